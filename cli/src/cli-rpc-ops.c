@@ -7940,6 +7940,11 @@ cmd_heal_volume_statistics_out(dict_t *dict, int brick)
     uint64_t healed_count = 0;
     uint64_t split_brain_count = 0;
     uint64_t heal_failed_count = 0;
+    uint64_t dir_healed_count = 0;
+    uint64_t file_healed_count = 0;
+    uint64_t pending_count = 0;
+    int64_t elapsed = 0;
+    int64_t eta = -1;
     char *start_time_str = NULL;
     char *end_time_str = NULL;
     char *crawl_type = NULL;
@@ -8004,6 +8009,43 @@ cmd_heal_volume_statistics_out(dict_t *dict, int brick)
         cli_out("No. of entries healed: %" PRIu64, healed_count);
         cli_out("No. of entries in split-brain: %" PRIu64, split_brain_count);
         cli_out("No. of heal failed entries: %" PRIu64, heal_failed_count);
+
+        /* not sent by older self-heal daemons */
+        snprintf(key, sizeof key, "statistics_dir_healed_cnt-%d-%" PRIu64,
+                 brick, i);
+        if (dict_get_uint64(dict, key, &dir_healed_count))
+            continue;
+        snprintf(key, sizeof key, "statistics_file_healed_cnt-%d-%" PRIu64,
+                 brick, i);
+        if (dict_get_uint64(dict, key, &file_healed_count))
+            continue;
+        snprintf(key, sizeof key, "statistics_pending_cnt-%d-%" PRIu64, brick,
+                 i);
+        if (dict_get_uint64(dict, key, &pending_count))
+            continue;
+        snprintf(key, sizeof key, "statistics_elapsed-%d-%" PRIu64, brick, i);
+        if (dict_get_int64(dict, key, &elapsed))
+            continue;
+        snprintf(key, sizeof key, "statistics_eta-%d-%" PRIu64, brick, i);
+        if (dict_get_int64(dict, key, &eta))
+            continue;
+
+        cli_out("No. of directories healed: %" PRIu64, dir_healed_count);
+        cli_out("No. of files healed: %" PRIu64, file_healed_count);
+        if (elapsed > 0)
+            cli_out("Heal rate: %.1f directories/s, %.1f files/s",
+                    (double)dir_healed_count / elapsed,
+                    (double)file_healed_count / elapsed);
+        if (progress != 1)
+            continue;
+        cli_out("No. of entries pending when the crawl started: %" PRIu64,
+                pending_count);
+        if (eta >= 0)
+            cli_out("Estimated time to completion: %" PRId64 "h %02" PRId64
+                    "m %02" PRId64 "s",
+                    eta / 3600, (eta % 3600) / 60, eta % 60);
+        else
+            cli_out("Estimated time to completion: unknown");
     }
 
 out:
@@ -0,0 +1,262 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * glfs-lock-storm: byte-range lock storm against the locks xlator.
+ *
+ * One owner takes <count> disjoint write locks on a single file, then a
+ * second owner probes every one of them with F_SETLK and F_GETLK, and the
+ * first owner releases them again. Each phase is timed separately.
+ *
+ * Given a directory, the tool loads features/locks directly on top of
+ * storage/posix in its own process, so the numbers only reflect the cost
+ * of the lock handling. Given a volfile, any graph can be measured.
+ *
+ * gcc glfs-lock-storm.c -lgfapi -o glfs-lock-storm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <glusterfs/api/glfs.h>
+
+#define PROGNAME "glfs-lock-storm"
+#define LOCK_FILE "/lock-storm.file"
+
+static char owner_a[] = "lock-storm-owner-a";
+static char owner_b[] = "lock-storm-owner-b";
+
+static void
+usage(FILE *output)
+{
+    fprintf(output, "Usage: " PROGNAME " <directory|volfile> [count]\n");
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+report(const char *phase, long count, double start)
+{
+    double elapsed = now() - start;
+
+    fprintf(stdout, "%-10s %8ld ops %10.3f s %12.0f ops/s\n", phase, count,
+            elapsed, elapsed > 0 ? count / elapsed : 0);
+}
+
+static int
+lock_range(glfs_fd_t *glfd, int cmd, short type, off_t start, off_t len,
+           struct flock *out)
+{
+    struct flock lock = {
+        0,
+    };
+
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = start;
+    lock.l_len = len;
+
+    if (glfs_posix_lock(glfd, cmd, &lock) != 0)
+        return -1;
+
+    if (out)
+        *out = lock;
+
+    return 0;
+}
+
+/* Writes a graph with the locks xlator straight on top of a posix brick
+ * rooted at @directory. */
+static int
+write_volfile(const char *directory, char *path, size_t size)
+{
+    FILE *fp = NULL;
+    int fd = -1;
+
+    snprintf(path, size, "/tmp/" PROGNAME ".XXXXXX");
+    fd = mkstemp(path);
+    if (fd < 0)
+        return -1;
+
+    fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        return -1;
+    }
+
+    fprintf(fp,
+            "volume posix\n"
+            "    type storage/posix\n"
+            "    option directory %s\n"
+            "end-volume\n"
+            "\n"
+            "volume locks\n"
+            "    type features/locks\n"
+            "    subvolumes posix\n"
+            "end-volume\n",
+            directory);
+
+    return fclose(fp);
+}
+
+int
+main(int argc, char **argv)
+{
+    glfs_t *fs = NULL;
+    glfs_fd_t *fd_a = NULL;
+    glfs_fd_t *fd_b = NULL;
+    struct flock lock = {
+        0,
+    };
+    struct stat st;
+    char volfile[PATH_MAX] = {
+        0,
+    };
+    const char *spec = NULL;
+    int generated = 0;
+    long count = 10000;
+    long i = 0;
+    double start = 0;
+    int ret = -1;
+
+    if (argc < 2 || argc > 3) {
+        usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (argc == 3) {
+        count = strtol(argv[2], NULL, 10);
+        if (count <= 0) {
+            usage(stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    spec = argv[1];
+    if (stat(spec, &st) == 0 && S_ISDIR(st.st_mode)) {
+        if (write_volfile(spec, volfile, sizeof(volfile)) != 0) {
+            perror("writing volfile failed");
+            exit(EXIT_FAILURE);
+        }
+        spec = volfile;
+        generated = 1;
+    }
+
+    fs = glfs_new(PROGNAME);
+    if (!fs) {
+        perror("glfs_new failed");
+        goto out;
+    }
+
+    glfs_set_logging(fs, "/dev/null", 0);
+
+    if (glfs_set_volfile(fs, spec) != 0) {
+        perror("glfs_set_volfile failed");
+        goto out;
+    }
+
+    if (glfs_init(fs) != 0) {
+        perror("glfs_init failed");
+        goto out;
+    }
+
+    fd_a = glfs_creat(fs, LOCK_FILE, O_RDWR, 0644);
+    if (!fd_a) {
+        perror("glfs_creat failed");
+        goto out;
+    }
+
+    fd_b = glfs_open(fs, LOCK_FILE, O_RDWR);
+    if (!fd_b) {
+        perror("glfs_open failed");
+        goto out;
+    }
+
+    if (glfs_fd_set_lkowner(fd_a, owner_a, sizeof(owner_a)) != 0 ||
+        glfs_fd_set_lkowner(fd_b, owner_b, sizeof(owner_b)) != 0) {
+        perror("glfs_fd_set_lkowner failed");
+        goto out;
+    }
+
+    /* Ranges are one byte apart so that none of them get merged. */
+    start = now();
+    for (i = 0; i < count; i++) {
+        if (lock_range(fd_a, F_SETLK, F_WRLCK, 2 * i, 1, NULL) != 0) {
+            fprintf(stderr, "lock %ld failed: %s\n", i, strerror(errno));
+            goto out;
+        }
+    }
+    report("lock", count, start);
+
+    start = now();
+    for (i = 0; i < count; i++) {
+        if (lock_range(fd_b, F_SETLK, F_WRLCK, 2 * i, 1, NULL) == 0 ||
+            errno != EAGAIN) {
+            fprintf(stderr, "conflicting lock %ld was not refused\n", i);
+            goto out;
+        }
+    }
+    report("conflict", count, start);
+
+    start = now();
+    for (i = 0; i < count; i++) {
+        if (lock_range(fd_b, F_GETLK, F_RDLCK, 2 * i, 1, &lock) != 0 ||
+            lock.l_type != F_WRLCK || lock.l_start != 2 * i) {
+            fprintf(stderr, "getlk %ld did not report the holder\n", i);
+            goto out;
+        }
+    }
+    report("getlk", count, start);
+
+    start = now();
+    for (i = count - 1; i >= 0; i--) {
+        if (lock_range(fd_a, F_SETLK, F_UNLCK, 2 * i, 1, NULL) != 0) {
+            fprintf(stderr, "unlock %ld failed: %s\n", i, strerror(errno));
+            goto out;
+        }
+    }
+    report("unlock", count, start);
+
+    /* Nothing may be left behind. */
+    if (lock_range(fd_b, F_SETLK, F_WRLCK, 0, 0, NULL) != 0 ||
+        lock_range(fd_b, F_SETLK, F_UNLCK, 0, 0, NULL) != 0) {
+        fprintf(stderr, "file is still locked after the storm\n");
+        goto out;
+    }
+
+    ret = 0;
+out:
+    if (fd_b)
+        glfs_close(fd_b);
+    if (fd_a)
+        glfs_close(fd_a);
+    if (fs) {
+        glfs_unlink(fs, LOCK_FILE);
+        glfs_fini(fs);
+    }
+    if (generated)
+        unlink(volfile);
+
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * glfs-read-storm: concurrent cache hits in io-cache.
+ *
+ * A file is written and read once, so that io-cache holds all of it. Then
+ * <threads> threads, each with its own fd, read 4KB blocks of the file at
+ * random for <seconds>. This is done twice, with the lock-free page index
+ * of io-cache ("lockless-read") off and on, in graphs loaded in the same
+ * process one after the other.
+ *
+ * The graph is performance/io-cache directly on top of storage/posix,
+ * rooted at <directory>, so only the cost of serving cache hits is
+ * measured.
+ *
+ * gcc glfs-read-storm.c -lgfapi -lpthread -o glfs-read-storm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <glusterfs/api/glfs.h>
+
+#define PROGNAME "glfs-read-storm"
+#define READ_FILE "/read-storm.file"
+#define FILE_SIZE (4 * 1024 * 1024)
+#define BLOCK_SIZE 4096
+
+struct storm {
+    glfs_t *fs;
+    volatile int stop;
+    long ops;
+    pthread_mutex_t lock;
+};
+
+static void
+usage(FILE *output)
+{
+    fprintf(output, "Usage: " PROGNAME " <directory> [threads] [seconds]\n");
+}
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+report(const char *phase, long count, double start)
+{
+    double elapsed = now() - start;
+
+    fprintf(stdout, "%-14s %10ld ops %10.3f s %12.0f ops/s\n", phase, count,
+            elapsed, elapsed > 0 ? count / elapsed : 0);
+}
+
+/* Writes a graph with io-cache straight on top of a posix brick rooted at
+ * @directory. */
+static int
+write_volfile(const char *directory, const char *lockless, char *path,
+              size_t size)
+{
+    FILE *fp = NULL;
+    int fd = -1;
+
+    snprintf(path, size, "/tmp/" PROGNAME ".XXXXXX");
+    fd = mkstemp(path);
+    if (fd < 0)
+        return -1;
+
+    fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        return -1;
+    }
+
+    fprintf(fp,
+            "volume posix\n"
+            "    type storage/posix\n"
+            "    option directory %s\n"
+            "end-volume\n"
+            "\n"
+            "volume io-cache\n"
+            "    type performance/io-cache\n"
+            "    option cache-timeout 60\n"
+            "    option lockless-read %s\n"
+            "    subvolumes posix\n"
+            "end-volume\n",
+            directory, lockless);
+
+    return fclose(fp);
+}
+
+static void *
+reader(void *data)
+{
+    struct storm *storm = data;
+    glfs_fd_t *glfd = NULL;
+    char buf[BLOCK_SIZE];
+    unsigned int seed = (unsigned int)(unsigned long)&buf;
+    long ops = 0;
+    off_t offset = 0;
+
+    glfd = glfs_open(storm->fs, READ_FILE, O_RDONLY);
+    if (!glfd) {
+        perror("glfs_open failed");
+        return NULL;
+    }
+
+    while (!storm->stop) {
+        offset = (rand_r(&seed) % (FILE_SIZE / BLOCK_SIZE)) * BLOCK_SIZE;
+        if (glfs_pread(glfd, buf, BLOCK_SIZE, offset, 0, NULL) !=
+            BLOCK_SIZE) {
+            fprintf(stderr, "read at %ld failed: %s\n", (long)offset,
+                    strerror(errno));
+            break;
+        }
+        ops++;
+    }
+
+    glfs_close(glfd);
+
+    pthread_mutex_lock(&storm->lock);
+    storm->ops += ops;
+    pthread_mutex_unlock(&storm->lock);
+
+    return NULL;
+}
+
+static int
+run(const char *directory, const char *lockless, int threads, int seconds)
+{
+    struct storm storm = {
+        0,
+    };
+    pthread_t *tids = NULL;
+    glfs_fd_t *glfd = NULL;
+    char volfile[PATH_MAX] = {
+        0,
+    };
+    char buf[BLOCK_SIZE];
+    char phase[32];
+    off_t offset = 0;
+    double start = 0;
+    int started = 0;
+    int i = 0;
+    int ret = -1;
+
+    pthread_mutex_init(&storm.lock, NULL);
+
+    if (write_volfile(directory, lockless, volfile, sizeof(volfile)) != 0) {
+        perror("writing volfile failed");
+        goto out;
+    }
+
+    storm.fs = glfs_new(PROGNAME);
+    if (!storm.fs) {
+        perror("glfs_new failed");
+        goto out;
+    }
+
+    glfs_set_logging(storm.fs, "/dev/null", 0);
+
+    if (glfs_set_volfile(storm.fs, volfile) != 0) {
+        perror("glfs_set_volfile failed");
+        goto out;
+    }
+
+    if (glfs_init(storm.fs) != 0) {
+        perror("glfs_init failed");
+        goto out;
+    }
+
+    glfd = glfs_creat(storm.fs, READ_FILE, O_RDWR, 0644);
+    if (!glfd) {
+        perror("glfs_creat failed");
+        goto out;
+    }
+
+    memset(buf, 'r', sizeof(buf));
+    for (offset = 0; offset < FILE_SIZE; offset += BLOCK_SIZE) {
+        if (glfs_pwrite(glfd, buf, BLOCK_SIZE, offset, 0, NULL, NULL) !=
+            BLOCK_SIZE) {
+            perror("glfs_pwrite failed");
+            goto out;
+        }
+    }
+
+    /* bring the whole file in the cache */
+    for (offset = 0; offset < FILE_SIZE; offset += BLOCK_SIZE) {
+        if (glfs_pread(glfd, buf, BLOCK_SIZE, offset, 0, NULL) !=
+            BLOCK_SIZE) {
+            perror("glfs_pread failed");
+            goto out;
+        }
+    }
+
+    tids = calloc(threads, sizeof(*tids));
+    if (!tids) {
+        perror("calloc failed");
+        goto out;
+    }
+
+    start = now();
+    for (started = 0; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, reader, &storm) != 0) {
+            perror("pthread_create failed");
+            break;
+        }
+    }
+
+    sleep(seconds);
+    storm.stop = 1;
+
+    for (i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+
+    if (started == threads) {
+        snprintf(phase, sizeof(phase), "lockless-%s", lockless);
+        report(phase, storm.ops, start);
+        ret = 0;
+    }
+
+out:
+    free(tids);
+    if (glfd)
+        glfs_close(glfd);
+    if (storm.fs) {
+        glfs_unlink(storm.fs, READ_FILE);
+        glfs_fini(storm.fs);
+    }
+    if (volfile[0])
+        unlink(volfile);
+    pthread_mutex_destroy(&storm.lock);
+
+    return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct stat st;
+    int threads = 8;
+    int seconds = 10;
+
+    if (argc < 2 || argc > 4) {
+        usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (stat(argv[1], &st) != 0 || !S_ISDIR(st.st_mode)) {
+        usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (argc >= 3)
+        threads = atoi(argv[2]);
+    if (argc == 4)
+        seconds = atoi(argv[3]);
+
+    if (threads <= 0 || seconds <= 0) {
+        usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(stdout, "%d threads, %d seconds\n", threads, seconds);
+
+    if (run(argv[1], "off", threads, seconds) != 0 ||
+        run(argv[1], "on", threads, seconds) != 0)
+        exit(EXIT_FAILURE);
+
+    return EXIT_SUCCESS;
+}
@@ -45,7 +45,7 @@
     1 /* MIN is the fresh start op-version, mostly                             \
          should not change */
 #define GD_OP_VERSION_MAX                                                      \
-    GD_OP_VERSION_7_2 /* MAX VERSION is the maximum                            \
+    GD_OP_VERSION_8_0 /* MAX VERSION is the maximum                            \
                          count in VME table, should                            \
                          keep changing with                                    \
                          introduction of newer                                 \
@@ -119,6 +119,8 @@
 #define GD_OP_VERSION_7_2 70200 /* Op-version for GlusterFS 7.2 */
 #define GD_OP_VERSION_7_3 70300 /* Op-version for GlusterFS 7.3 */
 
+#define GD_OP_VERSION_8_0 80000 /* Op-version for GlusterFS 8.0 */
+
 #define GD_OP_VER_PERSISTENT_AFR_XATTRS GD_OP_VERSION_3_6_0
 
 #include "glusterfs/xlator.h"
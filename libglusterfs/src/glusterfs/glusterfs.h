@@ -457,6 +457,18 @@ fop_enum_to_pri_string(glusterfs_fop_t fop);
 
 /* key value which quick read uses to get small files in lookup cbk */
 #define GF_CONTENT_KEY "glusterfs.content"
+/* same, but files larger than the requested size return their first
+ * requested-size bytes instead of nothing */
+#define GF_CONTENT_HEAD_KEY "glusterfs.content-head"
+
+/* set by readdir-ahead in the reply of lookups it served from a directory
+ * listing, holds the generation of that listing */
+#define GF_RDA_LISTING_KEY "glusterfs.rda-listing"
+
+/* set by cache-leases in the reply of lookups and stats of inodes it holds
+ * a read lease on, and in the cache invalidations it sends up when the
+ * lease goes away */
+#define GF_CACHE_LEASE_KEY "glusterfs.cache-lease"
 
 struct _xlator_cmdline_option {
     struct list_head cmd_args;
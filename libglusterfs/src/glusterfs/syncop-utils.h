@@ -23,6 +23,11 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                    void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
                    uint32_t max_jobs, uint32_t max_qlen);
 
+int
+syncop_mt_dir_scan_phased(call_frame_t *frame, xlator_t *subvol, loc_t *loc,
+                          int pid, void *data, syncop_dir_scan_fn_t fn,
+                          dict_t *xdata, uint32_t max_jobs, uint32_t max_qlen);
+
 int
 syncop_dir_scan(xlator_t *subvol, loc_t *loc, int pid, void *data,
                 int (*fn)(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
@@ -315,6 +315,8 @@ synctask_wake(struct synctask *task);
 void
 synctask_yield(struct synctask *task);
 void
+synctask_usleep(int32_t usecs);
+void
 synctask_waitfor(struct synctask *task, int count);
 
 #define synctask_barrier_init(args) syncbarrier_init(&args->barrier)
@@ -20,7 +20,8 @@ typedef enum tbf_ops {
     TBF_OP_HASH = 0,    /* checksum calculation  */
     TBF_OP_READ = 1,    /* inode read(s)         */
     TBF_OP_READDIR = 2, /* dentry read(s)        */
-    TBF_OP_MAX = 3,
+    TBF_OP_UNLINK = 3,  /* dentry removal(s)     */
+    TBF_OP_MAX = 4,
 } tbf_ops_t;
 
 /**
@@ -65,9 +66,15 @@ tbf_init(tbf_opspec_t *, unsigned int);
 int
 tbf_mod(tbf_t *, tbf_opspec_t *);
 
+void
+tbf_fini(tbf_t *);
+
 void
 tbf_throttle(tbf_t *, tbf_ops_t, unsigned long);
 
+unsigned long
+tbf_take(tbf_t *, tbf_ops_t, unsigned long);
+
 #define TBF_THROTTLE_BEGIN(tbf, op, tokens) (tbf_throttle(tbf, op, tokens))
 #define TBF_THROTTLE_END(tbf, op, tokens)
 
@@ -67,6 +67,7 @@ typedef enum {
     GF_UPCALL_RECALL_LEASE,
     GF_UPCALL_INODELK_CONTENTION,
     GF_UPCALL_ENTRYLK_CONTENTION,
+    GF_UPCALL_CACHE_INVALIDATION_BATCH,
 } gf_upcall_event_t;
 
 struct gf_upcall {
@@ -85,6 +86,13 @@ struct gf_upcall_cache_invalidation {
     dict_t *dict;          /* For xattrs */
 };
 
+/* Cache invalidations queued for the same client. Each entry is a
+ * GF_UPCALL_CACHE_INVALIDATION event, with its own gfid and data. */
+struct gf_upcall_cache_invalidation_batch {
+    uint32_t count;
+    struct gf_upcall *entries;
+};
+
 struct gf_upcall_recall_lease {
     uint32_t lease_type; /* Lease type to which client can downgrade to*/
     uuid_t tid;          /* transaction id of the fop that caused
@@ -330,6 +330,46 @@ out:
     return ret;
 }
 
+static int
+_dir_scan_dispatch(call_frame_t *frame, xlator_t *subvol, loc_t *parent,
+                   gf_dirent_t *q, gf_dirent_t *entry, int *retval,
+                   pthread_mutex_t *mut, pthread_cond_t *cond,
+                   uint32_t *jobs_running, uint32_t *qlen, uint32_t max_jobs,
+                   uint32_t max_qlen, syncop_dir_scan_fn_t fn, void *data)
+{
+    pthread_mutex_lock(mut);
+    {
+        while (*qlen == max_qlen)
+            pthread_cond_wait(cond, mut);
+        if (max_jobs == *jobs_running) {
+            list_add_tail(&entry->list, &q->list);
+            (*qlen)++;
+            entry = NULL;
+        } else {
+            (*jobs_running)++;
+        }
+    }
+    pthread_mutex_unlock(mut);
+
+    if (!entry)
+        return 0;
+
+    return _run_dir_scan_task(frame, subvol, parent, q, entry, retval, mut,
+                              cond, jobs_running, qlen, fn, data);
+}
+
+static void
+_dir_scan_drain(pthread_mutex_t *mut, pthread_cond_t *cond,
+                uint32_t *jobs_running)
+{
+    pthread_mutex_lock(mut);
+    {
+        while (*jobs_running)
+            pthread_cond_wait(cond, mut);
+    }
+    pthread_mutex_unlock(mut);
+}
+
 int
 syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                    void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
@@ -424,44 +464,183 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
             if (retval) /*Any jobs failed?*/
                 goto out;
 
-            pthread_mutex_lock(&mut);
-            {
-                while (qlen == max_qlen)
-                    pthread_cond_wait(&cond, &mut);
-                if (max_jobs == jobs_running) {
-                    list_add_tail(&entry->list, &q.list);
-                    qlen++;
-                    entry = NULL;
-                } else {
-                    jobs_running++;
-                }
+            ret = _dir_scan_dispatch(frame, subvol, loc, &q, entry, &retval,
+                                     &mut, &cond, &jobs_running, &qlen,
+                                     max_jobs, max_qlen, fn, data);
+            if (ret)
+                goto out;
+        }
+    }
+
+out:
+    if (fd)
+        fd_unref(fd);
+    if (mut_init && cond_init) {
+        _dir_scan_drain(&mut, &cond, &jobs_running);
+        gf_dirent_free(&q);
+        gf_dirent_free(&entries);
+    }
+
+    if (mut_init)
+        pthread_mutex_destroy(&mut);
+    if (cond_init)
+        pthread_cond_destroy(&cond);
+    return ret | retval;
+}
+
+/* Size classes of the entries run by syncop_mt_dir_scan_phased(), the
+ * biggest first. */
+static const uint64_t _dir_scan_size_class[] = {
+    1ULL << 30, /* 1GB */
+    64ULL << 20,
+    1ULL << 20,
+    0,
+};
+
+#define DIR_SCAN_SIZE_CLASSES                                                  \
+    (sizeof(_dir_scan_size_class) / sizeof(_dir_scan_size_class[0]))
+
+/*
+ * Like syncop_mt_dir_scan(), except that the entries of every readdir
+ * batch are run in two phases: all the directories first, up to max_jobs
+ * of them at once, then, once they are all done, the other entries, the
+ * biggest first. Entries created while running the directories are there
+ * by the time the other entries are run, and a big file picked up last
+ * does not keep the batch going alone. xdata should ask for the type (and
+ * size) of the entries, see "get-gfid-type"; entries of unknown type are
+ * run in the second phase.
+ */
+int
+syncop_mt_dir_scan_phased(call_frame_t *frame, xlator_t *subvol, loc_t *loc,
+                          int pid, void *data, syncop_dir_scan_fn_t fn,
+                          dict_t *xdata, uint32_t max_jobs, uint32_t max_qlen)
+{
+    fd_t *fd = NULL;
+    uint64_t offset = 0;
+    gf_dirent_t *last = NULL;
+    int ret = 0;
+    int retval = 0;
+    gf_dirent_t q;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *tmp = NULL;
+    uint32_t jobs_running = 0;
+    uint32_t qlen = 0;
+    pthread_cond_t cond;
+    pthread_mutex_t mut;
+    gf_boolean_t cond_init = _gf_false;
+    gf_boolean_t mut_init = _gf_false;
+    gf_dirent_t entries;
+    gf_dirent_t dirs;
+    gf_dirent_t others[DIR_SCAN_SIZE_CLASSES];
+    int i = 0;
+    xlator_t *this = NULL;
+
+    if (frame) {
+        this = frame->this;
+    } else {
+        this = THIS;
+    }
+
+    if (synctask_get())
+        return -ENOTSUP;
+
+    if (max_jobs == 0)
+        return -EINVAL;
+
+    if (max_qlen == 0)
+        max_qlen = 1;
+
+    INIT_LIST_HEAD(&entries.list);
+    INIT_LIST_HEAD(&q.list);
+    INIT_LIST_HEAD(&dirs.list);
+    for (i = 0; i < DIR_SCAN_SIZE_CLASSES; i++)
+        INIT_LIST_HEAD(&others[i].list);
+
+    ret = syncop_dirfd(subvol, loc, &fd, pid);
+    if (ret)
+        goto out;
+
+    ret = pthread_mutex_init(&mut, NULL);
+    if (ret)
+        goto out;
+    mut_init = _gf_true;
+
+    ret = pthread_cond_init(&cond, NULL);
+    if (ret)
+        goto out;
+    cond_init = _gf_true;
+
+    while ((ret = syncop_readdir(subvol, fd, 131072, offset, &entries, xdata,
+                                 NULL))) {
+        if (ret < 0)
+            break;
+
+        if (ret > 0)
+            ret = 0;
+
+        last = list_last_entry(&entries.list, typeof(*last), list);
+        offset = last->d_off;
+
+        list_for_each_entry_safe(entry, tmp, &entries.list, list)
+        {
+            list_del_init(&entry->list);
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+                gf_dirent_entry_free(entry);
+                continue;
             }
-            pthread_mutex_unlock(&mut);
 
-            if (!entry)
+            if (entry->d_stat.ia_type == IA_IFDIR) {
+                list_add_tail(&entry->list, &dirs.list);
                 continue;
+            }
+
+            for (i = 0; entry->d_stat.ia_size < _dir_scan_size_class[i]; i++)
+                ;
+            list_add_tail(&entry->list, &others[i].list);
+        }
 
-            ret = _run_dir_scan_task(frame, subvol, loc, &q, entry, &retval,
-                                     &mut, &cond, &jobs_running, &qlen, fn,
-                                     data);
+        /* the other entries wait for the directories */
+        list_for_each_entry_safe(entry, tmp, &dirs.list, list)
+        {
+            if ((this && this->cleanup_starting) || retval)
+                goto out;
+
+            list_del_init(&entry->list);
+            ret = _dir_scan_dispatch(frame, subvol, loc, &q, entry, &retval,
+                                     &mut, &cond, &jobs_running, &qlen,
+                                     max_jobs, max_qlen, fn, data);
             if (ret)
                 goto out;
         }
+        _dir_scan_drain(&mut, &cond, &jobs_running);
+
+        for (i = 0; i < DIR_SCAN_SIZE_CLASSES; i++) {
+            list_for_each_entry_safe(entry, tmp, &others[i].list, list)
+            {
+                if ((this && this->cleanup_starting) || retval)
+                    goto out;
+
+                list_del_init(&entry->list);
+                ret = _dir_scan_dispatch(frame, subvol, loc, &q, entry,
+                                         &retval, &mut, &cond, &jobs_running,
+                                         &qlen, max_jobs, max_qlen, fn, data);
+                if (ret)
+                    goto out;
+            }
+        }
     }
 
 out:
     if (fd)
         fd_unref(fd);
     if (mut_init && cond_init) {
-        pthread_mutex_lock(&mut);
-        {
-            while (jobs_running)
-                pthread_cond_wait(&cond, &mut);
-        }
-        pthread_mutex_unlock(&mut);
+        _dir_scan_drain(&mut, &cond, &jobs_running);
         gf_dirent_free(&q);
-        gf_dirent_free(&entries);
     }
+    gf_dirent_free(&entries);
+    gf_dirent_free(&dirs);
+    for (i = 0; i < DIR_SCAN_SIZE_CLASSES; i++)
+        gf_dirent_free(&others[i]);
 
     if (mut_init)
         pthread_mutex_destroy(&mut);
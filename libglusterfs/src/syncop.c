@@ -10,6 +10,7 @@
 
 #include "glusterfs/syncop.h"
 #include "glusterfs/libglusterfs-messages.h"
+#include "glusterfs/timer.h"
 
 int
 syncopctx_setfsuid(void *uid)
@@ -267,6 +268,43 @@ synctask_wake(struct synctask *task)
     pthread_mutex_unlock(&env->mutex);
 }
 
+static void
+synctask_sleep_wake(void *data)
+{
+    synctask_wake(data);
+}
+
+/* Sleeps for @usecs without holding on to the thread of the syncenv:
+ * the task is suspended and woken from a timer.
+ */
+void
+synctask_usleep(int32_t usecs)
+{
+    struct synctask *task = NULL;
+    gf_timer_t *timer = NULL;
+    struct timespec delta = {
+        0,
+    };
+
+    task = synctask_get();
+    if (!task) {
+        usleep(usecs);
+        return;
+    }
+
+    delta.tv_sec = usecs / 1000000;
+    delta.tv_nsec = (usecs % 1000000) * 1000;
+
+    timer = gf_timer_call_after(task->xl->ctx, delta, synctask_sleep_wake,
+                                task);
+    if (!timer) {
+        usleep(usecs);
+        return;
+    }
+
+    synctask_yield(task);
+}
+
 void
 synctask_wrap(void)
 {
@@ -94,15 +94,22 @@ tbf_tokengenerator(void *arg)
     unsigned long token_gen_interval = 0;
     tbf_bucket_t *bucket = arg;
 
-    tokenrate = bucket->tokenrate;
-    maxtokens = bucket->maxtokens;
-    token_gen_interval = bucket->token_gen_interval;
+    LOCK(&bucket->lock);
+    {
+        token_gen_interval = bucket->token_gen_interval;
+    }
+    UNLOCK(&bucket->lock);
 
     while (1) {
         usleep(token_gen_interval);
 
+        /* pick up changes made by tbf_mod() */
         LOCK(&bucket->lock);
         {
+            tokenrate = bucket->tokenrate;
+            maxtokens = bucket->maxtokens;
+            token_gen_interval = bucket->token_gen_interval;
+
             bucket->tokens += tokenrate;
             if (bucket->tokens > maxtokens)
                 bucket->tokens = maxtokens;
@@ -208,6 +215,8 @@ tbf_mod_bucket(tbf_bucket_t *bucket, tbf_opspec_t *spec)
         bucket->tokens = 0;
         bucket->tokenrate = spec->rate;
         bucket->maxtokens = spec->maxlimit;
+        if (spec->token_gen_interval)
+            bucket->token_gen_interval = spec->token_gen_interval;
     }
     UNLOCK(&bucket->lock);
 
@@ -239,6 +248,37 @@ tbf_mod(tbf_t *tbf, tbf_opspec_t *tbfspec)
     return ret;
 }
 
+/**
+ * Stop the token generators and release the buckets. Callers must make
+ * sure no request is blocked in (or about to enter) tbf_throttle().
+ */
+void
+tbf_fini(tbf_t *tbf)
+{
+    int32_t i = 0;
+    tbf_bucket_t *bucket = NULL;
+
+    if (!tbf)
+        return;
+
+    for (i = 0; i < TBF_OP_MAX; i++) {
+        bucket = *(tbf->bucket + i);
+        if (!bucket)
+            continue;
+
+        /* the generator only blocks in usleep(), which is a cancellation
+         * point, so it never goes away holding the bucket lock */
+        (void)pthread_cancel(bucket->tokener);
+        (void)pthread_join(bucket->tokener, NULL);
+
+        LOCK_DESTROY(&bucket->lock);
+        GF_FREE(bucket);
+        *(tbf->bucket + i) = NULL;
+    }
+
+    GF_FREE(tbf);
+}
+
 void
 tbf_throttle(tbf_t *tbf, tbf_ops_t op, unsigned long tokens_requested)
 {
@@ -288,3 +328,34 @@ unblock:
         GF_FREE(throttle);
     }
 }
+
+/**
+ * Takes up to @tokens_requested tokens without blocking, and returns how
+ * many were taken. For callers that can't block the thread they run on
+ * (synctasks) and wait out the rest their own way. Requests queued in
+ * tbf_throttle() are served first.
+ */
+unsigned long
+tbf_take(tbf_t *tbf, tbf_ops_t op, unsigned long tokens_requested)
+{
+    unsigned long taken = 0;
+    tbf_bucket_t *bucket = NULL;
+
+    GF_ASSERT(op >= TBF_OP_MIN);
+    GF_ASSERT(op <= TBF_OP_MAX);
+
+    bucket = *(tbf->bucket + op);
+    if (!bucket)
+        return tokens_requested;
+
+    LOCK(&bucket->lock);
+    {
+        if (list_empty(&bucket->queued)) {
+            taken = min(tokens_requested, bucket->tokens);
+            bucket->tokens -= taken;
+        }
+    }
+    UNLOCK(&bucket->lock);
+
+    return taken;
+}
@@ -155,6 +155,7 @@ enum gf_cbk_procnum {
     GF_CBK_STATEDUMP,
     GF_CBK_INODELK_CONTENTION,
     GF_CBK_ENTRYLK_CONTENTION,
+    GF_CBK_CACHE_INVALIDATION_BATCH,
     GF_CBK_MAXVALUE,
 };
 
@@ -797,3 +797,10 @@ struct gfs4_entrylk_contention_req {
         string                domain<>;
         opaque                xdata<>;
 };
+
+/* cache invalidations of several gfids for the same client, collapsed and
+ * sent in one callback by the upcall xlator */
+struct gfs4_cbk_cache_invalidation_batch_req {
+        gfs3_cbk_cache_invalidation_req entries<>;
+        opaque                          xdata<>;
+};
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+## xattrop index entries held in the index journal for index-delay
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function index_stat {
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+        grep -a "^$1=" $statedump | cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+function index_stat_positive {
+        if [ "$(index_stat $1)" -gt 0 ]; then echo "Y"; else echo "N"; fi
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 features.index-delay 2000
+TEST $CLI volume set $V0 features.index-delay-batch 16
+TEST ! $CLI volume set $V0 features.index-delay 100000
+TEST ! $CLI volume set $V0 features.index-delay-batch 0
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST $CLI volume start $V0
+TEST [ -f $B0/${V0}0/.glusterfs/indices/index-journal ]
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+## with both bricks up the entries are removed before being linked
+TEST touch $M0/file{1..20}
+EXPECT "0" echo $(ls $B0/${V0}0/.glusterfs/indices/xattrop | grep -v xattrop- | wc -l)
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^0$" index_stat journal-pending
+EXPECT "Y" index_stat_positive journal-cancelled
+
+## with a brick down they are linked after the delay
+TEST kill_brick $V0 $H0 $B0/${V0}1
+TEST dd if=/dev/zero of=$M0/file1 bs=4k count=1
+EXPECT_WITHIN $HEAL_TIMEOUT "Y" index_stat_positive journal-linked
+EXPECT "1" get_pending_heal_count $V0
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 1
+TEST $CLI volume set $V0 cluster.self-heal-daemon on
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" get_pending_heal_count $V0
+
+## back to linking right away
+TEST $CLI volume set $V0 features.index-delay 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^0$" index_stat journal-pending
+
+cleanup;
@@ -0,0 +1,74 @@
+#!/bin/bash
+
+## phased heal of the index: directories first, then files
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0,1,2}
+TEST $CLI volume set $V0 cluster.shd-heal-scheduler phased
+TEST $CLI volume set $V0 cluster.shd-max-threads 4
+TEST ! $CLI volume set $V0 cluster.shd-heal-scheduler lifo
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST $CLI volume set $V0 cluster.data-self-heal off
+TEST $CLI volume set $V0 cluster.metadata-self-heal off
+TEST $CLI volume set $V0 cluster.entry-self-heal off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST kill_brick $V0 $H0 $B0/${V0}2
+for i in {1..10}; do
+        TEST mkdir -p $M0/dir$i/sub
+        TEST dd if=/dev/urandom of=$M0/dir$i/sub/file bs=128k count=$i
+done
+TEST dd if=/dev/urandom of=$M0/big bs=1M count=2
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 2
+TEST $CLI volume set $V0 cluster.self-heal-daemon on
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+for i in {1..10}; do
+        TEST cmp $B0/${V0}0/dir$i/sub/file $B0/${V0}2/dir$i/sub/file
+done
+TEST cmp $B0/${V0}0/big $B0/${V0}2/big
+
+TEST $CLI volume heal $V0 statistics
+EXPECT_NOT "^0$" echo $($CLI volume heal $V0 statistics | grep -c "No. of directories healed")
+EXPECT_NOT "^0$" echo $($CLI volume heal $V0 statistics | grep -c "Heal rate")
+
+## one heal at a time: the files are healed biggest first, including
+## those whose inodes are still cached on the brick
+TEST $CLI volume set $V0 cluster.shd-max-threads 1
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST kill_brick $V0 $H0 $B0/${V0}2
+for i in {1..10}; do
+        TEST dd if=/dev/urandom of=$M0/small$i bs=4k count=$i
+done
+TEST dd if=/dev/urandom of=$M0/large bs=1M count=2
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 2
+TEST $CLI volume set $V0 cluster.self-heal-daemon on
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+## the last change of a healed file on the sink is the end of its heal
+large=$(stat -c %z $B0/${V0}2/large)
+for i in {1..10}; do
+        TEST [ "$large" \< "$(stat -c %z $B0/${V0}2/small$i)" ]
+done
+
+TEST $CLI volume set $V0 cluster.shd-heal-scheduler fifo
+
+cleanup;
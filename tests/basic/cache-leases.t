@@ -0,0 +1,60 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function cl_stat {
+        local statedump=$(generate_mount_statedump $V0 $1)
+        grep -A 20 "cache-leases.priv" $statedump | grep "^$2=" | \
+                cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+function revalidate {
+        for i in $(seq 1 4); do
+                stat $M0/file >/dev/null
+                sleep 1
+        done
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 features.leases on
+TEST $CLI volume set $V0 performance.cache-leases on
+TEST $CLI volume set $V0 performance.cache-leases-threshold 2
+TEST ! $CLI volume set $V0 performance.cache-leases-threshold 0
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 --attribute-timeout=0 \
+          --entry-timeout=0 $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 --attribute-timeout=0 \
+          --entry-timeout=0 $M1
+
+TEST dd if=/dev/zero of=$M0/file bs=1k count=1
+
+# a file stat'ed over and over gets leased
+revalidate
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^[1-9]" cl_stat $M0 granted
+EXPECT "1" cl_stat $M0 held
+
+# writes of the mount holding the lease do not break it
+TEST dd if=/dev/zero of=$M0/file bs=1k count=2
+EXPECT "2048" stat -c %s $M0/file
+EXPECT "0" cl_stat $M0 recalled
+
+# a write from another mount recalls it, the new size is seen right away
+TEST dd if=/dev/zero of=$M1/file bs=1k count=4
+EXPECT "^[1-9]" cl_stat $M0 recalled
+EXPECT "0" cl_stat $M0 held
+EXPECT "4096" stat -c %s $M0/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,53 @@
+#!/bin/bash
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../env.rc
+
+cleanup;
+
+CHANGELOG_BIN_PATH=$(dirname $0)/../../utils/changelog
+build_tester $CHANGELOG_BIN_PATH/test-reader-api.c -lgfchangelog
+
+CHANGELOG_PATH_0="$B0/${V0}0/.glusterfs/changelogs"
+
+function count_records {
+        local type=$1
+        local gfid=$2
+        $CHANGELOG_BIN_PATH/test-reader-api $type $gfid $CHANGELOG_PATH_0/CHANGELOG.*
+}
+
+function has_records {
+        if [ "$(count_records $1 $2)" -ge 1 ] 2>/dev/null; then
+                echo "Y"
+        else
+                echo "N"
+        fi
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 changelog.changelog on
+TEST $CLI volume set $V0 changelog.encoding indexed
+TEST $CLI volume set $V0 changelog.rollover-time 2
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0;
+
+for i in {1..10}; do
+        echo "data" > $M0/file$i
+done
+TEST chmod 600 $M0/file1
+gfid=$(get_gfid_string $M0/file1)
+
+#Entry records of all the creates, and only them
+EXPECT_WITHIN 10 "10" count_records E -
+#Records of a single file, looked up through the index
+EXPECT_WITHIN 10 "1" count_records E $gfid
+EXPECT_WITHIN 10 "Y" has_records M $gfid
+EXPECT "Y" has_records D $gfid
+
+TEST rm $CHANGELOG_BIN_PATH/test-reader-api
+
+cleanup;
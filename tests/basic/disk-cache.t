@@ -0,0 +1,76 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function dc_stat {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep -A 30 "disk-cache.priv" $statedump | grep "^$1=" | \
+                cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+function dc_saved_since {
+        if [ $(dc_stat index-saves) -gt $1 ]; then echo "Y"; else echo "N"; fi
+}
+
+function dc_stat_positive {
+        local value=$(dc_stat $1)
+        if [ "${value:-0}" -gt 0 ]; then echo "Y"; else echo "N"; fi
+}
+
+function file_md5 {
+        md5sum $1 | cut -f1 -d' '
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.disk-cache on
+TEST ! $CLI volume set $V0 performance.disk-cache-dir relative/path
+TEST $CLI volume set $V0 performance.disk-cache-dir $B0/dcache
+TEST $CLI volume set $V0 performance.disk-cache-timeout 0
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/urandom of=$M0/file bs=128k count=8
+md5=$(file_md5 $M0/file)
+
+# reading the file fills the cache, once out of the page cache
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+saves=$(dc_stat index-saves)
+EXPECT "$md5" file_md5 $M0/file
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1048576" dc_stat fill-bytes
+
+# the index is saved once the fills are written, unmount or not
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" dc_saved_since $saves
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" path_exists $B0/dcache/index
+
+# the cache survives a remount
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" dc_stat files_cached
+EXPECT "$md5" file_md5 $M0/file
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" dc_stat_positive cache-hit
+# the hits share the data file opened by the first one
+EXPECT "1" dc_stat open-data-files
+
+# a modification drops the cached blocks of the file
+TEST dd if=/dev/urandom of=$M0/file bs=128k count=1 seek=2 conv=notrunc
+EXPECT "0" dc_stat files_cached
+md5=$(md5sum $B0/${V0}0/file | cut -f1 -d' ')
+EXPECT "$md5" file_md5 $M0/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+rm -rf $B0/dcache
+
+cleanup;
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Delayed propagation of quota updates to the ancestors: the usage of the
+# ancestors is updated once the delay expires, the directories stay dirty
+# until then and are fixed by the lookup after a brick restart.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function quota_dirty {
+        getfattr -n trusted.glusterfs.quota.dirty -e hex --only-values $1 2>/dev/null | cut -c 1-4
+}
+
+cleanup;
+
+TEST glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}
+TEST $CLI volume start $V0;
+
+TEST $CLI volume quota $V0 enable;
+TEST $CLI volume quota $V0 hard-timeout 0
+TEST $CLI volume quota $V0 soft-timeout 0
+
+TEST $CLI volume set $V0 features.quota-update-delay 2
+TEST $CLI volume set $V0 features.quota-update-threshold 0
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0;
+
+TEST mkdir -p $M0/d1/d2/d3
+TEST $CLI volume quota $V0 limit-usage /d1 100MB
+
+for i in {1..5}; do
+        TEST dd if=/dev/zero of=$M0/d1/d2/d3/f$i bs=1M count=1 conv=fsync
+done
+
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "5.0MB" quotausage "/d1"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "0x30" quota_dirty $B0/${V0}/d1/d2/d3
+
+## Updates not propagated yet when the brick goes down
+TEST $CLI volume set $V0 features.quota-update-delay 300
+TEST dd if=/dev/zero of=$M0/d1/d2/d3/f6 bs=1M count=1 conv=fsync
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "0x31" quota_dirty $B0/${V0}/d1/d2/d3
+
+TEST kill_brick $V0 $H0 $B0/${V0}
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" brick_up_status $V0 $H0 $B0/${V0}
+
+TEST $CLI volume set $V0 features.quota-update-delay 0
+TEST stat $M0/d1/d2/d3
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "6.0MB" quotausage "/d1"
+
+cleanup;
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Space reservation: writes under a directory with a limit spend leases of
+# the remaining space taken from quotad, the limit is still enforced across
+# the bricks.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+QDD=$(dirname $0)/quota
+# compile the test write program and run it
+build_tester $(dirname $0)/quota.c -o $QDD
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2}
+TEST $CLI volume start $V0;
+
+TEST $CLI volume quota $V0 enable;
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" quotad_up_status;
+
+TEST $CLI volume quota $V0 soft-timeout 0
+TEST $CLI volume quota $V0 hard-timeout 0
+TEST $CLI volume set $V0 features.quota-lease-size 1MB
+TEST $CLI volume set $V0 features.quota-lease-timeout 5
+TEST ! $CLI volume set $V0 features.quota-lease-timeout 0
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0;
+
+TEST mkdir $M0/dir
+TEST $CLI volume quota $V0 limit-usage /dir 10MB
+
+for i in {1..8}; do
+        TEST $QDD $M0/dir/f$i 256 4
+done
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "8.0MB" quotausage "/dir"
+
+## the leases of both bricks must fit in what is left
+TEST ! $QDD $M0/dir/big 256 16
+TEST rm -f $M0/dir/big
+
+## unspent leases come back once they expire
+TEST rm $M0/dir/f{1..8}
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "0Bytes" quotausage "/dir"
+sleep 8
+TEST $QDD $M0/dir/f9 256 36
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "9.0MB" quotausage "/dir"
+
+TEST $CLI volume set $V0 features.quota-lease-size 0
+TEST ! $QDD $M0/dir/big 256 16
+
+TEST umount $M0
+rm -f $QDD
+
+cleanup;
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function sa_stat {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep -A 20 "stat-ahead.priv" $statedump | grep "^$1=" | \
+                cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-ahead on
+TEST $CLI volume set $V0 performance.stat-ahead-timeout 60
+TEST ! $CLI volume set $V0 performance.stat-ahead-window 0
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+for d in $(seq 1 10); do
+        TEST mkdir -p $M0/tree/dir$d/sub
+        TEST touch $M0/tree/dir$d/file1 $M0/tree/dir$d/file2
+done
+
+# walk the tree from a fresh mount, subdirectories get prefetched
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "41" echo $(find $M0/tree | wc -l)
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^[1-9]" sa_stat prefetched
+
+# the second walk is served from the listings, with the same result
+EXPECT "41" echo $(find $M0/tree | wc -l)
+TEST [ $(sa_stat served) -gt 0 ]
+
+# a change in a directory drops its listing
+TEST touch $M0/tree/dir5/file3
+TEST [ $(sa_stat invalidated) -gt 0 ]
+TEST [ -f $M0/tree/dir5/file3 ]
+EXPECT "3" echo $(ls $M0/tree/dir5 | grep -c file)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+## Merkle signatures: incremental re-signing and chunk level scrubbing
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function get_signature {
+        getfattr -n trusted.bit-rot.signature -e hex --only-values $1 2>/dev/null
+}
+
+function signature_changed {
+        if [ "$(get_signature $1)" != "$2" ]; then echo "Y"; else echo "N"; fi
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume start $V0
+
+TEST $CLI volume set $V0 features.bitrot-signature-type merkle-sha256
+TEST $CLI volume set $V0 features.bitrot-chunk-size 4KB
+TEST $CLI volume set $V0 features.bitrot-hash-threads 2
+TEST ! $CLI volume set $V0 features.bitrot-signature-type md5
+
+TEST $CLI volume bitrot $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" get_bitd_count
+
+TEST $CLI volume set $V0 features.expiry-time 1
+TEST $CLI volume set $V0 performance.quick-read off
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+
+## 64KB: 16 chunks
+TEST dd if=/dev/urandom of=$M0/FILE1 bs=4k count=16
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'trusted.bit-rot.signature' check_for_xattr 'trusted.bit-rot.signature' "/$B0/${V0}1/FILE1"
+sign1=$(get_signature $B0/${V0}1/FILE1)
+TEST [ -n "$sign1" ]
+
+## modify a chunk, the object gets signed again
+TEST dd if=/dev/urandom of=$M0/FILE1 bs=4k count=1 seek=5 conv=notrunc
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" signature_changed $B0/${V0}1/FILE1 "$sign1"
+
+## grow the object
+TEST dd if=/dev/urandom of=$M0/FILE1 bs=4k count=2 seek=16 conv=notrunc
+sign2=$(get_signature $B0/${V0}1/FILE1)
+EXPECT "73728" stat -c %s $B0/${V0}1/FILE1
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" signature_changed $B0/${V0}1/FILE1 "$sign2"
+
+## the incrementally re-signed object matches its signature
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" scrub_status $V0 'Number of Scrubbed files'
+EXPECT "0" scrub_status $V0 'Error count'
+TEST ! getfattr -n trusted.bit-rot.bad-file $B0/${V0}1/FILE1
+
+## corrupt a chunk in place
+TEST dd if=/dev/urandom of=$B0/${V0}1/FILE1 bs=4k count=1 seek=9 conv=notrunc
+
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'trusted.bit-rot.bad-file' check_for_xattr 'trusted.bit-rot.bad-file' "/$B0/${V0}1/FILE1"
+
+cleanup;
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+## Scrub rate, deadline and latency based backoff, and scrub checkpoints
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+CKPT_KEY=trusted.glusterfs.bit-rot.scrub-checkpoint
+
+## first 8 bytes of the checkpoint: start of the pass in progress
+function pass_in_progress {
+        local ckpt=$(getfattr -n $CKPT_KEY -e hex --only-values $1 2>/dev/null)
+        if [ -z "$ckpt" ]; then echo "none";
+        elif [ "${ckpt:2:16}" == "0000000000000000" ]; then echo "N";
+        else echo "Y"; fi
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume start $V0
+
+TEST $CLI volume bitrot $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" get_bitd_count
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" get_scrubd_count
+
+TEST $CLI volume set $V0 features.scrub-rate 8MB
+TEST $CLI volume set $V0 features.scrub-deadline 1h
+TEST $CLI volume set $V0 features.scrub-max-latency 500
+TEST ! $CLI volume set $V0 features.scrub-max-latency 100000
+
+TEST $CLI volume set $V0 features.expiry-time 1
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+
+TEST mkdir $M0/dir
+for i in {1..4}; do
+        TEST dd if=/dev/urandom of=$M0/dir/FILE$i bs=1M count=2
+done
+for i in {1..4}; do
+        EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'trusted.bit-rot.signature' check_for_xattr 'trusted.bit-rot.signature' "$B0/${V0}1/dir/FILE$i"
+done
+
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "N" pass_in_progress $B0/${V0}1
+
+## corruption is still caught at a limited rate
+TEST `echo "corrupt" >> $B0/${V0}1/dir/FILE3`
+TEST $CLI volume bitrot $V0 scrub ondemand
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'trusted.bit-rot.bad-file' check_for_xattr 'trusted.bit-rot.bad-file' "$B0/${V0}1/dir/FILE3"
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "N" pass_in_progress $B0/${V0}1
+
+cleanup;
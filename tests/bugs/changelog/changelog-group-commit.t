@@ -0,0 +1,54 @@
+#!/bin/bash
+
+#Checks that no record is lost or mangled when changelog records of
+#concurrent fops are written to the journal in batches.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+function count_creates {
+        local count=0
+        for changelog in $B0/${V0}0/.glusterfs/changelogs/CHANGELOG.*; do
+                count=$((count + $($PYTHON $(dirname $0)/../../utils/changelogparser.py $changelog | grep -c " CREATE .*/gc-file-")))
+        done
+        echo $count
+}
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 changelog.changelog on
+TEST $CLI volume set $V0 changelog.rollover-time 3
+TEST $CLI volume set $V0 changelog.journal-group-commit on
+TEST $CLI volume set $V0 changelog.journal-commit-delay 10
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+
+for i in $(seq 1 200); do
+        touch $M0/gc-file-$i &
+done
+wait
+
+for i in $(seq 1 200); do
+        echo data > $M0/gc-file-$i &
+done
+wait
+
+#fsync of the journal must write out buffered records first
+TEST $CLI volume set $V0 changelog.fsync-interval 1
+
+EXPECT_WITHIN 20 "200" count_creates
+
+#switching group commit off must not lose what is still buffered
+TEST $CLI volume set $V0 changelog.journal-group-commit off
+for i in $(seq 201 250); do
+        touch $M0/gc-file-$i &
+done
+wait
+
+EXPECT_WITHIN 20 "250" count_creates
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
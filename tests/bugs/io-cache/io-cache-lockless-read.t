@@ -0,0 +1,54 @@
+#!/bin/bash
+
+## io-cache: cache hits served from the lock-free page index
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function ioc_lockless_hits {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "lockless-hits" $statedump | cut -f2 -d'=' | sort -n | tail -1
+        rm -f $statedump
+}
+
+function file_md5 {
+        dd if=$1 bs=4k count=$2 2>/dev/null | md5sum | cut -f1 -d' '
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.io-cache on
+TEST $CLI volume set $V0 performance.cache-refresh-timeout 60
+TEST $CLI volume set $V0 performance.io-cache-lockless-read on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=64
+md5=$(md5sum $B0/${V0}0/file | cut -f1 -d' ')
+
+# The first read fills the cache, the next ones hit it.
+EXPECT "$md5" file_md5 $M0/file 64
+EXPECT "$md5" file_md5 $M0/file 64
+TEST [ $(ioc_lockless_hits) -gt 0 ]
+
+# A write drops the pages, the index does not serve stale data.
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=1 seek=3 conv=notrunc
+md5=$(md5sum $B0/${V0}0/file | cut -f1 -d' ')
+EXPECT "$md5" file_md5 $M0/file 64
+EXPECT "$md5" file_md5 $M0/file 64
+
+# Same data with the index off.
+TEST $CLI volume set $V0 performance.io-cache-lockless-read off
+EXPECT "$md5" file_md5 $M0/file 64
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
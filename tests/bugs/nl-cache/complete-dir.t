@@ -0,0 +1,64 @@
+#!/bin/bash
+
+## nl-cache: directories read to the end with readdirp answer negative
+## lookups locally, and stay coherent with creates and removes
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function nlc_counter {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep -a "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup;
+
+TEST glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0..1}
+TEST $CLI volume set $V0 group nl-cache
+TEST $CLI volume set $V0 nl-cache-positive-entry on
+TEST $CLI volume set $V0 nl-cache-complete-dir on
+TEST $CLI volume set $V0 nl-cache-limit 10MB
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1
+
+TEST mkdir $M1/dir
+for i in {1..500}; do echo $i > $M1/dir/file$i; done
+
+## read the directory to the end, then look up present and absent names
+EXPECT "500" echo $(ls $M0/dir | wc -l)
+TEST [ $(nlc_counter complete_directories) -ge 1 ]
+TEST stat $M0/dir/file1
+TEST stat $M0/dir/file500
+hits=$(nlc_counter negative_lookup_hit_count)
+misses=$(nlc_counter negative_lookup_miss_count)
+TEST ! stat $M0/dir/file501
+TEST ! stat $M0/dir/FILE1
+## both answered from the complete listing, none sent to the bricks
+TEST [ $(nlc_counter negative_lookup_hit_count) -ge $((hits + 2)) ]
+EXPECT "$misses" nlc_counter negative_lookup_miss_count
+
+## creates and removes through the same mount update the cache
+TEST touch $M0/dir/file501
+TEST stat $M0/dir/file501
+TEST rm $M0/dir/file1
+TEST ! stat $M0/dir/file1
+
+## and through another mount invalidate it
+TEST touch $M1/dir/file502
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" path_exists $M0/dir/file502
+TEST rm $M1/dir/file2
+EXPECT_WITHIN $UMOUNT_TIMEOUT "N" path_exists $M0/dir/file2
+
+EXPECT "500" echo $(ls $M0/dir | wc -l)
+TEST ! stat $M0/dir/file2
+TEST stat $M0/dir/file3
+
+TEST rm -rf $M0/dir
+TEST ! stat $M1/dir
+
+cleanup;
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+## open-behind: reads on anonymous fds and batched opens
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../fileio.rc
+
+function ob_counter {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.open-behind on
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.lazy-open on
+TEST $CLI volume set $V0 performance.read-after-open yes
+TEST $CLI volume set $V0 performance.open-behind-anonymous-fops on
+TEST $CLI volume set $V0 performance.open-behind-batch-size 8
+TEST ! $CLI volume set $V0 performance.open-behind-batch-size 4096
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+for i in $(seq 1 10); do
+        echo "file-$i" > $M0/file-$i
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# Files opened, read and closed are read on anonymous fds, their opens
+# are never sent even though read-after-open is on.
+for i in $(seq 1 10); do
+        EXPECT "file-$i" cat $M0/file-$i
+done
+TEST [ $(ob_counter opens_avoided) -ge 10 ]
+TEST [ $(ob_counter anonymous_fd_fops) -ge 10 ]
+
+# The first write sends the other pending opens for writing along.
+fd1=$(fd_available)
+TEST fd_open $fd1 "rw" $M0/file-1
+fd2=$(fd_available)
+TEST fd_open $fd2 "rw" $M0/file-2
+fd3=$(fd_available)
+TEST fd_open $fd3 "rw" $M0/file-3
+TEST fd_write $fd1 "write"
+TEST fd_close $fd1
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^[1-9]" ob_counter opens_batched
+TEST fd_close $fd2
+TEST fd_close $fd3
+EXPECT "file-2" cat $M0/file-2
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
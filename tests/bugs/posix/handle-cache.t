@@ -0,0 +1,52 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function brick_statedump_field {
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+function gfid_to_path {
+        getfattr --only-values -n glusterfs.gfidtopath $1 2>/dev/null
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.handle-cache-size 1024
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST mkdir -p $M0/a/b/c/d/e
+TEST touch $M0/a/b/c/d/e/file
+
+# Resolving the same ancestry twice is served from the cache.
+EXPECT "/a/b/c/d/e/file" gfid_to_path $M0/a/b/c/d/e/file
+EXPECT "/a/b/c/d/e/file" gfid_to_path $M0/a/b/c/d/e/file
+TEST [ $(brick_statedump_field handle_cache_hits) -gt 0 ]
+TEST [ $(brick_statedump_field handle_cache_entries) -ge 5 ]
+
+# Renaming and removing directories invalidate their entries.
+TEST mv $M0/a/b $M0/a/x
+EXPECT "/a/x/c/d/e/file" gfid_to_path $M0/a/x/c/d/e/file
+TEST mkdir $M0/a/x/c/d/e/sub
+TEST rmdir $M0/a/x/c/d/e/sub
+TEST mkdir $M0/a/x/c/d/e/sub
+TEST touch $M0/a/x/c/d/e/sub/file
+EXPECT "/a/x/c/d/e/sub/file" gfid_to_path $M0/a/x/c/d/e/sub/file
+
+# Turning the cache off empties it.
+TEST $CLI volume set $V0 storage.handle-cache-size 0
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" brick_statedump_field handle_cache_entries
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
@@ -0,0 +1,41 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function qr_cache_hits {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "cache-hit" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.qr-head-size 256KB
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=1
+head_md5=$(dd if=$M0/file bs=128k count=1 2>/dev/null | md5sum | cut -f1 -d' ')
+full_md5=$(md5sum $M0/file | cut -f1 -d' ')
+
+# The first 256KB of the file come back with the lookup after a remount
+# and serve reads of the head without going to the brick.
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "$head_md5" echo $(dd if=$M0/file bs=128k count=1 2>/dev/null | md5sum | cut -f1 -d' ')
+TEST [ $(qr_cache_hits) -gt 0 ]
+
+# Reads beyond the cached head still see the whole file.
+EXPECT "$full_md5" echo $(md5sum $M0/file | cut -f1 -d' ')
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
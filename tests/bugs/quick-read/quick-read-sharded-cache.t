@@ -0,0 +1,57 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function qr_stat {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.qr-cache-compression on
+TEST ! $CLI volume set $V0 performance.qr-cache-admission lfu
+TEST $CLI volume set $V0 performance.qr-cache-admission tinylfu
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+# compressible files, the cache holds fewer bytes than their size
+for i in {1..10}; do
+        yes $i | head -c 32768 > $M0/file$i
+done
+md5=$(md5sum $M0/file5 | cut -f1 -d' ')
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+for i in {1..10}; do
+        TEST cat $M0/file$i
+done
+EXPECT "$md5" echo $(md5sum $M0/file5 | cut -f1 -d' ')
+TEST [ $(qr_stat cache-hit) -gt 0 ]
+TEST [ $(qr_stat total_cache_used) -lt $(qr_stat total_cache_data) ]
+
+# a cache too small for every file evicts or rejects some of them
+TEST $CLI volume set $V0 performance.cache-size 1MB
+TEST $CLI volume set $V0 performance.qr-cache-compression off
+for i in {11..80}; do
+        TEST dd if=/dev/urandom of=$M0/file$i bs=32k count=1
+done
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+for i in {11..80}; do
+        TEST cat $M0/file$i
+done
+TEST [ $(( $(qr_stat cache-evictions) + $(qr_stat cache-admission-rejects) )) -gt 0 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
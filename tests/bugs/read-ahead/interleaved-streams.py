@@ -0,0 +1,35 @@
+#
+# Read a file as two interleaved sequential streams on one fd, and check
+# the data against a copy of the file.
+#
+
+import os
+import sys
+
+CHUNK = 32 * 1024
+
+
+def main(path, reference):
+    fd = os.open(path, os.O_RDONLY)
+    ref = open(reference, 'rb').read()
+    half = len(ref) // 2
+    streams = [0, half]
+    ends = [half, len(ref)]
+
+    while streams[0] < ends[0] or streams[1] < ends[1]:
+        for i in (0, 1):
+            if streams[i] >= ends[i]:
+                continue
+            size = min(CHUNK, ends[i] - streams[i])
+            data = os.pread(fd, size, streams[i])
+            if data != ref[streams[i]:streams[i] + size]:
+                sys.stderr.write("mismatch at %d\n" % streams[i])
+                return 1
+            streams[i] += size
+
+    os.close(fd)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1], sys.argv[2]))
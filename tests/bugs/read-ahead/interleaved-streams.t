@@ -0,0 +1,68 @@
+#!/bin/bash
+
+## read-ahead for interleaved sequential streams on one fd
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function ra_counter {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep -A 20 "read-ahead.priv" $statedump | grep "^$1=" | \
+                cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+## reads the file as two interleaved streams, out of the page cache, and
+## prints the pages read ahead for them and the pages read from the bricks
+function interleaved_read {
+        local hits=$(ra_counter page_hits)
+        local faults=$(ra_counter page_faults)
+        local reader=$(dirname $0)/interleaved-streams.py
+
+        drop_cache $M0
+        $PYTHON $reader $M0/file $B0/ref || return 1
+        echo "$(($(ra_counter page_hits) - hits))" \
+             "$(($(ra_counter page_faults) - faults))"
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.read-ahead on
+TEST $CLI volume set $V0 performance.read-ahead-stream-count 4
+TEST $CLI volume set $V0 performance.read-ahead-cache-size 64MB
+TEST ! $CLI volume set $V0 performance.read-ahead-stream-count 0
+TEST ! $CLI volume set $V0 performance.read-ahead-stream-count 17
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/ref bs=1M count=8
+TEST cp $B0/ref $M0/file
+
+## each stream is read ahead: most pages are found ready
+read -r hits faults <<< "$(interleaved_read)"
+TEST [ -n "$faults" ]
+TEST [ $hits -gt $faults ]
+streams_faults=$faults
+
+## a small cache still gives the right data
+TEST $CLI volume set $V0 performance.read-ahead-cache-size 256KB
+TEST interleaved_read
+
+## one stream, as before: the streams keep replacing each other and
+## their pages are read from the bricks as the application asks for them
+TEST $CLI volume set $V0 performance.read-ahead-cache-size 64MB
+TEST $CLI volume set $V0 performance.read-ahead-stream-count 1
+read -r hits faults <<< "$(interleaved_read)"
+TEST [ -n "$faults" ]
+TEST [ $faults -gt $streams_faults ]
+
+rm -f $B0/ref
+cleanup;
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function rda_stat {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.readdir-ahead on
+TEST $CLI volume set $V0 performance.md-cache-timeout 1
+TEST ! $CLI volume set $V0 performance.rda-listing-timeout 601
+TEST $CLI volume set $V0 performance.rda-listing-timeout 60
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+TEST mkdir $M0/dir
+for i in {1..50}; do
+        echo $i > $M0/dir/file$i
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+EXPECT "50" echo $(ls $M0/dir | wc -l)
+
+# md-cache has expired the entries, the stats are answered from the listing
+sleep 2
+TEST stat $M0/dir/file{1..50}
+TEST [ $(rda_stat rda_listing_hits) -ge 50 ]
+
+# changes made from this mount are seen right away
+TEST chmod 0600 $M0/dir/file1
+EXPECT "600" stat -c %a $M0/dir/file1
+TEST mv $M0/dir/file2 $M0/dir/file3
+EXPECT "2" cat $M0/dir/file3
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
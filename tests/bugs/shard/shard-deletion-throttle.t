@@ -0,0 +1,55 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function shard_statedump_field {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+function shard_count {
+        ls $B0/${V0}0/.shard | grep -c $1
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 features.shard-block-size 4MB
+TEST $CLI volume set $V0 features.shard-deletion-max-rate 10
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# One 4k write into each of blocks 1..40 leaves 40 shards behind the base file.
+for i in {1..40}; do
+        dd if=/dev/zero of=$M0/image bs=4k count=1 seek=$((i * 1024)) \
+           conv=notrunc 2>/dev/null
+done
+gfid=$(get_gfid_string $M0/image)
+EXPECT "40" shard_count $gfid
+
+start=$(date +%s)
+TEST rm -f $M0/image
+EXPECT_WITHIN 30 "0" shard_count $gfid
+end=$(date +%s)
+
+# 10 shards a second: clearing 40 of them cannot take less than 3 seconds.
+TEST [ $((end - start)) -ge 3 ]
+EXPECT_WITHIN 5 "40" shard_statedump_field deletion-shards-deleted
+EXPECT_WITHIN 5 "1" shard_statedump_field deletion-files-completed
+EXPECT_WITHIN 5 "none" shard_statedump_field deletion-state
+
+# Lifting the limit is picked up on the fly.
+TEST $CLI volume set $V0 features.shard-deletion-max-rate 0
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" shard_statedump_field deletion-max-rate
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function shard_statedump_field {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep "^$1=" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0,1,2}
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 features.shard-block-size 4MB
+TEST $CLI volume set $V0 features.shard-prefetch-count 4
+TEST $CLI volume set $V0 features.shard-per-file-inode-cache 16
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# A preallocated image: all 16 shards are holes within EOF.
+TEST truncate -s 64M $M0/image
+TEST dd if=/dev/urandom of=$M0/image bs=1M count=64 conv=notrunc
+md5=$(md5sum $M0/image | awk '{print $1}')
+
+# Sequential writes into the holes had the shards ahead of them created in
+# the background, and no shard was created beyond EOF.
+TEST [ $(shard_statedump_field shards-prefetched) -gt 0 ]
+EXPECT "15" echo $(ls $B0/${V0}0/.shard | grep -c $(get_gfid_string $M0/image))
+
+# Re-reading the file resolves its shards from the per-file cache.
+TEST dd if=$M0/image of=/dev/null bs=1M
+TEST [ $(shard_statedump_field inode-cache-hits) -gt 0 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "$md5" echo $(md5sum $M0/image | awk '{print $1}')
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
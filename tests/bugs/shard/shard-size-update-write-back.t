@@ -0,0 +1,63 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../fileio.rc
+
+function size_xattrops_sent {
+        local statedump=$(generate_mount_statedump $V0 $1)
+        grep "size-xattrops-sent" $statedump | cut -f2 -d'=' | tail -1
+        rm -f $statedump
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0,1,2}
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 features.shard-block-size 4MB
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# Baseline: one size xattrop per extending write.
+TEST dd if=/dev/zero of=$M0/wt bs=4k count=256 conv=notrunc
+wt_count=$(size_xattrops_sent $M0)
+TEST [ $wt_count -ge 256 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume set $V0 features.shard-size-update-mode write-back
+TEST $CLI volume set $V0 features.shard-size-update-batch 64
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# The same workload only pays for one xattrop per batch plus the flush.
+TEST dd if=/dev/zero of=$M0/wb bs=4k count=256 conv=notrunc
+wb_count=$(size_xattrops_sent $M0)
+TEST [ $wb_count -le 8 ]
+EXPECT "1048576" stat -c %s $M0/wb
+
+# Deltas held back by a writer that neither flushes nor fsyncs must reach
+# the bricks once the write-back interval expires.
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M1
+TEST fd=`fd_available`
+TEST fd_open $fd 'w' "$M0/wb-open"
+TEST fd_write $fd "abcdefgh"
+EXPECT_WITHIN 5 "9" stat -c %s $M1/wb-open
+TEST fd_close $fd
+
+# Sizes survive a remount.
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "1048576" stat -c %s $M0/wt
+EXPECT "1048576" stat -c %s $M0/wb
+EXPECT "9" stat -c %s $M0/wb-open
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
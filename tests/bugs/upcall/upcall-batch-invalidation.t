@@ -0,0 +1,56 @@
+#!/bin/bash
+
+## cache invalidations batched per client and collapsed per gfid
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function upcall_client_stat {
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}1)
+        grep -a "^$1=" $statedump | cut -f2 -d'=' | awk '{s += $1} END {print (s > 0) ? "Y" : "N"}'
+        rm -f $statedump
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}1
+TEST $CLI volume set $V0 features.cache-invalidation on
+TEST $CLI volume set $V0 features.cache-invalidation-timeout 600
+TEST $CLI volume set $V0 features.cache-invalidation-batch-window 200
+TEST $CLI volume set $V0 features.cache-invalidation-batch-size 16
+TEST ! $CLI volume set $V0 features.cache-invalidation-batch-window 5000
+TEST ! $CLI volume set $V0 features.cache-invalidation-batch-size 0
+TEST $CLI volume set $V0 performance.cache-invalidation on
+TEST $CLI volume set $V0 performance.md-cache-timeout 600
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1
+
+TEST mkdir $M0/dir1
+TEST touch $M0/dir1/file{1..40}
+
+## cache the entries in M1
+TEST ls -l $M1/dir1/
+
+## changes from M0 reach M1 after the batch window
+echo "hello" > $M0/dir1/file2
+EXPECT_WITHIN $UMOUNT_TIMEOUT "6" stat -c %s $M1/dir1/file2
+
+## more than batch-size invalidations, the parent dir collapsed
+TEST rm -f $M0/dir1/file{10..40}
+EXPECT_WITHIN $UMOUNT_TIMEOUT "9" echo $(ls $M1/dir1 | wc -l)
+
+EXPECT "Y" upcall_client_stat sent
+EXPECT "Y" upcall_client_stat callbacks
+EXPECT "Y" upcall_client_stat collapsed
+
+## back to one notification at a time
+TEST $CLI volume set $V0 features.cache-invalidation-batch-window 0
+echo "hello world" > $M0/dir1/file3
+EXPECT_WITHIN $UMOUNT_TIMEOUT "12" stat -c %s $M1/dir1/file3
+
+cleanup;
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+## write-behind: vectored aggregation and a dirty-budget shared by all the
+## files being written
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function wb_counter {
+        local statedump=$(generate_mount_statedump $V0 $M0)
+        grep -a -A20 "xlator.performance.write-behind.priv" $statedump | \
+                grep "^$1=" | cut -f2 -d'=' | head -1
+        rm -f $statedump
+}
+
+function md5 {
+        md5sum < $1 | cut -d' ' -f1
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+
+TEST $CLI volume create $V0 $H0:$B0/$V0;
+TEST $CLI volume set $V0 performance.write-behind-aggregate-mode vector
+TEST $CLI volume set $V0 performance.aggregate-size 1MB
+TEST $CLI volume set $V0 performance.write-behind-dirty-budget 2MB
+TEST $CLI volume set $V0 performance.write-behind-trickling-writes off
+TEST ! $CLI volume set $V0 performance.write-behind-aggregate-mode zero-copy
+TEST $CLI volume start $V0;
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+TEST dd if=/dev/urandom of=$B0/ref bs=1M count=4
+ref=$(md5 $B0/ref)
+small=$(head -c 1M $B0/ref | md5sum | cut -d' ' -f1)
+
+## 16 contiguous 256KB writes of one file go down as vectored writes of up
+## to 4 of them (aggregate-size); at most 2 per writev means the requests
+## chained behind a head are not aggregated
+writevs=$(wb_counter fulfilled)
+requests=$(wb_counter fulfilled_requests)
+TEST dd if=$B0/ref of=$M0/aggregated bs=256k conv=fsync
+writevs=$(($(wb_counter fulfilled) - writevs))
+requests=$(($(wb_counter fulfilled_requests) - requests))
+EXPECT "16" echo $requests
+TEST [ $((requests)) -gt $((2 * writevs)) ]
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$ref" md5 $B0/$V0/aggregated
+
+## many files written at once, with large and small writes
+for i in {1..64}; do
+        dd if=$B0/ref of=$M0/big$i bs=256k 2>/dev/null &
+        dd if=$B0/ref of=$M0/small$i bs=4k count=256 2>/dev/null &
+done
+wait
+
+for i in {1..64}; do
+        EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$ref" md5 $B0/$V0/big$i
+        EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$small" md5 $B0/$V0/small$i
+done
+
+## lowering the budget and going back to copying on a live mount
+TEST $CLI volume set $V0 performance.write-behind-dirty-budget 512KB
+TEST $CLI volume set $V0 performance.write-behind-aggregate-mode copy
+TEST dd if=$B0/ref of=$M0/copy bs=64k
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$ref" md5 $B0/$V0/copy
+
+TEST $CLI volume reset $V0 performance.write-behind-dirty-budget
+TEST dd if=$B0/ref of=$M0/window bs=64k
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$ref" md5 $B0/$V0/window
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
@@ -599,6 +599,8 @@ testcase9_recall_conflict_lease()
     obj = glfs_h_lookupat(client2, NULL, TEST_FILE, NULL, 0);
     ret = glfs_h_lease(client2, obj, &lease);
     VERIFY_RESULT(2, ret, SHUD_FAIL);
+    /* a refused lease can be retried later */
+    VERIFY_RESULT(6, errno, EAGAIN);
 
     ret = unlk_write_lease(fd1, lid1);
     VERIFY_RESULT(5, ret, SHUD_PASS);
@@ -644,6 +646,41 @@ error:
     return -1;
 }
 
+static int
+testcase11_rd_lease_unleased_read()
+{
+    glfs_fd_t *fd1 = NULL;
+    glfs_fd_t *fd3 = NULL;
+    char buf[16] = "";
+    int ret = 0;
+
+    fprintf(log_file, "\n Basic test case for reads without lease id on a "
+                      "read lease:");
+    OPEN(client1, O_RDONLY, fd1, lid1);
+    ret = set_read_lease(fd1, lid1);
+    VERIFY_RESULT(1, ret, SHUD_PASS);
+
+    /* no lease id: reads do not recall read leases */
+    OPEN(client3, O_RDONLY, fd3, lid4);
+    ret = glfs_pread(fd3, buf, sizeof(buf), 0, 0, NULL);
+    VERIFY_RESULT(2, (ret < 0), 0);
+
+    ret = get_lease(fd1, lid1);
+    VERIFY_RESULT(3, ret, GLFS_RD_LEASE);
+
+    ret = unlk_read_lease(fd1, lid1);
+    VERIFY_RESULT(4, ret, SHUD_PASS);
+
+    ret = glfs_close(fd3);
+    VERIFY_RESULT(5, ret, SHUD_PASS);
+    ret = glfs_close(fd1);
+    VERIFY_RESULT(6, ret, SHUD_PASS);
+
+    return 0;
+error:
+    return -1;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -706,6 +743,9 @@ main(int argc, char *argv[])
     ret = testcase10_recall_open_conflict();
     VERIFY_RESULT(110, ret, SHUD_PASS);
 
+    ret = testcase11_rd_lease_unleased_read();
+    VERIFY_RESULT(111, ret, SHUD_PASS);
+
     glfs_fini(client1);
     glfs_fini(client2);
     glfs_fini(client3);
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup
+
+LOCK_STORM=$(dirname $0)/../../extras/benchmarking/glfs-lock-storm.c
+
+# Drive the locks xlator in isolation, stacked straight on a posix brick,
+# with enough byte-range locks on one file to make list scans show up.
+TEST build_tester $LOCK_STORM -lgfapi
+TEST mkdir -p $B0/storm
+TEST $(dirname $LOCK_STORM)/glfs-lock-storm $B0/storm 20000
+
+# Taking, probing and releasing the same number of locks once more must
+# leave nothing behind from the previous run.
+TEST $(dirname $LOCK_STORM)/glfs-lock-storm $B0/storm 2000
+
+cleanup_tester $(dirname $LOCK_STORM)/glfs-lock-storm
+
+cleanup
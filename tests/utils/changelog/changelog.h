@@ -112,6 +112,56 @@ int
 gf_changelog_register_generic(struct gf_brick_spec *bricks, int count,
                               int ordered, char *logfile, int lvl, void *xl);
 
+/**
+ * Reader for changelogs written with the "indexed" encoding. Records can be
+ * filtered by type, fop, gfid prefix and time; whole changelogs and records
+ * that cannot match are skipped without being parsed.
+ */
+
+/* record types (gf_changelog_filter_t.types) */
+#define GF_CHANGELOG_TYPE_DATA (1 << 0)
+#define GF_CHANGELOG_TYPE_METADATA (1 << 1)
+#define GF_CHANGELOG_TYPE_ENTRY (1 << 2)
+
+typedef struct gf_changelog_reader gf_changelog_reader_t;
+
+/* zeroed fields match everything */
+typedef struct gf_changelog_filter {
+    unsigned int types;    /* GF_CHANGELOG_TYPE_* */
+    const int *fops;       /* GF_FOP_* values; data records have no fop */
+    int nr_fops;
+    const unsigned char *gfid_prefix; /* leading bytes of the gfid */
+    size_t gfid_prefix_len;           /* at most 16 */
+    unsigned long start; /* records logged at or after this time */
+    unsigned long end;   /* ... and at or before this one, if non-zero */
+} gf_changelog_filter_t;
+
+/* the pointers are valid until the reader is closed */
+typedef struct gf_changelog_record {
+    char type; /* 'D', 'M' or 'E' */
+    int fop;   /* GF_FOP_*, 0 for data records */
+    unsigned long time;
+    unsigned char gfid[16];
+    int nr_fields;      /* number of strings in @fields */
+    const char *fields; /* '\0' terminated, as in the ascii encoding */
+    size_t fields_len;
+} gf_changelog_record_t;
+
+gf_changelog_reader_t *
+gf_changelog_reader_open(const char *path);
+
+int
+gf_changelog_reader_filter(gf_changelog_reader_t *reader,
+                           const gf_changelog_filter_t *filter);
+
+/* returns 1 when @record is filled, 0 at the end and -1 on error */
+int
+gf_changelog_reader_next(gf_changelog_reader_t *reader,
+                         gf_changelog_record_t *record);
+
+void
+gf_changelog_reader_close(gf_changelog_reader_t *reader);
+
 int
 gf_history_changelog(char *changelog_dir, unsigned long start,
                      unsigned long end, int n_parallel,
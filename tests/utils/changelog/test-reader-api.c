@@ -0,0 +1,118 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/**
+ * count the records of indexed changelogs that match a filter
+ *
+ * usage: test-reader-api <D|M|E|-> <gfid|-> <changelog>...
+ *
+ * Compile it using:
+ *  gcc -o test-reader-api `pkg-config --cflags libgfchangelog` \
+ *  test-reader-api.c `pkg-config --libs libgfchangelog`
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "changelog.h"
+
+static int
+parse_gfid(const char *str, unsigned char *gfid)
+{
+    int i = 0;
+    unsigned int byte = 0;
+
+    for (i = 0; i < 16 && *str; i++) {
+        if (*str == '-')
+            str++;
+        if (sscanf(str, "%2x", &byte) != 1)
+            return -1;
+        gfid[i] = byte;
+        str += 2;
+    }
+
+    return i;
+}
+
+int
+main(int argc, char **argv)
+{
+    int i = 0;
+    int ret = 0;
+    long count = 0;
+    unsigned char gfid[16] = {
+        0,
+    };
+    gf_changelog_filter_t filter = {
+        0,
+    };
+    gf_changelog_record_t record = {
+        0,
+    };
+    gf_changelog_reader_t *reader = NULL;
+
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <D|M|E|-> <gfid|-> <changelog>...\n",
+                argv[0]);
+        return 1;
+    }
+
+    switch (argv[1][0]) {
+        case 'D':
+            filter.types = GF_CHANGELOG_TYPE_DATA;
+            break;
+        case 'M':
+            filter.types = GF_CHANGELOG_TYPE_METADATA;
+            break;
+        case 'E':
+            filter.types = GF_CHANGELOG_TYPE_ENTRY;
+            break;
+    }
+
+    if (strcmp(argv[2], "-")) {
+        ret = parse_gfid(argv[2], gfid);
+        if (ret <= 0) {
+            fprintf(stderr, "bad gfid %s\n", argv[2]);
+            return 1;
+        }
+        filter.gfid_prefix = gfid;
+        filter.gfid_prefix_len = ret;
+    }
+
+    for (i = 3; i < argc; i++) {
+        reader = gf_changelog_reader_open(argv[i]);
+        if (!reader) {
+            fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+
+        if (gf_changelog_reader_filter(reader, &filter)) {
+            fprintf(stderr, "filter: %s\n", strerror(errno));
+            return 1;
+        }
+
+        while ((ret = gf_changelog_reader_next(reader, &record)) == 1)
+            count++;
+
+        gf_changelog_reader_close(reader);
+
+        if (ret < 0) {
+            fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+    }
+
+    printf("%ld\n", count);
+
+    return 0;
+}
@@ -2254,8 +2254,11 @@ afr_attempt_readsubvol_set(call_frame_t *frame, xlator_t *this,
                "subvols for %s",
                local->loc.path);
     }
-    if (*read_subvol >= 0)
+    if (*read_subvol >= 0) {
         dict_del_sizen(local->replies[*read_subvol].xdata, GF_CONTENT_KEY);
+        dict_del_sizen(local->replies[*read_subvol].xdata,
+                       GF_CONTENT_HEAD_KEY);
+    }
 }
 
 static void
@@ -2399,6 +2402,8 @@ afr_lookup_done(call_frame_t *frame, xlator_t *this)
         if (ret) {
             afr_inode_need_refresh_set(local->inode, this);
             dict_del_sizen(local->replies[read_subvol].xdata, GF_CONTENT_KEY);
+            dict_del_sizen(local->replies[read_subvol].xdata,
+                           GF_CONTENT_HEAD_KEY);
         }
     } else {
     cant_interpret:
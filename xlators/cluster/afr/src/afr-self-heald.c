@@ -301,7 +301,8 @@ afr_shd_selfheal_name(struct subvol_healer *healer, int child, uuid_t parent,
 }
 
 int
-afr_shd_selfheal(struct subvol_healer *healer, int child, uuid_t gfid)
+afr_shd_selfheal(struct subvol_healer *healer, int child, uuid_t gfid,
+                 ia_type_t type)
 {
     int ret = 0;
     eh_t *eh = NULL;
@@ -336,6 +337,10 @@ afr_shd_selfheal(struct subvol_healer *healer, int child, uuid_t gfid)
             crawl_event->heal_failed_count++;
         } else if (ret == 0) {
             crawl_event->healed_count++;
+            if (type == IA_IFDIR)
+                crawl_event->dir_healed_count++;
+            else
+                crawl_event->file_healed_count++;
         }
     }
     UNLOCK(&priv->lock);
@@ -370,6 +375,9 @@ afr_shd_sweep_prepare(struct subvol_healer *healer)
     event->healed_count = 0;
     event->split_brain_count = 0;
     event->heal_failed_count = 0;
+    event->dir_healed_count = 0;
+    event->file_healed_count = 0;
+    event->pending_count = 0;
 
     time(&event->start_time);
     event->end_time = 0;
@@ -421,7 +429,8 @@ afr_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
 
     inode_ctx_get2(parent->inode, subvol, NULL, &val);
 
-    ret = afr_shd_selfheal(healer, healer->subvol, gfid);
+    ret = afr_shd_selfheal(healer, healer->subvol, gfid,
+                           entry->d_stat.ia_type);
 
     if (ret == -ENOENT || ret == -ESTALE)
         afr_shd_index_purge(subvol, parent->inode, entry->d_name, val);
@@ -471,9 +480,16 @@ afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
         goto out;
     }
 
-    ret = syncop_mt_dir_scan(frame, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
-                             healer, afr_shd_index_heal, xdata,
-                             priv->shd.max_threads, priv->shd.wait_qlength);
+    if (priv->shd.phased)
+        ret = syncop_mt_dir_scan_phased(
+            frame, subvol, &loc, GF_CLIENT_PID_SELF_HEALD, healer,
+            afr_shd_index_heal, xdata, priv->shd.max_threads,
+            priv->shd.wait_qlength);
+    else
+        ret = syncop_mt_dir_scan(frame, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
+                                 healer, afr_shd_index_heal, xdata,
+                                 priv->shd.max_threads,
+                                 priv->shd.wait_qlength);
 
     if (ret == 0)
         ret = healer->crawl_event.healed_count;
@@ -535,7 +551,8 @@ afr_shd_full_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
     afr_shd_selfheal_name(healer, healer->subvol, parent->inode->gfid,
                           entry->d_name);
 
-    afr_shd_selfheal(healer, healer->subvol, entry->d_stat.ia_gfid);
+    afr_shd_selfheal(healer, healer->subvol, entry->d_stat.ia_gfid,
+                     entry->d_stat.ia_type);
 
     return 0;
 }
@@ -851,6 +868,7 @@ afr_shd_index_healer(void *data)
     int ret = 0;
     afr_private_t *priv = NULL;
     dict_t *pre_crawl_xdata = NULL;
+    uint64_t pending = 0;
     loc_t loc = {
         0,
     };
@@ -879,6 +897,13 @@ afr_shd_index_healer(void *data)
 
             afr_shd_sweep_prepare(healer);
 
+            /* what the crawl has to get through, for the ETA */
+            if (!afr_shd_get_index_count(this, healer->subvol, &pending)) {
+                LOCK(&priv->lock);
+                healer->crawl_event.pending_count = pending;
+                UNLOCK(&priv->lock);
+            }
+
             ret = afr_shd_index_sweep_all(healer);
 
             afr_shd_sweep_done(healer);
@@ -1031,6 +1056,9 @@ afr_shd_dict_add_crawl_event(xlator_t *this, dict_t *output,
     uint64_t healed_count = 0;
     uint64_t split_brain_count = 0;
     uint64_t heal_failed_count = 0;
+    uint64_t done = 0;
+    int64_t elapsed = 0;
+    int64_t eta = -1;
     char *start_time_str = 0;
     char *end_time_str = NULL;
     char *crawl_type = NULL;
@@ -1046,6 +1074,17 @@ afr_shd_dict_add_crawl_event(xlator_t *this, dict_t *output,
     if (!crawl_event->start_time)
         goto out;
 
+    if (crawl_event->end_time)
+        elapsed = crawl_event->end_time - crawl_event->start_time;
+    else
+        elapsed = time(NULL) - crawl_event->start_time;
+
+    /* the entries left, at the rate they were handled so far */
+    done = healed_count + split_brain_count + heal_failed_count;
+    if (!crawl_event->end_time && done && elapsed > 0 &&
+        (crawl_event->pending_count > done))
+        eta = (crawl_event->pending_count - done) * elapsed / done;
+
     start_time_str = gf_strdup(ctime(&crawl_event->start_time));
 
     if (crawl_event->end_time)
@@ -1094,6 +1133,46 @@ afr_shd_dict_add_crawl_event(xlator_t *this, dict_t *output,
         goto out;
     }
 
+    snprintf(key, sizeof(key), "statistics_dir_healed_cnt-%s", suffix);
+    ret = dict_set_uint64(output, key, crawl_event->dir_healed_count);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, AFR_MSG_DICT_SET_FAILED,
+               "Could not add statistics_dir_healed_count to output");
+        goto out;
+    }
+
+    snprintf(key, sizeof(key), "statistics_file_healed_cnt-%s", suffix);
+    ret = dict_set_uint64(output, key, crawl_event->file_healed_count);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, AFR_MSG_DICT_SET_FAILED,
+               "Could not add statistics_file_healed_count to output");
+        goto out;
+    }
+
+    snprintf(key, sizeof(key), "statistics_pending_cnt-%s", suffix);
+    ret = dict_set_uint64(output, key, crawl_event->pending_count);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, AFR_MSG_DICT_SET_FAILED,
+               "Could not add statistics_pending_count to output");
+        goto out;
+    }
+
+    snprintf(key, sizeof(key), "statistics_elapsed-%s", suffix);
+    ret = dict_set_int64(output, key, elapsed);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, AFR_MSG_DICT_SET_FAILED,
+               "Could not add statistics_elapsed to output");
+        goto out;
+    }
+
+    snprintf(key, sizeof(key), "statistics_eta-%s", suffix);
+    ret = dict_set_int64(output, key, eta);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, AFR_MSG_DICT_SET_FAILED,
+               "Could not add statistics_eta to output");
+        goto out;
+    }
+
     keylen = snprintf(key, sizeof(key), "statistics_strt_time-%s", suffix);
     ret = dict_set_dynstrn(output, key, keylen, start_time_str);
     if (ret) {
@@ -23,6 +23,10 @@ typedef struct {
     uint64_t healed_count;
     uint64_t split_brain_count;
     uint64_t heal_failed_count;
+    uint64_t dir_healed_count;
+    uint64_t file_healed_count;
+    /* entries in the xattrop index when the crawl started */
+    uint64_t pending_count;
 
     /* If start_time is 0, it means crawler is not in progress
        and stats are not valid */
@@ -57,6 +61,7 @@ typedef struct {
     uint32_t max_threads;
     uint32_t wait_qlength;
     uint32_t halo_max_latency_msec;
+    gf_boolean_t phased; /* shd-heal-scheduler is "phased" */
 } afr_self_heald_t;
 
 int
@@ -69,6 +74,9 @@ int
 afr_shd_gfid_to_path(xlator_t *this, xlator_t *subvol, uuid_t gfid,
                      char **path_p);
 
+int
+afr_shd_get_index_count(xlator_t *this, int i, uint64_t *count);
+
 int
 afr_shd_index_purge(xlator_t *subvol, inode_t *inode, char *name,
                     ia_type_t type);
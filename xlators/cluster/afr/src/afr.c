@@ -146,6 +146,7 @@ reconfigure(xlator_t *this, dict_t *options)
     int index = -1;
     char *qtype = NULL;
     char *fav_child_policy = NULL;
+    char *heal_scheduler = NULL;
     char *data_self_heal = NULL;
     char *data_self_heal_algorithm = NULL;
     char *locking_scheme = NULL;
@@ -277,6 +278,9 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("shd-wait-qlength", priv->shd.wait_qlength, options,
                      uint32, out);
 
+    GF_OPTION_RECONF("shd-heal-scheduler", heal_scheduler, options, str, out);
+    priv->shd.phased = !strcmp(heal_scheduler, "phased");
+
     GF_OPTION_RECONF("favorite-child-policy", fav_child_policy, options, str,
                      out);
     if (afr_set_favorite_child_policy(priv, fav_child_policy) == -1)
@@ -396,6 +400,7 @@ init(xlator_t *this)
     int read_subvol_index = -1;
     char *qtype = NULL;
     char *fav_child_policy = NULL;
+    char *heal_scheduler = NULL;
     char *thin_arbiter = NULL;
     char *data_self_heal = NULL;
     char *locking_scheme = NULL;
@@ -477,6 +482,9 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("shd-wait-qlength", priv->shd.wait_qlength, uint32, out);
 
+    GF_OPTION_INIT("shd-heal-scheduler", heal_scheduler, str, out);
+    priv->shd.phased = !strcmp(heal_scheduler, "phased");
+
     GF_OPTION_INIT("background-self-heal-count",
                    priv->background_self_heal_count, uint32, out);
 
@@ -1215,6 +1223,18 @@ struct volume_options options[] = {
         .description = "This option can be used to control number of heals"
                        " that can wait in SHD per subvolume",
     },
+    {.key = {"shd-heal-scheduler"},
+     .type = GF_OPTION_TYPE_STR,
+     .value = {"fifo", "phased"},
+     .default_value = "fifo",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"replicate"},
+     .description = "Order in which SHD heals the entries of the indices. "
+                    "'fifo' heals them in index order, directories one at "
+                    "a time. 'phased' heals the directories of each batch "
+                    "of entries read first, shd-max-threads at a time, "
+                    "then the files, the biggest first."},
     {
         .key = {"locking-scheme"},
         .type = GF_OPTION_TYPE_STR,
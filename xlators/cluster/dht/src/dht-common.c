@@ -10804,6 +10804,11 @@ dht_notify(xlator_t *this, int event, void *data, ...)
         }
         case GF_EVENT_UPCALL:
             up_data = (struct gf_upcall *)data;
+            /* lease holders above have to hear about recalls */
+            if (up_data->event_type == GF_UPCALL_RECALL_LEASE) {
+                propagate = 1;
+                break;
+            }
             if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
                 break;
             up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
@@ -348,6 +348,9 @@ struct dht_local {
 
     glusterfs_fop_t fop;
 
+    /* directory leases, taken on all subvolumes */
+    struct gf_lease lease;
+
     gf_boolean_t linked;
     xlator_t *link_subvol;
 
@@ -1096,6 +1096,102 @@ dht_lease_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     return 0;
 }
 
+static int
+dht_lease_dir_unlock_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                         int op_ret, int op_errno, struct gf_lease *lease,
+                         dict_t *xdata)
+{
+    dht_local_t *local = frame->local;
+    int this_call_cnt = 0;
+
+    this_call_cnt = dht_frame_return(frame);
+    if (is_last_call(this_call_cnt))
+        DHT_STACK_UNWIND(lease, frame, -1, local->op_errno, &local->lease,
+                         NULL);
+
+    return 0;
+}
+
+static int
+dht_lease_dir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, struct gf_lease *lease,
+                  dict_t *xdata)
+{
+    dht_local_t *local = frame->local;
+    dht_conf_t *conf = this->private;
+    xlator_t *prev = cookie;
+    int this_call_cnt = 0;
+    int i = 0;
+
+    LOCK(&frame->lock);
+    {
+        if (op_ret < 0) {
+            gf_msg_debug(this->name, op_errno, "lease on %s failed on %s",
+                         local->loc.path, prev->name);
+            local->op_ret = -1;
+            local->op_errno = op_errno;
+        } else if (lease) {
+            local->lease.lease_type = lease->lease_type;
+        }
+    }
+    UNLOCK(&frame->lock);
+
+    this_call_cnt = dht_frame_return(frame);
+    if (!is_last_call(this_call_cnt))
+        return 0;
+
+    if ((local->op_ret < 0) && (local->lease.cmd == GF_SET_LEASE)) {
+        /* a lease held on only some subvolumes would not see the entries
+         * changed on the others, give back the ones granted. Unlocking
+         * where no lease was granted does nothing. */
+        local->lease.cmd = GF_UNLK_LEASE;
+        local->call_cnt = conf->subvolume_cnt;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+            STACK_WIND_COOKIE(frame, dht_lease_dir_unlock_cbk,
+                              conf->subvolumes[i], conf->subvolumes[i],
+                              conf->subvolumes[i]->fops->lease, &local->loc,
+                              &local->lease, NULL);
+        }
+        return 0;
+    }
+
+    DHT_STACK_UNWIND(lease, frame, local->op_ret, local->op_errno,
+                     &local->lease, NULL);
+    return 0;
+}
+
+/* Entries of a directory are created on the subvolumes they hash to, a
+ * lease on a directory is taken on all of them. */
+static int
+dht_lease_dir(call_frame_t *frame, xlator_t *this, loc_t *loc,
+              struct gf_lease *lease, dict_t *xdata)
+{
+    dht_conf_t *conf = this->private;
+    dht_local_t *local = NULL;
+    int call_cnt = 0;
+    int i = 0;
+
+    local = dht_local_init(frame, loc, NULL, GF_FOP_LEASE);
+    if (!local) {
+        DHT_STACK_UNWIND(lease, frame, -1, ENOMEM, NULL, NULL);
+        return 0;
+    }
+
+    local->op_ret = 0;
+    local->op_errno = 0;
+    local->lease = *lease;
+    local->call_cnt = call_cnt = conf->subvolume_cnt;
+
+    for (i = 0; i < call_cnt; i++) {
+        STACK_WIND_COOKIE(frame, dht_lease_dir_cbk, conf->subvolumes[i],
+                          conf->subvolumes[i],
+                          conf->subvolumes[i]->fops->lease, loc, lease, xdata);
+    }
+
+    return 0;
+}
+
 int
 dht_lease(call_frame_t *frame, xlator_t *this, loc_t *loc,
           struct gf_lease *lease, dict_t *xdata)
@@ -1106,6 +1202,10 @@ dht_lease(call_frame_t *frame, xlator_t *this, loc_t *loc,
     VALIDATE_OR_GOTO(frame, err);
     VALIDATE_OR_GOTO(this, err);
     VALIDATE_OR_GOTO(loc, err);
+    VALIDATE_OR_GOTO(loc->inode, err);
+
+    if (IA_ISDIR(loc->inode->ia_type))
+        return dht_lease_dir(frame, this, loc, lease, xdata);
 
     subvol = dht_subvol_get_cached(this, loc->inode);
     if (!subvol) {
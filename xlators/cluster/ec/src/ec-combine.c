@@ -238,6 +238,7 @@ gf_boolean_t
 ec_value_ignore(char *key)
 {
     if ((strcmp(key, GF_CONTENT_KEY) == 0) ||
+        (strcmp(key, GF_CONTENT_HEAD_KEY) == 0) ||
         (strcmp(key, GF_XATTR_PATHINFO_KEY) == 0) ||
         (strcmp(key, GF_XATTR_USER_PATHINFO_KEY) == 0) ||
         (strcmp(key, GF_XATTR_LOCKINFO_KEY) == 0) ||
@@ -762,6 +762,7 @@ ec_manager_lookup(ec_fop_data_t *fop, int32_t state)
             } else {
                 /*TODO: To be handled once we have 'syndromes' */
                 dict_del(fop->xdata, GF_CONTENT_KEY);
+                dict_del(fop->xdata, GF_CONTENT_HEAD_KEY);
             }
             err = dict_set_uint64(fop->xdata, EC_XATTR_SIZE, 0);
             if (err == 0) {
@@ -246,9 +246,16 @@ ec_shd_index_sweep(struct subvol_healer *healer)
     }
 
     _mask_cancellation();
-    ret = syncop_mt_dir_scan(NULL, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
-                             healer, ec_shd_index_heal, xdata,
-                             ec->shd.max_threads, ec->shd.wait_qlength);
+    if (ec->shd.phased)
+        ret = syncop_mt_dir_scan_phased(NULL, subvol, &loc,
+                                        GF_CLIENT_PID_SELF_HEALD, healer,
+                                        ec_shd_index_heal, xdata,
+                                        ec->shd.max_threads,
+                                        ec->shd.wait_qlength);
+    else
+        ret = syncop_mt_dir_scan(NULL, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
+                                 healer, ec_shd_index_heal, xdata,
+                                 ec->shd.max_threads, ec->shd.wait_qlength);
     _unmask_cancellation();
 out:
     if (xdata)
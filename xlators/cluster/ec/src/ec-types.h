@@ -596,6 +596,7 @@ struct _ec_self_heald {
     int timeout;
     uint32_t max_threads;
     uint32_t wait_qlength;
+    gf_boolean_t phased; /* shd-heal-scheduler is "phased" */
     struct subvol_healer *index_healers;
     struct subvol_healer *full_healers;
 };
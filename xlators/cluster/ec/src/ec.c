@@ -246,6 +246,7 @@ reconfigure(xlator_t *this, dict_t *options)
 {
     ec_t *ec = this->private;
     char *read_policy = NULL;
+    char *heal_scheduler = NULL;
     char *extensions = NULL;
     uint32_t heal_wait_qlen = 0;
     uint32_t background_heals = 0;
@@ -277,6 +278,9 @@ reconfigure(xlator_t *this, dict_t *options)
                      failed);
     GF_OPTION_RECONF("shd-wait-qlength", ec->shd.wait_qlength, options, uint32,
                      failed);
+    GF_OPTION_RECONF("shd-heal-scheduler", heal_scheduler, options, str,
+                     failed);
+    ec->shd.phased = !strcmp(heal_scheduler, "phased");
 
     GF_OPTION_RECONF("read-policy", read_policy, options, str, failed);
 
@@ -695,6 +699,7 @@ init(xlator_t *this)
 {
     ec_t *ec = NULL;
     char *read_policy = NULL;
+    char *heal_scheduler = NULL;
     char *extensions = NULL;
     int32_t err;
 
@@ -779,6 +784,8 @@ init(xlator_t *this)
     GF_OPTION_INIT("heal-timeout", ec->shd.timeout, int32, failed);
     GF_OPTION_INIT("shd-max-threads", ec->shd.max_threads, uint32, failed);
     GF_OPTION_INIT("shd-wait-qlength", ec->shd.wait_qlength, uint32, failed);
+    GF_OPTION_INIT("shd-heal-scheduler", heal_scheduler, str, failed);
+    ec->shd.phased = !strcmp(heal_scheduler, "phased");
     GF_OPTION_INIT("optimistic-change-log", ec->optimistic_changelog, bool,
                    failed);
     GF_OPTION_INIT("parallel-writes", ec->parallel_writes, bool, failed);
@@ -1681,6 +1688,18 @@ struct volume_options options[] = {
      .tags = {"disperse"},
      .description = "This option can be used to control number of heals"
                     " that can wait in SHD per subvolume"},
+    {.key = {"shd-heal-scheduler"},
+     .type = GF_OPTION_TYPE_STR,
+     .value = {"fifo", "phased"},
+     .default_value = "fifo",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Order in which SHD heals the entries of the indices. "
+                    "'fifo' heals them in index order, directories one at "
+                    "a time. 'phased' heals the directories of each batch "
+                    "of entries read first, shd-max-threads at a time, "
+                    "then the files, the biggest first."},
     {.key = {"cpu-extensions"},
      .type = GF_OPTION_TYPE_STR,
      .value = {"none", "auto", "x64", "sse", "avx"},
@@ -516,6 +516,22 @@ ios_bump_upcall(xlator_t *this, gf_upcall_flags_t event)
     }
 }
 
+static void
+ios_bump_cache_invalidation(xlator_t *this,
+                            struct gf_upcall_cache_invalidation *up_ci)
+{
+    if (up_ci->flags & (UP_XATTR | UP_XATTR_RM))
+        ios_bump_upcall(this, GF_UPCALL_CI_XATTR);
+    if (up_ci->flags & IATT_UPDATE_FLAGS)
+        ios_bump_upcall(this, GF_UPCALL_CI_STAT);
+    if (up_ci->flags & UP_RENAME_FLAGS)
+        ios_bump_upcall(this, GF_UPCALL_CI_RENAME);
+    if (up_ci->flags & UP_FORGET)
+        ios_bump_upcall(this, GF_UPCALL_CI_FORGET);
+    if (up_ci->flags & UP_NLINK)
+        ios_bump_upcall(this, GF_UPCALL_CI_NLINK);
+}
+
 static void
 ios_bump_stats(xlator_t *this, struct ios_stat *iosstat, ios_stats_type_t type)
 {
@@ -4053,6 +4069,8 @@ notify(xlator_t *this, int32_t event, void *data, ...)
     va_list ap;
     struct gf_upcall *up_data = NULL;
     struct gf_upcall_cache_invalidation *up_ci = NULL;
+    struct gf_upcall_cache_invalidation_batch *up_batch = NULL;
+    uint32_t i = 0;
 
     dict = data;
     va_start(ap, data);
@@ -4147,16 +4165,16 @@ notify(xlator_t *this, int32_t event, void *data, ...)
                 case GF_UPCALL_CACHE_INVALIDATION:
                     up_ci = (struct gf_upcall_cache_invalidation *)
                                 up_data->data;
-                    if (up_ci->flags & (UP_XATTR | UP_XATTR_RM))
-                        ios_bump_upcall(this, GF_UPCALL_CI_XATTR);
-                    if (up_ci->flags & IATT_UPDATE_FLAGS)
-                        ios_bump_upcall(this, GF_UPCALL_CI_STAT);
-                    if (up_ci->flags & UP_RENAME_FLAGS)
-                        ios_bump_upcall(this, GF_UPCALL_CI_RENAME);
-                    if (up_ci->flags & UP_FORGET)
-                        ios_bump_upcall(this, GF_UPCALL_CI_FORGET);
-                    if (up_ci->flags & UP_NLINK)
-                        ios_bump_upcall(this, GF_UPCALL_CI_NLINK);
+                    ios_bump_cache_invalidation(this, up_ci);
+                    break;
+                case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+                    up_batch = (struct gf_upcall_cache_invalidation_batch *)
+                                   up_data->data;
+                    for (i = 0; i < up_batch->count; i++) {
+                        up_ci = (struct gf_upcall_cache_invalidation *)
+                                    up_batch->entries[i].data;
+                        ios_bump_cache_invalidation(this, up_ci);
+                    }
                     break;
                 default:
                     gf_msg_debug(this->name, 0,
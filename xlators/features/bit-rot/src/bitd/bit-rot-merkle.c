@@ -0,0 +1,577 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <pthread.h>
+
+#include <glusterfs/logging.h>
+
+#include "bit-rot.h"
+#include "bit-rot-bitd-messages.h"
+
+/**
+ * Merkle signatures
+ *
+ * The object is split in (at most BR_MERKLE_MAX_CHUNKS) chunks which are
+ * hashed independently:
+ *
+ *     leaf = SHA256(0x00 | chunk)
+ *     node = SHA256(0x01 | left | right)
+ *
+ * The root is built pairwise over the leaves, an odd node being promoted to
+ * the next level as is. The prefixes keep a leaf from passing for an inner
+ * node.
+ *
+ * Chunks are hashed in parallel: the thread signing (or scrubbing) an object
+ * queues it to the hasher and then hashes chunks itself, along with the
+ * hasher threads, until none is left.
+ */
+
+#define BR_MERKLE_LEAF 0x00
+#define BR_MERKLE_NODE 0x01
+
+struct br_hashjob {
+    struct list_head list; /* hook in hasher->jobs while chunks are left */
+
+    xlator_t *this;
+    br_child_t *child;
+    fd_t *fd;
+    pid_t pid;
+
+    uint64_t chunksize;
+    uint64_t size;
+
+    uint64_t todo; /* chunks not handed out yet */
+    int pending;   /* chunks being hashed */
+    int32_t ret;
+
+    int ref;             /* owner + hasher threads hashing a chunk */
+    pthread_cond_t cond; /* signalled when no chunk is pending */
+
+    unsigned char leaves[BR_MERKLE_MAX_CHUNKS][BR_MERKLE_HASH_LEN];
+};
+
+static void
+br_hashjob_destroy(struct br_hashjob *job)
+{
+    pthread_cond_destroy(&job->cond);
+    fd_unref(job->fd);
+    GF_FREE(job);
+}
+
+static gf_boolean_t
+__br_hashjob_unref(struct br_hashjob *job)
+{
+    return (--job->ref == 0);
+}
+
+static int
+__br_hashjob_next_chunk(struct br_hashjob *job)
+{
+    int chunk = 0;
+
+    while (!(job->todo & (1ULL << chunk)))
+        chunk++;
+
+    job->todo &= ~(1ULL << chunk);
+    if (!job->todo)
+        list_del_init(&job->list);
+
+    job->pending++;
+    return chunk;
+}
+
+static void
+__br_hashjob_chunk_done(struct br_hashjob *job, int32_t ret)
+{
+    if (ret) {
+        job->ret = ret;
+        job->todo = 0;
+        list_del_init(&job->list);
+    }
+
+    if (--job->pending == 0)
+        pthread_cond_signal(&job->cond);
+}
+
+static int32_t
+br_hashjob_hash_chunk(struct br_hashjob *job, int chunk)
+{
+    int32_t ret = 0;
+    off_t offset = 0;
+    off_t end = 0;
+    size_t block = 0;
+    unsigned char prefix = BR_MERKLE_LEAF;
+    SHA256_CTX sha256;
+
+    offset = chunk * job->chunksize;
+    end = min(offset + job->chunksize, job->size);
+
+    syncopctx_setfspid(&job->pid);
+
+    SHA256_Init(&sha256);
+    SHA256_Update(&sha256, &prefix, sizeof(prefix));
+
+    while (offset < end) {
+        block = min(BR_HASH_CALC_READ_SIZE, end - offset);
+        ret = br_object_read_block_and_sign(job->this, job->fd, job->child,
+                                            offset, block, &sha256);
+        if (ret < 0) {
+            gf_msg(job->this->name, GF_LOG_ERROR, 0, BRB_MSG_BLOCK_READ_FAILED,
+                   "reading block with offset %" PRIu64
+                   " of object %s failed",
+                   offset, uuid_utoa(job->fd->inode->gfid));
+            return -1;
+        }
+
+        /* object is shorter than it was (or is to be) signed */
+        if (ret == 0)
+            break;
+
+        offset += ret;
+    }
+
+    SHA256_Final(job->leaves[chunk], &sha256);
+    return 0;
+}
+
+static void *
+br_hasher_proc(void *arg)
+{
+    int chunk = 0;
+    int32_t ret = 0;
+    xlator_t *this = arg;
+    br_private_t *priv = this->private;
+    struct br_hasher *hasher = &priv->hasher;
+    struct br_hashjob *job = NULL;
+    gf_boolean_t release = _gf_false;
+
+    THIS = this;
+
+    pthread_mutex_lock(&hasher->lock);
+    while (hasher->running <= hasher->nr_threads) {
+        if (list_empty(&hasher->jobs)) {
+            pthread_cond_wait(&hasher->cond, &hasher->lock);
+            continue;
+        }
+
+        job = list_first_entry(&hasher->jobs, struct br_hashjob, list);
+        chunk = __br_hashjob_next_chunk(job);
+        job->ref++;
+        pthread_mutex_unlock(&hasher->lock);
+
+        ret = br_hashjob_hash_chunk(job, chunk);
+
+        pthread_mutex_lock(&hasher->lock);
+        __br_hashjob_chunk_done(job, ret);
+        release = __br_hashjob_unref(job);
+        if (release) {
+            pthread_mutex_unlock(&hasher->lock);
+            br_hashjob_destroy(job);
+            pthread_mutex_lock(&hasher->lock);
+        }
+    }
+
+    hasher->running--;
+    pthread_cond_broadcast(&hasher->cond);
+    pthread_mutex_unlock(&hasher->lock);
+
+    return NULL;
+}
+
+/**
+ * The owner of a job got cancelled (scrubber scaling down, translator
+ * going away) while hashing one of its chunks: hand out no more chunks and
+ * leave the job to the hasher threads still working on it.
+ */
+static void
+br_hashjob_abort(void *arg)
+{
+    struct br_hashjob *job = arg;
+    br_private_t *priv = job->this->private;
+    struct br_hasher *hasher = &priv->hasher;
+    gf_boolean_t release = _gf_false;
+
+    pthread_mutex_lock(&hasher->lock);
+    {
+        __br_hashjob_chunk_done(job, -1);
+        release = __br_hashjob_unref(job);
+    }
+    pthread_mutex_unlock(&hasher->lock);
+
+    if (release)
+        br_hashjob_destroy(job);
+}
+
+static void
+br_merkle_root(br_merkle_signature_t *merkle)
+{
+    uint32_t i = 0;
+    uint32_t nr = merkle->nr_chunks;
+    unsigned char prefix = BR_MERKLE_NODE;
+    unsigned char level[BR_MERKLE_MAX_CHUNKS][BR_MERKLE_HASH_LEN];
+    SHA256_CTX sha256;
+
+    /* empty object: the hash of an empty chunk */
+    if (nr == 0) {
+        prefix = BR_MERKLE_LEAF;
+        SHA256(&prefix, sizeof(prefix), merkle->root);
+        return;
+    }
+
+    memcpy(level, merkle->leaves, nr * BR_MERKLE_HASH_LEN);
+
+    while (nr > 1) {
+        for (i = 0; i < nr / 2; i++) {
+            SHA256_Init(&sha256);
+            SHA256_Update(&sha256, &prefix, sizeof(prefix));
+            SHA256_Update(&sha256, level[2 * i], BR_MERKLE_HASH_LEN);
+            SHA256_Update(&sha256, level[2 * i + 1], BR_MERKLE_HASH_LEN);
+            SHA256_Final(level[i], &sha256);
+        }
+
+        if (nr & 1)
+            memcpy(level[i], level[nr - 1], BR_MERKLE_HASH_LEN);
+
+        nr = (nr + 1) / 2;
+    }
+
+    memcpy(merkle->root, level[0], BR_MERKLE_HASH_LEN);
+}
+
+/**
+ * smallest chunk size (starting at the configured one) with which an object
+ * of @size fits in BR_MERKLE_MAX_CHUNKS chunks.
+ */
+static uint64_t
+br_merkle_chunk_size(uint64_t chunksize, uint64_t size)
+{
+    while ((size / chunksize) >= BR_MERKLE_MAX_CHUNKS)
+        chunksize <<= 1;
+
+    return chunksize;
+}
+
+br_merkle_signature_t *
+br_merkle_alloc(uint64_t chunksize, uint64_t size)
+{
+    uint64_t nr_chunks = 0;
+    br_merkle_signature_t *merkle = NULL;
+
+    nr_chunks = (size + chunksize - 1) / chunksize;
+    if (nr_chunks > BR_MERKLE_MAX_CHUNKS)
+        return NULL;
+
+    merkle = GF_CALLOC(1, br_merkle_signature_size(nr_chunks),
+                       gf_br_stub_mt_signature_t);
+    if (!merkle)
+        return NULL;
+
+    merkle->chunksize = chunksize;
+    merkle->size = size;
+    merkle->nr_chunks = nr_chunks;
+
+    return merkle;
+}
+
+/**
+ * hash the chunks of @merkle set in @todo (the others are expected to be
+ * filled in already) and compute its root.
+ */
+int32_t
+br_merkle_calculate(xlator_t *this, br_child_t *child, fd_t *fd,
+                    br_merkle_signature_t *merkle, uint64_t todo)
+{
+    int chunk = 0;
+    int oldstate = 0;
+    int32_t ret = -1;
+    uint32_t i = 0;
+    gf_boolean_t release = _gf_false;
+    br_private_t *priv = this->private;
+    struct br_hasher *hasher = &priv->hasher;
+    struct br_hashjob *job = NULL;
+
+    job = GF_CALLOC(1, sizeof(*job), gf_br_mt_br_hashjob_t);
+    if (!job)
+        goto out;
+
+    INIT_LIST_HEAD(&job->list);
+    job->this = this;
+    job->child = child;
+    job->fd = fd_ref(fd);
+    job->pid = (priv->iamscrubber) ? GF_CLIENT_PID_SCRUB : GF_CLIENT_PID_BITD;
+    job->chunksize = merkle->chunksize;
+    job->size = merkle->size;
+    job->todo = todo & BR_MERKLE_CHUNK_MASK(merkle->nr_chunks);
+    job->ref = 1;
+    pthread_cond_init(&job->cond, NULL);
+
+    pthread_cleanup_push(br_hashjob_abort, job);
+    pthread_mutex_lock(&hasher->lock);
+    {
+        if (job->todo) {
+            list_add_tail(&job->list, &hasher->jobs);
+            pthread_cond_broadcast(&hasher->cond);
+        }
+
+        while (job->todo) {
+            chunk = __br_hashjob_next_chunk(job);
+            pthread_mutex_unlock(&hasher->lock);
+
+            ret = br_hashjob_hash_chunk(job, chunk);
+
+            pthread_mutex_lock(&hasher->lock);
+            __br_hashjob_chunk_done(job, ret);
+        }
+
+        /**
+         * hasher threads are at most a chunk away from being done with
+         * the job: do not leave it to them half way through.
+         */
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &oldstate);
+        while (job->pending)
+            pthread_cond_wait(&job->cond, &hasher->lock);
+        pthread_setcancelstate(oldstate, NULL);
+
+        ret = job->ret;
+        release = __br_hashjob_unref(job);
+    }
+    pthread_mutex_unlock(&hasher->lock);
+    pthread_cleanup_pop(0);
+
+    if (!ret) {
+        for (i = 0; i < merkle->nr_chunks; i++) {
+            if (todo & (1ULL << i))
+                memcpy(merkle->leaves[i], job->leaves[i], BR_MERKLE_HASH_LEN);
+        }
+        br_merkle_root(merkle);
+    }
+
+    if (release)
+        br_hashjob_destroy(job);
+
+out:
+    return ret;
+}
+
+/**
+ * Compute the Merkle signature of an object to be signed. Chunks the stub
+ * has not seen modified since the object was last signed are taken over
+ * from that signature, provided it is still the one on disk and has the
+ * same chunk size. The dirty chunks are fetched before reading the object,
+ * so that modifications racing with the signing show up in @xdata, which
+ * is handed back to the stub along with the signature.
+ */
+int32_t
+br_merkle_sign(xlator_t *this, br_child_t *child, fd_t *fd, struct iatt *iatt,
+               br_merkle_signature_t **signature, dict_t **xdata)
+{
+    int32_t ret = -1;
+    uint32_t i = 0;
+    uint32_t unchanged = 0;
+    uint64_t todo = 0;
+    uint64_t chunksize = 0;
+    dict_t *dirtyxattr = NULL;
+    dict_t *signxattr = NULL;
+    br_dirty_chunks_t *dirty = NULL;
+    br_isignature_out_t *sign = NULL;
+    br_merkle_signature_t *merkle = NULL;
+    br_merkle_signature_t *prev = NULL;
+    br_private_t *priv = this->private;
+
+    chunksize = br_merkle_chunk_size(priv->chunksize, iatt->ia_size);
+    merkle = br_merkle_alloc(chunksize, iatt->ia_size);
+    if (!merkle)
+        goto out;
+
+    todo = BR_MERKLE_CHUNK_MASK(merkle->nr_chunks);
+
+    ret = syncop_fgetxattr(child->xl, fd, &dirtyxattr, BR_DIRTY_CHUNKS_KEY,
+                           NULL, NULL);
+    if (ret < 0 ||
+        dict_get_bin(dirtyxattr, BR_DIRTY_CHUNKS_KEY, (void **)&dirty)) {
+        dirty = NULL;
+        goto hash;
+    }
+
+    if (dirty->chunksize != chunksize)
+        goto hash;
+
+    ret = syncop_fgetxattr(child->xl, fd, &signxattr,
+                           GLUSTERFS_GET_OBJECT_SIGNATURE, NULL, NULL);
+    if (ret < 0 ||
+        dict_get_ptr(signxattr, GLUSTERFS_GET_OBJECT_SIGNATURE, (void **)&sign))
+        goto hash;
+
+    if ((sign->signaturetype != BR_SIGNATURE_TYPE_MERKLE_SHA256) ||
+        (sign->version != dirty->signedversion) ||
+        !br_is_merkle_signature_valid(sign->signature, sign->signaturelen))
+        goto hash;
+
+    prev = (br_merkle_signature_t *)sign->signature;
+    if (prev->chunksize != chunksize)
+        goto hash;
+
+    /* the last common chunk is partial (or was) if the size changed */
+    unchanged = min(prev->nr_chunks, merkle->nr_chunks);
+    if ((prev->size != merkle->size) && unchanged)
+        unchanged--;
+
+    for (i = 0; i < unchanged; i++) {
+        if (dirty->mask & (1ULL << i))
+            continue;
+        memcpy(merkle->leaves[i], prev->leaves[i], BR_MERKLE_HASH_LEN);
+        todo &= ~(1ULL << i);
+    }
+
+hash:
+    gf_msg_debug(this->name, 0,
+                 "hashing chunks 0x%" PRIx64 " of %u (%" PRIu64
+                 " bytes each) of object %s",
+                 todo, merkle->nr_chunks, chunksize, uuid_utoa(fd->inode->gfid));
+
+    ret = br_merkle_calculate(this, child, fd, merkle, todo);
+    if (ret)
+        goto out;
+
+    /* not fatal: the stub then stops tracking modifications */
+    if (dirty) {
+        *xdata = dict_new();
+        if (*xdata &&
+            dict_set_bin(*xdata, BR_DIRTY_CHUNKS_KEY,
+                         gf_memdup(dirty, sizeof(*dirty)), sizeof(*dirty))) {
+            dict_unref(*xdata);
+            *xdata = NULL;
+        }
+    }
+
+    *signature = merkle;
+    merkle = NULL;
+
+out:
+    GF_FREE(merkle);
+    if (signxattr)
+        dict_unref(signxattr);
+    if (dirtyxattr)
+        dict_unref(dirtyxattr);
+    return ret;
+}
+
+/**
+ * compare chunk hashes of an object with its signature and list the ones
+ * not matching in @chunks (e.g. "0,4-6"). returns their number.
+ */
+int
+br_merkle_compare(br_merkle_signature_t *sign, br_merkle_signature_t *calc,
+                  char *chunks, size_t len)
+{
+    int bad = 0;
+    int start = -1;
+    uint32_t i = 0;
+    size_t off = 0;
+    gf_boolean_t match = _gf_true;
+
+    chunks[0] = '\0';
+
+    for (i = 0; i <= sign->nr_chunks; i++) {
+        match = (i == sign->nr_chunks) ||
+                ((i < calc->nr_chunks) &&
+                 (memcmp(sign->leaves[i], calc->leaves[i],
+                         BR_MERKLE_HASH_LEN) == 0));
+        if (!match) {
+            bad++;
+            if (start < 0)
+                start = i;
+            continue;
+        }
+
+        if (start < 0)
+            continue;
+
+        if (off < len) {
+            if (i - 1 > start)
+                off += snprintf(chunks + off, len - off, "%s%d-%u",
+                                (off) ? "," : "", start, i - 1);
+            else
+                off += snprintf(chunks + off, len - off, "%s%d",
+                                (off) ? "," : "", start);
+        }
+        start = -1;
+    }
+
+    return bad;
+}
+
+void
+br_hasher_configure(xlator_t *this, br_private_t *priv, int nr_threads)
+{
+    int ret = 0;
+    pthread_t thread;
+    struct br_hasher *hasher = &priv->hasher;
+
+    pthread_mutex_lock(&hasher->lock);
+    {
+        hasher->nr_threads = nr_threads;
+
+        /* threads in excess exit by themselves */
+        while (hasher->running < hasher->nr_threads) {
+            ret = gf_thread_create_detached(&thread, br_hasher_proc, this,
+                                            "brhash");
+            if (ret) {
+                gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_SPAWN_FAILED,
+                       "failed to spawn hasher thread (%d of %d running)",
+                       hasher->running, hasher->nr_threads);
+                hasher->nr_threads = hasher->running;
+                break;
+            }
+            hasher->running++;
+        }
+
+        pthread_cond_broadcast(&hasher->cond);
+    }
+    pthread_mutex_unlock(&hasher->lock);
+}
+
+int32_t
+br_hasher_init(xlator_t *this, br_private_t *priv)
+{
+    int nr_threads = 0;
+    struct br_hasher *hasher = &priv->hasher;
+
+    GF_OPTION_INIT("hash-threads", nr_threads, int32, error_return);
+
+    pthread_mutex_init(&hasher->lock, NULL);
+    pthread_cond_init(&hasher->cond, NULL);
+    INIT_LIST_HEAD(&hasher->jobs);
+
+    br_hasher_configure(this, priv, nr_threads);
+    return 0;
+
+error_return:
+    return -1;
+}
+
+void
+br_hasher_fini(xlator_t *this, br_private_t *priv)
+{
+    struct br_hasher *hasher = &priv->hasher;
+
+    pthread_mutex_lock(&hasher->lock);
+    {
+        hasher->nr_threads = 0;
+        pthread_cond_broadcast(&hasher->cond);
+
+        while (hasher->running)
+            pthread_cond_wait(&hasher->cond, &hasher->lock);
+    }
+    pthread_mutex_unlock(&hasher->lock);
+
+    pthread_cond_destroy(&hasher->cond);
+    pthread_mutex_destroy(&hasher->lock);
+}
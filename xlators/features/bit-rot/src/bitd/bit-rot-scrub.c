@@ -141,6 +141,7 @@ out:
 static int32_t
 bitd_signature_staleness(xlator_t *this, br_child_t *child, fd_t *fd,
                          int *stale, unsigned long *version,
+                         br_merkle_signature_t *layout,
                          br_scrub_stats_t *scrub_stat, gf_boolean_t skip_stat)
 {
     int32_t ret = -1;
@@ -161,6 +162,11 @@ bitd_signature_staleness(xlator_t *this, br_child_t *child, fd_t *fd,
     *stale = signptr->stale ? 1 : 0;
     *version = signptr->version;
 
+    /* chunk layout of merkle signatures, to hash the object the same way */
+    if ((signptr->signaturetype == BR_SIGNATURE_TYPE_MERKLE_SHA256) &&
+        br_is_merkle_signature_valid(signptr->signature, signptr->signaturelen))
+        memcpy(layout, signptr->signature, sizeof(*layout));
+
     dict_unref(xattr);
 
 out:
@@ -178,6 +184,7 @@ out:
 int32_t
 bitd_scrub_pre_compute_check(xlator_t *this, br_child_t *child, fd_t *fd,
                              unsigned long *version,
+                             br_merkle_signature_t *layout,
                              br_scrub_stats_t *scrub_stat,
                              gf_boolean_t skip_stat)
 {
@@ -191,8 +198,8 @@ bitd_scrub_pre_compute_check(xlator_t *this, br_child_t *child, fd_t *fd,
         goto out;
     }
 
-    ret = bitd_signature_staleness(this, child, fd, &stale, version, scrub_stat,
-                                   skip_stat);
+    ret = bitd_signature_staleness(this, child, fd, &stale, version, layout,
+                                   scrub_stat, skip_stat);
     if (!ret && stale) {
         if (!skip_stat)
             br_inc_unsigned_file_count(scrub_stat);
@@ -207,6 +214,61 @@ out:
     return ret;
 }
 
+/**
+ * Merkle signatures tell which chunks of a corrupted object do not match.
+ * Objects re-signed with another chunk layout in between the pre and post
+ * compute checks are left for the next scrub.
+ */
+static int
+bitd_compare_merkle(xlator_t *this, br_isignature_out_t *sign,
+                    br_merkle_signature_t *merkle, inode_t *linked_inode,
+                    br_child_t *child, loc_t *loc)
+{
+    int bad = 0;
+    char chunks[256] = {
+        0,
+    };
+    br_merkle_signature_t *signed_merkle = NULL;
+
+    if (!br_is_merkle_signature_valid(sign->signature, sign->signaturelen))
+        return 1;
+
+    signed_merkle = (br_merkle_signature_t *)sign->signature;
+    if ((signed_merkle->chunksize != merkle->chunksize) ||
+        (signed_merkle->nr_chunks != merkle->nr_chunks)) {
+        gf_msg_debug(this->name, 0,
+                     "%s [GFID: %s | Brick: %s] was signed with another "
+                     "chunk layout during checksumming, skipping..",
+                     loc->path, uuid_utoa(linked_inode->gfid),
+                     child->brick_path);
+        return 0;
+    }
+
+    bad = br_merkle_compare(signed_merkle, merkle, chunks, sizeof(chunks));
+
+    if (signed_merkle->size != merkle->size) {
+        gf_msg(this->name, GF_LOG_ALERT, 0, BRB_MSG_CHECKSUM_MISMATCH,
+               "Object size mismatch: %s [GFID: %s | Brick: %s] "
+               "{signed: %" PRIu64 " | current: %" PRIu64 "}",
+               loc->path, uuid_utoa(linked_inode->gfid), child->brick_path,
+               signed_merkle->size, merkle->size);
+        bad++;
+    }
+
+    if (!bad)
+        return (memcmp(signed_merkle->root, merkle->root,
+                       BR_MERKLE_HASH_LEN) != 0);
+
+    if (chunks[0])
+        gf_msg(this->name, GF_LOG_ALERT, 0, BRB_MSG_CHECKSUM_MISMATCH,
+               "Chunk checksum mismatch: %s [GFID: %s | Brick: %s] "
+               "{chunks: %s | chunk size: %" PRIu64 "}",
+               loc->path, uuid_utoa(linked_inode->gfid), child->brick_path,
+               chunks, merkle->chunksize);
+
+    return bad;
+}
+
 /* static int */
 int
 bitd_compare_ckum(xlator_t *this, br_isignature_out_t *sign, unsigned char *md,
@@ -224,7 +286,13 @@ bitd_compare_ckum(xlator_t *this, br_isignature_out_t *sign, unsigned char *md,
     GF_VALIDATE_OR_GOTO(this->name, md, out);
     GF_VALIDATE_OR_GOTO(this->name, entry, out);
 
-    if (strncmp(sign->signature, (char *)md, sign->signaturelen) == 0) {
+    if (sign->signaturetype == BR_SIGNATURE_TYPE_MERKLE_SHA256)
+        ret = bitd_compare_merkle(this, sign, (br_merkle_signature_t *)md,
+                                  linked_inode, child, loc);
+    else
+        ret = strncmp(sign->signature, (char *)md, sign->signaturelen);
+
+    if (ret == 0) {
         gf_msg_debug(this->name, 0,
                      "%s [GFID: %s | Brick: %s] "
                      "matches calculated checksum",
@@ -277,9 +345,9 @@ out:
 /**
  * "The Scrubber"
  *
- * Perform signature validation for a given object with the assumption
- * that the signature is SHA256 (because signer as of now _always_
- * signs with SHA256).
+ * Perform signature validation for a given object. The signature is
+ * either a SHA256 hash of the whole object or a merkle signature, in
+ * which case the object is hashed with the chunk layout of the latter.
  */
 int
 br_scrubber_scrub_begin(xlator_t *this, struct br_fsscan_entry *fsentry)
@@ -301,6 +369,10 @@ br_scrubber_scrub_begin(xlator_t *this, struct br_fsscan_entry *fsentry)
     inode_t *linked_inode = NULL;
     br_isignature_out_t *sign = NULL;
     unsigned long signedversion = 0;
+    br_merkle_signature_t layout = {
+        0,
+    };
+    br_merkle_signature_t *merkle = NULL;
     gf_dirent_t *entry = NULL;
     br_private_t *priv = NULL;
     loc_t *parent = NULL;
@@ -388,16 +460,29 @@ br_scrubber_scrub_begin(xlator_t *this, struct br_fsscan_entry *fsentry)
      *  - signature staleness
      */
     ret = bitd_scrub_pre_compute_check(this, child, fd, &signedversion,
-                                       &priv->scrub_stat, skip_stat);
+                                       &layout, &priv->scrub_stat, skip_stat);
     if (ret)
         goto unrefd; /* skip this object */
 
     /* if all's good, proceed to calculate the hash */
-    md = GF_MALLOC(SHA256_DIGEST_LENGTH, gf_common_mt_char);
-    if (!md)
-        goto unrefd;
+    if (layout.chunksize) {
+        merkle = br_merkle_alloc(layout.chunksize, layout.size);
+        if (!merkle) {
+            ret = -1;
+            goto unrefd;
+        }
 
-    ret = br_calculate_obj_checksum(md, child, fd, &iatt);
+        ret = br_merkle_calculate(this, child, fd, merkle,
+                                  BR_MERKLE_CHUNK_MASK(merkle->nr_chunks));
+        merkle->size = iatt.ia_size;
+        md = (unsigned char *)merkle;
+    } else {
+        md = GF_MALLOC(SHA256_DIGEST_LENGTH, gf_common_mt_char);
+        if (!md)
+            goto unrefd;
+
+        ret = br_calculate_obj_checksum(md, child, fd, &iatt);
+    }
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_CALC_ERROR,
                "error calculating hash for object [GFID: %s]",
@@ -500,8 +585,340 @@ _br_fsscan_collect_entry(struct br_scanfs *fsscan,
     _br_fsscan_inc_entry_count(fsscan);
 }
 
+#define BR_SCRUB_MIN_RATE (1 * GF_UNIT_MB) /* floor when backing off */
+#define BR_SCRUB_TOKEN_INTERVAL 100000    /* usec */
+#define BR_SCRUB_SCHED_IDLE 10            /* seconds */
+
+/**
+ * TBF_OP_HASH tokens are bytes read for hashing. Once a bucket exists it
+ * stays, so "unlimited" is a bucket that never runs dry.
+ */
+static void
+__br_scrub_sched_apply(xlator_t *this, br_private_t *priv, uint64_t rate)
+{
+    struct br_scrub_sched *sched = &priv->fsscrub.sched;
+    tbf_opspec_t spec = {
+        0,
+    };
+
+    sched->rate = rate;
+    if (!rate && !sched->throttling)
+        return;
+
+    spec.op = TBF_OP_HASH;
+    spec.token_gen_interval = BR_SCRUB_TOKEN_INTERVAL;
+
+    if (rate) {
+        spec.rate = max(rate / (1000000 / BR_SCRUB_TOKEN_INTERVAL), 1);
+        spec.maxlimit = max(spec.rate, BR_HASH_CALC_READ_SIZE);
+    } else {
+        spec.rate = ULONG_MAX / 2;
+        spec.maxlimit = ULONG_MAX / 2;
+    }
+
+    if (tbf_mod(priv->tbf, &spec) == 0)
+        sched->throttling = _gf_true;
+}
+
+/**
+ * Once a second:
+ *  - the target rate is raised to what is needed to scrub the bytes left
+ *    (as many as the last complete pass) before the deadline,
+ *  - while the average read latency is above the limit, the rate is
+ *    halved (from what was actually scrubbed), down to BR_SCRUB_MIN_RATE,
+ *  - after that, it grows back by a quarter per second.
+ */
+static uint64_t
+__br_scrub_sched_adjust(xlator_t *this, struct br_scrub_sched *sched,
+                        time_t now)
+{
+    time_t timeleft = 0;
+    uint64_t rate = sched->rate;
+    uint64_t desired = sched->target;
+    uint64_t throughput = 0;
+    gf_boolean_t backoff = sched->backoff;
+
+    if (now - sched->tick > BR_SCRUB_SCHED_IDLE) {
+        sched->tick = now;
+        sched->tick_bytes = 0;
+        return rate;
+    }
+
+    throughput = sched->tick_bytes / (now - sched->tick);
+    sched->tick = now;
+    sched->tick_bytes = 0;
+
+    if (desired && sched->deadline && (sched->estimate > sched->bytes)) {
+        timeleft = sched->pass_start + sched->deadline - now;
+        if (timeleft > 0) {
+            desired = max(desired,
+                          (sched->estimate - sched->bytes) / timeleft);
+        } else {
+            desired = 0; /* late: as fast as latency allows */
+            if (!sched->late)
+                gf_msg(this->name, GF_LOG_WARNING, 0, BRB_MSG_SCRUB_RATE,
+                       "Scrub deadline missed [%" PRIu64 "/%" PRIu64
+                       " bytes scrubbed]",
+                       sched->bytes, sched->estimate);
+            sched->late = _gf_true;
+        }
+    }
+
+    if (sched->max_latency &&
+        (sched->latency > (uint64_t)sched->max_latency * 1000)) {
+        if (!rate || (rate > throughput))
+            rate = throughput;
+        rate = max(rate / 2, BR_SCRUB_MIN_RATE);
+        sched->backoff = _gf_true;
+    } else if (!sched->backoff) {
+        rate = desired;
+    } else {
+        rate += max(rate / 4, BR_SCRUB_MIN_RATE);
+        if (desired && (rate >= desired)) {
+            rate = desired;
+            sched->backoff = _gf_false;
+        } else if (!desired && (rate > 2 * throughput)) {
+            rate = 0; /* not what limits scrubbing anymore */
+            sched->backoff = _gf_false;
+        }
+    }
+
+    if (backoff != sched->backoff)
+        gf_msg(this->name, GF_LOG_INFO, 0, BRB_MSG_SCRUB_RATE,
+               "%s scrub rate [read latency: %" PRIu64
+               " usec, rate: %" PRIu64 " bytes/sec]",
+               (sched->backoff) ? "Lowering" : "Restored", sched->latency,
+               rate);
+    else if (rate != sched->rate)
+        gf_msg_debug(this->name, 0,
+                     "scrub rate %" PRIu64 " => %" PRIu64
+                     " bytes/sec [read latency: %" PRIu64 " usec]",
+                     sched->rate, rate, sched->latency);
+
+    return rate;
+}
+
+/* account a read done for scrubbing (called from any scrubber thread) */
+void
+br_scrub_sched_account(xlator_t *this, br_child_t *child, size_t bytes,
+                       uint64_t latency)
+{
+    uint64_t rate = 0;
+    struct timeval tv = {
+        0,
+    };
+    br_private_t *priv = this->private;
+    struct br_scrub_sched *sched = &priv->fsscrub.sched;
+
+    GF_ATOMIC_ADD(child->fsscan.bytes, bytes);
+
+    gettimeofday(&tv, NULL);
+
+    pthread_mutex_lock(&sched->lock);
+    {
+        sched->bytes += bytes;
+        sched->tick_bytes += bytes;
+
+        /* moving average, 1/8th weight to the last read */
+        if (sched->latency)
+            sched->latency = (sched->latency * 7 + latency) / 8;
+        else
+            sched->latency = latency;
+
+        if (tv.tv_sec > sched->tick) {
+            rate = __br_scrub_sched_adjust(this, sched, tv.tv_sec);
+            if (rate != sched->rate)
+                __br_scrub_sched_apply(this, priv, rate);
+        }
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
+static void
+br_scrub_sched_start(xlator_t *this)
+{
+    struct timeval tv = {
+        0,
+    };
+    br_private_t *priv = this->private;
+    struct br_scrub_sched *sched = &priv->fsscrub.sched;
+
+    gettimeofday(&tv, NULL);
+
+    pthread_mutex_lock(&sched->lock);
+    {
+        sched->pass_start = tv.tv_sec;
+        sched->bytes = 0;
+        sched->estimate = 0;
+        sched->late = _gf_false;
+        sched->tick = tv.tv_sec;
+        sched->tick_bytes = 0;
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
+/* a child starting (or resuming) its part of the pass */
+static void
+br_scrub_sched_join(xlator_t *this, br_child_t *child)
+{
+    br_private_t *priv = this->private;
+    struct br_scanfs *fsscan = &child->fsscan;
+    struct br_scrub_sched *sched = &priv->fsscrub.sched;
+
+    pthread_mutex_lock(&sched->lock);
+    {
+        sched->estimate += fsscan->last_bytes;
+        sched->bytes += GF_ATOMIC_GET(fsscan->bytes);
+        if (fsscan->pass_start < sched->pass_start)
+            sched->pass_start = fsscan->pass_start;
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
 #define NR_ENTRIES (1 << 7) /* ..bulk scrubbing */
 
+#define BR_SCRUB_CHECKPOINT_INTERVAL 60 /* seconds */
+
+static void
+br_scrub_checkpoint_loc(br_child_t *child, loc_t *loc)
+{
+    loc->inode = inode_ref(child->table->root);
+    gf_uuid_copy(loc->gfid, loc->inode->gfid);
+}
+
+/**
+ * Save the progress of the pass on the brick root. Entries are crawled
+ * in batches and a batch is scrubbed as a whole before the crawl goes on,
+ * so every entry crawled so far has been scrubbed. @done marks the pass as
+ * complete.
+ */
+static void
+br_scrub_checkpoint_save(xlator_t *this, br_child_t *child, gf_boolean_t done)
+{
+    int32_t ret = -1;
+    dict_t *xattr = NULL;
+    loc_t loc = {
+        0,
+    };
+    struct timeval tv = {
+        0,
+    };
+    struct br_scanfs *fsscan = &child->fsscan;
+    struct br_scrub_checkpoint ckpt = {
+        0,
+    };
+
+    if (done) {
+        fsscan->last_bytes = GF_ATOMIC_GET(fsscan->bytes);
+    } else {
+        ckpt.pass_start = fsscan->pass_start;
+        ckpt.entries = fsscan->nr_entries;
+        ckpt.bytes = GF_ATOMIC_GET(fsscan->bytes);
+    }
+    ckpt.last_bytes = fsscan->last_bytes;
+
+    xattr = dict_new();
+    if (!xattr)
+        return;
+
+    ret = dict_set_static_bin(xattr, BR_SCRUB_CHECKPOINT_KEY, &ckpt,
+                              sizeof(ckpt));
+    if (ret)
+        goto unref_dict;
+
+    br_scrub_checkpoint_loc(child, &loc);
+
+    ret = syncop_setxattr(child->xl, &loc, xattr, 0, NULL, NULL);
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, -ret, BRB_MSG_SCRUB_CHECKPOINT,
+               "failed to save scrub progress of brick %s",
+               child->brick_path);
+
+    gettimeofday(&tv, NULL);
+    fsscan->saved = tv.tv_sec;
+
+    loc_wipe(&loc);
+unref_dict:
+    dict_unref(xattr);
+}
+
+static void
+br_scrub_checkpoint_update(xlator_t *this, br_child_t *child)
+{
+    struct timeval tv = {
+        0,
+    };
+
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec - child->fsscan.saved >= BR_SCRUB_CHECKPOINT_INTERVAL)
+        br_scrub_checkpoint_save(this, child, _gf_false);
+}
+
+/**
+ * Pick up a pass interrupted by a scrubber restart (the crawl skips the
+ * entries already scrubbed), or start a new one.
+ */
+static void
+br_scrub_checkpoint_load(xlator_t *this, br_child_t *child)
+{
+    int32_t ret = -1;
+    dict_t *xattr = NULL;
+    data_t *data = NULL;
+    loc_t loc = {
+        0,
+    };
+    struct timeval tv = {
+        0,
+    };
+    char timestr[64] = {
+        0,
+    };
+    struct br_scanfs *fsscan = &child->fsscan;
+    struct br_scrub_checkpoint *ckpt = NULL;
+
+    gettimeofday(&tv, NULL);
+
+    fsscan->pass_start = tv.tv_sec;
+    fsscan->saved = tv.tv_sec;
+    fsscan->nr_entries = 0;
+    fsscan->skip = 0;
+    GF_ATOMIC_INIT(fsscan->bytes, 0);
+
+    br_scrub_checkpoint_loc(child, &loc);
+
+    ret = syncop_getxattr(child->xl, &loc, &xattr, BR_SCRUB_CHECKPOINT_KEY,
+                          NULL, NULL);
+    if (ret < 0)
+        goto join; /* first pass */
+
+    data = dict_get(xattr, BR_SCRUB_CHECKPOINT_KEY);
+    if (!data || (data->len != sizeof(*ckpt)))
+        goto join;
+
+    ckpt = (struct br_scrub_checkpoint *)data->data;
+
+    fsscan->last_bytes = ckpt->last_bytes;
+    if (!ckpt->pass_start)
+        goto join;
+
+    fsscan->pass_start = ckpt->pass_start;
+    fsscan->skip = ckpt->entries;
+    GF_ATOMIC_INIT(fsscan->bytes, ckpt->bytes);
+
+    gf_time_fmt(timestr, sizeof(timestr), fsscan->pass_start, gf_timefmt_FT);
+    gf_msg(this->name, GF_LOG_INFO, 0, BRB_MSG_SCRUB_CHECKPOINT,
+           "Resuming scrub of brick %s started at %s [%" PRIu64
+           " entries, %" PRIu64 " bytes already scrubbed]",
+           child->brick_path, timestr, ckpt->entries, ckpt->bytes);
+
+join:
+    br_scrub_sched_join(this, child);
+
+    if (xattr)
+        dict_unref(xattr);
+    loc_wipe(&loc);
+}
+
 int
 br_fsscanner_handle_entry(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
                           void *data)
@@ -520,6 +937,10 @@ br_fsscanner_handle_entry(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
     this = child->this;
     fsscan = &child->fsscan;
 
+    /* scrubbed before the scrubber restarted */
+    if (++fsscan->nr_entries <= fsscan->skip)
+        return 0;
+
     _mask_cancellation();
 
     fsentry = GF_CALLOC(1, sizeof(*fsentry), gf_br_mt_br_fsscan_entry_t);
@@ -558,8 +979,10 @@ br_fsscanner_handle_entry(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
 
     _unmask_cancellation();
 
-    if (scrub)
+    if (scrub) {
         wait_for_scrubbing(this, fsscan);
+        br_scrub_checkpoint_update(this, child);
+    }
 
     return 0;
 
@@ -733,6 +1156,8 @@ static void
 br_fsscanner_entry_control(xlator_t *this, br_child_t *child)
 {
     br_fsscanner_log_time(this, child, "started");
+
+    br_scrub_checkpoint_load(this, child);
 }
 
 static void
@@ -798,6 +1223,7 @@ br_fsscanner_exit_control(xlator_t *this, br_child_t *child)
 void *
 br_fsscanner(void *arg)
 {
+    int ret = 0;
     loc_t loc = {
         0,
     };
@@ -819,11 +1245,15 @@ br_fsscanner(void *arg)
             br_fsscanner_entry_control(this, child);
 
             /* scrub */
-            (void)syncop_ftw(child->xl, &loc, GF_CLIENT_PID_SCRUB, child,
+            ret = syncop_ftw(child->xl, &loc, GF_CLIENT_PID_SCRUB, child,
                              br_fsscanner_handle_entry);
             if (!list_empty(&fsscan->queued))
                 wait_for_scrubbing(this, fsscan);
 
+            /* an incomplete crawl is resumed by the next pass */
+            if (_br_is_child_connected(child))
+                br_scrub_checkpoint_save(this, child, (ret == 0));
+
             /* scrub exit criteria */
             br_fsscanner_exit_control(this, child);
         }
@@ -854,6 +1284,8 @@ br_kickstart_scanner(struct gf_tw_timer_list *timer, void *data,
     priv->scrub_stat.scrubbed_files = 0;
     priv->scrub_stat.unsigned_files = 0;
 
+    br_scrub_sched_start(this);
+
     /* Moves state from PENDING to ACTIVE */
     (void)br_scrubber_entry_control(this);
 
@@ -1538,6 +1970,54 @@ error_return:
     return -1;
 }
 
+static int32_t
+br_scrubber_handle_sched(xlator_t *this, br_private_t *priv, dict_t *options)
+{
+    uint64_t target = 0;
+    uint32_t deadline = 0;
+    uint32_t max_latency = 0;
+    struct br_scrub_sched *sched = &priv->fsscrub.sched;
+
+    if (options) {
+        GF_OPTION_RECONF("scrub-rate", target, options, size_uint64,
+                         error_return);
+        GF_OPTION_RECONF("scrub-deadline", deadline, options, time,
+                         error_return);
+        GF_OPTION_RECONF("scrub-max-latency", max_latency, options, uint32,
+                         error_return);
+    } else {
+        GF_OPTION_INIT("scrub-rate", target, size_uint64, error_return);
+        GF_OPTION_INIT("scrub-deadline", deadline, time, error_return);
+        GF_OPTION_INIT("scrub-max-latency", max_latency, uint32,
+                       error_return);
+    }
+
+    pthread_mutex_lock(&sched->lock);
+    {
+        if ((sched->target != target) || (sched->deadline != deadline) ||
+            (sched->max_latency != max_latency))
+            gf_msg(this->name, GF_LOG_INFO, 0, BRB_MSG_SCRUB_TUNABLE,
+                   "SCRUB RATE:: [Target: %" PRIu64
+                   " bytes/sec, Deadline: %u sec, Max latency: %u msec]",
+                   target, deadline, max_latency);
+
+        sched->target = target;
+        sched->deadline = deadline;
+        sched->max_latency = max_latency;
+
+        /* start over from the (new) target */
+        sched->backoff = _gf_false;
+        if (sched->rate != target)
+            __br_scrub_sched_apply(this, priv, target);
+    }
+    pthread_mutex_unlock(&sched->lock);
+
+    return 0;
+
+error_return:
+    return -1;
+}
+
 static void
 br_scrubber_log_option(xlator_t *this, br_private_t *priv,
                        gf_boolean_t scrubstall)
@@ -1591,6 +2071,10 @@ br_scrubber_handle_options(xlator_t *this, br_private_t *priv, dict_t *options)
     if (ret)
         goto error_return;
 
+    ret = br_scrubber_handle_sched(this, priv, options);
+    if (ret)
+        goto error_return;
+
     br_scrubber_log_option(this, priv, scrubstall);
 
     return 0;
@@ -2078,6 +2562,8 @@ br_scrubber_init(xlator_t *this, br_private_t *priv)
     pthread_mutex_init(&fsscrub->mutex, NULL);
     pthread_cond_init(&fsscrub->cond, NULL);
 
+    pthread_mutex_init(&fsscrub->sched.lock, NULL);
+
     fsscrub->nr_scrubbers = 0;
     INIT_LIST_HEAD(&fsscrub->scrubbers);
     INIT_LIST_HEAD(&fsscrub->scrublist);
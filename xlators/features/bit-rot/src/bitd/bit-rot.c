@@ -12,14 +12,13 @@
 
 #include <glusterfs/logging.h>
 #include <glusterfs/compat-errno.h>
+#include <glusterfs/timespec.h>
 
 #include "bit-rot.h"
 #include "bit-rot-scrub.h"
 #include <pthread.h>
 #include "bit-rot-bitd-messages.h"
 
-#define BR_HASH_CALC_READ_SIZE (128 * 1024)
-
 typedef int32_t(br_child_handler)(xlator_t *, br_child_t *);
 
 struct br_child_event {
@@ -269,7 +268,7 @@ out:
  * read 128k block from the object @object from the offset @offset
  * and return the buffer.
  */
-static int32_t
+int32_t
 br_object_read_block_and_sign(xlator_t *this, fd_t *fd, br_child_t *child,
                               off_t offset, size_t size, SHA256_CTX *sha256)
 {
@@ -280,6 +279,15 @@ br_object_read_block_and_sign(xlator_t *this, fd_t *fd, br_child_t *child,
     br_private_t *priv = NULL;
     int count = 0;
     int i = 0;
+    struct timespec start = {
+        0,
+    };
+    struct timespec end = {
+        0,
+    };
+    struct timespec elapsed = {
+        0,
+    };
 
     GF_VALIDATE_OR_GOTO("bit-rot", this, out);
     GF_VALIDATE_OR_GOTO(this->name, fd, out);
@@ -292,6 +300,8 @@ br_object_read_block_and_sign(xlator_t *this, fd_t *fd, br_child_t *child,
     GF_VALIDATE_OR_GOTO(this->name, priv->tbf, out);
     tbf = priv->tbf;
 
+    timespec_now(&start);
+
     ret = syncop_readv(child->xl, fd, size, offset, 0, &iovec, &count, &iobref,
                        NULL, NULL, NULL);
 
@@ -305,13 +315,22 @@ br_object_read_block_and_sign(xlator_t *this, fd_t *fd, br_child_t *child,
     if (ret == 0)
         goto out;
 
+    /* read latency drives the scrub rate */
+    if (priv->iamscrubber) {
+        timespec_now(&end);
+        timespec_sub(&start, &end, &elapsed);
+        br_scrub_sched_account(this, child, ret,
+                               elapsed.tv_sec * 1000000 +
+                                   elapsed.tv_nsec / 1000);
+    }
+
     for (i = 0; i < count; i++) {
         TBF_THROTTLE_BEGIN(tbf, TBF_OP_HASH, iovec[i].iov_len);
         {
             SHA256_Update(sha256, (const unsigned char *)(iovec[i].iov_base),
                           iovec[i].iov_len);
         }
-        TBF_THROTTLE_BEGIN(tbf, TBF_OP_HASH, iovec[i].iov_len);
+        TBF_THROTTLE_END(tbf, TBF_OP_HASH, iovec[i].iov_len);
     }
 
 out:
@@ -378,37 +397,58 @@ br_object_read_sign(inode_t *linked_inode, fd_t *fd, br_object_t *object,
                     struct iatt *iatt)
 {
     int32_t ret = -1;
+    size_t mdlen = SHA256_DIGEST_LENGTH;
+    int8_t signaturetype = BR_SIGNATURE_TYPE_SHA256;
     xlator_t *this = NULL;
     dict_t *xattr = NULL;
+    dict_t *xdata = NULL;
     unsigned char *md = NULL;
     br_isignature_t *sign = NULL;
+    br_private_t *priv = NULL;
+    br_merkle_signature_t *merkle = NULL;
 
     GF_VALIDATE_OR_GOTO("bit-rot", object, out);
     GF_VALIDATE_OR_GOTO("bit-rot", linked_inode, out);
     GF_VALIDATE_OR_GOTO("bit-rot", fd, out);
 
     this = object->this;
+    priv = this->private;
 
-    md = GF_MALLOC(SHA256_DIGEST_LENGTH, gf_common_mt_char);
-    if (!md) {
-        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, BRB_MSG_NO_MEMORY,
-               "failed to allocate memory for saving hash of the "
-               "object %s",
-               uuid_utoa(fd->inode->gfid));
-        goto out;
-    }
+    if (priv->signaturetype == BR_SIGNATURE_TYPE_MERKLE_SHA256) {
+        ret = br_merkle_sign(this, object->child, fd, iatt, &merkle, &xdata);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_CALC_CHECKSUM_FAILED,
+                   "calculating merkle signature "
+                   "for the object %s failed",
+                   uuid_utoa(linked_inode->gfid));
+            goto out;
+        }
 
-    ret = br_object_checksum(md, object, fd, iatt);
-    if (ret) {
-        gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_CALC_CHECKSUM_FAILED,
-               "calculating checksum "
-               "for the object %s failed",
-               uuid_utoa(linked_inode->gfid));
-        goto free_signature;
+        md = (unsigned char *)merkle;
+        mdlen = br_merkle_signature_size(merkle->nr_chunks);
+        signaturetype = BR_SIGNATURE_TYPE_MERKLE_SHA256;
+        ret = -1;
+    } else {
+        md = GF_MALLOC(SHA256_DIGEST_LENGTH, gf_common_mt_char);
+        if (!md) {
+            gf_msg(this->name, GF_LOG_ERROR, ENOMEM, BRB_MSG_NO_MEMORY,
+                   "failed to allocate memory for saving hash of the "
+                   "object %s",
+                   uuid_utoa(fd->inode->gfid));
+            goto out;
+        }
+
+        ret = br_object_checksum(md, object, fd, iatt);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_CALC_CHECKSUM_FAILED,
+                   "calculating checksum "
+                   "for the object %s failed",
+                   uuid_utoa(linked_inode->gfid));
+            goto free_signature;
+        }
     }
 
-    sign = br_prepare_signature(md, SHA256_DIGEST_LENGTH,
-                                BR_SIGNATURE_TYPE_SHA256, object);
+    sign = br_prepare_signature(md, mdlen, signaturetype, object);
     if (!sign) {
         gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_GET_SIGN_FAILED,
                "failed to get the signature for the object %s",
@@ -417,7 +457,7 @@ br_object_read_sign(inode_t *linked_inode, fd_t *fd, br_object_t *object,
     }
 
     xattr = dict_for_key_value(GLUSTERFS_SET_OBJECT_SIGNATURE, (void *)sign,
-                               signature_size(SHA256_DIGEST_LENGTH), _gf_true);
+                               signature_size(mdlen), _gf_true);
 
     if (!xattr) {
         gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_SET_SIGN_FAILED,
@@ -426,7 +466,7 @@ br_object_read_sign(inode_t *linked_inode, fd_t *fd, br_object_t *object,
         goto free_isign;
     }
 
-    ret = syncop_fsetxattr(object->child->xl, fd, xattr, 0, NULL, NULL);
+    ret = syncop_fsetxattr(object->child->xl, fd, xattr, 0, xdata, NULL);
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, 0, BRB_MSG_SET_SIGN_FAILED,
                "fsetxattr of signature to the object %s failed",
@@ -442,6 +482,8 @@ free_isign:
     GF_FREE(sign);
 free_signature:
     GF_FREE(md);
+    if (xdata)
+        dict_unref(xdata);
 out:
     return ret;
 }
@@ -1246,6 +1288,7 @@ br_enact_scrubber(xlator_t *this, br_child_t *child)
     pthread_cond_init(&fsscan->waitcond, NULL);
 
     fsscan->entries = 0;
+    GF_ATOMIC_INIT(fsscan->bytes, 0);
     INIT_LIST_HEAD(&fsscan->queued);
     INIT_LIST_HEAD(&fsscan->ready);
 
@@ -1870,11 +1913,26 @@ br_rate_limit_signer(xlator_t *this, int child_count, int numbricks)
 static int32_t
 br_signer_handle_options(xlator_t *this, br_private_t *priv, dict_t *options)
 {
-    if (options)
+    char *signaturetype = NULL;
+
+    if (options) {
         GF_OPTION_RECONF("expiry-time", priv->expiry_time, options, uint32,
                          error_return);
-    else
+        GF_OPTION_RECONF("signature-type", signaturetype, options, str,
+                         error_return);
+        GF_OPTION_RECONF("chunk-size", priv->chunksize, options, size_uint64,
+                         error_return);
+    } else {
         GF_OPTION_INIT("expiry-time", priv->expiry_time, uint32, error_return);
+        GF_OPTION_INIT("signature-type", signaturetype, str, error_return);
+        GF_OPTION_INIT("chunk-size", priv->chunksize, size_uint64,
+                       error_return);
+    }
+
+    if (strcasecmp(signaturetype, "merkle-sha256") == 0)
+        priv->signaturetype = BR_SIGNATURE_TYPE_MERKLE_SHA256;
+    else
+        priv->signaturetype = BR_SIGNATURE_TYPE_SHA256;
 
     return 0;
 
@@ -2046,6 +2104,9 @@ init(xlator_t *this)
             ret = br_scrubber_handle_options(this, priv, NULL);
     }
 
+    if (!ret)
+        ret = br_hasher_init(this, priv);
+
     if (ret)
         goto cleanup;
 
@@ -2090,6 +2151,8 @@ fini(xlator_t *this)
     else
         (void)br_free_scrubber_monitor(this, priv);
 
+    br_hasher_fini(this, priv);
+
     br_free_children(this, priv, priv->child_count);
 
     this->private = NULL;
@@ -2153,6 +2216,7 @@ int
 reconfigure(xlator_t *this, dict_t *options)
 {
     int ret = 0;
+    int nr_threads = 0;
     br_private_t *priv = NULL;
 
     priv = this->private;
@@ -2162,6 +2226,15 @@ reconfigure(xlator_t *this, dict_t *options)
     else
         ret = br_reconfigure_signer(this, options);
 
+    if (ret)
+        goto err;
+
+    ret = -1;
+    GF_OPTION_RECONF("hash-threads", nr_threads, options, int32, err);
+    br_hasher_configure(this, priv, nr_threads);
+    ret = 0;
+
+err:
     return ret;
 }
 
@@ -2220,6 +2293,72 @@ struct volume_options options[] = {
         .description = "Pause/Resume scrub. Upon resume, scrubber "
                        "continues from where it left off.",
     },
+    {
+        .key = {"scrub-rate"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Bytes per second the scrubber aims at, 0 for no "
+                       "limit other than scrub-throttle.",
+    },
+    {
+        .key = {"scrub-deadline"},
+        .type = GF_OPTION_TYPE_TIME,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Time a scrub pass should take at most. The scrub "
+                       "rate is raised above scrub-rate when needed to "
+                       "scrub as much as the last pass did in time.",
+    },
+    {
+        .key = {"scrub-max-latency"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 60000,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Average latency (in msec) of reads from the "
+                       "bricks above which the scrubber slows down, "
+                       "0 to disable.",
+    },
+    {
+        .key = {"signature-type"},
+        .type = GF_OPTION_TYPE_STR,
+        .value = {"sha256", "merkle-sha256"},
+        .default_value = "sha256",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Signature computed for new and modified objects. "
+                       "\"merkle-sha256\" hashes the object in chunks, in "
+                       "parallel, and only rehashes modified chunks when "
+                       "the object is signed again.",
+    },
+    {
+        .key = {"chunk-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 4 * GF_UNIT_KB,
+        .max = 1 * GF_UNIT_GB,
+        .default_value = "1MB",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Smallest chunk size of merkle signatures. Objects "
+                       "too large to fit in 64 chunks get larger ones.",
+    },
+    {
+        .key = {"hash-threads"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 64,
+        .default_value = "4",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .description = "Number of threads hashing chunks of merkle "
+                       "signed objects, along with the thread signing "
+                       "(or scrubbing) the object.",
+    },
     {.key = {NULL}},
 };
 
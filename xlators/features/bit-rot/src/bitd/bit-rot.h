@@ -36,6 +36,11 @@
  */
 #define BR_WORKERS 4
 
+#define BR_HASH_CALC_READ_SIZE (128 * 1024)
+
+/* bitmask of the first @nr chunks of a Merkle signature */
+#define BR_MERKLE_CHUNK_MASK(nr) ((nr) ? (~0ULL >> (64 - (nr))) : 0)
+
 typedef enum scrub_throttle {
     BR_SCRUB_THROTTLE_VOID = -1,
     BR_SCRUB_THROTTLE_LAZY = 0,
@@ -56,6 +61,19 @@ typedef enum scrub_freq {
 
 #define signature_size(hl) (sizeof(br_isignature_t) + hl + 1)
 
+/**
+ * progress of a scrub pass, kept on the brick root so that a restarted
+ * scrubber resumes the pass instead of crawling from the start again.
+ */
+#define BR_SCRUB_CHECKPOINT_KEY "trusted.glusterfs.bit-rot.scrub-checkpoint"
+
+struct br_scrub_checkpoint {
+    uint64_t pass_start; /* start of the pass in progress, 0 if none */
+    uint64_t entries;    /* entries crawled (and scrubbed) so far */
+    uint64_t bytes;      /* bytes scrubbed so far */
+    uint64_t last_bytes; /* bytes scrubbed by the last complete pass */
+};
+
 struct br_scanfs {
     gf_lock_t entrylock;
 
@@ -65,6 +83,14 @@ struct br_scanfs {
     unsigned int entries;
     struct list_head queued;
     struct list_head ready;
+
+    /* pass progress (c.f. struct br_scrub_checkpoint) */
+    time_t pass_start;
+    uint64_t nr_entries; /* crawled in this pass */
+    uint64_t skip;       /* crawled before the scrubber restarted */
+    gf_atomic_t bytes;   /* scrubbed in this pass */
+    uint64_t last_bytes;
+    time_t saved; /* last checkpoint */
 };
 
 /* just need three states to track child status */
@@ -116,6 +142,31 @@ struct br_obj_n_workers {
                                       signing each object */
 };
 
+/**
+ * scrub rate: the configured target, raised to meet the deadline and
+ * lowered while reads from the bricks take longer than allowed.
+ */
+struct br_scrub_sched {
+    pthread_mutex_t lock;
+
+    uint64_t target;      /* bytes/sec, 0: unlimited */
+    uint32_t deadline;    /* seconds for a pass, 0: none */
+    uint32_t max_latency; /* msec, 0: no backoff */
+
+    uint64_t rate;        /* current rate, 0: unlimited */
+    gf_boolean_t backoff; /* rate lowered because of latency */
+    gf_boolean_t throttling;
+    gf_boolean_t late; /* deadline missed (logged) */
+    uint64_t latency;  /* moving average of read latency (usec) */
+
+    time_t pass_start;
+    uint64_t bytes;    /* scrubbed in this pass */
+    uint64_t estimate; /* scrubbed by the last complete pass */
+
+    time_t tick;         /* last adjustment of the rate */
+    uint64_t tick_bytes; /* scrubbed since */
+};
+
 struct br_scrubber {
     xlator_t *this;
 
@@ -142,6 +193,8 @@ struct br_scrubber {
      * list of "rotatable" subvolume(s) undergoing scrubbing
      */
     struct list_head scrublist;
+
+    struct br_scrub_sched sched;
 };
 
 struct br_monitor {
@@ -177,6 +230,20 @@ struct br_monitor {
 
 typedef struct br_obj_n_workers br_obj_n_workers_t;
 
+/**
+ * threads hashing the chunks of objects with Merkle signatures, along with
+ * the signer or scrubber thread handling each object.
+ */
+struct br_hasher {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    struct list_head jobs; /* objects with chunks left to hash */
+
+    int nr_threads; /* configured number of threads */
+    int running;    /* number of threads alive */
+};
+
 typedef struct br_private br_private_t;
 
 typedef void (*br_scrubbed_file_update)(br_private_t *priv);
@@ -218,6 +285,11 @@ struct br_private {
     struct br_scrubber fsscrub; /* scrubbers for this subvolume */
 
     struct br_monitor scrub_monitor; /* scrubber monitor */
+
+    struct br_hasher hasher; /* chunk hashing threads */
+
+    int8_t signaturetype; /* signature type used by the signer */
+    uint64_t chunksize;   /* minimum chunk size of Merkle signatures */
 };
 
 struct br_object {
@@ -248,6 +320,37 @@ br_log_object_path(xlator_t *, char *, const char *, int32_t);
 int32_t
 br_calculate_obj_checksum(unsigned char *, br_child_t *, fd_t *, struct iatt *);
 
+int32_t
+br_object_read_block_and_sign(xlator_t *, fd_t *, br_child_t *, off_t, size_t,
+                              SHA256_CTX *);
+
+void
+br_scrub_sched_account(xlator_t *, br_child_t *, size_t, uint64_t);
+
+int32_t
+br_hasher_init(xlator_t *, br_private_t *);
+
+void
+br_hasher_configure(xlator_t *, br_private_t *, int);
+
+void
+br_hasher_fini(xlator_t *, br_private_t *);
+
+br_merkle_signature_t *
+br_merkle_alloc(uint64_t, uint64_t);
+
+int32_t
+br_merkle_calculate(xlator_t *, br_child_t *, fd_t *, br_merkle_signature_t *,
+                    uint64_t);
+
+int32_t
+br_merkle_sign(xlator_t *, br_child_t *, fd_t *, struct iatt *,
+               br_merkle_signature_t **, dict_t **);
+
+int
+br_merkle_compare(br_merkle_signature_t *, br_merkle_signature_t *, char *,
+                  size_t);
+
 int32_t
 br_prepare_loc(xlator_t *, br_child_t *, loc_t *, gf_dirent_t *, loc_t *);
 
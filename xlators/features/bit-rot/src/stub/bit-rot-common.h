@@ -118,12 +118,35 @@ typedef struct br_stub_init {
 } br_stub_init_t;
 
 typedef enum {
-    BR_SIGNATURE_TYPE_VOID = -1,  /* object is not signed       */
-    BR_SIGNATURE_TYPE_ZERO = 0,   /* min boundary               */
-    BR_SIGNATURE_TYPE_SHA256 = 1, /* signed with SHA256         */
-    BR_SIGNATURE_TYPE_MAX = 2,    /* max boundary               */
+    BR_SIGNATURE_TYPE_VOID = -1,         /* object is not signed       */
+    BR_SIGNATURE_TYPE_ZERO = 0,          /* min boundary               */
+    BR_SIGNATURE_TYPE_SHA256 = 1,        /* signed with SHA256         */
+    BR_SIGNATURE_TYPE_MERKLE_SHA256 = 2, /* SHA256 hash tree of chunks */
+    BR_SIGNATURE_TYPE_MAX = 3,           /* max boundary               */
 } br_signature_type;
 
+/**
+ * a Merkle signature covers at most this many chunks: all of them fit in
+ * the signature xattr and the stub tracks them in a 64 bit mask. larger
+ * objects are signed with larger chunks.
+ */
+#define BR_MERKLE_MAX_CHUNKS 64
+
+/**
+ * chunks of an object modified since it was last signed, as tracked by the
+ * stub. fetched by the signer (virtual xattr) before it hashes the object
+ * and handed back with the signature, c.f. br_stub_perform_objsign().
+ */
+#define BR_DIRTY_CHUNKS_KEY "trusted.glusterfs.bit-rot.dirty-chunks"
+
+typedef struct br_dirty_chunks {
+    uint64_t mask;      /* chunks written since @signedversion */
+    uint64_t gen;       /* bumped by every modification */
+    uint64_t chunksize; /* 0 if modifications were not tracked */
+    unsigned long signedversion;
+    uint32_t epoch; /* c.f. br_stub_private_t */
+} br_dirty_chunks_t;
+
 /* BitRot stub start time (virtual xattr) */
 #define GLUSTERFS_GET_BR_STUB_INIT_TIME "trusted.glusterfs.bit-rot.stub-init"
 
@@ -139,6 +162,25 @@ br_is_signature_type_valid(int8_t signaturetype)
             (signaturetype < BR_SIGNATURE_TYPE_MAX));
 }
 
+static inline size_t
+br_merkle_signature_size(uint32_t nr_chunks)
+{
+    return sizeof(br_merkle_signature_t) + (nr_chunks * BR_MERKLE_HASH_LEN);
+}
+
+static inline int
+br_is_merkle_signature_valid(const char *signature, size_t signaturelen)
+{
+    const br_merkle_signature_t *merkle = NULL;
+
+    if (signaturelen < sizeof(br_merkle_signature_t))
+        return 0;
+
+    merkle = (const br_merkle_signature_t *)signature;
+    return (merkle->chunksize && (merkle->nr_chunks <= BR_MERKLE_MAX_CHUNKS) &&
+            (signaturelen == br_merkle_signature_size(merkle->nr_chunks)));
+}
+
 static inline void
 br_set_default_ongoingversion(br_version_t *buf, uint32_t *tv)
 {
@@ -27,4 +27,22 @@ typedef struct __attribute__((__packed__)) br_signature {
     char signature[0];
 } br_signature_t;
 
+#define BR_MERKLE_HASH_LEN 32 /* SHA256_DIGEST_LENGTH */
+
+/**
+ * signature of BR_SIGNATURE_TYPE_MERKLE_SHA256 objects: the object is split
+ * in @nr_chunks chunks of @chunksize bytes (the last one may be shorter).
+ * @leaves holds the hash of each chunk and @root the root of the hash tree
+ * built over them.
+ */
+typedef struct __attribute__((__packed__)) br_merkle_signature {
+    uint64_t chunksize;
+    uint64_t size; /* object size when signed */
+    uint32_t nr_chunks;
+    uint32_t reserved;
+
+    unsigned char root[BR_MERKLE_HASH_LEN];
+    unsigned char leaves[0][BR_MERKLE_HASH_LEN];
+} br_merkle_signature_t;
+
 #endif
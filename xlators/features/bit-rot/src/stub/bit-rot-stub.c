@@ -165,6 +165,9 @@ init(xlator_t *this)
     pthread_cond_init(&priv->cond, NULL);
     INIT_LIST_HEAD(&priv->squeue);
 
+    /* 0 is never valid, c.f. br_stub_perform_objsign() */
+    priv->epoch = 1;
+
     /* Thread creations need 'this' to be passed so that THIS can be
      * assigned inside the thread. So setting this->private here.
      */
@@ -221,11 +224,15 @@ int32_t
 reconfigure(xlator_t *this, dict_t *options)
 {
     int32_t ret = -1;
+    gf_boolean_t do_versioning = _gf_false;
     br_stub_private_t *priv = NULL;
 
     priv = this->private;
 
+    do_versioning = priv->do_versioning;
     GF_OPTION_RECONF("bitrot", priv->do_versioning, options, bool, err);
+    if (priv->do_versioning && !do_versioning)
+        priv->epoch++;
     if (priv->do_versioning && !priv->signth) {
         ret = gf_thread_create(&priv->signth, NULL, br_stub_signth, this,
                                "brssign");
@@ -546,6 +553,9 @@ br_stub_cleanup_local(br_stub_local_t *local)
     local->fopstub = NULL;
     local->versioningtype = 0;
     local->u.context.version = 0;
+    local->u.context.chunksize = 0;
+    local->u.context.offset = 0;
+    memset(&local->u.context.dirty, 0, sizeof(local->u.context.dirty));
     if (local->u.context.fd) {
         fd_unref(local->u.context.fd);
         local->u.context.fd = NULL;
@@ -701,6 +711,88 @@ error_return:
     return -1;
 }
 
+/**
+ * Record the chunks touched by a modification (@toeof: every chunk from
+ * @offset on), so that the signer only rehashes those when the object is
+ * signed with a Merkle signature. Modifications beyond the last chunk a
+ * signature can have change the chunk size and stop the tracking.
+ */
+static void
+br_stub_mark_chunks_dirty(inode_t *inode, br_stub_inode_ctx_t *ctx,
+                          off_t offset, size_t len, gf_boolean_t toeof)
+{
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    LOCK(&inode->lock);
+    {
+        ctx->dirty_gen++;
+        if (!ctx->chunksize)
+            goto unblock;
+
+        first = (uint64_t)offset / ctx->chunksize;
+        if (toeof)
+            last = BR_MERKLE_MAX_CHUNKS - 1;
+        else
+            last = ((uint64_t)offset + (len ? len - 1 : 0)) / ctx->chunksize;
+
+        if ((first >= BR_MERKLE_MAX_CHUNKS) ||
+            (last >= BR_MERKLE_MAX_CHUNKS)) {
+            ctx->chunksize = 0;
+            goto unblock;
+        }
+
+        ctx->dirty_chunks |= (~0ULL >> (63 - last)) & (~0ULL << first);
+    }
+unblock:
+    UNLOCK(&inode->lock);
+}
+
+/**
+ * Chunks are marked dirty once the modification is on disk. Marked at
+ * wind, the signer could rehash them while they still hold the old data
+ * and clear them with the generation it read, leaving a stale leaf that
+ * the scrubber later reports as corruption.
+ */
+static void
+br_stub_mark_chunks_written(xlator_t *this, br_stub_local_t *local,
+                            size_t len, gf_boolean_t toeof)
+{
+    inode_t *inode = local->u.context.inode;
+    uint64_t ctx_addr = 0;
+
+    if (!inode || br_stub_get_inode_ctx(this, inode, &ctx_addr))
+        return;
+
+    br_stub_mark_chunks_dirty(inode, (br_stub_inode_ctx_t *)(long)ctx_addr,
+                              local->u.context.offset, len, toeof);
+}
+
+/**
+ * The inode is already versioned and modified, the local only carries the
+ * modified range to the callback.
+ */
+static int
+br_stub_tracking_prep(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      off_t offset)
+{
+    br_stub_local_t *local = NULL;
+
+    local = br_stub_alloc_local(this);
+    if (!local) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, BRS_MSG_NO_MEMORY,
+               "local allocation failed (gfid: %s)",
+               uuid_utoa(fd->inode->gfid));
+        return -1;
+    }
+
+    br_stub_fill_local(local, NULL, fd, fd->inode, fd->inode->gfid, 0, 0);
+    local->u.context.offset = offset;
+    frame->local = local;
+
+    return 0;
+}
+
 /**
  * The possible return values from br_stub_is_bad_object () are:
  * 1) 0  => as per the inode context object is not bad
@@ -901,11 +993,98 @@ done:
 
 /* fsetxattr() */
 
+/**
+ * A signature is on disk: from now on the dirty chunks are relative to it.
+ * That only holds if the object was not modified since the signer fetched
+ * the dirty chunks (it rehashed those, and read everything else after) and
+ * versioning was not turned off and on in between. Otherwise, stop the
+ * tracking and let the next signing hash the whole object.
+ */
+static void
+br_stub_reset_dirty_chunks(xlator_t *this, br_stub_local_t *local)
+{
+    inode_t *inode = NULL;
+    uint64_t ctx_addr = 0;
+    br_stub_inode_ctx_t *ctx = NULL;
+    br_stub_private_t *priv = NULL;
+    br_dirty_chunks_t *dirty = NULL;
+
+    priv = this->private;
+    inode = local->u.context.inode;
+    dirty = &local->u.context.dirty;
+
+    if (br_stub_get_inode_ctx(this, inode, &ctx_addr))
+        return;
+    ctx = (br_stub_inode_ctx_t *)(long)ctx_addr;
+
+    LOCK(&inode->lock);
+    {
+        if ((dirty->epoch == priv->epoch) && (dirty->gen == ctx->dirty_gen)) {
+            ctx->dirty_chunks = 0;
+            ctx->chunksize = local->u.context.chunksize;
+            ctx->dirty_epoch = priv->epoch;
+            ctx->signedversion = local->u.context.version;
+        } else {
+            ctx->chunksize = 0;
+        }
+    }
+    UNLOCK(&inode->lock);
+}
+
+static int32_t
+br_stub_perform_objsign_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    br_stub_local_t *local = NULL;
+
+    local = frame->local;
+    frame->local = NULL;
+
+    if (local && (op_ret == 0))
+        br_stub_reset_dirty_chunks(this, local);
+
+    STACK_UNWIND_STRICT(fsetxattr, frame, op_ret, op_errno, xdata);
+
+    br_stub_cleanup_local(local);
+    br_stub_dealloc_local(local);
+    return 0;
+}
+
 int32_t
 br_stub_perform_objsign(call_frame_t *frame, xlator_t *this, fd_t *fd,
                         dict_t *dict, int flags, dict_t *xdata)
 {
-    STACK_WIND(frame, default_fsetxattr_cbk, FIRST_CHILD(this),
+    br_stub_local_t *local = NULL;
+    br_signature_t *sbuf = NULL;
+    br_dirty_chunks_t *dirty = NULL;
+    br_merkle_signature_t *merkle = NULL;
+
+    /**
+     * without a local, the dirty chunks of the object are not reset: the
+     * next signing rehashes the chunks it would have anyway.
+     */
+    local = br_stub_alloc_local(this);
+    if (local) {
+        br_stub_fill_local(local, NULL, fd, fd->inode, fd->inode->gfid,
+                           BR_STUB_NO_VERSIONING, 0);
+
+        if (!dict_get_bin(dict, BITROT_SIGNING_VERSION_KEY, (void **)&sbuf)) {
+            local->u.context.version = sbuf->signedversion;
+            if (sbuf->signaturetype == BR_SIGNATURE_TYPE_MERKLE_SHA256) {
+                merkle = (br_merkle_signature_t *)sbuf->signature;
+                local->u.context.chunksize = merkle->chunksize;
+            }
+        }
+
+        if (!dict_get_bin(xdata, BR_DIRTY_CHUNKS_KEY, (void **)&dirty))
+            local->u.context.dirty = *dirty;
+
+        frame->local = local;
+    }
+
+    dict_del(xdata, BR_DIRTY_CHUNKS_KEY);
+
+    STACK_WIND(frame, br_stub_perform_objsign_cbk, FIRST_CHILD(this),
                FIRST_CHILD(this)->fops->fsetxattr, fd, dict, flags, xdata);
 
     dict_unref(xdata);
@@ -1047,6 +1226,9 @@ br_stub_prepare_signature(xlator_t *this, dict_t *dict, inode_t *inode,
         goto error_return;
 
     signaturelen = sign->signaturelen;
+    if ((sign->signaturetype == BR_SIGNATURE_TYPE_MERKLE_SHA256) &&
+        !br_is_merkle_signature_valid(sign->signature, signaturelen))
+        goto error_return;
     ret = br_stub_alloc_versions(NULL, &sbuf, signaturelen);
     if (ret)
         goto error_return;
@@ -1812,6 +1994,66 @@ unwind:
         dict_unref(xattr);
 }
 
+/**
+ * hand the dirty chunks of an object to the signer. tracking is off (the
+ * whole object is rehashed) if versioning was turned off and on since the
+ * object was last signed.
+ */
+static void
+br_stub_send_dirty_chunks(call_frame_t *frame, xlator_t *this, inode_t *inode)
+{
+    int op_ret = 0;
+    int op_errno = 0;
+    uint64_t ctx_addr = 0;
+    dict_t *xattr = NULL;
+    br_stub_inode_ctx_t *ctx = NULL;
+    br_stub_private_t *priv = NULL;
+    br_dirty_chunks_t dirty = {
+        0,
+    };
+
+    priv = this->private;
+
+    xattr = dict_new();
+    if (!xattr) {
+        op_ret = -1;
+        op_errno = ENOMEM;
+        goto unwind;
+    }
+
+    dirty.epoch = priv->epoch;
+
+    LOCK(&inode->lock);
+    {
+        if (__br_stub_get_inode_ctx(this, inode, &ctx_addr) == 0) {
+            ctx = (br_stub_inode_ctx_t *)(long)ctx_addr;
+
+            dirty.gen = ctx->dirty_gen;
+            if (ctx->chunksize && (ctx->dirty_epoch == priv->epoch)) {
+                dirty.mask = ctx->dirty_chunks;
+                dirty.chunksize = ctx->chunksize;
+                dirty.signedversion = ctx->signedversion;
+            }
+        }
+    }
+    UNLOCK(&inode->lock);
+
+    op_ret = dict_set_static_bin(xattr, BR_DIRTY_CHUNKS_KEY, (void *)&dirty,
+                                 sizeof(br_dirty_chunks_t));
+    if (op_ret < 0) {
+        op_errno = EINVAL;
+        goto unwind;
+    }
+
+    op_ret = sizeof(br_dirty_chunks_t);
+
+unwind:
+    STACK_UNWIND_STRICT(fgetxattr, frame, op_ret, op_errno, xattr, NULL);
+
+    if (xattr)
+        dict_unref(xattr);
+}
+
 int
 br_stub_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
                  const char *name, dict_t *xdata)
@@ -1950,6 +2192,14 @@ br_stub_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
     if (!IA_ISREG(fd->inode->ia_type))
         goto wind;
 
+    if ((frame->root->pid == GF_CLIENT_PID_BITD) &&
+        (strncmp(name, BR_DIRTY_CHUNKS_KEY, SLEN(BR_DIRTY_CHUNKS_KEY)) ==
+         0)) {
+        BR_STUB_RESET_LOCAL_NULL(frame);
+        br_stub_send_dirty_chunks(frame, this, fd->inode);
+        return 0;
+    }
+
     if (name && (strncmp(name, GLUSTERFS_GET_OBJECT_SIGNATURE,
                          sizeof(GLUSTERFS_GET_OBJECT_SIGNATURE) - 1) == 0)) {
         cookie = (void *)BR_STUB_REQUEST_COOKIE;
@@ -2031,6 +2281,11 @@ br_stub_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     if (op_ret < 0)
         goto unwind;
 
+    br_stub_mark_chunks_written(this, local, op_ret, _gf_false);
+
+    if (!local->versioningtype)
+        goto unwind;
+
     ret = br_stub_mark_inode_modified(this, local);
     if (ret) {
         op_ret = -1;
@@ -2104,10 +2359,17 @@ br_stub_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     /**
      * The inode is not dirty and also witnessed at least one successful
      * modification operation. Therefore, subsequent operations need not
-     * perform any special tracking.
+     * perform any special tracking, other than of the chunks they modify.
      */
-    if (!inc_version && modified)
+    if (!inc_version && modified) {
+        ret = br_stub_tracking_prep(frame, this, fd, offset);
+        if (ret) {
+            op_errno = ENOMEM;
+            goto unwind;
+        }
+        cbk = br_stub_writev_cbk;
         goto wind;
+    }
 
     /**
      * okay.. so, either the inode needs versioning or the modification
@@ -2120,6 +2382,7 @@ br_stub_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
         goto unwind;
 
     local = frame->local;
+    local->u.context.offset = offset;
     if (!inc_version) {
         br_stub_fill_local(local, NULL, fd, fd->inode, fd->inode->gfid,
                            BR_STUB_NO_VERSIONING, 0);
@@ -2171,6 +2434,11 @@ br_stub_ftruncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     if (op_ret < 0)
         goto unwind;
 
+    br_stub_mark_chunks_written(this, local, 0, _gf_true);
+
+    if (!local->versioningtype)
+        goto unwind;
+
     ret = br_stub_mark_inode_modified(this, local);
     if (ret) {
         op_ret = -1;
@@ -2229,14 +2497,22 @@ br_stub_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     if (ret)
         goto unwind;
 
-    if (!inc_version && modified)
+    if (!inc_version && modified) {
+        ret = br_stub_tracking_prep(frame, this, fd, offset);
+        if (ret) {
+            op_errno = ENOMEM;
+            goto unwind;
+        }
+        cbk = br_stub_ftruncate_cbk;
         goto wind;
+    }
 
     ret = br_stub_versioning_prep(frame, this, fd, ctx);
     if (ret)
         goto unwind;
 
     local = frame->local;
+    local->u.context.offset = offset;
     if (!inc_version) {
         br_stub_fill_local(local, NULL, fd, fd->inode, fd->inode->gfid,
                            BR_STUB_NO_VERSIONING, 0);
@@ -2286,6 +2562,11 @@ br_stub_truncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     if (op_ret < 0)
         goto unwind;
 
+    br_stub_mark_chunks_written(this, local, 0, _gf_true);
+
+    if (!local->versioningtype)
+        goto unwind;
+
     ret = br_stub_mark_inode_modified(this, local);
     if (ret) {
         op_ret = -1;
@@ -2369,14 +2650,22 @@ br_stub_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
     if (ret)
         goto unwind;
 
-    if (!inc_version && modified)
+    if (!inc_version && modified) {
+        ret = br_stub_tracking_prep(frame, this, fd, offset);
+        if (ret) {
+            op_errno = ENOMEM;
+            goto cleanup_fd;
+        }
+        cbk = br_stub_truncate_cbk;
         goto wind;
+    }
 
     ret = br_stub_versioning_prep(frame, this, fd, ctx);
     if (ret)
         goto cleanup_fd;
 
     local = frame->local;
+    local->u.context.offset = offset;
     if (!inc_version) {
         br_stub_fill_local(local, NULL, fd, fd->inode, fd->inode->gfid,
                            BR_STUB_NO_VERSIONING, 0);
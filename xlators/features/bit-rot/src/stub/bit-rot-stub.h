@@ -81,6 +81,13 @@ typedef struct br_stub_inode_ctx {
     struct list_head fd_list; /* list of open fds or fds participating in
                                  write operations */
     gf_boolean_t bad_object;
+
+    /* chunks modified since the (Merkle) signature of @signedversion */
+    uint64_t dirty_chunks;
+    uint64_t dirty_gen;
+    uint64_t chunksize; /* 0: modifications are not tracked */
+    uint32_t dirty_epoch;
+    unsigned long signedversion;
 } br_stub_inode_ctx_t;
 
 typedef struct br_stub_fd {
@@ -111,6 +118,9 @@ typedef struct br_stub_local {
             uuid_t gfid;
             inode_t *inode;
             unsigned long version;
+            uint64_t chunksize;      /* of the signature being stored */
+            br_dirty_chunks_t dirty; /* as seen by the signer */
+            off_t offset;            /* of the modification */
         } context;
     } u;
 } br_stub_local_t;
@@ -140,6 +150,9 @@ typedef struct br_stub_private {
     char stub_basepath[BR_PATH_MAX_EXTRA];
 
     uuid_t bad_object_dir_gfid;
+
+    uint32_t epoch; /* bumped when versioning is turned back on, as
+                       modifications were not tracked in between */
 } br_stub_private_t;
 
 br_stub_fd_t *
@@ -252,4 +252,8 @@ pick_event_unordered(struct gf_event_list *, struct gf_event **);
 void *
 gf_changelog_connection_janitor(void *);
 
+/* reader of indexed changelogs, on an already open changelog */
+gf_changelog_reader_t *
+gf_changelog_reader_fdopen(int fd);
+
 #endif
@@ -424,6 +424,114 @@ out:
     return ret;
 }
 
+/**
+ * indexed decoder: the reader does the walking, records come out in the
+ * same format as the ascii decoder produces.
+ */
+static int
+gf_changelog_parse_indexed(xlator_t *this, gf_changelog_journal_t *jnl,
+                           int from_fd, int to_fd, int version_idx)
+{
+    int i = 0;
+    int ret = -1;
+    int nr_raw = 0;
+    off_t off = 0;
+    size_t len = 0;
+    char *ascii = NULL;
+    char *eptr = NULL;
+    const char *field = NULL;
+    const char *fopname = NULL;
+    gf_changelog_record_t record = {
+        0,
+    };
+    gf_changelog_reader_t *reader = NULL;
+
+    reader = gf_changelog_reader_fdopen(from_fd);
+    if (!reader) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, CHANGELOG_LIB_MSG_MMAP_FAILED,
+               "could not map indexed changelog");
+        goto out;
+    }
+
+    ascii = GF_CALLOC(LINE_BUFSIZE, sizeof(char), gf_common_mt_char);
+    if (!ascii)
+        goto out;
+
+    while ((ret = gf_changelog_reader_next(reader, &record)) == 1) {
+        off = 0;
+
+        GF_CHANGELOG_FILL_BUFFER(&record.type, ascii, off, 1);
+        GF_CHANGELOG_FILL_BUFFER(" ", ascii, off, 1);
+        field = uuid_utoa(record.gfid);
+        GF_CHANGELOG_FILL_BUFFER(field, ascii, off, strlen(field));
+
+        nr_raw = 0;
+        if (record.type != 'D') {
+            fopname = (record.fop < GF_FOP_MAXVALUE) ? gf_fop_list[record.fop]
+                                                     : NULL;
+            if (fopname == NULL) {
+                ret = -1;
+                break;
+            }
+
+            GF_CHANGELOG_FILL_BUFFER(" ", ascii, off, 1);
+            GF_CHANGELOG_FILL_BUFFER(fopname, ascii, off, strlen(fopname));
+
+            if (record.type == 'E')
+                nr_raw = nr_extra_recs[version_idx][record.fop];
+        }
+
+        /* mode, uid and gid as they are, then the (encoded) entries */
+        field = record.fields;
+        for (i = 0; i < record.nr_fields; i++, field += len + 1) {
+            len = strlen(field);
+            if (!len)
+                continue;
+
+            GF_CHANGELOG_FILL_BUFFER(" ", ascii, off, 1);
+            if (i < nr_raw) {
+                GF_CHANGELOG_FILL_BUFFER(field, ascii, off, len);
+                continue;
+            }
+
+            eptr = calloc(3, len + 1);
+            if (!eptr) {
+                ret = -1;
+                break;
+            }
+
+            gf_rfc3986_encode_space_newline((unsigned char *)field, eptr,
+                                            jnl->rfc3986_space_newline);
+            GF_CHANGELOG_FILL_BUFFER(eptr, ascii, off, strlen(eptr));
+            free(eptr);
+        }
+
+        if (ret == -1)
+            break;
+
+        GF_CHANGELOG_FILL_BUFFER("\n", ascii, off, 1);
+
+        if (gf_changelog_write(to_fd, ascii, off) != off) {
+            gf_msg(this->name, GF_LOG_ERROR, errno,
+                   CHANGELOG_LIB_MSG_ASCII_ERROR,
+                   "processing indexed changelog failed due to "
+                   " error in writing change");
+            ret = -1;
+            break;
+        }
+    }
+
+    if (ret == -1)
+        gf_msg(this->name, GF_LOG_ERROR, errno, CHANGELOG_LIB_MSG_PARSE_ERROR,
+               "error parsing indexed changelog");
+
+out:
+    GF_FREE(ascii);
+    gf_changelog_reader_close(reader);
+
+    return ret;
+}
+
 static int
 gf_changelog_decode(xlator_t *this, gf_changelog_journal_t *jnl, int from_fd,
                     int to_fd, struct stat *stbuf, int *zerob)
@@ -486,6 +594,11 @@ gf_changelog_decode(xlator_t *this, gf_changelog_journal_t *jnl, int from_fd,
             ret = gf_changelog_parse_ascii(this, jnl, from_fd, to_fd, elen,
                                            stbuf, version_idx);
             break;
+
+        case CHANGELOG_ENCODE_INDEXED:
+            ret = gf_changelog_parse_indexed(this, jnl, from_fd, to_fd,
+                                             version_idx);
+            break;
     }
 
 out:
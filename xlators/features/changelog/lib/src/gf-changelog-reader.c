@@ -0,0 +1,492 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <sys/mman.h>
+#include <glusterfs/syscall.h>
+
+#include "gf-changelog-helpers.h"
+
+/* from the changelog translator */
+#include "changelog-misc.h"
+#include "changelog-index.h"
+
+/**
+ * Reader for changelogs with the indexed encoding (see changelog-index.h).
+ *
+ * The changelog is mapped as a whole. Filters are applied in three steps:
+ * the footer tells whether the changelog can have any matching record at
+ * all, the sorted gfid index turns a gfid prefix into the list of records
+ * to look at, and the fixed size record headers decide the rest without
+ * touching the fields.
+ *
+ * Nothing here depends on the library being initialized, so that readers
+ * can be used on their own (e.g. on changelogs copied off a brick). Hence
+ * plain calloc() and no logging: errors are reported through errno.
+ */
+
+struct gf_changelog_reader {
+    char *map;
+    size_t size;
+
+    size_t start; /* first record */
+    size_t end;   /* end of the records */
+
+    /* NULL if the changelog is not (or not yet) indexed */
+    struct changelog_index_footer *footer;
+    struct changelog_index_footer footer_buf;
+    uint64_t index_offset;
+
+    /* filter */
+    unsigned int types;
+    gf_boolean_t match_fops;
+    uint64_t fops[CHANGELOG_INDEX_FOP_WORDS];
+    unsigned char prefix[16];
+    size_t prefix_len;
+    unsigned long start_time;
+    unsigned long end_time;
+
+    /* position */
+    gf_boolean_t eof;
+    size_t next;
+    gf_boolean_t use_offsets; /* walk @offsets rather than the records */
+    uint64_t *offsets;
+    uint64_t nr_offsets;
+    uint64_t cursor;
+};
+
+static int
+gf_changelog_reader_header(gf_changelog_reader_t *reader)
+{
+    int encoding = -1;
+    int major = -1;
+    int minor = -1;
+    char *eol = NULL;
+    char line[1024] = {
+        0,
+    };
+
+    eol = memchr(reader->map, '\n', min(reader->size, sizeof(line) - 1));
+    if (!eol)
+        return -1;
+
+    memcpy(line, reader->map, eol - reader->map + 1);
+    if (sscanf(line, CHANGELOG_HEADER, &major, &minor, &encoding) != 3)
+        return -1;
+
+    if (encoding != CHANGELOG_ENCODE_INDEXED)
+        return -1;
+
+    reader->start = eol - reader->map + 1;
+    reader->end = reader->size;
+
+    return 0;
+}
+
+/* Uses the index only if it is consistent with the size of the file. */
+static void
+gf_changelog_reader_footer(gf_changelog_reader_t *reader)
+{
+    uint64_t index_len = 0;
+    struct changelog_index_footer *footer = &reader->footer_buf;
+
+    if (reader->size < reader->start + sizeof(*footer))
+        return;
+
+    memcpy(footer, reader->map + reader->size - sizeof(*footer),
+           sizeof(*footer));
+
+    if (memcmp(footer->cf_magic, CHANGELOG_INDEX_MAGIC,
+               CHANGELOG_INDEX_MAGIC_LEN) ||
+        (footer->cf_version != CHANGELOG_INDEX_VERSION))
+        return;
+
+    index_len = footer->cf_records * sizeof(struct changelog_index_entry);
+    if ((footer->cf_index_offset < reader->start) ||
+        (footer->cf_index_offset + index_len + sizeof(*footer) !=
+         reader->size))
+        return;
+
+    reader->footer = footer;
+    reader->index_offset = footer->cf_index_offset;
+    reader->end = footer->cf_index_offset;
+}
+
+gf_changelog_reader_t *
+gf_changelog_reader_fdopen(int fd)
+{
+    struct stat stbuf = {
+        0,
+    };
+    gf_changelog_reader_t *reader = NULL;
+
+    if (sys_fstat(fd, &stbuf))
+        return NULL;
+
+    if (stbuf.st_size == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    reader = calloc(1, sizeof(*reader));
+    if (!reader)
+        return NULL;
+
+    reader->size = stbuf.st_size;
+    reader->map = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (reader->map == MAP_FAILED) {
+        free(reader);
+        return NULL;
+    }
+
+    if (gf_changelog_reader_header(reader)) {
+        gf_changelog_reader_close(reader);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    gf_changelog_reader_footer(reader);
+    (void)gf_changelog_reader_filter(reader, NULL);
+
+    return reader;
+}
+
+gf_changelog_reader_t *
+gf_changelog_reader_open(const char *path)
+{
+    int fd = -1;
+    int saved_errno = 0;
+    gf_changelog_reader_t *reader = NULL;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    reader = gf_changelog_reader_fdopen(fd);
+    saved_errno = errno;
+    sys_close(fd);
+    errno = saved_errno;
+
+    return reader;
+}
+
+void
+gf_changelog_reader_close(gf_changelog_reader_t *reader)
+{
+    if (!reader)
+        return;
+
+    if (reader->map && (reader->map != MAP_FAILED))
+        (void)munmap(reader->map, reader->size);
+    free(reader->offsets);
+    free(reader);
+}
+
+/* Can a changelog with this footer contain anything that matches? */
+static gf_boolean_t
+gf_changelog_reader_may_match(gf_changelog_reader_t *reader)
+{
+    int i = 0;
+    gf_boolean_t fops = _gf_false;
+    struct changelog_index_footer *footer = reader->footer;
+
+    if (!footer)
+        return _gf_true;
+
+    if (footer->cf_records == 0)
+        return _gf_false;
+
+    if (reader->types && !(reader->types & footer->cf_types))
+        return _gf_false;
+
+    if (reader->match_fops) {
+        for (i = 0; i < CHANGELOG_INDEX_FOP_WORDS; i++)
+            if (reader->fops[i] & footer->cf_fops[i])
+                fops = _gf_true;
+        if (!fops)
+            return _gf_false;
+    }
+
+    if (reader->start_time && (footer->cf_max_time < reader->start_time))
+        return _gf_false;
+
+    if (reader->end_time && (footer->cf_min_time > reader->end_time))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+static void
+gf_changelog_reader_entry(gf_changelog_reader_t *reader, uint64_t i,
+                          struct changelog_index_entry *entry)
+{
+    memcpy(entry,
+           reader->map + reader->index_offset +
+               (i * sizeof(struct changelog_index_entry)),
+           sizeof(*entry));
+}
+
+static int
+gf_changelog_offset_cmp(const void *a, const void *b)
+{
+    uint64_t o1 = *(const uint64_t *)a;
+    uint64_t o2 = *(const uint64_t *)b;
+
+    if (o1 == o2)
+        return 0;
+
+    return (o1 < o2) ? -1 : 1;
+}
+
+/* Looks the gfid prefix up in the index, giving the offsets of the records
+ * to visit, in the order they were logged. */
+static int
+gf_changelog_reader_lookup(gf_changelog_reader_t *reader)
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    uint64_t mid = 0;
+    uint64_t i = 0;
+    struct changelog_index_entry entry;
+
+    lo = 0;
+    hi = reader->footer->cf_records;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        gf_changelog_reader_entry(reader, mid, &entry);
+        if (memcmp(entry.ce_gfid, reader->prefix, reader->prefix_len) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (i = lo; i < reader->footer->cf_records; i++) {
+        gf_changelog_reader_entry(reader, i, &entry);
+        if (memcmp(entry.ce_gfid, reader->prefix, reader->prefix_len))
+            break;
+    }
+
+    reader->use_offsets = _gf_true;
+    reader->nr_offsets = i - lo;
+    if (!reader->nr_offsets)
+        return 0;
+
+    reader->offsets = calloc(reader->nr_offsets, sizeof(uint64_t));
+    if (!reader->offsets)
+        return -1;
+
+    for (i = 0; i < reader->nr_offsets; i++) {
+        gf_changelog_reader_entry(reader, lo + i, &entry);
+        reader->offsets[i] = entry.ce_offset;
+    }
+
+    qsort(reader->offsets, reader->nr_offsets, sizeof(uint64_t),
+          gf_changelog_offset_cmp);
+
+    return 0;
+}
+
+int
+gf_changelog_reader_filter(gf_changelog_reader_t *reader,
+                           const gf_changelog_filter_t *filter)
+{
+    int i = 0;
+    int fop = 0;
+
+    if (!reader) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (filter) {
+        if (filter->gfid_prefix_len > sizeof(reader->prefix) ||
+            (filter->gfid_prefix_len && !filter->gfid_prefix) ||
+            (filter->nr_fops > 0 && !filter->fops)) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        for (i = 0; i < filter->nr_fops; i++) {
+            fop = filter->fops[i];
+            if (fop <= 0 || fop >= (CHANGELOG_INDEX_FOP_WORDS * 64)) {
+                errno = EINVAL;
+                return -1;
+            }
+        }
+    }
+
+    free(reader->offsets);
+    reader->offsets = NULL;
+    reader->nr_offsets = 0;
+    reader->cursor = 0;
+    reader->use_offsets = _gf_false;
+    reader->next = reader->start;
+
+    reader->types = 0;
+    reader->match_fops = _gf_false;
+    memset(reader->fops, 0, sizeof(reader->fops));
+    reader->prefix_len = 0;
+    reader->start_time = 0;
+    reader->end_time = 0;
+
+    if (filter) {
+        reader->types = filter->types;
+        for (i = 0; i < filter->nr_fops; i++) {
+            CHANGELOG_INDEX_FOP_SET(reader->fops, filter->fops[i]);
+            reader->match_fops = _gf_true;
+        }
+        reader->prefix_len = filter->gfid_prefix_len;
+        if (reader->prefix_len)
+            memcpy(reader->prefix, filter->gfid_prefix, reader->prefix_len);
+        reader->start_time = filter->start;
+        reader->end_time = filter->end;
+    }
+
+    reader->eof = !gf_changelog_reader_may_match(reader);
+
+    if (!reader->eof && reader->prefix_len && reader->footer)
+        return gf_changelog_reader_lookup(reader);
+
+    return 0;
+}
+
+static gf_boolean_t
+gf_changelog_reader_match(gf_changelog_reader_t *reader,
+                          struct changelog_index_record *rec)
+{
+    if (reader->types &&
+        !(reader->types & changelog_index_type_bit(rec->cr_type)))
+        return _gf_false;
+
+    if (reader->match_fops &&
+        ((rec->cr_type == 'D') ||
+         (rec->cr_fop >= (CHANGELOG_INDEX_FOP_WORDS * 64)) ||
+         !CHANGELOG_INDEX_FOP_ISSET(reader->fops, rec->cr_fop)))
+        return _gf_false;
+
+    if (reader->start_time && (rec->cr_time < reader->start_time))
+        return _gf_false;
+
+    if (reader->end_time && (rec->cr_time > reader->end_time))
+        return _gf_false;
+
+    if (reader->prefix_len &&
+        memcmp(rec->cr_gfid, reader->prefix, reader->prefix_len))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+/**
+ * Reads the header of the record at @offset. Returns 0 if the record is
+ * sane, 1 if it runs past the end of the records and -1 if it is garbage.
+ */
+static int
+gf_changelog_reader_record(gf_changelog_reader_t *reader, size_t offset,
+                           struct changelog_index_record *rec)
+{
+    if ((offset < reader->start) || (offset + sizeof(*rec) > reader->end))
+        return 1;
+
+    memcpy(rec, reader->map + offset, sizeof(*rec));
+
+    if ((rec->cr_len < sizeof(*rec)) ||
+        (rec->cr_len % CHANGELOG_INDEX_ALIGN) ||
+        !changelog_index_type_bit(rec->cr_type))
+        return -1;
+
+    if (offset + rec->cr_len > reader->end)
+        return 1;
+
+    return 0;
+}
+
+static int
+gf_changelog_reader_fill(gf_changelog_reader_t *reader, size_t offset,
+                         struct changelog_index_record *rec,
+                         gf_changelog_record_t *record)
+{
+    int i = 0;
+    char *fields = NULL;
+    char *nul = NULL;
+    size_t left = 0;
+
+    fields = reader->map + offset + sizeof(*rec);
+    left = rec->cr_len - sizeof(*rec);
+
+    record->fields = fields;
+    record->fields_len = 0;
+    for (i = 0; i < rec->cr_nr_fields; i++) {
+        nul = memchr(fields + record->fields_len, '\0',
+                     left - record->fields_len);
+        if (!nul)
+            return -1;
+        record->fields_len = nul - fields + 1;
+    }
+
+    record->type = rec->cr_type;
+    record->fop = (rec->cr_type == 'D') ? 0 : rec->cr_fop;
+    record->time = rec->cr_time;
+    memcpy(record->gfid, rec->cr_gfid, sizeof(record->gfid));
+    record->nr_fields = rec->cr_nr_fields;
+
+    return 0;
+}
+
+int
+gf_changelog_reader_next(gf_changelog_reader_t *reader,
+                         gf_changelog_record_t *record)
+{
+    int ret = 0;
+    size_t offset = 0;
+    struct changelog_index_record rec;
+
+    if (!reader || !record) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    while (!reader->eof) {
+        if (reader->use_offsets) {
+            if (reader->cursor == reader->nr_offsets)
+                break;
+            offset = reader->offsets[reader->cursor++];
+        } else {
+            offset = reader->next;
+            if (offset >= reader->end)
+                break;
+        }
+
+        ret = gf_changelog_reader_record(reader, offset, &rec);
+        if (ret == 1 && !reader->footer && !reader->use_offsets) {
+            /* partly written tail of a changelog without index */
+            break;
+        }
+        if (ret)
+            goto err;
+
+        reader->next = offset + rec.cr_len;
+
+        if (!gf_changelog_reader_match(reader, &rec))
+            continue;
+
+        if (gf_changelog_reader_fill(reader, offset, &rec, record))
+            goto err;
+
+        return 1;
+    }
+
+    reader->eof = _gf_true;
+    return 0;
+
+err:
+    reader->eof = _gf_true;
+    errno = EIO;
+    return -1;
+}
@@ -212,6 +212,203 @@ changelog_encode_binary(xlator_t *this, changelog_log_data_t *cld)
     return changelog_write_change(priv, buffer, off);
 }
 
+/**
+ * fixed size header followed by the fields as text; see changelog-index.h
+ */
+int
+changelog_encode_indexed(xlator_t *this, changelog_log_data_t *cld)
+{
+    int i = 0;
+    int ret = 0;
+    size_t off = 0;
+    size_t len = 0;
+    char *path = NULL;
+    char *buffer = NULL;
+    changelog_opt_t *co = NULL;
+    changelog_priv_t *priv = NULL;
+    struct changelog_index_record *rec = NULL;
+
+    priv = this->private;
+
+    /* numbers take up to 10 digits and a terminator as text */
+    buffer = alloca(sizeof(*rec) + cld->cld_ptr_len +
+                    (cld->cld_xtra_records * 12) + CHANGELOG_INDEX_ALIGN);
+
+    rec = (struct changelog_index_record *)buffer;
+    memset(rec, 0, sizeof(*rec));
+    rec->cr_type = priv->maps[cld->cld_type][0];
+    rec->cr_time = (uint64_t)time(NULL);
+    memcpy(rec->cr_gfid, cld->cld_gfid, sizeof(rec->cr_gfid));
+    off = sizeof(*rec);
+
+    co = (changelog_opt_t *)cld->cld_ptr;
+    for (; i < cld->cld_xtra_records; i++, co++) {
+        switch (co->co_type) {
+            case CHANGELOG_OPT_REC_FOP:
+                rec->cr_fop = co->co_fop;
+                break;
+            case CHANGELOG_OPT_REC_UINT32:
+                off += sprintf(buffer + off, "%u", co->co_uint32) + 1;
+                rec->cr_nr_fields++;
+                break;
+            case CHANGELOG_OPT_REC_ENTRY:
+                off += entry_fn(&co->co_entry, buffer + off, _gf_true);
+                CHANGELOG_FILL_BUFFER(buffer, off, "\0", 1);
+                rec->cr_nr_fields++;
+
+                /* path of the deleted entry, possibly empty */
+                if (co->co_convert == del_entry_fn) {
+                    path = co->co_entry.cef_path;
+                    CHANGELOG_FILL_BUFFER(buffer, off, path, strlen(path) + 1);
+                    rec->cr_nr_fields++;
+                }
+                break;
+        }
+    }
+
+    len = CHANGELOG_INDEX_ROUNDUP(off);
+    memset(buffer + off, 0, len - off);
+    rec->cr_len = len;
+
+    ret = changelog_write_change(priv, buffer, len);
+    changelog_index_add(priv, rec, ret);
+
+    return ret;
+}
+
+static int
+changelog_index_entry_cmp(const void *a, const void *b)
+{
+    int ret = 0;
+    const struct changelog_index_entry *e1 = a;
+    const struct changelog_index_entry *e2 = b;
+
+    ret = memcmp(e1->ce_gfid, e2->ce_gfid, sizeof(e1->ce_gfid));
+    if (ret)
+        return ret;
+
+    if (e1->ce_offset == e2->ce_offset)
+        return 0;
+
+    return (e1->ce_offset < e2->ce_offset) ? -1 : 1;
+}
+
+/* called once the header of a new journal is written */
+void
+changelog_index_start(changelog_priv_t *priv, size_t offset)
+{
+    changelog_index_t *index = &priv->index;
+
+    index->active = (priv->ce->encoder == CHANGELOG_ENCODE_INDEXED);
+    index->broken = _gf_false;
+    index->offset = offset;
+    memset(&index->footer, 0, sizeof(index->footer));
+}
+
+void
+changelog_index_add(changelog_priv_t *priv, struct changelog_index_record *rec,
+                    int error)
+{
+    uint64_t max = 0;
+    struct changelog_index_entry *entries = NULL;
+    struct changelog_index_footer *footer = NULL;
+    changelog_index_t *index = &priv->index;
+
+    if (!index->active)
+        return;
+
+    footer = &index->footer;
+
+    /* offsets of the records that follow are unknown now */
+    if (error)
+        index->broken = _gf_true;
+
+    if (index->broken)
+        goto account;
+
+    if (footer->cf_records == index->max_entries) {
+        max = index->max_entries ? (index->max_entries * 2) : 1024;
+        entries = GF_REALLOC(index->entries, max * sizeof(*entries));
+        if (!entries) {
+            index->broken = _gf_true;
+            goto account;
+        }
+
+        index->entries = entries;
+        index->max_entries = max;
+    }
+
+    entries = &index->entries[footer->cf_records];
+    memcpy(entries->ce_gfid, rec->cr_gfid, sizeof(entries->ce_gfid));
+    entries->ce_offset = index->offset;
+
+account:
+    if (!footer->cf_records || rec->cr_time < footer->cf_min_time)
+        footer->cf_min_time = rec->cr_time;
+    if (rec->cr_time > footer->cf_max_time)
+        footer->cf_max_time = rec->cr_time;
+
+    footer->cf_types |= changelog_index_type_bit(rec->cr_type);
+    if (rec->cr_type != 'D')
+        CHANGELOG_INDEX_FOP_SET(footer->cf_fops, rec->cr_fop);
+
+    footer->cf_records++;
+    index->offset += rec->cr_len;
+}
+
+/**
+ * append the index and the footer to the journal about to be rolled over.
+ * Everything buffered must have been written out already.
+ */
+int
+changelog_index_finish(xlator_t *this, changelog_priv_t *priv)
+{
+    int ret = 0;
+    changelog_index_t *index = &priv->index;
+    struct changelog_index_footer *footer = &index->footer;
+
+    if (!index->active)
+        return 0;
+
+    index->active = _gf_false;
+
+    if (!footer->cf_records)
+        return 0;
+
+    if (index->broken) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, CHANGELOG_MSG_WRITE_FAILED,
+               "not indexing changelog, some records could not be "
+               "written");
+        return 0;
+    }
+
+    qsort(index->entries, footer->cf_records, sizeof(*index->entries),
+          changelog_index_entry_cmp);
+
+    footer->cf_index_offset = index->offset;
+    footer->cf_version = CHANGELOG_INDEX_VERSION;
+    memcpy(footer->cf_magic, CHANGELOG_INDEX_MAGIC, sizeof(footer->cf_magic));
+
+    ret = changelog_write(priv->changelog_fd, (char *)index->entries,
+                          footer->cf_records * sizeof(*index->entries));
+    if (!ret)
+        ret = changelog_write(priv->changelog_fd, (char *)footer,
+                              sizeof(*footer));
+    if (ret)
+        gf_msg(this->name, GF_LOG_ERROR, errno, CHANGELOG_MSG_WRITE_FAILED,
+               "error writing changelog index");
+
+    return ret;
+}
+
+void
+changelog_index_fini(changelog_priv_t *priv)
+{
+    GF_FREE(priv->index.entries);
+    priv->index.entries = NULL;
+    priv->index.max_entries = 0;
+}
+
 static struct changelog_encoder cb_encoder[] = {
     [CHANGELOG_ENCODE_BINARY] =
         {
@@ -223,6 +420,11 @@ static struct changelog_encoder cb_encoder[] = {
             .encoder = CHANGELOG_ENCODE_ASCII,
             .encode = changelog_encode_ascii,
         },
+    [CHANGELOG_ENCODE_INDEXED] =
+        {
+            .encoder = CHANGELOG_ENCODE_INDEXED,
+            .encode = changelog_encode_indexed,
+        },
 };
 
 void
@@ -44,6 +44,16 @@ int
 changelog_encode_binary(xlator_t *, changelog_log_data_t *);
 int
 changelog_encode_ascii(xlator_t *, changelog_log_data_t *);
+int
+changelog_encode_indexed(xlator_t *, changelog_log_data_t *);
+void
+changelog_index_start(changelog_priv_t *, size_t);
+void
+changelog_index_add(changelog_priv_t *, struct changelog_index_record *, int);
+int
+changelog_index_finish(xlator_t *, changelog_priv_t *);
+void
+changelog_index_fini(changelog_priv_t *);
 void
 changelog_encode_change(changelog_priv_t *);
 
@@ -13,6 +13,7 @@
 #include <glusterfs/logging.h>
 #include <glusterfs/iobuf.h>
 #include <glusterfs/syscall.h>
+#include <glusterfs/timespec.h>
 
 #include "changelog-helpers.h"
 #include "changelog-encoders.h"
@@ -399,6 +400,10 @@ changelog_rollover_changelog(xlator_t *this, changelog_priv_t *priv,
     };
 
     if (priv->changelog_fd != -1) {
+        /* an index pointing past the records written is worse than none */
+        if (changelog_journal_flush(this, priv))
+            priv->index.broken = _gf_true;
+        (void)changelog_index_finish(this, priv);
         ret = sys_fsync(priv->changelog_fd);
         if (ret < 0) {
             gf_msg(this->name, GF_LOG_ERROR, errno,
@@ -945,13 +950,21 @@ changelog_open_journal(xlator_t *this, changelog_priv_t *priv)
 
     (void)snprintf(buffer, 1024, CHANGELOG_HEADER, CHANGELOG_VERSION_MAJOR,
                    CHANGELOG_VERSION_MINOR, priv->ce->encoder);
-    ret = changelog_write_change(priv, buffer, strlen(buffer));
+    ret = changelog_write(priv->changelog_fd, buffer, strlen(buffer));
     if (ret) {
         sys_close(priv->changelog_fd);
         priv->changelog_fd = -1;
         goto out;
     }
 
+    pthread_mutex_lock(&priv->journal.lock);
+    {
+        priv->journal.broken = _gf_false;
+    }
+    pthread_mutex_unlock(&priv->journal.lock);
+
+    changelog_index_start(priv, strlen(buffer));
+
     ret = 0;
 
 out:
@@ -1004,9 +1017,296 @@ changelog_snap_write_change(changelog_priv_t *priv, char *buffer, size_t len)
     return changelog_write(priv->c_snap_fd, buffer, len);
 }
 
+/* Two lists: one being written out while records go into the other. */
+#define CHANGELOG_JOURNAL_NR_BUFFS 2
+
+int
+changelog_journal_init(changelog_journal_t *journal)
+{
+    int ret = -1;
+
+    journal->rbuf = rbuf_init(CHANGELOG_JOURNAL_NR_BUFFS);
+    if (!journal->rbuf)
+        goto out;
+
+    ret = pthread_mutex_init(&journal->lock, NULL);
+    if (ret)
+        goto dtor;
+
+    ret = pthread_cond_init(&journal->cond, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&journal->lock);
+        goto dtor;
+    }
+
+    return 0;
+
+dtor:
+    rbuf_dtor(journal->rbuf);
+    journal->rbuf = NULL;
+out:
+    return -1;
+}
+
+void
+changelog_journal_fini(changelog_journal_t *journal)
+{
+    if (!journal->rbuf)
+        return;
+
+    pthread_cond_destroy(&journal->cond);
+    pthread_mutex_destroy(&journal->lock);
+    rbuf_dtor(journal->rbuf);
+    journal->rbuf = NULL;
+}
+
+void
+changelog_journal_configure(changelog_journal_t *journal,
+                            gf_boolean_t group_commit, uint32_t delay,
+                            uint64_t batch)
+{
+    pthread_mutex_lock(&journal->lock);
+    {
+        journal->group_commit = group_commit;
+        journal->delay = delay;
+        journal->batch = batch;
+
+        /* let a writer sleeping on the old delay go */
+        journal->urgent = _gf_true;
+        pthread_cond_broadcast(&journal->cond);
+    }
+    pthread_mutex_unlock(&journal->lock);
+}
+
+uint64_t
+changelog_journal_seq(changelog_journal_t *journal)
+{
+    uint64_t seq = 0;
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        seq = journal->appended;
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return seq;
+}
+
+/**
+ * Buffer a record. Callers are serialized by the dispatcher, so records
+ * land in the buffer in the same order as they get their sequence numbers.
+ */
+static int
+changelog_journal_append(changelog_journal_t *journal, char *buffer,
+                         size_t len)
+{
+    char *wbuf = NULL;
+    void *opaque = NULL;
+
+    wbuf = rbuf_reserve_write_area(journal->rbuf, len, &opaque);
+    if (!wbuf)
+        return -1;
+
+    memcpy(wbuf, buffer, len);
+    (void)rbuf_write_complete(opaque);
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        journal->appended++;
+        journal->pending += len;
+        journal->nr_records++;
+
+        if (journal->flushing && journal->pending >= journal->batch)
+            pthread_cond_broadcast(&journal->cond);
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return 0;
+}
+
+struct changelog_journal_write_args {
+    int fd;
+    int ret;
+    size_t bytes;
+};
+
+static void
+changelog_journal_dispatch(rbuf_list_t *rlist, void *arg)
+{
+    rbuf_iovec_t *rvec = NULL;
+    struct rlist_iter riter = {
+        {
+            0,
+        },
+    };
+    struct changelog_journal_write_args *args = arg;
+
+    rlist_iter_init(&riter, rlist);
+
+    rvec_for_each_entry(rvec, &riter)
+    {
+        if (args->ret)
+            break;
+
+        args->ret = changelog_write(args->fd, rvec->iov.iov_base,
+                                    rvec->iov.iov_len);
+        if (!args->ret)
+            args->bytes += rvec->iov.iov_len;
+    }
+}
+
+/* Write out whatever is buffered. Only one writer at a time. */
+static int
+changelog_journal_write(xlator_t *this, changelog_priv_t *priv)
+{
+    int ret = 0;
+    void *opaque = NULL;
+    changelog_journal_t *journal = &priv->journal;
+    struct changelog_journal_write_args args = {
+        .fd = priv->changelog_fd,
+    };
+
+    ret = rbuf_get_buffer(journal->rbuf, &opaque, NULL, NULL);
+    if (ret == RBUF_EMPTY)
+        return 0;
+    if (ret != RBUF_CONSUMABLE) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, CHANGELOG_MSG_WRITE_FAILED,
+               "failed to switch journal buffers (%d)", ret);
+        return -1;
+    }
+
+    ret = rbuf_wait_for_completion(journal->rbuf, opaque,
+                                   changelog_journal_dispatch, &args);
+    if (!ret)
+        ret = args.ret;
+    if (ret)
+        gf_msg(this->name, GF_LOG_ERROR, errno, CHANGELOG_MSG_WRITE_FAILED,
+               "error writing changelog to disk");
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        journal->nr_writes++;
+        journal->nr_bytes += args.bytes;
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return ret;
+}
+
+/**
+ * Returns once the record with sequence number @seq (and so every record
+ * before it) has been written to the journal fd.
+ *
+ * The first caller that finds nobody writing becomes the writer: it waits
+ * for up to the commit delay (unless @urgent, or the batch size is reached
+ * earlier), switches buffers and writes out all the records buffered so
+ * far, on behalf of everybody waiting for them. Callers arriving meanwhile
+ * wait for it, and the first of them to wake up writes the next batch.
+ */
+int
+changelog_journal_commit(xlator_t *this, changelog_priv_t *priv, uint64_t seq,
+                         gf_boolean_t urgent)
+{
+    int ret = 0;
+    uint64_t target = 0;
+    struct timespec deadline = {
+        0,
+    };
+    changelog_journal_t *journal = &priv->journal;
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        while (journal->written < seq) {
+            if (journal->flushing) {
+                if (urgent) {
+                    journal->urgent = _gf_true;
+                    pthread_cond_broadcast(&journal->cond);
+                }
+                pthread_cond_wait(&journal->cond, &journal->lock);
+                continue;
+            }
+
+            journal->flushing = _gf_true;
+
+            if (!urgent && journal->delay) {
+                timespec_now_realtime(&deadline);
+                deadline.tv_sec += journal->delay / 1000;
+                deadline.tv_nsec += (journal->delay % 1000) * 1000000;
+                if (deadline.tv_nsec >= 1000000000) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000;
+                }
+
+                while (!journal->urgent && journal->pending < journal->batch) {
+                    if (pthread_cond_timedwait(&journal->cond, &journal->lock,
+                                               &deadline) == ETIMEDOUT)
+                        break;
+                }
+            }
+
+            journal->urgent = _gf_false;
+            target = journal->appended;
+            journal->pending = 0;
+
+            pthread_mutex_unlock(&journal->lock);
+            ret = changelog_journal_write(this, priv);
+            pthread_mutex_lock(&journal->lock);
+
+            if (ret) {
+                journal->failed_from = journal->written;
+                journal->failed = target;
+                journal->broken = _gf_true;
+            }
+            journal->written = target;
+            journal->flushing = _gf_false;
+            pthread_cond_broadcast(&journal->cond);
+        }
+
+        ret = (seq > journal->failed_from && seq <= journal->failed) ? -1 : 0;
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return ret;
+}
+
+/* Write out every buffered record, e.g. before the journal is synced or
+ * rolled over. Fails if any batch written to the journal file since it was
+ * opened failed, not only the last one: the file misses records and its
+ * offsets cannot be trusted. */
+int
+changelog_journal_flush(xlator_t *this, changelog_priv_t *priv)
+{
+    int ret = 0;
+    changelog_journal_t *journal = &priv->journal;
+
+    ret = changelog_journal_commit(this, priv, changelog_journal_seq(journal),
+                                   _gf_true);
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        if (journal->broken)
+            ret = -1;
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return ret;
+}
+
 int
 changelog_write_change(changelog_priv_t *priv, char *buffer, size_t len)
 {
+    xlator_t *this = THIS;
+    changelog_journal_t *journal = &priv->journal;
+
+    if (journal->group_commit &&
+        !changelog_journal_append(journal, buffer, len))
+        return 0;
+
+    /* records buffered before group commit got disabled go first */
+    if (changelog_journal_commit(this, priv, changelog_journal_seq(journal),
+                                 _gf_true))
+        return -1;
+
     return changelog_write(priv->changelog_fd, buffer, len);
 }
 
@@ -1088,6 +1388,12 @@ changelog_handle_change(xlator_t *this, changelog_priv_t *priv,
         return 0;
 
     if (CHANGELOG_TYPE_IS_FSYNC(cld->cld_type)) {
+        ret = changelog_journal_flush(this, priv);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_ERROR, 0, CHANGELOG_MSG_WRITE_FAILED,
+                   "changelog records could not be written");
+            goto out;
+        }
         ret = sys_fsync(priv->changelog_fd);
         if (ret < 0) {
             gf_msg(this->name, GF_LOG_ERROR, errno,
@@ -25,6 +25,7 @@
 
 #include "changelog.h"
 #include "changelog-messages.h"
+#include "changelog-index.h"
 
 /**
  * the changelog entry
@@ -188,6 +189,55 @@ typedef struct changelog_ev_selector {
     unsigned int ref[CHANGELOG_EV_SELECTION_RANGE];
 } changelog_ev_selector_t;
 
+/**
+ * Group commit of journal records. Records are copied into a rotational
+ * buffer in the order they are sequenced, and whoever needs its record on
+ * disk either writes out everything buffered so far or waits for the
+ * writer that is already doing so. See changelog_journal_commit().
+ */
+typedef struct changelog_journal {
+    rbuf_t *rbuf;
+
+    pthread_mutex_t lock; /* protects everything below */
+    pthread_cond_t cond;
+
+    uint64_t appended; /* sequence number of the last buffered record */
+    uint64_t written;  /* sequence number of the last written record */
+
+    /* records in (failed_from, failed] could not be written */
+    uint64_t failed_from;
+    uint64_t failed;
+    gf_boolean_t broken; /* some records of the journal file are missing */
+
+    size_t pending;        /* bytes buffered since the last switch */
+    gf_boolean_t flushing; /* a writer owns the journal fd */
+    gf_boolean_t urgent;   /* cut the commit delay of the writer short */
+
+    gf_boolean_t group_commit;
+    uint32_t delay; /* msecs a writer waits for more records */
+    uint64_t batch; /* ... unless this many bytes are buffered */
+
+    uint64_t nr_records;
+    uint64_t nr_writes;
+    uint64_t nr_bytes;
+} changelog_journal_t;
+
+/**
+ * gfid index and summary of the journal being written, when it uses the
+ * indexed encoding. Protected by the dispatcher, like the journal itself.
+ */
+typedef struct changelog_index {
+    gf_boolean_t active;
+    gf_boolean_t broken; /* some record is missing, don't write the index */
+
+    uint64_t offset; /* journal offset of the next record */
+
+    struct changelog_index_entry *entries;
+    uint64_t max_entries;
+
+    struct changelog_index_footer footer;
+} changelog_index_t;
+
 /* changelog's private structure */
 struct changelog_priv {
     gf_boolean_t active;
@@ -227,6 +277,12 @@ struct changelog_priv {
     /* fsync() interval */
     int32_t fsync_interval;
 
+    /* buffered journal writes */
+    changelog_journal_t journal;
+
+    /* index of the journal (indexed encoding) */
+    changelog_index_t index;
+
     /* changelog type maps */
     const char *maps[CHANGELOG_MAX_TYPE];
 
@@ -435,6 +491,21 @@ changelog_write(int fd, char *buffer, size_t len);
 int
 changelog_write_change(changelog_priv_t *priv, char *buffer, size_t len);
 int
+changelog_journal_init(changelog_journal_t *journal);
+void
+changelog_journal_fini(changelog_journal_t *journal);
+void
+changelog_journal_configure(changelog_journal_t *journal,
+                            gf_boolean_t group_commit, uint32_t delay,
+                            uint64_t batch);
+uint64_t
+changelog_journal_seq(changelog_journal_t *journal);
+int
+changelog_journal_commit(xlator_t *this, changelog_priv_t *priv, uint64_t seq,
+                         gf_boolean_t urgent);
+int
+changelog_journal_flush(xlator_t *this, changelog_priv_t *priv);
+int
 changelog_handle_change(xlator_t *this, changelog_priv_t *priv,
                         changelog_log_data_t *cld);
 void
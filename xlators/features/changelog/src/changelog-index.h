@@ -0,0 +1,95 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef _CHANGELOG_INDEX_H
+#define _CHANGELOG_INDEX_H
+
+#include <stdint.h>
+
+/**
+ * On-disk layout of changelogs with the "indexed" encoding, shared by the
+ * translator (writer) and libgfchangelog (reader). Integers are stored in
+ * host byte order, like the binary encoding does.
+ *
+ *   CHANGELOG_HEADER line (encoding : CHANGELOG_ENCODE_INDEXED)
+ *   record, record, ...
+ *   index entries, sorted by gfid and then by offset
+ *   footer
+ *
+ * Every record starts with a fixed size header that is enough to filter
+ * it (type, fop, time, gfid) and to skip it (length). The rest of the fields
+ * follow as '\0' terminated strings, in the order of the ascii encoding.
+ *
+ * The index and the footer are written when the changelog is rolled over.
+ * A changelog without them (the one being written, or one left behind by a
+ * crash) can still be read record by record.
+ */
+
+#define CHANGELOG_INDEX_VERSION 1
+#define CHANGELOG_INDEX_MAGIC "GFCLIDX"
+#define CHANGELOG_INDEX_MAGIC_LEN 8
+#define CHANGELOG_INDEX_ALIGN 8
+#define CHANGELOG_INDEX_ROUNDUP(len)                                           \
+    (((len) + CHANGELOG_INDEX_ALIGN - 1) & ~(CHANGELOG_INDEX_ALIGN - 1))
+
+/* enough for GF_FOP_MAXVALUE */
+#define CHANGELOG_INDEX_FOP_WORDS 2
+
+/* bits of cf_types */
+#define CHANGELOG_INDEX_TYPE_DATA (1 << 0)
+#define CHANGELOG_INDEX_TYPE_METADATA (1 << 1)
+#define CHANGELOG_INDEX_TYPE_ENTRY (1 << 2)
+
+struct changelog_index_record {
+    uint32_t cr_len; /* whole record, padded to CHANGELOG_INDEX_ALIGN */
+    uint16_t cr_fop; /* GF_FOP_*, GF_FOP_NULL for data records */
+    uint8_t cr_type; /* 'D', 'M' or 'E' */
+    uint8_t cr_nr_fields;
+    uint64_t cr_time;
+    unsigned char cr_gfid[16];
+};
+
+struct changelog_index_entry {
+    unsigned char ce_gfid[16];
+    uint64_t ce_offset;
+};
+
+struct changelog_index_footer {
+    uint64_t cf_records;
+    uint64_t cf_index_offset; /* offset of the first index entry */
+    uint64_t cf_min_time;
+    uint64_t cf_max_time;
+    uint64_t cf_fops[CHANGELOG_INDEX_FOP_WORDS]; /* fops present */
+    uint32_t cf_types;                           /* record types present */
+    uint32_t cf_version;
+    char cf_magic[CHANGELOG_INDEX_MAGIC_LEN];
+};
+
+#define CHANGELOG_INDEX_FOP_SET(map, fop)                                      \
+    ((map)[(fop) / 64] |= (1ULL << ((fop) % 64)))
+#define CHANGELOG_INDEX_FOP_ISSET(map, fop)                                    \
+    ((map)[(fop) / 64] & (1ULL << ((fop) % 64)))
+
+static inline uint32_t
+changelog_index_type_bit(char type)
+{
+    switch (type) {
+        case 'D':
+            return CHANGELOG_INDEX_TYPE_DATA;
+        case 'M':
+            return CHANGELOG_INDEX_TYPE_METADATA;
+        case 'E':
+            return CHANGELOG_INDEX_TYPE_ENTRY;
+    }
+
+    return 0;
+}
+
+#endif /* _CHANGELOG_INDEX_H */
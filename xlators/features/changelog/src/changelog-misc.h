@@ -118,6 +118,7 @@ typedef enum {
     CHANGELOG_ENCODE_MIN = 0,
     CHANGELOG_ENCODE_BINARY,
     CHANGELOG_ENCODE_ASCII,
+    CHANGELOG_ENCODE_INDEXED,
     CHANGELOG_ENCODE_MAX,
 } changelog_encoder_t;
 
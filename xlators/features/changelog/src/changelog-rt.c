@@ -50,6 +50,7 @@ changelog_rt_enqueue(xlator_t *this, changelog_priv_t *priv, void *cbatch,
                      changelog_log_data_t *cld_0, changelog_log_data_t *cld_1)
 {
     int ret = 0;
+    uint64_t seq = 0;
     changelog_rt_t *crt = NULL;
 
     crt = (changelog_rt_t *)cbatch;
@@ -59,8 +60,18 @@ changelog_rt_enqueue(xlator_t *this, changelog_priv_t *priv, void *cbatch,
         ret = changelog_handle_change(this, priv, cld_0);
         if (!ret && cld_1)
             ret = changelog_handle_change(this, priv, cld_1);
+
+        seq = changelog_journal_seq(&priv->journal);
     }
     UNLOCK(&crt->lock);
 
+    /**
+     * records are only buffered above; wait for them to hit the journal
+     * outside the lock, so that others can queue up behind us and get
+     * written in the same go.
+     */
+    if (!ret)
+        ret = changelog_journal_commit(this, priv, seq, _gf_false);
+
     return ret;
 }
@@ -13,6 +13,7 @@
 #include <glusterfs/syscall.h>
 #include <glusterfs/logging.h>
 #include <glusterfs/iobuf.h>
+#include <glusterfs/statedump.h>
 
 #include "changelog-rt.h"
 
@@ -1925,6 +1926,8 @@ changelog_assign_encoding(changelog_priv_t *priv, char *enc)
         priv->encode_mode = CHANGELOG_ENCODE_BINARY;
     } else if (strncmp(enc, "ascii", 5) == 0) {
         priv->encode_mode = CHANGELOG_ENCODE_ASCII;
+    } else if (strncmp(enc, "indexed", 7) == 0) {
+        priv->encode_mode = CHANGELOG_ENCODE_INDEXED;
     }
 }
 
@@ -2447,6 +2450,9 @@ reconfigure(xlator_t *this, dict_t *options)
         0,
     };
     uint32_t timeout = 0;
+    gf_boolean_t group_commit = _gf_false;
+    uint32_t commit_delay = 0;
+    uint64_t commit_batch = 0;
 
     priv = this->private;
     if (!priv)
@@ -2512,6 +2518,14 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("capture-del-path", priv->capture_del_path, options, bool,
                      out);
 
+    GF_OPTION_RECONF("journal-group-commit", group_commit, options, bool, out);
+    GF_OPTION_RECONF("journal-commit-delay", commit_delay, options, uint32,
+                     out);
+    GF_OPTION_RECONF("journal-commit-batch", commit_batch, options,
+                     size_uint64, out);
+    changelog_journal_configure(&priv->journal, group_commit, commit_delay,
+                                commit_batch);
+
     if (active_now || active_earlier) {
         ret = changelog_fill_rollover_data(&cld, !active_now);
         if (ret)
@@ -2577,6 +2591,9 @@ changelog_init_options(xlator_t *this, changelog_priv_t *priv)
     int ret = 0;
     char *tmp = NULL;
     uint32_t timeout = 0;
+    gf_boolean_t group_commit = _gf_false;
+    uint32_t commit_delay = 0;
+    uint64_t commit_batch = 0;
     char htime_dir[PATH_MAX] = {
         0,
     };
@@ -2636,6 +2653,13 @@ changelog_init_options(xlator_t *this, changelog_priv_t *priv)
     GF_OPTION_INIT("changelog-barrier-timeout", timeout, time, dealloc_2);
     changelog_assign_barrier_timeout(priv, timeout);
 
+    GF_OPTION_INIT("journal-group-commit", group_commit, bool, dealloc_2);
+    GF_OPTION_INIT("journal-commit-delay", commit_delay, uint32, dealloc_2);
+    GF_OPTION_INIT("journal-commit-batch", commit_batch, size_uint64,
+                   dealloc_2);
+    changelog_journal_configure(&priv->journal, group_commit, commit_delay,
+                                commit_batch);
+
     GF_ASSERT(cb_bootstrap[priv->op_mode].mode == priv->op_mode);
     priv->cb = &cb_bootstrap[priv->op_mode];
 
@@ -2742,10 +2766,14 @@ init(xlator_t *this)
     INIT_LIST_HEAD(&priv->xprt_list);
     priv->htime_fd = -1;
 
-    ret = changelog_init_options(this, priv);
+    ret = changelog_journal_init(&priv->journal);
     if (ret)
         goto cleanup_mempool;
 
+    ret = changelog_init_options(this, priv);
+    if (ret)
+        goto cleanup_journal;
+
     /* snap dependency changes */
     priv->dm.black_fop_cnt = 0;
     priv->dm.white_fop_cnt = 0;
@@ -2788,6 +2816,8 @@ cleanup_barrier:
     changelog_barrier_pthread_destroy(priv);
 cleanup_options:
     changelog_freeup_options(this, priv);
+cleanup_journal:
+    changelog_journal_fini(&priv->journal);
 cleanup_mempool:
     mem_pool_destroy(this->local_pool);
     this->local_pool = NULL;
@@ -2825,6 +2855,10 @@ fini(xlator_t *this)
         /* cleanup allocated options */
         changelog_freeup_options(this, priv);
 
+        changelog_journal_fini(&priv->journal);
+
+        changelog_index_fini(priv);
+
         /* deallocate mempool */
         mem_pool_destroy(this->local_pool);
 
@@ -2842,6 +2876,41 @@ fini(xlator_t *this)
     return;
 }
 
+static int32_t
+changelog_priv_dump(xlator_t *this)
+{
+    changelog_priv_t *priv = NULL;
+    changelog_journal_t *journal = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN] = {
+        0,
+    };
+
+    priv = this->private;
+    if (!priv)
+        return 0;
+
+    journal = &priv->journal;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.features.changelog", "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("active", "%d", priv->active);
+
+    pthread_mutex_lock(&journal->lock);
+    {
+        gf_proc_dump_write("journal-group-commit", "%d",
+                           journal->group_commit);
+        gf_proc_dump_write("journal-records", "%" PRIu64, journal->nr_records);
+        gf_proc_dump_write("journal-writes", "%" PRIu64, journal->nr_writes);
+        gf_proc_dump_write("journal-bytes", "%" PRIu64, journal->nr_bytes);
+        gf_proc_dump_write("journal-unwritten", "%" PRIu64,
+                           journal->appended - journal->written);
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return 0;
+}
+
 struct xlator_fops fops = {
     .open = changelog_open,
     .mknod = changelog_mknod,
@@ -2871,6 +2940,10 @@ struct xlator_cbks cbks = {
     .release = changelog_release,
 };
 
+struct xlator_dumpops dumpops = {
+    .priv = changelog_priv_dump,
+};
+
 struct volume_options options[] = {
     {.key = {"changelog"},
      .type = GF_OPTION_TYPE_BOOL,
@@ -2905,8 +2978,11 @@ struct volume_options options[] = {
     {.key = {"encoding"},
      .type = GF_OPTION_TYPE_STR,
      .default_value = "ascii",
-     .value = {"binary", "ascii"},
-     .description = "encoding type for changelogs",
+     .value = {"binary", "ascii", "indexed"},
+     .description = "encoding type for changelogs. \"indexed\" is a binary "
+                    "format with fixed size record headers and a gfid index, "
+                    "which lets libgfchangelog readers skip records they "
+                    "are not interested in",
      .op_version = {3},
      .flags = OPT_FLAG_SETTABLE,
      .level = OPT_STATUS_ADVANCED,
@@ -2947,6 +3023,40 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE,
      .level = OPT_STATUS_BASIC,
      .tags = {"journal", "glusterfind"}},
+    {.key = {"journal-group-commit"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "buffer changelog records in memory and write them out "
+                    "in batches. A fop still waits for its record to be "
+                    "written, but records of concurrent fops share a "
+                    "single write()",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .level = OPT_STATUS_ADVANCED,
+     .tags = {"journal"}},
+    {.key = {"journal-commit-delay"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 1000,
+     .default_value = "0",
+     .description = "time (in milliseconds) the writer of a batch waits for "
+                    "more records to join it before writing. Trades fop "
+                    "latency for fewer writes under load",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .level = OPT_STATUS_ADVANCED,
+     .tags = {"journal"}},
+    {.key = {"journal-commit-batch"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 4 * GF_UNIT_KB,
+     .max = 1 * GF_UNIT_MB,
+     .default_value = "64KB",
+     .description = "amount of buffered records that ends the "
+                    "journal-commit-delay early",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .level = OPT_STATUS_ADVANCED,
+     .tags = {"journal"}},
     {.key = {NULL}},
 };
 
@@ -2959,6 +3069,7 @@ xlator_api_t xlator_api = {
     .op_version = {1}, /* Present from the initial version */
     .fops = &fops,
     .cbks = &cbks,
+    .dumpops = &dumpops,
     .options = options,
     .identifier = "changelog",
     .category = GF_MAINTAINED,
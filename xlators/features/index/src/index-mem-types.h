@@ -18,6 +18,7 @@ enum gf_index_mem_types_ {
     gf_index_inode_ctx_t,
     gf_index_fd_ctx_t,
     gf_index_mt_local_t,
+    gf_index_mt_journal_t,
     gf_index_mt_end
 };
 #endif
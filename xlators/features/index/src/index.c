@@ -13,10 +13,12 @@
 #include <glusterfs/syscall.h>
 #include <glusterfs/syncop.h>
 #include <glusterfs/common-utils.h>
+#include <glusterfs/statedump.h>
 #include "index-messages.h"
 #include <ftw.h>
 #include <libgen.h> /* for dirname() */
 #include <signal.h>
+#include <sys/mman.h>
 
 #define XATTROP_SUBDIR "xattrop"
 #define DIRTY_SUBDIR "dirty"
@@ -723,6 +725,481 @@ out:
     return ret;
 }
 
+static uint64_t
+index_time_ms(void)
+{
+    struct timespec ts = {
+        0,
+    };
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static gf_boolean_t
+index_type_is_delayed(index_xattrop_type_t type)
+{
+    return (type == XATTROP) || (type == DIRTY);
+}
+
+/*
+ * Slots of a gfid are looked up in the INDEX_JOURNAL_PROBE slots following
+ * its hash. gfids are random, their last bytes make a good enough hash.
+ */
+static index_journal_slot_t *
+__index_journal_find(index_priv_t *priv, uuid_t gfid, int type,
+                     index_journal_slot_t **free_slot)
+{
+    index_journal_slot_t *slot = NULL;
+    uint32_t hash = 0;
+    uint32_t i = 0;
+
+    memcpy(&hash, gfid + 12, sizeof(hash));
+
+    for (i = 0; i < INDEX_JOURNAL_PROBE; i++) {
+        slot = &priv->journal[1 + ((hash + type + i) % INDEX_JOURNAL_SLOTS)];
+        if (slot->state == INDEX_SLOT_FREE) {
+            if (free_slot && !*free_slot)
+                *free_slot = slot;
+            continue;
+        }
+
+        if ((slot->type == type) && !gf_uuid_compare(slot->gfid, gfid))
+            return slot;
+    }
+
+    return NULL;
+}
+
+static void
+__index_journal_slot_free(index_priv_t *priv, index_journal_slot_t *slot)
+{
+    priv->journal_count[slot->type]--;
+    memset(slot, 0, sizeof(*slot));
+}
+
+/*
+ * A gfid in the journal is never linked under index-base, except by the
+ * flusher: it is added to the journal only when the inode is known not to
+ * be in the index, and is never linked directly while it is in the journal.
+ *
+ * Returns 0 when the gfid is (or already was) in the journal.
+ */
+static int
+index_journal_add(xlator_t *this, uuid_t gfid, index_xattrop_type_t type,
+                  gf_boolean_t create)
+{
+    index_priv_t *priv = this->private;
+    index_journal_slot_t *slot = NULL;
+    index_journal_slot_t *free_slot = NULL;
+    int ret = -1;
+
+    if (!priv->journal)
+        return -1;
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        slot = __index_journal_find(priv, gfid, type, &free_slot);
+        if (slot) {
+            /* still to be linked, or being linked */
+            slot->deleted = 0;
+            ret = 0;
+            goto unlock;
+        }
+
+        if (!create || !priv->delay)
+            goto unlock;
+
+        if (!free_slot) {
+            priv->journal_full++;
+            goto unlock;
+        }
+
+        gf_uuid_copy(free_slot->gfid, gfid);
+        free_slot->type = type;
+        free_slot->deleted = 0;
+        free_slot->time = index_time_ms();
+        free_slot->state = INDEX_SLOT_PENDING;
+
+        priv->journal_count[type]++;
+        priv->journal_queued++;
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    return ret;
+}
+
+/*
+ * Returns 0 when the gfid was in the journal, and so not in the index.
+ */
+static int
+index_journal_del(xlator_t *this, uuid_t gfid, index_xattrop_type_t type)
+{
+    index_priv_t *priv = this->private;
+    index_journal_slot_t *slot = NULL;
+    int ret = -1;
+
+    if (!priv->journal)
+        return -1;
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        slot = __index_journal_find(priv, gfid, type, NULL);
+        if (!slot)
+            goto unlock;
+
+        if (slot->state == INDEX_SLOT_FLUSHING) {
+            /* the flusher removes it once linked */
+            slot->deleted = 1;
+        } else {
+            __index_journal_slot_free(priv, slot);
+            priv->journal_cancelled++;
+        }
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    return ret;
+}
+
+static uint32_t
+index_journal_pending(index_priv_t *priv, index_xattrop_type_t type)
+{
+    uint32_t count = 0;
+
+    if (!priv->journal)
+        return 0;
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        if (type == XATTROP_TYPE_UNSET)
+            count = priv->journal_count[XATTROP] + priv->journal_count[DIRTY];
+        else
+            count = priv->journal_count[type];
+    }
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    return count;
+}
+
+/*
+ * Link the gfids which have been in the journal for index-delay msecs, or
+ * all of them, delay_batch at a time. Slots are freed only once linked, so
+ * that a crash in between replays them.
+ */
+static void
+index_journal_flush(xlator_t *this, gf_boolean_t all)
+{
+    index_priv_t *priv = this->private;
+    index_journal_slot_t **slots = NULL;
+    index_journal_slot_t *slot = NULL;
+    uint32_t max = 0;
+    uint32_t n = 0;
+    uint32_t i = 0;
+    uint64_t now = 0;
+    int ret = 0;
+
+    if (!priv->journal)
+        return;
+
+    max = priv->delay_batch;
+    slots = GF_CALLOC(max, sizeof(*slots), gf_index_mt_journal_t);
+    if (!slots)
+        return;
+
+    do {
+        n = 0;
+        now = index_time_ms();
+
+        pthread_mutex_lock(&priv->journal_lock);
+        {
+            for (i = 1; (i <= INDEX_JOURNAL_SLOTS) && (n < max); i++) {
+                slot = &priv->journal[i];
+                if (slot->state != INDEX_SLOT_PENDING)
+                    continue;
+                if (!all && ((now - slot->time) < priv->delay))
+                    continue;
+
+                slot->state = INDEX_SLOT_FLUSHING;
+                slots[n++] = slot;
+            }
+        }
+        pthread_mutex_unlock(&priv->journal_lock);
+
+        for (i = 0; i < n; i++) {
+            slot = slots[i];
+
+            ret = index_add(this, slot->gfid,
+                            index_get_subdir_from_type(slot->type),
+                            slot->type);
+
+            pthread_mutex_lock(&priv->journal_lock);
+            {
+                if (ret) {
+                    /* try again later */
+                    slot->state = INDEX_SLOT_PENDING;
+                    slot->time = now;
+                } else if (!slot->deleted) {
+                    __index_journal_slot_free(priv, slot);
+                    priv->journal_linked++;
+                    slot = NULL;
+                }
+            }
+            pthread_mutex_unlock(&priv->journal_lock);
+
+            if (ret || !slot)
+                continue;
+
+            /* removed from the index while it was being linked */
+            index_del(this, slot->gfid, index_get_subdir_from_type(slot->type),
+                      slot->type);
+
+            pthread_mutex_lock(&priv->journal_lock);
+            {
+                if (slot->deleted)
+                    __index_journal_slot_free(priv, slot);
+                else
+                    slot->state = INDEX_SLOT_PENDING;
+            }
+            pthread_mutex_unlock(&priv->journal_lock);
+        }
+    } while (n == max);
+
+    GF_FREE(slots);
+}
+
+static void *
+index_journal_worker(void *data)
+{
+    xlator_t *this = data;
+    index_priv_t *priv = NULL;
+    struct timespec wait = {
+        0,
+    };
+    uint32_t interval = 0;
+    gf_boolean_t all = _gf_false;
+    gf_boolean_t bye = _gf_false;
+
+    THIS = this;
+    priv = this->private;
+
+    for (;;) {
+        pthread_mutex_lock(&priv->journal_lock);
+        {
+            if (!priv->down) {
+                interval = priv->delay ? max(priv->delay / 2, 10) : 1000;
+                clock_gettime(CLOCK_REALTIME, &wait);
+                wait.tv_sec += interval / 1000;
+                wait.tv_nsec += (interval % 1000) * 1000000;
+                if (wait.tv_nsec >= 1000000000) {
+                    wait.tv_sec++;
+                    wait.tv_nsec -= 1000000000;
+                }
+                (void)pthread_cond_timedwait(&priv->journal_cond,
+                                             &priv->journal_lock, &wait);
+            }
+
+            bye = priv->down;
+            /* link everything when disabled, going down, or when half of
+             * the journal is used */
+            all = bye || !priv->delay ||
+                  ((priv->journal_count[XATTROP] +
+                    priv->journal_count[DIRTY]) >= INDEX_JOURNAL_SLOTS / 2);
+        }
+        pthread_mutex_unlock(&priv->journal_lock);
+
+        index_journal_flush(this, all);
+        if (bye)
+            break;
+    }
+
+    pthread_mutex_lock(&priv->mutex);
+    {
+        priv->curr_count--;
+        if (priv->curr_count == 0)
+            pthread_cond_broadcast(&priv->cond);
+    }
+    pthread_mutex_unlock(&priv->mutex);
+
+    return NULL;
+}
+
+/*
+ * Map the journal, and link what a previous instance left in it.
+ */
+static int
+index_journal_init(xlator_t *this)
+{
+    index_priv_t *priv = this->private;
+    index_journal_header_t *hdr = NULL;
+    index_journal_slot_t *slot = NULL;
+    char path[PATH_MAX] = {0};
+    struct stat st = {0};
+    void *map = NULL;
+    size_t size = 0;
+    uint32_t replayed = 0;
+    uint32_t i = 0;
+    int fd = -1;
+    int ret = -1;
+
+    size = (INDEX_JOURNAL_SLOTS + 1) * sizeof(index_journal_slot_t);
+    make_index_dir_path(priv->index_basepath, INDEX_JOURNAL_NAME, path,
+                        sizeof(path));
+
+    fd = sys_open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, INDEX_MSG_JOURNAL_FAILED,
+               "%s: failed to open", path);
+        goto out;
+    }
+
+    ret = sys_fstat(fd, &st);
+    if (!ret && (st.st_size != size))
+        ret = sys_ftruncate(fd, size);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, INDEX_MSG_JOURNAL_FAILED,
+               "%s: failed to size", path);
+        goto out;
+    }
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, INDEX_MSG_JOURNAL_FAILED,
+               "%s: failed to map", path);
+        ret = -1;
+        goto out;
+    }
+
+    hdr = map;
+    if ((hdr->magic == INDEX_JOURNAL_MAGIC) &&
+        (hdr->version == INDEX_JOURNAL_VERSION) &&
+        (hdr->slots == INDEX_JOURNAL_SLOTS)) {
+        for (i = 1; i <= INDEX_JOURNAL_SLOTS; i++) {
+            slot = &((index_journal_slot_t *)map)[i];
+            if (slot->state == INDEX_SLOT_FREE)
+                continue;
+
+            if (index_type_is_delayed(slot->type) &&
+                !gf_uuid_is_null(slot->gfid)) {
+                index_add(this, slot->gfid,
+                          index_get_subdir_from_type(slot->type), slot->type);
+                replayed++;
+            }
+            memset(slot, 0, sizeof(*slot));
+        }
+    } else {
+        memset(map, 0, size);
+        hdr->magic = INDEX_JOURNAL_MAGIC;
+        hdr->version = INDEX_JOURNAL_VERSION;
+        hdr->slots = INDEX_JOURNAL_SLOTS;
+    }
+
+    if (replayed)
+        gf_msg(this->name, GF_LOG_INFO, 0, INDEX_MSG_JOURNAL_FAILED,
+               "%u delayed index entries of the previous run recovered "
+               "from %s",
+               replayed, path);
+
+    priv->journal = map;
+    priv->journal_size = size;
+    ret = 0;
+out:
+    if (fd >= 0)
+        sys_close(fd);
+
+    return ret;
+}
+
+static int
+index_journal_start(xlator_t *this)
+{
+    index_priv_t *priv = this->private;
+    int ret = 0;
+
+    if (priv->journal)
+        return 0;
+
+    ret = index_journal_init(this);
+    if (ret)
+        goto out;
+
+    pthread_mutex_lock(&priv->mutex);
+    {
+        ret = gf_thread_create(&priv->journal_thread, NULL,
+                               index_journal_worker, this, "idxjrnl");
+        if (!ret) {
+            priv->journal_thread_running = _gf_true;
+            priv->curr_count++;
+        }
+    }
+    pthread_mutex_unlock(&priv->mutex);
+
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, ret,
+               INDEX_MSG_WORKER_THREAD_CREATE_FAILED,
+               "Failed to create journal thread");
+out:
+    if (ret) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, INDEX_MSG_JOURNAL_FAILED,
+               "index-delay disabled");
+        priv->delay = 0;
+    }
+
+    return ret;
+}
+
+static void
+index_journal_stop(xlator_t *this)
+{
+    index_priv_t *priv = this->private;
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        pthread_cond_broadcast(&priv->journal_cond);
+    }
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    if (priv->journal_thread_running) {
+        pthread_join(priv->journal_thread, NULL);
+        priv->journal_thread_running = _gf_false;
+    }
+
+    if (priv->journal) {
+        munmap(priv->journal, priv->journal_size);
+        priv->journal = NULL;
+    }
+}
+
+/*
+ * With index-delay, the gfids of the xattrop and dirty indices are kept in
+ * the journal for that long before being linked under index-base, and the
+ * ones deleted meanwhile never reach the disk.
+ */
+static int
+index_add_delayed(xlator_t *this, uuid_t gfid, char *subdir,
+                  index_xattrop_type_t type, int state)
+{
+    /* when the state is unknown, the gfid may be in the index already */
+    if (index_type_is_delayed(type) &&
+        !index_journal_add(this, gfid, type, (state == NOTIN)))
+        return 0;
+
+    return index_add(this, gfid, subdir, type);
+}
+
+static int
+index_del_delayed(xlator_t *this, uuid_t gfid, char *subdir,
+                  index_xattrop_type_t type)
+{
+    if (index_type_is_delayed(type) && !index_journal_del(this, gfid, type))
+        return 0;
+
+    return index_del(this, gfid, subdir, type);
+}
+
 static gf_boolean_t
 _is_xattr_in_watchlist(dict_t *d, char *k, data_t *v, void *tmp)
 {
@@ -962,13 +1439,14 @@ _index_action(xlator_t *this, inode_t *inode, int *zfilled)
         if (zfilled[i] == 1) {
             if (ctx->state[i] == NOTIN)
                 continue;
-            ret = index_del(this, inode->gfid, subdir, i);
+            ret = index_del_delayed(this, inode->gfid, subdir, i);
             if (!ret)
                 ctx->state[i] = NOTIN;
         } else if (zfilled[i] == 0) {
             if (ctx->state[i] == IN)
                 continue;
-            ret = index_add(this, inode->gfid, subdir, i);
+            ret = index_add_delayed(this, inode->gfid, subdir, i,
+                                    ctx->state[i]);
             if (!ret)
                 ctx->state[i] = IN;
         }
@@ -1424,6 +1902,9 @@ index_entry_count(xlator_t *this, char *subdir)
 
     priv = this->private;
 
+    if (index_journal_pending(priv, XATTROP_TYPE_UNSET))
+        index_journal_flush(this, _gf_true);
+
     make_index_dir_path(priv->index_basepath, subdir, index_dir,
                         sizeof(index_dir));
 
@@ -1694,6 +2175,10 @@ index_get_gfid_type(void *opaque)
         if (loc.inode) {
             entry->d_stat.ia_type = loc.inode->ia_type;
             entry->d_type = gf_d_type_from_ia_type(loc.inode->ia_type);
+            /* the phased heal scheduler orders files by size */
+            if ((loc.inode->ia_type == IA_IFREG) &&
+                !syncop_stat(FIRST_CHILD(this), &loc, &iatt, NULL, NULL))
+                entry->d_stat = iatt;
             continue;
         }
         loc.inode = inode_new(args->parent->table);
@@ -1727,6 +2212,10 @@ index_readdir_wrapper(call_frame_t *frame, xlator_t *this, fd_t *fd,
     priv = this->private;
     INIT_LIST_HEAD(&entries.list);
 
+    /* the crawl of the indices sees the delayed entries too */
+    if (!off && index_journal_pending(priv, XATTROP_TYPE_UNSET))
+        index_journal_flush(this, _gf_true);
+
     ret = index_fd_ctx_get(fd, this, &fctx);
     if (ret < 0) {
         op_errno = -ret;
@@ -2044,6 +2533,9 @@ index_fill_link_count(xlator_t *this, dict_t *xdata)
         index_set_link_count(priv, count, XATTROP);
     }
 
+    if ((count == 0) && index_journal_pending(priv, XATTROP))
+        count = 1;
+
     if (count == 0) {
         ret = dict_set_int8(xdata, "link-count", 0);
         if (ret < 0)
@@ -2337,6 +2829,7 @@ init(xlator_t *this)
     char *pendinglist = NULL;
     char *index_base_parent = NULL;
     char *tmp = NULL;
+    char journal[PATH_MAX] = {0};
 
     if (!this->children || this->children->next) {
         gf_msg(this->name, GF_LOG_ERROR, EINVAL, INDEX_MSG_INVALID_GRAPH,
@@ -2354,6 +2847,8 @@ init(xlator_t *this)
         goto out;
 
     LOCK_INIT(&priv->lock);
+    pthread_mutex_init(&priv->journal_lock, NULL);
+    pthread_cond_init(&priv->journal_cond, NULL);
     if ((ret = pthread_cond_init(&priv->cond, NULL)) != 0) {
         gf_msg(this->name, GF_LOG_ERROR, ret, INDEX_MSG_INVALID_ARGS,
                "pthread_cond_init failed");
@@ -2415,6 +2910,9 @@ init(xlator_t *this)
         priv->complete_watchlist = dict_copy_with_ref(priv->pending_watchlist,
                                                       priv->complete_watchlist);
 
+    GF_OPTION_INIT("index-delay", priv->delay, uint32, out);
+    GF_OPTION_INIT("index-delay-batch", priv->delay_batch, uint32, out);
+
     gf_uuid_generate(priv->index);
     for (i = 0; i < XATTROP_TYPE_END; i++)
         gf_uuid_generate(priv->internal_vgfid[i]);
@@ -2444,6 +2942,12 @@ init(xlator_t *this)
     if (ret < 0)
         goto out;
 
+    /* a journal left by a previous run is replayed even without delay */
+    make_index_dir_path(priv->index_basepath, INDEX_JOURNAL_NAME, journal,
+                        sizeof(journal));
+    if (priv->delay || !sys_access(journal, F_OK))
+        (void)index_journal_start(this);
+
     /*init indices files counts*/
     count = index_fetch_link_count(this, XATTROP);
     index_set_link_count(priv, count, XATTROP);
@@ -2464,6 +2968,12 @@ out:
     GF_FREE(tmp);
 
     if (ret) {
+        if (priv) {
+            priv->down = _gf_true;
+            index_journal_stop(this);
+            pthread_cond_destroy(&priv->journal_cond);
+            pthread_mutex_destroy(&priv->journal_lock);
+        }
         if (cond_inited)
             pthread_cond_destroy(&priv->cond);
         if (mutex_inited)
@@ -2501,8 +3011,11 @@ fini(xlator_t *this)
         gf_thread_cleanup_xint(priv->thread);
         priv->thread = 0;
     }
+    index_journal_stop(this);
     this->private = NULL;
     LOCK_DESTROY(&priv->lock);
+    pthread_cond_destroy(&priv->journal_cond);
+    pthread_mutex_destroy(&priv->journal_lock);
     pthread_cond_destroy(&priv->cond);
     pthread_mutex_destroy(&priv->mutex);
     if (priv->dirty_watchlist)
@@ -2614,6 +3127,12 @@ notify(xlator_t *this, int event, void *data, ...)
         {
             priv->down = _gf_true;
             pthread_cond_broadcast(&priv->cond);
+
+            /* the journal thread links what it holds before leaving */
+            pthread_mutex_lock(&priv->journal_lock);
+            pthread_cond_broadcast(&priv->journal_cond);
+            pthread_mutex_unlock(&priv->journal_lock);
+
             while (priv->curr_count)
                 pthread_cond_wait(&priv->cond, &priv->mutex);
         }
@@ -2641,7 +3160,69 @@ struct xlator_fops fops = {
     .fstat = index_fstat,
 };
 
-struct xlator_dumpops dumpops;
+int
+reconfigure(xlator_t *this, dict_t *options)
+{
+    index_priv_t *priv = this->private;
+    uint32_t delay = 0;
+    int ret = -1;
+
+    GF_OPTION_RECONF("index-delay", delay, options, uint32, out);
+    GF_OPTION_RECONF("index-delay-batch", priv->delay_batch, options, uint32,
+                     out);
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        priv->delay = delay;
+        /* with no delay, what is held gets linked right away */
+        pthread_cond_broadcast(&priv->journal_cond);
+    }
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    if (delay)
+        (void)index_journal_start(this);
+
+    ret = 0;
+out:
+    return ret;
+}
+
+static int32_t
+index_priv_dump(xlator_t *this)
+{
+    index_priv_t *priv = this->private;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+    if (!priv)
+        return 0;
+
+    gf_proc_dump_build_key(key_prefix, this->type, this->name);
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("index-delay", "%u", priv->delay);
+    gf_proc_dump_write("index-delay-batch", "%u", priv->delay_batch);
+    if (!priv->journal)
+        return 0;
+
+    pthread_mutex_lock(&priv->journal_lock);
+    {
+        gf_proc_dump_write("journal-pending", "%u",
+                           priv->journal_count[XATTROP] +
+                               priv->journal_count[DIRTY]);
+        gf_proc_dump_write("journal-queued", "%" PRIu64, priv->journal_queued);
+        gf_proc_dump_write("journal-cancelled", "%" PRIu64,
+                           priv->journal_cancelled);
+        gf_proc_dump_write("journal-linked", "%" PRIu64, priv->journal_linked);
+        gf_proc_dump_write("journal-full", "%" PRIu64, priv->journal_full);
+    }
+    pthread_mutex_unlock(&priv->journal_lock);
+
+    return 0;
+}
+
+struct xlator_dumpops dumpops = {
+    .priv = index_priv_dump,
+};
 
 struct xlator_cbks cbks = {.forget = index_forget,
                            .release = index_release,
@@ -2664,6 +3245,27 @@ struct volume_options options[] = {
      .type = GF_OPTION_TYPE_STR,
      .description = "Comma separated list of xattrs that are watched",
      .default_value = "trusted.afr.{{ volume.name }}"},
+    {.key = {"index-delay"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 60000,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"index"},
+     .description = "Milliseconds the gfids of the xattrop and dirty indices "
+                    "are held in a journal before being linked under "
+                    "index-base. Entries deleted within that time never "
+                    "reach the disk. 0 links them right away."},
+    {.key = {"index-delay-batch"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 65536,
+     .default_value = "1024",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"index"},
+     .description = "Number of delayed index entries linked in one go."},
     {.key = {NULL}},
 };
 
@@ -2671,6 +3273,7 @@ xlator_api_t xlator_api = {
     .init = init,
     .fini = fini,
     .notify = notify,
+    .reconfigure = reconfigure,
     .mem_acct_init = mem_acct_init,
     .op_version = {1}, /* Present from the initial version */
     .dumpops = &dumpops,
@@ -20,6 +20,38 @@
 
 #define INDEX_THREAD_STACK_SIZE ((size_t)(1024 * 1024))
 
+/* Journal of the gfids added to the xattrop and dirty indices but not yet
+ * linked under index-base, when index-delay is set. It is mapped in memory,
+ * so it survives a crash of the brick and is replayed by the next init. */
+#define INDEX_JOURNAL_NAME "index-journal"
+#define INDEX_JOURNAL_MAGIC 0x474c5849 /* "GLXI" */
+#define INDEX_JOURNAL_VERSION 1
+#define INDEX_JOURNAL_SLOTS 16384
+#define INDEX_JOURNAL_PROBE 32
+
+enum {
+    INDEX_SLOT_FREE = 0,
+    INDEX_SLOT_PENDING, /* not linked yet */
+    INDEX_SLOT_FLUSHING /* being linked by the flusher */
+};
+
+/* on disk, 32 bytes each. The header takes the first slot. */
+typedef struct index_journal_slot {
+    unsigned char gfid[16];
+    uint32_t type; /* XATTROP or DIRTY */
+    uint8_t state;
+    uint8_t deleted; /* removed from the index while being linked */
+    uint16_t pad;
+    uint64_t time; /* msecs, when added */
+} index_journal_slot_t;
+
+typedef struct index_journal_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t pad[5];
+} index_journal_header_t;
+
 typedef enum { UNKNOWN, IN, NOTIN } index_state_t;
 
 typedef enum {
@@ -60,6 +92,21 @@ typedef struct index_priv {
     gf_boolean_t down;
     gf_atomic_t stub_cnt;
     int32_t curr_count;
+
+    /* delayed index adds, see INDEX_JOURNAL_NAME */
+    uint32_t delay;       /* msecs */
+    uint32_t delay_batch; /* gfids linked per pass of the flusher */
+    index_journal_slot_t *journal;
+    size_t journal_size;
+    pthread_mutex_t journal_lock;
+    pthread_cond_t journal_cond;
+    pthread_t journal_thread;
+    gf_boolean_t journal_thread_running;
+    uint32_t journal_count[XATTROP_TYPE_END]; /* slots in use */
+    uint64_t journal_queued;    /* adds delayed */
+    uint64_t journal_cancelled; /* deleted before being linked */
+    uint64_t journal_linked;    /* linked by the flusher */
+    uint64_t journal_full;      /* added right away, journal full */
 } index_priv_t;
 
 typedef struct index_local {
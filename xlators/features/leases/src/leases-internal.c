@@ -720,11 +720,12 @@ __is_lease_grantable(xlator_t *this, lease_inode_ctx_t *lease_ctx,
         {
             ret = fd_ctx_get(iter_fd, this, &ctx);
             if (ret < 0) {
-                grant = _gf_false;
-                UNLOCK(&inode->lock);
-                gf_msg(this->name, GF_LOG_ERROR, 0, LEASE_MSG_INVAL_FD_CTX,
-                       "Unable to get fd ctx");
-                goto out;
+                /* fds not opened through leases_open (created files,
+                 * directories, internal opens) have no lease id, they
+                 * conflict according to the way they were opened */
+                fd_count++;
+                flags |= iter_fd->flags;
+                continue;
             }
             fd_ctx = (lease_fd_ctx_t *)(long)ctx;
 
@@ -1019,7 +1020,8 @@ process_lease_req(call_frame_t *frame, xlator_t *this, inode_t *inode,
                                  " request from %s on gfid(%s)",
                                  client_uid, uuid_utoa(inode->gfid));
                     __recall_lease(this, lease_ctx);
-                    ret = -1;
+                    ret = -EAGAIN;
+                    errno = EAGAIN;
                 }
                 break;
             case GF_UNLK_LEASE:
@@ -1066,7 +1068,8 @@ __check_lease_conflict(call_frame_t *frame, lease_inode_ctx_t *lease_ctx,
      * from the same client??
      */
     if ((frame->root->op == GF_FOP_RENAME) ||
-        (frame->root->op == GF_FOP_UNLINK)) {
+        (frame->root->op == GF_FOP_UNLINK) ||
+        (frame->root->op == GF_FOP_RMDIR)) {
         conflicts = _gf_true;
         goto recall;
     }
@@ -1083,9 +1086,11 @@ __check_lease_conflict(call_frame_t *frame, lease_inode_ctx_t *lease_ctx,
     }
 
     /* If lease_id is not sent, set conflicts = true if there is
-     * an existing lease */
+     * an existing lease. Read leases only conflict with writes, so that
+     * clients which do not take leases can still read the file. */
     if (!lease_id && (lease_ctx->lease_cnt > 0)) {
-        conflicts = _gf_true;
+        if (is_write || (lease_type & GF_RW_LEASE))
+            conflicts = _gf_true;
         goto recall;
     }
 
@@ -1186,6 +1191,55 @@ out:
     return ret;
 }
 
+/* Entry fops change the directories they add entries to or remove entries
+ * from. They conflict with the leases other lease ids hold on those
+ * directories, whatever their type. A fop with no lease id conflicts with
+ * any lease.
+ *
+ * Return values:
+ * WIND_FOP: No conflict, wind the fop
+ * BLOCK_FOP: Found a conflicting lease, block the fop
+ */
+int
+check_entry_lease_conflict(call_frame_t *frame, inode_t *dir,
+                           const char *lease_id)
+{
+    lease_inode_ctx_t *lease_ctx = NULL;
+    gf_boolean_t conflicts = _gf_false;
+    uint64_t ctx = 0;
+
+    if (!dir || (frame->root->pid < 0))
+        return WIND_FOP;
+
+    /* no ctx for every directory entries are created in, a directory
+     * without one never had a lease */
+    if (inode_ctx_get(dir, frame->this, &ctx) || !ctx)
+        return WIND_FOP;
+
+    lease_ctx = (lease_inode_ctx_t *)(long)ctx;
+
+    pthread_mutex_lock(&lease_ctx->lock);
+    {
+        if (lease_ctx->lease_type != NONE) {
+            conflicts = (!lease_id ||
+                         __another_lease_found(lease_ctx, lease_id));
+            if (conflicts)
+                __recall_lease(frame->this, lease_ctx);
+        }
+    }
+    pthread_mutex_unlock(&lease_ctx->lock);
+
+    if (conflicts) {
+        gf_msg_debug(frame->this->name, 0,
+                     "Fop: %s conflicting existing lease on the parent "
+                     "directory %s, blocking the fop",
+                     gf_fop_list[frame->root->op], uuid_utoa(dir->gfid));
+        return BLOCK_FOP;
+    }
+
+    return WIND_FOP;
+}
+
 static int
 remove_clnt_leases(const char *client_uid, inode_t *inode, xlator_t *this)
 {
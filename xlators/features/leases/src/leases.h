@@ -75,7 +75,9 @@
             fop == GF_FOP_WRITE || fop == GF_FOP_FALLOCATE ||                  \
             fop == GF_FOP_DISCARD || fop == GF_FOP_ZEROFILL ||                 \
             fop == GF_FOP_SETATTR || fop == GF_FOP_FSETATTR ||                 \
-            fop == GF_FOP_LINK)                                                \
+            fop == GF_FOP_LINK || fop == GF_FOP_RMDIR ||                       \
+            fop == GF_FOP_SETXATTR || fop == GF_FOP_FSETXATTR ||               \
+            fop == GF_FOP_REMOVEXATTR || fop == GF_FOP_FREMOVEXATTR)           \
             fop_flags = DATA_MODIFY_FOP;                                       \
                                                                                \
         if (!(fd_flags & (O_NONBLOCK | O_NDELAY)))                             \
@@ -245,6 +247,10 @@ int
 check_lease_conflict(call_frame_t *frame, inode_t *inode, const char *lease_id,
                      uint32_t fop_flags);
 
+int
+check_entry_lease_conflict(call_frame_t *frame, inode_t *dir,
+                           const char *lease_id);
+
 int
 cleanup_client_leases(xlator_t *this, const char *client_uid);
 
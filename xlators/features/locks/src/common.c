@@ -49,6 +49,8 @@ __allocate_domain(const char *volume)
     INIT_LIST_HEAD(&dom->blocked_entrylks);
     INIT_LIST_HEAD(&dom->inodelk_list);
     INIT_LIST_HEAD(&dom->blocked_inodelks);
+    pl_itree_init(&dom->inodelk_tree);
+    pl_itree_init(&dom->blocked_inodelk_tree);
 
 out:
     if (dom && (NULL == dom->domain)) {
@@ -454,6 +456,7 @@ pl_inode_get(xlator_t *this, inode_t *inode, pl_local_t *local)
 
         INIT_LIST_HEAD(&pl_inode->dom_list);
         INIT_LIST_HEAD(&pl_inode->ext_list);
+        pl_itree_init(&pl_inode->ext_tree);
         INIT_LIST_HEAD(&pl_inode->rw_list);
         INIT_LIST_HEAD(&pl_inode->reservelk_list);
         INIT_LIST_HEAD(&pl_inode->blocked_reservelks);
@@ -548,6 +551,7 @@ out:
 void
 __delete_lock(posix_lock_t *lock)
 {
+    pl_itree_remove(&lock->range);
     list_del_init(&lock->list);
 }
 
@@ -573,8 +577,10 @@ __copy_lock(posix_lock_t *src)
             dst = NULL;
         }
 
-        if (dst != NULL)
+        if (dst != NULL) {
             INIT_LIST_HEAD(&dst->list);
+            pl_itree_node_init(&dst->range);
+        }
     }
 
     return dst;
@@ -606,6 +612,12 @@ __insert_lock(pl_inode_t *pl_inode, posix_lock_t *lock)
 
     list_add_tail(&lock->list, &pl_inode->ext_list);
 
+    /* Only granted locks are indexed, blocked ones are always looked at in
+     * the order they were queued. */
+    if (!lock->blocked)
+        pl_itree_insert(&pl_inode->ext_tree, &lock->range, lock->fl_start,
+                        lock->fl_end);
+
     return;
 }
 
@@ -750,76 +762,100 @@ done:
     return v;
 }
 
+typedef struct {
+    posix_lock_t *lock;
+    posix_lock_t *found;
+} pl_overlap_args_t;
+
+static int
+__conflicting_overlap_fn(pl_itree_node_t *node, void *data)
+{
+    pl_overlap_args_t *args = data;
+    posix_lock_t *l = pl_itree_entry(node, posix_lock_t, range);
+
+    if (same_owner(l, args->lock))
+        return 0;
+
+    if ((l->fl_type == F_WRLCK) || (args->lock->fl_type == F_WRLCK)) {
+        args->found = l;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int
+__overlap_fn(pl_itree_node_t *node, void *data)
+{
+    pl_overlap_args_t *args = data;
+
+    args->found = pl_itree_entry(node, posix_lock_t, range);
+
+    return 1;
+}
+
+static int
+__owner_overlap_fn(pl_itree_node_t *node, void *data)
+{
+    pl_overlap_args_t *args = data;
+    posix_lock_t *l = pl_itree_entry(node, posix_lock_t, range);
+
+    if (!same_owner(l, args->lock))
+        return 0;
+
+    args->found = l;
+
+    return 1;
+}
+
 static posix_lock_t *
 first_conflicting_overlap(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
-    posix_lock_t *l = NULL;
-    posix_lock_t *conf = NULL;
+    pl_overlap_args_t args = {
+        .lock = lock,
+    };
 
     pthread_mutex_lock(&pl_inode->mutex);
     {
-        list_for_each_entry(l, &pl_inode->ext_list, list)
-        {
-            if (l->blocked)
-                continue;
-
-            if (locks_overlap(l, lock)) {
-                if (same_owner(l, lock))
-                    continue;
-
-                if ((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) {
-                    conf = l;
-                    goto unlock;
-                }
-            }
-        }
+        pl_itree_walk(&pl_inode->ext_tree, lock->fl_start, lock->fl_end,
+                      __conflicting_overlap_fn, &args);
     }
-unlock:
     pthread_mutex_unlock(&pl_inode->mutex);
 
-    return conf;
+    return args.found;
 }
 
 /*
-  Start searching from {begin}, and return the first lock that
-  conflicts, NULL if no conflict
-  If {begin} is NULL, then start from the beginning of the list
+  Return a granted lock overlapping with {lock}, NULL if there is none
 */
 static posix_lock_t *
 first_overlap(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
-    posix_lock_t *l = NULL;
-
-    list_for_each_entry(l, &pl_inode->ext_list, list)
-    {
-        if (l->blocked)
-            continue;
+    pl_overlap_args_t args = {
+        .lock = lock,
+    };
 
-        if (locks_overlap(l, lock))
-            return l;
-    }
+    pl_itree_walk(&pl_inode->ext_tree, lock->fl_start, lock->fl_end,
+                  __overlap_fn, &args);
 
-    return NULL;
+    return args.found;
 }
 
 /* Return true if lock is grantable */
 static int
 __is_lock_grantable(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
-    posix_lock_t *l = NULL;
-    int ret = 1;
+    pl_overlap_args_t args = {
+        .lock = lock,
+    };
 
-    list_for_each_entry(l, &pl_inode->ext_list, list)
-    {
-        if (!l->blocked && locks_overlap(lock, l)) {
-            if (((l->fl_type == F_WRLCK) || (lock->fl_type == F_WRLCK)) &&
-                (lock->fl_type != F_UNLCK) && !same_owner(l, lock)) {
-                ret = 0;
-                break;
-            }
-        }
-    }
-    return ret;
+    if (lock->fl_type == F_UNLCK)
+        return 1;
+
+    pl_itree_walk(&pl_inode->ext_tree, lock->fl_start, lock->fl_end,
+                  __conflicting_overlap_fn, &args);
+
+    return (args.found == NULL);
 }
 
 extern void
@@ -829,63 +865,55 @@ static void
 __insert_and_merge(pl_inode_t *pl_inode, posix_lock_t *lock)
 {
     posix_lock_t *conf = NULL;
-    posix_lock_t *t = NULL;
     posix_lock_t *sum = NULL;
     int i = 0;
     struct _values v = {.locks = {0, 0, 0}};
+    pl_overlap_args_t args = {
+        .lock = lock,
+    };
 
-    list_for_each_entry_safe(conf, t, &pl_inode->ext_list, list)
-    {
-        if (conf->blocked)
-            continue;
-        if (!locks_overlap(conf, lock))
-            continue;
-
-        if (same_owner(conf, lock)) {
-            if (conf->fl_type == lock->fl_type &&
-                conf->lk_flags == lock->lk_flags) {
-                sum = add_locks(lock, conf, lock);
+    /* Locks of other owners never need merging: they were checked for
+     * conflicts before getting here, and overlapping read locks simply
+     * coexist. */
+    pl_itree_walk(&pl_inode->ext_tree, lock->fl_start, lock->fl_end,
+                  __owner_overlap_fn, &args);
+    conf = args.found;
 
-                __delete_lock(conf);
-                __destroy_lock(conf);
+    if (conf) {
+        if (conf->fl_type == lock->fl_type &&
+            conf->lk_flags == lock->lk_flags) {
+            sum = add_locks(lock, conf, lock);
 
-                __destroy_lock(lock);
-                INIT_LIST_HEAD(&sum->list);
-                posix_lock_to_flock(sum, &sum->user_flock);
-                __insert_and_merge(pl_inode, sum);
+            __delete_lock(conf);
+            __destroy_lock(conf);
 
-                return;
-            } else {
-                sum = add_locks(lock, conf, conf);
+            __destroy_lock(lock);
+            INIT_LIST_HEAD(&sum->list);
+            posix_lock_to_flock(sum, &sum->user_flock);
+            __insert_and_merge(pl_inode, sum);
 
-                v = subtract_locks(sum, lock);
+            return;
+        } else {
+            sum = add_locks(lock, conf, conf);
 
-                __delete_lock(conf);
-                __destroy_lock(conf);
+            v = subtract_locks(sum, lock);
 
-                __delete_lock(lock);
-                __destroy_lock(lock);
+            __delete_lock(conf);
+            __destroy_lock(conf);
 
-                __destroy_lock(sum);
+            __delete_lock(lock);
+            __destroy_lock(lock);
 
-                for (i = 0; i < 3; i++) {
-                    if (!v.locks[i])
-                        continue;
+            __destroy_lock(sum);
 
-                    __insert_and_merge(pl_inode, v.locks[i]);
-                }
+            for (i = 0; i < 3; i++) {
+                if (!v.locks[i])
+                    continue;
 
-                __delete_unlck_locks(pl_inode);
-                return;
+                __insert_and_merge(pl_inode, v.locks[i]);
             }
-        }
-
-        if (lock->fl_type == F_UNLCK) {
-            continue;
-        }
 
-        if ((conf->fl_type == F_RDLCK) && (lock->fl_type == F_RDLCK)) {
-            __insert_lock(pl_inode, lock);
+            __delete_unlck_locks(pl_inode);
             return;
         }
     }
@@ -101,6 +101,9 @@ inodelk_contention_notify(xlator_t *this, struct list_head *contend);
 void
 __delete_inode_lock(pl_inode_lock_t *lock);
 
+void
+__delete_blocked_inode_lock(pl_inode_lock_t *lock);
+
 void
 __pl_inodelk_unref(pl_inode_lock_t *lock);
 
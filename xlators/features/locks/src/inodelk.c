@@ -12,18 +12,107 @@
 #include <glusterfs/dict.h>
 #include <glusterfs/logging.h>
 #include <glusterfs/list.h>
+#include <glusterfs/hashfn.h>
 #include <glusterfs/upcall-utils.h>
 
 #include "locks.h"
 #include "clear.h"
 #include "common.h"
 
+/* Domains get an owner table once they hold this many inodelks, so that
+ * the check for nested locks does not walk every lock of the domain. */
+#define PL_INODELK_OWNER_TABLE_MIN 32
+#define PL_INODELK_OWNER_HASH_SIZE 256
+
+static uint32_t
+__inodelk_owner_hash(pl_inode_lock_t *lock)
+{
+    uint32_t hash = 0;
+
+    if (lock->owner.len > 0)
+        hash = gf_dm_hashfn(lock->owner.data, lock->owner.len);
+    hash ^= (uint32_t)((uintptr_t)lock->client >> 4);
+
+    return hash % PL_INODELK_OWNER_HASH_SIZE;
+}
+
+static uint32_t
+__inodelk_dom_lock_count(pl_dom_list_t *dom)
+{
+    return pl_itree_count(&dom->inodelk_tree) +
+           pl_itree_count(&dom->blocked_inodelk_tree);
+}
+
+static void
+__inodelk_owner_table_build(pl_dom_list_t *dom)
+{
+    struct list_head *table = NULL;
+    pl_inode_lock_t *l = NULL;
+    int i = 0;
+
+    /* If this fails the lists keep being scanned, as they would be for a
+     * domain with few locks. */
+    table = GF_MALLOC(PL_INODELK_OWNER_HASH_SIZE * sizeof(*table),
+                      gf_locks_mt_pl_inodelk_owners_t);
+    if (!table)
+        return;
+
+    for (i = 0; i < PL_INODELK_OWNER_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&table[i]);
+
+    list_for_each_entry(l, &dom->inodelk_list, list)
+    {
+        list_add_tail(&l->owner_list, &table[__inodelk_owner_hash(l)]);
+    }
+
+    list_for_each_entry(l, &dom->blocked_inodelks, blocked_locks)
+    {
+        list_add_tail(&l->owner_list, &table[__inodelk_owner_hash(l)]);
+    }
+
+    dom->inodelk_owners = table;
+}
+
+/* Index a lock that was just added to the granted or blocked list of the
+ * domain in the matching interval tree and in the owner table. */
+static void
+__inodelk_index(pl_dom_list_t *dom, pl_itree_t *tree, pl_inode_lock_t *lock)
+{
+    pl_itree_insert(tree, &lock->range, lock->fl_start, lock->fl_end);
+
+    if (dom->inodelk_owners) {
+        list_add_tail(&lock->owner_list,
+                      &dom->inodelk_owners[__inodelk_owner_hash(lock)]);
+    } else if (__inodelk_dom_lock_count(dom) >= PL_INODELK_OWNER_TABLE_MIN) {
+        __inodelk_owner_table_build(dom);
+    }
+}
+
+static void
+__inodelk_unindex(pl_inode_lock_t *lock)
+{
+    pl_itree_remove(&lock->range);
+    list_del_init(&lock->owner_list);
+}
+
 void
 __delete_inode_lock(pl_inode_lock_t *lock)
 {
+    if (!list_empty(&lock->list))
+        __inodelk_unindex(lock);
     list_del_init(&lock->list);
 }
 
+void
+__delete_blocked_inode_lock(pl_inode_lock_t *lock)
+{
+    /* A granted lock may be linked through blocked_locks in the list of
+     * locks waiting to be unwound, it is not indexed as blocked then. */
+    if (list_empty(&lock->list))
+        __inodelk_unindex(lock);
+    list_del_init(&lock->blocked_locks);
+}
+
 static void
 __pl_inodelk_ref(pl_inode_lock_t *lock)
 {
@@ -163,13 +252,30 @@ __stale_inodelk(xlator_t *this, pl_inode_lock_t *candidate_lock,
  * introduce a heuristic which clears blocked locks as well if they
  * are beyond a threshold.
  */
+typedef struct {
+    xlator_t *this;
+    pl_inode_lock_t *lock;
+    time_t lock_age_sec;
+} pl_stale_inodelk_args_t;
+
+static int
+__stale_inodelk_fn(pl_itree_node_t *node, void *data)
+{
+    pl_stale_inodelk_args_t *args = data;
+    pl_inode_lock_t *lk = pl_itree_entry(node, pl_inode_lock_t, range);
+
+    return __stale_inodelk(args->this, lk, args->lock, &args->lock_age_sec);
+}
+
 static gf_boolean_t
 __inodelk_prune_stale(xlator_t *this, pl_inode_t *pinode, pl_dom_list_t *dom,
                       pl_inode_lock_t *lock)
 {
     posix_locks_private_t *priv = NULL;
-    pl_inode_lock_t *tmp = NULL;
-    pl_inode_lock_t *lk = NULL;
+    pl_stale_inodelk_args_t stale = {
+        .this = this,
+        .lock = lock,
+    };
     gf_boolean_t revoke_lock = _gf_false;
     int bcount = 0;
     int gcount = 0;
@@ -192,26 +298,18 @@ __inodelk_prune_stale(xlator_t *this, pl_inode_t *pinode, pl_dom_list_t *dom,
         goto out;
 
     pthread_mutex_lock(&pinode->mutex);
-    list_for_each_entry_safe(lk, tmp, &dom->inodelk_list, list)
-    {
-        if (__stale_inodelk(this, lk, lock, &lk_age_sec) == _gf_true) {
-            revoke_lock = _gf_true;
-            reason_str = "age";
-            break;
-        }
+    if (pl_itree_walk(&dom->inodelk_tree, lock->fl_start, lock->fl_end,
+                      __stale_inodelk_fn, &stale)) {
+        lk_age_sec = stale.lock_age_sec;
+        revoke_lock = _gf_true;
+        reason_str = "age";
     }
 
     max_blocked = priv->revocation_max_blocked;
-    if (max_blocked != 0 && revoke_lock == _gf_false) {
-        list_for_each_entry_safe(lk, tmp, &dom->blocked_inodelks, blocked_locks)
-        {
-            max_blocked--;
-            if (max_blocked == 0) {
-                revoke_lock = _gf_true;
-                reason_str = "max blocked";
-                break;
-            }
-        }
+    if (max_blocked != 0 && revoke_lock == _gf_false &&
+        pl_itree_count(&dom->blocked_inodelk_tree) >= max_blocked) {
+        revoke_lock = _gf_true;
+        reason_str = "max blocked";
     }
     pthread_mutex_unlock(&pinode->mutex);
 
@@ -334,45 +432,79 @@ inodelk_contention_notify(xlator_t *this, struct list_head *contend)
     }
 }
 
+typedef struct {
+    xlator_t *this;
+    pl_inode_lock_t *lock;
+    pl_inode_lock_t *conf;
+    struct timespec *now;
+    struct list_head *contend;
+} pl_inodelk_conflict_args_t;
+
+static int
+__inodelk_grantable_fn(pl_itree_node_t *node, void *data)
+{
+    pl_inodelk_conflict_args_t *args = data;
+    pl_inode_lock_t *l = pl_itree_entry(node, pl_inode_lock_t, range);
+
+    if (!inodelk_type_conflict(args->lock, l) ||
+        same_inodelk_owner(args->lock, l))
+        return 0;
+
+    if (args->conf == NULL) {
+        args->conf = l;
+        if (args->contend == NULL)
+            return 1;
+    }
+
+    if (__inodelk_needs_contention_notify(args->this, l, args->now))
+        list_add_tail(&l->contend, args->contend);
+
+    return 0;
+}
+
 /* Determine if lock is grantable or not */
 static pl_inode_lock_t *
 __inodelk_grantable(xlator_t *this, pl_dom_list_t *dom, pl_inode_lock_t *lock,
                     struct timespec *now, struct list_head *contend)
 {
-    pl_inode_lock_t *l = NULL;
-    pl_inode_lock_t *ret = NULL;
+    pl_inodelk_conflict_args_t args = {
+        .this = this,
+        .lock = lock,
+        .now = now,
+        .contend = contend,
+    };
 
-    list_for_each_entry(l, &dom->inodelk_list, list)
-    {
-        if (inodelk_conflict(lock, l) && !same_inodelk_owner(lock, l)) {
-            if (ret == NULL) {
-                ret = l;
-                if (contend == NULL) {
-                    break;
-                }
-            }
-            if (__inodelk_needs_contention_notify(this, l, now)) {
-                list_add_tail(&l->contend, contend);
-            }
-        }
-    }
+    pl_itree_walk(&dom->inodelk_tree, lock->fl_start, lock->fl_end,
+                  __inodelk_grantable_fn, &args);
 
-    return ret;
+    return args.conf;
+}
+
+static int
+__blocked_lock_conflict_fn(pl_itree_node_t *node, void *data)
+{
+    pl_inodelk_conflict_args_t *args = data;
+    pl_inode_lock_t *l = pl_itree_entry(node, pl_inode_lock_t, range);
+
+    if (!inodelk_type_conflict(args->lock, l))
+        return 0;
+
+    args->conf = l;
+
+    return 1;
 }
 
 static pl_inode_lock_t *
 __blocked_lock_conflict(pl_dom_list_t *dom, pl_inode_lock_t *lock)
 {
-    pl_inode_lock_t *l = NULL;
+    pl_inodelk_conflict_args_t args = {
+        .lock = lock,
+    };
 
-    list_for_each_entry(l, &dom->blocked_inodelks, blocked_locks)
-    {
-        if (inodelk_conflict(lock, l)) {
-            return l;
-        }
-    }
+    pl_itree_walk(&dom->blocked_inodelk_tree, lock->fl_start, lock->fl_end,
+                  __blocked_lock_conflict_fn, &args);
 
-    return NULL;
+    return args.conf;
 }
 
 static int
@@ -380,6 +512,18 @@ __owner_has_lock(pl_dom_list_t *dom, pl_inode_lock_t *newlock)
 {
     pl_inode_lock_t *lock = NULL;
 
+    if (dom->inodelk_owners) {
+        list_for_each_entry(
+            lock, &dom->inodelk_owners[__inodelk_owner_hash(newlock)],
+            owner_list)
+        {
+            if (same_inodelk_owner(lock, newlock))
+                return 1;
+        }
+
+        return 0;
+    }
+
     list_for_each_entry(lock, &dom->inodelk_list, list)
     {
         if (same_inodelk_owner(lock, newlock))
@@ -409,6 +553,7 @@ __lock_blocked_add(xlator_t *this, pl_dom_list_t *dom, pl_inode_lock_t *lock,
 
     lock->blkd_time = now;
     list_add_tail(&lock->blocked_locks, &dom->blocked_inodelks);
+    __inodelk_index(dom, &dom->blocked_inodelk_tree, lock);
 
     gf_msg_trace(this->name, 0,
                  "%s (pid=%d) (lk-owner=%s) %" PRId64
@@ -464,6 +609,7 @@ __lock_inodelk(xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
     __pl_inodelk_ref(lock);
     gettimeofday(&lock->granted_time, NULL);
     list_add(&lock->list, &dom->inodelk_list);
+    __inodelk_index(dom, &dom->inodelk_tree, lock);
 
     ret = 0;
 
@@ -481,16 +627,32 @@ inodelks_equal(pl_inode_lock_t *l1, pl_inode_lock_t *l2)
     return 0;
 }
 
+static int
+__matching_inodelk_fn(pl_itree_node_t *node, void *data)
+{
+    pl_inodelk_conflict_args_t *args = data;
+    pl_inode_lock_t *l = pl_itree_entry(node, pl_inode_lock_t, range);
+
+    if (!inodelks_equal(l, args->lock) || !same_inodelk_owner(l, args->lock))
+        return 0;
+
+    args->conf = l;
+
+    return 1;
+}
+
 static pl_inode_lock_t *
 find_matching_inodelk(pl_inode_lock_t *lock, pl_dom_list_t *dom)
 {
-    pl_inode_lock_t *l = NULL;
-    list_for_each_entry(l, &dom->inodelk_list, list)
-    {
-        if (inodelks_equal(l, lock) && same_inodelk_owner(l, lock))
-            return l;
-    }
-    return NULL;
+    pl_inodelk_conflict_args_t args = {
+        .lock = lock,
+    };
+
+    /* Only locks starting at the same offset can match. */
+    pl_itree_walk(&dom->inodelk_tree, lock->fl_start, lock->fl_start,
+                  __matching_inodelk_fn, &args);
+
+    return args.conf;
 }
 
 /* Set F_UNLCK removes a lock which has the exact same lock boundaries
@@ -535,6 +697,14 @@ __grant_blocked_inode_locks(xlator_t *this, pl_inode_t *pl_inode,
     INIT_LIST_HEAD(&blocked_list);
     list_splice_init(&dom->blocked_inodelks, &blocked_list);
 
+    /* Locks still waiting in blocked_list must not stop the ones queued
+     * before them from being granted, so they are only indexed again if
+     * they block once more. */
+    list_for_each_entry(bl, &blocked_list, blocked_locks)
+    {
+        __inodelk_unindex(bl);
+    }
+
     list_for_each_entry_safe(bl, tmp, &blocked_list, blocked_locks)
     {
         list_del_init(&bl->blocked_locks);
@@ -680,7 +850,7 @@ pl_inodelk_client_cleanup(xlator_t *this, pl_ctx_t *ctx)
                     __delete_inode_lock(l);
                     list_add_tail(&l->client_list, &released);
                 } else {
-                    list_del_init(&l->blocked_locks);
+                    __delete_blocked_inode_lock(l);
                     list_add_tail(&l->client_list, &unwind);
                 }
             }
@@ -913,6 +1083,7 @@ new_inode_lock(struct gf_flock *flock, client_t *client, pid_t client_pid,
     INIT_LIST_HEAD(&lock->blocked_locks);
     INIT_LIST_HEAD(&lock->client_list);
     INIT_LIST_HEAD(&lock->contend);
+    INIT_LIST_HEAD(&lock->owner_list);
     __pl_inodelk_ref(lock);
 
 out:
@@ -1085,15 +1256,7 @@ pl_finodelk(call_frame_t *frame, xlator_t *this, const char *volume, fd_t *fd,
 static int32_t
 __get_inodelk_dom_count(pl_dom_list_t *dom)
 {
-    pl_inode_lock_t *lock = NULL;
-    int32_t count = 0;
-
-    list_for_each_entry(lock, &dom->inodelk_list, list) { count++; }
-    list_for_each_entry(lock, &dom->blocked_inodelks, blocked_locks)
-    {
-        count++;
-    }
-    return count;
+    return __inodelk_dom_lock_count(dom);
 }
 
 /* Returns the no. of locks (blocked/granted) held on a given domain name
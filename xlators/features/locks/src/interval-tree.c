@@ -0,0 +1,222 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#include <glusterfs/common-utils.h>
+
+#include "interval-tree.h"
+
+static int
+pl_itree_height(pl_itree_node_t *node)
+{
+    return node ? node->height : 0;
+}
+
+static void
+pl_itree_update(pl_itree_node_t *node)
+{
+    int lh = pl_itree_height(node->left);
+    int rh = pl_itree_height(node->right);
+
+    node->height = max(lh, rh) + 1;
+
+    node->max_end = node->end;
+    if (node->left && node->left->max_end > node->max_end)
+        node->max_end = node->left->max_end;
+    if (node->right && node->right->max_end > node->max_end)
+        node->max_end = node->right->max_end;
+}
+
+static pl_itree_node_t *
+pl_itree_rotate_right(pl_itree_node_t *node)
+{
+    pl_itree_node_t *left = node->left;
+
+    node->left = left->right;
+    left->right = node;
+
+    pl_itree_update(node);
+    pl_itree_update(left);
+
+    return left;
+}
+
+static pl_itree_node_t *
+pl_itree_rotate_left(pl_itree_node_t *node)
+{
+    pl_itree_node_t *right = node->right;
+
+    node->right = right->left;
+    right->left = node;
+
+    pl_itree_update(node);
+    pl_itree_update(right);
+
+    return right;
+}
+
+static pl_itree_node_t *
+pl_itree_balance(pl_itree_node_t *node)
+{
+    int balance = 0;
+
+    pl_itree_update(node);
+
+    balance = pl_itree_height(node->left) - pl_itree_height(node->right);
+    if (balance > 1) {
+        if (pl_itree_height(node->left->left) <
+            pl_itree_height(node->left->right))
+            node->left = pl_itree_rotate_left(node->left);
+        return pl_itree_rotate_right(node);
+    }
+
+    if (balance < -1) {
+        if (pl_itree_height(node->right->right) <
+            pl_itree_height(node->right->left))
+            node->right = pl_itree_rotate_right(node->right);
+        return pl_itree_rotate_left(node);
+    }
+
+    return node;
+}
+
+/* Several locks may cover the same range, so nodes with equal starts are
+ * ordered by address. This keeps every node reachable by a plain descent,
+ * which is what removal relies on. */
+static int
+pl_itree_cmp(pl_itree_node_t *n1, pl_itree_node_t *n2)
+{
+    if (n1->start != n2->start)
+        return (n1->start < n2->start) ? -1 : 1;
+
+    if (n1 != n2)
+        return ((uintptr_t)n1 < (uintptr_t)n2) ? -1 : 1;
+
+    return 0;
+}
+
+static pl_itree_node_t *
+__pl_itree_insert(pl_itree_node_t *root, pl_itree_node_t *node)
+{
+    if (!root)
+        return node;
+
+    if (pl_itree_cmp(node, root) < 0)
+        root->left = __pl_itree_insert(root->left, node);
+    else
+        root->right = __pl_itree_insert(root->right, node);
+
+    return pl_itree_balance(root);
+}
+
+static pl_itree_node_t *
+__pl_itree_remove_min(pl_itree_node_t *root, pl_itree_node_t **min)
+{
+    if (!root->left) {
+        *min = root;
+        return root->right;
+    }
+
+    root->left = __pl_itree_remove_min(root->left, min);
+
+    return pl_itree_balance(root);
+}
+
+static pl_itree_node_t *
+__pl_itree_remove(pl_itree_node_t *root, pl_itree_node_t *node)
+{
+    pl_itree_node_t *min = NULL;
+    pl_itree_node_t *right = NULL;
+    int cmp = 0;
+
+    if (!root)
+        return NULL;
+
+    cmp = pl_itree_cmp(node, root);
+    if (cmp < 0) {
+        root->left = __pl_itree_remove(root->left, node);
+    } else if (cmp > 0) {
+        root->right = __pl_itree_remove(root->right, node);
+    } else {
+        if (!root->right)
+            return root->left;
+
+        right = __pl_itree_remove_min(root->right, &min);
+        min->right = right;
+        min->left = root->left;
+
+        return pl_itree_balance(min);
+    }
+
+    return pl_itree_balance(root);
+}
+
+void
+pl_itree_insert(pl_itree_t *tree, pl_itree_node_t *node, off_t start,
+                off_t end)
+{
+    GF_ASSERT(node->tree == NULL);
+
+    node->left = NULL;
+    node->right = NULL;
+    node->start = start;
+    node->end = end;
+    node->max_end = end;
+    node->height = 1;
+    node->tree = tree;
+
+    tree->root = __pl_itree_insert(tree->root, node);
+    tree->count++;
+}
+
+void
+pl_itree_remove(pl_itree_node_t *node)
+{
+    pl_itree_t *tree = node->tree;
+
+    if (!tree)
+        return;
+
+    tree->root = __pl_itree_remove(tree->root, node);
+    tree->count--;
+
+    pl_itree_node_init(node);
+}
+
+static int
+__pl_itree_walk(pl_itree_node_t *node, off_t start, off_t end,
+                pl_itree_fn_t fn, void *data)
+{
+    int ret = 0;
+
+    if (!node || node->max_end < start)
+        return 0;
+
+    ret = __pl_itree_walk(node->left, start, end, fn, data);
+    if (ret)
+        return ret;
+
+    /* Everything from here on starts after the searched range. */
+    if (node->start > end)
+        return 0;
+
+    if (node->end >= start) {
+        ret = fn(node, data);
+        if (ret)
+            return ret;
+    }
+
+    return __pl_itree_walk(node->right, start, end, fn, data);
+}
+
+int
+pl_itree_walk(pl_itree_t *tree, off_t start, off_t end, pl_itree_fn_t fn,
+              void *data)
+{
+    return __pl_itree_walk(tree->root, start, end, fn, data);
+}
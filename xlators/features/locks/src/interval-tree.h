@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef __PL_INTERVAL_TREE_H__
+#define __PL_INTERVAL_TREE_H__
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Intrusive interval tree of byte ranges [start, end]. It is an AVL tree
+ * ordered by start, where every node also remembers the largest end found
+ * in its subtree, so that all the ranges overlapping a given one can be
+ * found without visiting the others.
+ *
+ * The tree does no locking and no allocation: nodes are embedded in the
+ * lock structures and the caller serializes access (pl_inode->mutex). */
+
+struct _pl_itree;
+
+typedef struct _pl_itree_node {
+    struct _pl_itree_node *left;
+    struct _pl_itree_node *right;
+    struct _pl_itree *tree; /* tree the node is linked in, NULL if none */
+    off_t start;
+    off_t end;
+    off_t max_end; /* largest end in the subtree rooted at this node */
+    int height;
+} pl_itree_node_t;
+
+typedef struct _pl_itree {
+    pl_itree_node_t *root;
+    uint32_t count;
+} pl_itree_t;
+
+/* Called for every node overlapping the searched range, in order of start.
+ * Returning non-zero stops the walk and is returned by pl_itree_walk().
+ * The callback must not modify the tree. */
+typedef int (*pl_itree_fn_t)(pl_itree_node_t *node, void *data);
+
+#define pl_itree_entry(ptr, type, member)                                      \
+    ((type *)((char *)(ptr) - (unsigned long)(&((type *)0)->member)))
+
+static inline void
+pl_itree_init(pl_itree_t *tree)
+{
+    tree->root = NULL;
+    tree->count = 0;
+}
+
+static inline void
+pl_itree_node_init(pl_itree_node_t *node)
+{
+    node->left = NULL;
+    node->right = NULL;
+    node->tree = NULL;
+}
+
+static inline uint32_t
+pl_itree_count(pl_itree_t *tree)
+{
+    return tree->count;
+}
+
+void
+pl_itree_insert(pl_itree_t *tree, pl_itree_node_t *node, off_t start,
+                off_t end);
+
+/* Unlinks the node from the tree it is in. Does nothing if it is not
+ * linked. */
+void
+pl_itree_remove(pl_itree_node_t *node);
+
+int
+pl_itree_walk(pl_itree_t *tree, off_t start, off_t end, pl_itree_fn_t fn,
+              void *data);
+
+#endif /* __PL_INTERVAL_TREE_H__ */
@@ -14,6 +14,7 @@
 #include <glusterfs/stack.h>
 #include <glusterfs/call-stub.h>
 #include "locks-mem-types.h"
+#include "interval-tree.h"
 #include <glusterfs/client_t.h>
 
 #include <glusterfs/lkowner.h>
@@ -29,6 +30,7 @@ struct __pl_fd;
 
 struct __posix_lock {
     struct list_head list;
+    pl_itree_node_t range; /* node in pl_inode->ext_tree while granted */
 
     off_t fl_start;
     off_t fl_end;
@@ -72,6 +74,8 @@ struct __pl_inode_lock {
     struct list_head list;
     struct list_head blocked_locks; /* list_head pointing to blocked_inodelks */
     struct list_head contend;       /* list of contending locks */
+    pl_itree_node_t range;          /* node in the granted or blocked tree */
+    struct list_head owner_list;    /* chain in the domain's owner table */
     int ref;
 
     off_t fl_start;
@@ -119,6 +123,10 @@ struct _pl_dom_list {
     struct list_head blocked_entrylks; /* List of all blocked entrylks */
     struct list_head inodelk_list;     /* List of inode locks */
     struct list_head blocked_inodelks; /* List of all blocked inodelks */
+    pl_itree_t inodelk_tree;           /* granted inodelks by range */
+    pl_itree_t blocked_inodelk_tree;   /* blocked inodelks by range */
+    struct list_head *inodelk_owners;  /* inodelks hashed by owner, only
+                                          built for busy domains */
 };
 typedef struct _pl_dom_list pl_dom_list_t;
 
@@ -161,6 +169,7 @@ struct __pl_inode {
 
     struct list_head dom_list;           /* list of domains */
     struct list_head ext_list;           /* list of fcntl locks */
+    pl_itree_t ext_tree;                 /* granted fcntl locks by range */
     struct list_head rw_list;            /* list of waiting r/w requests */
     struct list_head reservelk_list;     /* list of reservelks */
     struct list_head blocked_reservelks; /* list of blocked reservelks */
@@ -2071,11 +2071,39 @@ gf_boolean_t static within_range(posix_lock_t *existing, posix_lock_t *new)
     return _gf_false;
 }
 
+typedef struct {
+    posix_lock_t *region;
+    glusterfs_fop_t op;
+    mlk_mode_t mandatory_mode;
+} pl_rw_conflict_args_t;
+
+static int
+__rw_conflict_fn(pl_itree_node_t *node, void *data)
+{
+    pl_rw_conflict_args_t *args = data;
+    posix_lock_t *l = pl_itree_entry(node, posix_lock_t, range);
+
+    if (same_owner(l, args->region))
+        return 0;
+
+    if ((args->op == GF_FOP_READ) && (l->fl_type != F_WRLCK))
+        return 0;
+
+    /* Check for mandatory lock under optimal mandatory-locking mode */
+    if (args->mandatory_mode == MLK_OPTIMAL && !(l->lk_flags & GF_LK_MANDATORY))
+        return 0;
+
+    return 1;
+}
+
 static int
 __rw_allowable(pl_inode_t *pl_inode, posix_lock_t *region, glusterfs_fop_t op)
 {
     posix_lock_t *l = NULL;
     posix_locks_private_t *priv = THIS->private;
+    pl_rw_conflict_args_t args = {
+        0,
+    };
     int ret = 1;
 
     if (pl_inode->mlock_enforced) {
@@ -2119,20 +2147,13 @@ __rw_allowable(pl_inode_t *pl_inode, posix_lock_t *region, glusterfs_fop_t op)
         return 0;
     }
 
-    list_for_each_entry(l, &pl_inode->ext_list, list)
-    {
-        if (!l->blocked && locks_overlap(l, region) && !same_owner(l, region)) {
-            if ((op == GF_FOP_READ) && (l->fl_type != F_WRLCK))
-                continue;
-            /* Check for mandatory lock under optimal
-             * mandatory-locking mode */
-            if (priv->mandatory_mode == MLK_OPTIMAL &&
-                !(l->lk_flags & GF_LK_MANDATORY))
-                continue;
-            ret = 0;
-            break;
-        }
-    }
+    args.region = region;
+    args.op = op;
+    args.mandatory_mode = priv->mandatory_mode;
+
+    if (pl_itree_walk(&pl_inode->ext_tree, region->fl_start, region->fl_end,
+                      __rw_conflict_fn, &args))
+        ret = 0;
 
     return ret;
 }
@@ -2870,6 +2891,7 @@ pl_forget(xlator_t *this, inode_t *inode)
             list_del(&dom->inode_list);
             gf_log("posix-locks", GF_LOG_TRACE, " Cleaning up domain: %s",
                    dom->domain);
+            GF_FREE(dom->inodelk_owners);
             GF_FREE((char *)(dom->domain));
             GF_FREE(dom);
         }
@@ -3332,7 +3354,7 @@ __unwind_blocked_locks(pl_inode_t *pl_inode, struct list_head *tmp_list)
         if (!lock->blocking)
             continue;
 
-        list_del_init(&lock->list);
+        __delete_lock(lock);
         list_add_tail(&lock->list, tmp_list);
     }
 }
@@ -4244,6 +4266,8 @@ pl_write_active_locks(call_frame_t *frame, pl_inode_t *pl_inode,
                 goto out;
             }
             list_add_tail(&newlock->list, &pl_inode->ext_list);
+            pl_itree_insert(&pl_inode->ext_tree, &newlock->range,
+                            newlock->fl_start, newlock->fl_end);
         }
     }
     /*TODO: What if few lock add failed with ENOMEM. Should the already
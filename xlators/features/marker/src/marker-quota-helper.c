@@ -142,6 +142,7 @@ mq_alloc_inode_ctx()
     ctx->updation_status = _gf_false;
     LOCK_INIT(&ctx->lock);
     INIT_LIST_HEAD(&ctx->contribution_head);
+    INIT_LIST_HEAD(&ctx->pending_list);
 out:
     return ctx;
 }
@@ -144,6 +144,33 @@ out:
     return;
 }
 
+static void
+mq_set_ctx_pending_dirty(xlator_t *this, quota_inode_ctx_t *ctx,
+                         gf_boolean_t status)
+{
+    marker_conf_t *priv = this->private;
+
+    LOCK(&priv->lock);
+    {
+        ctx->pending_dirty = status;
+    }
+    UNLOCK(&priv->lock);
+}
+
+static void
+mq_get_ctx_pending_status(xlator_t *this, quota_inode_ctx_t *ctx,
+                          gf_boolean_t *pending, gf_boolean_t *pending_dirty)
+{
+    marker_conf_t *priv = this->private;
+
+    LOCK(&priv->lock);
+    {
+        *pending = ctx->pending;
+        *pending_dirty = ctx->pending_dirty;
+    }
+    UNLOCK(&priv->lock);
+}
+
 int
 mq_build_ancestry(xlator_t *this, loc_t *loc)
 {
@@ -1334,6 +1361,7 @@ mq_reduce_parent_size_task(void *opaque)
     xlator_t *this = NULL;
     loc_t *loc = NULL;
     gf_boolean_t remove_xattr = _gf_true;
+    gf_boolean_t failed = _gf_false;
     uint32_t nlink = 0;
 
     GF_ASSERT(opaque);
@@ -1427,9 +1455,13 @@ out:
              * Do the same if dir was dirty before
              * the txn
              */
+            failed = (ret < 0);
             ret = mq_inode_ctx_get(parent_loc.inode, this, &parent_ctx);
-            if (ret == 0)
+            if (ret == 0) {
                 mq_set_ctx_dirty_status(parent_ctx, _gf_false);
+                if (failed)
+                    mq_set_ctx_pending_dirty(this, parent_ctx, _gf_false);
+            }
         } else {
             ret = mq_mark_dirty(this, &parent_loc, 0);
         }
@@ -1488,6 +1520,99 @@ out:
     return ret;
 }
 
+static void
+mq_flush_timer_cbk(void *data)
+{
+    xlator_t *this = data;
+    marker_conf_t *priv = this->private;
+    gf_boolean_t flush = _gf_false;
+
+    LOCK(&priv->lock);
+    {
+        priv->flush_timer = NULL;
+        if (!priv->flushing && !list_empty(&priv->pending_list)) {
+            priv->flushing = _gf_true;
+            flush = _gf_true;
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (flush)
+        mq_flush_pending(this);
+}
+
+/* With quota-update-delay set, the update of a directory is not propagated
+ * to its ancestors by the txn which updated it. The directory is queued and
+ * its dirty xattr is left set, the updates of all the fops under it until
+ * the queue is flushed are then propagated by a single txn. The dirty xattr
+ * makes the lookup fix the directory and propagate it if the brick goes down
+ * in the meantime.
+ *
+ * Called with the inodelk on the directory held. Returns _gf_true if the
+ * caller must stop propagating and leave the directory dirty.
+ */
+static gf_boolean_t
+mq_defer_propagation(xlator_t *this, loc_t *loc, quota_meta_t *delta,
+                     int32_t prev_dirty)
+{
+    int32_t ret = -1;
+    marker_conf_t *priv = this->private;
+    quota_inode_ctx_t *ctx = NULL;
+    gf_boolean_t deferred = _gf_false;
+    gf_boolean_t flush = _gf_false;
+    struct timespec delay = {
+        0,
+    };
+
+    if (priv->quota_update_delay == 0 || __is_root_gfid(loc->gfid))
+        goto out;
+
+    ret = mq_inode_ctx_get(loc->inode, this, &ctx);
+    if (ret < 0)
+        goto out;
+
+    LOCK(&priv->lock);
+    {
+        /* The directory was already dirty and needs to be fixed by
+         * the lookup, don't take over its dirty flag
+         */
+        if (prev_dirty && !ctx->pending_dirty)
+            goto unlock;
+
+        ctx->pending_dirty = _gf_true;
+        mq_add_meta(&ctx->pending_delta, delta);
+        if (!ctx->pending) {
+            ctx->pending = _gf_true;
+            ctx->pending_inode = inode_ref(loc->inode);
+            list_add_tail(&ctx->pending_list, &priv->pending_list);
+            priv->nr_pending++;
+        }
+        deferred = _gf_true;
+
+        if (priv->flushing)
+            goto unlock;
+
+        if (priv->nr_pending >= priv->quota_update_batch ||
+            (priv->quota_update_threshold &&
+             (uint64_t)llabs(ctx->pending_delta.size) >=
+                 priv->quota_update_threshold)) {
+            priv->flushing = _gf_true;
+            flush = _gf_true;
+        } else if (!priv->flush_timer) {
+            delay.tv_sec = priv->quota_update_delay;
+            priv->flush_timer = gf_timer_call_after(this->ctx, delay,
+                                                    mq_flush_timer_cbk, this);
+        }
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (flush)
+        mq_flush_pending(this);
+out:
+    return deferred;
+}
+
 int
 mq_initiate_quota_task(void *opaque)
 {
@@ -1685,6 +1810,13 @@ mq_initiate_quota_task(void *opaque)
             goto out;
         }
 
+        if (mq_defer_propagation(this, &parent_loc, &delta, prev_dirty)) {
+            dirty = _gf_false;
+            ret = mq_lock(this, &parent_loc, F_UNLCK);
+            locked = _gf_false;
+            break;
+        }
+
         if (prev_dirty == 0) {
             ret = mq_mark_dirty(this, &parent_loc, 0);
         } else {
@@ -1723,8 +1855,10 @@ out:
              * txn
              */
             ret = mq_inode_ctx_get(parent_loc.inode, this, &parent_ctx);
-            if (ret == 0)
+            if (ret == 0) {
                 mq_set_ctx_dirty_status(parent_ctx, _gf_false);
+                mq_set_ctx_pending_dirty(this, parent_ctx, _gf_false);
+            }
         } else {
             ret = mq_mark_dirty(this, &parent_loc, 0);
         }
@@ -1810,6 +1944,163 @@ out:
     return ret;
 }
 
+static void
+mq_flush_pending_inode(xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx)
+{
+    int32_t ret = -1;
+    marker_conf_t *priv = this->private;
+    gf_boolean_t clean = _gf_false;
+    loc_t loc = {
+        0,
+    };
+
+    ret = mq_inode_loc_fill(NULL, inode, &loc);
+    if (ret < 0)
+        goto out;
+
+    mq_synctask(this, mq_initiate_quota_task, _gf_false, &loc);
+
+    /* Clear the dirty flag unless the directory was updated and
+     * queued again while its update was being propagated
+     */
+    ret = mq_lock(this, &loc, F_WRLCK);
+    if (ret < 0)
+        goto out;
+
+    LOCK(&priv->lock);
+    {
+        clean = !ctx->pending && ctx->pending_dirty;
+        if (clean)
+            ctx->pending_dirty = _gf_false;
+    }
+    UNLOCK(&priv->lock);
+
+    if (clean)
+        ret = mq_mark_dirty(this, &loc, 0);
+
+    mq_lock(this, &loc, F_UNLCK);
+
+out:
+    if (ret < 0) {
+        /* leave the directory to inspect_directory_xattr */
+        mq_set_ctx_pending_dirty(this, ctx, _gf_false);
+    }
+
+    loc_wipe(&loc);
+}
+
+static int
+mq_flush_pending_task(void *opaque)
+{
+    xlator_t *this = opaque;
+    marker_conf_t *priv = NULL;
+    quota_inode_ctx_t *ctx = NULL;
+    quota_inode_ctx_t *tmp = NULL;
+    inode_t *inode = NULL;
+    struct list_head batch;
+
+    THIS = this;
+    priv = this->private;
+
+    /* Directories queued while a batch is flushed, i.e. the parents of the
+     * batch, are flushed in the next round. Siblings are flushed in the
+     * same round, so the update of their parent is propagated once.
+     */
+    for (;;) {
+        INIT_LIST_HEAD(&batch);
+
+        LOCK(&priv->lock);
+        {
+            list_splice_init(&priv->pending_list, &batch);
+            priv->nr_pending = 0;
+            if (list_empty(&batch))
+                priv->flushing = _gf_false;
+        }
+        UNLOCK(&priv->lock);
+
+        if (list_empty(&batch))
+            break;
+
+        list_for_each_entry_safe(ctx, tmp, &batch, pending_list)
+        {
+            LOCK(&priv->lock);
+            {
+                list_del_init(&ctx->pending_list);
+                ctx->pending = _gf_false;
+                memset(&ctx->pending_delta, 0, sizeof(ctx->pending_delta));
+                inode = ctx->pending_inode;
+                ctx->pending_inode = NULL;
+            }
+            UNLOCK(&priv->lock);
+
+            mq_flush_pending_inode(this, inode, ctx);
+            inode_unref(inode);
+        }
+    }
+
+    return 0;
+}
+
+static int
+mq_flush_pending_done(int ret, call_frame_t *frame, void *opaque)
+{
+    return 0;
+}
+
+/* Called with priv->flushing set by the caller */
+void
+mq_flush_pending(xlator_t *this)
+{
+    int32_t ret = -1;
+    marker_conf_t *priv = this->private;
+
+    ret = synctask_new(this->ctx->env, mq_flush_pending_task,
+                       mq_flush_pending_done, NULL, this);
+    if (ret) {
+        gf_log(this->name, GF_LOG_ERROR,
+               "Failed to spawn synctask to propagate delayed updates");
+        LOCK(&priv->lock);
+        {
+            priv->flushing = _gf_false;
+        }
+        UNLOCK(&priv->lock);
+    }
+}
+
+void
+mq_pending_cleanup(xlator_t *this)
+{
+    marker_conf_t *priv = this->private;
+    quota_inode_ctx_t *ctx = NULL;
+    quota_inode_ctx_t *tmp = NULL;
+    struct list_head pending;
+
+    INIT_LIST_HEAD(&pending);
+
+    /* The directories are left dirty on disk, they are fixed and their
+     * updates propagated on their next lookup
+     */
+    LOCK(&priv->lock);
+    {
+        if (priv->flush_timer) {
+            gf_timer_call_cancel(this->ctx, priv->flush_timer);
+            priv->flush_timer = NULL;
+        }
+        list_splice_init(&priv->pending_list, &pending);
+        priv->nr_pending = 0;
+    }
+    UNLOCK(&priv->lock);
+
+    list_for_each_entry_safe(ctx, tmp, &pending, pending_list)
+    {
+        list_del_init(&ctx->pending_list);
+        ctx->pending = _gf_false;
+        ctx->pending_dirty = _gf_false;
+        inode_unref(ctx->pending_inode);
+        ctx->pending_inode = NULL;
+    }
+}
+
 int
 mq_update_dirty_inode_task(void *opaque)
 {
@@ -1992,7 +2283,10 @@ out:
     if (locked)
         mq_lock(this, loc, F_UNLCK);
 
-    if (updated)
+    /* The directory may also be dirty because the propagation of its
+     * update was delayed, see mq_defer_propagation()
+     */
+    if (updated || (ret >= 0 && dirty))
         mq_initiate_quota_blocking_txn(this, loc, NULL);
 
     return ret;
@@ -2043,6 +2337,8 @@ mq_inspect_directory_xattr(xlator_t *this, quota_inode_ctx_t *ctx,
     };
     int keylen = 0;
     gf_boolean_t status = _gf_false;
+    gf_boolean_t pending = _gf_false;
+    gf_boolean_t pending_dirty = _gf_false;
 
     ret = dict_get_int8(dict, QUOTA_DIRTY_KEY, &dirty);
     if (ret < 0) {
@@ -2104,12 +2400,18 @@ mq_inspect_directory_xattr(xlator_t *this, quota_inode_ctx_t *ctx,
 
     mq_compute_delta(&delta, &size, &contri);
 
+    /* Updates queued for delayed propagation are propagated when the
+     * queue is flushed
+     */
+    mq_get_ctx_pending_status(this, ctx, &pending, &pending_dirty);
+
     if (dirty) {
-        ret = mq_update_dirty_inode_txn(this, loc, ctx);
+        if (!pending_dirty)
+            ret = mq_update_dirty_inode_txn(this, loc, ctx);
         goto out;
     }
 
-    if (!loc_is_root(loc) && !quota_meta_is_null(&delta))
+    if (!loc_is_root(loc) && !quota_meta_is_null(&delta) && !pending)
         mq_initiate_quota_txn(this, loc, NULL);
 
     ret = 0;
@@ -92,6 +92,15 @@ struct quota_inode_ctx {
     gf_boolean_t dirty_status;
     gf_lock_t lock;
     struct list_head contribution_head;
+    /* Delayed update of the ancestors, protected by marker_conf->lock.
+     * pending_dirty is set when the dirty xattr of the directory is only
+     * left set until its update is propagated to its parent.
+     */
+    gf_boolean_t pending;
+    gf_boolean_t pending_dirty;
+    quota_meta_t pending_delta;
+    inode_t *pending_inode;
+    struct list_head pending_list;
 };
 typedef struct quota_inode_ctx quota_inode_ctx_t;
 
@@ -137,4 +146,10 @@ mq_reduce_parent_size_txn(xlator_t *, loc_t *, quota_meta_t *, uint32_t nlink,
 
 int32_t
 mq_forget(xlator_t *, quota_inode_ctx_t *);
+
+void
+mq_flush_pending(xlator_t *this);
+
+void
+mq_pending_cleanup(xlator_t *this);
 #endif
@@ -3294,6 +3294,8 @@ marker_priv_cleanup(xlator_t *this)
 
     marker_xtime_priv_cleanup(this);
 
+    mq_pending_cleanup(this);
+
     LOCK_DESTROY(&priv->lock);
 
     GF_FREE(priv);
@@ -3315,6 +3317,7 @@ reconfigure(xlator_t *this, dict_t *options)
     gf_boolean_t flag = _gf_false;
     marker_conf_t *priv = NULL;
     int32_t version = 0;
+    gf_boolean_t flush = _gf_false;
 
     GF_ASSERT(this);
     GF_ASSERT(this->private);
@@ -3353,6 +3356,29 @@ reconfigure(xlator_t *this, dict_t *options)
                    priv->version);
     }
 
+    ret = -1;
+    GF_OPTION_RECONF("quota-update-delay", priv->quota_update_delay, options,
+                     time, out);
+    GF_OPTION_RECONF("quota-update-batch", priv->quota_update_batch, options,
+                     uint32, out);
+    GF_OPTION_RECONF("quota-update-threshold", priv->quota_update_threshold,
+                     options, size_uint64, out);
+    ret = 0;
+
+    /* Propagate the updates delayed so far if the delay was turned off */
+    if (priv->quota_update_delay == 0) {
+        LOCK(&priv->lock);
+        {
+            flush = !priv->flushing && !list_empty(&priv->pending_list);
+            if (flush)
+                priv->flushing = _gf_true;
+        }
+        UNLOCK(&priv->lock);
+
+        if (flush)
+            mq_flush_pending(this);
+    }
+
     data = dict_get(options, "xtime");
     if (data) {
         ret = gf_string2boolean(data->data, &flag);
@@ -3409,6 +3435,13 @@ init(xlator_t *this)
     priv->version = 0;
 
     LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->pending_list);
+
+    GF_OPTION_INIT("quota-update-delay", priv->quota_update_delay, time, err);
+    GF_OPTION_INIT("quota-update-batch", priv->quota_update_batch, uint32,
+                   err);
+    GF_OPTION_INIT("quota-update-threshold", priv->quota_update_threshold,
+                   size_uint64, err);
 
     data = dict_get(options, "quota");
     if (data) {
@@ -3552,6 +3585,46 @@ struct volume_options options[] = {
         .key = {"quota-version"},
         .flags = OPT_FLAG_NONE,
     },
+    {
+        .key = {"quota-update-delay"},
+        .type = GF_OPTION_TYPE_TIME,
+        .min = 0,
+        .max = 300,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .tags = {"quota"},
+        .description = "Seconds by which the update of the ancestors of a "
+                       "directory is delayed, so that the updates of the fops "
+                       "under it are propagated together. 0 propagates every "
+                       "update right away.",
+    },
+    {
+        .key = {"quota-update-batch"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 65536,
+        .default_value = "1024",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .tags = {"quota"},
+        .description = "Number of directories with delayed updates after "
+                       "which the updates are propagated without waiting for "
+                       "quota-update-delay.",
+    },
+    {
+        .key = {"quota-update-threshold"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 1 * GF_UNIT_TB,
+        .default_value = "64MB",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+        .tags = {"quota"},
+        .description = "Change in the size of a directory after which its "
+                       "delayed updates are propagated without waiting for "
+                       "quota-update-delay. 0 for no limit.",
+    },
     {.key = {NULL}}};
 
 xlator_api_t xlator_api = {
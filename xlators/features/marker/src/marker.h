@@ -15,6 +15,7 @@
 #include <glusterfs/defaults.h>
 #include <glusterfs/compat-uuid.h>
 #include <glusterfs/call-stub.h>
+#include <glusterfs/timer.h>
 
 #define MARKER_XATTR_PREFIX "trusted.glusterfs"
 #define XTIME "xtime"
@@ -142,6 +143,13 @@ struct marker_conf {
     uint64_t quota_lk_owner;
     gf_lock_t lock;
     int32_t version;
+    uint32_t quota_update_delay;
+    uint32_t quota_update_batch;
+    uint64_t quota_update_threshold;
+    struct list_head pending_list; /* dirs whose parent update is delayed */
+    uint32_t nr_pending;
+    gf_boolean_t flushing;
+    gf_timer_t *flush_timer;
 };
 typedef struct marker_conf marker_conf_t;
 
@@ -590,6 +590,8 @@ quota_validate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     struct timeval tv = {
         0,
     };
+    int64_t lease = 0;
+    gf_boolean_t leased = _gf_false;
 
     local = frame->local;
 
@@ -623,6 +625,12 @@ quota_validate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         op_errno = EINVAL;
     }
 
+    /* quotad not reserving space is not an error, the limit is then
+     * checked against the size
+     */
+    if (dict_get_int64(xdata, QUOTA_LEASE_GRANTED_KEY, &lease) == 0)
+        leased = _gf_true;
+
     local->just_validated = 1; /* so that we don't go into infinite
                                 * loop of validation and checking
                                 * limit when timeout is zero.
@@ -634,6 +642,10 @@ quota_validate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         ctx->file_count = size.file_count;
         ctx->dir_count = size.dir_count;
         memcpy(&ctx->tv, &tv, sizeof(struct timeval));
+
+        ctx->leased = leased;
+        ctx->lease = lease;
+        memcpy(&ctx->lease_tv, &tv, sizeof(struct timeval));
     }
     UNLOCK(&ctx->lock);
 
@@ -645,6 +657,14 @@ unwind:
     return 0;
 }
 
+/* The lease was reserved under the previous limit */
+static void
+__quota_lease_drop(quota_inode_ctx_t *ctx)
+{
+    ctx->leased = _gf_false;
+    ctx->lease = 0;
+}
+
 static uint64_t
 quota_time_elapsed(struct timeval *now, struct timeval *then)
 {
@@ -967,6 +987,53 @@ err:
     return 0;
 }
 
+/* Space reservation: along with the cluster wide size of the directory,
+ * quotad is asked to reserve part of what is left under its limit for this
+ * brick. The lease is spent by quota_check_size_limit() without going to
+ * quotad, until it is used up or expires. The next request replaces it,
+ * which gives its unspent part back to quotad.
+ */
+static int
+quota_lease_request_set(xlator_t *this, call_frame_t *frame, dict_t *xdata)
+{
+    int ret = -1;
+    quota_priv_t *priv = NULL;
+    quota_local_t *local = NULL;
+    quota_local_t *par_local = NULL;
+    int64_t request = 0;
+
+    priv = this->private;
+    local = frame->local;
+
+    if (local->par_frame)
+        par_local = local->par_frame->local;
+    else
+        par_local = local;
+
+    /* enough for the fop being checked on top of the lease size */
+    request = priv->lease_size;
+    if (par_local && par_local->delta > 0)
+        request += par_local->delta;
+
+    ret = dict_set_int64(xdata, QUOTA_LEASE_REQUEST_KEY, request);
+    if (ret < 0)
+        goto out;
+
+    ret = dict_set_dynstr_with_alloc(xdata, QUOTA_LEASE_OWNER_KEY,
+                                     uuid_utoa(priv->lease_owner));
+    if (ret < 0)
+        goto out;
+
+    ret = dict_set_uint32(xdata, QUOTA_LEASE_TIMEOUT_KEY, priv->lease_timeout);
+    if (ret < 0)
+        goto out;
+
+    /* quotad needs the limit to reserve space under it */
+    ret = dict_set_int8(xdata, QUOTA_LIMIT_KEY, 1);
+out:
+    return ret;
+}
+
 int
 quota_validate(call_frame_t *frame, inode_t *inode, xlator_t *this,
                fop_lookup_cbk_t cbk_fn)
@@ -1020,6 +1087,16 @@ quota_validate(call_frame_t *frame, inode_t *inode, xlator_t *this,
         goto err;
     }
 
+    if (priv->lease_size > 0) {
+        ret = quota_lease_request_set(this, frame, xdata);
+        if (ret < 0) {
+            gf_msg(this->name, GF_LOG_WARNING, ENOMEM, Q_MSG_ENOMEM,
+                   "dict set failed");
+            ret = -ENOMEM;
+            goto err;
+        }
+    }
+
     ret = quota_enforcer_lookup(frame, this, xdata, cbk_fn);
     if (ret < 0) {
         ret = -ENOTCONN;
@@ -1176,7 +1253,9 @@ quota_check_size_limit(call_frame_t *frame, quota_inode_ctx_t *ctx,
     uint32_t timeout = 0;
     char need_validate = 0;
     gf_boolean_t hard_limit_exceeded = 0;
+    gf_boolean_t leased = _gf_false;
     int64_t space_available = 0;
+    int64_t lease_available = -1;
     int64_t wouldbe_size = 0;
 
     GF_ASSERT(frame);
@@ -1196,12 +1275,38 @@ quota_check_size_limit(call_frame_t *frame, quota_inode_ctx_t *ctx,
                 timeout = priv->hard_timeout;
             }
 
+            if ((priv->lease_size > 0) && (ctx->hard_lim > 0) && (delta > 0)) {
+                leased = ctx->leased &&
+                         !quota_timeout(&ctx->lease_tv, priv->lease_timeout);
+                if (leased && (ctx->lease >= delta)) {
+                    ctx->lease -= delta;
+                    goto unlock;
+                }
+
+                if (!just_validated) {
+                    /* used up or expired, get a new lease */
+                    need_validate = 1;
+                    goto unlock;
+                }
+
+                if (leased) {
+                    /* quotad could not reserve space for the
+                     * whole fop
+                     */
+                    hard_limit_exceeded = 1;
+                    lease_available = ctx->lease;
+                    ctx->lease = 0;
+                    goto unlock;
+                }
+            }
+
             if (!just_validated && quota_timeout(&ctx->tv, timeout)) {
                 need_validate = 1;
             } else if (wouldbe_size >= ctx->hard_lim) {
                 hard_limit_exceeded = 1;
             }
         }
+    unlock:
         UNLOCK(&ctx->lock);
 
         if (need_validate && *skip_check != _gf_true) {
@@ -1218,7 +1323,10 @@ quota_check_size_limit(call_frame_t *frame, quota_inode_ctx_t *ctx,
             local->op_ret = -1;
             local->op_errno = EDQUOT;
 
-            space_available = ctx->hard_lim - ctx->size;
+            if (lease_available >= 0)
+                space_available = lease_available;
+            else
+                space_available = ctx->hard_lim - ctx->size;
 
             if (space_available < 0)
                 space_available = 0;
@@ -1532,6 +1640,8 @@ quota_fill_inodectx(xlator_t *this, inode_t *inode, dict_t *dict, loc_t *loc,
 
     LOCK(&ctx->lock);
     {
+        if (ctx->hard_lim != hard_lim)
+            __quota_lease_drop(ctx);
         ctx->hard_lim = hard_lim;
         ctx->soft_lim = soft_lim;
         ctx->object_hard_lim = object_hard_limit;
@@ -3942,6 +4052,8 @@ quota_setxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
     LOCK(&ctx->lock);
     {
+        if (ctx->hard_lim != local->limit.hl)
+            __quota_lease_drop(ctx);
         ctx->hard_lim = local->limit.hl;
         ctx->soft_lim = local->limit.sl;
         ctx->object_hard_lim = local->object_limit.hl;
@@ -4043,6 +4155,8 @@ quota_fsetxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
     LOCK(&ctx->lock);
     {
+        if (ctx->hard_lim != local->limit.hl)
+            __quota_lease_drop(ctx);
         ctx->hard_lim = local->limit.hl;
         ctx->soft_lim = local->limit.sl;
         ctx->object_hard_lim = local->object_limit.hl;
@@ -5042,6 +5156,10 @@ init(xlator_t *this)
     GF_OPTION_INIT("hard-timeout", priv->hard_timeout, time, err);
     GF_OPTION_INIT("alert-time", priv->log_timeout, time, err);
     GF_OPTION_INIT("volume-uuid", priv->volume_uuid, str, err);
+    GF_OPTION_INIT("lease-size", priv->lease_size, size_uint64, err);
+    GF_OPTION_INIT("lease-timeout", priv->lease_timeout, time, err);
+
+    gf_uuid_generate(priv->lease_owner);
 
     this->local_pool = mem_pool_new(quota_local_t, 64);
     if (!this->local_pool) {
@@ -5090,6 +5208,9 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("alert-time", priv->log_timeout, options, time, out);
     GF_OPTION_RECONF("soft-timeout", priv->soft_timeout, options, time, out);
     GF_OPTION_RECONF("hard-timeout", priv->hard_timeout, options, time, out);
+    GF_OPTION_RECONF("lease-size", priv->lease_size, options, size_uint64,
+                     out);
+    GF_OPTION_RECONF("lease-timeout", priv->lease_timeout, options, time, out);
 
     if (quota_on) {
         priv->rpc_clnt = quota_enforcer_init(this, this->options);
@@ -5152,6 +5273,8 @@ quota_priv_dump(xlator_t *this)
         gf_proc_dump_write("volume-uuid", "%s", priv->volume_uuid);
         gf_proc_dump_write("validation-count", "%" PRIu64,
                            priv->validation_count);
+        gf_proc_dump_write("lease-size", "%" PRIu64, priv->lease_size);
+        gf_proc_dump_write("lease-timeout", "%u", priv->lease_timeout);
     }
     UNLOCK(&priv->lock);
 
@@ -5304,6 +5427,32 @@ struct volume_options options[] = {
         .description = "Frequency of limit breach messages in log.",
         .tags = {},
     },
+    {
+        .key = {"lease-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 1 * GF_UNIT_TB,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Space reserved from quotad at a time for the writes "
+                       "under a directory with a limit. Writes spend the "
+                       "reservation without checking the limit with quotad. "
+                       "0 disables space reservation.",
+        .tags = {},
+    },
+    {
+        .key = {"lease-timeout"},
+        .type = GF_OPTION_TYPE_TIME,
+        .min = 1,
+        .max = 300,
+        .default_value = "10",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Time after which the unspent part of a space "
+                       "reservation is given back to quotad.",
+        .tags = {},
+    },
     {.key = {NULL}}};
 
 xlator_api_t xlator_api = {
@@ -34,6 +34,12 @@
 #define VAL_LENGTH 8
 #define READDIR_BUF 4096
 
+/* Space reservation, sent along with the validation lookups to quotad */
+#define QUOTA_LEASE_REQUEST_KEY "quota-lease-request"
+#define QUOTA_LEASE_OWNER_KEY "quota-lease-owner"
+#define QUOTA_LEASE_TIMEOUT_KEY "quota-lease-timeout"
+#define QUOTA_LEASE_GRANTED_KEY "quota-lease-granted"
+
 #ifndef UUID_CANONICAL_FORM_LEN
 #define UUID_CANONICAL_FORM_LEN 36
 #endif
@@ -157,6 +163,9 @@ struct quota_inode_ctx {
     struct timeval prev_log;
     gf_boolean_t ancestry_built;
     gf_lock_t lock;
+    int64_t lease;           /* bytes reserved by quotad left to spend */
+    struct timeval lease_tv; /* when the lease was granted */
+    gf_boolean_t leased;
 };
 typedef struct quota_inode_ctx quota_inode_ctx_t;
 
@@ -214,6 +223,10 @@ struct quota_priv {
     char *volume_uuid;
     uint64_t validation_count;
     int32_t quotad_conn_status;
+    uint64_t lease_size;
+    uint32_t lease_timeout;
+    uuid_t lease_owner;
+    struct list_head *leases; /* quotad: leases granted to the bricks */
 };
 typedef struct quota_priv quota_priv_t;
 
@@ -317,6 +317,7 @@ quotad_aggregator_lookup(rpcsvc_request_t *req)
     xlator_t *this = NULL;
     dict_t *dict = NULL;
     char *volume_uuid = NULL;
+    char *lease_owner = NULL;
 
     GF_VALIDATE_OR_GOTO("quotad-aggregator", req, err);
 
@@ -357,6 +358,16 @@ quotad_aggregator_lookup(rpcsvc_request_t *req)
         }
     }
 
+    /* Space reservation asked by the enforcer, see qd_lease_grant() */
+    if (dict_get_int64(dict, QUOTA_LEASE_REQUEST_KEY, &state->lease_request) ==
+        0) {
+        if ((dict_get_str(dict, QUOTA_LEASE_OWNER_KEY, &lease_owner) < 0) ||
+            (gf_uuid_parse(lease_owner, state->lease_owner) < 0) ||
+            (dict_get_uint32(dict, QUOTA_LEASE_TIMEOUT_KEY,
+                             &state->lease_timeout) < 0))
+            state->lease_request = 0;
+    }
+
     ret = qd_nameless_lookup(this, frame, args.gfid, state->xdata, volume_uuid,
                              quotad_aggregator_lookup_cbk);
     if (ret) {
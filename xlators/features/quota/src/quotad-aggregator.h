@@ -24,8 +24,26 @@ typedef struct {
     loc_t loc;
     dict_t *xdata;
     dict_t *req_xdata;
+    xlator_t *subvol;
+    int64_t lease_request;
+    uint32_t lease_timeout;
+    uuid_t lease_owner;
 } quotad_aggregator_state_t;
 
+#define QD_LEASE_TABLE_SIZE 1024
+#define QD_LEASE_GRACE 2 /* seconds a lease is kept after it expired on
+                          * the brick */
+
+/* Space reserved under a directory for the enforcer of a brick */
+typedef struct {
+    struct list_head list;
+    xlator_t *subvol;
+    uuid_t gfid;
+    uuid_t owner;
+    int64_t granted;
+    time_t expiry;
+} qd_lease_t;
+
 typedef int (*quotad_aggregator_lookup_cbk_t)(xlator_t *this,
                                               call_frame_t *frame, void *rsp);
 int
@@ -42,17 +42,120 @@ mem_acct_init(xlator_t *this)
     return ret;
 }
 
+/* Reserve up to the requested bytes of what is left under the limit of the
+ * directory for the enforcer of a brick. The size aggregated by the lookup
+ * does not include the unspent part of the leases of the other bricks, so
+ * they are taken out of what is left. The previous lease of the brick is
+ * replaced by the new one, which returns its unspent part.
+ */
+static void
+qd_lease_grant(xlator_t *this, quotad_aggregator_state_t *state, uuid_t gfid,
+               dict_t *xdata)
+{
+    int32_t ret = -1;
+    quota_priv_t *priv = NULL;
+    quota_limits_t *limit = NULL;
+    quota_meta_t size = {
+        0,
+    };
+    qd_lease_t *lease = NULL;
+    qd_lease_t *tmp = NULL;
+    qd_lease_t *own = NULL;
+    struct list_head *bucket = NULL;
+    int64_t available = 0;
+    int64_t granted = 0;
+    time_t now = 0;
+
+    priv = this->private;
+
+    if (xdata == NULL || priv->leases == NULL)
+        goto out;
+
+    ret = dict_get_bin(xdata, QUOTA_LIMIT_KEY, (void **)&limit);
+    if (ret < 0 || limit == NULL || (int64_t)ntoh64(limit->hl) <= 0)
+        goto out;
+
+    ret = quota_dict_get_meta(xdata, QUOTA_SIZE_KEY, SLEN(QUOTA_SIZE_KEY),
+                              &size);
+    if (ret < 0)
+        goto out;
+
+    available = (int64_t)ntoh64(limit->hl) - size.size;
+    bucket = &priv->leases[((gfid[14] << 8) | gfid[15]) % QD_LEASE_TABLE_SIZE];
+    now = time(NULL);
+
+    LOCK(&priv->lock);
+    {
+        list_for_each_entry_safe(lease, tmp, bucket, list)
+        {
+            if (lease->expiry <= now) {
+                list_del_init(&lease->list);
+                GF_FREE(lease);
+                continue;
+            }
+
+            if ((lease->subvol != state->subvol) ||
+                gf_uuid_compare(lease->gfid, gfid))
+                continue;
+
+            if (gf_uuid_compare(lease->owner, state->lease_owner) == 0)
+                own = lease;
+            else
+                available -= lease->granted;
+        }
+
+        granted = min(max(available, 0), state->lease_request);
+        if (granted == 0) {
+            if (own) {
+                list_del_init(&own->list);
+                GF_FREE(own);
+            }
+            goto unlock;
+        }
+
+        if (own == NULL) {
+            own = GF_CALLOC(1, sizeof(*own), gf_quota_mt_qd_lease_t);
+            if (own == NULL) {
+                granted = 0;
+                goto unlock;
+            }
+            INIT_LIST_HEAD(&own->list);
+            own->subvol = state->subvol;
+            gf_uuid_copy(own->gfid, gfid);
+            gf_uuid_copy(own->owner, state->lease_owner);
+            list_add_tail(&own->list, bucket);
+        }
+
+        own->granted = granted;
+        own->expiry = now + state->lease_timeout + QD_LEASE_GRACE;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    ret = dict_set_int64(xdata, QUOTA_LEASE_GRANTED_KEY, granted);
+    if (ret < 0)
+        gf_msg(this->name, GF_LOG_WARNING, ENOMEM, Q_MSG_ENOMEM,
+               "dict set failed");
+out:
+    return;
+}
+
 int32_t
 qd_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
               int32_t op_errno, inode_t *inode, struct iatt *buf, dict_t *xdata,
               struct iatt *postparent)
 {
     quotad_aggregator_lookup_cbk_t lookup_cbk = NULL;
+    quotad_aggregator_state_t *state = NULL;
     gfs3_lookup_rsp rsp = {
         0,
     };
 
     lookup_cbk = cookie;
+    state = frame->root->state;
+
+    if (op_ret == 0 && state->lease_request > 0)
+        qd_lease_grant(this, state, buf->ia_gfid, xdata);
 
     rsp.op_ret = op_ret;
     rsp.op_errno = op_errno;
@@ -142,6 +245,7 @@ qd_nameless_lookup(xlator_t *this, call_frame_t *frame, char *gfid,
         op_errno = EINVAL;
         goto out;
     }
+    state->subvol = subvol;
 
     STACK_WIND_COOKIE(frame, qd_lookup_cbk, lookup_cbk, subvol,
                       subvol->fops->lookup, &loc, xdata);
@@ -168,6 +272,9 @@ void
 qd_fini(xlator_t *this)
 {
     quota_priv_t *priv = NULL;
+    qd_lease_t *lease = NULL;
+    qd_lease_t *tmp = NULL;
+    int i = 0;
 
     if (this == NULL || this->private == NULL)
         goto out;
@@ -179,6 +286,17 @@ qd_fini(xlator_t *this)
         priv->rpcsvc = NULL;
     }
 
+    if (priv->leases) {
+        for (i = 0; i < QD_LEASE_TABLE_SIZE; i++) {
+            list_for_each_entry_safe(lease, tmp, &priv->leases[i], list)
+            {
+                list_del_init(&lease->list);
+                GF_FREE(lease);
+            }
+        }
+        GF_FREE(priv->leases);
+    }
+
     GF_FREE(priv);
 
 out:
@@ -190,6 +308,7 @@ qd_init(xlator_t *this)
 {
     int32_t ret = -1;
     quota_priv_t *priv = NULL;
+    int i = 0;
 
     if (NULL == this->children) {
         gf_log(this->name, GF_LOG_ERROR,
@@ -202,6 +321,15 @@ qd_init(xlator_t *this)
     QUOTA_ALLOC_OR_GOTO(priv, quota_priv_t, err);
     LOCK_INIT(&priv->lock);
 
+    priv->leases = GF_CALLOC(QD_LEASE_TABLE_SIZE, sizeof(struct list_head),
+                             gf_quota_mt_qd_lease_t);
+    if (priv->leases == NULL) {
+        ret = -1;
+        goto err;
+    }
+    for (i = 0; i < QD_LEASE_TABLE_SIZE; i++)
+        INIT_LIST_HEAD(&priv->leases[i]);
+
     this->private = priv;
 
     ret = 0;
@@ -79,6 +79,7 @@ __shard_inode_ctx_get(inode_t *inode, xlator_t *this, shard_inode_ctx_t **ctx)
 
     INIT_LIST_HEAD(&ctx_p->ilist);
     INIT_LIST_HEAD(&ctx_p->to_fsync_list);
+    INIT_LIST_HEAD(&ctx_p->size_dirty_list);
 
     ctx_uint = (uint64_t)(uintptr_t)ctx_p;
     ret = __inode_ctx_set(inode, this, &ctx_uint);
@@ -495,6 +496,150 @@ shard_inode_ctx_fill_iatt_from_cache(inode_t *inode, xlator_t *this,
     return ret;
 }
 
+int
+shard_inode_ctx_get_pending_size(inode_t *inode, xlator_t *this,
+                                 int64_t *size, int64_t *blocks)
+{
+    int ret = -1;
+    uint64_t ctx_uint = 0;
+    shard_inode_ctx_t *ctx = NULL;
+
+    LOCK(&inode->lock);
+    {
+        ret = __inode_ctx_get(inode, this, &ctx_uint);
+        if (ret == 0) {
+            ctx = (shard_inode_ctx_t *)(uintptr_t)ctx_uint;
+            *size = ctx->pending_size;
+            *blocks = ctx->pending_blocks;
+        }
+    }
+    UNLOCK(&inode->lock);
+
+    return ret;
+}
+
+gf_boolean_t
+shard_inode_ctx_has_pending_size(inode_t *inode, xlator_t *this)
+{
+    int64_t size = 0;
+    int64_t blocks = 0;
+
+    if (shard_inode_ctx_get_pending_size(inode, this, &size, &blocks))
+        return _gf_false;
+
+    return (size != 0) || (blocks != 0);
+}
+
+/* Detaches the deferred size/block-count deltas from the inode ctx so that
+ * the caller can send them out along with its own xattrop. If the xattrop
+ * fails, they are handed back through shard_inode_ctx_restore_pending_size().
+ */
+static void
+shard_inode_ctx_take_pending_size(inode_t *inode, xlator_t *this,
+                                  int64_t *size, int64_t *blocks)
+{
+    shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+    inode_t *unref_inode = NULL;
+
+    priv = this->private;
+    *size = 0;
+    *blocks = 0;
+
+    /* Keep priv->lock off the write-through path. */
+    if (!shard_inode_ctx_has_pending_size(inode, this))
+        return;
+
+    LOCK(&priv->lock);
+    LOCK(&inode->lock);
+    {
+        if (__shard_inode_ctx_get(inode, this, &ctx))
+            goto unlock;
+        *size = ctx->pending_size;
+        *blocks = ctx->pending_blocks;
+        ctx->pending_size = 0;
+        ctx->pending_blocks = 0;
+        ctx->pending_count = 0;
+        if (!list_empty(&ctx->size_dirty_list)) {
+            list_del_init(&ctx->size_dirty_list);
+            unref_inode = ctx->size_dirty_inode;
+            ctx->size_dirty_inode = NULL;
+        }
+    }
+unlock:
+    UNLOCK(&inode->lock);
+    UNLOCK(&priv->lock);
+
+    if (unref_inode)
+        inode_unref(unref_inode);
+}
+
+static void
+shard_size_update_timer_cbk(void *data);
+
+/* Must be called with priv->lock and inode->lock held. @ref is a reference
+ * on @inode obtained by the caller without the locks held, which is either
+ * consumed by the dirty list or returned back through @ref for the caller to
+ * drop.
+ */
+static void
+__shard_inode_ctx_add_pending_size(xlator_t *this, inode_t *inode,
+                                   shard_inode_ctx_t *ctx, int64_t size,
+                                   int64_t blocks, inode_t **ref)
+{
+    shard_priv_t *priv = NULL;
+    struct timespec delay = {
+        0,
+    };
+
+    priv = this->private;
+
+    ctx->pending_size += size;
+    ctx->pending_blocks += blocks;
+    ctx->pending_count++;
+
+    if (list_empty(&ctx->size_dirty_list)) {
+        list_add_tail(&ctx->size_dirty_list, &priv->size_dirty_list);
+        ctx->size_dirty_inode = *ref;
+        *ref = NULL;
+    }
+
+    if (!priv->size_update_timer) {
+        delay.tv_sec = priv->size_update_interval;
+        priv->size_update_timer = gf_timer_call_after(
+            this->ctx, delay, shard_size_update_timer_cbk, this);
+    }
+}
+
+static void
+shard_inode_ctx_restore_pending_size(xlator_t *this, inode_t *inode,
+                                     int64_t size, int64_t blocks)
+{
+    shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+    inode_t *ref = NULL;
+
+    if (!size && !blocks)
+        return;
+
+    priv = this->private;
+    ref = inode_ref(inode);
+
+    LOCK(&priv->lock);
+    LOCK(&inode->lock);
+    {
+        if (__shard_inode_ctx_get(inode, this, &ctx) == 0)
+            __shard_inode_ctx_add_pending_size(this, inode, ctx, size, blocks,
+                                               &ref);
+    }
+    UNLOCK(&inode->lock);
+    UNLOCK(&priv->lock);
+
+    if (ref)
+        inode_unref(ref);
+}
+
+
 void
 shard_local_wipe(shard_local_t *local)
 {
@@ -545,11 +690,14 @@ shard_local_wipe(shard_local_t *local)
 }
 
 int
-shard_modify_size_and_block_count(struct iatt *stbuf, dict_t *dict)
+shard_modify_size_and_block_count(struct iatt *stbuf, dict_t *dict,
+                                  inode_t *inode)
 {
     int ret = -1;
     void *size_attr = NULL;
     uint64_t size_array[4];
+    int64_t pending_size = 0;
+    int64_t pending_blocks = 0;
 
     ret = dict_get_ptr(dict, GF_XATTR_SHARD_FILE_SIZE, &size_attr);
     if (ret) {
@@ -566,6 +714,14 @@ shard_modify_size_and_block_count(struct iatt *stbuf, dict_t *dict)
     stbuf->ia_size = ntoh64(size_array[0]);
     stbuf->ia_blocks = ntoh64(size_array[2]);
 
+    /* Account for the deltas this client is yet to write back. */
+    if (inode &&
+        !shard_inode_ctx_get_pending_size(inode, THIS, &pending_size,
+                                          &pending_blocks)) {
+        stbuf->ia_size += pending_size;
+        stbuf->ia_blocks += pending_blocks;
+    }
+
     return 0;
 }
 
@@ -652,6 +808,106 @@ out:
     return ret;
 }
 
+/* The per-file shard inode cache and the cached flag of the shards are
+ * protected by priv->lock. Every cached shard is also on the lru list, which
+ * holds a ref on its base inode, so the cache of a base inode is always empty
+ * by the time the base inode is forgotten.
+ */
+static inode_t *
+__shard_inode_cache_get(shard_inode_ctx_t *base_ctx, int block_num)
+{
+    shard_cached_inode_t *slot = NULL;
+
+    if (!base_ctx->shard_cache_size)
+        return NULL;
+
+    slot = &base_ctx->shard_cache[block_num % base_ctx->shard_cache_size];
+    if (!slot->inode || (slot->block_num != block_num))
+        return NULL;
+
+    return inode_ref(slot->inode);
+}
+
+/* Returns the inode whose cache slot was released, if any. The caller owns
+ * the ref that the cache held on it.
+ */
+static inode_t *
+__shard_inode_cache_del(xlator_t *this, shard_inode_ctx_t *base_ctx,
+                        shard_inode_ctx_t *ctx, inode_t *inode)
+{
+    shard_cached_inode_t *slot = NULL;
+
+    if (!ctx->cached || !base_ctx->shard_cache_size)
+        return NULL;
+
+    slot = &base_ctx->shard_cache[ctx->block_num % base_ctx->shard_cache_size];
+    if (slot->inode != inode)
+        return NULL;
+
+    slot->inode = NULL;
+    ctx->cached = _gf_false;
+
+    return inode;
+}
+
+static inode_t *
+__shard_inode_cache_add(xlator_t *this, shard_inode_ctx_t *base_ctx,
+                        shard_inode_ctx_t *ctx, inode_t *inode, int block_num)
+{
+    shard_priv_t *priv = NULL;
+    shard_cached_inode_t *slot = NULL;
+    shard_inode_ctx_t *old_ctx = NULL;
+    inode_t *old = NULL;
+
+    priv = this->private;
+
+    if (!base_ctx->shard_cache) {
+        if (!priv->per_file_inode_cache)
+            return NULL;
+        base_ctx->shard_cache = GF_CALLOC(priv->per_file_inode_cache,
+                                          sizeof(shard_cached_inode_t),
+                                          gf_shard_mt_inode_cache_t);
+        if (!base_ctx->shard_cache)
+            return NULL;
+        base_ctx->shard_cache_size = priv->per_file_inode_cache;
+    }
+
+    slot = &base_ctx->shard_cache[block_num % base_ctx->shard_cache_size];
+    if (slot->inode == inode)
+        return NULL;
+
+    old = slot->inode;
+    if (old && !shard_inode_ctx_get(old, this, &old_ctx))
+        old_ctx->cached = _gf_false;
+
+    slot->inode = inode_ref(inode);
+    slot->block_num = block_num;
+    ctx->cached = _gf_true;
+
+    return old;
+}
+
+/* Picks the least recently used shard that is not pinned by a per-file
+ * cache. Pinned shards that are skipped move to the tail of the list. If
+ * every shard is pinned, the head of the list is returned anyway so that
+ * shard-lru-limit is never exceeded.
+ */
+static shard_inode_ctx_t *
+__shard_lru_victim(shard_priv_t *priv)
+{
+    int i = 0;
+    shard_inode_ctx_t *ctx = NULL;
+
+    for (i = 0; i < priv->inode_count; i++) {
+        ctx = list_first_entry(&priv->ilist_head, shard_inode_ctx_t, ilist);
+        if (!ctx->cached)
+            break;
+        list_move_tail(&ctx->ilist, &priv->ilist_head);
+    }
+
+    return list_first_entry(&priv->ilist_head, shard_inode_ctx_t, ilist);
+}
+
 inode_t *
 __shard_update_shards_inode_list(inode_t *linked_inode, xlator_t *this,
                                  inode_t *base_inode, int block_num,
@@ -667,6 +923,8 @@ __shard_update_shards_inode_list(inode_t *linked_inode, xlator_t *this,
     shard_inode_ctx_t *lru_base_inode_ctx = NULL;
     inode_t *fsync_inode = NULL;
     inode_t *lru_base_inode = NULL;
+    inode_t *evicted_inode = NULL;
+    shard_inode_ctx_t *base_ictx = NULL;
     gf_boolean_t do_fsync = _gf_false;
 
     priv = this->private;
@@ -696,13 +954,23 @@ __shard_update_shards_inode_list(inode_t *linked_inode, xlator_t *this,
              * in the list, delete the lru inode from the head of the list,
              * unlink it. And in its place add this new inode into the list.
              */
-            lru_inode_ctx = list_first_entry(&priv->ilist_head,
-                                             shard_inode_ctx_t, ilist);
+            lru_inode_ctx = __shard_lru_victim(priv);
             GF_ASSERT(lru_inode_ctx->block_num > 0);
             lru_base_inode = lru_inode_ctx->base_inode;
             list_del_init(&lru_inode_ctx->ilist);
             lru_inode = inode_find(linked_inode->table,
                                    lru_inode_ctx->stat.ia_gfid);
+            if (lru_inode_ctx->cached && lru_base_inode &&
+                !shard_inode_ctx_get(lru_base_inode, this,
+                                     &lru_base_inode_ctx)) {
+                /* The following unref corresponds to the ref held by
+                 * the per-file cache of the base file.
+                 */
+                if (__shard_inode_cache_del(this, lru_base_inode_ctx,
+                                            lru_inode_ctx, lru_inode))
+                    inode_unref(lru_inode);
+                lru_base_inode_ctx = NULL;
+            }
             /* If the lru inode was part of the pending-fsync list,
              * the base inode needs to be unref'd, the lru inode
              * deleted from fsync list and fsync'd in a new frame,
@@ -774,6 +1042,15 @@ __shard_update_shards_inode_list(inode_t *linked_inode, xlator_t *this,
          */
         list_move_tail(&ctx->ilist, &priv->ilist_head);
     }
+
+    if (base_inode && (ctx->base_inode == base_inode) &&
+        priv->per_file_inode_cache &&
+        !shard_inode_ctx_get(base_inode, this, &base_ictx)) {
+        evicted_inode = __shard_inode_cache_add(this, base_ictx, ctx,
+                                                linked_inode, block_num);
+        if (evicted_inode)
+            inode_unref(evicted_inode);
+    }
     return fsync_inode;
 }
 
@@ -844,6 +1121,9 @@ shard_common_failure_unwind(glusterfs_fop_t fop, call_frame_t *frame,
             SHARD_STACK_UNWIND(fsync, frame, op_ret, op_errno, NULL, NULL,
                                NULL);
             break;
+        case GF_FOP_FLUSH:
+            SHARD_STACK_UNWIND(flush, frame, op_ret, op_errno, NULL);
+            break;
         case GF_FOP_REMOVEXATTR:
             SHARD_STACK_UNWIND(removexattr, frame, op_ret, op_errno, NULL);
             break;
@@ -1017,6 +1297,7 @@ shard_common_resolve_shards(call_frame_t *frame, xlator_t *this,
     inode_t *fsync_inode = NULL;
     shard_priv_t *priv = NULL;
     shard_local_t *local = NULL;
+    shard_inode_ctx_t *base_ctx = NULL;
 
     priv = this->private;
     local = frame->local;
@@ -1031,6 +1312,9 @@ shard_common_resolve_shards(call_frame_t *frame, xlator_t *this,
     if ((local->op_ret < 0) || (local->resolve_not))
         goto out;
 
+    if (res_inode && priv->per_file_inode_cache)
+        shard_inode_ctx_get(res_inode, this, &base_ctx);
+
     while (shard_idx_iter <= local->last_block) {
         i++;
         if (shard_idx_iter == 0) {
@@ -1039,10 +1323,21 @@ shard_common_resolve_shards(call_frame_t *frame, xlator_t *this,
             continue;
         }
 
-        shard_make_block_abspath(shard_idx_iter, gfid, path, sizeof(path));
-
         inode = NULL;
-        inode = inode_resolve(this->itable, path);
+        if (base_ctx) {
+            LOCK(&priv->lock);
+            {
+                inode = __shard_inode_cache_get(base_ctx, shard_idx_iter);
+            }
+            UNLOCK(&priv->lock);
+        }
+
+        if (inode) {
+            GF_ATOMIC_INC(priv->inode_cache_hits);
+        } else {
+            shard_make_block_abspath(shard_idx_iter, gfid, path, sizeof(path));
+            inode = inode_resolve(this->itable, path);
+        }
         if (inode) {
             gf_msg_debug(this->name, 0,
                          "Shard %d already "
@@ -1081,8 +1376,10 @@ shard_update_file_size_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 {
     inode_t *inode = NULL;
     shard_local_t *local = NULL;
+    shard_priv_t *priv = NULL;
 
     local = frame->local;
+    priv = this->private;
 
     if ((local->fd) && (local->fd->inode))
         inode = local->fd->inode;
@@ -1097,14 +1394,24 @@ shard_update_file_size_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                uuid_utoa(inode->gfid));
         local->op_ret = op_ret;
         local->op_errno = op_errno;
+        /* Deferred deltas that rode on this xattrop are retried later,
+         * unless the file is gone.
+         */
+        if ((op_errno != ENOENT) && (op_errno != ESTALE))
+            shard_inode_ctx_restore_pending_size(
+                this, inode, local->pending_size, local->pending_blocks);
         goto err;
     }
 
-    if (shard_modify_size_and_block_count(&local->postbuf, dict)) {
+    if (shard_modify_size_and_block_count(&local->postbuf, dict, inode)) {
         local->op_ret = -1;
         local->op_errno = ENOMEM;
         goto err;
     }
+
+    if (priv->size_update_wb)
+        shard_inode_ctx_set(inode, this, &local->postbuf, 0,
+                            SHARD_MASK_BLOCKS);
 err:
     local->post_update_size_handler(frame, this);
     return 0;
@@ -1147,9 +1454,11 @@ shard_update_file_size(call_frame_t *frame, xlator_t *this, fd_t *fd,
     int64_t delta_blocks = 0;
     inode_t *inode = NULL;
     shard_local_t *local = NULL;
+    shard_priv_t *priv = NULL;
     dict_t *xattr_req = NULL;
 
     local = frame->local;
+    priv = this->private;
     local->post_update_size_handler = handler;
 
     xattr_req = dict_new();
@@ -1164,21 +1473,27 @@ shard_update_file_size(call_frame_t *frame, xlator_t *this, fd_t *fd,
     else
         inode = loc->inode;
 
+    /* Piggyback the deltas deferred by earlier writes on this xattrop. */
+    shard_inode_ctx_take_pending_size(inode, this, &local->pending_size,
+                                      &local->pending_blocks);
+
     /* If both size and block count have not changed, then skip the xattrop.
      */
-    delta_blocks = GF_ATOMIC_GET(local->delta_blocks);
-    if ((local->delta_size + local->hole_size == 0) && (delta_blocks == 0)) {
+    delta_blocks = GF_ATOMIC_GET(local->delta_blocks) + local->pending_blocks;
+    if ((local->delta_size + local->hole_size + local->pending_size == 0) &&
+        (delta_blocks == 0)) {
         goto out;
     }
 
-    ret = shard_set_size_attrs(local->delta_size + local->hole_size,
-                               delta_blocks, &size_attr);
+    ret = shard_set_size_attrs(
+        local->delta_size + local->hole_size + local->pending_size,
+        delta_blocks, &size_attr);
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, 0, SHARD_MSG_SIZE_SET_FAILED,
                "Failed to set size attrs for %s", uuid_utoa(inode->gfid));
         local->op_ret = -1;
         local->op_errno = ENOMEM;
-        goto out;
+        goto restore;
     }
 
     ret = dict_set_bin(xattr_req, GF_XATTR_SHARD_FILE_SIZE, size_attr, 8 * 4);
@@ -1189,9 +1504,11 @@ shard_update_file_size(call_frame_t *frame, xlator_t *this, fd_t *fd,
         GF_FREE(size_attr);
         local->op_ret = -1;
         local->op_errno = ENOMEM;
-        goto out;
+        goto restore;
     }
 
+    GF_ATOMIC_INC(priv->size_xattrops_sent);
+
     if (fd)
         STACK_WIND(frame, shard_update_file_size_cbk, FIRST_CHILD(this),
                    FIRST_CHILD(this)->fops->fxattrop, fd,
@@ -1204,6 +1521,9 @@ shard_update_file_size(call_frame_t *frame, xlator_t *this, fd_t *fd,
     dict_unref(xattr_req);
     return 0;
 
+restore:
+    shard_inode_ctx_restore_pending_size(this, inode, local->pending_size,
+                                         local->pending_blocks);
 out:
     if (xattr_req)
         dict_unref(xattr_req);
@@ -1211,6 +1531,97 @@ out:
     return 0;
 }
 
+int
+shard_post_update_size_background_handler(call_frame_t *frame, xlator_t *this)
+{
+    SHARD_STACK_DESTROY(frame);
+    return 0;
+}
+
+/* Sends the deferred size/block-count deltas of @inode on a frame of its
+ * own. Used when the write-back interval expires.
+ */
+static int
+shard_update_file_size_in_background(xlator_t *this, inode_t *inode)
+{
+    call_frame_t *frame = NULL;
+    shard_local_t *local = NULL;
+
+    frame = create_frame(this, this->ctx->pool);
+    if (!frame)
+        goto err;
+
+    local = mem_get0(this->local_pool);
+    if (!local) {
+        STACK_DESTROY(frame->root);
+        goto err;
+    }
+
+    frame->local = local;
+    local->loc.inode = inode_ref(inode);
+    gf_uuid_copy(local->loc.gfid, inode->gfid);
+
+    shard_update_file_size(frame, this, NULL, &local->loc,
+                           shard_post_update_size_background_handler);
+    return 0;
+err:
+    gf_msg(this->name, GF_LOG_WARNING, ENOMEM, SHARD_MSG_MEMALLOC_FAILED,
+           "Failed to create frame to write back size of %s",
+           uuid_utoa(inode->gfid));
+    return -1;
+}
+
+static void
+shard_size_update_timer_cbk(void *data)
+{
+    xlator_t *this = data;
+    shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+    inode_t *inode = NULL;
+    int64_t size = 0;
+    int64_t blocks = 0;
+    struct list_head dirty;
+
+    THIS = this;
+    priv = this->private;
+    INIT_LIST_HEAD(&dirty);
+
+    LOCK(&priv->lock);
+    {
+        list_splice_init(&priv->size_dirty_list, &dirty);
+        priv->size_update_timer = NULL;
+    }
+    UNLOCK(&priv->lock);
+
+    /* Entries may concurrently be taken off @dirty by writers that send
+     * their own xattrop, so it is only walked under priv->lock.
+     */
+    for (;;) {
+        inode = NULL;
+        LOCK(&priv->lock);
+        {
+            if (!list_empty(&dirty)) {
+                ctx = list_first_entry(&dirty, shard_inode_ctx_t,
+                                       size_dirty_list);
+                list_del_init(&ctx->size_dirty_list);
+                inode = ctx->size_dirty_inode;
+                ctx->size_dirty_inode = NULL;
+            }
+        }
+        UNLOCK(&priv->lock);
+
+        if (!inode)
+            break;
+
+        if (shard_update_file_size_in_background(this, inode)) {
+            /* Keep the deltas around for the next tick. */
+            shard_inode_ctx_take_pending_size(inode, this, &size, &blocks);
+            shard_inode_ctx_restore_pending_size(this, inode, size, blocks);
+        }
+        inode_unref(inode);
+    }
+}
+
 static inode_t *
 shard_link_internal_dir_inode(shard_local_t *local, inode_t *inode,
                               struct iatt *buf, shard_internal_dir_type_t type)
@@ -1472,6 +1883,31 @@ shard_delete_shards(void *opaque);
 int
 shard_delete_shards_cbk(int ret, call_frame_t *frame, void *data);
 
+static gf_boolean_t
+shard_deletion_stopped(shard_priv_t *priv)
+{
+    gf_boolean_t stop = _gf_false;
+
+    pthread_mutex_lock(&priv->deletion_mutex);
+    {
+        stop = priv->deletion_stop;
+    }
+    pthread_mutex_unlock(&priv->deletion_mutex);
+
+    return stop;
+}
+
+static void
+shard_deletion_task_done(shard_priv_t *priv)
+{
+    pthread_mutex_lock(&priv->deletion_mutex);
+    {
+        priv->deletion_task = _gf_false;
+        pthread_cond_broadcast(&priv->deletion_cond);
+    }
+    pthread_mutex_unlock(&priv->deletion_mutex);
+}
+
 int
 shard_start_background_deletion(xlator_t *this)
 {
@@ -1504,12 +1940,25 @@ shard_start_background_deletion(xlator_t *this)
     if (!i_cleanup)
         return 0;
 
+    /* no new task once fini() started waiting for the last one */
+    pthread_mutex_lock(&priv->deletion_mutex);
+    {
+        if (!priv->deletion_stop)
+            priv->deletion_task = _gf_true;
+        else
+            i_cleanup = _gf_false;
+    }
+    pthread_mutex_unlock(&priv->deletion_mutex);
+    if (!i_cleanup)
+        goto err;
+
     cleanup_frame = create_frame(this, this->ctx->pool);
     if (!cleanup_frame) {
         gf_msg(this->name, GF_LOG_WARNING, ENOMEM, SHARD_MSG_MEMALLOC_FAILED,
                "Failed to create "
                "new frame to delete shards");
         ret = -ENOMEM;
+        shard_deletion_task_done(priv);
         goto err;
     }
 
@@ -1523,6 +1972,7 @@ shard_start_background_deletion(xlator_t *this)
                "failed to create task to do background "
                "cleanup of shards");
         STACK_DESTROY(cleanup_frame->root);
+        shard_deletion_task_done(priv);
         goto err;
     }
     return 0;
@@ -1559,7 +2009,7 @@ shard_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
     if (dict_get(xdata, GF_XATTR_SHARD_FILE_SIZE) &&
         frame->root->pid != GF_CLIENT_PID_GSYNCD)
-        shard_modify_size_and_block_count(buf, xdata);
+        shard_modify_size_and_block_count(buf, xdata, inode);
 
     /* If this was a fresh lookup, there are two possibilities:
      * 1) If the file is sharded (indicated by the presence of block size
@@ -1650,6 +2100,9 @@ shard_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req)
     if ((xattr_req) && (dict_get(xattr_req, GF_CONTENT_KEY)))
         dict_del(xattr_req, GF_CONTENT_KEY);
 
+    if ((xattr_req) && (dict_get(xattr_req, GF_CONTENT_HEAD_KEY)))
+        dict_del(xattr_req, GF_CONTENT_HEAD_KEY);
+
     STACK_WIND(frame, shard_lookup_cbk, FIRST_CHILD(this),
                FIRST_CHILD(this)->fops->lookup, loc, local->xattr_req);
     return 0;
@@ -1685,7 +2138,7 @@ shard_lookup_base_file_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     local->prebuf = *buf;
-    if (shard_modify_size_and_block_count(&local->prebuf, xdata)) {
+    if (shard_modify_size_and_block_count(&local->prebuf, xdata, inode)) {
         local->op_ret = -1;
         local->op_errno = EINVAL;
         goto unwind;
@@ -1811,7 +2264,9 @@ shard_common_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     local->prebuf = *buf;
-    if (shard_modify_size_and_block_count(&local->prebuf, xdata)) {
+    if (shard_modify_size_and_block_count(
+            &local->prebuf, xdata,
+            (local->fd) ? local->fd->inode : local->loc.inode)) {
         local->op_ret = -1;
         local->op_errno = EINVAL;
         goto unwind;
@@ -3031,6 +3486,11 @@ shard_unlink_block_inode(shard_local_t *local, int shard_block_num)
                 base_ictx->fsync_count--;
             }
         }
+        if (ctx->cached && base_inode &&
+            !__shard_inode_ctx_get(base_inode, this, &base_ictx)) {
+            if (__shard_inode_cache_del(this, base_ictx, ctx, inode))
+                unref_shard_inode++;
+        }
     }
     UNLOCK(&inode->lock);
     if (base_inode)
@@ -3078,8 +3538,10 @@ shard_unlink_shards_do_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 {
     int shard_block_num = (long)cookie;
     shard_local_t *local = NULL;
+    shard_priv_t *priv = NULL;
 
     local = frame->local;
+    priv = this->private;
 
     if (op_ret < 0) {
         local->op_ret = op_ret;
@@ -3088,6 +3550,7 @@ shard_unlink_shards_do_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     shard_unlink_block_inode(local, shard_block_num);
+    GF_ATOMIC_INC(priv->shards_deleted);
 done:
     syncbarrier_wake(&local->barrier);
     return 0;
@@ -3192,6 +3655,41 @@ shard_unlink_shards_do(call_frame_t *frame, xlator_t *this, inode_t *inode)
     return 0;
 }
 
+/* Takes one token per shard about to be deleted, until
+ * shard-deletion-max-rate allows the deletion task to go on. This runs in
+ * a synctask: tokens are taken without blocking and the task sleeps off
+ * the deficit with synctask_usleep(), leaving the syncenv thread to the
+ * other tasks. The sleep is capped to a second so that a new rate is
+ * picked up.
+ */
+static void
+shard_deletion_throttle(xlator_t *this, int count)
+{
+    shard_priv_t *priv = NULL;
+    uint32_t rate = 0;
+    uint64_t usecs = 0;
+
+    priv = this->private;
+
+    while (count > 0) {
+        rate = priv->deletion_max_rate;
+        if (!rate || !priv->deletion_tbf || shard_deletion_stopped(priv))
+            break;
+
+        count -= tbf_take(priv->deletion_tbf, TBF_OP_UNLINK, count);
+        if (count <= 0)
+            break;
+
+        usecs = ((uint64_t)count * 1000000) / rate;
+        usecs = max(usecs, 10000);
+        usecs = min(usecs, 1000000);
+        synctask_usleep(usecs);
+    }
+}
+
+/* Deletes @now shards, one unlink per shard wound in parallel through the
+ * graph, once the deletion throttle allows it.
+ */
 int
 shard_regulated_shards_deletion(call_frame_t *cleanup_frame, xlator_t *this,
                                 int now, int first_block, gf_dirent_t *entry)
@@ -3199,11 +3697,15 @@ shard_regulated_shards_deletion(call_frame_t *cleanup_frame, xlator_t *this,
     int i = 0;
     int ret = 0;
     shard_local_t *local = NULL;
+    shard_priv_t *priv = NULL;
     uuid_t gfid = {
         0,
     };
 
     local = cleanup_frame->local;
+    priv = this->private;
+
+    shard_deletion_throttle(this, now);
 
     local->inode_list = GF_CALLOC(now, sizeof(inode_t *),
                                   gf_shard_mt_inode_list);
@@ -3240,6 +3742,12 @@ shard_regulated_shards_deletion(call_frame_t *cleanup_frame, xlator_t *this,
     inode_unref(local->resolver_base_inode);
     local->resolver_base_inode = NULL;
     STACK_RESET(cleanup_frame->root);
+
+    LOCK(&priv->lock);
+    {
+        priv->deletion_shards_done += now;
+    }
+    UNLOCK(&priv->lock);
     return ret;
 }
 
@@ -3251,6 +3759,7 @@ __shard_delete_shards_of_entry(call_frame_t *cleanup_frame, xlator_t *this,
     int shard_count = 0;
     int first_block = 0;
     int now = 0;
+    int batch = 0;
     uint64_t size = 0;
     uint64_t block_size = 0;
     uint64_t size_array[4] = {
@@ -3380,13 +3889,35 @@ __shard_delete_shards_of_entry(call_frame_t *cleanup_frame, xlator_t *this,
 
     first_block = 1;
 
-    while (shard_count) {
-        if (shard_count < local->deletion_rate) {
-            now = shard_count;
-            shard_count = 0;
+    LOCK(&priv->lock);
+    {
+        gf_uuid_parse(entry->d_name, priv->deletion_gfid);
+        priv->deletion_shards_total = shard_count;
+        priv->deletion_shards_done = 0;
+    }
+    UNLOCK(&priv->lock);
+
+    /* With a rate limit in place, keep each batch within one second's
+     * worth of tokens so that the unlinks are spread out rather than
+     * sent in bursts of deletion_rate.
+     */
+    batch = local->deletion_rate;
+    if (priv->deletion_max_rate && (priv->deletion_max_rate < batch))
+        batch = priv->deletion_max_rate;
+
+    while (shard_count) {
+        /* the marker stays, the next mount picks up from there */
+        if (shard_deletion_stopped(priv)) {
+            ret = -ECANCELED;
+            goto err;
+        }
+
+        if (shard_count < batch) {
+            now = shard_count;
+            shard_count = 0;
         } else {
-            now = local->deletion_rate;
-            shard_count -= local->deletion_rate;
+            now = batch;
+            shard_count -= batch;
         }
 
         gf_msg_debug(this->name, 0,
@@ -3420,7 +3951,16 @@ delete_marker:
                "Failed to delete %s "
                "from /%s",
                entry->d_name, GF_SHARD_REMOVE_ME_DIR);
+    else
+        GF_ATOMIC_INC(priv->files_deleted);
 err:
+    LOCK(&priv->lock);
+    {
+        gf_uuid_clear(priv->deletion_gfid);
+        priv->deletion_shards_total = 0;
+        priv->deletion_shards_done = 0;
+    }
+    UNLOCK(&priv->lock);
     if (xattr_rsp)
         dict_unref(xattr_rsp);
     loc_wipe(&loc);
@@ -3461,7 +4001,10 @@ out:
 int
 shard_delete_shards_cbk(int ret, call_frame_t *frame, void *data)
 {
+    shard_priv_t *priv = frame->this->private;
+
     SHARD_STACK_DESTROY(frame);
+    shard_deletion_task_done(priv);
     return 0;
 }
 
@@ -3583,6 +4126,7 @@ shard_delete_shards(void *opaque)
     gf_dirent_t *entry = NULL;
     call_frame_t *cleanup_frame = NULL;
     gf_boolean_t done = _gf_false;
+    gf_boolean_t stop = _gf_false;
 
     this = THIS;
     priv = this->private;
@@ -3639,9 +4183,13 @@ shard_delete_shards(void *opaque)
 
     for (;;) {
         offset = 0;
+        stop = shard_deletion_stopped(priv);
         LOCK(&priv->lock);
         {
-            if (priv->bg_del_state == SHARD_BG_DELETION_LAUNCHING) {
+            if (stop) {
+                priv->bg_del_state = SHARD_BG_DELETION_NONE;
+                done = _gf_true;
+            } else if (priv->bg_del_state == SHARD_BG_DELETION_LAUNCHING) {
                 priv->bg_del_state = SHARD_BG_DELETION_IN_PROGRESS;
             } else if (priv->bg_del_state == SHARD_BG_DELETION_IN_PROGRESS) {
                 priv->bg_del_state = SHARD_BG_DELETION_NONE;
@@ -3663,6 +4211,11 @@ shard_delete_shards(void *opaque)
                 if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
                     continue;
 
+                if (shard_deletion_stopped(priv)) {
+                    ret = -ECANCELED;
+                    break;
+                }
+
                 if (!entry->inode) {
                     ret = shard_lookup_marker_entry(this, local, entry);
                     if (ret < 0)
@@ -3679,6 +4232,8 @@ shard_delete_shards(void *opaque)
                                                    link_inode);
                 inode_unlink(link_inode, local->fd->inode, entry->d_name);
                 inode_unref(link_inode);
+                if (ret == -ECANCELED)
+                    break;
                 if (ret) {
                     gf_msg(this->name, GF_LOG_ERROR, -ret,
                            SHARD_MSG_SHARDS_DELETION_FAILED,
@@ -5018,6 +5573,164 @@ err:
     return 0;
 }
 
+int
+shard_post_mknod_prefetch_handler(call_frame_t *frame, xlator_t *this)
+{
+    SHARD_STACK_DESTROY(frame);
+    return 0;
+}
+
+int
+shard_post_lookup_shards_prefetch_handler(call_frame_t *frame, xlator_t *this)
+{
+    shard_local_t *local = NULL;
+
+    local = frame->local;
+
+    if ((local->op_ret < 0) || !local->create_count) {
+        SHARD_STACK_DESTROY(frame);
+        return 0;
+    }
+
+    shard_common_resume_mknod(frame, this, shard_post_mknod_prefetch_handler);
+    return 0;
+}
+
+int
+shard_post_resolve_prefetch_handler(call_frame_t *frame, xlator_t *this)
+{
+    shard_local_t *local = NULL;
+    shard_priv_t *priv = NULL;
+
+    local = frame->local;
+    priv = this->private;
+
+    if ((local->op_ret < 0) || !local->call_count) {
+        SHARD_STACK_DESTROY(frame);
+        return 0;
+    }
+
+    GF_ATOMIC_ADD(priv->shards_prefetched, local->call_count);
+    shard_common_lookup_shards(frame, this, local->resolver_base_inode,
+                               shard_post_lookup_shards_prefetch_handler);
+    return 0;
+}
+
+/* Resolves shards @first_block..@last_block of the file open on @fd in a
+ * frame of its own, looking up those that are not in the inode table and
+ * creating the ones that are holes, exactly as a read or write on them
+ * would.
+ */
+static int
+shard_prefetch_shards_do(xlator_t *this, fd_t *fd, glusterfs_fop_t fop,
+                         uint64_t block_size, int first_block, int last_block)
+{
+    call_frame_t *frame = NULL;
+    shard_local_t *local = NULL;
+
+    frame = create_frame(this, this->ctx->pool);
+    if (!frame)
+        return -1;
+
+    local = mem_get0(this->local_pool);
+    if (!local) {
+        STACK_DESTROY(frame->root);
+        return -1;
+    }
+
+    frame->local = local;
+    local->fop = fop;
+    local->fd = fd_ref(fd);
+    local->block_size = block_size;
+    local->loc.inode = inode_ref(fd->inode);
+    gf_uuid_copy(local->loc.gfid, fd->inode->gfid);
+    local->resolver_base_inode = local->loc.inode;
+    local->first_block = first_block;
+    local->last_block = last_block;
+    local->num_blocks = last_block - first_block + 1;
+    local->inode_list = GF_CALLOC(local->num_blocks, sizeof(inode_t *),
+                                  gf_shard_mt_inode_list);
+    local->xattr_req = dict_new();
+    if (!local->inode_list || !local->xattr_req) {
+        SHARD_STACK_DESTROY(frame);
+        return -1;
+    }
+
+    shard_common_resolve_shards(frame, this,
+                                shard_post_resolve_prefetch_handler);
+    return 0;
+}
+
+/* Called once the shards of a read or write are resolved. If the I/O
+ * continues where the previous one on the file ended, the next
+ * shard-prefetch-count shards up to EOF are resolved in the background so
+ * that the following I/O finds them in the inode table. Shards beyond EOF are
+ * never created speculatively, since nothing would clean them up if the file
+ * does not grow over them.
+ */
+static void
+shard_prefetch_shards(xlator_t *this, shard_local_t *local)
+{
+    int first_block = 0;
+    int last_block = 0;
+    int eof_block = 0;
+    gf_boolean_t sequential = _gf_false;
+    gf_boolean_t prefetch = _gf_false;
+    inode_t *base_inode = NULL;
+    shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+
+    priv = this->private;
+    base_inode = local->resolver_base_inode;
+
+    if (!priv->prefetch_count || !local->fd || !base_inode ||
+        !priv->dot_shard_inode || !local->block_size)
+        return;
+
+    if ((local->fop != GF_FOP_READ) && (local->fop != GF_FOP_WRITE))
+        return;
+
+    if (shard_inode_ctx_get(base_inode, this, &ctx))
+        return;
+
+    LOCK(&priv->lock);
+    {
+        sequential = (local->first_block == ctx->last_access_block) ||
+                     (local->first_block == ctx->last_access_block + 1);
+        ctx->last_access_block = local->last_block;
+        if (!sequential) {
+            ctx->prefetched_upto = local->last_block;
+            goto unlock;
+        }
+
+        if (ctx->stat.ia_size == 0)
+            goto unlock;
+
+        eof_block = get_highest_block(0, ctx->stat.ia_size, local->block_size);
+        first_block = max(local->last_block, ctx->prefetched_upto) + 1;
+        last_block = min(local->last_block + (int)priv->prefetch_count,
+                         eof_block);
+        if (first_block > last_block)
+            goto unlock;
+
+        ctx->prefetched_upto = last_block;
+        prefetch = _gf_true;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (!prefetch)
+        return;
+
+    if (shard_prefetch_shards_do(this, local->fd, local->fop,
+                                 local->block_size, first_block,
+                                 last_block)) {
+        gf_msg_debug(this->name, ENOMEM,
+                     "Failed to prefetch shards %d-%d of %s", first_block,
+                     last_block, uuid_utoa(base_inode->gfid));
+    }
+}
+
 int
 shard_post_mknod_readv_handler(call_frame_t *frame, xlator_t *this);
 
@@ -5092,6 +5805,8 @@ shard_post_resolve_readv_handler(call_frame_t *frame, xlator_t *this)
         }
     }
 
+    shard_prefetch_shards(this, local);
+
     if (local->call_count) {
         shard_common_lookup_shards(frame, this, local->resolver_base_inode,
                                    shard_post_lookup_shards_readv_handler);
@@ -5327,6 +6042,61 @@ shard_get_delta_size_from_inode_ctx(shard_local_t *local, inode_t *inode,
     return ret;
 }
 
+/* In write-back mode, parks the size/block-count delta of a completed write
+ * in the base inode ctx instead of sending an xattrop for it. Returns
+ * _gf_false when the delta has to go out right away, either because
+ * write-back is off or because this write completes a batch, in which case
+ * the caller's xattrop carries all the accumulated deltas.
+ */
+static gf_boolean_t
+shard_inode_ctx_defer_size_update(shard_local_t *local, inode_t *inode,
+                                  xlator_t *this)
+{
+    int64_t delta_blocks = 0;
+    gf_boolean_t deferred = _gf_false;
+    shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+    inode_t *ref = NULL;
+
+    priv = this->private;
+    if (!priv->size_update_wb)
+        return _gf_false;
+
+    delta_blocks = GF_ATOMIC_GET(local->delta_blocks);
+    if ((local->delta_size == 0) && (delta_blocks == 0))
+        return _gf_false;
+
+    ref = inode_ref(inode);
+
+    LOCK(&priv->lock);
+    LOCK(&inode->lock);
+    {
+        if (__shard_inode_ctx_get(inode, this, &ctx))
+            goto unlock;
+
+        if (ctx->pending_count + 1 >= priv->size_update_batch)
+            goto unlock;
+
+        __shard_inode_ctx_add_pending_size(this, inode, ctx, local->delta_size,
+                                           delta_blocks, &ref);
+        ctx->stat.ia_blocks += delta_blocks;
+        local->postbuf.ia_size = ctx->stat.ia_size;
+        local->postbuf.ia_blocks = ctx->stat.ia_blocks;
+        deferred = _gf_true;
+    }
+unlock:
+    UNLOCK(&inode->lock);
+    UNLOCK(&priv->lock);
+
+    if (ref)
+        inode_unref(ref);
+
+    if (deferred)
+        GF_ATOMIC_INC(priv->size_updates_deferred);
+
+    return deferred;
+}
+
 int
 shard_common_inode_write_do_cbk(call_frame_t *frame, void *cookie,
                                 xlator_t *this, int32_t op_ret,
@@ -5374,6 +6144,11 @@ shard_common_inode_write_do_cbk(call_frame_t *frame, void *cookie,
             local->hole_size = 0;
             if (xdata)
                 local->xattr_rsp = dict_ref(xdata);
+            if (shard_inode_ctx_defer_size_update(local, local->fd->inode,
+                                                  this)) {
+                shard_common_inode_write_post_update_size_handler(frame, this);
+                return 0;
+            }
             shard_update_file_size(
                 frame, this, local->fd, NULL,
                 shard_common_inode_write_post_update_size_handler);
@@ -5606,6 +6381,8 @@ shard_common_inode_write_post_resolve_handler(call_frame_t *frame,
         return 0;
     }
 
+    shard_prefetch_shards(this, local);
+
     if (local->call_count) {
         shard_common_lookup_shards(
             frame, this, local->resolver_base_inode,
@@ -5797,10 +6574,52 @@ shard_flush_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 int
-shard_flush(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+shard_post_update_size_flush_handler(call_frame_t *frame, xlator_t *this)
 {
+    shard_local_t *local = NULL;
+
+    local = frame->local;
+
+    if (local->op_ret < 0) {
+        shard_common_failure_unwind(GF_FOP_FLUSH, frame, local->op_ret,
+                                    local->op_errno);
+        return 0;
+    }
+
     STACK_WIND(frame, shard_flush_cbk, FIRST_CHILD(this),
-               FIRST_CHILD(this)->fops->flush, fd, xdata);
+               FIRST_CHILD(this)->fops->flush, local->fd, local->xattr_req);
+    return 0;
+}
+
+int
+shard_flush(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+    shard_local_t *local = NULL;
+
+    /* Write back any size/block-count deltas still held by this client
+     * before the flush goes out.
+     */
+    if (!shard_inode_ctx_has_pending_size(fd->inode, this)) {
+        STACK_WIND(frame, shard_flush_cbk, FIRST_CHILD(this),
+                   FIRST_CHILD(this)->fops->flush, fd, xdata);
+        return 0;
+    }
+
+    local = mem_get0(this->local_pool);
+    if (!local)
+        goto err;
+
+    frame->local = local;
+    local->fd = fd_ref(fd);
+    local->fop = GF_FOP_FLUSH;
+    if (xdata)
+        local->xattr_req = dict_ref(xdata);
+
+    shard_update_file_size(frame, this, fd, NULL,
+                           shard_post_update_size_flush_handler);
+    return 0;
+err:
+    shard_common_failure_unwind(GF_FOP_FLUSH, frame, -1, ENOMEM);
     return 0;
 }
 
@@ -5918,7 +6737,7 @@ out:
 }
 
 int
-shard_post_lookup_fsync_handler(call_frame_t *frame, xlator_t *this)
+shard_post_update_size_fsync_handler(call_frame_t *frame, xlator_t *this)
 {
     int ret = 0;
     int call_count = 0;
@@ -5935,7 +6754,6 @@ shard_post_lookup_fsync_handler(call_frame_t *frame, xlator_t *this)
 
     local = frame->local;
     base_inode = local->fd->inode;
-    local->postbuf = local->prebuf;
     INIT_LIST_HEAD(&copy);
 
     if (local->op_ret < 0) {
@@ -6003,6 +6821,33 @@ shard_post_lookup_fsync_handler(call_frame_t *frame, xlator_t *this)
     return 0;
 }
 
+int
+shard_post_lookup_fsync_handler(call_frame_t *frame, xlator_t *this)
+{
+    shard_local_t *local = NULL;
+
+    local = frame->local;
+    local->postbuf = local->prebuf;
+
+    if (local->op_ret < 0) {
+        shard_common_failure_unwind(GF_FOP_FSYNC, frame, local->op_ret,
+                                    local->op_errno);
+        return 0;
+    }
+
+    /* The size xattr has to be on disk before fsync returns, so write back
+     * whatever has been deferred before syncing the shards.
+     */
+    if (shard_inode_ctx_has_pending_size(local->fd->inode, this)) {
+        shard_update_file_size(frame, this, local->fd, NULL,
+                               shard_post_update_size_fsync_handler);
+        return 0;
+    }
+
+    shard_post_update_size_fsync_handler(frame, this);
+    return 0;
+}
+
 int
 shard_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
             dict_t *xdata)
@@ -6080,7 +6925,8 @@ shard_readdir_past_dot_shard_cbk(call_frame_t *frame, void *cookie,
             continue;
 
         if (dict_get(entry->dict, GF_XATTR_SHARD_FILE_SIZE))
-            shard_modify_size_and_block_count(&entry->d_stat, entry->dict);
+            shard_modify_size_and_block_count(&entry->d_stat, entry->dict,
+                                              entry->inode);
         if (!entry->inode)
             continue;
 
@@ -6139,7 +6985,8 @@ shard_readdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
         if (dict_get(entry->dict, GF_XATTR_SHARD_FILE_SIZE) &&
             frame->root->pid != GF_CLIENT_PID_GSYNCD)
-            shard_modify_size_and_block_count(&entry->d_stat, entry->dict);
+            shard_modify_size_and_block_count(&entry->d_stat, entry->dict,
+                                              entry->inode);
 
         if (!entry->inode)
             continue;
@@ -6435,7 +7282,9 @@ shard_common_setattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     local->prebuf = *prebuf;
-    if (shard_modify_size_and_block_count(&local->prebuf, xdata)) {
+    if (shard_modify_size_and_block_count(
+            &local->prebuf, xdata,
+            (local->fd) ? local->fd->inode : local->loc.inode)) {
         local->op_ret = -1;
         local->op_errno = EINVAL;
         goto unwind;
@@ -6737,11 +7586,45 @@ mem_acct_init(xlator_t *this)
     return ret;
 }
 
+/* Creates or retunes the token bucket pacing background deletion. When
+ * the limit is lifted the deletion task stops taking tokens, and the
+ * bucket is opened wide.
+ */
+static int
+shard_deletion_throttle_set(xlator_t *this, shard_priv_t *priv)
+{
+    tbf_opspec_t spec = {
+        0,
+    };
+
+    spec.op = TBF_OP_UNLINK;
+    spec.token_gen_interval = 1000000; /* In usec */
+    if (priv->deletion_max_rate) {
+        spec.rate = priv->deletion_max_rate;
+        spec.maxlimit = priv->deletion_max_rate;
+    } else {
+        spec.rate = UINT32_MAX;
+        spec.maxlimit = UINT32_MAX;
+    }
+
+    if (priv->deletion_tbf)
+        return tbf_mod(priv->deletion_tbf, &spec);
+
+    priv->deletion_tbf = tbf_init(&spec, 1);
+    if (!priv->deletion_tbf) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, SHARD_MSG_MEMALLOC_FAILED,
+               "Failed to set up the shard deletion throttle");
+        return -1;
+    }
+    return 0;
+}
+
 int
 init(xlator_t *this)
 {
     int ret = -1;
     shard_priv_t *priv = NULL;
+    char *size_update_mode = NULL;
 
     if (!this) {
         gf_msg("shard", GF_LOG_ERROR, 0, SHARD_MSG_NULL_THIS,
@@ -6772,6 +7655,28 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("shard-lru-limit", priv->lru_limit, uint64, out);
 
+    GF_OPTION_INIT("shard-size-update-mode", size_update_mode, str, out);
+    priv->size_update_wb = !strcmp(size_update_mode, "write-back");
+
+    GF_OPTION_INIT("shard-size-update-interval", priv->size_update_interval,
+                   uint32, out);
+
+    GF_OPTION_INIT("shard-size-update-batch", priv->size_update_batch, uint32,
+                   out);
+
+    GF_OPTION_INIT("shard-prefetch-count", priv->prefetch_count, uint32, out);
+
+    GF_OPTION_INIT("shard-per-file-inode-cache", priv->per_file_inode_cache,
+                   uint32, out);
+
+    GF_OPTION_INIT("shard-deletion-max-rate", priv->deletion_max_rate, uint32,
+                   out);
+    if (priv->deletion_max_rate) {
+        ret = shard_deletion_throttle_set(this, priv);
+        if (ret)
+            goto out;
+    }
+
     this->local_pool = mem_pool_new(shard_local_t, 128);
     if (!this->local_pool) {
         ret = -1;
@@ -6782,10 +7687,21 @@ init(xlator_t *this)
 
     this->private = priv;
     LOCK_INIT(&priv->lock);
+    pthread_mutex_init(&priv->deletion_mutex, NULL);
+    pthread_cond_init(&priv->deletion_cond, NULL);
     INIT_LIST_HEAD(&priv->ilist_head);
+    INIT_LIST_HEAD(&priv->size_dirty_list);
+    GF_ATOMIC_INIT(priv->size_xattrops_sent, 0);
+    GF_ATOMIC_INIT(priv->size_updates_deferred, 0);
+    GF_ATOMIC_INIT(priv->shards_prefetched, 0);
+    GF_ATOMIC_INIT(priv->inode_cache_hits, 0);
+    GF_ATOMIC_INIT(priv->shards_deleted, 0);
+    GF_ATOMIC_INIT(priv->files_deleted, 0);
     ret = 0;
 out:
     if (ret) {
+        if (priv)
+            tbf_fini(priv->deletion_tbf);
         GF_FREE(priv);
         mem_pool_destroy(this->local_pool);
     }
@@ -6797,20 +7713,55 @@ void
 fini(xlator_t *this)
 {
     shard_priv_t *priv = NULL;
+    shard_inode_ctx_t *ctx = NULL;
+    shard_inode_ctx_t *tmp = NULL;
 
     GF_VALIDATE_OR_GOTO("shard", this, out);
 
+    priv = this->private;
+
+    /* the deletion task uses priv, the local pool and the throttle: have
+     * it stop at the next batch and wait until it is gone */
+    if (priv) {
+        pthread_mutex_lock(&priv->deletion_mutex);
+        {
+            priv->deletion_stop = _gf_true;
+            while (priv->deletion_task)
+                pthread_cond_wait(&priv->deletion_cond,
+                                  &priv->deletion_mutex);
+        }
+        pthread_mutex_unlock(&priv->deletion_mutex);
+    }
+
     /*Itable was not created by shard, hence setting to NULL.*/
     this->itable = NULL;
 
     mem_pool_destroy(this->local_pool);
     this->local_pool = NULL;
 
-    priv = this->private;
     if (!priv)
         goto out;
 
+    /* Deltas that were never written back are dropped here; the next
+     * lookup will see the size last written to the bricks.
+     */
+    if (priv->size_update_timer) {
+        gf_timer_call_cancel(this->ctx, priv->size_update_timer);
+        priv->size_update_timer = NULL;
+    }
+    list_for_each_entry_safe(ctx, tmp, &priv->size_dirty_list, size_dirty_list)
+    {
+        list_del_init(&ctx->size_dirty_list);
+        inode_unref(ctx->size_dirty_inode);
+        ctx->size_dirty_inode = NULL;
+    }
+
+    tbf_fini(priv->deletion_tbf);
+    priv->deletion_tbf = NULL;
+
     this->private = NULL;
+    pthread_cond_destroy(&priv->deletion_cond);
+    pthread_mutex_destroy(&priv->deletion_mutex);
     LOCK_DESTROY(&priv->lock);
     GF_FREE(priv);
 
@@ -6823,6 +7774,7 @@ reconfigure(xlator_t *this, dict_t *options)
 {
     int ret = -1;
     shard_priv_t *priv = NULL;
+    char *size_update_mode = NULL;
 
     priv = this->private;
 
@@ -6830,6 +7782,30 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("shard-deletion-rate", priv->deletion_rate, options,
                      uint32, out);
+
+    GF_OPTION_RECONF("shard-size-update-mode", size_update_mode, options, str,
+                     out);
+    priv->size_update_wb = !strcmp(size_update_mode, "write-back");
+
+    GF_OPTION_RECONF("shard-size-update-interval", priv->size_update_interval,
+                     options, uint32, out);
+
+    GF_OPTION_RECONF("shard-size-update-batch", priv->size_update_batch,
+                     options, uint32, out);
+
+    GF_OPTION_RECONF("shard-prefetch-count", priv->prefetch_count, options,
+                     uint32, out);
+
+    GF_OPTION_RECONF("shard-per-file-inode-cache", priv->per_file_inode_cache,
+                     options, uint32, out);
+
+    GF_OPTION_RECONF("shard-deletion-max-rate", priv->deletion_max_rate,
+                     options, uint32, out);
+    if (priv->deletion_max_rate || priv->deletion_tbf) {
+        ret = shard_deletion_throttle_set(this, priv);
+        if (ret)
+            goto out;
+    }
     ret = 0;
 
 out:
@@ -6853,6 +7829,11 @@ shard_forget(xlator_t *this, inode_t *inode)
 
     ctx = (shard_inode_ctx_t *)(uintptr_t)ctx_uint;
 
+    /* Cached shards pin their base inode through the lru list, so the
+     * per-file cache is empty by now.
+     */
+    GF_FREE(ctx->shard_cache);
+
     /* When LRU limit reaches inode will be forcefully removed from the
      * table, inode needs to be removed from LRU of shard as well.
      */
@@ -6876,6 +7857,12 @@ shard_release(xlator_t *this, fd_t *fd)
     return 0;
 }
 
+static const char *shard_bg_deletion_state_str[] = {
+    [SHARD_BG_DELETION_NONE] = "none",
+    [SHARD_BG_DELETION_LAUNCHING] = "launching",
+    [SHARD_BG_DELETION_IN_PROGRESS] = "in-progress",
+};
+
 int
 shard_priv_dump(xlator_t *this)
 {
@@ -6884,6 +7871,12 @@ shard_priv_dump(xlator_t *this)
         0,
     };
     char *str = NULL;
+    shard_bg_deletion_state_t bg_del_state = SHARD_BG_DELETION_NONE;
+    uuid_t deletion_gfid = {
+        0,
+    };
+    uint64_t shards_total = 0;
+    uint64_t shards_done = 0;
 
     priv = this->private;
 
@@ -6894,6 +7887,42 @@ shard_priv_dump(xlator_t *this)
     gf_proc_dump_write("inode-count", "%d", priv->inode_count);
     gf_proc_dump_write("ilist_head", "%p", &priv->ilist_head);
     gf_proc_dump_write("lru-max-limit", "%" PRIu64, priv->lru_limit);
+    gf_proc_dump_write("size-update-mode", "%s",
+                       priv->size_update_wb ? "write-back" : "write-through");
+    gf_proc_dump_write("size-xattrops-sent", "%" PRId64,
+                       GF_ATOMIC_GET(priv->size_xattrops_sent));
+    gf_proc_dump_write("size-updates-deferred", "%" PRId64,
+                       GF_ATOMIC_GET(priv->size_updates_deferred));
+    gf_proc_dump_write("prefetch-count", "%" PRIu32, priv->prefetch_count);
+    gf_proc_dump_write("shards-prefetched", "%" PRId64,
+                       GF_ATOMIC_GET(priv->shards_prefetched));
+    gf_proc_dump_write("per-file-inode-cache", "%" PRIu32,
+                       priv->per_file_inode_cache);
+    gf_proc_dump_write("inode-cache-hits", "%" PRId64,
+                       GF_ATOMIC_GET(priv->inode_cache_hits));
+    gf_proc_dump_write("deletion-max-rate", "%" PRIu32,
+                       priv->deletion_max_rate);
+    gf_proc_dump_write("deletion-shards-deleted", "%" PRId64,
+                       GF_ATOMIC_GET(priv->shards_deleted));
+    gf_proc_dump_write("deletion-files-completed", "%" PRId64,
+                       GF_ATOMIC_GET(priv->files_deleted));
+    if (TRY_LOCK(&priv->lock) == 0) {
+        bg_del_state = priv->bg_del_state;
+        gf_uuid_copy(deletion_gfid, priv->deletion_gfid);
+        shards_total = priv->deletion_shards_total;
+        shards_done = priv->deletion_shards_done;
+        UNLOCK(&priv->lock);
+
+        gf_proc_dump_write("deletion-state", "%s",
+                           shard_bg_deletion_state_str[bg_del_state]);
+        if (!gf_uuid_is_null(deletion_gfid)) {
+            gf_proc_dump_write("deletion-current-gfid", "%s",
+                               uuid_utoa(deletion_gfid));
+            gf_proc_dump_write("deletion-current-progress",
+                               "%" PRIu64 "/%" PRIu64, shards_done,
+                               shards_total);
+        }
+    }
 
     GF_FREE(str);
 
@@ -6980,6 +8009,19 @@ struct volume_options options[] = {
         .max = INT_MAX,
         .description = "The number of shards to send deletes on at a time",
     },
+    {
+        .key = {"shard-deletion-max-rate"},
+        .type = GF_OPTION_TYPE_INT,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "0",
+        .min = 0,
+        .max = INT_MAX,
+        .description = "Maximum number of shards per second that background "
+                       "deletion of removed files may unlink, so that it does "
+                       "not compete with application I/O. 0 means unlimited.",
+    },
     {
         .key = {"shard-lru-limit"},
         .type = GF_OPTION_TYPE_INT,
@@ -6997,6 +8039,82 @@ struct volume_options options[] = {
                        "amount of memory consumed by these inodes and their "
                        "internal metadata",
     },
+    {
+        .key = {"shard-size-update-mode"},
+        .type = GF_OPTION_TYPE_STR,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .value = {"write-through", "write-back"},
+        .default_value = "write-through",
+        .description = "In write-through mode every write that changes the "
+                       "size or block count of a sharded file is followed by "
+                       "an xattrop on the base file. In write-back mode the "
+                       "deltas are accumulated in memory and sent out on "
+                       "fsync, flush, after shard-size-update-interval "
+                       "seconds, or along with the write that completes a "
+                       "batch of shard-size-update-batch writes. If the "
+                       "client crashes, the size recorded on the bricks may "
+                       "lag behind the data written since the last "
+                       "write-back. Only use it for files with a single "
+                       "writer, such as VM images.",
+    },
+    {
+        .key = {"shard-size-update-interval"},
+        .type = GF_OPTION_TYPE_INT,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "1",
+        .min = 1,
+        .max = 60,
+        .description = "Maximum time, in seconds, a size/block-count delta "
+                       "is held back in write-back mode",
+    },
+    {
+        .key = {"shard-size-update-batch"},
+        .type = GF_OPTION_TYPE_INT,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "64",
+        .min = 2,
+        .max = 65536,
+        .description = "Number of writes on a file whose size/block-count "
+                       "deltas are coalesced into one xattrop in write-back "
+                       "mode",
+    },
+    {
+        .key = {"shard-prefetch-count"},
+        .type = GF_OPTION_TYPE_INT,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "0",
+        .min = 0,
+        .max = 64,
+        .description = "Number of shards following a sequential read or "
+                       "write that are looked up in the background, and "
+                       "created if they are holes within the file, so that "
+                       "the next I/O does not wait for them. 0 disables "
+                       "prefetching",
+    },
+    {
+        .key = {"shard-per-file-inode-cache"},
+        .type = GF_OPTION_TYPE_INT,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "0",
+        .min = 0,
+        .max = 1024,
+        .description = "Number of resolved shard inodes each file keeps "
+                       "indexed by block number. Cached shards are resolved "
+                       "without a path lookup in the inode table and are "
+                       "skipped when shard-lru-limit forces an eviction, so "
+                       "one large stream cannot push out the working set of "
+                       "other files. 0 disables the cache",
+    },
     {.key = {NULL}},
 };
 
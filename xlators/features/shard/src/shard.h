@@ -15,6 +15,8 @@
 #include <glusterfs/compat-errno.h>
 #include "shard-messages.h"
 #include <glusterfs/syncop.h>
+#include <glusterfs/timer.h>
+#include <glusterfs/throttle-tbf.h>
 
 #define GF_SHARD_DIR ".shard"
 #define GF_SHARD_REMOVE_ME_DIR ".remove_me"
@@ -207,6 +209,12 @@ typedef enum {
 
 /* rm = "remove me" */
 
+/* Slot of the per-file cache of resolved shard inodes */
+typedef struct {
+    int block_num;
+    inode_t *inode;
+} shard_cached_inode_t;
+
 typedef struct shard_priv {
     uint64_t block_size;
     uuid_t dot_shard_gfid;
@@ -220,6 +228,48 @@ typedef struct shard_priv {
     shard_bg_deletion_state_t bg_del_state;
     gf_boolean_t first_lookup_done;
     uint64_t lru_limit;
+    /* write-back of the file size/block-count xattr. Base inodes with
+     * deferred deltas are kept on size_dirty_list (protected by @lock)
+     * until a fsync, flush, the timer or a write crossing the batch
+     * threshold sends them out in a single xattrop.
+     */
+    gf_boolean_t size_update_wb;
+    uint32_t size_update_interval;
+    uint32_t size_update_batch;
+    struct list_head size_dirty_list;
+    gf_timer_t *size_update_timer;
+    gf_atomic_t size_xattrops_sent;
+    gf_atomic_t size_updates_deferred;
+    /* Number of shards beyond the current I/O that are looked up (and, for
+     * holes, created) ahead of sequential readers and writers.
+     */
+    uint32_t prefetch_count;
+    /* Number of resolved shards each file keeps pinned, regardless of
+     * pressure on the lru list above.
+     */
+    uint32_t per_file_inode_cache;
+    gf_atomic_t shards_prefetched;
+    gf_atomic_t inode_cache_hits;
+    /* Background deletion is paced to deletion_max_rate shards per second
+     * (0 = unlimited) through @deletion_tbf. The gfid, shard count and
+     * blocks processed so far of the file being cleaned up are protected
+     * by @lock and reported in statedump.
+     */
+    uint32_t deletion_max_rate;
+    tbf_t *deletion_tbf;
+    uuid_t deletion_gfid;
+    uint64_t deletion_shards_total;
+    uint64_t deletion_shards_done;
+    gf_atomic_t shards_deleted;
+    gf_atomic_t files_deleted;
+    /* fini() sets @deletion_stop and waits for the deletion task to be
+     * gone (@deletion_task cleared by its completion callback), both
+     * under @deletion_mutex.
+     */
+    pthread_mutex_t deletion_mutex;
+    pthread_cond_t deletion_cond;
+    gf_boolean_t deletion_stop;
+    gf_boolean_t deletion_task;
 } shard_priv_t;
 
 typedef struct {
@@ -318,6 +368,8 @@ typedef struct shard_local {
     uint32_t deletion_rate;
     gf_boolean_t cleanup_required;
     uuid_t base_gfid;
+    int64_t pending_size;
+    int64_t pending_blocks;
 } shard_local_t;
 
 typedef struct shard_inode_ctx {
@@ -337,6 +389,25 @@ typedef struct shard_inode_ctx {
     inode_t *inode;
     int fsync_count;
     inode_t *base_inode;
+    /* Size and block-count deltas of the base file which are yet to be
+     * sent to the bricks (write-back mode only).
+     */
+    int64_t pending_size;
+    int64_t pending_blocks;
+    uint32_t pending_count;
+    struct list_head size_dirty_list;
+    inode_t *size_dirty_inode;
+    /* Base file only: access pattern tracking for prefetch and the per-file
+     * shard inode cache, protected by priv->lock.
+     */
+    int last_access_block;
+    int prefetched_upto;
+    shard_cached_inode_t *shard_cache;
+    uint32_t shard_cache_size;
+    /* Shards only: set while the shard occupies a slot in the per-file cache
+     * of its base file. Protected by priv->lock.
+     */
+    gf_boolean_t cached;
 } shard_inode_ctx_t;
 
 typedef enum {
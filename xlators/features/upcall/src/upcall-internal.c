@@ -20,6 +20,7 @@
 
 #include <glusterfs/statedump.h>
 #include <glusterfs/syncop.h>
+#include <glusterfs/hashfn.h>
 
 #include "upcall.h"
 #include "upcall-mem-types.h"
@@ -60,9 +61,24 @@ get_cache_invalidation_timeout(xlator_t *this)
     return 0;
 }
 
+/* Invalidations taken from a client's queue, to be sent in one callback */
+typedef struct {
+    struct list_head list;
+    char *client_uid;
+    struct list_head pending; /* upcall_pending_inval_t */
+    uint32_t count;
+} upcall_batch_t;
+
+uint32_t
+upcall_client_hash(const char *client_uid)
+{
+    return gf_dm_hashfn(client_uid, strlen(client_uid));
+}
+
 static upcall_client_t *
 __add_upcall_client(call_frame_t *frame, client_t *client,
-                    upcall_inode_ctx_t *up_inode_ctx, time_t now)
+                    uint32_t client_hash, upcall_inode_ctx_t *up_inode_ctx,
+                    time_t now)
 {
     upcall_client_t *up_client_entry = GF_MALLOC(
         sizeof(*up_client_entry), gf_upcall_mt_upcall_client_entry_t);
@@ -73,6 +89,7 @@ __add_upcall_client(call_frame_t *frame, client_t *client,
     }
     INIT_LIST_HEAD(&up_client_entry->client_list);
     up_client_entry->client_uid = gf_strdup(client->client_uid);
+    up_client_entry->client_hash = client_hash;
     up_client_entry->access_time = now;
     up_client_entry->expire_time_attr = get_cache_invalidation_timeout(
         frame->this);
@@ -295,6 +312,535 @@ out:
     return ret;
 }
 
+static void
+__upcall_pending_free(upcall_pending_inval_t *pend)
+{
+    list_del_init(&pend->list);
+    list_del_init(&pend->hash);
+    if (pend->ca.dict)
+        dict_unref(pend->ca.dict);
+    GF_FREE(pend);
+}
+
+static void
+__upcall_client_rec_free(upcall_client_rec_t *rec)
+{
+    upcall_pending_inval_t *pend = NULL;
+    upcall_pending_inval_t *tmp = NULL;
+
+    list_for_each_entry_safe(pend, tmp, &rec->pending, list)
+    {
+        __upcall_pending_free(pend);
+    }
+
+    list_del_init(&rec->hash_list);
+    LOCK_DESTROY(&rec->lock);
+    GF_FREE(rec->client_uid);
+    GF_FREE(rec);
+}
+
+int
+upcall_client_table_init(xlator_t *this)
+{
+    upcall_private_t *priv = NULL;
+    int i = 0;
+
+    priv = this->private;
+    GF_ASSERT(priv);
+
+    priv->client_table = GF_CALLOC(UPCALL_CLIENT_TABLE_SIZE,
+                                   sizeof(struct list_head),
+                                   gf_upcall_mt_client_rec_t);
+    if (!priv->client_table)
+        return -1;
+
+    for (i = 0; i < UPCALL_CLIENT_TABLE_SIZE; i++)
+        INIT_LIST_HEAD(&priv->client_table[i]);
+
+    return 0;
+}
+
+void
+upcall_client_table_cleanup(xlator_t *this, upcall_private_t *priv)
+{
+    upcall_client_rec_t *rec = NULL;
+    upcall_client_rec_t *tmp = NULL;
+    int i = 0;
+
+    if (!priv->client_table)
+        return;
+
+    LOCK(&priv->client_lk);
+    {
+        if (priv->flush_timer) {
+            gf_timer_call_cancel(this->ctx, priv->flush_timer);
+            priv->flush_timer = NULL;
+        }
+
+        for (i = 0; i < UPCALL_CLIENT_TABLE_SIZE; i++) {
+            list_for_each_entry_safe(rec, tmp, &priv->client_table[i],
+                                     hash_list)
+            {
+                __upcall_client_rec_free(rec);
+            }
+        }
+    }
+    UNLOCK(&priv->client_lk);
+
+    GF_FREE(priv->client_table);
+    priv->client_table = NULL;
+}
+
+/*
+ * Lookup the record of the client in the table, by the hash of its uid.
+ * A record is created on first use.
+ */
+static upcall_client_rec_t *
+__upcall_client_rec_get(upcall_private_t *priv, const char *client_uid,
+                        uint32_t client_hash, time_t now)
+{
+    upcall_client_rec_t *rec = NULL;
+    upcall_client_rec_t *tmp = NULL;
+    struct list_head *bucket = NULL;
+    int i = 0;
+
+    bucket = &priv->client_table[client_hash % UPCALL_CLIENT_TABLE_SIZE];
+
+    list_for_each_entry(tmp, bucket, hash_list)
+    {
+        if ((tmp->client_hash == client_hash) &&
+            !strcmp(tmp->client_uid, client_uid)) {
+            rec = tmp;
+            goto out;
+        }
+    }
+
+    rec = GF_CALLOC(1, sizeof(*rec), gf_upcall_mt_client_rec_t);
+    if (!rec)
+        goto out;
+
+    rec->client_uid = gf_strdup(client_uid);
+    if (!rec->client_uid) {
+        GF_FREE(rec);
+        rec = NULL;
+        goto out;
+    }
+    rec->client_hash = client_hash;
+    INIT_LIST_HEAD(&rec->hash_list);
+    LOCK_INIT(&rec->lock);
+    INIT_LIST_HEAD(&rec->pending);
+    for (i = 0; i < UPCALL_PENDING_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&rec->pending_hash[i]);
+    rec->since = now;
+    rec->dump_time = now;
+
+    list_add_tail(&rec->hash_list, bucket);
+out:
+    if (rec)
+        rec->last_seen = now;
+
+    return rec;
+}
+
+/*
+ * Client records are kept as long as the client entries of the inodes, i.e.
+ * 2 * cache_invalidation_timeout after the client was last notified.
+ */
+static void
+upcall_cleanup_expired_recs(xlator_t *this, time_t now)
+{
+    upcall_private_t *priv = NULL;
+    upcall_client_rec_t *rec = NULL;
+    upcall_client_rec_t *tmp = NULL;
+    time_t timeout = 0;
+    uint32_t pending = 0;
+    int i = 0;
+
+    priv = this->private;
+    GF_ASSERT(priv);
+
+    timeout = get_cache_invalidation_timeout(this);
+
+    LOCK(&priv->client_lk);
+    {
+        for (i = 0; i < UPCALL_CLIENT_TABLE_SIZE; i++) {
+            list_for_each_entry_safe(rec, tmp, &priv->client_table[i],
+                                     hash_list)
+            {
+                if ((now - rec->last_seen) <= 2 * timeout)
+                    continue;
+
+                /* a record is only used under priv->client_lk or with
+                 * its lock taken before priv->client_lk is released */
+                LOCK(&rec->lock);
+                pending = rec->nr_pending;
+                UNLOCK(&rec->lock);
+
+                if (pending)
+                    continue;
+
+                gf_log(this->name, GF_LOG_TRACE,
+                       "Cleaning up client record (%s)", rec->client_uid);
+                __upcall_client_rec_free(rec);
+            }
+        }
+    }
+    UNLOCK(&priv->client_lk);
+}
+
+/*
+ * Moves the invalidations queued for the client to a batch, which is sent
+ * by upcall_batch_send() once the locks are released. On failure, they
+ * stay queued for the next flush. Called with rec->lock held.
+ */
+static upcall_batch_t *
+__upcall_batch_take(upcall_client_rec_t *rec)
+{
+    upcall_batch_t *batch = NULL;
+    upcall_pending_inval_t *pend = NULL;
+
+    batch = GF_CALLOC(1, sizeof(*batch), gf_upcall_mt_batch_t);
+    if (!batch)
+        return NULL;
+
+    batch->client_uid = gf_strdup(rec->client_uid);
+    if (!batch->client_uid) {
+        GF_FREE(batch);
+        return NULL;
+    }
+    INIT_LIST_HEAD(&batch->list);
+    INIT_LIST_HEAD(&batch->pending);
+
+    list_for_each_entry(pend, &rec->pending, list)
+    {
+        list_del_init(&pend->hash);
+    }
+
+    list_splice_init(&rec->pending, &batch->pending);
+    batch->count = rec->nr_pending;
+    rec->nr_pending = 0;
+
+    rec->sent += batch->count;
+    rec->callbacks++;
+
+    return batch;
+}
+
+static void
+upcall_batch_send(xlator_t *this, upcall_batch_t *batch)
+{
+    struct gf_upcall up_req = {
+        0,
+    };
+    struct gf_upcall_cache_invalidation_batch ca_batch = {
+        0,
+    };
+    upcall_pending_inval_t *pend = NULL;
+    upcall_pending_inval_t *tmp = NULL;
+    struct gf_upcall *entries = NULL;
+    uint32_t i = 0;
+    int ret = -1;
+
+    entries = GF_CALLOC(batch->count, sizeof(*entries), gf_upcall_mt_batch_t);
+    if (!entries) {
+        gf_msg("upcall", GF_LOG_WARNING, 0, UPCALL_MSG_NO_MEMORY,
+               "Memory allocation failed, %u cache invalidations for %s "
+               "dropped",
+               batch->count, batch->client_uid);
+        goto out;
+    }
+
+    list_for_each_entry(pend, &batch->pending, list)
+    {
+        entries[i].client_uid = batch->client_uid;
+        gf_uuid_copy(entries[i].gfid, pend->gfid);
+        entries[i].event_type = GF_UPCALL_CACHE_INVALIDATION;
+        entries[i].data = &pend->ca;
+        i++;
+    }
+
+    ca_batch.count = i;
+    ca_batch.entries = entries;
+
+    up_req.client_uid = batch->client_uid;
+    up_req.event_type = GF_UPCALL_CACHE_INVALIDATION_BATCH;
+    up_req.data = &ca_batch;
+
+    gf_log(this->name, GF_LOG_TRACE, "%u cache invalidations sent to %s", i,
+           batch->client_uid);
+
+    /* as for single notifications, a client which went away is
+     * forgotten when its entries expire */
+    ret = this->notify(this, GF_EVENT_UPCALL, &up_req);
+    if (ret < 0)
+        gf_msg_debug(this->name, 0, "Failed to send %u invalidations to %s",
+                     i, batch->client_uid);
+
+out:
+    list_for_each_entry_safe(pend, tmp, &batch->pending, list)
+    {
+        __upcall_pending_free(pend);
+    }
+    GF_FREE(entries);
+    GF_FREE(batch->client_uid);
+    GF_FREE(batch);
+}
+
+/*
+ * Send whatever is queued, to all the clients.
+ */
+void
+upcall_flush_pending(xlator_t *this)
+{
+    upcall_private_t *priv = NULL;
+    upcall_client_rec_t *rec = NULL;
+    upcall_batch_t *batch = NULL;
+    upcall_batch_t *tmp = NULL;
+    struct list_head batches;
+    int i = 0;
+
+    priv = this->private;
+    if (!priv || !priv->client_table)
+        return;
+
+    INIT_LIST_HEAD(&batches);
+
+    LOCK(&priv->client_lk);
+    {
+        for (i = 0; i < UPCALL_CLIENT_TABLE_SIZE; i++) {
+            list_for_each_entry(rec, &priv->client_table[i], hash_list)
+            {
+                batch = NULL;
+
+                LOCK(&rec->lock);
+                {
+                    if (rec->nr_pending)
+                        batch = __upcall_batch_take(rec);
+                }
+                UNLOCK(&rec->lock);
+
+                if (batch)
+                    list_add_tail(&batch->list, &batches);
+            }
+        }
+    }
+    UNLOCK(&priv->client_lk);
+
+    list_for_each_entry_safe(batch, tmp, &batches, list)
+    {
+        list_del_init(&batch->list);
+        upcall_batch_send(this, batch);
+    }
+}
+
+static void
+upcall_flush_timer_cbk(void *data)
+{
+    xlator_t *this = data;
+    upcall_private_t *priv = NULL;
+
+    priv = this->private;
+    if (!priv)
+        return;
+
+    LOCK(&priv->client_lk);
+    {
+        priv->flush_timer = NULL;
+    }
+    UNLOCK(&priv->client_lk);
+
+    upcall_flush_pending(this);
+}
+
+static void
+__upcall_flush_timer_arm(xlator_t *this, upcall_private_t *priv)
+{
+    struct timespec delta = {
+        0,
+    };
+
+    if (priv->flush_timer || priv->fini)
+        return;
+
+    delta.tv_sec = priv->batch_window / 1000;
+    delta.tv_nsec = (priv->batch_window % 1000) * 1000000;
+
+    priv->flush_timer = gf_timer_call_after(this->ctx, delta,
+                                            upcall_flush_timer_cbk, this);
+    if (!priv->flush_timer)
+        gf_msg("upcall", GF_LOG_WARNING, 0, UPCALL_MSG_INTERNAL_ERROR,
+               "Failed to arm the cache invalidation flush timer");
+}
+
+/*
+ * Merge an invalidation into the one queued for the same gfid: the flags
+ * add up and the latest attributes win.
+ */
+static void
+upcall_pending_merge(upcall_pending_inval_t *pend, uint32_t flags,
+                     struct iatt *stbuf, struct iatt *p_stbuf,
+                     struct iatt *oldp_stbuf, dict_t *xattr,
+                     uint32_t expire_time_attr)
+{
+    uint32_t xattr_flags = 0;
+
+    xattr_flags = (pend->ca.flags | flags) & (UP_XATTR | UP_XATTR_RM);
+
+    pend->ca.flags |= flags;
+    pend->ca.expire_time_attr = expire_time_attr;
+    if (stbuf)
+        pend->ca.stat = *stbuf;
+    if (p_stbuf)
+        pend->ca.p_stat = *p_stbuf;
+    if (oldp_stbuf)
+        pend->ca.oldp_stat = *oldp_stbuf;
+
+    /* xattrs set and removed can't be told apart in a single dict, let
+     * the client look them up again */
+    if (xattr_flags == (UP_XATTR | UP_XATTR_RM)) {
+        pend->ca.flags &= ~(UP_XATTR | UP_XATTR_RM);
+        pend->ca.flags |= UP_INVAL_ATTR;
+        if (pend->ca.dict) {
+            dict_unref(pend->ca.dict);
+            pend->ca.dict = NULL;
+        }
+        return;
+    }
+
+    if (!xattr || (pend->ca.flags & UP_INVAL_ATTR))
+        return;
+
+    if (pend->ca.dict)
+        dict_copy(xattr, pend->ca.dict);
+    else
+        pend->ca.dict = dict_copy_with_ref(xattr, NULL);
+}
+
+/*
+ * Queue the invalidation for the client, collapsing it with the one already
+ * queued for the same gfid. The queue is sent when it is batch_size long or
+ * after batch_window msecs, whichever comes first.
+ */
+static void
+upcall_client_queue_invalidate(xlator_t *this, uuid_t gfid,
+                               upcall_client_t *up_client_entry,
+                               uint32_t flags, struct iatt *stbuf,
+                               struct iatt *p_stbuf, struct iatt *oldp_stbuf,
+                               dict_t *xattr, time_t now)
+{
+    upcall_private_t *priv = NULL;
+    upcall_client_rec_t *rec = NULL;
+    upcall_pending_inval_t *pend = NULL;
+    upcall_pending_inval_t *tmp = NULL;
+    upcall_batch_t *batch = NULL;
+    struct list_head *bucket = NULL;
+    gf_boolean_t arm = _gf_false;
+
+    priv = this->private;
+    GF_ASSERT(priv);
+
+    /* the table lock is only held to find the record: the queue is under
+     * the lock of the client, taken before the table lock is released so
+     * that the record can't be reaped meanwhile */
+    LOCK(&priv->client_lk);
+    rec = __upcall_client_rec_get(priv, up_client_entry->client_uid,
+                                  up_client_entry->client_hash, now);
+    if (rec)
+        LOCK(&rec->lock);
+    UNLOCK(&priv->client_lk);
+
+    if (!rec)
+        return;
+
+    rec->queued++;
+
+    bucket = &rec->pending_hash[(gfid[15] + (gfid[14] << 8)) %
+                                UPCALL_PENDING_HASH_SIZE];
+    list_for_each_entry(tmp, bucket, hash)
+    {
+        if (!gf_uuid_compare(tmp->gfid, gfid)) {
+            pend = tmp;
+            break;
+        }
+    }
+
+    if (pend) {
+        upcall_pending_merge(pend, flags, stbuf, p_stbuf, oldp_stbuf, xattr,
+                             up_client_entry->expire_time_attr);
+        rec->collapsed++;
+        goto unlock;
+    }
+
+    pend = GF_CALLOC(1, sizeof(*pend), gf_upcall_mt_pending_inval_t);
+    if (!pend)
+        goto unlock;
+
+    INIT_LIST_HEAD(&pend->list);
+    INIT_LIST_HEAD(&pend->hash);
+    gf_uuid_copy(pend->gfid, gfid);
+    pend->ca.flags = flags;
+    pend->ca.expire_time_attr = up_client_entry->expire_time_attr;
+    if (stbuf)
+        pend->ca.stat = *stbuf;
+    if (p_stbuf)
+        pend->ca.p_stat = *p_stbuf;
+    if (oldp_stbuf)
+        pend->ca.oldp_stat = *oldp_stbuf;
+    if (xattr)
+        pend->ca.dict = dict_copy_with_ref(xattr, NULL);
+
+    list_add_tail(&pend->list, &rec->pending);
+    list_add(&pend->hash, bucket);
+    rec->nr_pending++;
+
+    /* the timer flushes all the clients, it only needs arming when
+     * a queue stops being empty */
+    if (rec->nr_pending >= priv->batch_size)
+        batch = __upcall_batch_take(rec);
+    else if (rec->nr_pending == 1)
+        arm = _gf_true;
+unlock:
+    UNLOCK(&rec->lock);
+
+    if (arm) {
+        LOCK(&priv->client_lk);
+        __upcall_flush_timer_arm(this, priv);
+        UNLOCK(&priv->client_lk);
+    }
+
+    if (batch)
+        upcall_batch_send(this, batch);
+}
+
+/*
+ * Account a notification sent right away in the client record.
+ */
+static void
+upcall_client_rec_account(xlator_t *this, upcall_client_t *up_client_entry,
+                          time_t now)
+{
+    upcall_private_t *priv = NULL;
+    upcall_client_rec_t *rec = NULL;
+
+    priv = this->private;
+    GF_ASSERT(priv);
+
+    LOCK(&priv->client_lk);
+    rec = __upcall_client_rec_get(priv, up_client_entry->client_uid,
+                                  up_client_entry->client_hash, now);
+    if (rec)
+        LOCK(&rec->lock);
+    UNLOCK(&priv->client_lk);
+
+    if (!rec)
+        return;
+
+    rec->queued++;
+    rec->sent++;
+    rec->callbacks++;
+    UNLOCK(&rec->lock);
+}
+
 /*
  * Traverse through the list of upcall_inode_ctx(s),
  * cleanup the expired client entries and destroy the ctx
@@ -341,6 +887,8 @@ upcall_reaper_thread(void *data)
             inode_ctx = NULL;
         }
 
+        upcall_cleanup_expired_recs(this, time_now);
+
         /* don't do a very busy loop */
         timeout = get_cache_invalidation_timeout(this);
         sleep(timeout / 2);
@@ -480,6 +1028,7 @@ upcall_cache_invalidate(call_frame_t *frame, xlator_t *this, client_t *client,
     gf_boolean_t found = _gf_false;
     time_t time_now;
     inode_t *linked_inode = NULL;
+    uint32_t client_hash = 0;
 
     if (!is_upcall_enabled(this))
         return;
@@ -533,6 +1082,8 @@ upcall_cache_invalidate(call_frame_t *frame, xlator_t *this, client_t *client,
         goto out;
     }
 
+    client_hash = upcall_client_hash(client->client_uid);
+
     time_now = time(NULL);
     pthread_mutex_lock(&up_inode_ctx->client_list_lock);
     {
@@ -540,7 +1091,8 @@ upcall_cache_invalidate(call_frame_t *frame, xlator_t *this, client_t *client,
                                  &up_inode_ctx->client_list, client_list)
         {
             /* Do not send UPCALL event if same client. */
-            if (!strcmp(client->client_uid, up_client_entry->client_uid)) {
+            if ((up_client_entry->client_hash == client_hash) &&
+                !strcmp(client->client_uid, up_client_entry->client_uid)) {
                 up_client_entry->access_time = time_now;
                 found = _gf_true;
                 continue;
@@ -569,8 +1121,8 @@ upcall_cache_invalidate(call_frame_t *frame, xlator_t *this, client_t *client,
         }
 
         if (!found) {
-            up_client_entry = __add_upcall_client(frame, client, up_inode_ctx,
-                                                  time_now);
+            up_client_entry = __add_upcall_client(frame, client, client_hash,
+                                                  up_inode_ctx, time_now);
         }
     }
     pthread_mutex_unlock(&up_inode_ctx->client_list_lock);
@@ -598,6 +1150,7 @@ upcall_client_cache_invalidate(xlator_t *this, uuid_t gfid,
     struct gf_upcall_cache_invalidation ca_req = {
         0,
     };
+    upcall_private_t *priv = this->private;
     time_t timeout = 0;
     int ret = -1;
     time_t t_expired = now - up_client_entry->access_time;
@@ -606,7 +1159,10 @@ upcall_client_cache_invalidate(xlator_t *this, uuid_t gfid,
                         !(gf_uuid_is_null(gfid)), out);
     timeout = get_cache_invalidation_timeout(this);
 
-    if (t_expired < timeout) {
+    if ((t_expired < timeout) && priv->batch_window) {
+        upcall_client_queue_invalidate(this, gfid, up_client_entry, flags,
+                                       stbuf, p_stbuf, oldp_stbuf, xattr, now);
+    } else if (t_expired < timeout) {
         /* Send notify call */
         up_req.client_uid = up_client_entry->client_uid;
         gf_uuid_copy(up_req.gfid, gfid);
@@ -637,6 +1193,8 @@ upcall_client_cache_invalidate(xlator_t *this, uuid_t gfid,
          */
         if (ret < 0)
             __upcall_cleanup_client_entry(up_client_entry);
+        else
+            upcall_client_rec_account(this, up_client_entry, now);
 
     } else {
         gf_log(THIS->name, GF_LOG_TRACE,
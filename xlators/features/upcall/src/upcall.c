@@ -2214,6 +2214,76 @@ wind:
     return 0;
 }
 
+static int32_t
+upcall_priv_dump(xlator_t *this)
+{
+    upcall_private_t *priv = NULL;
+    upcall_client_rec_t *rec = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    time_t now = 0;
+    time_t elapsed = 0;
+    int i = 0;
+    int count = 0;
+
+    priv = this->private;
+    if (!priv)
+        goto out;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.features.upcall", "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("cache-invalidation", "%d",
+                       priv->cache_invalidation_enabled);
+    gf_proc_dump_write("cache-invalidation-timeout", "%d",
+                       priv->cache_invalidation_timeout);
+    gf_proc_dump_write("cache-invalidation-batch-window", "%u",
+                       priv->batch_window);
+    gf_proc_dump_write("cache-invalidation-batch-size", "%u",
+                       priv->batch_size);
+
+    if (TRY_LOCK(&priv->client_lk))
+        goto out;
+    {
+        now = time(NULL);
+        for (i = 0; i < UPCALL_CLIENT_TABLE_SIZE; i++) {
+            list_for_each_entry(rec, &priv->client_table[i], hash_list)
+            {
+                gf_proc_dump_build_key(key_prefix,
+                                       "xlator.features.upcall.client", "%d",
+                                       count++);
+                gf_proc_dump_add_section("%s", key_prefix);
+
+                LOCK(&rec->lock);
+                gf_proc_dump_write("client-uid", "%s", rec->client_uid);
+                gf_proc_dump_write("pending", "%u", rec->nr_pending);
+                gf_proc_dump_write("queued", "%" PRIu64, rec->queued);
+                gf_proc_dump_write("collapsed", "%" PRIu64, rec->collapsed);
+                gf_proc_dump_write("sent", "%" PRIu64, rec->sent);
+                gf_proc_dump_write("callbacks", "%" PRIu64, rec->callbacks);
+
+                elapsed = now - rec->since;
+                gf_proc_dump_write("sent-per-sec", "%.2f",
+                                   elapsed ? (double)rec->sent / elapsed
+                                           : (double)rec->sent);
+
+                /* rate since the previous statedump */
+                elapsed = now - rec->dump_time;
+                gf_proc_dump_write(
+                    "sent-per-sec-since-last-dump", "%.2f",
+                    elapsed ? (double)(rec->sent - rec->dump_sent) / elapsed
+                            : (double)(rec->sent - rec->dump_sent));
+                rec->dump_time = now;
+                rec->dump_sent = rec->sent;
+                UNLOCK(&rec->lock);
+            }
+        }
+    }
+    UNLOCK(&priv->client_lk);
+
+out:
+    return 0;
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
@@ -2227,9 +2297,17 @@ reconfigure(xlator_t *this, dict_t *options)
                      options, bool, out);
     GF_OPTION_RECONF("cache-invalidation-timeout",
                      priv->cache_invalidation_timeout, options, int32, out);
+    GF_OPTION_RECONF("cache-invalidation-batch-window", priv->batch_window,
+                     options, uint32, out);
+    GF_OPTION_RECONF("cache-invalidation-batch-size", priv->batch_size,
+                     options, uint32, out);
 
     ret = 0;
 
+    /* do not hold back what was queued with the previous window */
+    if (!priv->batch_window || !priv->cache_invalidation_enabled)
+        upcall_flush_pending(this);
+
     if (priv->cache_invalidation_enabled && !priv->reaper_init_done) {
         ret = upcall_reaper_thread_init(this);
 
@@ -2264,14 +2342,26 @@ init(xlator_t *this)
                    out);
     GF_OPTION_INIT("cache-invalidation-timeout",
                    priv->cache_invalidation_timeout, int32, out);
+    GF_OPTION_INIT("cache-invalidation-batch-window", priv->batch_window,
+                   uint32, out);
+    GF_OPTION_INIT("cache-invalidation-batch-size", priv->batch_size, uint32,
+                   out);
 
     LOCK_INIT(&priv->inode_ctx_lk);
     INIT_LIST_HEAD(&priv->inode_ctx_list);
+    LOCK_INIT(&priv->client_lk);
 
     priv->fini = 0;
     priv->reaper_init_done = _gf_false;
 
     this->private = priv;
+    ret = upcall_client_table_init(this);
+    if (ret) {
+        this->private = NULL;
+        LOCK_DESTROY(&priv->client_lk);
+        LOCK_DESTROY(&priv->inode_ctx_lk);
+        goto out;
+    }
     this->local_pool = mem_pool_new(upcall_local_t, 512);
     ret = 0;
 
@@ -2316,8 +2406,12 @@ fini(xlator_t *this)
         priv->reaper_init_done = _gf_false;
     }
 
+    /* the notifications still queued are dropped */
+    upcall_client_table_cleanup(this, priv);
+
     dict_unref(priv->xattrs);
     LOCK_DESTROY(&priv->inode_ctx_lk);
+    LOCK_DESTROY(&priv->client_lk);
 
     /* Do we need to cleanup the inode_ctxs? IMO not required
      * as inode_forget would have been done on all the inodes
@@ -2467,6 +2561,10 @@ struct xlator_cbks cbks = {
     .release = upcall_release,
 };
 
+struct xlator_dumpops dumpops = {
+    .priv = upcall_priv_dump,
+};
+
 struct volume_options options[] = {
     {
         .key = {"cache-invalidation"},
@@ -2487,6 +2585,31 @@ struct volume_options options[] = {
      .op_version = {GD_OP_VERSION_3_7_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
      .tags = {"cache", "cachetimeout", "upcall"}},
+    {.key = {"cache-invalidation-batch-window"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 1000,
+     .default_value = "0",
+     .description = "Time in milliseconds cache-invalidation"
+                    " notifications are held for each client, so that the"
+                    " ones for the same file are collapsed and all of them"
+                    " are sent in one callback. 0 sends every notification"
+                    " right away.",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"cache", "upcall"}},
+    {.key = {"cache-invalidation-batch-size"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 4096,
+     .default_value = "256",
+     .description = "Maximum number of cache-invalidation notifications"
+                    " sent to a client in one callback. The notifications"
+                    " held for a client are sent as soon as there are this"
+                    " many of them.",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"cache", "upcall"}},
     {.key = {NULL}},
 };
 
@@ -2499,6 +2622,7 @@ xlator_api_t xlator_api = {
     .op_version = {1}, /* Present from the initial version */
     .fops = &fops,
     .cbks = &cbks,
+    .dumpops = &dumpops,
     .options = options,
     .identifier = "upcall",
     .category = GF_MAINTAINED,
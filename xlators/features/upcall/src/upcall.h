@@ -16,6 +16,13 @@
 #include "upcall-messages.h"
 #include "upcall-cache-invalidation.h"
 #include <glusterfs/upcall-utils.h>
+#include <glusterfs/timer.h>
+
+/* buckets of the table of clients, indexed by the hash of their uid */
+#define UPCALL_CLIENT_TABLE_SIZE 128
+
+/* buckets of the invalidations queued for a client, by gfid */
+#define UPCALL_PENDING_HASH_SIZE 64
 
 #define EXIT_IF_UPCALL_OFF(this, label)                                        \
     do {                                                                       \
@@ -57,13 +64,55 @@ struct _upcall_private {
     int32_t fini;
     dict_t *xattrs; /* list of xattrs registered by clients
                        for receiving invalidation */
+
+    /* invalidations are queued per client for batch_window msecs and
+     * sent batch_size at most at a time, 0 sends them right away */
+    uint32_t batch_window;
+    uint32_t batch_size;
+    gf_lock_t client_lk; /* protects client_table and flush_timer, taken
+                            before the lock of a client record */
+    struct list_head *client_table; /* upcall_client_rec_t */
+    gf_timer_t *flush_timer;
 };
 typedef struct _upcall_private upcall_private_t;
 
+/* One per client notified by this brick, in priv->client_table */
+struct _upcall_client_rec {
+    struct list_head hash_list;
+    char *client_uid;
+    uint32_t client_hash;
+    time_t last_seen; /* under priv->client_lk */
+
+    gf_lock_t lock; /* protects the queue and the counters */
+    struct list_head pending; /* upcall_pending_inval_t, in queue order */
+    struct list_head pending_hash[UPCALL_PENDING_HASH_SIZE];
+    uint32_t nr_pending;
+
+    /* shown in the statedump */
+    time_t since;
+    uint64_t queued;    /* invalidations for this client */
+    uint64_t collapsed; /* merged with one already queued */
+    uint64_t sent;      /* invalidations sent */
+    uint64_t callbacks; /* callbacks sent */
+    time_t dump_time;   /* sent at the previous statedump */
+    uint64_t dump_sent;
+};
+typedef struct _upcall_client_rec upcall_client_rec_t;
+
+/* An invalidation waiting in upcall_client_rec_t->pending */
+struct _upcall_pending_inval {
+    struct list_head list;
+    struct list_head hash; /* in upcall_client_rec_t->pending_hash */
+    uuid_t gfid;
+    struct gf_upcall_cache_invalidation ca;
+};
+typedef struct _upcall_pending_inval upcall_pending_inval_t;
+
 struct _upcall_client {
     struct list_head client_list;
     /* strdup to store client_uid, strdup. Free it explicitly */
     char *client_uid;
+    uint32_t client_hash;
     time_t access_time; /* time last accessed */
     /* the amount of time which client can cache this entry */
     uint32_t expire_time_attr;
@@ -110,6 +159,15 @@ upcall_reaper_thread(void *data);
 int
 upcall_reaper_thread_init(xlator_t *this);
 
+uint32_t
+upcall_client_hash(const char *client_uid);
+int
+upcall_client_table_init(xlator_t *this);
+void
+upcall_client_table_cleanup(xlator_t *this, upcall_private_t *priv);
+void
+upcall_flush_pending(xlator_t *this);
+
 /* Xlator options */
 gf_boolean_t
 is_upcall_enabled(xlator_t *this);
@@ -2801,6 +2801,18 @@ perfxl_option_handler(volgen_graph_t *graph, struct volopt_map_entry *vme,
         (vme->op_version > volinfo->client_op_version))
         return 0;
 
+    if (!strcmp(vme->key, "performance.disk-cache") &&
+        (vme->op_version > volinfo->client_op_version))
+        return 0;
+
+    if (!strcmp(vme->key, "performance.stat-ahead") &&
+        (vme->op_version > volinfo->client_op_version))
+        return 0;
+
+    if (!strcmp(vme->key, "performance.cache-leases") &&
+        (vme->op_version > volinfo->client_op_version))
+        return 0;
+
     if (priv->op_version < GD_OP_VERSION_3_12_2) {
         /* For replicate volumes do not load io-threads as it affects
          * performance
@@ -4414,6 +4426,14 @@ bitrot_option_handler(volgen_graph_t *graph, struct volopt_map_entry *vme,
             return -1;
     }
 
+    if (!strcmp(vme->option, "signature-type") ||
+        !strcmp(vme->option, "chunk-size") ||
+        !strcmp(vme->option, "hash-threads")) {
+        ret = xlator_set_fixed_option(xl, vme->option, vme->value);
+        if (ret)
+            return -1;
+    }
+
     return ret;
 }
 
@@ -4438,6 +4458,15 @@ scrubber_option_handler(volgen_graph_t *graph, struct volopt_map_entry *vme,
             return -1;
     }
 
+    if (!strcmp(vme->option, "hash-threads") ||
+        !strcmp(vme->option, "scrub-rate") ||
+        !strcmp(vme->option, "scrub-deadline") ||
+        !strcmp(vme->option, "scrub-max-latency")) {
+        ret = xlator_set_fixed_option(xl, vme->option, vme->value);
+        if (ret)
+            return -1;
+    }
+
     if (!strcmp(vme->option, "scrubber")) {
         if (!strcmp(vme->value, "pause")) {
             ret = xlator_set_fixed_option(xl, "scrub-state", vme->value);
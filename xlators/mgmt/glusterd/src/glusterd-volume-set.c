@@ -1231,6 +1231,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "performance/io-cache",
      .op_version = 1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.io-cache-lockless-read",
+     .voltype = "performance/io-cache",
+     .option = "lockless-read",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
 
     /* IO-threads xlator options */
     {.key = "performance.io-thread-count",
@@ -1266,6 +1271,69 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .op_version = GD_OP_VERSION_4_1_0},
 
     /* Other perf xlators' options */
+    {.key = "performance.disk-cache-dir",
+     .voltype = "performance/disk-cache",
+     .option = "cache-dir",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-size",
+     .voltype = "performance/disk-cache",
+     .option = "cache-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-block-size",
+     .voltype = "performance/disk-cache",
+     .option = "block-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-timeout",
+     .voltype = "performance/disk-cache",
+     .option = "cache-timeout",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-ctime-invalidation",
+     .voltype = "performance/disk-cache",
+     .option = "ctime-invalidation",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.stat-ahead-cache-size",
+     .voltype = "performance/stat-ahead",
+     .option = "cache-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.stat-ahead-window",
+     .voltype = "performance/stat-ahead",
+     .option = "window",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.stat-ahead-inflight",
+     .voltype = "performance/stat-ahead",
+     .option = "max-inflight",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.stat-ahead-timeout",
+     .voltype = "performance/stat-ahead",
+     .option = "timeout",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.stat-ahead-pass-through",
+     .voltype = "performance/stat-ahead",
+     .option = "pass-through",
+     .op_version = GD_OP_VERSION_8_0},
+    {.key = "performance.cache-leases-threshold",
+     .voltype = "performance/cache-leases",
+     .option = "threshold",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.cache-leases-max",
+     .voltype = "performance/cache-leases",
+     .option = "max-leases",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.cache-leases-pass-through",
+     .voltype = "performance/cache-leases",
+     .option = "pass-through",
+     .op_version = GD_OP_VERSION_8_0},
     {.key = "performance.io-cache-pass-through",
      .voltype = "performance/io-cache",
      .option = "pass-through",
@@ -1290,6 +1358,21 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "ctime-invalidation",
      .op_version = GD_OP_VERSION_5_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.qr-head-size",
+     .voltype = "performance/quick-read",
+     .option = "head-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.qr-cache-admission",
+     .voltype = "performance/quick-read",
+     .option = "cache-admission",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.qr-cache-compression",
+     .voltype = "performance/quick-read",
+     .option = "cache-compression",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.flush-behind",
      .voltype = "performance/write-behind",
      .option = "flush-behind",
@@ -1355,6 +1438,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "aggregate-size",
      .op_version = GD_OP_VERSION_4_1_0,
      .flags = OPT_FLAG_CLIENT_OPT},
+    {.key = "performance.write-behind-aggregate-mode",
+     .voltype = "performance/write-behind",
+     .option = "aggregate-mode",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.write-behind-dirty-budget",
+     .voltype = "performance/write-behind",
+     .option = "dirty-budget",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.nfs.write-behind-trickling-writes",
      .voltype = "performance/write-behind",
      .option = "trickling-writes",
@@ -1370,6 +1463,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "read-after-open",
      .op_version = 3,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.open-behind-anonymous-fops",
+     .voltype = "performance/open-behind",
+     .option = "anonymous-fops",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.open-behind-batch-size",
+     .voltype = "performance/open-behind",
+     .option = "open-batch-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "performance.open-behind-pass-through",
         .voltype = "performance/open-behind",
@@ -1381,6 +1484,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "page-count",
      .op_version = 1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.read-ahead-stream-count",
+     .voltype = "performance/read-ahead",
+     .option = "stream-count",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.read-ahead-cache-size",
+     .voltype = "performance/read-ahead",
+     .option = "cache-size",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "performance.read-ahead-pass-through",
         .voltype = "performance/read-ahead",
@@ -1718,6 +1831,17 @@ struct volopt_map_entry glusterd_volopt_map[] = {
     },
 
     /* Performance xlators enable/disbable options */
+    {.key = "performance.cache-leases",
+     .voltype = "performance/cache-leases",
+     .option = "!perf",
+     .value = "off",
+     .op_version = GD_OP_VERSION_8_0,
+     .description = "enable/disable the cache-leases translator in the "
+                    "volume. It takes read leases on the files and "
+                    "directories revalidated often, md-cache and io-cache "
+                    "keep them cached while the leases are held. Needs "
+                    "features.leases on.",
+     .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
     {.key = "performance.write-behind",
      .voltype = "performance/write-behind",
      .option = "!perf",
@@ -1740,6 +1864,15 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .op_version = 3,
      .description = "enable/disable readdir-ahead translator in the volume.",
      .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
+    {.key = "performance.disk-cache",
+     .voltype = "performance/disk-cache",
+     .option = "!perf",
+     .value = "off",
+     .op_version = GD_OP_VERSION_8_0,
+     .description = "enable/disable the persistent disk cache translator "
+                    "in the volume. Data read is kept in "
+                    "performance.disk-cache-dir across remounts.",
+     .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
     {.key = "performance.io-cache",
      .voltype = "performance/io-cache",
      .option = "!perf",
@@ -1780,6 +1913,15 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .description = "enable/disable meta-data caching translator in the "
                     "volume.",
      .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
+    {.key = "performance.stat-ahead",
+     .voltype = "performance/stat-ahead",
+     .option = "!perf",
+     .value = "off",
+     .op_version = GD_OP_VERSION_8_0,
+     .description = "enable/disable the stat-ahead translator in the "
+                    "volume. It prefetches the subdirectories of a tree "
+                    "being walked into md-cache.",
+     .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
     {.key = "performance.client-io-threads",
      .voltype = "performance/io-threads",
      .option = "!perf",
@@ -1964,6 +2106,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = 2,
         .validate_fn = validate_quota,
     },
+    {
+        .key = "features.quota-lease-size",
+        .voltype = "features/quota",
+        .option = "lease-size",
+        .value = "0",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Space reserved from quotad at a time for the writes "
+                       "under a directory with a limit. Writes spend the "
+                       "reservation without checking the limit with quotad. "
+                       "0 disables space reservation.",
+    },
+    {
+        .key = "features.quota-lease-timeout",
+        .voltype = "features/quota",
+        .option = "lease-timeout",
+        .value = "10",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Time after which the unspent part of a space "
+                       "reservation is given back to quotad.",
+    },
 
     /* Marker xlator options */
     {.key = VKEY_MARKER_XTIME,
@@ -2008,6 +2170,37 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .type = NO_DOC,
      .flags = VOLOPT_FLAG_NEVER_RESET,
      .op_version = 1},
+    {
+        .key = "features.quota-update-delay",
+        .voltype = "features/marker",
+        .option = "quota-update-delay",
+        .value = "0",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Seconds by which the update of the ancestors of a "
+                       "directory is delayed, so that the updates of the fops "
+                       "under it are propagated together. 0 propagates every "
+                       "update right away.",
+    },
+    {
+        .key = "features.quota-update-batch",
+        .voltype = "features/marker",
+        .option = "quota-update-batch",
+        .value = "1024",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Number of directories with delayed updates after "
+                       "which the updates are propagated without waiting for "
+                       "quota-update-delay.",
+    },
+    {
+        .key = "features.quota-update-threshold",
+        .voltype = "features/marker",
+        .option = "quota-update-threshold",
+        .value = "64MB",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Change in the size of a directory after which its "
+                       "delayed updates are propagated without waiting for "
+                       "quota-update-delay. 0 for no limit.",
+    },
     {.key = VKEY_FEATURES_BITROT,
      .voltype = "features/bit-rot",
      .option = "bitrot",
@@ -2412,6 +2605,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .voltype = "storage/posix",
         .op_version = GD_OP_VERSION_4_0_0,
     },
+    {
+        .option = "handle-cache-size",
+        .key = "storage.handle-cache-size",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_8_0,
+    },
     {
         .option = "ctime",
         .key = "features.ctime",
@@ -2476,6 +2675,15 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "features/changelog",
      .type = NO_DOC,
      .op_version = 3},
+    {.key = "changelog.journal-group-commit",
+     .voltype = "features/changelog",
+     .op_version = GD_OP_VERSION_8_0},
+    {.key = "changelog.journal-commit-delay",
+     .voltype = "features/changelog",
+     .op_version = GD_OP_VERSION_8_0},
+    {.key = "changelog.journal-commit-batch",
+     .voltype = "features/changelog",
+     .op_version = GD_OP_VERSION_8_0},
     {
         .key = "features.barrier",
         .voltype = "features/barrier",
@@ -2603,6 +2811,30 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "features/shard",
      .op_version = GD_OP_VERSION_5_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-size-update-mode",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-size-update-interval",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-size-update-batch",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-prefetch-count",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-per-file-inode-cache",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-deletion-max-rate",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "features.scrub-throttle",
         .voltype = "features/bit-rot",
@@ -2635,6 +2867,61 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_3_7_0,
         .type = NO_DOC,
     },
+    {
+        .key = "features.scrub-rate",
+        .voltype = "features/bit-rot",
+        .value = "0",
+        .option = "scrub-rate",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Bytes per second the scrubber aims at, 0 for no "
+                       "limit other than the scrub-throttle.",
+    },
+    {
+        .key = "features.scrub-deadline",
+        .voltype = "features/bit-rot",
+        .value = "0",
+        .option = "scrub-deadline",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Time a scrub pass should take at most (e.g. 72h), "
+                       "0 for none.",
+    },
+    {
+        .key = "features.scrub-max-latency",
+        .voltype = "features/bit-rot",
+        .value = "0",
+        .option = "scrub-max-latency",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Average read latency (msec) from the bricks above "
+                       "which the scrubber slows down, 0 to disable.",
+    },
+    {
+        .key = "features.bitrot-signature-type",
+        .voltype = "features/bit-rot",
+        .value = "sha256",
+        .option = "signature-type",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Signature computed by the signer: \"sha256\" of "
+                       "the whole object, or \"merkle-sha256\" to hash it "
+                       "in chunks, in parallel, and only rehash modified "
+                       "chunks when it is signed again.",
+    },
+    {
+        .key = "features.bitrot-chunk-size",
+        .voltype = "features/bit-rot",
+        .value = "1MB",
+        .option = "chunk-size",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Smallest chunk size of merkle signatures.",
+    },
+    {
+        .key = "features.bitrot-hash-threads",
+        .voltype = "features/bit-rot",
+        .value = "4",
+        .option = "hash-threads",
+        .op_version = GD_OP_VERSION_8_0,
+        .description = "Number of threads of the signer and of the "
+                       "scrubber hashing chunks of merkle signed objects.",
+    },
     /* Upcall translator options */
     {
         .key = "features.cache-invalidation",
@@ -2647,6 +2934,27 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .voltype = "features/upcall",
         .op_version = GD_OP_VERSION_3_7_0,
     },
+    {
+        .key = "features.cache-invalidation-batch-window",
+        .voltype = "features/upcall",
+        .op_version = GD_OP_VERSION_8_0,
+    },
+    {
+        .key = "features.cache-invalidation-batch-size",
+        .voltype = "features/upcall",
+        .op_version = GD_OP_VERSION_8_0,
+    },
+    /* Index xlator options */
+    {
+        .key = "features.index-delay",
+        .voltype = "features/index",
+        .op_version = GD_OP_VERSION_8_0,
+    },
+    {
+        .key = "features.index-delay-batch",
+        .voltype = "features/index",
+        .op_version = GD_OP_VERSION_8_0,
+    },
     /* Lease translator options */
     {
         .key = "features.leases",
@@ -2692,6 +3000,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/replicate",
      .op_version = GD_OP_VERSION_3_7_12,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.shd-heal-scheduler",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.locking-scheme",
      .voltype = "cluster/replicate",
      .type = DOC,
@@ -2748,6 +3060,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_9_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.shd-heal-scheduler",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_8_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "disperse.cpu-extensions",
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_9_0,
@@ -2805,6 +3121,15 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .flags = VOLOPT_FLAG_CLIENT_OPT,
      .op_version = GD_OP_VERSION_3_9_1,
      .validate_fn = validate_rda_cache_limit},
+    {
+        .key = "performance.rda-listing-timeout",
+        .voltype = "performance/readdir-ahead",
+        .option = "rda-listing-timeout",
+        .value = "0",
+        .type = DOC,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+        .op_version = GD_OP_VERSION_8_0,
+    },
     {
         .key = "performance.nl-cache-positive-entry",
         .voltype = "performance/nl-cache",
@@ -2828,6 +3153,13 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .flags = VOLOPT_FLAG_CLIENT_OPT,
         .op_version = GD_OP_VERSION_3_11_0,
     },
+    {
+        .key = "performance.nl-cache-complete-dir",
+        .voltype = "performance/nl-cache",
+        .option = "nl-cache-complete-dir",
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+        .op_version = GD_OP_VERSION_8_0,
+    },
 
     /* Brick multiplexing options */
     {.key = GLUSTERD_BRICK_MULTIPLEX_KEY,
@@ -0,0 +1,1166 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+/*
+ * cache-leases: read leases for the client caches
+ *
+ * md-cache and io-cache trust what they cached for a timeout, then ask the
+ * bricks again. Files and directories that are looked up or stat'ed over and
+ * over get a read lease from the bricks (features.leases). While the lease
+ * is held, the replies of their lookups and stats carry GF_CACHE_LEASE_KEY,
+ * and the caches above keep what they cached past their timeout. Before
+ * another client changes the inode, the bricks recall the lease: the caches
+ * above are told to drop the inode with a cache invalidation upcall, and the
+ * lease is given back.
+ *
+ * The xlator sits below all the other performance xlators, so that every
+ * fop of the mount, including those sent by write-behind or read-ahead,
+ * carries the lease id of the mount and does not break its own leases.
+ */
+
+#include "cache-leases.h"
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
+
+#define CL_STACK_WIND_STAMPED(fop, frame, this, xdata, params...)              \
+    do {                                                                       \
+        dict_t *__xdata = cl_stamp(this, xdata);                               \
+                                                                               \
+        STACK_WIND_TAIL(frame, FIRST_CHILD(this),                              \
+                        FIRST_CHILD(this)->fops->fop, params, __xdata);        \
+        if (__xdata)                                                           \
+            dict_unref(__xdata);                                               \
+    } while (0)
+
+static cl_inode_t *
+cl_inode_ctx(xlator_t *this, inode_t *inode)
+{
+    uint64_t value = 0;
+
+    if (inode_ctx_get(inode, this, &value))
+        return NULL;
+
+    return (cl_inode_t *)(uintptr_t)value;
+}
+
+static cl_inode_t *
+cl_inode_get(xlator_t *this, inode_t *inode)
+{
+    cl_inode_t *ctx = NULL;
+    uint64_t value = 0;
+
+    LOCK(&inode->lock);
+    {
+        __inode_ctx_get(inode, this, &value);
+        if (value) {
+            ctx = (cl_inode_t *)(uintptr_t)value;
+            goto unlock;
+        }
+
+        ctx = GF_CALLOC(1, sizeof(*ctx), gf_cl_mt_cl_inode_t);
+        if (ctx == NULL)
+            goto unlock;
+
+        INIT_LIST_HEAD(&ctx->held);
+
+        value = (uint64_t)(uintptr_t)ctx;
+        if (__inode_ctx_set(inode, this, &value) < 0) {
+            GF_FREE(ctx);
+            ctx = NULL;
+        }
+    }
+unlock:
+    UNLOCK(&inode->lock);
+
+    return ctx;
+}
+
+/* returns the inode ref of the lease dropped, if one was held */
+static inode_t *
+__cl_inode_drop(cl_private_t *priv, cl_inode_t *ctx)
+{
+    inode_t *inode = NULL;
+
+    if (ctx->state == CL_LEASE_REQUESTED) {
+        ctx->recalled = _gf_true;
+        return NULL;
+    }
+
+    if (ctx->state != CL_LEASE_HELD)
+        return NULL;
+
+    list_del_init(&ctx->held);
+    priv->held_count--;
+    ctx->state = CL_LEASE_NONE;
+
+    inode = ctx->inode;
+    ctx->inode = NULL;
+
+    return inode;
+}
+
+/* xdata with the lease id of the mount, to be unref'd */
+static dict_t *
+cl_stamp(xlator_t *this, dict_t *xdata)
+{
+    cl_private_t *priv = this->private;
+
+    if (!priv->supported)
+        return xdata ? dict_ref(xdata) : NULL;
+
+    if (xdata) {
+        dict_ref(xdata);
+        /* gfapi applications send their own */
+        if (dict_get_sizen(xdata, "lease-id"))
+            return xdata;
+    } else {
+        xdata = dict_new();
+        if (xdata == NULL)
+            return NULL;
+    }
+
+    if (dict_set_static_bin(xdata, "lease-id", priv->lease_id,
+                            LEASE_ID_SIZE))
+        gf_msg_debug(this->name, 0, "failed to set the lease id");
+
+    return xdata;
+}
+
+/* tells the caches above to drop what they cached under the lease */
+static void
+cl_invalidate(xlator_t *this, inode_t *inode)
+{
+    struct gf_upcall up_data = {
+        0,
+    };
+    struct gf_upcall_cache_invalidation up_ci = {
+        0,
+    };
+
+    up_ci.dict = dict_new();
+    if (up_ci.dict)
+        dict_set_int8(up_ci.dict, GF_CACHE_LEASE_KEY, 1);
+    up_ci.flags = UP_INVAL_ATTR;
+
+    gf_uuid_copy(up_data.gfid, inode->gfid);
+    up_data.event_type = GF_UPCALL_CACHE_INVALIDATION;
+    up_data.data = &up_ci;
+
+    default_notify(this, GF_EVENT_UPCALL, &up_data);
+
+    if (up_ci.dict)
+        dict_unref(up_ci.dict);
+}
+
+static int32_t
+cl_unlock_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct gf_lease *lease,
+              dict_t *xdata)
+{
+    /* the bricks revoke it when the recall times out */
+    if (op_ret < 0)
+        gf_msg(this->name, GF_LOG_WARNING, op_errno, CL_MSG_UNLOCK_FAILED,
+               "failed to give a lease back");
+
+    STACK_DESTROY(frame->root);
+    return 0;
+}
+
+static void
+cl_unlock(xlator_t *this, inode_t *inode)
+{
+    cl_private_t *priv = this->private;
+    call_frame_t *frame = NULL;
+    struct gf_lease lease = {
+        0,
+    };
+    loc_t loc = {
+        0,
+    };
+
+    frame = create_frame(this, this->ctx->pool);
+    if (frame == NULL) {
+        gf_msg(this->name, GF_LOG_WARNING, ENOMEM, CL_MSG_UNLOCK_FAILED,
+               "failed to give the lease on %s back",
+               uuid_utoa(inode->gfid));
+        return;
+    }
+
+    loc.inode = inode_ref(inode);
+    gf_uuid_copy(loc.gfid, inode->gfid);
+
+    lease.cmd = GF_UNLK_LEASE;
+    lease.lease_type = GF_RD_LEASE;
+    memcpy(lease.lease_id, priv->lease_id, LEASE_ID_SIZE);
+
+    GF_ATOMIC_INC(priv->released);
+
+    STACK_WIND(frame, cl_unlock_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lease, &loc, &lease, NULL);
+
+    loc_wipe(&loc);
+}
+
+/* gives a lease back, and drops the inode ref taken with it */
+static void
+cl_release(xlator_t *this, inode_t *inode)
+{
+    cl_invalidate(this, inode);
+    cl_unlock(this, inode);
+    inode_unref(inode);
+}
+
+/* the fop would break a lease of the mount, give it back first */
+static void
+cl_release_own(xlator_t *this, inode_t *inode)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    inode_t *held = NULL;
+
+    if (inode == NULL)
+        return;
+
+    ctx = cl_inode_ctx(this, inode);
+    if (ctx == NULL)
+        return;
+
+    LOCK(&priv->lock);
+    {
+        held = __cl_inode_drop(priv, ctx);
+    }
+    UNLOCK(&priv->lock);
+
+    if (held)
+        cl_release(this, held);
+}
+
+static void
+cl_release_all(xlator_t *this)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    inode_t *held = NULL;
+
+    for (;;) {
+        LOCK(&priv->lock);
+        {
+            held = NULL;
+            if (!list_empty(&priv->held)) {
+                ctx = list_first_entry(&priv->held, cl_inode_t, held);
+                held = __cl_inode_drop(priv, ctx);
+            }
+        }
+        UNLOCK(&priv->lock);
+
+        if (held == NULL)
+            break;
+
+        cl_release(this, held);
+    }
+}
+
+static int32_t
+cl_lease_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, struct gf_lease *lease, dict_t *xdata)
+{
+    cl_private_t *priv = this->private;
+    inode_t *inode = cookie;
+    cl_inode_t *ctx = NULL;
+    cl_inode_t *lru = NULL;
+    inode_t *evicted = NULL;
+    gf_boolean_t unlock = _gf_false;
+    gf_boolean_t warn = _gf_false;
+
+    ctx = cl_inode_ctx(this, inode);
+
+    LOCK(&priv->lock);
+    {
+        if (ctx == NULL || ctx->state != CL_LEASE_REQUESTED) {
+            unlock = (op_ret == 0);
+            goto unlock;
+        }
+
+        ctx->state = CL_LEASE_NONE;
+
+        if (op_ret < 0) {
+            if (op_errno == ENOSYS) {
+                warn = priv->supported && !priv->warned;
+                priv->supported = _gf_false;
+                priv->warned = _gf_true;
+            } else {
+                ctx->backoff = time(NULL) + CL_BACKOFF;
+            }
+            goto unlock;
+        }
+
+        if (ctx->recalled) {
+            ctx->backoff = time(NULL) + CL_BACKOFF;
+            unlock = _gf_true;
+            goto unlock;
+        }
+
+        ctx->state = CL_LEASE_HELD;
+        ctx->grant++;
+        ctx->inode = inode_ref(inode);
+        list_add_tail(&ctx->held, &priv->held);
+        priv->held_count++;
+
+        if (priv->held_count > priv->max_leases) {
+            lru = list_first_entry(&priv->held, cl_inode_t, held);
+            evicted = __cl_inode_drop(priv, lru);
+        }
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (op_ret == 0)
+        GF_ATOMIC_INC(priv->granted);
+    else if (op_errno != ENOSYS)
+        GF_ATOMIC_INC(priv->denied);
+
+    if (warn)
+        gf_msg(this->name, GF_LOG_WARNING, op_errno,
+               CL_MSG_LEASES_NOT_SUPPORTED,
+               "the bricks do not grant leases, is features.leases on? "
+               "no lease is requested until they reconnect");
+
+    if (unlock)
+        cl_unlock(this, inode);
+
+    if (evicted)
+        cl_release(this, evicted);
+
+    inode_unref(inode);
+    STACK_DESTROY(frame->root);
+    return 0;
+}
+
+static void
+cl_lease_request(call_frame_t *frame, xlator_t *this, inode_t *inode)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    call_frame_t *lease_frame = NULL;
+    struct gf_lease lease = {
+        0,
+    };
+    loc_t loc = {
+        0,
+    };
+
+    lease_frame = copy_frame(frame);
+    if (lease_frame == NULL) {
+        ctx = cl_inode_ctx(this, inode);
+        LOCK(&priv->lock);
+        {
+            if (ctx)
+                ctx->state = CL_LEASE_NONE;
+        }
+        UNLOCK(&priv->lock);
+        return;
+    }
+
+    loc.inode = inode_ref(inode);
+    gf_uuid_copy(loc.gfid, inode->gfid);
+
+    lease.cmd = GF_SET_LEASE;
+    lease.lease_type = GF_RD_LEASE;
+    memcpy(lease.lease_id, priv->lease_id, LEASE_ID_SIZE);
+
+    GF_ATOMIC_INC(priv->requested);
+
+    STACK_WIND_COOKIE(lease_frame, cl_lease_cbk, inode_ref(inode),
+                      FIRST_CHILD(this), FIRST_CHILD(this)->fops->lease, &loc,
+                      &lease, NULL);
+
+    loc_wipe(&loc);
+}
+
+/* counts the revalidations of an inode, and leases it when it gets hot */
+static void
+cl_revalidated(call_frame_t *frame, xlator_t *this, inode_t *inode)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    gf_boolean_t request = _gf_false;
+    time_t now = 0;
+
+    /* internal fops do not make an inode hot, and the bricks would not
+     * grant a lease for them */
+    if (!priv->supported || frame->root->pid < 0 || inode == NULL ||
+        gf_uuid_is_null(inode->gfid))
+        return;
+
+    if (!IA_ISREG(inode->ia_type) && !IA_ISDIR(inode->ia_type))
+        return;
+
+    ctx = cl_inode_get(this, inode);
+    if (ctx == NULL)
+        return;
+
+    now = time(NULL);
+
+    LOCK(&priv->lock);
+    {
+        if (ctx->state != CL_LEASE_NONE || now < ctx->backoff)
+            goto unlock;
+
+        if (now - ctx->window >= CL_HOT_WINDOW) {
+            ctx->window = now;
+            ctx->revalidations = 0;
+        }
+
+        if (++ctx->revalidations < priv->threshold)
+            goto unlock;
+
+        ctx->revalidations = 0;
+        ctx->recalled = _gf_false;
+        ctx->state = CL_LEASE_REQUESTED;
+        request = _gf_true;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (request)
+        cl_lease_request(frame, this, inode);
+}
+
+/* a lookup or stat wound while the lease is held: the reply was served
+ * under it, unless the lease went away and came back meanwhile */
+static cl_local_t *
+cl_local_get(xlator_t *this, inode_t *inode)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    cl_local_t *local = NULL;
+    uint64_t grant = 0;
+
+    if (inode == NULL)
+        return NULL;
+
+    ctx = cl_inode_ctx(this, inode);
+    if (ctx == NULL)
+        return NULL;
+
+    LOCK(&priv->lock);
+    {
+        if (ctx->state == CL_LEASE_HELD)
+            grant = ctx->grant;
+    }
+    UNLOCK(&priv->lock);
+
+    if (grant == 0)
+        return NULL;
+
+    local = mem_get0(this->local_pool);
+    if (local == NULL)
+        return NULL;
+
+    local->inode = inode_ref(inode);
+    local->grant = grant;
+
+    return local;
+}
+
+static void
+cl_local_wipe(cl_local_t *local)
+{
+    if (local == NULL)
+        return;
+
+    inode_unref(local->inode);
+    mem_put(local);
+}
+
+/* xdata of a reply, with GF_CACHE_LEASE_KEY when the lease the fop was
+ * wound under is still held, to be unref'd. NULL when it is not. */
+static dict_t *
+cl_advertise(xlator_t *this, cl_local_t *local, dict_t *xdata)
+{
+    cl_private_t *priv = this->private;
+    cl_inode_t *ctx = NULL;
+    gf_boolean_t held = _gf_false;
+
+    if (local == NULL)
+        return NULL;
+
+    ctx = cl_inode_ctx(this, local->inode);
+    if (ctx == NULL)
+        return NULL;
+
+    LOCK(&priv->lock);
+    {
+        held = ((ctx->state == CL_LEASE_HELD) &&
+                (ctx->grant == local->grant));
+        if (held) {
+            /* least recently used first */
+            list_move_tail(&ctx->held, &priv->held);
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (!held)
+        return NULL;
+
+    xdata = xdata ? dict_ref(xdata) : dict_new();
+    if (xdata == NULL)
+        return NULL;
+
+    if (dict_set_int8(xdata, GF_CACHE_LEASE_KEY, 1) == 0)
+        GF_ATOMIC_INC(priv->advertised);
+
+    return xdata;
+}
+
+static int32_t
+cl_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *stbuf, dict_t *xdata, struct iatt *postparent)
+{
+    cl_local_t *local = frame->local;
+    dict_t *reply = NULL;
+
+    if (op_ret == 0)
+        reply = cl_advertise(this, local, xdata);
+
+    frame->local = NULL;
+    STACK_UNWIND_STRICT(lookup, frame, op_ret, op_errno, inode, stbuf,
+                        reply ? reply : xdata, postparent);
+
+    if (reply)
+        dict_unref(reply);
+    cl_local_wipe(local);
+
+    return 0;
+}
+
+static int32_t
+cl_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    cl_revalidated(frame, this, loc->inode);
+
+    frame->local = cl_local_get(this, loc->inode);
+
+    STACK_WIND(frame, cl_lookup_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lookup, loc, xdata);
+    return 0;
+}
+
+static int32_t
+cl_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, struct iatt *buf, dict_t *xdata)
+{
+    cl_local_t *local = frame->local;
+    dict_t *reply = NULL;
+
+    if (op_ret == 0)
+        reply = cl_advertise(this, local, xdata);
+
+    frame->local = NULL;
+    STACK_UNWIND_STRICT(stat, frame, op_ret, op_errno, buf,
+                        reply ? reply : xdata);
+
+    if (reply)
+        dict_unref(reply);
+    cl_local_wipe(local);
+
+    return 0;
+}
+
+static int32_t
+cl_stat(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    cl_revalidated(frame, this, loc->inode);
+
+    frame->local = cl_local_get(this, loc->inode);
+
+    STACK_WIND(frame, cl_stat_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->stat, loc, xdata);
+    return 0;
+}
+
+static int32_t
+cl_fstat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *buf, dict_t *xdata)
+{
+    cl_local_t *local = frame->local;
+    dict_t *reply = NULL;
+
+    if (op_ret == 0)
+        reply = cl_advertise(this, local, xdata);
+
+    frame->local = NULL;
+    STACK_UNWIND_STRICT(fstat, frame, op_ret, op_errno, buf,
+                        reply ? reply : xdata);
+
+    if (reply)
+        dict_unref(reply);
+    cl_local_wipe(local);
+
+    return 0;
+}
+
+static int32_t
+cl_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+    cl_revalidated(frame, this, fd->inode);
+
+    frame->local = cl_local_get(this, fd->inode);
+
+    STACK_WIND(frame, cl_fstat_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->fstat, fd, xdata);
+    return 0;
+}
+
+static int32_t
+cl_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+        fd_t *fd, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(open, frame, this, xdata, loc, flags, fd);
+    return 0;
+}
+
+static int32_t
+cl_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+          mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(create, frame, this, xdata, loc, flags, mode, umask,
+                          fd);
+    return 0;
+}
+
+static int32_t
+cl_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+         off_t offset, uint32_t flags, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(readv, frame, this, xdata, fd, size, offset, flags);
+    return 0;
+}
+
+static int32_t
+cl_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
+          int32_t count, off_t offset, uint32_t flags, struct iobref *iobref,
+          dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(writev, frame, this, xdata, fd, vector, count,
+                          offset, flags, iobref);
+    return 0;
+}
+
+static int32_t
+cl_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+            dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(truncate, frame, this, xdata, loc, offset);
+    return 0;
+}
+
+static int32_t
+cl_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(ftruncate, frame, this, xdata, fd, offset);
+    return 0;
+}
+
+static int32_t
+cl_setattr(call_frame_t *frame, xlator_t *this, loc_t *loc, struct iatt *stbuf,
+           int32_t valid, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(setattr, frame, this, xdata, loc, stbuf, valid);
+    return 0;
+}
+
+static int32_t
+cl_fsetattr(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iatt *stbuf,
+            int32_t valid, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(fsetattr, frame, this, xdata, fd, stbuf, valid);
+    return 0;
+}
+
+static int32_t
+cl_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+             off_t offset, size_t len, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(fallocate, frame, this, xdata, fd, mode, offset,
+                          len);
+    return 0;
+}
+
+static int32_t
+cl_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+           size_t len, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(discard, frame, this, xdata, fd, offset, len);
+    return 0;
+}
+
+static int32_t
+cl_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            off_t len, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(zerofill, frame, this, xdata, fd, offset, len);
+    return 0;
+}
+
+static int32_t
+cl_lk(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
+      struct gf_flock *flock, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(lk, frame, this, xdata, fd, cmd, flock);
+    return 0;
+}
+
+static int32_t
+cl_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
+         dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(fsync, frame, this, xdata, fd, datasync);
+    return 0;
+}
+
+static int32_t
+cl_flush(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(flush, frame, this, xdata, fd);
+    return 0;
+}
+
+static int32_t
+cl_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+         mode_t umask, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(mkdir, frame, this, xdata, loc, mode, umask);
+    return 0;
+}
+
+static int32_t
+cl_mknod(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+         dev_t rdev, mode_t umask, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(mknod, frame, this, xdata, loc, mode, rdev, umask);
+    return 0;
+}
+
+static int32_t
+cl_symlink(call_frame_t *frame, xlator_t *this, const char *linkname,
+           loc_t *loc, mode_t umask, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(symlink, frame, this, xdata, linkname, loc, umask);
+    return 0;
+}
+
+static int32_t
+cl_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+        dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(link, frame, this, xdata, oldloc, newloc);
+    return 0;
+}
+
+/* the bricks recall the leases on the inodes unlinked, renamed or removed,
+ * even from the mount holding them */
+static int32_t
+cl_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+          dict_t *xdata)
+{
+    cl_release_own(this, loc->inode);
+
+    CL_STACK_WIND_STAMPED(unlink, frame, this, xdata, loc, xflag);
+    return 0;
+}
+
+static int32_t
+cl_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
+         dict_t *xdata)
+{
+    cl_release_own(this, loc->inode);
+
+    CL_STACK_WIND_STAMPED(rmdir, frame, this, xdata, loc, flags);
+    return 0;
+}
+
+static int32_t
+cl_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+          dict_t *xdata)
+{
+    cl_release_own(this, oldloc->inode);
+    cl_release_own(this, newloc->inode);
+
+    CL_STACK_WIND_STAMPED(rename, frame, this, xdata, oldloc, newloc);
+    return 0;
+}
+
+static int32_t
+cl_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
+            int32_t flags, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(setxattr, frame, this, xdata, loc, dict, flags);
+    return 0;
+}
+
+static int32_t
+cl_fsetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *dict,
+             int32_t flags, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(fsetxattr, frame, this, xdata, fd, dict, flags);
+    return 0;
+}
+
+static int32_t
+cl_removexattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+               const char *name, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(removexattr, frame, this, xdata, loc, name);
+    return 0;
+}
+
+static int32_t
+cl_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                const char *name, dict_t *xdata)
+{
+    CL_STACK_WIND_STAMPED(fremovexattr, frame, this, xdata, fd, name);
+    return 0;
+}
+
+static int32_t
+cl_forget(xlator_t *this, inode_t *inode)
+{
+    uint64_t value = 0;
+
+    /* a held lease keeps a ref on the inode, the ctx is not on
+     * priv->held */
+    if (inode_ctx_del(inode, this, &value) || !value)
+        return 0;
+
+    GF_FREE((cl_inode_t *)(uintptr_t)value);
+    return 0;
+}
+
+static void
+cl_recall(xlator_t *this, struct gf_upcall *up_data)
+{
+    cl_private_t *priv = this->private;
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+    inode_t *held = NULL;
+    cl_inode_t *ctx = NULL;
+    gf_boolean_t leased = _gf_false;
+
+    itable = ((xlator_t *)this->graph->top)->itable;
+    if (itable == NULL)
+        return;
+
+    inode = inode_find(itable, up_data->gfid);
+    if (inode == NULL)
+        return;
+
+    /* never leased by the mount */
+    ctx = cl_inode_ctx(this, inode);
+    if (ctx == NULL)
+        goto out;
+
+    LOCK(&priv->lock);
+    {
+        leased = (ctx->state != CL_LEASE_NONE);
+        held = __cl_inode_drop(priv, ctx);
+        ctx->backoff = time(NULL) + CL_BACKOFF;
+    }
+    UNLOCK(&priv->lock);
+
+    if (leased)
+        GF_ATOMIC_INC(priv->recalled);
+
+    /* a lease still requested is given back when it is granted */
+    if (held)
+        cl_release(this, held);
+out:
+    inode_unref(inode);
+}
+
+int
+cl_notify(xlator_t *this, int event, void *data, ...)
+{
+    cl_private_t *priv = this->private;
+    struct gf_upcall *up_data = NULL;
+
+    switch (event) {
+        case GF_EVENT_UPCALL:
+            up_data = (struct gf_upcall *)data;
+            if (up_data->event_type == GF_UPCALL_RECALL_LEASE)
+                cl_recall(this, up_data);
+            break;
+        case GF_EVENT_CHILD_DOWN:
+        case GF_EVENT_SOME_DESCENDENT_DOWN:
+            /* the bricks drop the leases of a client that disconnects */
+            cl_release_all(this);
+            break;
+        case GF_EVENT_CHILD_UP:
+            priv->supported = _gf_true;
+            break;
+        default:
+            break;
+    }
+
+    /* gfapi applications take leases of their own */
+    return default_notify(this, event, data);
+}
+
+int32_t
+cl_priv_dump(xlator_t *this)
+{
+    cl_private_t *priv = this->private;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+    if (!priv)
+        return 0;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.cache-leases",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("lease_id", "%s", leaseid_utoa(priv->lease_id));
+    gf_proc_dump_write("threshold", "%d", priv->threshold);
+    gf_proc_dump_write("max_leases", "%d", priv->max_leases);
+    gf_proc_dump_write("supported", "%d", priv->supported);
+
+    LOCK(&priv->lock);
+    {
+        gf_proc_dump_write("held", "%d", priv->held_count);
+    }
+    UNLOCK(&priv->lock);
+
+    gf_proc_dump_write("requested", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->requested));
+    gf_proc_dump_write("granted", "%" PRIu64, GF_ATOMIC_GET(priv->granted));
+    gf_proc_dump_write("denied", "%" PRIu64, GF_ATOMIC_GET(priv->denied));
+    gf_proc_dump_write("recalled", "%" PRIu64, GF_ATOMIC_GET(priv->recalled));
+    gf_proc_dump_write("released", "%" PRIu64, GF_ATOMIC_GET(priv->released));
+    gf_proc_dump_write("advertised", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->advertised));
+
+    return 0;
+}
+
+int32_t
+mem_acct_init(xlator_t *this)
+{
+    int ret = -1;
+
+    if (!this)
+        goto out;
+
+    ret = xlator_mem_acct_init(this, gf_cl_mt_end + 1);
+
+    if (ret != 0) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, CL_MSG_NO_MEMORY,
+               "Memory accounting init failed");
+        goto out;
+    }
+out:
+    return ret;
+}
+
+int
+reconfigure(xlator_t *this, dict_t *options)
+{
+    cl_private_t *priv = this->private;
+    int ret = -1;
+
+    GF_OPTION_RECONF("threshold", priv->threshold, options, int32, out);
+    GF_OPTION_RECONF("max-leases", priv->max_leases, options, int32, out);
+    GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
+
+    ret = 0;
+out:
+    return ret;
+}
+
+int
+init(xlator_t *this)
+{
+    cl_private_t *priv = NULL;
+    uuid_t id;
+    int i = 0;
+
+    if (!this->children || this->children->next) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, CL_MSG_XLATOR_CHILD_MISCONFIGURED,
+               "FATAL: cache-leases not configured with exactly one child");
+        return -1;
+    }
+
+    if (!this->parents)
+        gf_msg(this->name, GF_LOG_WARNING, 0, CL_MSG_VOL_MISCONFIGURED,
+               "dangling volume. check volfile");
+
+    priv = GF_CALLOC(1, sizeof(*priv), gf_cl_mt_cl_private_t);
+    if (!priv)
+        goto err;
+
+    LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->held);
+    priv->supported = _gf_true;
+
+    /* the bricks compare lease ids as strings: no zero byte but the
+     * last one */
+    gf_uuid_generate(id);
+    for (i = 0; i < LEASE_ID_SIZE - 1; i++)
+        priv->lease_id[i] = id[i] ? id[i] : 1;
+    priv->lease_id[LEASE_ID_SIZE - 1] = '\0';
+
+    GF_ATOMIC_INIT(priv->requested, 0);
+    GF_ATOMIC_INIT(priv->granted, 0);
+    GF_ATOMIC_INIT(priv->denied, 0);
+    GF_ATOMIC_INIT(priv->recalled, 0);
+    GF_ATOMIC_INIT(priv->released, 0);
+    GF_ATOMIC_INIT(priv->advertised, 0);
+
+    GF_OPTION_INIT("threshold", priv->threshold, int32, err);
+    GF_OPTION_INIT("max-leases", priv->max_leases, int32, err);
+    GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
+
+    this->local_pool = mem_pool_new(cl_local_t, 64);
+    if (!this->local_pool) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, CL_MSG_NO_MEMORY,
+               "failed to create local_t's memory pool");
+        goto err;
+    }
+
+    this->private = priv;
+
+    return 0;
+err:
+    if (priv) {
+        LOCK_DESTROY(&priv->lock);
+        GF_FREE(priv);
+    }
+
+    return -1;
+}
+
+void
+fini(xlator_t *this)
+{
+    cl_private_t *priv = this->private;
+
+    if (!priv)
+        return;
+
+    /* the leases go with the connections to the bricks */
+    this->private = NULL;
+    LOCK_DESTROY(&priv->lock);
+    GF_FREE(priv);
+
+    if (this->local_pool) {
+        mem_pool_destroy(this->local_pool);
+        this->local_pool = NULL;
+    }
+}
+
+struct xlator_fops fops = {
+    .lookup = cl_lookup,
+    .stat = cl_stat,
+    .fstat = cl_fstat,
+    .open = cl_open,
+    .create = cl_create,
+    .readv = cl_readv,
+    .writev = cl_writev,
+    .truncate = cl_truncate,
+    .ftruncate = cl_ftruncate,
+    .setattr = cl_setattr,
+    .fsetattr = cl_fsetattr,
+    .fallocate = cl_fallocate,
+    .discard = cl_discard,
+    .zerofill = cl_zerofill,
+    .lk = cl_lk,
+    .fsync = cl_fsync,
+    .flush = cl_flush,
+    .mkdir = cl_mkdir,
+    .mknod = cl_mknod,
+    .symlink = cl_symlink,
+    .link = cl_link,
+    .unlink = cl_unlink,
+    .rmdir = cl_rmdir,
+    .rename = cl_rename,
+    .setxattr = cl_setxattr,
+    .fsetxattr = cl_fsetxattr,
+    .removexattr = cl_removexattr,
+    .fremovexattr = cl_fremovexattr,
+};
+
+struct xlator_cbks cbks = {
+    .forget = cl_forget,
+};
+
+struct xlator_dumpops dumpops = {
+    .priv = cl_priv_dump,
+};
+
+struct volume_options options[] = {
+    {
+        .key = {"cache-leases"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .description = "enable/disable cache-leases",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+    },
+    {
+        .key = {"threshold"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 1024,
+        .default_value = "3",
+        .description = "Lookups and stats of a file or directory within a "
+                       "minute after which a read lease is requested for it.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"cache-leases"},
+    },
+    {
+        .key = {"max-leases"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 1048576,
+        .default_value = "4096",
+        .description = "Leases held at most. The least recently used one is "
+                       "given back to take a new one.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"cache-leases"},
+    },
+    {
+        .key = {"pass-through"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "false",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"cache-leases"},
+        .description = "Enable/Disable cache-leases translator",
+    },
+    {.key = {NULL}},
+};
+
+xlator_api_t xlator_api = {
+    .init = init,
+    .fini = fini,
+    .notify = cl_notify,
+    .reconfigure = reconfigure,
+    .mem_acct_init = mem_acct_init,
+    .op_version = {GD_OP_VERSION_8_0},
+    .dumpops = &dumpops,
+    .fops = &fops,
+    .cbks = &cbks,
+    .options = options,
+    .identifier = "cache-leases",
+    .category = GF_TECH_PREVIEW,
+};
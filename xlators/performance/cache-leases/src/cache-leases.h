@@ -0,0 +1,88 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __CACHE_LEASES_H__
+#define __CACHE_LEASES_H__
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/defaults.h>
+#include <glusterfs/list.h>
+#include <glusterfs/locking.h>
+#include <glusterfs/common-utils.h>
+#include "cache-leases-mem-types.h"
+#include "cache-leases-messages.h"
+
+/* revalidations of an inode are counted over this many seconds */
+#define CL_HOT_WINDOW 60
+
+/* an inode whose lease was recalled or denied is not leased again for
+ * this many seconds */
+#define CL_BACKOFF 30
+
+enum cl_lease_state {
+    CL_LEASE_NONE = 0,
+    CL_LEASE_REQUESTED, /* lease fop on its way */
+    CL_LEASE_HELD,
+};
+
+/*
+ * cl_inode - lease state of an inode
+ *
+ * All fields are protected by priv->lock.
+ */
+struct cl_inode {
+    struct list_head held; /* in priv->held, lru first, while HELD */
+    inode_t *inode;        /* ref'd while HELD, for the unlock */
+    enum cl_lease_state state;
+    gf_boolean_t recalled;  /* recalled while REQUESTED */
+    uint64_t grant;         /* bumped each time a lease is granted */
+    uint32_t revalidations; /* lookups and stats in the current window */
+    time_t window;          /* start of the current window */
+    time_t backoff;         /* no lease requested before that */
+};
+typedef struct cl_inode cl_inode_t;
+
+/* a lookup or stat wound while the inode was leased */
+struct cl_local {
+    inode_t *inode;
+    uint64_t grant; /* cl_inode.grant at wind */
+};
+typedef struct cl_local cl_local_t;
+
+struct cl_private {
+    gf_lock_t lock;
+    struct list_head held;
+    int32_t held_count;
+
+    /* the lease id of this mount, stamped on the fops sent to the bricks
+     * so that they do not conflict with its own leases */
+    char lease_id[LEASE_ID_SIZE];
+
+    /* cleared when the bricks do not have features.leases on, until they
+     * reconnect */
+    gf_boolean_t supported;
+    gf_boolean_t warned;
+
+    /* options */
+    int32_t threshold;
+    int32_t max_leases;
+
+    /* statistics */
+    gf_atomic_t requested;
+    gf_atomic_t granted;
+    gf_atomic_t denied;
+    gf_atomic_t recalled;
+    gf_atomic_t released;
+    gf_atomic_t advertised;
+};
+typedef struct cl_private cl_private_t;
+
+#endif /* __CACHE_LEASES_H__ */
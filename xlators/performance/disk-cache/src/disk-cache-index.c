@@ -0,0 +1,911 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#include <dirent.h>
+#include <sys/file.h>
+#include <glusterfs/syscall.h>
+#include <glusterfs/iobuf.h>
+#include "disk-cache.h"
+
+static uint32_t
+dc_hash(uuid_t gfid)
+{
+    return ((gfid[14] << 8) | gfid[15]) & (DC_HASH_SIZE - 1);
+}
+
+void
+dc_data_path(dc_private_t *priv, uuid_t gfid, char *path, size_t len)
+{
+    snprintf(path, len, "%s/%02x/%s", priv->conf.cache_dir, gfid[0],
+             uuid_utoa(gfid));
+}
+
+static void
+dc_index_path(dc_private_t *priv, char *path, size_t len, const char *suffix)
+{
+    snprintf(path, len, "%s/%s%s", priv->conf.cache_dir, DC_INDEX_NAME,
+             suffix);
+}
+
+/* To be called with priv->lock held */
+dc_entry_t *
+__dc_entry_get(dc_private_t *priv, uuid_t gfid)
+{
+    dc_entry_t *entry = NULL;
+
+    list_for_each_entry(entry, &priv->hash[dc_hash(gfid)], hash)
+    {
+        if (gf_uuid_compare(entry->gfid, gfid) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static dc_entry_t *
+__dc_entry_alloc(dc_private_t *priv, uuid_t gfid, uint32_t nblocks)
+{
+    dc_entry_t *entry = NULL;
+
+    entry = GF_CALLOC(1, sizeof(*entry), gf_dc_mt_dc_entry_t);
+    if (!entry)
+        return NULL;
+
+    if (nblocks) {
+        entry->bitmap = GF_CALLOC((nblocks + 7) / 8, 1, gf_dc_mt_dc_bitmap_t);
+        if (!entry->bitmap) {
+            GF_FREE(entry);
+            return NULL;
+        }
+    }
+
+    entry->nblocks = nblocks;
+    gf_uuid_copy(entry->gfid, gfid);
+    INIT_LIST_HEAD(&entry->hash);
+    INIT_LIST_HEAD(&entry->lru);
+
+    list_add(&entry->hash, &priv->hash[dc_hash(gfid)]);
+    list_add_tail(&entry->lru, &priv->lru);
+    priv->entries++;
+
+    return entry;
+}
+
+void
+dc_datafd_unref(dc_datafd_t *datafd)
+{
+    if (!datafd)
+        return;
+
+    if (GF_ATOMIC_DEC(datafd->refcount) == 0) {
+        sys_close(datafd->fd);
+        GF_FREE(datafd);
+    }
+}
+
+static void
+dc_entry_free(dc_private_t *priv, dc_entry_t *entry)
+{
+    if (entry->datafd) {
+        GF_ATOMIC_DEC(priv->datafds);
+        dc_datafd_unref(entry->datafd);
+    }
+
+    GF_FREE(entry->bitmap);
+    GF_FREE(entry);
+}
+
+/* Opens the data file of @gfid to serve a read from it, and leaves it open
+ * in the entry for the next ones, unless the entry changed meanwhile or
+ * too many are open already. The caller has a ref on what is returned.
+ */
+dc_datafd_t *
+dc_datafd_open(xlator_t *this, uuid_t gfid, uint64_t gen)
+{
+    dc_private_t *priv = this->private;
+    dc_datafd_t *datafd = NULL;
+    dc_entry_t *entry = NULL;
+    char path[PATH_MAX];
+
+    datafd = GF_CALLOC(1, sizeof(*datafd), gf_dc_mt_dc_datafd_t);
+    if (!datafd)
+        return NULL;
+
+    dc_data_path(priv, gfid, path, sizeof(path));
+
+    datafd->fd = sys_open(path, O_RDONLY, 0);
+    if (datafd->fd < 0) {
+        GF_FREE(datafd);
+        return NULL;
+    }
+
+    GF_ATOMIC_INIT(datafd->refcount, 1);
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, gfid);
+        if (entry && (entry->gen == gen) && !entry->datafd &&
+            (GF_ATOMIC_GET(priv->datafds) < DC_MAX_OPEN_DATA_FILES)) {
+            GF_ATOMIC_INC(datafd->refcount);
+            GF_ATOMIC_INC(priv->datafds);
+            entry->datafd = datafd;
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    return datafd;
+}
+
+/* To be called with priv->lock held */
+static dc_entry_t *
+__dc_entry_new(dc_private_t *priv, uuid_t gfid, struct iatt *buf)
+{
+    dc_entry_t *entry = NULL;
+    uint64_t bs = priv->conf.block_size;
+
+    entry = __dc_entry_alloc(priv, gfid, (buf->ia_size + bs - 1) / bs);
+    if (!entry)
+        return NULL;
+
+    entry->size = buf->ia_size;
+    entry->mtime = buf->ia_mtime;
+    entry->mtime_nsec = buf->ia_mtime_nsec;
+    entry->ctime = buf->ia_ctime;
+    entry->ctime_nsec = buf->ia_ctime_nsec;
+    entry->gen = ++priv->gen;
+
+    return entry;
+}
+
+/* Unhashes @entry; the caller frees it and drops its data file.
+ * To be called with priv->lock held.
+ */
+static void
+__dc_entry_del(dc_private_t *priv, dc_entry_t *entry)
+{
+    list_del_init(&entry->hash);
+    list_del_init(&entry->lru);
+
+    priv->cache_used -= (uint64_t)entry->cached * priv->conf.block_size;
+    priv->entries--;
+}
+
+static gf_boolean_t
+dc_entry_matches(dc_conf_t *conf, dc_entry_t *entry, struct iatt *buf)
+{
+    if (entry->size != buf->ia_size)
+        return _gf_false;
+
+    if ((entry->mtime != buf->ia_mtime) ||
+        (entry->mtime_nsec != buf->ia_mtime_nsec))
+        return _gf_false;
+
+    if (conf->ctime_invalidation && ((entry->ctime != buf->ia_ctime) ||
+                                     (entry->ctime_nsec != buf->ia_ctime_nsec)))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+/* Evicts least recently used files onto @victims until the cache fits in
+ * cache-size. To be called with priv->lock held.
+ */
+static void
+__dc_cache_prune(dc_private_t *priv, struct list_head *victims)
+{
+    dc_entry_t *entry = NULL;
+
+    while ((priv->cache_used > priv->conf.cache_size) &&
+           !list_empty(&priv->lru)) {
+        entry = list_first_entry(&priv->lru, dc_entry_t, lru);
+        __dc_entry_del(priv, entry);
+        list_add_tail(&entry->lru, victims);
+    }
+}
+
+static void
+dc_victims_drop(xlator_t *this, struct list_head *victims)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    dc_entry_t *tmp = NULL;
+    char path[PATH_MAX];
+
+    list_for_each_entry_safe(entry, tmp, victims, lru)
+    {
+        list_del_init(&entry->lru);
+
+        dc_data_path(priv, entry->gfid, path, sizeof(path));
+        sys_unlink(path);
+
+        GF_ATOMIC_INC(priv->stats.evictions);
+        dc_entry_free(priv, entry);
+    }
+}
+
+static void
+dc_fill_free(dc_fill_t *fill)
+{
+    GF_FREE(fill->vector);
+
+    if (fill->iobref)
+        iobref_unref(fill->iobref);
+
+    GF_FREE(fill);
+}
+
+/* Hands @fill to the worker thread. Fills of data are dropped when too
+ * much is queued already, @fill is freed then.
+ */
+static int
+dc_fill_queue(xlator_t *this, dc_fill_t *fill)
+{
+    dc_private_t *priv = this->private;
+    int ret = -1;
+
+    pthread_mutex_lock(&priv->fill_lock);
+    {
+        if (fill->size &&
+            (priv->fill_pending + fill->size > DC_FILL_QUEUE_LIMIT))
+            goto unlock;
+
+        list_add_tail(&fill->list, &priv->fills);
+        priv->fill_pending += fill->size;
+        pthread_cond_signal(&priv->fill_cond);
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&priv->fill_lock);
+
+    if (ret) {
+        GF_ATOMIC_INC(priv->stats.fills_dropped);
+        dc_fill_free(fill);
+    }
+
+    return ret;
+}
+
+/* Drops @entry, unhashed already, and has its data file removed */
+static void
+dc_entry_drop(xlator_t *this, dc_entry_t *entry)
+{
+    dc_private_t *priv = this->private;
+    dc_fill_t *trim = NULL;
+
+    trim = GF_CALLOC(1, sizeof(*trim), gf_dc_mt_dc_fill_t);
+    if (trim) {
+        gf_uuid_copy(trim->gfid, entry->gfid);
+        dc_fill_queue(this, trim);
+    }
+
+    GF_ATOMIC_INC(priv->stats.invalidations);
+    dc_entry_free(priv, entry);
+}
+
+void
+dc_invalidate(xlator_t *this, uuid_t gfid)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, gfid);
+        if (entry)
+            __dc_entry_del(priv, entry);
+    }
+    UNLOCK(&priv->lock);
+
+    if (entry)
+        dc_entry_drop(this, entry);
+}
+
+/* Checks the blocks cached for a file against its attributes, as just
+ * returned by the bricks.
+ */
+void
+dc_validate(xlator_t *this, struct iatt *buf)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, buf->ia_gfid);
+        if (!entry)
+            goto unlock;
+
+        if (dc_entry_matches(&priv->conf, entry, buf)) {
+            entry->buf = *buf;
+            entry->validated = time(NULL);
+            entry = NULL;
+        } else {
+            __dc_entry_del(priv, entry);
+        }
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (entry)
+        dc_entry_drop(this, entry);
+}
+
+/* Queues the whole blocks in @size bytes read at @offset, and the last
+ * block of the file if the read reached its end, to be written to the
+ * cache. The data is not copied, the fill holds a ref on @iobref.
+ */
+void
+dc_fill(xlator_t *this, uuid_t gfid, off_t offset, struct iovec *vector,
+        int count, size_t size, struct iatt *stbuf, struct iobref *iobref)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    dc_entry_t *stale = NULL;
+    dc_fill_t *fill = NULL;
+    uint64_t bs = priv->conf.block_size;
+    uint64_t block = 0;
+    off_t start = 0;
+    off_t end = 0;
+    uint64_t gen = 0;
+    gf_boolean_t cached = _gf_true;
+
+    start = ((offset + bs - 1) / bs) * bs;
+    end = offset + size;
+    if (end < (off_t)stbuf->ia_size)
+        end = (end / bs) * bs;
+    if (end <= start)
+        return;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, gfid);
+        if (entry && !dc_entry_matches(&priv->conf, entry, stbuf)) {
+            __dc_entry_del(priv, entry);
+            stale = entry;
+            entry = NULL;
+        }
+
+        /* a new entry is only served from after a lookup or an fstat
+         * validated it, not on the attributes of a read that may have
+         * raced with a write
+         */
+        if (!entry)
+            entry = __dc_entry_new(priv, gfid, stbuf);
+
+        if (entry) {
+            gen = entry->gen;
+            for (block = start / bs; block * bs < end; block++) {
+                if (!(entry->bitmap[block / 8] & (1 << (block % 8)))) {
+                    cached = _gf_false;
+                    break;
+                }
+            }
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (stale)
+        dc_entry_drop(this, stale);
+
+    if (!entry || cached)
+        return;
+
+    fill = GF_CALLOC(1, sizeof(*fill), gf_dc_mt_dc_fill_t);
+    if (!fill)
+        return;
+
+    gf_uuid_copy(fill->gfid, gfid);
+    fill->gen = gen;
+    fill->offset = start;
+    fill->size = end - start;
+    fill->count = iov_subset(vector, count, start - offset, fill->size,
+                             &fill->vector, 0);
+    if (fill->count <= 0) {
+        GF_FREE(fill);
+        return;
+    }
+    fill->iobref = iobref_ref(iobref);
+
+    dc_fill_queue(this, fill);
+}
+
+/* A fill of size 0 drops the data file of a file whose blocks were
+ * invalidated, unless blocks of its new version were cached since.
+ */
+static void
+dc_fill_trim(xlator_t *this, dc_fill_t *fill)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    gf_boolean_t live = _gf_false;
+    char path[PATH_MAX];
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, fill->gfid);
+        live = (entry && entry->cached);
+    }
+    UNLOCK(&priv->lock);
+
+    if (live)
+        return;
+
+    dc_data_path(priv, fill->gfid, path, sizeof(path));
+    sys_unlink(path);
+}
+
+static void
+dc_fill_process(xlator_t *this, dc_fill_t *fill)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    uint64_t bs = priv->conf.block_size;
+    uint64_t block = 0;
+    gf_boolean_t valid = _gf_false;
+    char path[PATH_MAX];
+    ssize_t ret = -1;
+    int fd = -1;
+    struct list_head victims;
+
+    INIT_LIST_HEAD(&victims);
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, fill->gfid);
+        valid = (entry && (entry->gen == fill->gen));
+    }
+    UNLOCK(&priv->lock);
+
+    if (!valid)
+        return;
+
+    dc_data_path(priv, fill->gfid, path, sizeof(path));
+
+    fd = sys_open(path, O_CREAT | O_WRONLY, 0600);
+    if (fd < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_FILL_FAILED,
+               "cannot open cache file %s", path);
+        return;
+    }
+
+    ret = sys_pwritev(fd, fill->vector, fill->count, fill->offset);
+    sys_close(fd);
+
+    if (ret != fill->size) {
+        gf_msg(this->name, GF_LOG_WARNING, (ret < 0) ? errno : ENOSPC,
+               DC_MSG_FILL_FAILED, "cannot write %zu bytes at %" PRId64
+               " to cache file %s", fill->size, fill->offset, path);
+        return;
+    }
+
+    GF_ATOMIC_ADD(priv->stats.fill_bytes, fill->size);
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, fill->gfid);
+        if (!entry || (entry->gen != fill->gen))
+            goto unlock;
+
+        for (block = fill->offset / bs;
+             (block * bs < fill->offset + fill->size) &&
+             (block < entry->nblocks);
+             block++) {
+            if (entry->bitmap[block / 8] & (1 << (block % 8)))
+                continue;
+
+            entry->bitmap[block / 8] |= (1 << (block % 8));
+            entry->cached++;
+            priv->cache_used += bs;
+        }
+
+        entry->dirty = _gf_true;
+        list_move_tail(&entry->lru, &priv->lru);
+
+        __dc_cache_prune(priv, &victims);
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    dc_victims_drop(this, &victims);
+}
+
+/* Removes data files left without index entries: written after the last
+ * index save of a client that did not shut down cleanly, or cached with
+ * another block-size.
+ */
+static void
+dc_cache_scrub(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    gf_boolean_t keep = _gf_false;
+    DIR *dir = NULL;
+    struct dirent *de = NULL;
+    struct dirent scratch[2] = {
+        {
+            0,
+        },
+    };
+    uuid_t gfid;
+    char dpath[PATH_MAX];
+    char path[PATH_MAX];
+    int i = 0;
+
+    for (i = 0; i < 256; i++) {
+        snprintf(dpath, sizeof(dpath), "%s/%02x", priv->conf.cache_dir, i);
+
+        dir = sys_opendir(dpath);
+        if (!dir)
+            continue;
+
+        while ((de = sys_readdir(dir, scratch)) != NULL) {
+            if (gf_uuid_parse(de->d_name, gfid) != 0)
+                continue;
+
+            LOCK(&priv->lock);
+            {
+                entry = __dc_entry_get(priv, gfid);
+                keep = (entry && entry->cached);
+            }
+            UNLOCK(&priv->lock);
+
+            if (keep)
+                continue;
+
+            snprintf(path, sizeof(path), "%s/%s", dpath, de->d_name);
+            sys_unlink(path);
+        }
+
+        sys_closedir(dir);
+    }
+}
+
+int
+dc_index_load(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+    struct dc_index_header *hdr = NULL;
+    struct dc_index_record *rec = NULL;
+    dc_entry_t *entry = NULL;
+    char *buf = NULL;
+    char *cur = NULL;
+    char *end = NULL;
+    struct stat stbuf;
+    char path[PATH_MAX];
+    uint64_t bs = priv->conf.block_size;
+    uint64_t i = 0;
+    uint32_t j = 0;
+    size_t len = 0;
+    int fd = -1;
+    int ret = -1;
+
+    dc_index_path(priv, path, sizeof(path), "");
+
+    fd = sys_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        ret = (errno == ENOENT) ? 0 : -1;
+        goto out;
+    }
+
+    if (sys_fstat(fd, &stbuf) || (stbuf.st_size < (off_t)sizeof(*hdr)))
+        goto out;
+
+    buf = GF_MALLOC(stbuf.st_size, gf_dc_mt_dc_index_t);
+    if (!buf)
+        goto out;
+
+    if (sys_read(fd, buf, stbuf.st_size) != stbuf.st_size)
+        goto out;
+
+    hdr = (struct dc_index_header *)buf;
+    if ((hdr->magic != DC_INDEX_MAGIC) || (hdr->version != DC_INDEX_VERSION))
+        goto out;
+
+    /* blocks cached with another block-size are dropped by the scrub */
+    ret = 0;
+    if (hdr->block_size != bs) {
+        gf_msg(this->name, GF_LOG_INFO, 0, DC_MSG_INDEX_LOAD_FAILED,
+               "block-size changed from %" PRIu64 " to %" PRIu64
+               ", dropping the cache in %s",
+               hdr->block_size, bs, priv->conf.cache_dir);
+        goto out;
+    }
+
+    cur = buf + sizeof(*hdr);
+    end = buf + stbuf.st_size;
+
+    LOCK(&priv->lock);
+    {
+        for (i = 0; i < hdr->count; i++) {
+            rec = (struct dc_index_record *)cur;
+            if (cur + sizeof(*rec) > end)
+                break;
+
+            len = (rec->nblocks + 7) / 8;
+            if ((cur + sizeof(*rec) + len > end) ||
+                (rec->nblocks != (rec->size + bs - 1) / bs))
+                break;
+
+            entry = __dc_entry_alloc(priv, rec->gfid, rec->nblocks);
+            if (!entry)
+                break;
+
+            entry->size = rec->size;
+            entry->mtime = rec->mtime;
+            entry->mtime_nsec = rec->mtime_nsec;
+            entry->ctime = rec->ctime;
+            entry->ctime_nsec = rec->ctime_nsec;
+            entry->gen = ++priv->gen;
+
+            memcpy(entry->bitmap, cur + sizeof(*rec), len);
+            for (j = 0; j < rec->nblocks; j++) {
+                if (entry->bitmap[j / 8] & (1 << (j % 8)))
+                    entry->cached++;
+            }
+            priv->cache_used += (uint64_t)entry->cached * bs;
+
+            cur += sizeof(*rec) + len;
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (i < hdr->count)
+        gf_msg(this->name, GF_LOG_WARNING, 0, DC_MSG_INDEX_LOAD_FAILED,
+               "index %s is truncated, loaded %" PRIu64 " of %" PRIu64
+               " files",
+               path, i, hdr->count);
+
+out:
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_INDEX_LOAD_FAILED,
+               "cannot load index %s, starting with an empty cache", path);
+
+    if (fd >= 0)
+        sys_close(fd);
+
+    GF_FREE(buf);
+
+    return ret;
+}
+
+/* Writes the index to a temporary file and renames it over the previous
+ * one. Data files written since the last save are synced first, so that
+ * the index never refers to blocks that did not reach the disk.
+ */
+int
+dc_index_save(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+    struct dc_index_header *hdr = NULL;
+    struct dc_index_record *rec = NULL;
+    dc_entry_t *entry = NULL;
+    unsigned char *dirty = NULL;
+    char *buf = NULL;
+    char *cur = NULL;
+    char path[PATH_MAX];
+    char tmp[PATH_MAX];
+    size_t size = sizeof(*hdr);
+    size_t ndirty = 0;
+    size_t i = 0;
+    int fd = -1;
+    int ret = -1;
+
+    LOCK(&priv->lock);
+    {
+        list_for_each_entry(entry, &priv->lru, lru)
+        {
+            if (entry->cached)
+                size += sizeof(*rec) + (entry->nblocks + 7) / 8;
+        }
+
+        buf = GF_CALLOC(1, size, gf_dc_mt_dc_index_t);
+        dirty = GF_MALLOC(priv->entries * sizeof(uuid_t) + 1,
+                          gf_dc_mt_dc_index_t);
+        if (!buf || !dirty)
+            goto unlock;
+
+        hdr = (struct dc_index_header *)buf;
+        hdr->magic = DC_INDEX_MAGIC;
+        hdr->version = DC_INDEX_VERSION;
+        hdr->block_size = priv->conf.block_size;
+
+        cur = buf + sizeof(*hdr);
+
+        /* least recently used first, as they are loaded back */
+        list_for_each_entry(entry, &priv->lru, lru)
+        {
+            if (entry->dirty) {
+                memcpy(dirty + ndirty * sizeof(uuid_t), entry->gfid,
+                       sizeof(uuid_t));
+                ndirty++;
+                entry->dirty = _gf_false;
+            }
+
+            if (!entry->cached)
+                continue;
+
+            rec = (struct dc_index_record *)cur;
+            memcpy(rec->gfid, entry->gfid, sizeof(rec->gfid));
+            rec->size = entry->size;
+            rec->mtime = entry->mtime;
+            rec->mtime_nsec = entry->mtime_nsec;
+            rec->ctime = entry->ctime;
+            rec->ctime_nsec = entry->ctime_nsec;
+            rec->nblocks = entry->nblocks;
+            memcpy(cur + sizeof(*rec), entry->bitmap, (entry->nblocks + 7) / 8);
+
+            cur += sizeof(*rec) + (entry->nblocks + 7) / 8;
+            hdr->count++;
+        }
+
+        ret = 0;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (ret)
+        goto out;
+
+    for (i = 0; i < ndirty; i++) {
+        dc_data_path(priv, dirty + i * sizeof(uuid_t), path, sizeof(path));
+        fd = sys_open(path, O_WRONLY, 0);
+        if (fd < 0)
+            continue;
+        sys_fdatasync(fd);
+        sys_close(fd);
+    }
+
+    ret = -1;
+    dc_index_path(priv, path, sizeof(path), "");
+    dc_index_path(priv, tmp, sizeof(tmp), ".tmp");
+
+    fd = sys_open(tmp, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if (fd < 0)
+        goto out;
+
+    if ((sys_write(fd, buf, size) != size) || sys_fsync(fd))
+        goto out;
+
+    sys_close(fd);
+    fd = -1;
+
+    ret = sys_rename(tmp, path);
+    if (ret == 0) {
+        priv->last_save = time(NULL);
+        GF_ATOMIC_INC(priv->stats.index_saves);
+    }
+out:
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_INDEX_SAVE_FAILED,
+               "cannot save index of %s", priv->conf.cache_dir);
+
+    if (fd >= 0)
+        sys_close(fd);
+
+    GF_FREE(buf);
+    GF_FREE(dirty);
+
+    return ret;
+}
+
+void *
+dc_worker(void *data)
+{
+    xlator_t *this = data;
+    dc_private_t *priv = this->private;
+    dc_fill_t *fill = NULL;
+    struct timespec deadline = {
+        0,
+    };
+    struct list_head victims;
+
+    THIS = this;
+    INIT_LIST_HEAD(&victims);
+
+    dc_cache_scrub(this);
+
+    LOCK(&priv->lock);
+    {
+        __dc_cache_prune(priv, &victims);
+    }
+    UNLOCK(&priv->lock);
+
+    dc_victims_drop(this, &victims);
+
+    pthread_mutex_lock(&priv->fill_lock);
+    while (!priv->fini) {
+        if (list_empty(&priv->fills)) {
+            /* a batch of fills is on disk, have the index cover it */
+            if (priv->save)
+                deadline.tv_sec = 0;
+            else if (priv->filled)
+                deadline.tv_sec = priv->last_save + DC_INDEX_FILL_INTERVAL;
+            else
+                deadline.tv_sec = priv->last_save + DC_INDEX_SYNC_INTERVAL;
+
+            if (deadline.tv_sec > time(NULL)) {
+                pthread_cond_timedwait(&priv->fill_cond, &priv->fill_lock,
+                                       &deadline);
+                continue;
+            }
+
+            priv->save = _gf_false;
+            priv->filled = _gf_false;
+            pthread_mutex_unlock(&priv->fill_lock);
+            dc_index_save(this);
+            pthread_mutex_lock(&priv->fill_lock);
+            /* retried at the next interval if it failed */
+            priv->last_save = time(NULL);
+            continue;
+        }
+
+        fill = list_first_entry(&priv->fills, dc_fill_t, list);
+        list_del_init(&fill->list);
+        priv->fill_pending -= fill->size;
+        pthread_mutex_unlock(&priv->fill_lock);
+
+        if (fill->size)
+            dc_fill_process(this, fill);
+        else
+            dc_fill_trim(this, fill);
+
+        pthread_mutex_lock(&priv->fill_lock);
+        if (fill->size)
+            priv->filled = _gf_true;
+        pthread_mutex_unlock(&priv->fill_lock);
+
+        dc_fill_free(fill);
+
+        pthread_mutex_lock(&priv->fill_lock);
+    }
+    pthread_mutex_unlock(&priv->fill_lock);
+
+    return NULL;
+}
+
+/* Has the worker save the index as soon as the fills queued are written */
+void
+dc_index_save_request(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+
+    pthread_mutex_lock(&priv->fill_lock);
+    {
+        priv->save = _gf_true;
+        pthread_cond_signal(&priv->fill_cond);
+    }
+    pthread_mutex_unlock(&priv->fill_lock);
+}
+
+/* To be called once the worker is gone */
+void
+dc_cache_destroy(dc_private_t *priv)
+{
+    dc_entry_t *entry = NULL;
+    dc_entry_t *tmp = NULL;
+    dc_fill_t *fill = NULL;
+    dc_fill_t *ftmp = NULL;
+
+    list_for_each_entry_safe(fill, ftmp, &priv->fills, list)
+    {
+        list_del_init(&fill->list);
+        dc_fill_free(fill);
+    }
+
+    list_for_each_entry_safe(entry, tmp, &priv->lru, lru)
+    {
+        list_del_init(&entry->hash);
+        list_del_init(&entry->lru);
+        dc_entry_free(priv, entry);
+    }
+
+    GF_FREE(priv->hash);
+    priv->hash = NULL;
+}
@@ -0,0 +1,27 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __DISK_CACHE_MEM_TYPES_H__
+#define __DISK_CACHE_MEM_TYPES_H__
+
+#include <glusterfs/mem-types.h>
+
+enum gf_dc_mem_types_ {
+    gf_dc_mt_dc_private_t = gf_common_mt_end + 1,
+    gf_dc_mt_dc_entry_t,
+    gf_dc_mt_dc_bitmap_t,
+    gf_dc_mt_dc_fill_t,
+    gf_dc_mt_dc_local_t,
+    gf_dc_mt_dc_index_t,
+    gf_dc_mt_dc_datafd_t,
+    gf_dc_mt_end
+};
+
+#endif /* __DISK_CACHE_MEM_TYPES_H__ */
@@ -0,0 +1,32 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __DISK_CACHE_MESSAGES_H__
+#define __DISK_CACHE_MESSAGES_H__
+
+#include <glusterfs/glfs-message-id.h>
+
+/* To add new message IDs, append new identifiers at the end of the list.
+ *
+ * Never remove a message ID. If it's not used anymore, you can rename it or
+ * leave it as it is, but not delete it. This is to prevent reutilization of
+ * IDs by other messages.
+ *
+ * The component name must match one of the entries defined in
+ * glfs-message-id.h.
+ */
+
+GLFS_MSGID(DISK_CACHE, DC_MSG_NO_MEMORY, DC_MSG_XLATOR_CHILD_MISCONFIGURED,
+           DC_MSG_VOL_MISCONFIGURED, DC_MSG_NO_CACHE_DIR, DC_MSG_CACHE_DIR_BUSY,
+           DC_MSG_THREAD_FAILED, DC_MSG_INDEX_LOAD_FAILED,
+           DC_MSG_INDEX_SAVE_FAILED, DC_MSG_FILL_FAILED, DC_MSG_READ_FAILED,
+           DC_MSG_CACHE_READY);
+
+#endif /* __DISK_CACHE_MESSAGES_H__ */
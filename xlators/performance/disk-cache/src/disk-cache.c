@@ -0,0 +1,955 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#include <sys/file.h>
+#include <glusterfs/syscall.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
+#include <glusterfs/iobuf.h>
+#include "disk-cache.h"
+
+#define DC_STACK_UNWIND(fop, frame, params...)                                 \
+    do {                                                                       \
+        dc_local_t *__local = NULL;                                            \
+        if (frame) {                                                           \
+            __local = frame->local;                                            \
+            frame->local = NULL;                                               \
+        }                                                                      \
+        STACK_UNWIND_STRICT(fop, frame, params);                               \
+        dc_local_wipe(__local);                                                \
+    } while (0)
+
+static void
+dc_local_wipe(dc_local_t *local)
+{
+    if (!local)
+        return;
+
+    if (local->stub)
+        call_stub_destroy(local->stub);
+
+    GF_FREE(local);
+}
+
+static dc_local_t *
+dc_local_get(call_frame_t *frame, fd_t *fd, off_t offset)
+{
+    dc_local_t *local = frame->local;
+
+    if (!local) {
+        local = GF_CALLOC(1, sizeof(*local), gf_dc_mt_dc_local_t);
+        if (!local)
+            return NULL;
+        frame->local = local;
+    }
+
+    gf_uuid_copy(local->gfid, fd->inode->gfid);
+    local->offset = offset;
+
+    return local;
+}
+
+static gf_boolean_t
+dc_fd_cacheable(dc_private_t *priv, fd_t *fd)
+{
+    if (!priv->enabled)
+        return _gf_false;
+
+    if (fd->flags & O_DIRECT)
+        return _gf_false;
+
+    return (fd->inode && IA_ISREG(fd->inode->ia_type) &&
+            !gf_uuid_is_null(fd->inode->gfid));
+}
+
+int
+dc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+              int op_errno, inode_t *inode, struct iatt *buf, dict_t *xdata,
+              struct iatt *postparent)
+{
+    dc_private_t *priv = this->private;
+
+    if ((op_ret == 0) && priv->enabled && IA_ISREG(buf->ia_type))
+        dc_validate(this, buf);
+
+    STACK_UNWIND_STRICT(lookup, frame, op_ret, op_errno, inode, buf, xdata,
+                        postparent);
+    return 0;
+}
+
+int
+dc_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    STACK_WIND(frame, dc_lookup_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lookup, loc, xdata);
+    return 0;
+}
+
+int
+dc_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                int op_errno, gf_dirent_t *entries, dict_t *xdata)
+{
+    dc_private_t *priv = this->private;
+    gf_dirent_t *entry = NULL;
+
+    if ((op_ret <= 0) || !priv->enabled)
+        goto unwind;
+
+    list_for_each_entry(entry, &entries->list, list)
+    {
+        if (IA_ISREG(entry->d_stat.ia_type))
+            dc_validate(this, &entry->d_stat);
+    }
+
+unwind:
+    STACK_UNWIND_STRICT(readdirp, frame, op_ret, op_errno, entries, xdata);
+    return 0;
+}
+
+int
+dc_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+            off_t offset, dict_t *xdata)
+{
+    STACK_WIND(frame, dc_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, fd, size, offset, xdata);
+    return 0;
+}
+
+/* Serves the read from the cache if every block it covers is there.
+ * Returns 0 if it did, 1 if the blocks are there but the attributes of
+ * the file have to be checked first, -1 otherwise.
+ */
+static int
+dc_readv_cached(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                off_t offset, dict_t *xdata, gf_boolean_t revalidate)
+{
+    dc_private_t *priv = this->private;
+    dc_entry_t *entry = NULL;
+    uint64_t bs = priv->conf.block_size;
+    uint64_t block = 0;
+    struct iobuf *iobuf = NULL;
+    struct iobref *iobref = NULL;
+    struct iovec iov = {
+        0,
+    };
+    struct iatt buf = {
+        0,
+    };
+    char path[PATH_MAX] = {
+        0,
+    };
+    dc_datafd_t *datafd = NULL;
+    uint64_t gen = 0;
+    off_t end = 0;
+    ssize_t len = 0;
+    int ret = -1;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dc_entry_get(priv, fd->inode->gfid);
+        if (!entry || !entry->cached || (offset >= entry->size))
+            goto unlock;
+
+        end = min(offset + size, entry->size);
+        for (block = offset / bs; block * bs < end; block++) {
+            if (!(entry->bitmap[block / 8] & (1 << (block % 8))))
+                goto unlock;
+        }
+
+        if (revalidate &&
+            (time(NULL) - entry->validated >= priv->conf.cache_timeout)) {
+            ret = 1;
+            goto unlock;
+        }
+
+        buf = entry->buf;
+        gen = entry->gen;
+        datafd = entry->datafd;
+        if (datafd)
+            GF_ATOMIC_INC(datafd->refcount);
+        list_move_tail(&entry->lru, &priv->lru);
+        ret = 0;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (ret)
+        return ret;
+
+    ret = -1;
+    len = end - offset;
+
+    iobuf = iobuf_get2(this->ctx->iobuf_pool, len);
+    if (!iobuf)
+        goto out;
+
+    iobref = iobref_new();
+    if (!iobref)
+        goto out;
+
+    iobref_add(iobref, iobuf);
+
+    if (!datafd) {
+        datafd = dc_datafd_open(this, fd->inode->gfid, gen);
+        if (!datafd)
+            goto out;
+    }
+
+    if (sys_pread(datafd->fd, iobuf->ptr, len, offset) != len)
+        goto out;
+
+    iov.iov_base = iobuf->ptr;
+    iov.iov_len = len;
+
+    GF_ATOMIC_INC(priv->stats.hits);
+    GF_ATOMIC_ADD(priv->stats.hit_bytes, len);
+
+    DC_STACK_UNWIND(readv, frame, len, 0, &iov, 1, &buf, iobref, xdata);
+    ret = 0;
+out:
+    if (ret) {
+        /* the data file is gone or damaged, do not trust it anymore */
+        dc_data_path(priv, fd->inode->gfid, path, sizeof(path));
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_READ_FAILED,
+               "cannot read %zd bytes at %" PRId64 " from cache file %s",
+               len, offset, path);
+        dc_invalidate(this, fd->inode->gfid);
+    }
+
+    dc_datafd_unref(datafd);
+
+    if (iobuf)
+        iobuf_unref(iobuf);
+
+    if (iobref)
+        iobref_unref(iobref);
+
+    return ret;
+}
+
+int
+dc_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+             int op_errno, struct iovec *vector, int count, struct iatt *stbuf,
+             struct iobref *iobref, dict_t *xdata)
+{
+    dc_private_t *priv = this->private;
+    dc_local_t *local = frame->local;
+
+    if ((op_ret <= 0) || !local || !stbuf || !IA_ISREG(stbuf->ia_type))
+        goto unwind;
+
+    if (gf_uuid_compare(local->gfid, stbuf->ia_gfid) == 0)
+        dc_fill(this, local->gfid, local->offset, vector, count, op_ret, stbuf,
+                iobref);
+
+unwind:
+    GF_ATOMIC_INC(priv->stats.misses);
+    DC_STACK_UNWIND(readv, frame, op_ret, op_errno, vector, count, stbuf,
+                    iobref, xdata);
+    return 0;
+}
+
+static int
+dc_readv_wind(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+              off_t offset, uint32_t flags, dict_t *xdata)
+{
+    dc_local_get(frame, fd, offset);
+
+    STACK_WIND(frame, dc_readv_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readv, fd, size, offset, flags, xdata);
+    return 0;
+}
+
+int
+dc_readv_resume(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                off_t offset, uint32_t flags, dict_t *xdata)
+{
+    if (dc_readv_cached(frame, this, fd, size, offset, xdata, _gf_false) == 0)
+        return 0;
+
+    return dc_readv_wind(frame, this, fd, size, offset, flags, xdata);
+}
+
+int
+dc_revalidate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, struct iatt *buf, dict_t *xdata)
+{
+    dc_private_t *priv = this->private;
+    dc_local_t *local = frame->local;
+    call_stub_t *stub = NULL;
+
+    GF_ATOMIC_INC(priv->stats.revalidations);
+
+    if (op_ret == 0)
+        dc_validate(this, buf);
+    else
+        dc_invalidate(this, local->gfid);
+
+    stub = local->stub;
+    local->stub = NULL;
+    call_resume(stub);
+
+    return 0;
+}
+
+int
+dc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+         off_t offset, uint32_t flags, dict_t *xdata)
+{
+    dc_private_t *priv = this->private;
+    dc_local_t *local = NULL;
+    int ret = -1;
+
+    if (!dc_fd_cacheable(priv, fd))
+        goto wind;
+
+    ret = dc_readv_cached(frame, this, fd, size, offset, xdata, _gf_true);
+    if (ret == 0)
+        return 0;
+
+    if (ret < 0)
+        return dc_readv_wind(frame, this, fd, size, offset, flags, xdata);
+
+    /* blocks are cached but their file may have changed since */
+    local = dc_local_get(frame, fd, offset);
+    if (!local)
+        goto wind;
+
+    local->stub = fop_readv_stub(frame, dc_readv_resume, fd, size, offset,
+                                 flags, xdata);
+    if (!local->stub)
+        return dc_readv_wind(frame, this, fd, size, offset, flags, xdata);
+
+    STACK_WIND(frame, dc_revalidate_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->fstat, fd, NULL);
+    return 0;
+
+wind:
+    STACK_WIND(frame, default_readv_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readv, fd, size, offset, flags, xdata);
+    return 0;
+}
+
+/* Modifications through this client drop the blocks of the file, before
+ * they are sent and again once they are done, for reads that raced them.
+ */
+#define DC_INVALIDATE(this, inode)                                             \
+    do {                                                                       \
+        dc_private_t *__priv = (this)->private;                                \
+        if (__priv->enabled && (inode) && !gf_uuid_is_null((inode)->gfid))     \
+            dc_invalidate(this, (inode)->gfid);                                \
+    } while (0)
+
+int
+dc_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+              int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+              dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(writev, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
+          int count, off_t offset, uint32_t flags, struct iobref *iobref,
+          dict_t *xdata)
+{
+    DC_INVALIDATE(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, dc_writev_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->writev, fd, vector, count,
+                      offset, flags, iobref, xdata);
+    return 0;
+}
+
+int
+dc_truncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+                dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(truncate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+            dict_t *xdata)
+{
+    DC_INVALIDATE(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, dc_truncate_cbk, loc->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->truncate, loc, offset, xdata);
+    return 0;
+}
+
+int
+dc_ftruncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                 int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+                 dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(ftruncate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             dict_t *xdata)
+{
+    DC_INVALIDATE(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, dc_ftruncate_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->ftruncate, fd, offset, xdata);
+    return 0;
+}
+
+int
+dc_fallocate_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                 int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+                 dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(fallocate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+             off_t offset, size_t len, dict_t *xdata)
+{
+    DC_INVALIDATE(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, dc_fallocate_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->fallocate, fd, mode, offset,
+                      len, xdata);
+    return 0;
+}
+
+int
+dc_discard_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+               int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+               dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(discard, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+           size_t len, dict_t *xdata)
+{
+    DC_INVALIDATE(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, dc_discard_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->discard, fd, offset, len, xdata);
+    return 0;
+}
+
+int
+dc_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                int op_errno, struct iatt *prebuf, struct iatt *postbuf,
+                dict_t *xdata)
+{
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(zerofill, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+int
+dc_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            off_t len, dict_t *xdata)
+{
+    DC_INVALIDATE(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, dc_zerofill_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->zerofill, fd, offset, len,
+                      xdata);
+    return 0;
+}
+
+int
+dc_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+            int op_errno, fd_t *fd, dict_t *xdata)
+{
+    /* blocks read while the truncate was in flight are stale too */
+    DC_INVALIDATE(this, (inode_t *)cookie);
+
+    STACK_UNWIND_STRICT(open, frame, op_ret, op_errno, fd, xdata);
+    return 0;
+}
+
+int
+dc_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+        fd_t *fd, dict_t *xdata)
+{
+    if (!(flags & O_TRUNC)) {
+        STACK_WIND(frame, default_open_cbk, FIRST_CHILD(this),
+                   FIRST_CHILD(this)->fops->open, loc, flags, fd, xdata);
+        return 0;
+    }
+
+    DC_INVALIDATE(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, dc_open_cbk, loc->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->open, loc, flags, fd, xdata);
+    return 0;
+}
+
+static int
+dc_upcall(xlator_t *this, struct gf_upcall *up_data)
+{
+    dc_private_t *priv = this->private;
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+
+    switch (up_data->event_type) {
+        case GF_UPCALL_CACHE_INVALIDATION:
+            up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+            if (!up_ci || !(up_ci->flags & UP_WRITE_FLAGS))
+                return 0;
+            break;
+        case GF_UPCALL_RECALL_LEASE:
+            /* another client is about to modify the file */
+            break;
+        default:
+            return 0;
+    }
+
+    GF_ATOMIC_INC(priv->stats.upcall_invalidations);
+    dc_invalidate(this, up_data->gfid);
+
+    return 0;
+}
+
+int
+dc_notify(xlator_t *this, int event, void *data, ...)
+{
+    dc_private_t *priv = this->private;
+    int ret = 0;
+
+    if ((event == GF_EVENT_UPCALL) && priv && priv->enabled)
+        ret = dc_upcall(this, data);
+
+    /* fini() is not called on unmount, save the index while we can */
+    if ((event == GF_EVENT_PARENT_DOWN) && priv && priv->enabled)
+        dc_index_save_request(this);
+
+    if (default_notify(this, event, data) != 0)
+        ret = -1;
+
+    return ret;
+}
+
+int
+dc_priv_dump(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+    dc_conf_t *conf = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    uint64_t entries = 0;
+    uint64_t cache_used = 0;
+
+    if (!priv)
+        return -1;
+
+    conf = &priv->conf;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.disk-cache",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("cache_dir", "%s", conf->cache_dir);
+    gf_proc_dump_write("enabled", "%s", priv->enabled ? "yes" : "no");
+    gf_proc_dump_write("cache_size", "%" PRIu64, conf->cache_size);
+    gf_proc_dump_write("block_size", "%" PRIu64, conf->block_size);
+    gf_proc_dump_write("cache_timeout", "%d", conf->cache_timeout);
+
+    if (!priv->enabled)
+        return 0;
+
+    LOCK(&priv->lock);
+    {
+        entries = priv->entries;
+        cache_used = priv->cache_used;
+    }
+    UNLOCK(&priv->lock);
+
+    gf_proc_dump_write("files_cached", "%" PRIu64, entries);
+    gf_proc_dump_write("cache_used", "%" PRIu64, cache_used);
+    gf_proc_dump_write("fill_pending", "%" PRIu64, priv->fill_pending);
+    gf_proc_dump_write("cache-hit", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.hits));
+    gf_proc_dump_write("cache-miss", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.misses));
+    gf_proc_dump_write("hit-bytes", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.hit_bytes));
+    gf_proc_dump_write("fill-bytes", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.fill_bytes));
+    gf_proc_dump_write("fills-dropped", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.fills_dropped));
+    gf_proc_dump_write("revalidations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.revalidations));
+    gf_proc_dump_write("invalidations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.invalidations));
+    gf_proc_dump_write("upcall-invalidations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.upcall_invalidations));
+    gf_proc_dump_write("evictions", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.evictions));
+    gf_proc_dump_write("index-saves", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.index_saves));
+    gf_proc_dump_write("open-data-files", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->datafds));
+
+    return 0;
+}
+
+int32_t
+dc_mem_acct_init(xlator_t *this)
+{
+    int ret = -1;
+
+    if (!this)
+        return ret;
+
+    ret = xlator_mem_acct_init(this, gf_dc_mt_end + 1);
+    if (ret != 0) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, DC_MSG_NO_MEMORY,
+               "Memory accounting init failed");
+        return ret;
+    }
+
+    return ret;
+}
+
+/* Creates the directories of the cache and takes a lock on it, so that two
+ * clients on the node never share a cache-dir.
+ */
+static int
+dc_cache_dir_init(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+    char path[PATH_MAX];
+    int i = 0;
+
+    if ((sys_mkdir(priv->conf.cache_dir, 0700) != 0) && (errno != EEXIST))
+        goto err;
+
+    for (i = 0; i < 256; i++) {
+        snprintf(path, sizeof(path), "%s/%02x", priv->conf.cache_dir, i);
+        if ((sys_mkdir(path, 0700) != 0) && (errno != EEXIST))
+            goto err;
+    }
+
+    snprintf(path, sizeof(path), "%s/lock", priv->conf.cache_dir);
+    priv->index_fd = sys_open(path, O_CREAT | O_RDWR, 0600);
+    if (priv->index_fd < 0)
+        goto err;
+
+    if (flock(priv->index_fd, LOCK_EX | LOCK_NB) != 0) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_CACHE_DIR_BUSY,
+               "cache directory %s is in use by another client, disk "
+               "caching disabled",
+               priv->conf.cache_dir);
+        sys_close(priv->index_fd);
+        priv->index_fd = -1;
+        return -1;
+    }
+
+    return 0;
+err:
+    gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_NO_CACHE_DIR,
+           "cannot set up cache directory %s (%s), disk caching disabled",
+           priv->conf.cache_dir, path);
+    return -1;
+}
+
+int
+dc_reconfigure(xlator_t *this, dict_t *options)
+{
+    dc_private_t *priv = this->private;
+    dc_conf_t *conf = &priv->conf;
+    int ret = -1;
+
+    GF_OPTION_RECONF("cache-size", conf->cache_size, options, size_uint64,
+                     out);
+
+    GF_OPTION_RECONF("cache-timeout", conf->cache_timeout, options, int32, out);
+
+    GF_OPTION_RECONF("ctime-invalidation", conf->ctime_invalidation, options,
+                     bool, out);
+
+    ret = 0;
+out:
+    return ret;
+}
+
+int
+dc_init(xlator_t *this)
+{
+    dc_private_t *priv = NULL;
+    dc_conf_t *conf = NULL;
+    char *cache_dir = NULL;
+    int ret = -1;
+    int i = 0;
+
+    if (!this->children || this->children->next) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, DC_MSG_XLATOR_CHILD_MISCONFIGURED,
+               "FATAL: volume (%s) not configured with exactly one "
+               "child",
+               this->name);
+        return -1;
+    }
+
+    if (!this->parents) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, DC_MSG_VOL_MISCONFIGURED,
+               "dangling volume. check volfile ");
+    }
+
+    priv = GF_CALLOC(1, sizeof(*priv), gf_dc_mt_dc_private_t);
+    if (!priv)
+        goto out;
+
+    conf = &priv->conf;
+    priv->index_fd = -1;
+    LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->lru);
+    INIT_LIST_HEAD(&priv->fills);
+    pthread_mutex_init(&priv->fill_lock, NULL);
+    pthread_cond_init(&priv->fill_cond, NULL);
+
+    GF_ATOMIC_INIT(priv->stats.hits, 0);
+    GF_ATOMIC_INIT(priv->stats.misses, 0);
+    GF_ATOMIC_INIT(priv->stats.hit_bytes, 0);
+    GF_ATOMIC_INIT(priv->stats.fill_bytes, 0);
+    GF_ATOMIC_INIT(priv->stats.fills_dropped, 0);
+    GF_ATOMIC_INIT(priv->stats.revalidations, 0);
+    GF_ATOMIC_INIT(priv->stats.invalidations, 0);
+    GF_ATOMIC_INIT(priv->stats.upcall_invalidations, 0);
+    GF_ATOMIC_INIT(priv->stats.evictions, 0);
+    GF_ATOMIC_INIT(priv->stats.index_saves, 0);
+    GF_ATOMIC_INIT(priv->datafds, 0);
+
+    this->private = priv;
+
+    GF_OPTION_INIT("cache-dir", cache_dir, str, out);
+    GF_OPTION_INIT("cache-size", conf->cache_size, size_uint64, out);
+    GF_OPTION_INIT("block-size", conf->block_size, size_uint64, out);
+    GF_OPTION_INIT("cache-timeout", conf->cache_timeout, int32, out);
+    GF_OPTION_INIT("ctime-invalidation", conf->ctime_invalidation, bool, out);
+
+    ret = 0;
+
+    if (!cache_dir) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, DC_MSG_NO_CACHE_DIR,
+               "cache-dir is not set, disk caching disabled");
+        goto out;
+    }
+
+    conf->cache_dir = gf_strdup(cache_dir);
+    if (!conf->cache_dir) {
+        ret = -1;
+        goto out;
+    }
+
+    priv->hash = GF_CALLOC(DC_HASH_SIZE, sizeof(*priv->hash),
+                           gf_common_mt_list_head);
+    if (!priv->hash) {
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < DC_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&priv->hash[i]);
+
+    if (dc_cache_dir_init(this) != 0)
+        goto out;
+
+    dc_index_load(this);
+    priv->last_save = time(NULL);
+
+    if (gf_thread_create(&priv->worker, NULL, dc_worker, this, "dcfill")) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, DC_MSG_THREAD_FAILED,
+               "cannot start the cache thread, disk caching disabled");
+        dc_cache_destroy(priv);
+        goto out;
+    }
+
+    priv->worker_started = _gf_true;
+    priv->enabled = _gf_true;
+
+    gf_msg(this->name, GF_LOG_INFO, 0, DC_MSG_CACHE_READY,
+           "caching in %s, %" PRIu64 " files and %" PRIu64 " bytes cached",
+           conf->cache_dir, priv->entries, priv->cache_used);
+out:
+    if (ret && priv) {
+        this->private = NULL;
+        pthread_mutex_destroy(&priv->fill_lock);
+        pthread_cond_destroy(&priv->fill_cond);
+        LOCK_DESTROY(&priv->lock);
+        GF_FREE(priv->hash);
+        GF_FREE(conf->cache_dir);
+        GF_FREE(priv);
+    }
+
+    return ret;
+}
+
+void
+dc_fini(xlator_t *this)
+{
+    dc_private_t *priv = this->private;
+
+    if (!priv)
+        return;
+
+    if (priv->worker_started) {
+        pthread_mutex_lock(&priv->fill_lock);
+        {
+            priv->fini = _gf_true;
+            pthread_cond_signal(&priv->fill_cond);
+        }
+        pthread_mutex_unlock(&priv->fill_lock);
+
+        pthread_join(priv->worker, NULL);
+
+        /* fills still queued are dropped, the index only has what is
+         * on disk already */
+        dc_index_save(this);
+    }
+
+    this->private = NULL;
+
+    dc_cache_destroy(priv);
+
+    if (priv->index_fd >= 0)
+        sys_close(priv->index_fd);
+
+    pthread_mutex_destroy(&priv->fill_lock);
+    pthread_cond_destroy(&priv->fill_cond);
+    LOCK_DESTROY(&priv->lock);
+    GF_FREE(priv->conf.cache_dir);
+    GF_FREE(priv);
+}
+
+struct xlator_fops dc_fops = {
+    .lookup = dc_lookup,
+    .readdirp = dc_readdirp,
+    .open = dc_open,
+    .readv = dc_readv,
+    .writev = dc_writev,
+    .truncate = dc_truncate,
+    .ftruncate = dc_ftruncate,
+    .fallocate = dc_fallocate,
+    .discard = dc_discard,
+    .zerofill = dc_zerofill,
+};
+
+struct xlator_cbks dc_cbks;
+
+struct xlator_dumpops dc_dumpops = {
+    .priv = dc_priv_dump,
+};
+
+struct volume_options dc_options[] = {
+    {
+        .key = {"disk-cache"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .description = "enable/disable disk-cache",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+    },
+    {
+        .key = {"cache-dir"},
+        .type = GF_OPTION_TYPE_PATH,
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Local directory, on a fast local disk, where file "
+                       "data read from the volume is kept across remounts. "
+                       "Only one client process can use a directory. "
+                       "Caching is disabled while it is not set.",
+    },
+    {
+        .key = {"cache-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 16 * GF_UNIT_MB,
+        .max = 16 * GF_UNIT_TB,
+        .default_value = "10GB",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Space the cached data can take in cache-dir. The "
+                       "least recently used files are dropped beyond it.",
+    },
+    {
+        .key = {"block-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 4 * GF_UNIT_KB,
+        .max = 4 * GF_UNIT_MB,
+        .default_value = "128KB",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Unit in which file data is cached. Only reads "
+                       "covering whole blocks fill the cache. Changing it "
+                       "drops what was cached, at the next mount.",
+    },
+    {
+        .key = {"cache-timeout"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 600,
+        .default_value = "1",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Seconds cached blocks are served for before the "
+                       "attributes of their file are checked again with "
+                       "the bricks.",
+    },
+    {
+        .key = {"ctime-invalidation"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "false",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Check ctime along with mtime and size to tell "
+                       "whether a file changed, for applications that set "
+                       "mtime explicitly. Attribute changes then drop the "
+                       "cached data too.",
+    },
+    {.key = {NULL}},
+};
+
+xlator_api_t xlator_api = {
+    .init = dc_init,
+    .fini = dc_fini,
+    .notify = dc_notify,
+    .reconfigure = dc_reconfigure,
+    .mem_acct_init = dc_mem_acct_init,
+    .op_version = {GD_OP_VERSION_8_0},
+    .dumpops = &dc_dumpops,
+    .fops = &dc_fops,
+    .cbks = &dc_cbks,
+    .options = dc_options,
+    .identifier = "disk-cache",
+    .category = GF_TECH_PREVIEW,
+};
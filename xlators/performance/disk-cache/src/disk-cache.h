@@ -0,0 +1,202 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __DISK_CACHE_H__
+#define __DISK_CACHE_H__
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/defaults.h>
+#include <glusterfs/list.h>
+#include <glusterfs/locking.h>
+#include <glusterfs/common-utils.h>
+#include <glusterfs/call-stub.h>
+#include "disk-cache-mem-types.h"
+#include "disk-cache-messages.h"
+
+/* Blocks of a file are kept at their own offset in a sparse data file,
+ * <cache-dir>/<first byte of the gfid>/<gfid>, and an index of the blocks
+ * present in every data file is saved in <cache-dir>/index.
+ */
+#define DC_INDEX_NAME "index"
+#define DC_INDEX_MAGIC 0x47464443 /* "GFDC" */
+#define DC_INDEX_VERSION 1
+
+#define DC_HASH_SIZE 4096
+#define DC_INDEX_SYNC_INTERVAL 30 /* seconds */
+
+/* the index is saved once the fills queued are written, at most this
+ * often: fuse does not call the fini() of the graph on unmount */
+#define DC_INDEX_FILL_INTERVAL 1 /* seconds */
+
+/* data files kept open by their entries for the reads served from the
+ * cache; beyond this many, a hit opens and closes the data file */
+#define DC_MAX_OPEN_DATA_FILES 1024
+
+/* fills waiting for the worker thread hold on to the data read; beyond
+ * this many bytes new fills are dropped
+ */
+#define DC_FILL_QUEUE_LIMIT (64 * GF_UNIT_MB)
+
+struct dc_index_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t block_size;
+    uint64_t count;
+};
+
+/* followed by (nblocks + 7) / 8 bytes of bitmap */
+struct dc_index_record {
+    unsigned char gfid[16];
+    uint64_t size;
+    int64_t mtime;
+    int64_t ctime;
+    uint32_t mtime_nsec;
+    uint32_t ctime_nsec;
+    uint32_t nblocks;
+    uint32_t pad;
+};
+
+/* an open data file, shared by the reads served from it */
+struct dc_datafd {
+    gf_atomic_t refcount;
+    int fd;
+};
+typedef struct dc_datafd dc_datafd_t;
+
+struct dc_entry {
+    struct list_head hash;
+    struct list_head lru;
+    uuid_t gfid;
+    /* attributes of the file the cached blocks belong to */
+    uint64_t size;
+    int64_t mtime;
+    int64_t ctime;
+    uint32_t mtime_nsec;
+    uint32_t ctime_nsec;
+    uint64_t gen;       /* bumped every time the blocks are dropped */
+    time_t validated;   /* attributes last checked against the bricks */
+    struct iatt buf;    /* as last validated, not saved in the index */
+    uint32_t nblocks;   /* bits in bitmap */
+    uint32_t cached;    /* bits set in bitmap */
+    unsigned char *bitmap;
+    dc_datafd_t *datafd; /* opened by the first hit */
+    gf_boolean_t dirty;  /* blocks written since the index was saved */
+};
+typedef struct dc_entry dc_entry_t;
+
+struct dc_fill {
+    struct list_head list;
+    uuid_t gfid;
+    uint64_t gen;
+    off_t offset; /* block aligned */
+    size_t size;  /* 0 to only truncate the data file */
+    struct iovec *vector;
+    int count;
+    struct iobref *iobref;
+};
+typedef struct dc_fill dc_fill_t;
+
+struct dc_local {
+    uuid_t gfid;
+    off_t offset;
+    call_stub_t *stub;
+};
+typedef struct dc_local dc_local_t;
+
+struct dc_statistics {
+    gf_atomic_t hits;
+    gf_atomic_t misses;
+    gf_atomic_t hit_bytes;
+    gf_atomic_t fill_bytes;
+    gf_atomic_t fills_dropped;
+    gf_atomic_t revalidations;
+    gf_atomic_t invalidations;
+    gf_atomic_t upcall_invalidations;
+    gf_atomic_t evictions;
+    gf_atomic_t index_saves;
+};
+
+struct dc_conf {
+    char *cache_dir;
+    uint64_t cache_size;
+    uint64_t block_size;
+    int32_t cache_timeout;
+    gf_boolean_t ctime_invalidation;
+};
+typedef struct dc_conf dc_conf_t;
+
+struct dc_private {
+    dc_conf_t conf;
+    gf_boolean_t enabled;
+    int index_fd; /* locked, one client process per cache-dir */
+
+    gf_lock_t lock;
+    struct list_head *hash;
+    struct list_head lru;
+    uint64_t entries;
+    uint64_t cache_used;
+    uint64_t gen;
+
+    pthread_t worker;
+    gf_boolean_t worker_started;
+    pthread_mutex_t fill_lock;
+    pthread_cond_t fill_cond;
+    struct list_head fills;
+    uint64_t fill_pending;
+    gf_boolean_t fini;
+    gf_boolean_t save;   /* save the index now */
+    gf_boolean_t filled; /* blocks written since the index was saved */
+    time_t last_save;
+    gf_atomic_t datafds; /* data files kept open by entries */
+
+    struct dc_statistics stats;
+};
+typedef struct dc_private dc_private_t;
+
+/* disk-cache-index.c */
+dc_entry_t *
+__dc_entry_get(dc_private_t *priv, uuid_t gfid);
+
+void
+dc_data_path(dc_private_t *priv, uuid_t gfid, char *path, size_t len);
+
+void
+dc_invalidate(xlator_t *this, uuid_t gfid);
+
+void
+dc_validate(xlator_t *this, struct iatt *buf);
+
+dc_datafd_t *
+dc_datafd_open(xlator_t *this, uuid_t gfid, uint64_t gen);
+
+void
+dc_datafd_unref(dc_datafd_t *datafd);
+
+void
+dc_index_save_request(xlator_t *this);
+
+void
+dc_fill(xlator_t *this, uuid_t gfid, off_t offset, struct iovec *vector,
+        int count, size_t size, struct iatt *stbuf, struct iobref *iobref);
+
+int
+dc_index_load(xlator_t *this);
+
+int
+dc_index_save(xlator_t *this);
+
+void *
+dc_worker(void *data);
+
+void
+dc_cache_destroy(dc_private_t *priv);
+
+#endif /* __DISK_CACHE_H__ */
@@ -16,6 +16,7 @@
 #include "io-cache.h"
 #include "ioc-mem-types.h"
 #include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
 #include <assert.h>
 #include <sys/time.h>
 #include "io-cache-messages.h"
@@ -144,6 +145,10 @@ ioc_inode_need_revalidate(ioc_inode_t *ioc_inode)
 
     table = ioc_inode->table;
 
+    /* the lease is recalled before the file changes */
+    if (ioc_inode->leased)
+        return 0;
+
     gettimeofday(&tv, NULL);
 
     if (time_elapsed(&tv, &ioc_inode->cache.tv) >= table->cache_timeout)
@@ -283,6 +288,39 @@ out:
     return 0;
 }
 
+/*
+ * ioc_inode_lease_set - GF_CACHE_LEASE_KEY in the reply of a lookup:
+ * cache-leases holds a read lease on the file, its pages need no
+ * revalidation until it is invalidated (see ioc_notify()).
+ *
+ * @invalidations: table->invalidations when the lookup was sent, a lease
+ *                 that went away meanwhile is not trusted
+ */
+static void
+ioc_inode_lease_set(xlator_t *this, inode_t *inode, dict_t *xdata,
+                    uint64_t invalidations)
+{
+    ioc_table_t *table = this->private;
+    uint64_t tmp_ioc_inode = 0;
+    ioc_inode_t *ioc_inode = NULL;
+
+    inode_ctx_get(inode, this, &tmp_ioc_inode);
+    ioc_inode = (ioc_inode_t *)(long)tmp_ioc_inode;
+    if (ioc_inode == NULL)
+        return;
+
+    ioc_inode_lock(ioc_inode);
+    {
+        /* read without the lock by ioc_index_read() */
+        __atomic_store_n(&ioc_inode->leased,
+                         (xdata && dict_get_sizen(xdata, GF_CACHE_LEASE_KEY) &&
+                          (GF_ATOMIC_GET(table->invalidations) ==
+                           invalidations)),
+                         __ATOMIC_RELEASE);
+    }
+    ioc_inode_unlock(ioc_inode);
+}
+
 int32_t
 ioc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -307,6 +345,7 @@ ioc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     ioc_inode_update(this, inode, (char *)local->file_loc.path, stbuf);
+    ioc_inode_lease_set(this, inode, xdata, local->invalidations);
 
 out:
     if (frame->local != NULL) {
@@ -342,6 +381,8 @@ ioc_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
     }
 
     frame->local = local;
+    local->invalidations = GF_ATOMIC_GET(
+        ((ioc_table_t *)this->private)->invalidations);
 
     STACK_WIND(frame, ioc_lookup_cbk, FIRST_CHILD(this),
                FIRST_CHILD(this)->fops->lookup, loc, xdata);
@@ -457,6 +498,7 @@ ioc_cache_validate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     ioc_inode_lock(ioc_inode);
     {
         memcpy(&ioc_inode->cache.tv, &tv, sizeof(struct timeval));
+        __ioc_index_validated(ioc_inode, tv.tv_sec);
     }
     ioc_inode_unlock(ioc_inode);
 
@@ -501,7 +543,7 @@ ioc_wait_on_inode(ioc_inode_t *ioc_inode, ioc_page_t *page)
 
         waiter->data = page;
         waiter->next = ioc_inode->waitq;
-        ioc_inode->waitq = waiter;
+        __atomic_store_n(&ioc_inode->waitq, waiter, __ATOMIC_RELEASE);
     }
 
 out:
@@ -1126,6 +1168,12 @@ ioc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     uint32_t weight = 0;
     ioc_table_t *table = NULL;
     int32_t op_errno = EINVAL;
+    struct iovec vector[IOC_INDEX_MAX_IOV];
+    struct iobref *iobref = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    int32_t count = 0;
 
     if (!this) {
         goto out;
@@ -1158,6 +1206,26 @@ ioc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto out;
     }
 
+    /* the index, once created, lives as long as ioc_inode */
+    if (table->lockless_read &&
+        __atomic_load_n(&ioc_inode->cache.index, __ATOMIC_ACQUIRE)) {
+        if (!fd_ctx_get(fd, this, NULL)) {
+            STACK_WIND_TAIL(frame, FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->readv, fd, size, offset,
+                            flags, xdata);
+            return 0;
+        }
+
+        if (ioc_index_read(ioc_inode, offset, size, vector, &count, &iobref,
+                           &op_errno)) {
+            STACK_UNWIND_STRICT(readv, frame, iov_length(vector, count),
+                                op_errno, vector, count, &stbuf, iobref,
+                                NULL);
+            iobref_unref(iobref);
+            return 0;
+        }
+    }
+
     ioc_inode_lock(ioc_inode);
     {
         if (!ioc_inode->cache.page_table) {
@@ -1171,6 +1239,10 @@ ioc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 goto out;
             }
         }
+
+        if (table->lockless_read && !ioc_inode->cache.index)
+            __atomic_store_n(&ioc_inode->cache.index,
+                             ioc_index_new(ioc_inode), __ATOMIC_RELEASE);
     }
     ioc_inode_unlock(ioc_inode);
 
@@ -1430,6 +1502,7 @@ ioc_lk(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t cmd,
     ioc_inode_lock(ioc_inode);
     {
         memcpy(&ioc_inode->cache.tv, &tv, sizeof(struct timeval));
+        __ioc_index_validated(ioc_inode, tv.tv_sec);
     }
     ioc_inode_unlock(ioc_inode);
 
@@ -1700,6 +1773,9 @@ reconfigure(xlator_t *this, dict_t *options)
         GF_OPTION_RECONF("cache-timeout", table->cache_timeout, options, int32,
                          unlock);
 
+        GF_OPTION_RECONF("lockless-read", table->lockless_read, options, bool,
+                         unlock);
+
         data = dict_get(options, "priority");
         if (data) {
             char *option_list = data_to_str(data);
@@ -1802,6 +1878,10 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("max-file-size", table->max_file_size, size_uint64, out);
 
+    GF_OPTION_INIT("lockless-read", table->lockless_read, bool, out);
+
+    GF_ATOMIC_INIT(table->invalidations, 0);
+
     if (!check_cache_size_ok(this, table->cache_size)) {
         ret = -1;
         goto out;
@@ -1983,6 +2063,10 @@ __ioc_cache_dump(ioc_inode_t *ioc_inode, char *prefix)
         gf_proc_dump_write("last-cache-validation-time", "%s", timestr);
     }
 
+    if (ioc_inode->cache.index)
+        gf_proc_dump_write("lockless-hits", "%" PRIu64,
+                           GF_ATOMIC_GET(ioc_inode->cache.index->hits));
+
     for (offset = 0; offset < ioc_inode->ia_size; offset += table->page_size) {
         page = __ioc_page_get(ioc_inode, offset);
         if (page == NULL) {
@@ -2039,6 +2123,7 @@ ioc_inode_dump(xlator_t *this, inode_t *inode)
         __inode_path(ioc_inode->inode, NULL, &path);
 
         gf_proc_dump_write("inode.weight", "%d", ioc_inode->weight);
+        gf_proc_dump_write("leased", "%d", ioc_inode->leased);
 
         if (path) {
             gf_proc_dump_write("path", "%s", path);
@@ -2094,6 +2179,8 @@ ioc_priv_dump(xlator_t *this)
         gf_proc_dump_write("cache_timeout", "%u", priv->cache_timeout);
         gf_proc_dump_write("min-file-size", "%" PRIu64, priv->min_file_size);
         gf_proc_dump_write("max-file-size", "%" PRIu64, priv->max_file_size);
+        gf_proc_dump_write("lockless-read", "%s",
+                           priv->lockless_read ? "on" : "off");
     }
     pthread_mutex_unlock(&priv->table_lock);
 out:
@@ -2163,6 +2250,60 @@ fini(xlator_t *this)
     return;
 }
 
+/*
+ * ioc_notify - cache-leases gives the lease on a file back: its pages are
+ * dropped, the next reads revalidate as usual
+ */
+int
+ioc_notify(xlator_t *this, int event, void *data, ...)
+{
+    ioc_table_t *table = this->private;
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+    uint64_t tmp_ioc_inode = 0;
+    ioc_inode_t *ioc_inode = NULL;
+
+    if (event != GF_EVENT_UPCALL || table == NULL)
+        goto out;
+
+    up_data = (struct gf_upcall *)data;
+    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+        goto out;
+
+    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+    if (!up_ci->dict || !dict_get_sizen(up_ci->dict, GF_CACHE_LEASE_KEY))
+        goto out;
+
+    GF_ATOMIC_INC(table->invalidations);
+
+    itable = ((xlator_t *)this->graph->top)->itable;
+    if (itable == NULL)
+        goto out;
+
+    inode = inode_find(itable, up_data->gfid);
+    if (inode == NULL)
+        goto out;
+
+    inode_ctx_get(inode, this, &tmp_ioc_inode);
+    ioc_inode = (ioc_inode_t *)(long)tmp_ioc_inode;
+    if (ioc_inode) {
+        ioc_inode_lock(ioc_inode);
+        {
+            __atomic_store_n(&ioc_inode->leased, _gf_false,
+                             __ATOMIC_RELEASE);
+        }
+        ioc_inode_unlock(ioc_inode);
+
+        ioc_inode_flush(ioc_inode);
+    }
+
+    inode_unref(inode);
+out:
+    return default_notify(this, event, data);
+}
+
 struct xlator_fops fops = {
     .open = ioc_open,
     .create = ioc_create,
@@ -2248,12 +2389,22 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"io-cache"},
      .description = "Enable/Disable io cache translator"},
+    {.key = {"lockless-read"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "on",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"io-cache"},
+     .description = "Serve reads of cached pages, which need no "
+                    "revalidation, from a per-inode page index without "
+                    "taking the inode and table locks."},
     {.key = {NULL}},
 };
 
 xlator_api_t xlator_api = {
     .init = init,
     .fini = fini,
+    .notify = ioc_notify,
     .reconfigure = reconfigure,
     .mem_acct_init = mem_acct_init,
     .op_version = {1}, /* Present from the initial version */
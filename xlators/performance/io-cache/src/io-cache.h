@@ -25,6 +25,8 @@
 #define IOC_PAGE_SIZE (1024 * 128) /* 128KB */
 #define IOC_CACHE_SIZE (32 * 1024 * 1024)
 #define IOC_PAGE_TABLE_BUCKET_COUNT 1
+#define IOC_INDEX_SLOTS 64 /* slots of the lock-free page index */
+#define IOC_INDEX_MAX_IOV 4
 
 struct ioc_table;
 struct ioc_local;
@@ -91,6 +93,7 @@ struct ioc_local {
     struct iobref *iobref;
     int32_t need_xattr;
     dict_t *xattr_req;
+    uint64_t invalidations; /* table->invalidations at wind time */
 };
 
 /*
@@ -112,10 +115,60 @@ struct ioc_page {
     pthread_mutex_t page_lock;
     int32_t op_errno;
     char stale;
+    struct ioc_retired *retired; /* for @iobref, taken once published */
+};
+
+/*
+ * ioc_slot - a ready page, as seen by readers that take no lock
+ *
+ * Slots are changed under the inode lock, with @seq odd while they are.
+ * Readers copy a slot and only use the copy if @seq did not move. @page is
+ * only looked at by writers, to tell which page the slot holds.
+ */
+struct ioc_slot {
+    gf_atomic_uint32_t seq;
+    gf_atomic_int32_t referenced; /* read since the last prune */
+    struct ioc_page *page;
+    off_t offset;
+    size_t size;
+    int32_t count;
+    int32_t op_errno;
+    struct iovec vector[IOC_INDEX_MAX_IOV];
+    struct iobref *iobref;
+};
+
+struct ioc_retired {
+    struct ioc_retired *next;
+    struct iobref *iobref;
+};
+
+/*
+ * ioc_index - index of the ready pages of an inode, for cache hits that
+ *             do not take the table, inode or page locks
+ *
+ * A reader counts itself in @readers[epoch & 1] while it looks at the
+ * slots. The iobref of a page leaving the index is retired instead of
+ * being released, until no reader can still be looking at it (see
+ * __ioc_index_reclaim()).
+ */
+struct ioc_index {
+    struct ioc_slot slots[IOC_INDEX_SLOTS];
+    gf_atomic_t epoch;
+    gf_atomic_t readers[2];
+    gf_atomic_t validated;        /* when the cache was last validated */
+    gf_atomic_t hits;
+    gf_atomic_int32_t referenced; /* read since the last prune */
+    gf_atomic_int32_t pending;    /* retired iobrefs not released yet */
+    struct ioc_retired *retired;  /* retired in the current epoch */
+    struct ioc_retired *waiting;  /* waiting for readers[waiting_on] */
+    int32_t waiting_on;
 };
 
 struct ioc_cache {
     rbthash_table_t *page_table;
+    struct ioc_index *index; /* set once, never changes until destroy;
+                                read with __atomic_load_n() without the
+                                inode lock */
     struct list_head page_lru;
     time_t mtime;      /*
                         * seconds component of file mtime
@@ -144,6 +197,7 @@ struct ioc_inode {
                       * on each read
                       */
     inode_t *inode;
+    gf_boolean_t leased; /* under a lease of cache-leases, no revalidation */
 };
 
 struct ioc_table {
@@ -163,6 +217,8 @@ struct ioc_table {
     int32_t cache_timeout;
     int32_t max_pri;
     struct mem_pool *mem_pool;
+    gf_boolean_t lockless_read;
+    gf_atomic_t invalidations; /* leased inodes invalidated */
 };
 
 typedef struct ioc_table ioc_table_t;
@@ -216,6 +272,29 @@ int32_t
 ioc_frame_fill(ioc_page_t *page, call_frame_t *frame, off_t offset, size_t size,
                int32_t op_errno);
 
+struct ioc_index *
+ioc_index_new(ioc_inode_t *ioc_inode);
+
+void
+ioc_index_destroy(struct ioc_index *index);
+
+void
+__ioc_page_publish(ioc_page_t *page);
+
+void
+__ioc_page_unpublish(ioc_page_t *page);
+
+void
+__ioc_page_release(ioc_page_t *page);
+
+void
+__ioc_index_validated(ioc_inode_t *ioc_inode, time_t when);
+
+gf_boolean_t
+ioc_index_read(ioc_inode_t *ioc_inode, off_t offset, size_t size,
+               struct iovec *vector, int32_t *count, struct iobref **iobref,
+               int32_t *op_errno);
+
 #define ioc_inode_lock(ioc_inode)                                              \
     do {                                                                       \
         gf_msg_trace(ioc_inode->table->xl->name, 0, "locked inode(%p)",        \
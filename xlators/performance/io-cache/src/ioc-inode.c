@@ -100,7 +100,8 @@ ioc_inode_wakeup(call_frame_t *frame, ioc_inode_t *ioc_inode,
 
         while (waiter) {
             waiter_page = waiter->data;
-            ioc_inode->waitq = waiter->next;
+            __atomic_store_n(&ioc_inode->waitq, waiter->next,
+                             __ATOMIC_RELEASE);
             page_waitq = NULL;
 
             if (waiter_page) {
@@ -119,6 +120,7 @@ ioc_inode_wakeup(call_frame_t *frame, ioc_inode_t *ioc_inode,
                      */
                     if (waiter_page->ready) {
                         waiter_page->ready = 0;
+                        __ioc_page_unpublish(waiter_page);
                         need_fault = 1;
                     } else {
                         gf_msg_trace(frame->this->name, 0,
@@ -221,6 +223,7 @@ ioc_inode_destroy(ioc_inode_t *ioc_inode)
 
     ioc_inode_flush(ioc_inode);
     rbthash_table_destroy(ioc_inode->cache.page_table);
+    ioc_index_destroy(ioc_inode->cache.index);
 
     pthread_mutex_destroy(&ioc_inode->inode_lock);
     GF_FREE(ioc_inode);
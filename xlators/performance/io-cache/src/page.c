@@ -17,6 +17,12 @@
 #include <assert.h>
 #include <sys/time.h>
 #include "io-cache-messages.h"
+
+extern int ioc_log2_page_size;
+
+#define IOC_SLOT(index, offset)                                                \
+    (&(index)->slots[((offset) >> ioc_log2_page_size) % IOC_INDEX_SLOTS])
+
 char
 ioc_empty(struct ioc_cache *cache)
 {
@@ -95,6 +101,7 @@ __ioc_page_destroy(ioc_page_t *page)
         /* frames waiting on this page, do not destroy this page */
         page_size = -1;
         page->stale = 1;
+        __ioc_page_unpublish(page);
     } else {
         rbthash_remove(page->inode->cache.page_table, &page->offset,
                        sizeof(page->offset));
@@ -106,17 +113,15 @@ __ioc_page_destroy(ioc_page_t *page)
                      "&& inode = %p",
                      page, page->offset, page->inode);
 
-        if (page->vector) {
-            iobref_unref(page->iobref);
-            GF_FREE(page->vector);
-            page->vector = NULL;
-        }
+        if (page->vector)
+            __ioc_page_release(page);
 
         page->inode = NULL;
     }
 
     if (page_size != -1) {
         pthread_mutex_destroy(&page->page_lock);
+        GF_FREE(page->retired);
         GF_FREE(page);
     }
 
@@ -145,6 +150,60 @@ out:
     return ret;
 }
 
+/*
+ * Cache hits served from the index do not move pages and inodes in the lru
+ * lists, that would take the locks the index is there to avoid. They mark
+ * them referenced instead, and they are moved here, before pruning.
+ */
+static void
+__ioc_page_lru_refresh(ioc_inode_t *curr)
+{
+    struct ioc_index *index = curr->cache.index;
+    struct ioc_slot *slot = NULL;
+    ioc_page_t *page = NULL, *next = NULL, *last = NULL;
+
+    if (!index || list_empty(&curr->cache.page_lru))
+        return;
+
+    last = list_entry(curr->cache.page_lru.prev, ioc_page_t, page_lru);
+
+    list_for_each_entry_safe(page, next, &curr->cache.page_lru, page_lru)
+    {
+        slot = IOC_SLOT(index, page->offset);
+        if ((slot->page == page) && GF_ATOMIC_GET(slot->referenced)) {
+            GF_ATOMIC_SWAP(slot->referenced, 0);
+            list_move_tail(&page->page_lru, &curr->cache.page_lru);
+        }
+
+        if (page == last)
+            break;
+    }
+}
+
+static void
+__ioc_inode_lru_refresh(struct list_head *inode_lru)
+{
+    ioc_inode_t *curr = NULL, *next = NULL, *last = NULL;
+    struct ioc_index *index = NULL;
+
+    if (list_empty(inode_lru))
+        return;
+
+    last = list_entry(inode_lru->prev, ioc_inode_t, inode_lru);
+
+    list_for_each_entry_safe(curr, next, inode_lru, inode_lru)
+    {
+        index = curr->cache.index;
+        if (index && GF_ATOMIC_GET(index->referenced)) {
+            GF_ATOMIC_SWAP(index->referenced, 0);
+            list_move_tail(&curr->inode_lru, inode_lru);
+        }
+
+        if (curr == last)
+            break;
+    }
+}
+
 int32_t
 __ioc_inode_prune(ioc_inode_t *curr, uint64_t *size_pruned,
                   uint64_t size_to_prune, uint32_t index)
@@ -159,6 +218,8 @@ __ioc_inode_prune(ioc_inode_t *curr, uint64_t *size_pruned,
 
     table = curr->table;
 
+    __ioc_page_lru_refresh(curr);
+
     list_for_each_entry_safe(page, next, &curr->cache.page_lru, page_lru)
     {
         *size_pruned += page->size;
@@ -207,6 +268,8 @@ ioc_prune(ioc_table_t *table)
         size_to_prune = table->cache_used - table->cache_size;
         /* take out the least recently used inode */
         for (index = 0; index < table->max_pri; index++) {
+            __ioc_inode_lru_refresh(&table->inode_lru[index]);
+
             list_for_each_entry_safe(curr, next_ioc_inode,
                                      &table->inode_lru[index], inode_lru)
             {
@@ -449,6 +512,7 @@ ioc_fault_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         }
 
         memcpy(&ioc_inode->cache.tv, &tv, sizeof(struct timeval));
+        __ioc_index_validated(ioc_inode, tv.tv_sec);
 
         if (op_ret < 0) {
             /* error, readv returned -1 */
@@ -468,12 +532,8 @@ ioc_fault_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                        "ioc_inode=%p",
                        offset, table->page_size, ioc_inode);
             } else {
-                if (page->vector) {
-                    iobref_unref(page->iobref);
-                    GF_FREE(page->vector);
-                    page->vector = NULL;
-                    page->iobref = NULL;
-                }
+                if (page->vector)
+                    __ioc_page_release(page);
 
                 /* keep a copy of the page for our cache */
                 page->vector = iov_dup(vector, count);
@@ -936,6 +996,8 @@ __ioc_page_wakeup(ioc_page_t *page, int32_t op_errno)
     page->waitq = NULL;
 
     page->ready = 1;
+    if (!page->stale)
+        __ioc_page_publish(page);
 
     gf_msg_trace(page->inode->table->xl->name, 0, "page is %p && waitq = %p",
                  page, waitq);
@@ -1033,3 +1095,342 @@ ioc_page_error(ioc_page_t *page, int32_t op_ret, int32_t op_errno)
 out:
     return waitq;
 }
+
+/*
+ * ioc_index_new - create the lock-free page index of an inode
+ *
+ * @ioc_inode:
+ *
+ * assumes ioc_inode is locked
+ */
+struct ioc_index *
+ioc_index_new(ioc_inode_t *ioc_inode)
+{
+    struct ioc_index *index = NULL;
+    int i = 0;
+
+    index = GF_CALLOC(1, sizeof(*index), gf_ioc_mt_ioc_index_t);
+    if (index == NULL)
+        return NULL;
+
+    for (i = 0; i < IOC_INDEX_SLOTS; i++) {
+        GF_ATOMIC_INIT(index->slots[i].seq, 0);
+        GF_ATOMIC_INIT(index->slots[i].referenced, 0);
+    }
+
+    GF_ATOMIC_INIT(index->epoch, 0);
+    GF_ATOMIC_INIT(index->readers[0], 0);
+    GF_ATOMIC_INIT(index->readers[1], 0);
+    GF_ATOMIC_INIT(index->validated, ioc_inode->cache.tv.tv_sec);
+    GF_ATOMIC_INIT(index->hits, 0);
+    GF_ATOMIC_INIT(index->referenced, 0);
+    GF_ATOMIC_INIT(index->pending, 0);
+
+    return index;
+}
+
+static void
+ioc_retired_free(struct ioc_retired *retired)
+{
+    struct ioc_retired *next = NULL;
+
+    for (; retired; retired = next) {
+        next = retired->next;
+        iobref_unref(retired->iobref);
+        GF_FREE(retired);
+    }
+}
+
+/*
+ * ioc_index_destroy - to be called once no reader can use the index anymore,
+ *                     when the inode is destroyed
+ */
+void
+ioc_index_destroy(struct ioc_index *index)
+{
+    if (index == NULL)
+        return;
+
+    ioc_retired_free(index->retired);
+    ioc_retired_free(index->waiting);
+    GF_FREE(index);
+}
+
+/*
+ * __ioc_index_reclaim - release the retired iobrefs no reader can see
+ *
+ * Readers count themselves in readers[epoch & 1]. The iobrefs retired
+ * so far are set aside when the epoch moves on, and released once the
+ * readers of the epoch they were retired in are gone. The epoch only moves
+ * on once the readers of the epoch before are gone too, so that they are
+ * not mixed with the readers to come. Nothing here waits for the readers.
+ *
+ * assumes ioc_inode is locked
+ */
+static void
+__ioc_index_reclaim(struct ioc_index *index)
+{
+    uint64_t epoch = 0;
+
+    /* the slots were changed before the readers are looked at */
+    __sync_synchronize();
+
+    if (index->waiting && !GF_ATOMIC_GET(index->readers[index->waiting_on])) {
+        ioc_retired_free(index->waiting);
+        index->waiting = NULL;
+    }
+
+    if (!index->waiting && index->retired) {
+        epoch = GF_ATOMIC_GET(index->epoch);
+        if (!GF_ATOMIC_GET(index->readers[(epoch + 1) & 1])) {
+            GF_ATOMIC_INC(index->epoch);
+            __sync_synchronize();
+
+            index->waiting = index->retired;
+            index->waiting_on = epoch & 1;
+            index->retired = NULL;
+
+            if (!GF_ATOMIC_GET(index->readers[epoch & 1])) {
+                ioc_retired_free(index->waiting);
+                index->waiting = NULL;
+            }
+        }
+    }
+
+    GF_ATOMIC_SWAP(index->pending, (index->waiting || index->retired));
+}
+
+/*
+ * __ioc_index_validated - the cache of the inode was (re)validated at @when
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_index_validated(ioc_inode_t *ioc_inode, time_t when)
+{
+    if (ioc_inode->cache.index)
+        GF_ATOMIC_SWAP(ioc_inode->cache.index->validated, when);
+}
+
+/*
+ * __ioc_page_publish - make a ready page visible to lock-free readers
+ *
+ * @page:
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_publish(ioc_page_t *page)
+{
+    struct ioc_index *index = page->inode->cache.index;
+    struct ioc_slot *slot = NULL;
+
+    if (!index || !page->vector || !page->iobref ||
+        (page->count > IOC_INDEX_MAX_IOV))
+        return;
+
+    slot = IOC_SLOT(index, page->offset);
+    if ((slot->page == page) && (slot->iobref == page->iobref))
+        return;
+
+    /* the iobref of a published page has to be retired when the page is
+     * released, which must not fail: a page that can't be is left to the
+     * readers that take the locks */
+    if (!page->retired) {
+        page->retired = GF_CALLOC(1, sizeof(*page->retired),
+                                  gf_ioc_mt_ioc_retired_t);
+        if (!page->retired)
+            return;
+    }
+
+    GF_ATOMIC_INC(slot->seq);
+    __sync_synchronize();
+
+    slot->page = page;
+    slot->offset = page->offset;
+    slot->size = page->size;
+    slot->count = page->count;
+    slot->op_errno = page->op_errno;
+    memcpy(slot->vector, page->vector, page->count * sizeof(struct iovec));
+    slot->iobref = page->iobref;
+
+    GF_ATOMIC_INC(slot->seq);
+}
+
+/*
+ * __ioc_page_unpublish - take a page out of the index, lock-free readers
+ *                        which have not copied it yet won't find it
+ *
+ * @page:
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_unpublish(ioc_page_t *page)
+{
+    struct ioc_index *index = page->inode->cache.index;
+    struct ioc_slot *slot = NULL;
+
+    if (!index)
+        return;
+
+    slot = IOC_SLOT(index, page->offset);
+    if (slot->page != page)
+        return;
+
+    GF_ATOMIC_INC(slot->seq);
+    __sync_synchronize();
+
+    slot->page = NULL;
+    slot->iobref = NULL;
+    slot->count = 0;
+    slot->size = 0;
+
+    GF_ATOMIC_INC(slot->seq);
+}
+
+/*
+ * __ioc_page_release - drop the data of a page
+ *
+ * A lock-free reader may have copied the iobref of a published page from
+ * the index (even after the slot was reused by another page) and be about
+ * to take a ref on it, so it is retired rather than released.
+ *
+ * assumes ioc_inode is locked
+ */
+void
+__ioc_page_release(ioc_page_t *page)
+{
+    struct ioc_index *index = page->inode->cache.index;
+    struct ioc_retired *retired = NULL;
+
+    __ioc_page_unpublish(page);
+
+    if (page->iobref) {
+        if (page->retired) {
+            retired = page->retired;
+            page->retired = NULL;
+
+            retired->iobref = page->iobref;
+            retired->next = index->retired;
+            index->retired = retired;
+        } else {
+            /* never published, no lock-free reader can have it */
+            iobref_unref(page->iobref);
+        }
+    }
+
+    GF_FREE(page->vector);
+    page->vector = NULL;
+    page->iobref = NULL;
+
+    if (index)
+        __ioc_index_reclaim(index);
+}
+
+/*
+ * ioc_index_read - serve a read from the index of the inode, without taking
+ *                  any lock
+ *
+ * Only reads within one page, which is ready and does not need to be
+ * validated, are served. Returns _gf_false when the read has to go through
+ * ioc_dispatch_requests().
+ *
+ * @vector: room for IOC_INDEX_MAX_IOV entries
+ * @iobref: a ref is taken on it
+ */
+gf_boolean_t
+ioc_index_read(ioc_inode_t *ioc_inode, off_t offset, size_t size,
+               struct iovec *vector, int32_t *count, struct iobref **iobref,
+               int32_t *op_errno)
+{
+    struct ioc_index *index = NULL;
+    ioc_table_t *table = ioc_inode->table;
+    struct ioc_slot *slot = NULL;
+    struct iovec page_vector[IOC_INDEX_MAX_IOV];
+    struct iobref *page_iobref = NULL;
+    int32_t page_count = 0;
+    size_t page_size = 0;
+    int32_t page_errno = 0;
+    off_t rounded_offset = 0;
+    size_t copy_size = 0;
+    uint32_t seq = 0;
+    int reader = 0;
+
+    index = __atomic_load_n(&ioc_inode->cache.index, __ATOMIC_ACQUIRE);
+    if (!index)
+        return _gf_false;
+
+    rounded_offset = gf_floor(offset, table->page_size);
+    if ((offset + size) > (rounded_offset + table->page_size))
+        return _gf_false;
+
+    /* same check as ioc_inode_need_revalidate(), and a validation is not
+     * already on its way */
+    if (__atomic_load_n(&ioc_inode->waitq, __ATOMIC_ACQUIRE))
+        return _gf_false;
+
+    if (!__atomic_load_n(&ioc_inode->leased, __ATOMIC_ACQUIRE) &&
+        (time(NULL) - GF_ATOMIC_GET(index->validated) >= table->cache_timeout))
+        return _gf_false;
+
+    slot = IOC_SLOT(index, rounded_offset);
+
+    reader = GF_ATOMIC_GET(index->epoch) & 1;
+    GF_ATOMIC_INC(index->readers[reader]);
+    __sync_synchronize();
+
+    seq = GF_ATOMIC_GET(slot->seq);
+    if (seq & 1)
+        goto miss;
+
+    page_iobref = slot->iobref;
+    page_count = slot->count;
+    if (!page_iobref || (slot->offset != rounded_offset) ||
+        (page_count > IOC_INDEX_MAX_IOV))
+        goto miss;
+
+    page_size = slot->size;
+    page_errno = slot->op_errno;
+    memcpy(page_vector, slot->vector, page_count * sizeof(struct iovec));
+
+    __sync_synchronize();
+    if (GF_ATOMIC_GET(slot->seq) != seq)
+        goto miss;
+
+    iobref_ref(page_iobref);
+    GF_ATOMIC_DEC(index->readers[reader]);
+
+    if (!GF_ATOMIC_GET(slot->referenced))
+        GF_ATOMIC_SWAP(slot->referenced, 1);
+    if (!GF_ATOMIC_GET(index->referenced))
+        GF_ATOMIC_SWAP(index->referenced, 1);
+
+    /* release what the writers had to leave behind for us, if nobody
+     * else is at it */
+    if (GF_ATOMIC_GET(index->pending) &&
+        !pthread_mutex_trylock(&ioc_inode->inode_lock)) {
+        __ioc_index_reclaim(index);
+        pthread_mutex_unlock(&ioc_inode->inode_lock);
+    }
+
+    if (page_size > (offset - rounded_offset))
+        copy_size = min(page_size - (offset - rounded_offset), size);
+
+    *count = iov_subset(page_vector, page_count, offset - rounded_offset,
+                        copy_size, &vector, IOC_INDEX_MAX_IOV);
+    if (*count < 0) {
+        iobref_unref(page_iobref);
+        return _gf_false;
+    }
+
+    GF_ATOMIC_INC(index->hits);
+
+    *iobref = page_iobref;
+    *op_errno = page_errno;
+    return _gf_true;
+
+miss:
+    GF_ATOMIC_DEC(index->readers[reader]);
+    return _gf_false;
+}
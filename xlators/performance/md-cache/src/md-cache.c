@@ -121,6 +121,7 @@ struct md_cache {
     gf_boolean_t valid;
     gf_boolean_t gen_rollover;
     gf_boolean_t invalidation_rollover;
+    gf_boolean_t leased; /* under a lease of cache-leases */
     gf_lock_t lock;
 };
 
@@ -371,10 +372,11 @@ unlock:
 /* Cache is valid if:
  * - It is not cached before any brick was down. Brick down case is handled by
  *   invalidating all the cache when any brick went down.
- * - The cache time is not expired
+ * - The cache time is not expired, or the inode is leased: cache-leases
+ *   invalidates it before the lease is given back.
  */
 static gf_boolean_t
-__is_cache_valid(xlator_t *this, time_t mdc_time)
+__is_cache_valid(xlator_t *this, time_t mdc_time, gf_boolean_t leased)
 {
     time_t now = 0;
     gf_boolean_t ret = _gf_true;
@@ -401,6 +403,9 @@ __is_cache_valid(xlator_t *this, time_t mdc_time)
         goto out;
     }
 
+    if (leased && timeout)
+        goto out;
+
     if (now >= (mdc_time + timeout)) {
         ret = _gf_false;
     }
@@ -419,7 +424,7 @@ is_md_cache_iatt_valid(xlator_t *this, struct md_cache *mdc)
         if (mdc->valid == _gf_false) {
             ret = mdc->valid;
         } else {
-            ret = __is_cache_valid(this, mdc->ia_time);
+            ret = __is_cache_valid(this, mdc->ia_time, mdc->leased);
             if (ret == _gf_false) {
                 mdc->ia_time = 0;
                 mdc->generation = 0;
@@ -438,7 +443,7 @@ is_md_cache_xatt_valid(xlator_t *this, struct md_cache *mdc)
 
     LOCK(&mdc->lock);
     {
-        ret = __is_cache_valid(this, mdc->xa_time);
+        ret = __is_cache_valid(this, mdc->xa_time, mdc->leased);
         if (ret == _gf_false)
             mdc->xa_time = 0;
     }
@@ -513,6 +518,7 @@ mdc_inode_iatt_set_validate(xlator_t *this, inode_t *inode, struct iatt *prebuf,
                              uuid_utoa(inode->gfid));
             mdc->ia_time = 0;
             mdc->valid = 0;
+            mdc->leased = _gf_false;
 
             gen = __mdc_inc_generation(this, mdc);
             mdc->generation = (gen & 0xffffffff);
@@ -940,6 +946,7 @@ mdc_inode_iatt_invalidate(xlator_t *this, inode_t *inode)
     {
         mdc->ia_time = 0;
         mdc->valid = _gf_false;
+        mdc->leased = _gf_false;
         mdc->generation = gen;
     }
     UNLOCK(&mdc->lock);
@@ -960,6 +967,7 @@ mdc_inode_xatt_invalidate(xlator_t *this, inode_t *inode)
     LOCK(&mdc->lock);
     {
         mdc->xa_time = 0;
+        mdc->leased = _gf_false;
     }
     UNLOCK(&mdc->lock);
 
@@ -967,6 +975,37 @@ out:
     return ret;
 }
 
+/* GF_CACHE_LEASE_KEY in the reply: cache-leases holds a read lease on the
+ * inode, the cache does not expire until it tells the lease is gone. The
+ * lease only covers what the reply cached, not an invalidation that came
+ * in meanwhile. */
+static void
+mdc_inode_lease_set(xlator_t *this, inode_t *inode, dict_t *xdata,
+                    uint64_t incident_time)
+{
+    struct md_cache *mdc = NULL;
+    uint32_t rollover = 0;
+    gf_boolean_t leased = _gf_false;
+
+    if (mdc_inode_ctx_get(this, inode, &mdc) != 0)
+        return;
+
+    leased = (xdata && dict_get_sizen(xdata, GF_CACHE_LEASE_KEY));
+
+    rollover = incident_time >> 32;
+    incident_time = (incident_time & 0xffffffff);
+
+    LOCK(&mdc->lock);
+    {
+        if (!leased)
+            mdc->leased = _gf_false;
+        else if (mdc->valid && (mdc->gen_rollover == rollover) &&
+                 (incident_time >= mdc->generation))
+            mdc->leased = _gf_true;
+    }
+    UNLOCK(&mdc->lock);
+}
+
 static int
 mdc_update_gfid_stat(xlator_t *this, struct iatt *iatt)
 {
@@ -1240,7 +1279,9 @@ mdc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         goto out;
     }
 
-    if (local->loc.parent) {
+    /* lookups served by readdir-ahead from a directory listing carry no
+     * postparent */
+    if (local->loc.parent && !(dict && dict_get(dict, GF_RDA_LISTING_KEY))) {
         mdc_inode_iatt_set(this, local->loc.parent, postparent,
                            local->incident_time);
     }
@@ -1250,6 +1291,8 @@ mdc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         if (local->update_cache) {
             mdc_inode_xatt_set(this, local->loc.inode, dict);
         }
+        mdc_inode_lease_set(this, local->loc.inode, dict,
+                            local->incident_time);
     }
 out:
     MDC_STACK_UNWIND(lookup, frame, op_ret, op_errno, inode, stbuf, dict,
@@ -1355,6 +1398,7 @@ mdc_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if (local->update_cache) {
         mdc_inode_xatt_set(this, local->loc.inode, xdata);
     }
+    mdc_inode_lease_set(this, local->loc.inode, xdata, local->incident_time);
 
 out:
     MDC_STACK_UNWIND(stat, frame, op_ret, op_errno, buf, xdata);
@@ -1426,6 +1470,7 @@ mdc_fstat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if (local->update_cache) {
         mdc_inode_xatt_set(this, local->fd->inode, xdata);
     }
+    mdc_inode_lease_set(this, local->fd->inode, xdata, local->incident_time);
 
 out:
     MDC_STACK_UNWIND(fstat, frame, op_ret, op_errno, buf, xdata);
@@ -3492,6 +3537,21 @@ out:
     return ret;
 }
 
+/* the inodes cache-leases gives the lease of back are invalidated, even
+ * without cache invalidation */
+static gf_boolean_t
+mdc_is_lease_invalidation(struct gf_upcall *up_data)
+{
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+
+    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+        return _gf_false;
+
+    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+
+    return (up_ci->dict && dict_get_sizen(up_ci->dict, GF_CACHE_LEASE_KEY));
+}
+
 struct mdc_ipc {
     xlator_t *this;
     dict_t *xattr;
@@ -3792,7 +3852,7 @@ mdc_notify(xlator_t *this, int event, void *data, ...)
             mdc_update_child_down_time(this, &now);
             break;
         case GF_EVENT_UPCALL:
-            if (conf->mdc_invalidation)
+            if (conf->mdc_invalidation || mdc_is_lease_invalidation(data))
                 ret = mdc_invalidate(this, data);
             break;
         case GF_EVENT_CHILD_UP:
@@ -35,27 +35,36 @@
  *
  *   Data structures to store cache?
  *      The cache of any directory is stored in the inode_ctx of the directory.
- *      Negative entries are stored as list of strings.
- *             Search - O(n)
+ *      Negative entries are stored as list of strings, and hashed by name
+ *          in a table of the directory. A bloom filter in front of the table
+ *          answers most searches of names that are not negative entries.
+ *             Search - O(1)
  *             Add    - O(1)
- *             Delete - O(n) - as it has to be searched before deleting
+ *             Delete - O(1)
  *      Positive entries are stored as a list, each list node has a pointer
- *          to the inode of the positive entry or the name of the entry.
+ *          to the inode of the positive entry and the name of the entry.
  *          Since the client side inode table already will have inodes for
  *          positive entries, we just take a ref of that inode and store as
  *          positive entry cache. In cases like hardlinks and readdirp where
- *          inode is NULL, we store the names.
- *          Name Search - O(n)
+ *          inode is NULL, we store only the names. Names are hashed like the
+ *          negative entries.
+ *          Name Search - O(1)
  *          Inode Search - O(1) - Actually complexity of inode_find()
  *          Name/inode Add - O(1)
- *          Name Delete - O(n)
+ *          Name Delete - O(1)
  *          Inode Delete - O(1)
+ *      The hash of a name is taken on the name folded to lower case, so that
+ *      case insensitive searches (get_real_filename) are O(1) as well.
+ *
+ *      When nl-cache-complete-dir is on, a readdirp pass from offset 0 to
+ *      EOF fills the positive entries and marks the directory NLC_PE_FULL:
+ *      lookups of names that are not positive entries are then answered
+ *      ENOENT without winding.
  *
  * Locking order:
  *
  * TODO:
- * - Fill Positive entries on readdir/p, after which in lookup_cbk check if the
- *   name is in PE and replace it with inode.
+ * - In lookup_cbk check if the name is in PE and replace it with inode.
  * - fini, PARENET_DOWN, disable caching
  * - Virtual setxattr to dump the inode_ctx, to ease debugging
  * - Handle dht_nuke xattr: clear all cache
@@ -77,6 +86,240 @@ __nlc_free_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_pe_t *pe);
 void
 __nlc_free_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_ne_t *ne);
 
+static uint32_t
+nlc_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+
+    /* FNV-1a of the name folded to lower case */
+    for (; *name; name++) {
+        hash ^= (unsigned char)tolower((unsigned char)*name);
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static int
+__nlc_table_resize(xlator_t *this, nlc_ctx_t *nlc_ctx,
+                   struct nlc_name_table *table, uint32_t size)
+{
+    struct list_head *buckets = NULL;
+    struct nlc_hnode *hnode = NULL;
+    struct nlc_hnode *tmp = NULL;
+    nlc_conf_t *conf = NULL;
+    uint32_t i = 0;
+
+    conf = this->private;
+
+    buckets = GF_MALLOC(size * sizeof(*buckets), gf_nlc_mt_nlc_hash_t);
+    if (!buckets)
+        return -1;
+
+    for (i = 0; i < size; i++)
+        INIT_LIST_HEAD(&buckets[i]);
+
+    for (i = 0; i < table->size; i++) {
+        list_for_each_entry_safe(hnode, tmp, &table->buckets[i], list)
+        {
+            list_move(&hnode->list, &buckets[hnode->hashval & (size - 1)]);
+        }
+    }
+
+    nlc_ctx->cache_size += (size - table->size) * sizeof(*buckets);
+    GF_ATOMIC_ADD(conf->current_cache_size,
+                  (size - table->size) * sizeof(*buckets));
+
+    GF_FREE(table->buckets);
+    table->buckets = buckets;
+    table->size = size;
+
+    return 0;
+}
+
+static int
+__nlc_table_add(xlator_t *this, nlc_ctx_t *nlc_ctx,
+                struct nlc_name_table *table, struct nlc_hnode *hnode)
+{
+    uint32_t size = 0;
+
+    if ((table->count >= table->size) && (table->size < NLC_HASH_MAX_SIZE)) {
+        size = table->size ? (table->size * 2) : NLC_HASH_MIN_SIZE;
+        /* If the table cannot grow, keep it with longer chains */
+        if ((__nlc_table_resize(this, nlc_ctx, table, size) < 0) &&
+            (table->size == 0))
+            return -1;
+    }
+
+    list_add(&hnode->list, &table->buckets[hnode->hashval & (table->size - 1)]);
+    table->count++;
+
+    return 0;
+}
+
+static void
+__nlc_table_del(struct nlc_name_table *table, struct nlc_hnode *hnode)
+{
+    if (list_empty(&hnode->list))
+        return;
+
+    list_del_init(&hnode->list);
+    table->count--;
+}
+
+static void
+__nlc_table_free(xlator_t *this, nlc_ctx_t *nlc_ctx,
+                 struct nlc_name_table *table)
+{
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    GF_ASSERT(table->count == 0);
+
+    nlc_ctx->cache_size -= table->size * sizeof(*table->buckets);
+    GF_ATOMIC_SUB(conf->current_cache_size,
+                  table->size * sizeof(*table->buckets));
+
+    GF_FREE(table->buckets);
+    table->buckets = NULL;
+    table->size = 0;
+}
+
+static void
+nlc_bloom_bits(uint32_t hashval, uint32_t nbits, uint32_t *bit1,
+               uint32_t *bit2)
+{
+    *bit1 = hashval & (nbits - 1);
+    *bit2 = (((hashval >> 16) | (hashval << 16)) * 0x9e3779b1U) & (nbits - 1);
+}
+
+static void
+__nlc_bloom_add(nlc_ctx_t *nlc_ctx, uint32_t hashval)
+{
+    uint32_t bit1 = 0;
+    uint32_t bit2 = 0;
+
+    if (!nlc_ctx->ne_bloom)
+        return;
+
+    nlc_bloom_bits(hashval, nlc_ctx->ne_table.size * NLC_BLOOM_BITS_PER_BUCKET,
+                   &bit1, &bit2);
+    nlc_ctx->ne_bloom[bit1 / 8] |= 1 << (bit1 % 8);
+    nlc_ctx->ne_bloom[bit2 / 8] |= 1 << (bit2 % 8);
+}
+
+/* Returns false only if no ne has a name with this hash */
+static gf_boolean_t
+__nlc_bloom_test(nlc_ctx_t *nlc_ctx, uint32_t hashval)
+{
+    uint32_t bit1 = 0;
+    uint32_t bit2 = 0;
+
+    if (nlc_ctx->ne_table.count == 0)
+        return _gf_false;
+
+    if (!nlc_ctx->ne_bloom)
+        return _gf_true;
+
+    nlc_bloom_bits(hashval, nlc_ctx->ne_table.size * NLC_BLOOM_BITS_PER_BUCKET,
+                   &bit1, &bit2);
+
+    return ((nlc_ctx->ne_bloom[bit1 / 8] & (1 << (bit1 % 8))) &&
+            (nlc_ctx->ne_bloom[bit2 / 8] & (1 << (bit2 % 8))));
+}
+
+static void
+__nlc_bloom_free(xlator_t *this, nlc_ctx_t *nlc_ctx, size_t size)
+{
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    if (!nlc_ctx->ne_bloom)
+        return;
+
+    GF_FREE(nlc_ctx->ne_bloom);
+    nlc_ctx->ne_bloom = NULL;
+
+    nlc_ctx->cache_size -= size;
+    GF_ATOMIC_SUB(conf->current_cache_size, size);
+}
+
+/* Sizes the bloom filter to the ne table and sets the bits of all the ne.
+ * Without memory for it, the filter is dropped and searches go to the
+ * table. */
+static void
+__nlc_bloom_rebuild(xlator_t *this, nlc_ctx_t *nlc_ctx, uint32_t old_size)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_ne_t *ne = NULL;
+    size_t size = 0;
+
+    conf = this->private;
+
+    __nlc_bloom_free(this, nlc_ctx, old_size * NLC_BLOOM_BITS_PER_BUCKET / 8);
+
+    size = nlc_ctx->ne_table.size * NLC_BLOOM_BITS_PER_BUCKET / 8;
+    nlc_ctx->ne_bloom = GF_CALLOC(size, 1, gf_nlc_mt_nlc_hash_t);
+    if (!nlc_ctx->ne_bloom)
+        return;
+
+    nlc_ctx->cache_size += size;
+    GF_ATOMIC_ADD(conf->current_cache_size, size);
+
+    list_for_each_entry(ne, &nlc_ctx->ne, list)
+    {
+        __nlc_bloom_add(nlc_ctx, ne->hnode.hashval);
+    }
+}
+
+static nlc_pe_t *
+__nlc_find_pe(nlc_ctx_t *nlc_ctx, const char *name,
+              gf_boolean_t case_insensitive)
+{
+    struct nlc_name_table *table = &nlc_ctx->pe_table;
+    nlc_pe_t *pe = NULL;
+    uint32_t hashval = 0;
+
+    if (table->count == 0)
+        return NULL;
+
+    hashval = nlc_name_hash(name);
+    list_for_each_entry(pe, &table->buckets[hashval & (table->size - 1)],
+                        hnode.list)
+    {
+        if (pe->hnode.hashval != hashval)
+            continue;
+        if (case_insensitive ? (strcasecmp(pe->name, name) == 0)
+                             : (strcmp(pe->name, name) == 0))
+            return pe;
+    }
+
+    return NULL;
+}
+
+static nlc_ne_t *
+__nlc_find_ne(nlc_ctx_t *nlc_ctx, const char *name)
+{
+    struct nlc_name_table *table = &nlc_ctx->ne_table;
+    nlc_ne_t *ne = NULL;
+    uint32_t hashval = 0;
+
+    hashval = nlc_name_hash(name);
+    if (!__nlc_bloom_test(nlc_ctx, hashval))
+        return NULL;
+
+    list_for_each_entry(ne, &table->buckets[hashval & (table->size - 1)],
+                        hnode.list)
+    {
+        if ((ne->hnode.hashval == hashval) && (strcmp(ne->name, name) == 0))
+            return ne;
+    }
+
+    return NULL;
+}
+
 static int32_t
 nlc_get_cache_timeout(xlator_t *this)
 {
@@ -231,6 +474,12 @@ __nlc_inode_clear_entries(xlator_t *this, nlc_ctx_t *nlc_ctx)
             __nlc_free_ne(this, nlc_ctx, ne);
         }
 
+    __nlc_bloom_free(this, nlc_ctx,
+                     nlc_ctx->ne_table.size * NLC_BLOOM_BITS_PER_BUCKET / 8);
+    __nlc_table_free(this, nlc_ctx, &nlc_ctx->pe_table);
+    __nlc_table_free(this, nlc_ctx, &nlc_ctx->ne_table);
+
+    nlc_ctx->gen++;
     nlc_ctx->cache_time = 0;
     nlc_ctx->state = 0;
     GF_ASSERT(nlc_ctx->cache_size == sizeof(*nlc_ctx));
@@ -391,6 +640,9 @@ nlc_local_wipe(xlator_t *this, nlc_local_t *local)
 
     loc_wipe(&local->loc2);
 
+    if (local->fd)
+        fd_unref(local->fd);
+
     GF_FREE(local);
 out:
     return;
@@ -665,6 +917,7 @@ __nlc_free_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_pe_t *pe)
         inode_unref(pe->inode);
     }
     list_del(&pe->list);
+    __nlc_table_del(&nlc_ctx->pe_table, &pe->hnode);
 
     nlc_ctx->cache_size -= sizeof(*pe) + sizeof(pe->name);
     GF_ATOMIC_SUB(conf->current_cache_size, (sizeof(*pe) + sizeof(pe->name)));
@@ -687,9 +940,14 @@ __nlc_free_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_ne_t *ne)
     conf = this->private;
 
     list_del(&ne->list);
+    __nlc_table_del(&nlc_ctx->ne_table, &ne->hnode);
     GF_FREE(ne->name);
     GF_FREE(ne);
 
+    if (nlc_ctx->ne_table.count == 0 && nlc_ctx->ne_bloom)
+        memset(nlc_ctx->ne_bloom, 0,
+               nlc_ctx->ne_table.size * NLC_BLOOM_BITS_PER_BUCKET / 8);
+
     nlc_ctx->cache_size -= sizeof(*ne) + sizeof(ne->name);
     GF_ATOMIC_SUB(conf->current_cache_size, (sizeof(*ne) + sizeof(ne->name)));
 
@@ -725,7 +983,6 @@ __nlc_del_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
              const char *name, gf_boolean_t multilink)
 {
     nlc_pe_t *pe = NULL;
-    nlc_pe_t *tmp = NULL;
     gf_boolean_t found = _gf_false;
     uint64_t pe_int = 0;
 
@@ -737,12 +994,10 @@ __nlc_del_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
 
     /* If there are hardlinks first search names, followed by inodes */
     if (multilink) {
-        list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
-        {
-            if (pe->name && (strcmp(pe->name, name) == 0)) {
-                found = _gf_true;
-                goto out;
-            }
+        pe = __nlc_find_pe(nlc_ctx, name, _gf_false);
+        if (pe) {
+            found = _gf_true;
+            goto out;
         }
         inode_ctx_reset1(entry_ino, this, &pe_int);
         if (pe_int) {
@@ -761,14 +1016,9 @@ __nlc_del_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
     }
 
 name_search:
-    list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
-    {
-        if (pe->name && (strcmp(pe->name, name) == 0)) {
-            found = _gf_true;
-            break;
-            /* TODO: can there be duplicates? */
-        }
-    }
+    pe = __nlc_find_pe(nlc_ctx, name, _gf_false);
+    if (pe)
+        found = _gf_true;
 
 out:
     if (found)
@@ -781,23 +1031,18 @@ static void
 __nlc_del_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name)
 {
     nlc_ne_t *ne = NULL;
-    nlc_ne_t *tmp = NULL;
 
     if (!IS_NE_VALID(nlc_ctx->state))
         goto out;
 
-    list_for_each_entry_safe(ne, tmp, &nlc_ctx->ne, list)
-    {
-        if (strcmp(ne->name, name) == 0) {
-            __nlc_free_ne(this, nlc_ctx, ne);
-            break;
-        }
-    }
+    ne = __nlc_find_ne(nlc_ctx, name);
+    if (ne)
+        __nlc_free_ne(this, nlc_ctx, ne);
 out:
     return;
 }
 
-static void
+static int
 __nlc_add_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
              const char *name)
 {
@@ -808,22 +1053,34 @@ __nlc_add_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
 
     conf = this->private;
 
-    /* TODO: There can be no duplicate entries, as it is added only
-    during create. In case there arises duplicate entries, search PE
-    found = __nlc_search (entries, name, _gf_false);
-    can use bit vector to have simple search than sequential search */
+    /* A name found by readdirp can be added again with its inode, keep
+     * only one entry per name */
+    if (name) {
+        pe = __nlc_find_pe(nlc_ctx, name, _gf_false);
+        if (pe && (pe->inode || !entry_ino))
+            return 0;
+        if (pe)
+            __nlc_free_pe(this, nlc_ctx, pe);
+    }
 
     pe = GF_CALLOC(sizeof(*pe), 1, gf_nlc_mt_nlc_pe_t);
     if (!pe)
         goto out;
 
-    if (entry_ino) {
-        pe->inode = inode_ref(entry_ino);
-        nlc_inode_ctx_set(this, entry_ino, NULL, pe);
-    } else if (name) {
+    INIT_LIST_HEAD(&pe->hnode.list);
+    if (name) {
         pe->name = gf_strdup(name);
         if (!pe->name)
             goto out;
+
+        pe->hnode.hashval = nlc_name_hash(name);
+        if (__nlc_table_add(this, nlc_ctx, &nlc_ctx->pe_table, &pe->hnode))
+            goto out;
+    }
+
+    if (entry_ino) {
+        pe->inode = inode_ref(entry_ino);
+        nlc_inode_ctx_set(this, entry_ino, NULL, pe);
     }
 
     list_add(&pe->list, &nlc_ctx->pe);
@@ -838,10 +1095,12 @@ __nlc_add_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, inode_t *entry_ino,
 
     ret = 0;
 out:
-    if (ret)
+    if (ret && pe) {
+        GF_FREE(pe->name);
         GF_FREE(pe);
+    }
 
-    return;
+    return ret;
 }
 
 static void
@@ -850,12 +1109,12 @@ __nlc_add_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name)
     nlc_ne_t *ne = NULL;
     int ret = -1;
     nlc_conf_t *conf = NULL;
+    uint32_t old_size = 0;
 
     conf = this->private;
 
-    /* TODO: search ne before adding to get rid of duplicate entries
-    found = __nlc_search (entries, name, _gf_false);
-    can use bit vector to have faster search than sequential search */
+    if (IS_NE_VALID(nlc_ctx->state) && __nlc_find_ne(nlc_ctx, name))
+        return;
 
     ne = GF_CALLOC(sizeof(*ne), 1, gf_nlc_mt_nlc_ne_t);
     if (!ne)
@@ -865,14 +1124,26 @@ __nlc_add_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name)
     if (!ne->name)
         goto out;
 
+    old_size = nlc_ctx->ne_table.size;
+    ne->hnode.hashval = nlc_name_hash(name);
+    if (__nlc_table_add(this, nlc_ctx, &nlc_ctx->ne_table, &ne->hnode))
+        goto out;
+
+    if (nlc_ctx->ne_table.size != old_size)
+        __nlc_bloom_rebuild(this, nlc_ctx, old_size);
+    else
+        __nlc_bloom_add(nlc_ctx, ne->hnode.hashval);
+
     list_add(&ne->list, &nlc_ctx->ne);
 
     nlc_ctx->cache_size += sizeof(*ne) + sizeof(ne->name);
     GF_ATOMIC_ADD(conf->current_cache_size, (sizeof(*ne) + sizeof(ne->name)));
     ret = 0;
 out:
-    if (ret)
+    if (ret && ne) {
+        GF_FREE(ne->name);
         GF_FREE(ne);
+    }
 
     return;
 }
@@ -957,7 +1228,10 @@ nlc_dir_add_pe(xlator_t *this, inode_t *inode, inode_t *entry_ino,
     LOCK(&nlc_ctx->lock);
     {
         __nlc_del_ne(this, nlc_ctx, name);
-        __nlc_add_pe(this, nlc_ctx, entry_ino, name);
+        /* An entry missing from a complete directory would be reported
+         * as ENOENT, it is not complete anymore */
+        if (__nlc_add_pe(this, nlc_ctx, entry_ino, name) < 0)
+            nlc_ctx->state &= ~NLC_PE_FULL;
         if (!IS_PE_VALID(nlc_ctx->state))
             __nlc_set_dir_state(nlc_ctx, NLC_PE_PARTIAL);
     }
@@ -966,23 +1240,160 @@ out:
     return;
 }
 
+static nlc_fd_ctx_t *
+nlc_fd_ctx_get_set(xlator_t *this, fd_t *fd, gf_boolean_t create)
+{
+    nlc_fd_ctx_t *fd_ctx = NULL;
+    uint64_t value = 0;
+
+    LOCK(&fd->lock);
+    {
+        if (__fd_ctx_get(fd, this, &value) == 0) {
+            fd_ctx = (void *)(uintptr_t)value;
+            goto unlock;
+        }
+
+        if (!create)
+            goto unlock;
+
+        fd_ctx = GF_CALLOC(1, sizeof(*fd_ctx), gf_nlc_mt_nlc_fd_ctx_t);
+        if (!fd_ctx)
+            goto unlock;
+
+        value = (uint64_t)(uintptr_t)fd_ctx;
+        if (__fd_ctx_set(fd, this, value)) {
+            GF_FREE(fd_ctx);
+            fd_ctx = NULL;
+        }
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    return fd_ctx;
+}
+
+void
+nlc_fd_ctx_del(xlator_t *this, fd_t *fd)
+{
+    uint64_t value = 0;
+
+    fd_ctx_del(fd, this, &value);
+    GF_FREE((void *)(uintptr_t)value);
+}
+
+/* Generation of the cache of the directory, bumped each time it is
+ * cleared. Taken when a readdirp is wound, and given back with its reply
+ * to nlc_dir_add_entries(). */
+uint64_t
+nlc_dir_gen(xlator_t *this, inode_t *inode)
+{
+    nlc_ctx_t *nlc_ctx = NULL;
+    uint64_t gen = 0;
+
+    nlc_inode_ctx_get_set(this, inode, &nlc_ctx, NULL);
+    if (!nlc_ctx)
+        goto out;
+
+    LOCK(&nlc_ctx->lock);
+    {
+        gen = nlc_ctx->gen;
+    }
+    UNLOCK(&nlc_ctx->lock);
+out:
+    return gen;
+}
+
+/* Adds the entries of a readdirp reply as positive entries. When the
+ * replies seen on the fd cover the directory from offset 0 to EOF, without
+ * the cache being cleared in between, the directory is marked complete.
+ * @gen is the generation of the cache when the readdirp was wound: a clear
+ * while it was in flight would otherwise go unnoticed for offset 0. */
+void
+nlc_dir_add_entries(xlator_t *this, fd_t *fd, off_t offset, uint64_t gen,
+                    int32_t op_ret, gf_dirent_t *entries)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_ctx_t *nlc_ctx = NULL;
+    nlc_fd_ctx_t *fd_ctx = NULL;
+    gf_dirent_t *entry = NULL;
+    inode_t *inode = NULL;
+
+    conf = this->private;
+    inode = fd->inode;
+
+    if (inode->ia_type != IA_IFDIR) {
+        gf_msg_callingfn(this->name, GF_LOG_ERROR, EINVAL, NLC_MSG_EINVAL,
+                         "inode is not of type dir");
+        goto out;
+    }
+
+    fd_ctx = nlc_fd_ctx_get_set(this, fd, (offset == 0));
+    if (!fd_ctx)
+        goto out;
+
+    nlc_inode_ctx_get_set(this, inode, &nlc_ctx, NULL);
+    if (!nlc_ctx)
+        goto out;
+
+    LOCK(&nlc_ctx->lock);
+    {
+        if (offset == 0) {
+            fd_ctx->scanning = _gf_true;
+            fd_ctx->gen = gen;
+        } else if (!fd_ctx->scanning || (fd_ctx->gen != gen) ||
+                   (fd_ctx->next_offset != offset)) {
+            fd_ctx->scanning = _gf_false;
+        }
+
+        if (gen != nlc_ctx->gen)
+            fd_ctx->scanning = _gf_false;
+
+        if (!fd_ctx->scanning || (op_ret < 0) ||
+            !__nlc_is_cache_valid(this, nlc_ctx)) {
+            fd_ctx->scanning = _gf_false;
+            goto unlock;
+        }
+
+        if (!IS_PE_VALID(nlc_ctx->state))
+            __nlc_set_dir_state(nlc_ctx, NLC_PE_PARTIAL);
+
+        list_for_each_entry(entry, &entries->list, list)
+        {
+            fd_ctx->next_offset = entry->d_off;
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+                continue;
+
+            __nlc_del_ne(this, nlc_ctx, entry->d_name);
+            if (__nlc_add_pe(this, nlc_ctx, NULL, entry->d_name) < 0) {
+                fd_ctx->scanning = _gf_false;
+                goto unlock;
+            }
+        }
+
+        if (op_ret == 0) {
+            __nlc_set_dir_state(nlc_ctx, NLC_PE_FULL);
+            fd_ctx->scanning = _gf_false;
+            GF_ATOMIC_INC(conf->nlc_counter.complete_dirs);
+        }
+    }
+unlock:
+    UNLOCK(&nlc_ctx->lock);
+
+    nlc_lru_prune(this, NULL);
+out:
+    return;
+}
+
 gf_boolean_t
 __nlc_search_ne(nlc_ctx_t *nlc_ctx, const char *name)
 {
     gf_boolean_t found = _gf_false;
-    nlc_ne_t *ne = NULL;
-    nlc_ne_t *tmp = NULL;
 
     if (!IS_NE_VALID(nlc_ctx->state))
         goto out;
 
-    list_for_each_entry_safe(ne, tmp, &nlc_ctx->ne, list)
-    {
-        if (strcmp(ne->name, name) == 0) {
-            found = _gf_true;
-            break;
-        }
-    }
+    if (__nlc_find_ne(nlc_ctx, name))
+        found = _gf_true;
 out:
     return found;
 }
@@ -991,19 +1402,12 @@ static gf_boolean_t
 __nlc_search_pe(nlc_ctx_t *nlc_ctx, const char *name)
 {
     gf_boolean_t found = _gf_false;
-    nlc_pe_t *pe = NULL;
-    nlc_pe_t *tmp = NULL;
 
     if (!IS_PE_VALID(nlc_ctx->state))
         goto out;
 
-    list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
-    {
-        if (pe->name && (strcmp(pe->name, name) == 0)) {
-            found = _gf_true;
-            break;
-        }
-    }
+    if (__nlc_find_pe(nlc_ctx, name, _gf_false))
+        found = _gf_true;
 out:
     return found;
 }
@@ -1014,28 +1418,13 @@ __nlc_get_pe(nlc_ctx_t *nlc_ctx, const char *name,
 {
     char *found = NULL;
     nlc_pe_t *pe = NULL;
-    nlc_pe_t *tmp = NULL;
 
     if (!IS_PE_VALID(nlc_ctx->state))
         goto out;
 
-    if (case_insensitive) {
-        list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
-        {
-            if (pe->name && (strcasecmp(pe->name, name) == 0)) {
-                found = pe->name;
-                break;
-            }
-        }
-    } else {
-        list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
-        {
-            if (pe->name && (strcmp(pe->name, name) == 0)) {
-                found = pe->name;
-                break;
-            }
-        }
-    }
+    pe = __nlc_find_pe(nlc_ctx, name, case_insensitive);
+    if (pe)
+        found = pe->name;
 out:
     return found;
 }
@@ -1184,6 +1573,12 @@ nlc_dump_inodectx(xlator_t *this, inode_t *inode)
         gf_proc_dump_write("cache-time", "%ld", nlc_ctx->cache_time);
         gf_proc_dump_write("cache-size", "%zu", nlc_ctx->cache_size);
         gf_proc_dump_write("refd-inodes", "%" PRIu64, nlc_ctx->refd_inodes);
+        gf_proc_dump_write("pe-hash", "%" PRIu32 " entries, %" PRIu32
+                           " buckets", nlc_ctx->pe_table.count,
+                           nlc_ctx->pe_table.size);
+        gf_proc_dump_write("ne-hash", "%" PRIu32 " entries, %" PRIu32
+                           " buckets", nlc_ctx->ne_table.count,
+                           nlc_ctx->ne_table.size);
 
         if (IS_PE_VALID(nlc_ctx->state))
             list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
@@ -344,6 +344,53 @@ err:
     return 0;
 }
 
+static int32_t
+nlc_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                 dict_t *xdata)
+{
+    nlc_local_t *local = NULL;
+
+    local = frame->local;
+    if (!local)
+        goto out;
+
+    nlc_dir_add_entries(this, local->fd, local->offset, local->gen, op_ret,
+                        entries);
+out:
+    NLC_STACK_UNWIND(readdirp, frame, op_ret, op_errno, entries, xdata);
+    return 0;
+}
+
+static int32_t
+nlc_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+             off_t offset, dict_t *xdata)
+{
+    nlc_local_t *local = NULL;
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    if (!IS_COMPLETE_DIR_ENABLED(conf))
+        goto wind;
+
+    local = nlc_local_init(frame, this, GF_FOP_READDIRP, NULL, NULL);
+    if (!local)
+        goto wind;
+
+    local->fd = fd_ref(fd);
+    local->offset = offset;
+    local->gen = nlc_dir_gen(this, fd->inode);
+
+    STACK_WIND(frame, nlc_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, fd, size, offset, xdata);
+    return 0;
+wind:
+    STACK_WIND(frame, default_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, fd, size, offset, xdata);
+    return 0;
+}
+
 static int32_t
 nlc_symlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                 int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -572,6 +619,13 @@ nlc_forget(xlator_t *this, inode_t *inode)
     return 0;
 }
 
+static int32_t
+nlc_releasedir(xlator_t *this, fd_t *fd)
+{
+    nlc_fd_ctx_del(this, fd);
+    return 0;
+}
+
 static int32_t
 nlc_inodectx(xlator_t *this, inode_t *inode)
 {
@@ -606,6 +660,8 @@ nlc_priv_dump(xlator_t *this)
                        GF_ATOMIC_GET(conf->nlc_counter.ne_inode_cnt));
     gf_proc_dump_write("dentry_invalidations_received", "%" PRId64,
                        GF_ATOMIC_GET(conf->nlc_counter.nlc_invals));
+    gf_proc_dump_write("complete_directories", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.complete_dirs));
     gf_proc_dump_write("cache_limit", "%" PRIu64, conf->cache_size);
     gf_proc_dump_write("consumed_cache_size", "%" PRId64,
                        GF_ATOMIC_GET(conf->current_cache_size));
@@ -639,6 +695,8 @@ nlc_dump_metrics(xlator_t *this, int fd)
             this->name, GF_ATOMIC_GET(conf->nlc_counter.ne_inode_cnt));
     dprintf(fd, "%s.dentry_invalidations_received %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(conf->nlc_counter.nlc_invals));
+    dprintf(fd, "%s.complete_directories %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.complete_dirs));
     dprintf(fd, "%s.cache_limit %" PRIu64 "\n", this->name, conf->cache_size);
     dprintf(fd, "%s.consumed_cache_size %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(conf->current_cache_size));
@@ -684,6 +742,8 @@ nlc_reconfigure(xlator_t *this, dict_t *options)
                      options, bool, out);
     GF_OPTION_RECONF("nl-cache-limit", conf->cache_size, options, size_uint64,
                      out);
+    GF_OPTION_RECONF("nl-cache-complete-dir", conf->complete_dir, options,
+                     bool, out);
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
 
 out:
@@ -705,6 +765,7 @@ nlc_init(xlator_t *this)
     GF_OPTION_INIT("nl-cache-positive-entry", conf->positive_entry_cache, bool,
                    out);
     GF_OPTION_INIT("nl-cache-limit", conf->cache_size, size_uint64, out);
+    GF_OPTION_INIT("nl-cache-complete-dir", conf->complete_dir, bool, out);
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
 
     /* Since the positive entries are stored as list of refs on
@@ -729,6 +790,7 @@ nlc_init(xlator_t *this)
     GF_ATOMIC_INIT(conf->nlc_counter.pe_inode_cnt, 0);
     GF_ATOMIC_INIT(conf->nlc_counter.ne_inode_cnt, 0);
     GF_ATOMIC_INIT(conf->nlc_counter.nlc_invals, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.complete_dirs, 0);
 
     INIT_LIST_HEAD(&conf->lru);
     time(&conf->last_child_down);
@@ -761,15 +823,16 @@ struct xlator_fops nlc_fops = {
     .symlink = nlc_symlink,
     .link = nlc_link,
     .unlink = nlc_unlink,
+    .readdirp = nlc_readdirp,
     /* TODO:
     .readdir              = nlc_readdir,
-    .readdirp             = nlc_readdirp,
     .seek                 = nlc_seek,
     .opendir              = nlc_opendir, */
 };
 
 struct xlator_cbks nlc_cbks = {
     .forget = nlc_forget,
+    .releasedir = nlc_releasedir,
 };
 
 struct xlator_dumpops nlc_dumpops = {
@@ -814,6 +877,17 @@ struct volume_options nlc_options[] = {
         .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
         .description = "Time period after which cache has to be refreshed",
     },
+    {
+        .key = {"nl-cache-complete-dir"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .description = "When a directory was read to the end with readdirp, "
+                       "lookups of names that are not in it are answered "
+                       "ENOENT from the cache. Needs "
+                       "nl-cache-positive-entry",
+    },
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
@@ -28,6 +28,8 @@
 #define IS_NE_VALID(state) ((state != NLC_INVALID) && (state & NLC_NE_VALID))
 
 #define IS_PEC_ENABLED(conf) (conf->positive_entry_cache)
+#define IS_COMPLETE_DIR_ENABLED(conf)                                          \
+    (conf->positive_entry_cache && conf->complete_dir)
 #define IS_CACHE_ENABLED(conf) ((!conf->cache_disabled))
 
 #define NLC_STACK_UNWIND(fop, frame, params...)                                \
@@ -43,19 +45,42 @@
         nlc_local_wipe(__xl, __local);                                         \
     } while (0)
 
+/* Per directory hash tables of the pe and ne names start with
+ * NLC_HASH_MIN_SIZE buckets and double as entries are added, up to
+ * NLC_HASH_MAX_SIZE. The ne bloom filter has NLC_BLOOM_BITS_PER_BUCKET bits
+ * per bucket of the ne table. */
+#define NLC_HASH_MIN_SIZE 16
+#define NLC_HASH_MAX_SIZE (1 << 20)
+#define NLC_BLOOM_BITS_PER_BUCKET 8
+
 enum nlc_cache_clear_reason {
     NLC_NONE = 0,
     NLC_LRU_PRUNE,
 };
 
+/* Hash chain of a pe/ne entry; hashval is the hash of the case folded
+ * name, so that case insensitive searches land in the same bucket. */
+struct nlc_hnode {
+    struct list_head list;
+    uint32_t hashval;
+};
+
+struct nlc_name_table {
+    struct list_head *buckets;
+    uint32_t size; /* power of 2, 0 until the first entry is added */
+    uint32_t count;
+};
+
 struct nlc_ne {
     struct list_head list;
+    struct nlc_hnode hnode;
     char *name;
 };
 typedef struct nlc_ne nlc_ne_t;
 
 struct nlc_pe {
     struct list_head list;
+    struct nlc_hnode hnode;
     inode_t *inode;
     char *name;
 };
@@ -76,6 +101,10 @@ typedef struct nlc_lru_node nlc_lru_node_t;
 struct nlc_ctx {
     struct list_head pe; /* list of positive entries */
     struct list_head ne; /* list of negative entries */
+    struct nlc_name_table pe_table;
+    struct nlc_name_table ne_table;
+    unsigned char *ne_bloom; /* ne_table.size * NLC_BLOOM_BITS_PER_BUCKET */
+    uint64_t gen;            /* incremented every time the cache is cleared */
     uint64_t state;
     time_t cache_time;
     struct gf_tw_timer_list *timer;
@@ -93,10 +122,21 @@ struct nlc_local {
     inode_t *parent;
     fd_t *fd;
     char *linkname;
+    off_t offset;
+    uint64_t gen; /* of the directory when the readdirp was wound */
     glusterfs_fop_t fop;
 };
 typedef struct nlc_local nlc_local_t;
 
+/* Tracks a readdirp pass over a directory, from offset 0 to EOF, to tell
+ * whether it saw every entry of the directory */
+struct nlc_fd_ctx {
+    uint64_t gen;
+    off_t next_offset;
+    gf_boolean_t scanning;
+};
+typedef struct nlc_fd_ctx nlc_fd_ctx_t;
+
 struct nlc_statistics {
     gf_atomic_t nlc_hit;  /* No. of times lookup/stat was served from this xl */
     gf_atomic_t nlc_miss; /* No. of times negative lookups were sent to disk */
@@ -107,11 +147,13 @@ struct nlc_statistics {
     gf_atomic_t pe_inode_cnt;
     gf_atomic_t ne_inode_cnt;
     gf_atomic_t nlc_invals; /* No. of invalidates received from upcall*/
+    gf_atomic_t complete_dirs; /* No. of dirs fully read through readdirp */
 };
 
 struct nlc_conf {
     int32_t cache_timeout;
     gf_boolean_t positive_entry_cache;
+    gf_boolean_t complete_dir;
     gf_boolean_t negative_entry_cache;
     gf_boolean_t disable_cache;
     uint64_t cache_size;
@@ -147,6 +189,16 @@ nlc_dir_remove_pe(xlator_t *this, inode_t *inode, inode_t *entry_ino,
 void
 nlc_dir_add_ne(xlator_t *this, inode_t *inode, const char *name);
 
+uint64_t
+nlc_dir_gen(xlator_t *this, inode_t *inode);
+
+void
+nlc_dir_add_entries(xlator_t *this, fd_t *fd, off_t offset, uint64_t gen,
+                    int32_t op_ret, gf_dirent_t *entries);
+
+void
+nlc_fd_ctx_del(xlator_t *this, fd_t *fd);
+
 void
 nlc_local_wipe(xlator_t *this, nlc_local_t *local);
 
@@ -30,6 +30,19 @@ typedef struct ob_conf {
                                            first and then send readv i.e
                                            similar to what writev does
                                         */
+    gf_boolean_t anonymous_fops;   /* readv(), fstat() and fgetxattr()
+                                      always go on anonymous fds and never
+                                      trigger the open */
+    uint32_t open_batch_size;      /* pending opens for writing sent along
+                                      with an open that has to be sent */
+    gf_lock_t lock;
+    struct list_head write_pending; /* fds opened for writing whose open
+                                       was not sent yet */
+    gf_atomic_t opens_deferred;
+    gf_atomic_t opens_sent;
+    gf_atomic_t opens_batched;
+    gf_atomic_t opens_avoided;
+    gf_atomic_t anonymous_fops_count;
 } ob_conf_t;
 
 typedef struct ob_inode {
@@ -55,6 +68,8 @@ typedef struct ob_fd {
     gf_boolean_t ob_inode_fops_waiting;
     struct list_head list;
     struct list_head ob_fds_on_inode;
+    struct list_head pending;  /* in conf->write_pending */
+    call_frame_t *batch_frame; /* open claimed by ob_fd_wake_batch() */
 } ob_fd_t;
 
 ob_inode_t *
@@ -188,6 +203,7 @@ ob_fd_new(void)
 
     INIT_LIST_HEAD(&ob_fd->list);
     INIT_LIST_HEAD(&ob_fd->ob_fds_on_inode);
+    INIT_LIST_HEAD(&ob_fd->pending);
 
     return ob_fd;
 }
@@ -195,6 +211,16 @@ ob_fd_new(void)
 void
 ob_fd_free(ob_fd_t *ob_fd)
 {
+    ob_conf_t *conf = THIS->private;
+
+    if (!list_empty(&ob_fd->pending)) {
+        LOCK(&conf->lock);
+        {
+            list_del_init(&ob_fd->pending);
+        }
+        UNLOCK(&conf->lock);
+    }
+
     LOCK(&ob_fd->fd->inode->lock);
     {
         list_del_init(&ob_fd->ob_fds_on_inode);
@@ -310,10 +336,86 @@ ob_wake_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     return 0;
 }
 
+static void
+ob_fd_wind_open(xlator_t *this, call_frame_t *frame, fd_t *fd, ob_fd_t *ob_fd)
+{
+    ob_conf_t *conf = this->private;
+
+    /* We don't need to take a reference here. We already have a reference
+     * while the open is pending. */
+    frame->local = fd;
+
+    GF_ATOMIC_INC(conf->opens_sent);
+
+    STACK_WIND(frame, ob_wake_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->open, &ob_fd->loc, ob_fd->flags, fd,
+               ob_fd->xdata);
+}
+
+/*
+ * An open has to be sent: send along, back to back, up to open_batch_size
+ * of the opens for writing still pending on other fds. Those will have to
+ * be sent as soon as the application writes, reads on them go on anonymous
+ * fds anyway.
+ */
+static void
+ob_fd_wake_batch(xlator_t *this, ob_fd_t *except)
+{
+    ob_conf_t *conf = this->private;
+    ob_fd_t *ob_fd = NULL, *tmp = NULL;
+    call_frame_t *frame = NULL;
+    struct list_head batch;
+    uint32_t count = 0;
+
+    INIT_LIST_HEAD(&batch);
+
+    LOCK(&conf->lock);
+    {
+        list_for_each_entry_safe(ob_fd, tmp, &conf->write_pending, pending)
+        {
+            if (count >= conf->open_batch_size)
+                break;
+
+            if (ob_fd == except)
+                continue;
+
+            list_del_init(&ob_fd->pending);
+
+            /* claim the open, the pending reference on the fd keeps
+             * ob_fd around until it is wound */
+            LOCK(&ob_fd->fd->lock);
+            {
+                frame = ob_fd->open_frame;
+                ob_fd->open_frame = NULL;
+            }
+            UNLOCK(&ob_fd->fd->lock);
+
+            if (frame) {
+                ob_fd->batch_frame = frame;
+                list_add_tail(&ob_fd->pending, &batch);
+                count++;
+            }
+        }
+    }
+    UNLOCK(&conf->lock);
+
+    list_for_each_entry_safe(ob_fd, tmp, &batch, pending)
+    {
+        list_del_init(&ob_fd->pending);
+
+        frame = ob_fd->batch_frame;
+        ob_fd->batch_frame = NULL;
+
+        GF_ATOMIC_INC(conf->opens_batched);
+        ob_fd_wind_open(this, frame, ob_fd->fd, ob_fd);
+    }
+}
+
 int
 ob_fd_wake(xlator_t *this, fd_t *fd, ob_fd_t *ob_fd)
 {
     call_frame_t *frame = NULL;
+    ob_conf_t *conf = this->private;
 
     if (ob_fd == NULL) {
         LOCK(&fd->lock);
@@ -337,13 +439,18 @@ ob_fd_wake(xlator_t *this, fd_t *fd, ob_fd_t *ob_fd)
     }
 
     if (frame) {
-        /* We don't need to take a reference here. We already have a reference
-         * while the open is pending. */
-        frame->local = fd;
+        if (!list_empty(&ob_fd->pending)) {
+            LOCK(&conf->lock);
+            {
+                list_del_init(&ob_fd->pending);
+            }
+            UNLOCK(&conf->lock);
+        }
 
-        STACK_WIND(frame, ob_wake_cbk, FIRST_CHILD(this),
-                   FIRST_CHILD(this)->fops->open, &ob_fd->loc, ob_fd->flags, fd,
-                   ob_fd->xdata);
+        if (conf->open_batch_size)
+            ob_fd_wake_batch(this, ob_fd);
+
+        ob_fd_wind_open(this, frame, fd, ob_fd);
     }
 
     return 0;
@@ -549,6 +656,17 @@ ob_open_behind(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
     fd_ref(fd);
 
     if (!open_in_progress && !unlinked) {
+        GF_ATOMIC_INC(conf->opens_deferred);
+
+        /* only opens for writing are ever sent along with another */
+        if (conf->lazy_open && ((flags & O_ACCMODE) != O_RDONLY)) {
+            LOCK(&conf->lock);
+            {
+                list_add_tail(&ob_fd->pending, &conf->write_pending);
+            }
+            UNLOCK(&conf->lock);
+        }
+
         STACK_UNWIND_STRICT(open, frame, 0, 0, fd, xdata);
 
         if (!conf->lazy_open)
@@ -626,10 +744,12 @@ ob_get_wind_fd(xlator_t *this, fd_t *fd, uint32_t *flag)
 
     ob_fd = ob_fd_ctx_get(this, fd);
 
-    if (ob_fd && ob_fd->open_frame && conf->use_anonymous_fd) {
+    if (ob_fd && ob_fd->open_frame &&
+        (conf->use_anonymous_fd || conf->anonymous_fops)) {
         wind_fd = fd_anonymous(fd->inode);
         if ((ob_fd->flags & O_DIRECT) && (flag))
             *flag = *flag | O_DIRECT;
+        GF_ATOMIC_INC(conf->anonymous_fops_count);
     } else {
         wind_fd = fd_ref(fd);
     }
@@ -647,7 +767,7 @@ ob_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     conf = this->private;
 
-    if (!conf->read_after_open)
+    if (!conf->read_after_open || conf->anonymous_fops)
         wind_fd = ob_get_wind_fd(this, fd, &flags);
     else
         wind_fd = fd_ref(fd);
@@ -834,12 +954,24 @@ ob_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
              dict_t *xdata)
 {
     call_stub_t *stub = NULL;
+    fd_t *wind_fd = NULL;
+    ob_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    if (conf->anonymous_fops)
+        wind_fd = ob_get_wind_fd(this, fd, NULL);
+    else
+        wind_fd = fd_ref(fd);
+
+    stub = fop_fgetxattr_stub(frame, default_fgetxattr_resume, wind_fd, name,
+                              xdata);
+    fd_unref(wind_fd);
 
-    stub = fop_fgetxattr_stub(frame, default_fgetxattr_resume, fd, name, xdata);
     if (!stub)
         goto err;
 
-    open_and_resume(this, fd, stub);
+    open_and_resume(this, wind_fd, stub);
 
     return 0;
 err:
@@ -1077,9 +1209,14 @@ int
 ob_release(xlator_t *this, fd_t *fd)
 {
     ob_fd_t *ob_fd = NULL;
+    ob_conf_t *conf = this->private;
 
     ob_fd = ob_fd_ctx_get(this, fd);
 
+    /* the open was never sent */
+    if (ob_fd && ob_fd->open_frame)
+        GF_ATOMIC_INC(conf->opens_avoided);
+
     ob_fd_free(ob_fd);
 
     return 0;
@@ -1121,6 +1258,25 @@ ob_priv_dump(xlator_t *this)
 
     gf_proc_dump_write("lazy_open", "%d", conf->lazy_open);
 
+    gf_proc_dump_write("anonymous_fops", "%d", conf->anonymous_fops);
+
+    gf_proc_dump_write("open_batch_size", "%u", conf->open_batch_size);
+
+    gf_proc_dump_write("opens_deferred", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->opens_deferred));
+
+    gf_proc_dump_write("opens_sent", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->opens_sent));
+
+    gf_proc_dump_write("opens_batched", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->opens_batched));
+
+    gf_proc_dump_write("opens_avoided", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->opens_avoided));
+
+    gf_proc_dump_write("anonymous_fd_fops", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->anonymous_fops_count));
+
     return 0;
 }
 
@@ -1196,6 +1352,12 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("read-after-open", conf->read_after_open, options, bool,
                      out);
 
+    GF_OPTION_RECONF("anonymous-fops", conf->anonymous_fops, options, bool,
+                     out);
+
+    GF_OPTION_RECONF("open-batch-size", conf->open_batch_size, options,
+                     uint32, out);
+
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
     ret = 0;
 out:
@@ -1224,20 +1386,34 @@ init(xlator_t *this)
     if (!conf)
         goto err;
 
+    LOCK_INIT(&conf->lock);
+    INIT_LIST_HEAD(&conf->write_pending);
+    GF_ATOMIC_INIT(conf->opens_deferred, 0);
+    GF_ATOMIC_INIT(conf->opens_sent, 0);
+    GF_ATOMIC_INIT(conf->opens_batched, 0);
+    GF_ATOMIC_INIT(conf->opens_avoided, 0);
+    GF_ATOMIC_INIT(conf->anonymous_fops_count, 0);
+
     GF_OPTION_INIT("use-anonymous-fd", conf->use_anonymous_fd, bool, err);
 
     GF_OPTION_INIT("lazy-open", conf->lazy_open, bool, err);
 
     GF_OPTION_INIT("read-after-open", conf->read_after_open, bool, err);
 
+    GF_OPTION_INIT("anonymous-fops", conf->anonymous_fops, bool, err);
+
+    GF_OPTION_INIT("open-batch-size", conf->open_batch_size, uint32, err);
+
     GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
 
     this->private = conf;
 
     return 0;
 err:
-    if (conf)
+    if (conf) {
+        LOCK_DESTROY(&conf->lock);
         GF_FREE(conf);
+    }
 
     return -1;
 }
@@ -1248,7 +1424,10 @@ fini(xlator_t *this)
     ob_conf_t *conf = NULL;
 
     conf = this->private;
+    if (!conf)
+        return;
 
+    LOCK_DESTROY(&conf->lock);
     GF_FREE(conf);
 
     return;
@@ -1332,6 +1511,33 @@ struct volume_options options[] = {
         .tags = {},
         /* option_validation_fn validate_fn; */
     },
+    {
+        .key = {"anonymous-fops"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .description = "readv, fstat and fgetxattr on an fd whose open was "
+                       "not sent yet go on an anonymous fd and do not "
+                       "trigger the open, whatever use-anonymous-fd and "
+                       "read-after-open say. Files that are only opened, "
+                       "read and closed are never opened on the bricks.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"open-behind"},
+    },
+    {
+        .key = {"open-batch-size"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 1024,
+        .default_value = "0",
+        .description = "When an open has to be sent, send along up to this "
+                       "many of the opens for writing still pending on "
+                       "other fds, instead of waiting for a fop on each of "
+                       "them. 0 sends opens one at a time.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"open-behind"},
+    },
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
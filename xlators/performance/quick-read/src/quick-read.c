@@ -9,6 +9,7 @@
 */
 
 #include <math.h>
+#include <zlib.h>
 #include "quick-read.h"
 #include <glusterfs/statedump.h>
 #include "quick-read-messages.h"
@@ -28,6 +29,85 @@ void
 __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
                       qr_inode_t *qr_inode);
 
+static inline qr_inode_table_t *
+qr_inode_table(qr_private_t *priv, qr_inode_t *qr_inode)
+{
+    return &priv->table[qr_inode->shard];
+}
+
+static uint64_t
+qr_inode_key(inode_t *inode)
+{
+    uint64_t key = (uint64_t)(uintptr_t)inode;
+
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+
+    return key ^ (key >> 31);
+}
+
+/* the low bits of the key pick the shard, higher ones the sketch counters */
+#define QR_SHARD_INDEX(key) ((key) % QR_SHARD_COUNT)
+#define QR_SKETCH_INDEX(key, row)                                              \
+    (((key) >> (4 + (row)*15)) & (QR_SKETCH_WIDTH - 1))
+
+/* To be called with table->lock held */
+static void
+__qr_sketch_record(qr_inode_table_t *table, uint64_t key)
+{
+    uint8_t *counter = NULL;
+    int i = 0;
+
+    for (i = 0; i < QR_SKETCH_DEPTH; i++) {
+        counter = &table->sketch[i * QR_SKETCH_WIDTH +
+                                 QR_SKETCH_INDEX(key, i)];
+        if (*counter < QR_SKETCH_MAX)
+            (*counter)++;
+    }
+
+    if (++table->samples < QR_SKETCH_SAMPLES)
+        return;
+
+    for (i = 0; i < QR_SKETCH_DEPTH * QR_SKETCH_WIDTH; i++)
+        table->sketch[i] >>= 1;
+    table->samples /= 2;
+}
+
+/* To be called with table->lock held */
+static uint8_t
+__qr_sketch_estimate(qr_inode_table_t *table, uint64_t key)
+{
+    uint8_t freq = QR_SKETCH_MAX;
+    uint8_t counter = 0;
+    int i = 0;
+
+    for (i = 0; i < QR_SKETCH_DEPTH; i++) {
+        counter = table->sketch[i * QR_SKETCH_WIDTH + QR_SKETCH_INDEX(key, i)];
+        if (counter < freq)
+            freq = counter;
+    }
+
+    return freq;
+}
+
+static void
+qr_sketch_record(xlator_t *this, inode_t *inode)
+{
+    qr_private_t *priv = NULL;
+    qr_inode_table_t *table = NULL;
+    uint64_t key = 0;
+
+    priv = this->private;
+    key = qr_inode_key(inode);
+    table = &priv->table[QR_SHARD_INDEX(key)];
+
+    LOCK(&table->lock);
+    {
+        __qr_sketch_record(table, key);
+    }
+    UNLOCK(&table->lock);
+}
+
 void
 qr_local_wipe(qr_local_t *local)
 {
@@ -53,7 +133,7 @@ __qr_get_generation(xlator_t *this, qr_inode_t *qr_inode)
     qr_inode_table_t *table = NULL;
 
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
 
     gen = GF_ATOMIC_INC(priv->generation);
     if (gen == 0) {
@@ -77,11 +157,11 @@ qr_get_generation(xlator_t *this, inode_t *inode)
     qr_private_t *priv = NULL;
 
     priv = this->private;
-    table = &priv->table;
 
     qr_inode = qr_inode_ctx_get(this, inode);
 
     if (qr_inode) {
+        table = qr_inode_table(priv, qr_inode);
         LOCK(&table->lock);
         {
             gen = __qr_get_generation(this, qr_inode);
@@ -184,6 +264,8 @@ qr_inode_new(xlator_t *this, inode_t *inode)
 
     INIT_LIST_HEAD(&qr_inode->lru);
 
+    qr_inode->key = qr_inode_key(inode);
+    qr_inode->shard = QR_SHARD_INDEX(qr_inode->key);
     qr_inode->priority = 0; /* initial priority */
 
     return qr_inode;
@@ -210,7 +292,8 @@ qr_inode_ctx_get_or_new(xlator_t *this, inode_t *inode)
 
         ret = __qr_inode_ctx_set(this, inode, qr_inode);
         if (ret) {
-            __qr_inode_prune(this, &priv->table, qr_inode, 0);
+            __qr_inode_prune(this, qr_inode_table(priv, qr_inode), qr_inode,
+                             0);
             GF_FREE(qr_inode);
             qr_inode = NULL;
         }
@@ -249,11 +332,13 @@ __qr_inode_register(xlator_t *this, qr_inode_table_t *table,
     if (!priv)
         return;
 
-    if (list_empty(&qr_inode->lru))
+    if (list_empty(&qr_inode->lru)) {
         /* first time addition of this qr_inode into table */
-        table->cache_used += qr_inode->size;
-    else
+        table->cache_used += qr_inode->stored;
+        table->cache_data += qr_inode->size;
+    } else {
         list_del_init(&qr_inode->lru);
+    }
 
     list_add_tail(&qr_inode->lru, &table->lru[qr_inode->priority]);
 
@@ -276,7 +361,7 @@ qr_inode_set_priority(xlator_t *this, inode_t *inode, const char *path)
         return;
 
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
     conf = &priv->conf;
 
     if (path)
@@ -306,8 +391,10 @@ __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
     qr_inode->data = NULL;
 
     if (!list_empty(&qr_inode->lru)) {
-        table->cache_used -= qr_inode->size;
+        table->cache_used -= qr_inode->stored;
+        table->cache_data -= qr_inode->size;
         qr_inode->size = 0;
+        qr_inode->stored = 0;
 
         list_del_init(&qr_inode->lru);
 
@@ -317,7 +404,7 @@ __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
     memset(&qr_inode->buf, 0, sizeof(qr_inode->buf));
 }
 
-/* To be called with priv->table.lock held */
+/* To be called with table->lock held */
 void
 __qr_inode_prune(xlator_t *this, qr_inode_table_t *table, qr_inode_t *qr_inode,
                  uint64_t gen)
@@ -340,7 +427,7 @@ qr_inode_prune(xlator_t *this, inode_t *inode, uint64_t gen)
         return;
 
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
 
     LOCK(&table->lock);
     {
@@ -349,23 +436,31 @@ qr_inode_prune(xlator_t *this, inode_t *inode, uint64_t gen)
     UNLOCK(&table->lock);
 }
 
-/* To be called with priv->table.lock held */
+static uint64_t
+qr_shard_cache_size(qr_conf_t *conf)
+{
+    return conf->cache_size / QR_SHARD_COUNT;
+}
+
+/* To be called with table->lock held */
 void
 __qr_cache_prune(xlator_t *this, qr_inode_table_t *table, qr_conf_t *conf)
 {
+    qr_private_t *priv = NULL;
     qr_inode_t *curr = NULL;
     qr_inode_t *next = NULL;
     int index = 0;
-    size_t size_pruned = 0;
+
+    priv = this->private;
 
     for (index = 0; index < conf->max_pri; index++) {
         list_for_each_entry_safe(curr, next, &table->lru[index], lru)
         {
-            size_pruned += curr->size;
-
             __qr_inode_prune(this, table, curr, 0);
 
-            if (table->cache_used < conf->cache_size)
+            GF_ATOMIC_INC(priv->qr_counter.evictions);
+
+            if (table->cache_used < qr_shard_cache_size(conf))
                 return;
         }
     }
@@ -374,32 +469,109 @@ __qr_cache_prune(xlator_t *this, qr_inode_table_t *table, qr_conf_t *conf)
 }
 
 void
-qr_cache_prune(xlator_t *this)
+qr_cache_prune(xlator_t *this, qr_inode_table_t *table)
 {
     qr_private_t *priv = NULL;
     qr_conf_t *conf = NULL;
-    qr_inode_table_t *table = NULL;
 
     priv = this->private;
-    table = &priv->table;
     conf = &priv->conf;
 
     LOCK(&table->lock);
     {
-        if (table->cache_used > conf->cache_size)
+        if (table->cache_used > qr_shard_cache_size(conf))
             __qr_cache_prune(this, table, conf);
     }
     UNLOCK(&table->lock);
 }
 
+/* TinyLFU admission: when storing @stored more bytes would make the shard
+ * evict, the new content only gets in if it was accessed more often than
+ * the entry that would be evicted first. This keeps one-off reads of a
+ * large set of files from flushing the files that are read over and over.
+ *
+ * To be called with table->lock held.
+ */
+static gf_boolean_t
+__qr_cache_admit(qr_inode_table_t *table, qr_conf_t *conf,
+                 qr_inode_t *qr_inode, size_t stored)
+{
+    qr_inode_t *victim = NULL;
+    int index = 0;
+
+    if (table->cache_used + stored <= qr_shard_cache_size(conf))
+        return _gf_true;
+
+    for (index = 0; index < conf->max_pri; index++) {
+        if (list_empty(&table->lru[index]))
+            continue;
+
+        /* lower priority entries go first, whatever their frequency */
+        if (index < qr_inode->priority)
+            return _gf_true;
+
+        victim = list_first_entry(&table->lru[index], qr_inode_t, lru);
+
+        return (__qr_sketch_estimate(table, qr_inode->key) >
+                __qr_sketch_estimate(table, victim->key));
+    }
+
+    return _gf_true;
+}
+
+/* Returns the compressed copy of @data, freeing @data, or @data itself when
+ * compression does not save at least an eighth of it.
+ */
+static void *
+qr_content_deflate(xlator_t *this, void *data, size_t size, size_t *stored)
+{
+    void *zdata = NULL;
+    uLongf zsize = 0;
+    int ret = 0;
+
+    *stored = size;
+
+    if (size < QR_COMPRESS_MIN_SIZE)
+        return data;
+
+    zsize = compressBound(size);
+    zdata = GF_MALLOC(zsize, gf_qr_mt_content_t);
+    if (!zdata)
+        return data;
+
+    ret = compress2(zdata, &zsize, data, size, Z_BEST_SPEED);
+    if ((ret != Z_OK) || (zsize > size - (size / 8))) {
+        GF_FREE(zdata);
+        return data;
+    }
+
+    GF_FREE(data);
+    *stored = zsize;
+
+    return zdata;
+}
+
+static int
+qr_content_inflate(void *zdata, size_t zsize, void *data, size_t size)
+{
+    uLongf len = size;
+
+    if (uncompress(data, &len, zdata, zsize) != Z_OK)
+        return -1;
+
+    return (len == size) ? 0 : -1;
+}
+
 void *
-qr_content_extract(dict_t *xdata)
+qr_content_extract(dict_t *xdata, size_t *size)
 {
     data_t *data = NULL;
     void *content = NULL;
     int ret = 0;
 
     ret = dict_get_with_ref(xdata, GF_CONTENT_KEY, &data);
+    if (ret < 0 || !data)
+        ret = dict_get_with_ref(xdata, GF_CONTENT_HEAD_KEY, &data);
     if (ret < 0 || !data)
         return NULL;
 
@@ -408,6 +580,7 @@ qr_content_extract(dict_t *xdata)
         goto out;
 
     memcpy(content, data->data, data->len);
+    *size = data->len;
 
 out:
     data_unref(data);
@@ -416,11 +589,13 @@ out:
 
 void
 qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
-                  struct iatt *buf, uint64_t gen)
+                  size_t size, struct iatt *buf, uint64_t gen)
 {
     qr_private_t *priv = NULL;
+    qr_conf_t *conf = NULL;
     qr_inode_table_t *table = NULL;
     uint32_t rollover = 0;
+    size_t stored = size;
     struct timeval tv = {
         0,
     };
@@ -429,7 +604,11 @@ qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
     gen = gen & 0xffffffff;
 
     priv = this->private;
-    table = &priv->table;
+    conf = &priv->conf;
+    table = qr_inode_table(priv, qr_inode);
+
+    if (conf->compression)
+        data = qr_content_deflate(this, data, size, &stored);
 
     gettimeofday(&tv, NULL);
     LOCK(&table->lock);
@@ -443,9 +622,15 @@ qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
 
         __qr_inode_prune(this, table, qr_inode, gen);
 
+        if (conf->tinylfu && !__qr_cache_admit(table, conf, qr_inode, stored)) {
+            GF_ATOMIC_INC(priv->qr_counter.admission_rejects);
+            goto unlock;
+        }
+
         qr_inode->data = data;
         data = NULL;
-        qr_inode->size = buf->ia_size;
+        qr_inode->size = size;
+        qr_inode->stored = stored;
 
         qr_inode->ia_mtime = buf->ia_mtime;
         qr_inode->ia_mtime_nsec = buf->ia_mtime_nsec;
@@ -464,13 +649,21 @@ unlock:
     if (data)
         GF_FREE(data);
 
-    qr_cache_prune(this);
+    qr_cache_prune(this, table);
 }
 
 gf_boolean_t
 qr_size_fits(qr_conf_t *conf, struct iatt *buf)
 {
-    return (buf->ia_size <= conf->max_file_size);
+    /* a file that fits in head-size is cached whole too */
+    return (buf->ia_size <= max(conf->max_file_size, conf->head_size));
+}
+
+/* only the first qr_inode->size bytes of the file are cached */
+static gf_boolean_t
+qr_inode_is_head(qr_inode_t *qr_inode)
+{
+    return (qr_inode->data && (qr_inode->size < qr_inode->buf.ia_size));
 }
 
 gf_boolean_t
@@ -509,7 +702,7 @@ __qr_content_refresh(xlator_t *this, qr_inode_t *qr_inode, struct iatt *buf,
     gen = gen & 0xffffffff;
 
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
     conf = &priv->conf;
 
     /* allow for rollover of frame->root->unique */
@@ -522,7 +715,10 @@ __qr_content_refresh(xlator_t *this, qr_inode_t *qr_inode, struct iatt *buf,
 
     qr_inode->gen = gen;
 
-    if (qr_size_fits(conf, buf) && qr_time_equal(conf, qr_inode, buf)) {
+    /* a cached head stays valid for as long as the file is unmodified,
+     * whatever its size */
+    if ((qr_size_fits(conf, buf) || qr_inode_is_head(qr_inode)) &&
+        qr_time_equal(conf, qr_inode, buf)) {
         qr_inode->buf = *buf;
 
         gettimeofday(&qr_inode->last_refresh, NULL);
@@ -544,7 +740,7 @@ qr_content_refresh(xlator_t *this, qr_inode_t *qr_inode, struct iatt *buf,
     qr_inode_table_t *table = NULL;
 
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
 
     LOCK(&table->lock);
     {
@@ -583,12 +779,17 @@ qr_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
               dict_t *xdata, struct iatt *postparent)
 {
     void *content = NULL;
+    size_t size = 0;
     qr_inode_t *qr_inode = NULL;
     inode_t *inode = NULL;
     qr_local_t *local = NULL;
+    qr_private_t *priv = NULL;
+    qr_conf_t *conf = NULL;
 
     local = frame->local;
     inode = local->inode;
+    priv = this->private;
+    conf = &priv->conf;
 
     if (op_ret == -1) {
         qr_inode_prune(this, inode, local->incident_gen);
@@ -605,7 +806,19 @@ qr_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         goto out;
     }
 
-    content = qr_content_extract(xdata);
+    content = qr_content_extract(xdata, &size);
+
+    /* A partial reply (head of a larger file) is kept only up to
+     * head-size; a whole file only if it fits max-file-size.
+     */
+    if (content && ((size != buf->ia_size) || !qr_size_fits(conf, buf))) {
+        if (size > conf->head_size)
+            size = conf->head_size;
+        if (!size || (size >= buf->ia_size)) {
+            GF_FREE(content);
+            content = NULL;
+        }
+    }
 
     if (content) {
         /* new content came along, always replace old content */
@@ -616,7 +829,8 @@ qr_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
             goto out;
         }
 
-        qr_content_update(this, qr_inode, content, buf, local->incident_gen);
+        qr_content_update(this, qr_inode, content, size, buf,
+                          local->incident_gen);
     } else {
         /* purge old content if necessary */
         qr_inode = qr_inode_ctx_get(this, inode);
@@ -632,12 +846,43 @@ out:
     return 0;
 }
 
+/* The content (or head) of a file is only asked for along with a lookup
+ * when nothing valid is cached for it: content already cached is
+ * revalidated against the attributes the lookup returns, and inodes known
+ * not to be regular files have none.
+ */
+static gf_boolean_t
+qr_lookup_wants_content(xlator_t *this, inode_t *inode)
+{
+    qr_private_t *priv = NULL;
+    qr_inode_t *qr_inode = NULL;
+    qr_inode_table_t *table = NULL;
+    gf_boolean_t wants = _gf_true;
+
+    if ((inode->ia_type != IA_INVAL) && (inode->ia_type != IA_IFREG))
+        return _gf_false;
+
+    qr_inode = qr_inode_ctx_get(this, inode);
+    if (!qr_inode)
+        return _gf_true;
+
+    priv = this->private;
+    table = qr_inode_table(priv, qr_inode);
+
+    LOCK(&table->lock);
+    {
+        wants = (qr_inode->data == NULL);
+    }
+    UNLOCK(&table->lock);
+
+    return wants;
+}
+
 int
 qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
 {
     qr_private_t *priv = NULL;
     qr_conf_t *conf = NULL;
-    qr_inode_t *qr_inode = NULL;
     int ret = -1;
     dict_t *new_xdata = NULL;
     qr_local_t *local = NULL;
@@ -648,9 +893,11 @@ qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
     local->inode = inode_ref(loc->inode);
     frame->local = local;
 
-    qr_inode = qr_inode_ctx_get(this, loc->inode);
-    if (qr_inode && qr_inode->data)
-        /* cached. only validate in qr_lookup_cbk */
+    if (conf->tinylfu)
+        qr_sketch_record(this, loc->inode);
+
+    if (!qr_lookup_wants_content(this, loc->inode))
+        /* cached or not a file. only validate in qr_lookup_cbk */
         goto wind;
 
     if (!xdata)
@@ -660,7 +907,11 @@ qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
         goto wind;
 
     ret = 0;
-    if (conf->max_file_size)
+    if (conf->head_size)
+        ret = dict_set(xdata, GF_CONTENT_HEAD_KEY,
+                       data_from_uint64(max(conf->max_file_size,
+                                            conf->head_size)));
+    else if (conf->max_file_size)
         ret = dict_set(xdata, GF_CONTENT_KEY,
                        data_from_uint64(conf->max_file_size));
     if (ret)
@@ -729,6 +980,9 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
     qr_private_t *priv = NULL;
     qr_inode_table_t *table = NULL;
     int op_ret = -1;
+    void *zdata = NULL;
+    size_t zsize = 0;
+    size_t full = 0;
     struct iobuf *iobuf = NULL;
     struct iobref *iobref = NULL;
     struct iovec iov = {
@@ -740,7 +994,7 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
 
     this = frame->this;
     priv = this->private;
-    table = &priv->table;
+    table = qr_inode_table(priv, qr_inode);
 
     LOCK(&table->lock);
     {
@@ -750,12 +1004,27 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
         if (offset >= qr_inode->size)
             goto unlock;
 
+        /* a read running past a cached head has to go to the bricks */
+        if (qr_inode_is_head(qr_inode) && (offset + size > qr_inode->size))
+            goto unlock;
+
         if (!__qr_cache_is_fresh(this, qr_inode))
             goto unlock;
 
         op_ret = min(size, (qr_inode->size - offset));
 
-        iobuf = iobuf_get2(this->ctx->iobuf_pool, op_ret);
+        /* a compressed body is inflated outside the lock, from a copy */
+        if (qr_inode->stored < qr_inode->size) {
+            zdata = gf_memdup(qr_inode->data, qr_inode->stored);
+            if (!zdata) {
+                op_ret = -1;
+                goto unlock;
+            }
+            zsize = qr_inode->stored;
+            full = qr_inode->size;
+        }
+
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, zdata ? full : op_ret);
         if (!iobuf) {
             op_ret = -1;
             goto unlock;
@@ -769,18 +1038,28 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
 
         iobref_add(iobref, iobuf);
 
-        memcpy(iobuf->ptr, qr_inode->data + offset, op_ret);
+        if (!zdata)
+            memcpy(iobuf->ptr, qr_inode->data + offset, op_ret);
 
         buf = qr_inode->buf;
 
+        if (priv->conf.tinylfu)
+            __qr_sketch_record(table, qr_inode->key);
+
         /* bump LRU */
         __qr_inode_register(frame->this, table, qr_inode);
     }
 unlock:
     UNLOCK(&table->lock);
 
+    if (zdata) {
+        if ((op_ret >= 0) && qr_content_inflate(zdata, zsize, iobuf->ptr, full))
+            op_ret = -1;
+        GF_FREE(zdata);
+    }
+
     if (op_ret >= 0) {
-        iov.iov_base = iobuf->ptr;
+        iov.iov_base = iobuf->ptr + (full ? offset : 0);
         iov.iov_len = op_ret;
 
         GF_ATOMIC_INC(priv->qr_counter.cache_hit);
@@ -1047,7 +1326,11 @@ qr_inodectx_dump(xlator_t *this, inode_t *inode)
     gf_proc_dump_add_section("%s", key_prefix);
 
     gf_proc_dump_write("entire-file-cached", "%s",
-                       qr_inode->data ? "yes" : "no");
+                       (qr_inode->data && !qr_inode_is_head(qr_inode))
+                           ? "yes"
+                           : "no");
+    if (qr_inode_is_head(qr_inode))
+        gf_proc_dump_write("head-cached", "%zu", qr_inode->size);
 
     if (qr_inode->last_refresh.tv_sec) {
         gf_time_fmt(buf, sizeof buf, qr_inode->last_refresh.tv_sec,
@@ -1070,9 +1353,13 @@ qr_priv_dump(xlator_t *this)
     qr_private_t *priv = NULL;
     qr_inode_table_t *table = NULL;
     uint32_t file_count = 0;
+    uint32_t shard_files = 0;
     uint32_t i = 0;
+    uint32_t j = 0;
     qr_inode_t *curr = NULL;
     uint64_t total_size = 0;
+    uint64_t total_data = 0;
+    char key[GF_DUMP_MAX_BUF_LEN];
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
 
     if (!this) {
@@ -1084,37 +1371,62 @@ qr_priv_dump(xlator_t *this)
     if (!conf)
         return -1;
 
-    table = &priv->table;
-
     gf_proc_dump_build_key(key_prefix, "xlator.performance.quick-read", "priv");
 
     gf_proc_dump_add_section("%s", key_prefix);
 
     gf_proc_dump_write("max_file_size", "%" PRIu64, conf->max_file_size);
+    gf_proc_dump_write("head_size", "%" PRIu64, conf->head_size);
     gf_proc_dump_write("cache_timeout", "%d", conf->cache_timeout);
+    gf_proc_dump_write("cache_admission", "%s",
+                       conf->tinylfu ? "tinylfu" : "lru");
+    gf_proc_dump_write("cache_compression", "%s",
+                       conf->compression ? "on" : "off");
 
-    if (!table) {
-        goto out;
-    } else {
-        for (i = 0; i < conf->max_pri; i++) {
-            list_for_each_entry(curr, &table->lru[i], lru)
-            {
-                file_count++;
-                total_size += curr->size;
+    for (j = 0; j < QR_SHARD_COUNT; j++) {
+        table = &priv->table[j];
+        shard_files = 0;
+
+        LOCK(&table->lock);
+        {
+            for (i = 0; i < conf->max_pri; i++) {
+                list_for_each_entry(curr, &table->lru[i], lru)
+                {
+                    shard_files++;
+                }
             }
+
+            snprintf(key, sizeof(key), "shard[%u]", j);
+            gf_proc_dump_write(key,
+                               "files: %u, cache-used: %" PRIu64
+                               ", cache-data: %" PRIu64,
+                               shard_files, table->cache_used,
+                               table->cache_data);
+
+            total_size += table->cache_used;
+            total_data += table->cache_data;
         }
+        UNLOCK(&table->lock);
+
+        file_count += shard_files;
     }
 
     gf_proc_dump_write("total_files_cached", "%d", file_count);
     gf_proc_dump_write("total_cache_used", "%" PRIu64, total_size);
+    gf_proc_dump_write("total_cache_data", "%" PRIu64, total_data);
+    gf_proc_dump_write("compression-ratio", "%.2f",
+                       total_size ? (double)total_data / total_size : 1.0);
     gf_proc_dump_write("cache-hit", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(priv->qr_counter.cache_hit));
     gf_proc_dump_write("cache-miss", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(priv->qr_counter.cache_miss));
     gf_proc_dump_write("cache-invalidations", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
+    gf_proc_dump_write("cache-evictions", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->qr_counter.evictions));
+    gf_proc_dump_write("cache-admission-rejects", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->qr_counter.admission_rejects));
 
-out:
     return 0;
 }
 
@@ -1123,20 +1435,37 @@ qr_dump_metrics(xlator_t *this, int fd)
 {
     qr_private_t *priv = NULL;
     qr_inode_table_t *table = NULL;
+    uint64_t cache_used = 0;
+    uint64_t cache_data = 0;
+    int i = 0;
 
     priv = this->private;
-    table = &priv->table;
+
+    for (i = 0; i < QR_SHARD_COUNT; i++) {
+        table = &priv->table[i];
+
+        LOCK(&table->lock);
+        {
+            cache_used += table->cache_used;
+            cache_data += table->cache_data;
+        }
+        UNLOCK(&table->lock);
+    }
 
     dprintf(fd, "%s.total_files_cached %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.files_cached));
-    dprintf(fd, "%s.total_cache_used %" PRId64 "\n", this->name,
-            table->cache_used);
+    dprintf(fd, "%s.total_cache_used %" PRId64 "\n", this->name, cache_used);
+    dprintf(fd, "%s.total_cache_data %" PRId64 "\n", this->name, cache_data);
     dprintf(fd, "%s.cache-hit %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.cache_hit));
     dprintf(fd, "%s.cache-miss %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.cache_miss));
     dprintf(fd, "%s.cache-invalidations %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
+    dprintf(fd, "%s.cache-evictions %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->qr_counter.evictions));
+    dprintf(fd, "%s.cache-admission-rejects %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->qr_counter.admission_rejects));
 
     return 0;
 }
@@ -1204,6 +1533,7 @@ qr_reconfigure(xlator_t *this, dict_t *options)
     qr_private_t *priv = NULL;
     qr_conf_t *conf = NULL;
     uint64_t cache_size_new = 0;
+    char *admission = NULL;
 
     GF_VALIDATE_OR_GOTO("quick-read", this, out);
     GF_VALIDATE_OR_GOTO(this->name, this->private, out);
@@ -1218,12 +1548,20 @@ qr_reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("cache-timeout", conf->cache_timeout, options, int32, out);
 
+    GF_OPTION_RECONF("head-size", conf->head_size, options, size_uint64, out);
+
     GF_OPTION_RECONF("cache-invalidation", conf->qr_invalidation, options, bool,
                      out);
 
     GF_OPTION_RECONF("ctime-invalidation", conf->ctime_invalidation, options,
                      bool, out);
 
+    GF_OPTION_RECONF("cache-admission", admission, options, str, out);
+    conf->tinylfu = !strcmp(admission, "tinylfu");
+
+    GF_OPTION_RECONF("cache-compression", conf->compression, options, bool,
+                     out);
+
     GF_OPTION_RECONF("cache-size", cache_size_new, options, size_uint64, out);
     if (!check_cache_size_ok(this, cache_size_new)) {
         ret = -1;
@@ -1338,9 +1676,11 @@ out:
 int32_t
 qr_init(xlator_t *this)
 {
-    int32_t ret = -1, i = 0;
+    int32_t ret = -1, i = 0, j = 0;
     qr_private_t *priv = NULL;
     qr_conf_t *conf = NULL;
+    qr_inode_table_t *table = NULL;
+    char *admission = NULL;
 
     if (!this->children || this->children->next) {
         gf_msg(this->name, GF_LOG_ERROR, 0,
@@ -1362,11 +1702,14 @@ qr_init(xlator_t *this)
         goto out;
     }
 
-    LOCK_INIT(&priv->table.lock);
+    for (j = 0; j < QR_SHARD_COUNT; j++)
+        LOCK_INIT(&priv->table[j].lock);
     conf = &priv->conf;
 
     GF_OPTION_INIT("max-file-size", conf->max_file_size, size_uint64, out);
 
+    GF_OPTION_INIT("head-size", conf->head_size, size_uint64, out);
+
     GF_OPTION_INIT("cache-timeout", conf->cache_timeout, int32, out);
 
     GF_OPTION_INIT("cache-invalidation", conf->qr_invalidation, bool, out);
@@ -1379,6 +1722,11 @@ qr_init(xlator_t *this)
 
     GF_OPTION_INIT("ctime-invalidation", conf->ctime_invalidation, bool, out);
 
+    GF_OPTION_INIT("cache-admission", admission, str, out);
+    conf->tinylfu = !strcmp(admission, "tinylfu");
+
+    GF_OPTION_INIT("cache-compression", conf->compression, bool, out);
+
     INIT_LIST_HEAD(&conf->priority_list);
     conf->max_pri = 1;
     if (dict_get(this->options, "priority")) {
@@ -1393,15 +1741,26 @@ qr_init(xlator_t *this)
         conf->max_pri++;
     }
 
-    priv->table.lru = GF_CALLOC(conf->max_pri, sizeof(*priv->table.lru),
-                                gf_common_mt_list_head);
-    if (priv->table.lru == NULL) {
-        ret = -1;
-        goto out;
-    }
+    for (j = 0; j < QR_SHARD_COUNT; j++) {
+        table = &priv->table[j];
+
+        table->lru = GF_CALLOC(conf->max_pri, sizeof(*table->lru),
+                               gf_common_mt_list_head);
+        if (table->lru == NULL) {
+            ret = -1;
+            goto out;
+        }
+
+        for (i = 0; i < conf->max_pri; i++) {
+            INIT_LIST_HEAD(&table->lru[i]);
+        }
 
-    for (i = 0; i < conf->max_pri; i++) {
-        INIT_LIST_HEAD(&priv->table.lru[i]);
+        table->sketch = GF_CALLOC(QR_SKETCH_DEPTH * QR_SKETCH_WIDTH,
+                                  sizeof(*table->sketch), gf_qr_mt_qr_sketch_t);
+        if (table->sketch == NULL) {
+            ret = -1;
+            goto out;
+        }
     }
 
     ret = 0;
@@ -1411,6 +1770,11 @@ qr_init(xlator_t *this)
     this->private = priv;
 out:
     if ((ret == -1) && priv) {
+        for (j = 0; j < QR_SHARD_COUNT; j++) {
+            GF_FREE(priv->table[j].lru);
+            GF_FREE(priv->table[j].sketch);
+            LOCK_DESTROY(&priv->table[j].lock);
+        }
         GF_FREE(priv);
     }
 
@@ -1421,21 +1785,29 @@ void
 qr_inode_table_destroy(qr_private_t *priv)
 {
     int i = 0;
+    int j = 0;
     qr_conf_t *conf = NULL;
+    qr_inode_table_t *table = NULL;
 
     conf = &priv->conf;
 
-    for (i = 0; i < conf->max_pri; i++) {
-        /* There is a known leak of inodes, hence until
-         * that is fixed, log the assert as warning.
-        GF_ASSERT (list_empty (&priv->table.lru[i]));*/
-        if (!list_empty(&priv->table.lru[i])) {
-            gf_msg("quick-read", GF_LOG_INFO, 0, QUICK_READ_MSG_LRU_NOT_EMPTY,
-                   "quick read inode table lru not empty");
+    for (j = 0; j < QR_SHARD_COUNT; j++) {
+        table = &priv->table[j];
+
+        for (i = 0; i < conf->max_pri; i++) {
+            /* There is a known leak of inodes, hence until
+             * that is fixed, log the assert as warning.
+            GF_ASSERT (list_empty (&table->lru[i]));*/
+            if (!list_empty(&table->lru[i])) {
+                gf_msg("quick-read", GF_LOG_INFO, 0,
+                       QUICK_READ_MSG_LRU_NOT_EMPTY,
+                       "quick read inode table lru not empty");
+            }
         }
-    }
 
-    LOCK_DESTROY(&priv->table.lock);
+        GF_FREE(table->sketch);
+        LOCK_DESTROY(&table->lock);
+    }
 
     return;
 }
@@ -1614,6 +1986,21 @@ struct volume_options qr_options[] = {
         .op_version = {1},
         .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
     },
+    {
+        .key = {"head-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 1 * GF_UNIT_KB * 1000,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "For files larger than max-file-size, fetch and cache "
+                       "this many bytes from the start of the file along with "
+                       "the lookup. Reads that fall entirely within the head "
+                       "are then served without an open or a read going to "
+                       "the bricks. Should be at least the read size of the "
+                       "application (128KB for FUSE). 0 disables it.",
+    },
     {
         .key = {"cache-invalidation"},
         .type = GF_OPTION_TYPE_BOOL,
@@ -1643,6 +2030,31 @@ struct volume_options qr_options[] = {
                        "changes to file data. So, use this only when mtime "
                        "is not reliable",
     },
+    {
+        .key = {"cache-admission"},
+        .type = GF_OPTION_TYPE_STR,
+        .value = {"lru", "tinylfu"},
+        .default_value = "lru",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "With \"lru\", every file read from the bricks is "
+                       "cached, evicting the least recently used ones. With "
+                       "\"tinylfu\", once the cache is full a file is only "
+                       "cached if it was accessed more often of late than "
+                       "the file it would evict, so that scans of many "
+                       "files read once do not flush the ones read often.",
+    },
+    {
+        .key = {"cache-compression"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Compress the cached files (zlib, fastest level) "
+                       "so that more of them fit in cache-size. Files that "
+                       "do not shrink by at least an eighth are kept as "
+                       "they are. Costs CPU on every cache fill and hit.",
+    },
     {.key = {NULL}}};
 
 xlator_api_t xlator_api = {
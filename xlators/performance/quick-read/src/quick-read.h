@@ -29,9 +29,30 @@
 #include <fnmatch.h>
 #include "quick-read-mem-types.h"
 
+/* The cache is split in shards, each with its own lock, LRU lists and
+ * share of cache-size. An inode always maps to the same shard.
+ */
+#define QR_SHARD_COUNT 16
+
+/* TinyLFU frequency sketch of a shard: QR_SKETCH_DEPTH rows of
+ * QR_SKETCH_WIDTH counters, saturating at QR_SKETCH_MAX. All the counters
+ * are halved every QR_SKETCH_SAMPLES accesses so that old popularity
+ * fades away.
+ */
+#define QR_SKETCH_DEPTH 4
+#define QR_SKETCH_WIDTH 2048
+#define QR_SKETCH_MAX 15
+#define QR_SKETCH_SAMPLES (QR_SKETCH_WIDTH * 8)
+
+/* bodies smaller than this are not worth compressing */
+#define QR_COMPRESS_MIN_SIZE 512
+
 struct qr_inode {
     void *data;
-    size_t size;
+    size_t size;   /* bytes of the file cached */
+    size_t stored; /* bytes held in data, less than size if compressed */
+    uint64_t key;  /* hash of the inode, for the shard and the sketch */
+    uint32_t shard;
     int priority;
     uint32_t ia_mtime;
     uint32_t ia_mtime_nsec;
@@ -55,9 +76,12 @@ typedef struct qr_priority qr_priority_t;
 
 struct qr_conf {
     uint64_t max_file_size;
+    uint64_t head_size;
     int32_t cache_timeout;
     uint64_t cache_size;
     int max_pri;
+    gf_boolean_t tinylfu;
+    gf_boolean_t compression;
     gf_boolean_t qr_invalidation;
     gf_boolean_t ctime_invalidation;
     struct list_head priority_list;
@@ -65,8 +89,11 @@ struct qr_conf {
 typedef struct qr_conf qr_conf_t;
 
 struct qr_inode_table {
-    uint64_t cache_used;
+    uint64_t cache_used; /* bytes held, compressed or not */
+    uint64_t cache_data; /* bytes of files those stand for */
     struct list_head *lru;
+    uint8_t *sketch;
+    uint32_t samples;
     gf_lock_t lock;
 };
 typedef struct qr_inode_table qr_inode_table_t;
@@ -76,11 +103,13 @@ struct qr_statistics {
     gf_atomic_t cache_miss;
     gf_atomic_t file_data_invals; /* No. of invalidates received from upcall */
     gf_atomic_t files_cached;
+    gf_atomic_t evictions;
+    gf_atomic_t admission_rejects;
 };
 
 struct qr_private {
     qr_conf_t conf;
-    qr_inode_table_t table;
+    qr_inode_table_t table[QR_SHARD_COUNT];
     time_t last_child_down;
     gf_lock_t lock;
     struct qr_statistics qr_counter;
@@ -16,6 +16,12 @@
 #include <assert.h>
 #include "read-ahead-messages.h"
 
+static inline uint32_t
+ra_page_hash(ra_file_t *file, off_t rounded_offset)
+{
+    return (rounded_offset / file->page_size) % RA_PAGE_HASH_SIZE;
+}
+
 ra_page_t *
 ra_page_get(ra_file_t *file, off_t offset)
 {
@@ -24,14 +30,11 @@ ra_page_get(ra_file_t *file, off_t offset)
 
     GF_VALIDATE_OR_GOTO("read-ahead", file, out);
 
-    page = file->pages.next;
     rounded_offset = gf_floor(offset, file->page_size);
 
-    while (page != &file->pages && page->offset < rounded_offset)
-        page = page->next;
-
-    if (page == &file->pages || page->offset != rounded_offset)
-        page = NULL;
+    page = file->page_hash[ra_page_hash(file, rounded_offset)];
+    while (page && page->offset != rounded_offset)
+        page = page->hash_next;
 
 out:
     return page;
@@ -43,31 +46,47 @@ ra_page_create(ra_file_t *file, off_t offset)
     ra_page_t *page = NULL;
     off_t rounded_offset = 0;
     ra_page_t *newpage = NULL;
+    uint32_t bucket = 0;
 
     GF_VALIDATE_OR_GOTO("read-ahead", file, out);
 
-    page = file->pages.next;
     rounded_offset = gf_floor(offset, file->page_size);
 
-    while (page != &file->pages && page->offset < rounded_offset)
-        page = page->next;
-
-    if (page == &file->pages || page->offset != rounded_offset) {
-        newpage = GF_CALLOC(1, sizeof(*newpage), gf_ra_mt_ra_page_t);
-        if (!newpage) {
-            goto out;
-        }
+    page = ra_page_get(file, rounded_offset);
+    if (page)
+        goto out;
 
-        newpage->offset = rounded_offset;
-        newpage->prev = page->prev;
-        newpage->next = page;
-        newpage->file = file;
-        page->prev->next = newpage;
-        page->prev = newpage;
+    newpage = GF_CALLOC(1, sizeof(*newpage), gf_ra_mt_ra_page_t);
+    if (!newpage) {
+        goto out;
+    }
 
-        page = newpage;
+    /* the new page goes after the page before it in the file. Readers
+     * being sequential, it is usually the previous page, or the last. */
+    page = NULL;
+    if (rounded_offset >= file->page_size)
+        page = ra_page_get(file, rounded_offset - file->page_size);
+    if (!page) {
+        page = file->pages.prev;
+        while (page != &file->pages && page->offset > rounded_offset)
+            page = page->prev;
     }
 
+    newpage->offset = rounded_offset;
+    newpage->file = file;
+    newpage->stream = -1;
+    newpage->next = page->next;
+    newpage->prev = page;
+    page->next->prev = newpage;
+    page->next = newpage;
+
+    bucket = ra_page_hash(file, rounded_offset);
+    newpage->hash_next = file->page_hash[bucket];
+    file->page_hash[bucket] = newpage;
+
+    GF_ATOMIC_ADD(file->conf->cached, file->page_size);
+
+    page = newpage;
 out:
     return page;
 }
@@ -517,11 +536,24 @@ out:
 void
 ra_page_purge(ra_page_t *page)
 {
+    ra_file_t *file = NULL;
+    ra_page_t **trav = NULL;
+
     GF_VALIDATE_OR_GOTO("read-ahead", page, out);
 
+    file = page->file;
+
     page->prev->next = page->next;
     page->next->prev = page->prev;
 
+    trav = &file->page_hash[ra_page_hash(file, page->offset)];
+    while (*trav && *trav != page)
+        trav = &(*trav)->hash_next;
+    if (*trav)
+        *trav = page->hash_next;
+
+    GF_ATOMIC_SUB(file->conf->cached, file->page_size);
+
     if (page->iobref) {
         iobref_unref(page->iobref);
     }
@@ -533,6 +565,38 @@ out:
     return;
 }
 
+/*
+ * ra_page_discard - drop a page, which nobody waits on
+ * @page:
+ * @shrink: the page is not needed by its stream anymore
+ *
+ * A page read ahead and never read was read ahead too far: the window of
+ * its stream is halved when @shrink is set.
+ */
+void
+ra_page_discard(ra_page_t *page, gf_boolean_t shrink)
+{
+    ra_file_t *file = NULL;
+    ra_stream_t *stream = NULL;
+
+    GF_VALIDATE_OR_GOTO("read-ahead", page, out);
+
+    file = page->file;
+
+    if (page->dirty && page->ready) {
+        GF_ATOMIC_INC(file->conf->wasted);
+        if (shrink && (page->stream >= 0)) {
+            stream = &file->streams[page->stream];
+            stream->page_count /= 2;
+        }
+    }
+
+    ra_page_purge(page);
+
+out:
+    return;
+}
+
 /*
  * ra_page_error -
  * @page:
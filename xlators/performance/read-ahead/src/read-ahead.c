@@ -26,7 +26,7 @@
 #include "read-ahead-messages.h"
 
 static void
-read_ahead(call_frame_t *frame, ra_file_t *file);
+read_ahead(call_frame_t *frame, ra_file_t *file, int s, off_t offset);
 
 int
 ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
@@ -57,7 +57,6 @@ ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
         file->disabled = 1;
 
-    file->offset = (unsigned long long)0;
     file->conf = conf;
     file->pages.next = &file->pages;
     file->pages.prev = &file->pages;
@@ -74,14 +73,10 @@ ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     ra_conf_unlock(conf);
 
     file->fd = fd;
-    file->page_count = conf->page_count;
     file->page_size = conf->page_size;
+    file->stream_count = conf->stream_count;
     pthread_mutex_init(&file->file_lock, NULL);
 
-    if (!file->disabled) {
-        file->page_count = 1;
-    }
-
     ret = fd_ctx_set(fd, this, (uint64_t)(long)file);
     if (ret == -1) {
         gf_msg(frame->this->name, GF_LOG_WARNING, 0, READ_AHEAD_MSG_NO_MEMORY,
@@ -131,7 +126,6 @@ ra_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
         file->disabled = 1;
 
-    file->offset = (unsigned long long)0;
     // file->size = fd->inode->buf.ia_size;
     file->conf = conf;
     file->pages.next = &file->pages;
@@ -149,8 +143,8 @@ ra_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     ra_conf_unlock(conf);
 
     file->fd = fd;
-    file->page_count = conf->page_count;
     file->page_size = conf->page_size;
+    file->stream_count = conf->stream_count;
     pthread_mutex_init(&file->file_lock, NULL);
 
     ret = fd_ctx_set(fd, this, (uint64_t)(long)file);
@@ -216,7 +210,7 @@ flush_region(call_frame_t *frame, ra_file_t *file, off_t offset, off_t size,
             next = trav->next;
             if (trav->offset >= offset) {
                 if (!trav->waitq) {
-                    ra_page_purge(trav);
+                    ra_page_discard(trav, _gf_false);
                 } else {
                     trav->stale = 1;
 
@@ -231,6 +225,75 @@ flush_region(call_frame_t *frame, ra_file_t *file, off_t offset, off_t size,
     ra_file_unlock(file);
 }
 
+/* free the pages of a stream, or the ones behind @offset */
+static void
+__flush_stream(ra_file_t *file, int s, off_t offset)
+{
+    ra_page_t *trav = NULL;
+    ra_page_t *next = NULL;
+
+    trav = file->pages.next;
+    while (trav != &file->pages) {
+        next = trav->next;
+        if (offset >= 0 && trav->offset >= offset)
+            break;
+        if (trav->stream == s) {
+            if (!trav->waitq)
+                ra_page_discard(trav, offset >= 0);
+            else
+                trav->stale = 1;
+        }
+        trav = next;
+    }
+}
+
+static void
+__ra_streams_reset(ra_file_t *file)
+{
+    memset(file->streams, 0, sizeof(file->streams));
+    file->stream_count = file->conf->stream_count;
+}
+
+/*
+ * The stream a read at @offset continues, or a new one in place of the
+ * least recently used stream. Streams which never read sequentially go
+ * first, so that random reads do not evict the sequential streams.
+ */
+static int
+__ra_stream_get(ra_file_t *file, off_t offset, gf_boolean_t *sequential)
+{
+    ra_stream_t *stream = NULL;
+    uint32_t i = 0;
+    int lru = -1;
+    int lru_cold = -1;
+
+    *sequential = _gf_false;
+
+    for (i = 0; i < file->stream_count; i++) {
+        stream = &file->streams[i];
+        if (stream->last_used && stream->offset == offset) {
+            *sequential = _gf_true;
+            return i;
+        }
+
+        if (lru < 0 || stream->last_used < file->streams[lru].last_used)
+            lru = i;
+        if (!stream->expected &&
+            (lru_cold < 0 ||
+             stream->last_used < file->streams[lru_cold].last_used))
+            lru_cold = i;
+    }
+
+    if (lru_cold >= 0)
+        lru = lru_cold;
+
+    if (file->streams[lru].last_used)
+        __flush_stream(file, lru, -1);
+
+    memset(&file->streams[lru], 0, sizeof(file->streams[lru]));
+    return lru;
+}
+
 int
 ra_release(xlator_t *this, fd_t *fd)
 {
@@ -251,27 +314,38 @@ out:
 }
 
 void
-read_ahead(call_frame_t *frame, ra_file_t *file)
+read_ahead(call_frame_t *frame, ra_file_t *file, int s, off_t offset)
 {
+    ra_conf_t *conf = NULL;
     off_t ra_offset = 0;
     size_t ra_size = 0;
     off_t trav_offset = 0;
     ra_page_t *trav = NULL;
     off_t cap = 0;
+    uint32_t page_count = 0;
+    int64_t cached = 0;
     char fault = 0;
 
     GF_VALIDATE_OR_GOTO("read-ahead", frame, out);
     GF_VALIDATE_OR_GOTO(frame->this->name, file, out);
 
-    if (!file->page_count) {
+    conf = file->conf;
+
+    ra_file_lock(file);
+    {
+        page_count = min(file->streams[s].page_count, conf->page_count);
+    }
+    ra_file_unlock(file);
+
+    if (!page_count) {
         goto out;
     }
 
-    ra_size = file->page_size * file->page_count;
-    ra_offset = gf_floor(file->offset, file->page_size);
-    cap = file->size ? file->size : file->offset + ra_size;
+    ra_size = file->page_size * page_count;
+    ra_offset = gf_floor(offset, file->page_size);
+    cap = file->size ? file->size : offset + ra_size;
 
-    while (ra_offset < min(file->offset + ra_size, cap)) {
+    while (ra_offset < min(offset + ra_size, cap)) {
         ra_file_lock(file);
         {
             trav = ra_page_get(file, ra_offset);
@@ -293,6 +367,19 @@ read_ahead(call_frame_t *frame, ra_file_t *file)
 
     cap = file->size ? file->size : ra_offset + ra_size;
 
+    /* the pages of all the files fit in cache-size */
+    if (conf->cache_size) {
+        cached = GF_ATOMIC_GET(conf->cached);
+        if (cached + file->page_size > conf->cache_size) {
+            GF_ATOMIC_INC(conf->throttled);
+            goto out;
+        }
+        if (cached + ra_size > conf->cache_size) {
+            GF_ATOMIC_INC(conf->throttled);
+            ra_size = gf_floor(conf->cache_size - cached, file->page_size);
+        }
+    }
+
     while (trav_offset < min(ra_offset + ra_size, cap)) {
         fault = 0;
         ra_file_lock(file);
@@ -301,8 +388,10 @@ read_ahead(call_frame_t *frame, ra_file_t *file)
             if (!trav) {
                 fault = 1;
                 trav = ra_page_create(file, trav_offset);
-                if (trav)
+                if (trav) {
                     trav->dirty = 1;
+                    trav->stream = s;
+                }
             }
         }
         ra_file_unlock(file);
@@ -335,8 +424,8 @@ ra_need_atime_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     return 0;
 }
 
-static void
-dispatch_requests(call_frame_t *frame, ra_file_t *file)
+static gf_boolean_t
+dispatch_requests(call_frame_t *frame, ra_file_t *file, int s)
 {
     ra_local_t *local = NULL;
     ra_conf_t *conf = NULL;
@@ -347,6 +436,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
     call_frame_t *ra_frame = NULL;
     char need_atime_update = 1;
     char fault = 0;
+    gf_boolean_t waited = _gf_false;
 
     GF_VALIDATE_OR_GOTO("read-ahead", frame, out);
     GF_VALIDATE_OR_GOTO(frame->this->name, file, out);
@@ -375,11 +465,12 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
                 fault = 1;
                 need_atime_update = 0;
             }
-            trav->dirty = 0;
+            trav->stream = s;
 
             if (trav->ready) {
                 gf_msg_trace(frame->this->name, 0, "HIT at offset=%" PRId64 ".",
                              trav_offset);
+                GF_ATOMIC_INC(conf->hits);
                 ra_frame_fill(trav, frame);
             } else {
                 gf_msg_trace(frame->this->name, 0,
@@ -388,7 +479,11 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
                              trav_offset);
                 ra_wait_on_page(trav, frame);
                 need_atime_update = 0;
+                /* read ahead, but not far enough ahead */
+                if (trav->dirty)
+                    waited = _gf_true;
             }
+            trav->dirty = 0;
         }
     unlock:
         ra_file_unlock(file);
@@ -400,6 +495,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
         if (fault) {
             gf_msg_trace(frame->this->name, 0, "MISS at offset=%" PRId64 ".",
                          trav_offset);
+            GF_ATOMIC_INC(conf->faults);
             ra_page_fault(file, frame, trav_offset);
         }
 
@@ -420,7 +516,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
     }
 
 out:
-    return;
+    return waited;
 }
 
 int
@@ -444,9 +540,13 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     ra_file_t *file = NULL;
     ra_local_t *local = NULL;
     ra_conf_t *conf = NULL;
+    ra_stream_t *stream = NULL;
     int op_errno = EINVAL;
-    char expected_offset = 1;
+    gf_boolean_t sequential = _gf_false;
+    gf_boolean_t waited = _gf_false;
     uint64_t tmp_file = 0;
+    uint32_t grow = 0;
+    int s = 0;
 
     GF_ASSERT(frame);
     GF_VALIDATE_OR_GOTO(frame->this->name, this, unwind);
@@ -465,29 +565,35 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto disabled;
     }
 
-    if (file->offset != offset) {
-        gf_msg_trace(this->name, 0,
-                     "unexpected offset (%" PRId64 " != %" PRId64
-                     ") "
-                     "resetting",
-                     file->offset, offset);
-
-        expected_offset = file->expected = file->page_count = 0;
-    } else {
-        gf_msg_trace(this->name, 0,
-                     "expected offset (%" PRId64 ") when page_count=%d", offset,
-                     file->page_count);
-
-        if (file->expected < (file->page_size * conf->page_count)) {
-            file->expected += size;
-            file->page_count = min((file->expected / file->page_size),
-                                   conf->page_count);
+    ra_file_lock(file);
+    {
+        s = __ra_stream_get(file, offset, &sequential);
+        stream = &file->streams[s];
+
+        if (!sequential) {
+            gf_msg_trace(this->name, 0,
+                         "unexpected offset (%" PRId64
+                         "), new stream %d",
+                         offset, s);
+        } else {
+            /* the window grows by what the stream reads, up to
+             * page-count pages */
+            stream->expected += size;
+            grow = max(size / file->page_size, 1);
+            stream->page_count = min(stream->page_count + grow,
+                                     conf->page_count);
+
+            gf_msg_trace(this->name, 0,
+                         "expected offset (%" PRId64
+                         ") of stream %d when page_count=%d",
+                         offset, s, stream->page_count);
         }
-    }
 
-    if (!expected_offset) {
-        flush_region(frame, file, 0, file->pages.prev->offset + 1, 0);
+        stream->offset = offset + size;
+        stream->last_used = ++file->tick;
+        stream->reads++;
     }
+    ra_file_unlock(file);
 
     local = mem_get0(this->local_pool);
     if (!local) {
@@ -507,16 +613,27 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     frame->local = local;
 
-    dispatch_requests(frame, file);
+    waited = dispatch_requests(frame, file, s);
 
-    flush_region(frame, file, 0, gf_floor(offset, file->page_size), 0);
+    ra_file_lock(file);
+    {
+        __flush_stream(file, s, gf_floor(offset, file->page_size));
+
+        /* pages read ahead were still being read: the window does not
+         * cover the latency of the reads, double it */
+        if (waited && sequential) {
+            stream->waits++;
+            stream->page_count = min(stream->page_count * 2,
+                                     conf->page_count);
+        }
+    }
+    ra_file_unlock(file);
 
-    read_ahead(frame, file);
+    if (sequential)
+        read_ahead(frame, file, s, offset);
 
     ra_frame_return(frame);
 
-    file->offset = offset + size;
-
     return 0;
 
 unwind:
@@ -641,8 +758,10 @@ ra_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
 
             flush_region(frame, file, 0, file->pages.prev->offset + 1, 1);
 
-            /* reset the read-ahead counters too */
-            file->expected = file->page_count = 0;
+            /* reset the read-ahead streams too */
+            ra_file_lock(file);
+            __ra_streams_reset(file);
+            ra_file_unlock(file);
         }
     }
     UNLOCK(&inode->lock);
@@ -767,12 +886,16 @@ ra_fdctx_dump(xlator_t *this, fd_t *fd)
 {
     ra_file_t *file = NULL;
     ra_page_t *page = NULL;
+    ra_stream_t *stream = NULL;
     int32_t ret = 0, i = 0;
     uint64_t tmp_file = 0;
     char *path = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN] = {
         0,
     };
+    char key[GF_DUMP_MAX_BUF_LEN] = {
+        0,
+    };
 
     fd_ctx_get(fd, this, &tmp_file);
     file = (ra_file_t *)(long)tmp_file;
@@ -803,10 +926,19 @@ ra_fdctx_dump(xlator_t *this, fd_t *fd)
 
     gf_proc_dump_write("page-size", "%" PRId64, file->page_size);
 
-    gf_proc_dump_write("page-count", "%u", file->page_count);
-
-    gf_proc_dump_write("next-expected-offset-for-sequential-reads", "%" PRId64,
-                       file->offset);
+    for (i = 0; i < file->stream_count; i++) {
+        stream = &file->streams[i];
+        if (!stream->last_used)
+            continue;
+
+        gf_proc_dump_build_key(key, "stream", "%d", i);
+        gf_proc_dump_write(key,
+                           "offset=%" PRId64 ", page-count=%u, reads=%" PRIu64
+                           ", waits=%" PRIu64,
+                           stream->offset, stream->page_count, stream->reads,
+                           stream->waits);
+    }
+    i = 0;
 
     for (page = file->pages.next; page != &file->pages; page = page->next) {
         gf_proc_dump_write("page", "%d: %p", i++, (void *)page);
@@ -1045,6 +1177,16 @@ ra_priv_dump(xlator_t *this)
     {
         gf_proc_dump_write("page_size", "%" PRIu64, conf->page_size);
         gf_proc_dump_write("page_count", "%d", conf->page_count);
+        gf_proc_dump_write("stream_count", "%u", conf->stream_count);
+        gf_proc_dump_write("cache_size", "%" PRIu64, conf->cache_size);
+        gf_proc_dump_write("cached", "%" PRId64, GF_ATOMIC_GET(conf->cached));
+        gf_proc_dump_write("wasted_pages", "%" PRId64,
+                           GF_ATOMIC_GET(conf->wasted));
+        gf_proc_dump_write("throttled", "%" PRId64,
+                           GF_ATOMIC_GET(conf->throttled));
+        gf_proc_dump_write("page_hits", "%" PRId64, GF_ATOMIC_GET(conf->hits));
+        gf_proc_dump_write("page_faults", "%" PRId64,
+                           GF_ATOMIC_GET(conf->faults));
         gf_proc_dump_write("force_atime_update", "%d",
                            conf->force_atime_update);
     }
@@ -1098,6 +1240,10 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("page-size", conf->page_size, options, size_uint64, out);
 
+    GF_OPTION_RECONF("stream-count", conf->stream_count, options, uint32, out);
+
+    GF_OPTION_RECONF("cache-size", conf->cache_size, options, size_uint64, out);
+
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
 
     ret = 0;
@@ -1137,6 +1283,16 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("page-count", conf->page_count, uint32, out);
 
+    GF_OPTION_INIT("stream-count", conf->stream_count, uint32, out);
+
+    GF_OPTION_INIT("cache-size", conf->cache_size, size_uint64, out);
+
+    GF_ATOMIC_INIT(conf->cached, 0);
+    GF_ATOMIC_INIT(conf->wasted, 0);
+    GF_ATOMIC_INIT(conf->throttled, 0);
+    GF_ATOMIC_INIT(conf->hits, 0);
+    GF_ATOMIC_INIT(conf->faults, 0);
+
     GF_OPTION_INIT("force-atime-update", conf->force_atime_update, bool, out);
 
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
@@ -1252,6 +1408,28 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"read-ahead"},
      .description = "Page size with which read-ahead performs server I/O"},
+    {.key = {"stream-count"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = RA_MAX_STREAMS,
+     .default_value = "4",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+     .tags = {"read-ahead"},
+     .description = "Number of sequential streams tracked on an fd. Each "
+                    "stream gets up to page-count pages read ahead of it. "
+                    "Applies to files opened after it is changed."},
+    {.key = {"cache-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = 32 * GF_UNIT_GB,
+     .default_value = "256MB",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+     .tags = {"read-ahead"},
+     .description = "Memory the pages of all the files can take at most. "
+                    "Read-ahead is cut short beyond it. 0 does not limit "
+                    "it."},
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
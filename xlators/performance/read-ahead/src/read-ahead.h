@@ -18,6 +18,12 @@
 #include <glusterfs/common-utils.h>
 #include "read-ahead-mem-types.h"
 
+/* sequential streams tracked per fd, at most */
+#define RA_MAX_STREAMS 16
+
+/* buckets of the per fd index of pages by offset */
+#define RA_PAGE_HASH_SIZE 64
+
 struct ra_conf;
 struct ra_local;
 struct ra_page;
@@ -56,7 +62,9 @@ struct ra_local {
 struct ra_page {
     struct ra_page *next;
     struct ra_page *prev;
+    struct ra_page *hash_next;
     struct ra_file *file;
+    int stream;    /* stream the page was read for */
     char dirty;    /* Internal request, not from user. */
     char poisoned; /* Pending read invalidated by write. */
     char ready;
@@ -69,26 +77,49 @@ struct ra_page {
     char stale;
 };
 
+/*
+ * A sequential reader of the fd. Its window, the pages read ahead of it,
+ * grows as it keeps reading sequentially, doubles when it had to wait for
+ * pages still being read ahead, and is halved when pages read ahead for it
+ * are thrown away unread.
+ */
+struct ra_stream {
+    off_t offset;        /* next offset expected from the stream */
+    size_t expected;     /* bytes read sequentially so far */
+    uint32_t page_count; /* window */
+    uint64_t last_used;  /* ra_file.tick of the last read */
+    uint64_t reads;
+    uint64_t waits; /* reads that waited for pages read ahead */
+};
+
 struct ra_file {
     struct ra_file *next;
     struct ra_file *prev;
     struct ra_conf *conf;
     fd_t *fd;
     int disabled;
-    size_t expected;
-    struct ra_page pages;
-    off_t offset;
+    struct ra_page pages; /* sorted by offset */
+    struct ra_page *page_hash[RA_PAGE_HASH_SIZE];
     size_t size;
     int32_t refcount;
     pthread_mutex_t file_lock;
     struct iatt stbuf;
     uint64_t page_size;
-    uint32_t page_count;
+    struct ra_stream streams[RA_MAX_STREAMS];
+    uint32_t stream_count;
+    uint64_t tick;
 };
 
 struct ra_conf {
     uint64_t page_size;
-    uint32_t page_count;
+    uint32_t page_count; /* largest window of a stream */
+    uint32_t stream_count;
+    uint64_t cache_size; /* all the pages of all the files, at most */
+    gf_atomic_t cached;
+    gf_atomic_t wasted;    /* pages read ahead and thrown away unread */
+    gf_atomic_t throttled; /* read-aheads cut short by cache-size */
+    gf_atomic_t hits;      /* pages read found ready */
+    gf_atomic_t faults;    /* pages read neither ready nor in transit */
     void *cache_block;
     struct ra_file files;
     gf_boolean_t force_atime_update;
@@ -101,6 +132,7 @@ typedef struct ra_page ra_page_t;
 typedef struct ra_file ra_file_t;
 typedef struct ra_waitq ra_waitq_t;
 typedef struct ra_fill ra_fill_t;
+typedef struct ra_stream ra_stream_t;
 
 ra_page_t *
 ra_page_get(ra_file_t *file, off_t offset);
@@ -124,6 +156,9 @@ ra_page_error(ra_page_t *page, int32_t op_ret, int32_t op_errno);
 void
 ra_page_purge(ra_page_t *page);
 
+void
+ra_page_discard(ra_page_t *page, gf_boolean_t shrink);
+
 void
 ra_frame_return(call_frame_t *frame);
 
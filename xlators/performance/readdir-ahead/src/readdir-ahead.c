@@ -30,6 +30,8 @@
 #include "readdir-ahead.h"
 #include "readdir-ahead-mem-types.h"
 #include <glusterfs/defaults.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
 #include "readdir-ahead-messages.h"
 static int
 rda_fill_fd(call_frame_t *, xlator_t *, fd_t *);
@@ -298,6 +300,126 @@ out:
     return;
 }
 
+/*
+ * Remember that the iatt of an inode was just returned by a directory
+ * listing, along with the xattrs that came with it, so that the lookups and
+ * stats following the listing can be served from here.
+ */
+static void
+rda_inode_ctx_set_listing(inode_t *inode, xlator_t *this, dict_t *xattrs,
+                          dict_t *xattr_req, uint64_t listing, time_t now)
+{
+    rda_inode_ctx_t *ctx_p = NULL;
+    dict_t *old_xattrs = NULL;
+    dict_t *old_req = NULL;
+
+    LOCK(&inode->lock);
+    {
+        ctx_p = __rda_inode_ctx_get(inode, this);
+        if (!ctx_p || !ctx_p->statbuf.ia_ctime)
+            goto unlock;
+
+        old_xattrs = ctx_p->xattrs;
+        old_req = ctx_p->xattr_req;
+
+        ctx_p->xattrs = xattrs ? dict_ref(xattrs) : NULL;
+        ctx_p->xattr_req = xattr_req ? dict_ref(xattr_req) : NULL;
+        ctx_p->listed = now;
+        ctx_p->listing = listing;
+        ctx_p->listed_gen = GF_ATOMIC_GET(ctx_p->generation);
+    }
+unlock:
+    UNLOCK(&inode->lock);
+
+    if (old_xattrs)
+        dict_unref(old_xattrs);
+    if (old_req)
+        dict_unref(old_req);
+}
+
+static int
+rda_listing_key_covered(dict_t *xdata, char *key, data_t *value, void *data)
+{
+    dict_t *xattr_req = data;
+
+    /* quick-read asks for the content in every lookup of a file it
+     * hasn't cached, not getting it back only means it is not cached */
+    if (!strcmp(key, GF_CONTENT_KEY) || !strcmp(key, GF_CONTENT_HEAD_KEY) ||
+        !strcmp(key, "gfid-req"))
+        return 0;
+
+    if (xattr_req && dict_get(xattr_req, key))
+        return 0;
+
+    return -1;
+}
+
+/*
+ * Get the iatt (and xattrs, if rsp_xdata is given) of an inode, if they come
+ * from a listing recent enough and the inode was not modified or invalidated
+ * since. Everything requested in xdata must have been requested by the
+ * listing too.
+ */
+static gf_boolean_t
+rda_inode_ctx_get_listing(xlator_t *this, inode_t *inode, dict_t *xdata,
+                          struct iatt *stbuf, dict_t **rsp_xdata)
+{
+    struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *ctx_p = NULL;
+    uint64_t ctx_uint = 0;
+    uint64_t listing = 0;
+    gf_boolean_t found = _gf_false;
+
+    /* with parallel-readdir we are below dht, which needs to see lookups */
+    if (!priv->rda_listing_timeout || priv->parallel_readdir || !inode)
+        return _gf_false;
+
+    LOCK(&inode->lock);
+    {
+        if (__inode_ctx_get1(inode, this, &ctx_uint) || !ctx_uint)
+            goto unlock;
+
+        ctx_p = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
+        if (!ctx_p->listed || !ctx_p->statbuf.ia_ctime ||
+            IA_ISDIR(ctx_p->statbuf.ia_type))
+            goto unlock;
+
+        if ((time(NULL) >= ctx_p->listed + priv->rda_listing_timeout) ||
+            (ctx_p->listing <= GF_ATOMIC_GET(priv->rda_listing_floor)) ||
+            (ctx_p->listed_gen != GF_ATOMIC_GET(ctx_p->generation)))
+            goto unlock;
+
+        if (xdata && dict_foreach(xdata, rda_listing_key_covered,
+                                  ctx_p->xattr_req) < 0)
+            goto unlock;
+
+        if (rsp_xdata) {
+            if (ctx_p->xattrs)
+                *rsp_xdata = dict_copy_with_ref(ctx_p->xattrs, NULL);
+            else
+                *rsp_xdata = dict_new();
+            if (!*rsp_xdata)
+                goto unlock;
+        }
+
+        *stbuf = ctx_p->statbuf;
+        listing = ctx_p->listing;
+        found = _gf_true;
+    }
+unlock:
+    UNLOCK(&inode->lock);
+
+    if (!found)
+        return _gf_false;
+
+    if (rsp_xdata && dict_set_uint64(*rsp_xdata, GF_RDA_LISTING_KEY, listing))
+        gf_msg(this->name, GF_LOG_WARNING, 0, READDIR_AHEAD_MSG_DICT_OP_FAILED,
+               "failed to set %s", GF_RDA_LISTING_KEY);
+
+    GF_ATOMIC_INC(priv->rda_listing_hits);
+    return _gf_true;
+}
+
 /*
  * Serve a request from the fd dentry list based on the size of the request
  * buffer. ctx must be locked.
@@ -498,8 +620,15 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         0,
     };
     uint64_t generation = 0;
+    uint64_t listing = 0;
+    time_t now = 0;
     call_frame_t *fill_frame = NULL;
 
+    if (priv->rda_listing_timeout && entries && !list_empty(&entries->list)) {
+        listing = GF_ATOMIC_INC(priv->rda_listing_gen);
+        now = time(NULL);
+    }
+
     INIT_LIST_HEAD(&serve_entries.list);
     LOCK(&ctx->lock);
 
@@ -541,6 +670,11 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                     rda_inode_ctx_update_iatts(dirent->inode, this,
                                                &dirent->d_stat, &dirent->d_stat,
                                                generation);
+                    if (listing && (generation != 0) &&
+                        !IA_ISDIR(dirent->d_stat.ia_type))
+                        rda_inode_ctx_set_listing(dirent->inode, this,
+                                                  dirent->dict, ctx->xattrs,
+                                                  listing, now);
                 }
             }
 
@@ -623,6 +757,15 @@ out:
         STACK_DESTROY(fill_frame->root);
     }
 
+    /*
+     * Send the next request before handing the entries to the application,
+     * so that the bricks work on the next chunk of the directory while this
+     * one goes up the stack. frame and local must not be used past this
+     * point, the fill may complete (and be torn down) before we get back.
+     */
+    if (fill)
+        rda_fill_fd(frame, this, local->fd);
+
     if (serve) {
         STACK_UNWIND_STRICT(readdirp, stub->frame, ret, op_errno,
                             &serve_entries, xdata);
@@ -630,9 +773,6 @@ out:
         call_stub_destroy(stub);
     }
 
-    if (fill)
-        rda_fill_fd(frame, this, local->fd);
-
     return 0;
 }
 
@@ -1129,6 +1269,142 @@ rda_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
     return 0;
 }
 
+static int32_t
+rda_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    struct iatt stbuf = {
+        0,
+    };
+    struct iatt postparent = {
+        0,
+    };
+    dict_t *rsp_xdata = NULL;
+
+    if (!rda_inode_ctx_get_listing(this, loc->inode, xdata, &stbuf,
+                                   &rsp_xdata))
+        goto wind;
+
+    /* the parent was not looked up, md-cache leaves its cache alone when
+     * it finds GF_RDA_LISTING_KEY in the reply */
+    STACK_UNWIND_STRICT(lookup, frame, 0, 0, loc->inode, &stbuf, rsp_xdata,
+                        &postparent);
+    dict_unref(rsp_xdata);
+    return 0;
+
+wind:
+    STACK_WIND(frame, default_lookup_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lookup, loc, xdata);
+    return 0;
+}
+
+static int32_t
+rda_stat(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    struct iatt stbuf = {
+        0,
+    };
+
+    if (!rda_inode_ctx_get_listing(this, loc->inode, xdata, &stbuf, NULL))
+        goto wind;
+
+    STACK_UNWIND_STRICT(stat, frame, 0, 0, &stbuf, NULL);
+    return 0;
+
+wind:
+    STACK_WIND(frame, default_stat_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->stat, loc, xdata);
+    return 0;
+}
+
+/*
+ * Entry operations change the ctime (and link count) of the inode they act
+ * on, without returning its iatt. Drop what we have for it.
+ */
+static void
+rda_inode_invalidate(xlator_t *this, inode_t *inode)
+{
+    rda_mark_inode_dirty(this, inode);
+    rda_inode_ctx_update_iatts(inode, this, NULL, NULL, 0);
+}
+
+static int32_t
+rda_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret >= 0)
+        rda_inode_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(unlink, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int32_t
+rda_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+           dict_t *xdata)
+{
+    RDA_COMMON_MODIFICATION_FOP(unlink, frame, this, loc->inode, xdata, loc,
+                                xflag);
+    return 0;
+}
+
+static int32_t
+rda_link_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, inode_t *inode, struct iatt *buf,
+             struct iatt *preparent, struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret >= 0)
+        rda_inode_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(link, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+         dict_t *xdata)
+{
+    RDA_COMMON_MODIFICATION_FOP(link, frame, this, oldloc->inode, xdata,
+                                oldloc, newloc);
+    return 0;
+}
+
+static int32_t
+rda_rename_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *buf,
+               struct iatt *preoldparent, struct iatt *postoldparent,
+               struct iatt *prenewparent, struct iatt *postnewparent,
+               dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret >= 0)
+        rda_inode_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(rename, frame, op_ret, op_errno, buf, preoldparent,
+                     postoldparent, prenewparent, postnewparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+           dict_t *xdata)
+{
+    /* the inode being replaced, if any, loses a link */
+    if (newloc->inode)
+        rda_inode_invalidate(this, newloc->inode);
+
+    RDA_COMMON_MODIFICATION_FOP(rename, frame, this, oldloc->inode, xdata,
+                                oldloc, newloc);
+    return 0;
+}
+
 static int32_t
 rda_releasedir(xlator_t *this, fd_t *fd)
 {
@@ -1168,6 +1444,11 @@ rda_forget(xlator_t *this, inode_t *inode)
 
     ctx = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
 
+    if (ctx->xattrs)
+        dict_unref(ctx->xattrs);
+    if (ctx->xattr_req)
+        dict_unref(ctx->xattr_req);
+
     GF_FREE(ctx);
 
     return 0;
@@ -1192,6 +1473,73 @@ out:
     return ret;
 }
 
+static void
+rda_invalidate(xlator_t *this, struct gf_upcall *up_data)
+{
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+
+    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+        return;
+
+    itable = ((xlator_t *)this->graph->top)->itable;
+    inode = inode_find(itable, up_data->gfid);
+    if (!inode)
+        return;
+
+    rda_inode_invalidate(this, inode);
+    inode_unref(inode);
+}
+
+int
+rda_notify(xlator_t *this, int event, void *data, ...)
+{
+    struct rda_priv *priv = this->private;
+
+    switch (event) {
+        case GF_EVENT_CHILD_DOWN:
+        case GF_EVENT_SOME_DESCENDENT_DOWN:
+            /* a brick may miss changes while it is down, don't trust the
+             * listings done so far */
+            GF_ATOMIC_SWAP(priv->rda_listing_floor,
+                           GF_ATOMIC_GET(priv->rda_listing_gen));
+            break;
+        case GF_EVENT_UPCALL:
+            rda_invalidate(this, data);
+            break;
+        default:
+            break;
+    }
+
+    return default_notify(this, event, data);
+}
+
+static int
+rda_priv_dump(xlator_t *this)
+{
+    struct rda_priv *priv = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+    priv = this->private;
+    if (!priv)
+        return 0;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.readdir-ahead",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("rda_cache_size", "%" PRId64,
+                       GF_ATOMIC_GET(priv->rda_cache_size));
+    gf_proc_dump_write("rda_cache_limit", "%" PRIu64, priv->rda_cache_limit);
+    gf_proc_dump_write("rda_listing_timeout", "%u", priv->rda_listing_timeout);
+    gf_proc_dump_write("rda_listing_generation", "%" PRId64,
+                       GF_ATOMIC_GET(priv->rda_listing_gen));
+    gf_proc_dump_write("rda_listing_hits", "%" PRId64,
+                       GF_ATOMIC_GET(priv->rda_listing_hits));
+
+    return 0;
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
@@ -1207,6 +1555,8 @@ reconfigure(xlator_t *this, dict_t *options)
                      size_uint64, err);
     GF_OPTION_RECONF("parallel-readdir", priv->parallel_readdir, options, bool,
                      err);
+    GF_OPTION_RECONF("rda-listing-timeout", priv->rda_listing_timeout, options,
+                     uint32, err);
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, err);
 
     return 0;
@@ -1241,6 +1591,9 @@ init(xlator_t *this)
     this->private = priv;
 
     GF_ATOMIC_INIT(priv->rda_cache_size, 0);
+    GF_ATOMIC_INIT(priv->rda_listing_gen, 0);
+    GF_ATOMIC_INIT(priv->rda_listing_floor, 0);
+    GF_ATOMIC_INIT(priv->rda_listing_hits, 0);
 
     this->local_pool = mem_pool_new(struct rda_local, 32);
     if (!this->local_pool)
@@ -1251,6 +1604,8 @@ init(xlator_t *this)
     GF_OPTION_INIT("rda-high-wmark", priv->rda_high_wmark, size_uint64, err);
     GF_OPTION_INIT("rda-cache-limit", priv->rda_cache_limit, size_uint64, err);
     GF_OPTION_INIT("parallel-readdir", priv->parallel_readdir, bool, err);
+    GF_OPTION_INIT("rda-listing-timeout", priv->rda_listing_timeout, uint32,
+                   err);
     GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
 
     return 0;
@@ -1278,6 +1633,13 @@ out:
 struct xlator_fops fops = {
     .opendir = rda_opendir,
     .readdirp = rda_readdirp,
+    /* served from the listings */
+    .lookup = rda_lookup,
+    .stat = rda_stat,
+    /* entry */
+    .unlink = rda_unlink,
+    .link = rda_link,
+    .rename = rda_rename,
     /* inode write */
     /* TODO: invalidate a dentry's stats if its pointing to a directory
      * when entry operations happen in that directory
@@ -1302,6 +1664,10 @@ struct xlator_cbks cbks = {
     .forget = rda_forget,
 };
 
+struct xlator_dumpops dumpops = {
+    .priv = rda_priv_dump,
+};
+
 struct volume_options options[] = {
     {
         .key = {"readdir-ahead"},
@@ -1365,6 +1731,20 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"readdir-ahead"},
      .description = "Enable/Disable readdir ahead translator"},
+    {.key = {"rda-listing-timeout"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 600,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"readdir-ahead"},
+     .description = "Time in seconds for which the attributes and xattrs "
+                    "of the entries returned by a directory listing are "
+                    "used to answer lookups and stats of those entries. "
+                    "Entries modified from this client, or for which a "
+                    "cache invalidation is received, are looked up again. "
+                    "0 disables it"},
     {.key = {NULL}},
 };
 
@@ -1372,8 +1752,10 @@ xlator_api_t xlator_api = {
     .init = init,
     .fini = fini,
     .reconfigure = reconfigure,
+    .notify = rda_notify,
     .mem_acct_init = mem_acct_init,
     .op_version = {1}, /* Present from the initial version */
+    .dumpops = &dumpops,
     .fops = &fops,
     .cbks = &cbks,
     .options = options,
@@ -88,11 +88,21 @@ struct rda_priv {
     uint64_t rda_cache_limit;
     gf_atomic_t rda_cache_size;
     gf_boolean_t parallel_readdir;
+    uint32_t rda_listing_timeout;
+    gf_atomic_t rda_listing_gen;   /* bumped for every batch of entries */
+    gf_atomic_t rda_listing_floor; /* listings up to this one are stale */
+    gf_atomic_t rda_listing_hits;
 };
 
 typedef struct rda_inode_ctx {
     struct iatt statbuf;
     gf_atomic_t generation;
+    /* set when statbuf was filled in from a directory listing */
+    dict_t *xattrs;      /* xattrs returned with the entry */
+    dict_t *xattr_req;   /* keys the listing asked for */
+    time_t listed;       /* when the entry was listed */
+    uint64_t listing;    /* generation of the listing */
+    uint64_t listed_gen; /* inode generation at the time it was listed */
 } rda_inode_ctx_t;
 
 #endif /* __READDIR_AHEAD_H */
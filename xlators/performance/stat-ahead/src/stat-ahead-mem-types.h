@@ -0,0 +1,26 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __STAT_AHEAD_MEM_TYPES_H__
+#define __STAT_AHEAD_MEM_TYPES_H__
+
+#include <glusterfs/mem-types.h>
+
+enum gf_sa_mem_types_ {
+    gf_sa_mt_sa_private_t = gf_common_mt_end + 1,
+    gf_sa_mt_sa_inode_t,
+    gf_sa_mt_sa_listing_t,
+    gf_sa_mt_sa_fd_t,
+    gf_sa_mt_sa_local_t,
+    gf_sa_mt_sa_subdirs_t,
+    gf_sa_mt_end
+};
+
+#endif /* __STAT_AHEAD_MEM_TYPES_H__ */
@@ -0,0 +1,1738 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+/*
+ * stat-ahead: directory prefetch for tree walks
+ *
+ * Tree walkers (find, du, rsync, backup agents) read a directory, look up
+ * its entries, then open its subdirectories one after the other. When the
+ * application opens a subdirectory of a directory it has just read, the
+ * next subdirectories are opened and read ahead, a few at a time, through
+ * md-cache, which caches the attributes and xattrs of their entries. The
+ * complete listings are kept for a short while and serve the readdirps of
+ * the application when it gets to them.
+ */
+
+#include "stat-ahead.h"
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
+
+static void
+sa_prefetch(call_frame_t *frame, xlator_t *this, inode_t *parent);
+
+static sa_listing_t *
+sa_listing_ref(sa_listing_t *listing)
+{
+    GF_ATOMIC_INC(listing->refcount);
+    return listing;
+}
+
+static void
+sa_listing_unref(sa_listing_t *listing)
+{
+    if (listing == NULL)
+        return;
+
+    if (GF_ATOMIC_DEC(listing->refcount))
+        return;
+
+    gf_dirent_free(&listing->entries);
+    GF_FREE(listing);
+}
+
+static uint64_t
+sa_dirent_size(gf_dirent_t *entry)
+{
+    /* the xattrs md-cache asked for are only a guess */
+    return gf_dirent_size(entry->d_name) + (entry->dict ? 256 : 0);
+}
+
+static sa_inode_t *
+sa_inode_ctx(xlator_t *this, inode_t *inode)
+{
+    uint64_t value = 0;
+
+    if (inode_ctx_get(inode, this, &value))
+        return NULL;
+
+    return (sa_inode_t *)(uintptr_t)value;
+}
+
+static sa_inode_t *
+sa_inode_get(xlator_t *this, inode_t *inode)
+{
+    sa_inode_t *ctx = NULL;
+    uint64_t value = 0;
+
+    LOCK(&inode->lock);
+    {
+        __inode_ctx_get(inode, this, &value);
+        if (value) {
+            ctx = (sa_inode_t *)(uintptr_t)value;
+            goto unlock;
+        }
+
+        ctx = GF_CALLOC(1, sizeof(*ctx), gf_sa_mt_sa_inode_t);
+        if (ctx == NULL)
+            goto unlock;
+
+        INIT_LIST_HEAD(&ctx->lru);
+        ctx->inode = inode;
+        ctx->descended = -1;
+
+        value = (uint64_t)(uintptr_t)ctx;
+        if (__inode_ctx_set(inode, this, &value) < 0) {
+            GF_FREE(ctx);
+            ctx = NULL;
+        }
+    }
+unlock:
+    UNLOCK(&inode->lock);
+
+    return ctx;
+}
+
+/* returns the listing dropped, to be unref'd without priv->lock */
+static sa_listing_t *
+__sa_inode_drop(sa_private_t *priv, sa_inode_t *ctx)
+{
+    sa_listing_t *listing = ctx->listing;
+
+    ctx->gen++;
+
+    if (listing == NULL)
+        return NULL;
+
+    list_del_init(&ctx->lru);
+    priv->cache_used -= listing->size;
+    ctx->listing = NULL;
+
+    return listing;
+}
+
+static gf_boolean_t
+__sa_listing_fresh(sa_private_t *priv, sa_listing_t *listing)
+{
+    return (listing && (time(NULL) - listing->listed < priv->timeout));
+}
+
+static void
+sa_invalidate(xlator_t *this, inode_t *inode)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *ctx = NULL;
+    sa_listing_t *listing = NULL;
+
+    if (inode == NULL)
+        return;
+
+    ctx = sa_inode_ctx(this, inode);
+    if (ctx == NULL)
+        return;
+
+    /* unlocked peek: with neither a listing nor a prefetch running there
+     * is nothing to drop, and a prefetch starting now reads the change */
+    if ((ctx->listing == NULL) && !ctx->inflight)
+        return;
+
+    LOCK(&priv->lock);
+    {
+        listing = __sa_inode_drop(priv, ctx);
+    }
+    UNLOCK(&priv->lock);
+
+    if (listing) {
+        GF_ATOMIC_INC(priv->invalidated);
+        sa_listing_unref(listing);
+    }
+}
+
+static gf_boolean_t
+sa_idle(sa_private_t *priv)
+{
+    return (__atomic_load_n(&priv->inflight, __ATOMIC_ACQUIRE) == 0) &&
+           (__atomic_load_n(&priv->cache_used, __ATOMIC_ACQUIRE) == 0);
+}
+
+/* the attributes of @inode changed, and with them its entry in the listing
+ * of its parent */
+static void
+sa_invalidate_parent(xlator_t *this, inode_t *inode)
+{
+    inode_t *parent = NULL;
+
+    if (inode == NULL)
+        return;
+
+    /* writes come here, do not look up the parent when nothing at all is
+     * listed or being listed */
+    if (sa_idle(this->private))
+        return;
+
+    parent = inode_parent(inode, NULL, NULL);
+    if (parent) {
+        sa_invalidate(this, parent);
+        inode_unref(parent);
+    }
+}
+
+/* keeps the subdirectories of @dir in the order the application reads
+ * them, to know what it will open next */
+static void
+sa_record_subdirs(xlator_t *this, inode_t *dir, gf_boolean_t first,
+                  gf_dirent_t *entries)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *ctx = NULL;
+    gf_dirent_t *entry = NULL;
+    uuid_t *subdirs = NULL;
+    int32_t size = 0;
+
+    ctx = sa_inode_get(this, dir);
+    if (ctx == NULL)
+        return;
+
+    LOCK(&priv->lock);
+    {
+        if (first) {
+            ctx->subdir_count = 0;
+            ctx->descended = -1;
+            ctx->next = 0;
+        }
+        ctx->read = time(NULL);
+
+        list_for_each_entry(entry, &entries->list, list)
+        {
+            if ((entry->d_stat.ia_type != IA_IFDIR) ||
+                (strcmp(entry->d_name, ".") == 0) ||
+                (strcmp(entry->d_name, "..") == 0))
+                continue;
+
+            if (ctx->subdir_count == ctx->subdir_size) {
+                if (ctx->subdir_size >= SA_MAX_SUBDIRS)
+                    break;
+
+                size = ctx->subdir_size ? ctx->subdir_size * 2 : 64;
+                if (ctx->subdirs)
+                    subdirs = GF_REALLOC(ctx->subdirs, size * sizeof(uuid_t));
+                else
+                    subdirs = GF_CALLOC(size, sizeof(uuid_t),
+                                        gf_sa_mt_sa_subdirs_t);
+                if (subdirs == NULL)
+                    break;
+
+                ctx->subdirs = subdirs;
+                ctx->subdir_size = size;
+            }
+
+            gf_uuid_copy(ctx->subdirs[ctx->subdir_count++],
+                         entry->d_stat.ia_gfid);
+        }
+    }
+    UNLOCK(&priv->lock);
+}
+
+/* the application opens @inode, a subdirectory of @parent */
+static void
+sa_descend(call_frame_t *frame, xlator_t *this, inode_t *parent,
+           inode_t *inode)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *pctx = NULL;
+    int32_t found = -1;
+    int32_t i = 0;
+
+    pctx = sa_inode_ctx(this, parent);
+    if (pctx == NULL)
+        return;
+
+    LOCK(&priv->lock);
+    {
+        /* walkers go through the subdirectories in order */
+        for (i = pctx->descended + 1; i < pctx->subdir_count; i++) {
+            if (gf_uuid_compare(pctx->subdirs[i], inode->gfid) == 0) {
+                found = i;
+                break;
+            }
+        }
+
+        for (i = 0; (found < 0) && (i <= pctx->descended); i++) {
+            if (gf_uuid_compare(pctx->subdirs[i], inode->gfid) == 0)
+                found = i;
+        }
+
+        if (found >= 0) {
+            pctx->descended = found;
+            if (pctx->next <= found)
+                pctx->next = found + 1;
+            priv->walked = time(NULL);
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (found >= 0)
+        sa_prefetch(frame, this, parent);
+}
+
+static void
+sa_local_free(sa_local_t *local)
+{
+    if (local == NULL)
+        return;
+
+    if (local->fd)
+        fd_unref(local->fd);
+    if (local->inode)
+        inode_unref(local->inode);
+    if (local->parent)
+        inode_unref(local->parent);
+
+    gf_dirent_free(&local->entries);
+    GF_FREE(local);
+}
+
+static void
+sa_evict(xlator_t *this)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *ctx = NULL;
+    sa_listing_t *listing = NULL;
+
+    for (;;) {
+        listing = NULL;
+
+        LOCK(&priv->lock);
+        {
+            if ((priv->cache_used > priv->cache_size) &&
+                !list_empty(&priv->listings)) {
+                ctx = list_first_entry(&priv->listings, sa_inode_t, lru);
+                listing = ctx->listing;
+                list_del_init(&ctx->lru);
+                priv->cache_used -= listing->size;
+                ctx->listing = NULL;
+            }
+        }
+        UNLOCK(&priv->lock);
+
+        if (listing == NULL)
+            break;
+
+        GF_ATOMIC_INC(priv->evicted);
+        sa_listing_unref(listing);
+    }
+}
+
+static void
+sa_prefetch_done(call_frame_t *frame, xlator_t *this, gf_boolean_t complete)
+{
+    sa_private_t *priv = this->private;
+    sa_local_t *local = frame->local;
+    sa_inode_t *ctx = NULL;
+    sa_listing_t *listing = NULL;
+    sa_listing_t *old = NULL;
+
+    frame->local = NULL;
+
+    if (complete) {
+        GF_ATOMIC_INC(priv->prefetched);
+
+        if (priv->timeout) {
+            listing = GF_CALLOC(1, sizeof(*listing), gf_sa_mt_sa_listing_t);
+            if (listing) {
+                GF_ATOMIC_INIT(listing->refcount, 1);
+                INIT_LIST_HEAD(&listing->entries.list);
+                list_splice_init(&local->entries.list, &listing->entries.list);
+                listing->size = local->size;
+                listing->listed = time(NULL);
+            }
+        }
+    }
+
+    ctx = sa_inode_ctx(this, local->inode);
+
+    LOCK(&priv->lock);
+    {
+        priv->inflight--;
+
+        if (ctx) {
+            ctx->inflight = _gf_false;
+
+            /* the directory changed while it was being read */
+            if (listing && (ctx->gen == local->gen)) {
+                old = ctx->listing;
+                if (old) {
+                    list_del_init(&ctx->lru);
+                    priv->cache_used -= old->size;
+                }
+
+                ctx->listing = listing;
+                listing = NULL;
+                priv->cache_used += ctx->listing->size;
+                list_add_tail(&ctx->lru, &priv->listings);
+            }
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    sa_listing_unref(listing);
+    sa_listing_unref(old);
+
+    sa_evict(this);
+
+    /* keep the window full */
+    sa_prefetch(frame, this, local->parent);
+
+    sa_local_free(local);
+    STACK_DESTROY(frame->root);
+}
+
+static int32_t
+sa_prefetch_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                         dict_t *xdata)
+{
+    sa_private_t *priv = this->private;
+    sa_local_t *local = frame->local;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *copy = NULL;
+    inode_t *linked = NULL;
+
+    if ((op_ret < 0) && (op_errno != ENOENT)) {
+        GF_ATOMIC_INC(priv->prefetch_failed);
+        sa_prefetch_done(frame, this, _gf_false);
+        return 0;
+    }
+
+    if (op_ret <= 0) {
+        sa_prefetch_done(frame, this, _gf_true);
+        return 0;
+    }
+
+    list_for_each_entry(entry, &entries->list, list)
+    {
+        /* link the entries, so that lookups of the application find the
+         * inodes md-cache filled. No lookup count is taken, the inodes are
+         * not known to the application yet. */
+        if (entry->inode && (strcmp(entry->d_name, ".") != 0) &&
+            (strcmp(entry->d_name, "..") != 0)) {
+            linked = inode_link(entry->inode, local->inode, entry->d_name,
+                                &entry->d_stat);
+            if (linked) {
+                inode_unref(entry->inode);
+                entry->inode = linked;
+            }
+        }
+
+        copy = entry_copy(entry);
+        if (copy == NULL) {
+            sa_prefetch_done(frame, this, _gf_false);
+            return 0;
+        }
+
+        list_add_tail(&copy->list, &local->entries.list);
+        local->size += sa_dirent_size(copy);
+        local->offset = entry->d_off;
+    }
+
+    /* directories that would take a good share of the cache are only
+     * prefetched for md-cache */
+    if (local->size > priv->cache_size / 4) {
+        GF_ATOMIC_INC(priv->too_big);
+        sa_prefetch_done(frame, this, _gf_false);
+        return 0;
+    }
+
+    if (op_errno == ENOENT) {
+        sa_prefetch_done(frame, this, _gf_true);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_prefetch_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, local->fd, SA_READDIRP_SIZE,
+               local->offset, NULL);
+    return 0;
+}
+
+static int32_t
+sa_prefetch_opendir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, fd_t *fd,
+                        dict_t *xdata)
+{
+    sa_private_t *priv = this->private;
+    sa_local_t *local = frame->local;
+
+    if (op_ret < 0) {
+        gf_msg_debug(this->name, op_errno, "prefetch of %s failed",
+                     uuid_utoa(local->inode->gfid));
+        GF_ATOMIC_INC(priv->prefetch_failed);
+        sa_prefetch_done(frame, this, _gf_false);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_prefetch_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, local->fd, SA_READDIRP_SIZE,
+               0, NULL);
+    return 0;
+}
+
+static int
+sa_prefetch_start(call_frame_t *frame, xlator_t *this, inode_t *parent,
+                  inode_t *inode, uint64_t gen)
+{
+    call_frame_t *prefetch = NULL;
+    sa_local_t *local = NULL;
+    loc_t loc = {
+        0,
+    };
+
+    local = GF_CALLOC(1, sizeof(*local), gf_sa_mt_sa_local_t);
+    if (local == NULL)
+        goto err;
+
+    INIT_LIST_HEAD(&local->entries.list);
+    local->inode = inode_ref(inode);
+    local->parent = inode_ref(parent);
+    local->gen = gen;
+
+    /* the directory is read with the credentials of the application */
+    prefetch = copy_frame(frame);
+    if (prefetch == NULL)
+        goto err;
+
+    local->fd = fd_create(inode, prefetch->root->pid);
+    if (local->fd == NULL)
+        goto err;
+
+    prefetch->local = local;
+
+    loc.inode = inode_ref(inode);
+    gf_uuid_copy(loc.gfid, inode->gfid);
+
+    STACK_WIND(prefetch, sa_prefetch_opendir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->opendir, &loc, local->fd, NULL);
+
+    loc_wipe(&loc);
+    return 0;
+
+err:
+    gf_msg(this->name, GF_LOG_WARNING, ENOMEM, SA_MSG_NO_MEMORY,
+           "could not prefetch %s", uuid_utoa(inode->gfid));
+    if (prefetch)
+        STACK_DESTROY(prefetch->root);
+    sa_local_free(local);
+    return -1;
+}
+
+/*
+ * sa_prefetch - prefetch the next subdirectories of @parent, up to the
+ *               window ahead of the one the application is in and as
+ *               many as the in-flight budget allows
+ */
+static void
+sa_prefetch(call_frame_t *frame, xlator_t *this, inode_t *parent)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *pctx = NULL;
+    sa_inode_t *ctx = NULL;
+    inode_t *inode = NULL;
+    uint64_t gen = 0;
+    uuid_t gfid;
+    gf_boolean_t start = _gf_false;
+
+    pctx = sa_inode_ctx(this, parent);
+    if (pctx == NULL)
+        return;
+
+    for (;;) {
+        LOCK(&priv->lock);
+        {
+            if ((priv->inflight >= priv->max_inflight) ||
+                (pctx->next >= pctx->subdir_count) ||
+                (pctx->next > pctx->descended + priv->window)) {
+                UNLOCK(&priv->lock);
+                break;
+            }
+
+            /* reserve the slot before letting go of the lock */
+            priv->inflight++;
+            gf_uuid_copy(gfid, pctx->subdirs[pctx->next++]);
+        }
+        UNLOCK(&priv->lock);
+
+        start = _gf_false;
+
+        inode = inode_find(parent->table, gfid);
+        if (inode)
+            ctx = sa_inode_get(this, inode);
+
+        LOCK(&priv->lock);
+        {
+            if (inode && ctx && !ctx->inflight &&
+                !__sa_listing_fresh(priv, ctx->listing)) {
+                ctx->inflight = _gf_true;
+                gen = ctx->gen;
+                start = _gf_true;
+            } else {
+                priv->inflight--;
+            }
+        }
+        UNLOCK(&priv->lock);
+
+        if (start && sa_prefetch_start(frame, this, parent, inode, gen)) {
+            LOCK(&priv->lock);
+            {
+                ctx->inflight = _gf_false;
+                priv->inflight--;
+            }
+            UNLOCK(&priv->lock);
+        }
+
+        if (inode)
+            inode_unref(inode);
+        inode = NULL;
+        ctx = NULL;
+    }
+}
+
+/* the application read @dir to the end */
+static void
+sa_listed(call_frame_t *frame, xlator_t *this, inode_t *dir)
+{
+    sa_private_t *priv = this->private;
+
+    /* while a walk goes on, the subdirectories of a directory are opened
+     * once its entries are looked up, get them ahead of that */
+    if (time(NULL) - priv->walked <= SA_WALK_TIMEOUT)
+        sa_prefetch(frame, this, dir);
+}
+
+static int32_t
+sa_opendir(call_frame_t *frame, xlator_t *this, loc_t *loc, fd_t *fd,
+           dict_t *xdata)
+{
+    inode_t *parent = NULL;
+
+    if (loc->inode && !__is_root_gfid(loc->inode->gfid)) {
+        if (loc->parent)
+            parent = inode_ref(loc->parent);
+        else
+            parent = inode_parent(loc->inode, NULL, NULL);
+    }
+
+    if (parent) {
+        sa_descend(frame, this, parent, loc->inode);
+        inode_unref(parent);
+    }
+
+    STACK_WIND_TAIL(frame, FIRST_CHILD(this), FIRST_CHILD(this)->fops->opendir,
+                    loc, fd, xdata);
+    return 0;
+}
+
+static sa_fd_t *
+__sa_fd_ctx_get(xlator_t *this, fd_t *fd)
+{
+    uint64_t value = 0;
+
+    if (__fd_ctx_get(fd, this, &value))
+        return NULL;
+
+    return (sa_fd_t *)(uintptr_t)value;
+}
+
+static sa_listing_t *
+sa_listing_get(xlator_t *this, inode_t *inode)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *ctx = NULL;
+    sa_listing_t *listing = NULL;
+
+    ctx = sa_inode_ctx(this, inode);
+    if (ctx == NULL)
+        return NULL;
+
+    LOCK(&priv->lock);
+    {
+        if (__sa_listing_fresh(priv, ctx->listing)) {
+            listing = sa_listing_ref(ctx->listing);
+            list_move_tail(&ctx->lru, &priv->listings);
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    return listing;
+}
+
+/*
+ * Serves a readdirp from the prefetched listing of the directory. Only
+ * sessions that start at offset 0 while the listing is fresh are served,
+ * and they are served to the end from the same listing, with its offsets.
+ * Returns -1 when the readdirp has to go to the bricks.
+ */
+static int32_t
+sa_serve_readdirp(xlator_t *this, fd_t *fd, size_t size, off_t off,
+                  gf_dirent_t *entries, int32_t *op_errno)
+{
+    sa_fd_t *fctx = NULL;
+    sa_listing_t *listing = NULL;
+    sa_listing_t *drop = NULL;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *copy = NULL;
+    size_t filled = 0;
+    size_t dirent_size = 0;
+    int32_t count = -1;
+
+    if ((off == 0) && fd_ctx_get(fd, this, NULL))
+        listing = sa_listing_get(this, fd->inode);
+
+    LOCK(&fd->lock);
+    {
+        fctx = __sa_fd_ctx_get(this, fd);
+        if (fctx == NULL) {
+            if (listing == NULL)
+                goto unlock;
+
+            fctx = GF_CALLOC(1, sizeof(*fctx), gf_sa_mt_sa_fd_t);
+            if (fctx == NULL)
+                goto unlock;
+
+            if (__fd_ctx_set(fd, this, (uint64_t)(uintptr_t)fctx)) {
+                GF_FREE(fctx);
+                goto unlock;
+            }
+
+            fctx->listing = listing;
+            listing = NULL;
+            fctx->next = list_first_entry(&fctx->listing->entries.list,
+                                          gf_dirent_t, list);
+            fctx->next_off = 0;
+        }
+
+        if (fctx->bypass)
+            goto unlock;
+
+        if ((fctx->listing == NULL) || (off != fctx->next_off)) {
+            /* rewound or seeked, leave it to the bricks */
+            drop = fctx->listing;
+            fctx->listing = NULL;
+            fctx->bypass = _gf_true;
+            goto unlock;
+        }
+
+        count = 0;
+        entry = fctx->next;
+        while (&entry->list != &fctx->listing->entries.list) {
+            dirent_size = gf_dirent_size(entry->d_name);
+            if (count && (filled + dirent_size > size))
+                break;
+
+            copy = entry_copy(entry);
+            if (copy == NULL)
+                break;
+
+            list_add_tail(&copy->list, &entries->list);
+            filled += dirent_size;
+            count++;
+            fctx->next_off = entry->d_off;
+
+            entry = list_next_entry(entry, list);
+        }
+        fctx->next = entry;
+
+        *op_errno = (&entry->list == &fctx->listing->entries.list) ? ENOENT
+                                                                    : 0;
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    sa_listing_unref(listing);
+    sa_listing_unref(drop);
+
+    return count;
+}
+
+static int32_t
+sa_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                dict_t *xdata)
+{
+    sa_local_t *local = frame->local;
+
+    frame->local = NULL;
+
+    if (op_ret > 0)
+        sa_record_subdirs(this, local->fd->inode, (local->offset == 0),
+                          entries);
+
+    if ((op_ret == 0) || ((op_ret > 0) && (op_errno == ENOENT)))
+        sa_listed(frame, this, local->fd->inode);
+
+    STACK_UNWIND_STRICT(readdirp, frame, op_ret, op_errno, entries, xdata);
+
+    sa_local_free(local);
+    return 0;
+}
+
+static int32_t
+sa_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+            off_t off, dict_t *xdata)
+{
+    sa_private_t *priv = this->private;
+    sa_local_t *local = NULL;
+    gf_dirent_t entries;
+    int32_t op_errno = 0;
+    int32_t count = 0;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    count = sa_serve_readdirp(this, fd, size, off, &entries, &op_errno);
+    if (count >= 0) {
+        GF_ATOMIC_INC(priv->served);
+        GF_ATOMIC_ADD(priv->served_entries, count);
+
+        if (count)
+            sa_record_subdirs(this, fd->inode, (off == 0), &entries);
+        if (op_errno == ENOENT)
+            sa_listed(frame, this, fd->inode);
+
+        STACK_UNWIND_STRICT(readdirp, frame, count, op_errno, &entries, NULL);
+        gf_dirent_free(&entries);
+        return 0;
+    }
+
+    local = GF_CALLOC(1, sizeof(*local), gf_sa_mt_sa_local_t);
+    if (local == NULL) {
+        STACK_UNWIND_STRICT(readdirp, frame, -1, ENOMEM, NULL, NULL);
+        return 0;
+    }
+
+    INIT_LIST_HEAD(&local->entries.list);
+    local->fd = fd_ref(fd);
+    local->offset = off;
+    frame->local = local;
+
+    STACK_WIND(frame, sa_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, fd, size, off, xdata);
+    return 0;
+}
+
+/* entry operations change the listing of the parent directory
+ *
+ * The listings are dropped at wind, and once more when the fop completes:
+ * a prefetch that started in between may have read the directory before
+ * the change reached it, and its gen was taken after the first bump. The
+ * second bump is done whatever the result, a failed fop may have been
+ * applied on some of the bricks. */
+
+static inode_t *
+sa_loc_parent(loc_t *loc)
+{
+    if (loc->parent)
+        return inode_ref(loc->parent);
+
+    if (loc->inode)
+        return inode_parent(loc->inode, NULL, NULL);
+
+    return NULL;
+}
+
+/* drops the listings of @dir and @other, and keeps them in the local of
+ * @frame for sa_modified(); consumes the refs */
+static int
+sa_modify(call_frame_t *frame, xlator_t *this, inode_t *dir, inode_t *other)
+{
+    sa_local_t *local = NULL;
+
+    local = GF_CALLOC(1, sizeof(*local), gf_sa_mt_sa_local_t);
+    if (local == NULL) {
+        if (dir)
+            inode_unref(dir);
+        if (other)
+            inode_unref(other);
+        return -1;
+    }
+
+    INIT_LIST_HEAD(&local->entries.list);
+    local->parent = dir;
+    local->inode = other;
+
+    sa_invalidate(this, local->parent);
+    sa_invalidate(this, local->inode);
+
+    frame->local = local;
+    return 0;
+}
+
+static void
+sa_modified(call_frame_t *frame, xlator_t *this)
+{
+    sa_local_t *local = frame->local;
+
+    frame->local = NULL;
+    if (local == NULL)
+        return;
+
+    sa_invalidate(this, local->parent);
+    sa_invalidate(this, local->inode);
+    sa_local_free(local);
+}
+
+static int32_t
+sa_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(create, frame, op_ret, op_errno, fd, inode, buf,
+                        preparent, postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+          mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(loc), NULL) < 0) {
+        STACK_UNWIND_STRICT(create, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL, NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_create_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->create, loc, flags, mode, umask, fd,
+               xdata);
+    return 0;
+}
+
+static int32_t
+sa_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, inode_t *inode,
+             struct iatt *buf, struct iatt *preparent,
+             struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(mkdir, frame, op_ret, op_errno, inode, buf, preparent,
+                        postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+         mode_t umask, dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(loc), NULL) < 0) {
+        STACK_UNWIND_STRICT(mkdir, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_mkdir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->mkdir, loc, mode, umask, xdata);
+    return 0;
+}
+
+static int32_t
+sa_mknod_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, inode_t *inode,
+             struct iatt *buf, struct iatt *preparent,
+             struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(mknod, frame, op_ret, op_errno, inode, buf, preparent,
+                        postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_mknod(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+         dev_t rdev, mode_t umask, dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(loc), NULL) < 0) {
+        STACK_UNWIND_STRICT(mknod, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_mknod_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->mknod, loc, mode, rdev, umask, xdata);
+    return 0;
+}
+
+static int32_t
+sa_symlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(symlink, frame, op_ret, op_errno, inode, buf,
+                        preparent, postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_symlink(call_frame_t *frame, xlator_t *this, const char *linkname,
+           loc_t *loc, mode_t umask, dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(loc), NULL) < 0) {
+        STACK_UNWIND_STRICT(symlink, frame, -1, ENOMEM, NULL, NULL, NULL,
+                            NULL, NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_symlink_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->symlink, linkname, loc, umask, xdata);
+    return 0;
+}
+
+static int32_t
+sa_link_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+            int32_t op_errno, inode_t *inode, struct iatt *buf,
+            struct iatt *preparent, struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(link, frame, op_ret, op_errno, inode, buf, preparent,
+                        postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+        dict_t *xdata)
+{
+    inode_t *oldparent = NULL;
+
+    /* the link count of the entry changes in the old parent too */
+    if (oldloc->inode)
+        oldparent = inode_parent(oldloc->inode, NULL, NULL);
+
+    if (sa_modify(frame, this, sa_loc_parent(newloc), oldparent) < 0) {
+        STACK_UNWIND_STRICT(link, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_link_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->link, oldloc, newloc, xdata);
+    return 0;
+}
+
+static int32_t
+sa_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(unlink, frame, op_ret, op_errno, preparent,
+                        postparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+          dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(loc), NULL) < 0) {
+        STACK_UNWIND_STRICT(unlink, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_unlink_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->unlink, loc, xflag, xdata);
+    return 0;
+}
+
+static int32_t
+sa_rmdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+             struct iatt *postparent, dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(rmdir, frame, op_ret, op_errno, preparent, postparent,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
+         dict_t *xdata)
+{
+    inode_t *dir = NULL;
+
+    if (loc->inode)
+        dir = inode_ref(loc->inode);
+
+    if (sa_modify(frame, this, sa_loc_parent(loc), dir) < 0) {
+        STACK_UNWIND_STRICT(rmdir, frame, -1, ENOMEM, NULL, NULL, NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_rmdir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->rmdir, loc, flags, xdata);
+    return 0;
+}
+
+static int32_t
+sa_rename_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *buf,
+              struct iatt *preoldparent, struct iatt *postoldparent,
+              struct iatt *prenewparent, struct iatt *postnewparent,
+              dict_t *xdata)
+{
+    sa_modified(frame, this);
+
+    STACK_UNWIND_STRICT(rename, frame, op_ret, op_errno, buf, preoldparent,
+                        postoldparent, prenewparent, postnewparent, xdata);
+    return 0;
+}
+
+static int32_t
+sa_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+          dict_t *xdata)
+{
+    if (sa_modify(frame, this, sa_loc_parent(oldloc),
+                  sa_loc_parent(newloc)) < 0) {
+        STACK_UNWIND_STRICT(rename, frame, -1, ENOMEM, NULL, NULL, NULL, NULL,
+                            NULL, NULL);
+        return 0;
+    }
+
+    STACK_WIND(frame, sa_rename_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->rename, oldloc, newloc, xdata);
+    return 0;
+}
+
+/* attribute changes make the entry in the parent listing stale
+ *
+ * The inode is passed as the cookie, the fd or loc of the caller holds it
+ * until the fop unwinds. */
+
+static int32_t
+sa_setattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+               struct iatt *statpost, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(setattr, frame, op_ret, op_errno, statpre, statpost,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_setattr(call_frame_t *frame, xlator_t *this, loc_t *loc, struct iatt *stbuf,
+           int32_t valid, dict_t *xdata)
+{
+    sa_invalidate_parent(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, sa_setattr_cbk, loc->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->setattr, loc, stbuf, valid,
+                      xdata);
+    return 0;
+}
+
+static int32_t
+sa_fsetattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *statpre,
+                struct iatt *statpost, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(fsetattr, frame, op_ret, op_errno, statpre, statpost,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_fsetattr(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iatt *stbuf,
+            int32_t valid, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_fsetattr_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->fsetattr, fd, stbuf, valid,
+                      xdata);
+    return 0;
+}
+
+static int32_t
+sa_truncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(truncate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+            dict_t *xdata)
+{
+    sa_invalidate_parent(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, sa_truncate_cbk, loc->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->truncate, loc, offset, xdata);
+    return 0;
+}
+
+static int32_t
+sa_ftruncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(ftruncate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_ftruncate_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->ftruncate, fd, offset, xdata);
+    return 0;
+}
+
+static int32_t
+sa_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+              struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(writev, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
+          int32_t count, off_t off, uint32_t flags, struct iobref *iobref,
+          dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_writev_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->writev, fd, vector, count, off,
+                      flags, iobref, xdata);
+    return 0;
+}
+
+static int32_t
+sa_fallocate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(fallocate, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t mode,
+             off_t offset, size_t len, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_fallocate_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->fallocate, fd, mode, offset,
+                      len, xdata);
+    return 0;
+}
+
+static int32_t
+sa_discard_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+               struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(discard, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+           size_t len, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_discard_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->discard, fd, offset, len,
+                      xdata);
+    return 0;
+}
+
+static int32_t
+sa_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(zerofill, frame, op_ret, op_errno, prebuf, postbuf,
+                        xdata);
+    return 0;
+}
+
+static int32_t
+sa_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            off_t len, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_zerofill_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->zerofill, fd, offset, len,
+                      xdata);
+    return 0;
+}
+
+/* xattrs are returned with the entries by readdirp, and change the ctime */
+
+static int32_t
+sa_setxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(setxattr, frame, op_ret, op_errno, xdata);
+    return 0;
+}
+
+static int32_t
+sa_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
+            int32_t flags, dict_t *xdata)
+{
+    sa_invalidate_parent(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, sa_setxattr_cbk, loc->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->setxattr, loc, dict, flags,
+                      xdata);
+    return 0;
+}
+
+static int32_t
+sa_fsetxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(fsetxattr, frame, op_ret, op_errno, xdata);
+    return 0;
+}
+
+static int32_t
+sa_fsetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *dict,
+             int32_t flags, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_fsetxattr_cbk, fd->inode, FIRST_CHILD(this),
+                      FIRST_CHILD(this)->fops->fsetxattr, fd, dict, flags,
+                      xdata);
+    return 0;
+}
+
+static int32_t
+sa_removexattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(removexattr, frame, op_ret, op_errno, xdata);
+    return 0;
+}
+
+static int32_t
+sa_removexattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+               const char *name, dict_t *xdata)
+{
+    sa_invalidate_parent(this, loc->inode);
+
+    STACK_WIND_COOKIE(frame, sa_removexattr_cbk, loc->inode,
+                      FIRST_CHILD(this), FIRST_CHILD(this)->fops->removexattr,
+                      loc, name, xdata);
+    return 0;
+}
+
+static int32_t
+sa_fremovexattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    sa_invalidate_parent(this, cookie);
+
+    STACK_UNWIND_STRICT(fremovexattr, frame, op_ret, op_errno, xdata);
+    return 0;
+}
+
+static int32_t
+sa_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                const char *name, dict_t *xdata)
+{
+    sa_invalidate_parent(this, fd->inode);
+
+    STACK_WIND_COOKIE(frame, sa_fremovexattr_cbk, fd->inode,
+                      FIRST_CHILD(this), FIRST_CHILD(this)->fops->fremovexattr,
+                      fd, name, xdata);
+    return 0;
+}
+
+static int32_t
+sa_releasedir(xlator_t *this, fd_t *fd)
+{
+    sa_fd_t *fctx = NULL;
+    uint64_t value = 0;
+
+    if (fd_ctx_del(fd, this, &value) || !value)
+        return 0;
+
+    fctx = (sa_fd_t *)(uintptr_t)value;
+    sa_listing_unref(fctx->listing);
+    GF_FREE(fctx);
+
+    return 0;
+}
+
+static int32_t
+sa_forget(xlator_t *this, inode_t *inode)
+{
+    sa_private_t *priv = this->private;
+    sa_inode_t *ctx = NULL;
+    sa_listing_t *listing = NULL;
+    uint64_t value = 0;
+
+    if (inode_ctx_del(inode, this, &value) || !value)
+        return 0;
+
+    ctx = (sa_inode_t *)(uintptr_t)value;
+
+    if (priv) {
+        LOCK(&priv->lock);
+        {
+            listing = __sa_inode_drop(priv, ctx);
+        }
+        UNLOCK(&priv->lock);
+    } else {
+        listing = ctx->listing;
+    }
+
+    sa_listing_unref(listing);
+    GF_FREE(ctx->subdirs);
+    GF_FREE(ctx);
+
+    return 0;
+}
+
+int32_t
+sa_notify(xlator_t *this, int event, void *data, ...)
+{
+    struct gf_upcall *up_data = NULL;
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+
+    if (event == GF_EVENT_UPCALL) {
+        up_data = (struct gf_upcall *)data;
+        if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+            goto out;
+
+        itable = ((xlator_t *)this->graph->top)->itable;
+        if (itable == NULL)
+            goto out;
+
+        inode = inode_find(itable, up_data->gfid);
+        if (inode == NULL)
+            goto out;
+
+        /* the directory itself, or its entry in the parent */
+        sa_invalidate(this, inode);
+        sa_invalidate_parent(this, inode);
+        inode_unref(inode);
+    }
+
+out:
+    return default_notify(this, event, data);
+}
+
+int32_t
+sa_priv_dump(xlator_t *this)
+{
+    sa_private_t *priv = this->private;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+    if (!priv)
+        return 0;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.stat-ahead",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("cache_size", "%" PRIu64, priv->cache_size);
+    gf_proc_dump_write("window", "%d", priv->window);
+    gf_proc_dump_write("max_inflight", "%d", priv->max_inflight);
+    gf_proc_dump_write("timeout", "%d", priv->timeout);
+
+    LOCK(&priv->lock);
+    {
+        gf_proc_dump_write("cache_used", "%" PRIu64, priv->cache_used);
+        gf_proc_dump_write("inflight", "%d", priv->inflight);
+    }
+    UNLOCK(&priv->lock);
+
+    gf_proc_dump_write("prefetched", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->prefetched));
+    gf_proc_dump_write("prefetch_failed", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->prefetch_failed));
+    gf_proc_dump_write("too_big", "%" PRIu64, GF_ATOMIC_GET(priv->too_big));
+    gf_proc_dump_write("served", "%" PRIu64, GF_ATOMIC_GET(priv->served));
+    gf_proc_dump_write("served_entries", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->served_entries));
+    gf_proc_dump_write("invalidated", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->invalidated));
+    gf_proc_dump_write("evicted", "%" PRIu64, GF_ATOMIC_GET(priv->evicted));
+
+    return 0;
+}
+
+int32_t
+mem_acct_init(xlator_t *this)
+{
+    int ret = -1;
+
+    if (!this)
+        goto out;
+
+    ret = xlator_mem_acct_init(this, gf_sa_mt_end + 1);
+
+    if (ret != 0) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, SA_MSG_NO_MEMORY,
+               "Memory accounting init failed");
+        goto out;
+    }
+out:
+    return ret;
+}
+
+int
+reconfigure(xlator_t *this, dict_t *options)
+{
+    sa_private_t *priv = this->private;
+    int ret = -1;
+
+    GF_OPTION_RECONF("cache-size", priv->cache_size, options, size_uint64,
+                     out);
+    GF_OPTION_RECONF("window", priv->window, options, int32, out);
+    GF_OPTION_RECONF("max-inflight", priv->max_inflight, options, int32, out);
+    GF_OPTION_RECONF("timeout", priv->timeout, options, int32, out);
+    GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
+
+    sa_evict(this);
+
+    ret = 0;
+out:
+    return ret;
+}
+
+int
+init(xlator_t *this)
+{
+    sa_private_t *priv = NULL;
+
+    if (!this->children || this->children->next) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, SA_MSG_XLATOR_CHILD_MISCONFIGURED,
+               "FATAL: stat-ahead not configured with exactly one child");
+        return -1;
+    }
+
+    if (!this->parents)
+        gf_msg(this->name, GF_LOG_WARNING, 0, SA_MSG_VOL_MISCONFIGURED,
+               "dangling volume. check volfile");
+
+    priv = GF_CALLOC(1, sizeof(*priv), gf_sa_mt_sa_private_t);
+    if (!priv)
+        goto err;
+
+    LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->listings);
+
+    GF_ATOMIC_INIT(priv->prefetched, 0);
+    GF_ATOMIC_INIT(priv->prefetch_failed, 0);
+    GF_ATOMIC_INIT(priv->too_big, 0);
+    GF_ATOMIC_INIT(priv->served, 0);
+    GF_ATOMIC_INIT(priv->served_entries, 0);
+    GF_ATOMIC_INIT(priv->invalidated, 0);
+    GF_ATOMIC_INIT(priv->evicted, 0);
+
+    GF_OPTION_INIT("cache-size", priv->cache_size, size_uint64, err);
+    GF_OPTION_INIT("window", priv->window, int32, err);
+    GF_OPTION_INIT("max-inflight", priv->max_inflight, int32, err);
+    GF_OPTION_INIT("timeout", priv->timeout, int32, err);
+    GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
+
+    this->private = priv;
+
+    return 0;
+err:
+    if (priv) {
+        LOCK_DESTROY(&priv->lock);
+        GF_FREE(priv);
+    }
+
+    return -1;
+}
+
+void
+fini(xlator_t *this)
+{
+    sa_private_t *priv = this->private;
+
+    if (!priv)
+        return;
+
+    this->private = NULL;
+    LOCK_DESTROY(&priv->lock);
+    GF_FREE(priv);
+}
+
+struct xlator_fops fops = {
+    .opendir = sa_opendir,
+    .readdirp = sa_readdirp,
+    .create = sa_create,
+    .mkdir = sa_mkdir,
+    .mknod = sa_mknod,
+    .symlink = sa_symlink,
+    .link = sa_link,
+    .unlink = sa_unlink,
+    .rmdir = sa_rmdir,
+    .rename = sa_rename,
+    .setattr = sa_setattr,
+    .fsetattr = sa_fsetattr,
+    .truncate = sa_truncate,
+    .ftruncate = sa_ftruncate,
+    .writev = sa_writev,
+    .fallocate = sa_fallocate,
+    .discard = sa_discard,
+    .zerofill = sa_zerofill,
+    .setxattr = sa_setxattr,
+    .fsetxattr = sa_fsetxattr,
+    .removexattr = sa_removexattr,
+    .fremovexattr = sa_fremovexattr,
+};
+
+struct xlator_cbks cbks = {
+    .releasedir = sa_releasedir,
+    .forget = sa_forget,
+};
+
+struct xlator_dumpops dumpops = {
+    .priv = sa_priv_dump,
+};
+
+struct volume_options options[] = {
+    {
+        .key = {"stat-ahead"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .description = "enable/disable stat-ahead",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE,
+    },
+    {
+        .key = {"cache-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 1 * GF_UNIT_GB,
+        .default_value = "16MB",
+        .description = "Memory the prefetched listings may use. Directories "
+                       "bigger than a quarter of it are prefetched for "
+                       "md-cache but not kept.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"stat-ahead"},
+    },
+    {
+        .key = {"window"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 64,
+        .default_value = "8",
+        .description = "Subdirectories prefetched ahead of the one the "
+                       "application walks into.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"stat-ahead"},
+    },
+    {
+        .key = {"max-inflight"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 64,
+        .default_value = "4",
+        .description = "Directories being prefetched at the same time.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"stat-ahead"},
+    },
+    {
+        .key = {"timeout"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 600,
+        .default_value = "1",
+        .description = "Seconds a prefetched listing serves readdirps for. "
+                       "With 0, listings are only prefetched for md-cache.",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"stat-ahead"},
+    },
+    {
+        .key = {"pass-through"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "false",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"stat-ahead"},
+        .description = "Enable/Disable stat-ahead translator",
+    },
+    {.key = {NULL}},
+};
+
+xlator_api_t xlator_api = {
+    .init = init,
+    .fini = fini,
+    .notify = sa_notify,
+    .reconfigure = reconfigure,
+    .mem_acct_init = mem_acct_init,
+    .op_version = {GD_OP_VERSION_8_0},
+    .dumpops = &dumpops,
+    .fops = &fops,
+    .cbks = &cbks,
+    .options = options,
+    .identifier = "stat-ahead",
+    .category = GF_TECH_PREVIEW,
+};
@@ -0,0 +1,114 @@
+/*
+ *   Copyright (c) 2020 Red Hat, Inc. <http://www.redhat.com>
+ *   This file is part of GlusterFS.
+ *
+ *   This file is licensed to you under your choice of the GNU Lesser
+ *   General Public License, version 3 or any later version (LGPLv3 or
+ *   later), or the GNU General Public License, version 2 (GPLv2), in all
+ *   cases as published by the Free Software Foundation.
+ */
+
+#ifndef __STAT_AHEAD_H__
+#define __STAT_AHEAD_H__
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/defaults.h>
+#include <glusterfs/list.h>
+#include <glusterfs/locking.h>
+#include <glusterfs/common-utils.h>
+#include "stat-ahead-mem-types.h"
+#include "stat-ahead-messages.h"
+
+/* size of the readdirp requests of a prefetch */
+#define SA_READDIRP_SIZE (128 * GF_UNIT_KB)
+
+/* subdirectories remembered per directory, the walk is not followed
+ * further in bigger directories */
+#define SA_MAX_SUBDIRS 16384
+
+/* a descent into a subdirectory listed less than this many seconds ago
+ * means the tree is being walked */
+#define SA_WALK_TIMEOUT 2
+
+/*
+ * sa_listing - the complete listing of a directory, as prefetched
+ *
+ * Immutable once complete. Readers on an fd keep a ref while they serve
+ * from it, even after the directory has dropped it.
+ */
+struct sa_listing {
+    gf_atomic_t refcount;
+    gf_dirent_t entries;
+    uint64_t size; /* accounted in priv->cache_used */
+    time_t listed; /* when the prefetch completed */
+};
+typedef struct sa_listing sa_listing_t;
+
+/*
+ * sa_inode - stat-ahead state of a directory
+ *
+ * All fields are protected by priv->lock.
+ */
+struct sa_inode {
+    struct list_head lru;  /* in priv->listings, while there is a listing */
+    inode_t *inode;        /* not ref'd, the ctx goes away with the inode */
+    sa_listing_t *listing; /* NULL when not prefetched or dropped */
+    uint64_t gen;          /* bumped when the directory changes */
+    gf_boolean_t inflight; /* a prefetch of this directory is running */
+
+    /* subdirectories, in the order the application read them */
+    uuid_t *subdirs;
+    int32_t subdir_count;
+    int32_t subdir_size;
+    int32_t descended; /* last subdirectory the application opened */
+    int32_t next;      /* next subdirectory to prefetch */
+    time_t read;       /* when the application last read the directory */
+};
+typedef struct sa_inode sa_inode_t;
+
+/* a readdirp session on an fd of the application */
+struct sa_fd {
+    sa_listing_t *listing; /* serving from it */
+    gf_dirent_t *next;     /* next entry to serve */
+    off_t next_off;        /* offset expected by the next readdirp */
+    gf_boolean_t bypass;   /* readdirps of this fd go to the bricks */
+};
+typedef struct sa_fd sa_fd_t;
+
+struct sa_local {
+    inode_t *inode;  /* directory prefetched */
+    inode_t *parent; /* directory being walked */
+    fd_t *fd;
+    uint64_t gen;
+    gf_dirent_t entries;
+    uint64_t size;
+    off_t offset;
+};
+typedef struct sa_local sa_local_t;
+
+struct sa_private {
+    gf_lock_t lock;
+    struct list_head listings; /* sa_inode_t with a listing, lru first */
+    uint64_t cache_used;
+    int32_t inflight;
+    time_t walked; /* last descent into a listed subdirectory */
+
+    /* options */
+    uint64_t cache_size;
+    int32_t window;
+    int32_t max_inflight;
+    int32_t timeout;
+
+    /* statistics */
+    gf_atomic_t prefetched;
+    gf_atomic_t prefetch_failed;
+    gf_atomic_t too_big;
+    gf_atomic_t served;
+    gf_atomic_t served_entries;
+    gf_atomic_t invalidated;
+    gf_atomic_t evicted;
+};
+typedef struct sa_private sa_private_t;
+
+#endif /* __STAT_AHEAD_H__ */
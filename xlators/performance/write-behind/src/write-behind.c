@@ -25,6 +25,7 @@
 #define MAX_VECTOR_COUNT 8
 #define WB_AGGREGATE_SIZE 131072 /* 128 KB */
 #define WB_WINDOW_SIZE 1048576   /* 1MB */
+#define WB_BUDGET_FLUSH_MAX 16   /* inodes flushed at once for the budget */
 
 typedef struct list_head list_head_t;
 struct wb_conf;
@@ -32,7 +33,7 @@ struct wb_inode;
 
 typedef struct wb_inode {
     ssize_t window_conf;
-    ssize_t window_current;
+    ssize_t window_current; /* also accounted in conf->dirty */
     ssize_t transit; /* size of data stack_wound, and yet
                         to be fulfilled (wb_fulfill_cbk).
                         used for trickling_writes
@@ -124,6 +125,12 @@ typedef struct wb_inode {
     gf_atomic_int32_t readdirps;
     gf_atomic_int8_t invalidate;
 
+    list_head_t lru;          /* in conf->lru while window_current > 0,
+                                 least recently grown first */
+    list_head_t wait;         /* in conf->waiters while lies are held
+                                 back for lack of dirty-budget */
+    gf_atomic_int32_t flush;  /* set to wind all held writes, to give
+                                 back dirty-budget */
 } wb_inode_t;
 
 typedef struct wb_request {
@@ -185,6 +192,16 @@ typedef struct wb_conf {
     uint64_t aggregate_size;
     uint64_t page_size;
     uint64_t window_size;
+    uint64_t dirty_budget; /* 0: each inode is limited by window_size */
+    gf_atomic_t dirty;     /* sum of window_current of all inodes */
+    gf_lock_t lock;        /* protects lru and waiters, taken with
+                              wb_inode->lock held, never the other way */
+    list_head_t lru;
+    list_head_t waiters;
+    gf_atomic_t budget_flushes;
+    gf_atomic_t fulfilled;          /* writevs wound by wb_fulfill_head() */
+    gf_atomic_t fulfilled_requests; /* write requests they carried */
+    gf_boolean_t vectored; /* aggregate-mode vector */
     gf_boolean_t flush_behind;
     gf_boolean_t trickling_writes;
     gf_boolean_t strict_write_ordering;
@@ -261,6 +278,132 @@ wb_set_invalidate(wb_inode_t *wb_inode)
 void
 wb_process_queue(wb_inode_t *wb_inode);
 
+/* Grows or shrinks the window of the inode. With a dirty-budget, inodes
+ * holding dirty data are kept in conf->lru, most recently grown last. */
+static void
+__wb_window_update(wb_inode_t *wb_inode, ssize_t delta)
+{
+    wb_conf_t *conf = NULL;
+
+    conf = wb_inode->this->private;
+
+    if (delta == 0)
+        return;
+
+    wb_inode->window_current += delta;
+    if (delta > 0)
+        GF_ATOMIC_ADD(conf->dirty, delta);
+    else
+        GF_ATOMIC_SUB(conf->dirty, -delta);
+
+    if (!conf->dirty_budget && list_empty(&wb_inode->lru))
+        return;
+
+    LOCK(&conf->lock);
+    {
+        if (wb_inode->window_current <= 0)
+            list_del_init(&wb_inode->lru);
+        else if ((delta > 0) && conf->dirty_budget)
+            list_move_tail(&wb_inode->lru, &conf->lru);
+    }
+    UNLOCK(&conf->lock);
+}
+
+static gf_boolean_t
+__wb_window_full(wb_inode_t *wb_inode)
+{
+    wb_conf_t *conf = NULL;
+
+    conf = wb_inode->this->private;
+
+    if (conf->dirty_budget)
+        return (GF_ATOMIC_GET(conf->dirty) > conf->dirty_budget);
+
+    return (wb_inode->window_current > wb_inode->window_conf);
+}
+
+/* Resumes the inodes that held back lies for lack of dirty-budget, once
+ * there is budget again */
+static void
+wb_budget_wake(xlator_t *this)
+{
+    wb_conf_t *conf = NULL;
+    wb_inode_t *wb_inode = NULL;
+    inode_t *inodes[WB_BUDGET_FLUSH_MAX];
+    int count = 0;
+    int i = 0;
+
+    conf = this->private;
+
+    do {
+        if (conf->dirty_budget &&
+            (GF_ATOMIC_GET(conf->dirty) > conf->dirty_budget))
+            return;
+
+        count = 0;
+        LOCK(&conf->lock);
+        {
+            while (!list_empty(&conf->waiters) &&
+                   (count < WB_BUDGET_FLUSH_MAX)) {
+                wb_inode = list_first_entry(&conf->waiters, wb_inode_t, wait);
+                list_del_init(&wb_inode->wait);
+                inodes[count++] = inode_ref(wb_inode->inode);
+            }
+        }
+        UNLOCK(&conf->lock);
+
+        for (i = 0; i < count; i++) {
+            wb_inode = wb_inode_ctx_get(this, inodes[i]);
+            if (wb_inode)
+                wb_process_queue(wb_inode);
+            inode_unref(inodes[i]);
+        }
+    } while (count == WB_BUDGET_FLUSH_MAX);
+}
+
+/* Winds the writes held for aggregation by the least recently grown
+ * inodes, until what they hold covers the excess over the dirty-budget */
+static void
+wb_budget_flush(xlator_t *this)
+{
+    wb_conf_t *conf = NULL;
+    wb_inode_t *wb_inode = NULL;
+    inode_t *inodes[WB_BUDGET_FLUSH_MAX];
+    int64_t excess = 0;
+    int count = 0;
+    int i = 0;
+
+    conf = this->private;
+
+    LOCK(&conf->lock);
+    {
+        excess = GF_ATOMIC_GET(conf->dirty) - conf->dirty_budget;
+        list_for_each_entry(wb_inode, &conf->lru, lru)
+        {
+            if ((excess <= 0) || (count == WB_BUDGET_FLUSH_MAX))
+                break;
+
+            GF_ATOMIC_SWAP(wb_inode->flush, 1);
+            inodes[count++] = inode_ref(wb_inode->inode);
+            excess -= wb_inode->window_current;
+        }
+    }
+    UNLOCK(&conf->lock);
+
+    for (i = 0; i < count; i++) {
+        wb_inode = wb_inode_ctx_get(this, inodes[i]);
+        if (wb_inode) {
+            GF_ATOMIC_INC(conf->budget_flushes);
+            wb_process_queue(wb_inode);
+        }
+        inode_unref(inodes[i]);
+    }
+
+    /* budget may have come back before this inode was added to the
+     * waiters */
+    wb_budget_wake(this);
+}
+
 /*
   Below is a succinct explanation of the code deciding whether two regions
   overlap, from Pavan <tcp@gluster.com>.
@@ -426,7 +569,7 @@ __wb_request_unref(wb_request_t *req)
         if (list_empty(&wb_inode->all)) {
             wb_inode->gen = 0;
             /* in case of accounting errors? */
-            wb_inode->window_current = 0;
+            __wb_window_update(wb_inode, -wb_inode->window_current);
         }
 
         list_del_init(&req->winds);
@@ -674,6 +817,8 @@ __wb_inode_create(xlator_t *this, inode_t *inode)
     INIT_LIST_HEAD(&wb_inode->temptation);
     INIT_LIST_HEAD(&wb_inode->wip);
     INIT_LIST_HEAD(&wb_inode->invalidate_list);
+    INIT_LIST_HEAD(&wb_inode->lru);
+    INIT_LIST_HEAD(&wb_inode->wait);
 
     wb_inode->this = this;
 
@@ -683,6 +828,7 @@ __wb_inode_create(xlator_t *this, inode_t *inode)
     LOCK_INIT(&wb_inode->lock);
     GF_ATOMIC_INIT(wb_inode->invalidate, 0);
     GF_ATOMIC_INIT(wb_inode->readdirps, 0);
+    GF_ATOMIC_INIT(wb_inode->flush, 0);
 
     ret = __inode_ctx_put(inode, this, (uint64_t)(unsigned long)wb_inode);
     if (ret) {
@@ -716,12 +862,22 @@ out:
 void
 wb_inode_destroy(wb_inode_t *wb_inode)
 {
+    wb_conf_t *conf = NULL;
+
     GF_VALIDATE_OR_GOTO("write-behind", wb_inode, out);
 
     GF_ASSERT(list_empty(&wb_inode->todo));
     GF_ASSERT(list_empty(&wb_inode->liability));
     GF_ASSERT(list_empty(&wb_inode->temptation));
 
+    conf = wb_inode->this->private;
+    LOCK(&conf->lock);
+    {
+        list_del_init(&wb_inode->lru);
+        list_del_init(&wb_inode->wait);
+    }
+    UNLOCK(&conf->lock);
+
     LOCK_DESTROY(&wb_inode->lock);
     GF_FREE(wb_inode);
 out:
@@ -739,7 +895,7 @@ __wb_fulfill_request(wb_request_t *req)
     wb_inode = req->wb_inode;
 
     req->ordering.fulfilled = 1;
-    wb_inode->window_current -= req->total_size;
+    __wb_window_update(wb_inode, -req->total_size);
     wb_inode->transit -= req->total_size;
 
     uuid_utoa_r(req->gfid, gfid);
@@ -1107,6 +1263,8 @@ wb_fulfill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
     wb_process_queue(wb_inode);
 
+    wb_budget_wake(this);
+
     STACK_DESTROY(frame->root);
 
     return 0;
@@ -1127,6 +1285,10 @@ wb_fulfill_head(wb_inode_t *wb_inode, wb_request_t *head)
     int count = 0;
     wb_request_t *req = NULL;
     call_frame_t *frame = NULL;
+    wb_conf_t *conf = NULL;
+    int requests = 1;
+
+    conf = wb_inode->this->private;
 
     /* make sure head->total_size is updated before we run into any
      * errors
@@ -1137,6 +1299,7 @@ wb_fulfill_head(wb_inode_t *wb_inode, wb_request_t *head)
     list_for_each_entry(req, &head->winds, winds)
     {
         WB_IOV_LOAD(vector, count, req, head);
+        requests++;
 
         if (iobref_merge(head->stub->args.iobref, req->stub->args.iobref))
             goto err;
@@ -1156,6 +1319,9 @@ wb_fulfill_head(wb_inode_t *wb_inode, wb_request_t *head)
     }
     UNLOCK(&wb_inode->lock);
 
+    GF_ATOMIC_INC(conf->fulfilled);
+    GF_ATOMIC_ADD(conf->fulfilled_requests, requests);
+
     STACK_WIND(frame, wb_fulfill_cbk, FIRST_CHILD(frame->this),
                FIRST_CHILD(frame->this)->fops->writev, head->fd, vector, count,
                head->stub->args.offset, head->stub->args.flags,
@@ -1175,8 +1341,8 @@ err:
             ret |= wb_fulfill_head(wb_inode, head);                            \
         head = req;                                                            \
         expected_offset = req->stub->args.offset + req->write_size;            \
-        curr_aggregate = 0;                                                    \
-        vector_count = 0;                                                      \
+        curr_aggregate = req->write_size;                                      \
+        vector_count = req->stub->args.count;                                  \
     } while (0)
 
 int
@@ -1228,6 +1394,7 @@ wb_fulfill(wb_inode_t *wb_inode, list_head_t *liabilities)
         }
 
         list_add_tail(&req->winds, &head->winds);
+        expected_offset += req->write_size;
         curr_aggregate += req->write_size;
         vector_count += req->stub->args.count;
     }
@@ -1263,25 +1430,33 @@ wb_do_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
     return;
 }
 
-void
+/* Returns true if lies were held back for lack of dirty-budget and the
+ * inode was not already waiting for it */
+gf_boolean_t
 __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
 {
     wb_request_t *req = NULL;
     wb_request_t *tmp = NULL;
+    wb_conf_t *conf = NULL;
+    gf_boolean_t held = _gf_false;
+    gf_boolean_t wait = _gf_false;
     char gfid[64] = {
         0,
     };
 
+    conf = wb_inode->this->private;
+
     list_for_each_entry_safe(req, tmp, &wb_inode->temptation, lie)
     {
-        if (!req->ordering.fulfilled &&
-            wb_inode->window_current > wb_inode->window_conf)
+        if (!req->ordering.fulfilled && __wb_window_full(wb_inode)) {
+            held = _gf_true;
             continue;
+        }
 
         list_del_init(&req->lie);
         list_move_tail(&req->unwinds, lies);
 
-        wb_inode->window_current += req->orig_size;
+        __wb_window_update(wb_inode, req->orig_size);
 
         wb_inode->gen++;
 
@@ -1303,7 +1478,18 @@ __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
         }
     }
 
-    return;
+    if (held && conf->dirty_budget) {
+        LOCK(&conf->lock);
+        {
+            if (list_empty(&wb_inode->wait)) {
+                list_add_tail(&wb_inode->wait, &conf->waiters);
+                wait = _gf_true;
+            }
+        }
+        UNLOCK(&conf->lock);
+    }
+
+    return wait;
 }
 
 int
@@ -1371,6 +1557,41 @@ out:
     return ret;
 }
 
+/* In aggregate-mode vector, contiguous non-sync writes are chained from
+ * @holder to @last, and stay separate requests in todo (their iobufs are
+ * wound as one vector by wb_fulfill()). In aggregate-mode copy, @last is
+ * always @holder. */
+static void
+__wb_chain_go(wb_inode_t *wb_inode, wb_request_t *holder, wb_request_t *last)
+{
+    wb_request_t *req = holder;
+
+    for (;;) {
+        if (req->ordering.tempted)
+            req->ordering.go = 1;
+        if ((req == last) || (req->todo.next == &wb_inode->todo))
+            break;
+        req = list_entry(req->todo.next, wb_request_t, todo);
+    }
+}
+
+static gf_boolean_t
+__wb_chain_conflicts(wb_inode_t *wb_inode, wb_request_t *holder,
+                     wb_request_t *last, wb_request_t *req)
+{
+    wb_request_t *each = holder;
+
+    for (;;) {
+        if (each->ordering.tempted && wb_requests_conflict(each, req))
+            return _gf_true;
+        if ((each == last) || (each->todo.next == &wb_inode->todo))
+            break;
+        each = list_entry(each->todo.next, wb_request_t, todo);
+    }
+
+    return _gf_false;
+}
+
 void
 __wb_preprocess_winds(wb_inode_t *wb_inode)
 {
@@ -1379,9 +1600,13 @@ __wb_preprocess_winds(wb_inode_t *wb_inode)
     wb_request_t *req = NULL;
     wb_request_t *tmp = NULL;
     wb_request_t *holder = NULL;
+    wb_request_t *last = NULL;
     wb_conf_t *conf = NULL;
     int ret = 0;
     ssize_t page_size = 0;
+    size_t chain_size = 0;
+    int chain_count = 0;
+    int count = 0;
     char gfid[64] = {
         0,
     };
@@ -1423,51 +1648,61 @@ __wb_preprocess_winds(wb_inode_t *wb_inode)
 
         if (!req->ordering.tempted) {
             if (holder) {
-                if (wb_requests_conflict(holder, req))
+                if (__wb_chain_conflicts(wb_inode, holder, last, req))
                     /* do not hold on write if a
                        dependent write is in queue */
-                    holder->ordering.go = 1;
+                    __wb_chain_go(wb_inode, holder, last);
             }
             /* collapse only non-sync writes */
             continue;
         } else if (!holder) {
             /* holder is always a non-sync write */
-            holder = req;
+            holder = last = req;
+            chain_size = req->write_size;
+            chain_count = req->stub->args.count;
             continue;
         }
 
-        offset_expected = holder->stub->args.offset + holder->write_size;
+        offset_expected = last->stub->args.offset + last->write_size;
 
-        if (req->stub->args.offset != offset_expected) {
-            holder->ordering.go = 1;
-            holder = req;
+        if ((req->stub->args.offset != offset_expected) ||
+            !is_same_lkowner(&req->lk_owner, &holder->lk_owner) ||
+            (req->fd != holder->fd)) {
+            __wb_chain_go(wb_inode, holder, last);
+            holder = last = req;
+            chain_size = req->write_size;
+            chain_count = req->stub->args.count;
             continue;
         }
 
-        if (!is_same_lkowner(&req->lk_owner, &holder->lk_owner)) {
-            holder->ordering.go = 1;
-            holder = req;
-            continue;
-        }
-
-        if (req->fd != holder->fd) {
-            holder->ordering.go = 1;
-            holder = req;
-            continue;
-        }
-
-        space_left = page_size - holder->write_size;
+        space_left = page_size - last->write_size;
+
+        if ((space_left < req->write_size) ||
+            (chain_size + req->write_size > conf->aggregate_size)) {
+            if (!conf->vectored ||
+                (chain_size + req->write_size > conf->aggregate_size) ||
+                (chain_count + req->stub->args.count > MAX_VECTOR_COUNT)) {
+                __wb_chain_go(wb_inode, holder, last);
+                holder = req;
+                chain_size = 0;
+                chain_count = 0;
+            }
 
-        if (space_left < req->write_size) {
-            holder->ordering.go = 1;
-            holder = req;
+            /* chain the write as is, without copying it */
+            last = req;
+            chain_size += req->write_size;
+            chain_count += req->stub->args.count;
             continue;
         }
 
-        ret = __wb_collapse_small_writes(conf, holder, req);
+        count = last->stub->args.count;
+        ret = __wb_collapse_small_writes(conf, last, req);
         if (ret)
             continue;
 
+        chain_size += req->write_size;
+        chain_count += last->stub->args.count - count;
+
         /* collapsed request is as good as wound
            (from its p.o.v)
         */
@@ -1489,7 +1724,16 @@ __wb_preprocess_winds(wb_inode_t *wb_inode)
     */
 
     if (conf->trickling_writes && !wb_inode->transit && holder)
-        holder->ordering.go = 1;
+        __wb_chain_go(wb_inode, holder, last);
+
+    /* flushed to give back dirty-budget: do not hold anything */
+    if (GF_ATOMIC_SWAP(wb_inode->flush, 0)) {
+        list_for_each_entry(req, &wb_inode->todo, todo)
+        {
+            if (req->ordering.tempted)
+                req->ordering.go = 1;
+        }
+    }
 
     if (wb_inode->dontsync > 0)
         wb_inode->dontsync--;
@@ -1755,6 +1999,7 @@ wb_process_queue(wb_inode_t *wb_inode)
     list_head_t lies;
     list_head_t liabilities;
     int wind_failure = 0;
+    gf_boolean_t wait = _gf_false;
 
     INIT_LIST_HEAD(&tasks);
     INIT_LIST_HEAD(&lies);
@@ -1770,7 +2015,8 @@ wb_process_queue(wb_inode_t *wb_inode)
 
             __wb_pick_winds(wb_inode, &tasks, &liabilities);
 
-            __wb_pick_unwinds(wb_inode, &lies);
+            if (__wb_pick_unwinds(wb_inode, &lies))
+                wait = _gf_true;
         }
         UNLOCK(&wb_inode->lock);
 
@@ -1788,6 +2034,9 @@ wb_process_queue(wb_inode_t *wb_inode)
             wind_failure = wb_fulfill(wb_inode, &liabilities);
     } while (wind_failure);
 
+    if (wait)
+        wb_budget_flush(wb_inode->this);
+
     return;
 }
 
@@ -2865,6 +3114,15 @@ wb_priv_dump(xlator_t *this)
 
     gf_proc_dump_write("aggregate_size", "%" PRIu64, conf->aggregate_size);
     gf_proc_dump_write("window_size", "%" PRIu64, conf->window_size);
+    gf_proc_dump_write("aggregate_mode", "%s",
+                       conf->vectored ? "vector" : "copy");
+    gf_proc_dump_write("dirty_budget", "%" PRIu64, conf->dirty_budget);
+    gf_proc_dump_write("dirty", "%" PRId64, GF_ATOMIC_GET(conf->dirty));
+    gf_proc_dump_write("budget_flushes", "%" PRId64,
+                       GF_ATOMIC_GET(conf->budget_flushes));
+    gf_proc_dump_write("fulfilled", "%" PRId64, GF_ATOMIC_GET(conf->fulfilled));
+    gf_proc_dump_write("fulfilled_requests", "%" PRId64,
+                       GF_ATOMIC_GET(conf->fulfilled_requests));
     gf_proc_dump_write("flush_behind", "%d", conf->flush_behind);
     gf_proc_dump_write("trickling_writes", "%d", conf->trickling_writes);
 
@@ -3024,10 +3282,24 @@ out:
     return ret;
 }
 
+static void
+wb_set_aggregate_mode(wb_conf_t *conf, char *mode)
+{
+    conf->vectored = (strcmp(mode, "vector") == 0);
+
+    /* in vector mode, only writes that fit in a small buffer are copied
+     * together, larger ones are chained up to aggregate-size */
+    conf->page_size = conf->aggregate_size;
+    if (conf->vectored)
+        conf->page_size = min(conf->aggregate_size, WB_AGGREGATE_SIZE);
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
     wb_conf_t *conf = NULL;
+    char *mode = NULL;
+    uint64_t dirty_budget = 0;
     int ret = -1;
 
     conf = this->private;
@@ -3035,6 +3307,16 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("cache-size", conf->window_size, options, size_uint64,
                      out);
 
+    GF_OPTION_RECONF("aggregate-mode", mode, options, str, out);
+    wb_set_aggregate_mode(conf, mode);
+
+    GF_OPTION_RECONF("dirty-budget", dirty_budget, options, size_uint64, out);
+    if (dirty_budget != conf->dirty_budget) {
+        conf->dirty_budget = dirty_budget;
+        /* inodes held back by the former budget */
+        wb_budget_wake(this);
+    }
+
     GF_OPTION_RECONF("flush-behind", conf->flush_behind, options, bool, out);
 
     GF_OPTION_RECONF("trickling-writes", conf->trickling_writes, options, bool,
@@ -3057,6 +3339,7 @@ int32_t
 init(xlator_t *this)
 {
     wb_conf_t *conf = NULL;
+    char *mode = NULL;
     int32_t ret = -1;
 
     if ((this->children == NULL) || this->children->next) {
@@ -3078,9 +3361,21 @@ init(xlator_t *this)
         goto out;
     }
 
+    LOCK_INIT(&conf->lock);
+    INIT_LIST_HEAD(&conf->lru);
+    INIT_LIST_HEAD(&conf->waiters);
+    GF_ATOMIC_INIT(conf->dirty, 0);
+    GF_ATOMIC_INIT(conf->budget_flushes, 0);
+    GF_ATOMIC_INIT(conf->fulfilled, 0);
+    GF_ATOMIC_INIT(conf->fulfilled_requests, 0);
+
     /* configure 'options aggregate-size <size>' */
     GF_OPTION_INIT("aggregate-size", conf->aggregate_size, size_uint64, out);
-    conf->page_size = conf->aggregate_size;
+
+    GF_OPTION_INIT("aggregate-mode", mode, str, out);
+    wb_set_aggregate_mode(conf, mode);
+
+    GF_OPTION_INIT("dirty-budget", conf->dirty_budget, size_uint64, out);
 
     /* configure 'option window-size <size>' */
     GF_OPTION_INIT("cache-size", conf->window_size, size_uint64, out);
@@ -3093,7 +3388,7 @@ init(xlator_t *this)
         conf->window_size = conf->aggregate_size;
     }
 
-    if (conf->window_size < conf->aggregate_size) {
+    if (!conf->dirty_budget && (conf->window_size < conf->aggregate_size)) {
         gf_msg(this->name, GF_LOG_ERROR, 0, WRITE_BEHIND_MSG_EXCEEDED_MAX_SIZE,
                "aggregate-size(%" PRIu64
                ") cannot be more than "
@@ -3138,6 +3433,7 @@ fini(xlator_t *this)
     }
 
     this->private = NULL;
+    LOCK_DESTROY(&conf->lock);
     GF_FREE(conf);
 
 out:
@@ -3260,6 +3556,35 @@ struct volume_options options[] = {
                        " so that writes are aggregated till a max of "
                        "\"aggregate-size\" bytes",
     },
+    {
+        .key = {"aggregate-mode"},
+        .type = GF_OPTION_TYPE_STR,
+        .value = {"copy", "vector"},
+        .default_value = "copy",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"write-behind"},
+        .description = "copy: contiguous writes are copied into one buffer "
+                       "of up to aggregate-size. vector: only writes "
+                       "fitting in 128KB are copied together, larger ones "
+                       "keep their buffers and are sent as one vectored "
+                       "write of up to aggregate-size",
+    },
+    {
+        .key = {"dirty-budget"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 64 * GF_UNIT_GB,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_8_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"write-behind"},
+        .description = "Size of the write-behind buffer for all the files "
+                       "of the client. When set, it replaces cache-size: "
+                       "writes of any file can use it, and the files that "
+                       "grew their writes least recently are flushed when "
+                       "it is full. 0 limits each file to cache-size",
+    },
     {.key = {NULL}},
 };
 
@@ -90,17 +90,40 @@ out:
     return ret;
 }
 
-int
-client_cbk_cache_invalidation(struct rpc_clnt *rpc, void *mydata, void *data)
+static void
+client_cache_invalidation_notify(xlator_t *this,
+                                 gfs3_cbk_cache_invalidation_req *ca_req)
 {
     int ret = -1;
-    struct iovec *iov = NULL;
     struct gf_upcall upcall_data = {
         0,
     };
     struct gf_upcall_cache_invalidation ca_data = {
         0,
     };
+
+    upcall_data.data = &ca_data;
+    ret = gf_proto_cache_invalidation_to_upcall(this, ca_req, &upcall_data);
+    if (ret < 0)
+        goto out;
+
+    gf_msg_trace(this->name, 0,
+                 "Cache invalidation cbk received for gfid:"
+                 " %s, ret = %d",
+                 ca_req->gfid, ret);
+
+    default_notify(this, GF_EVENT_UPCALL, &upcall_data);
+
+out:
+    if (ca_data.dict)
+        dict_unref(ca_data.dict);
+}
+
+int
+client_cbk_cache_invalidation(struct rpc_clnt *rpc, void *mydata, void *data)
+{
+    int ret = -1;
+    struct iovec *iov = NULL;
     gfs3_cbk_cache_invalidation_req ca_req = {
         0,
     };
@@ -120,17 +143,7 @@ client_cbk_cache_invalidation(struct rpc_clnt *rpc, void *mydata, void *data)
         goto out;
     }
 
-    upcall_data.data = &ca_data;
-    ret = gf_proto_cache_invalidation_to_upcall(THIS, &ca_req, &upcall_data);
-    if (ret < 0)
-        goto out;
-
-    gf_msg_trace(THIS->name, 0,
-                 "Cache invalidation cbk received for gfid:"
-                 " %s, ret = %d",
-                 ca_req.gfid, ret);
-
-    default_notify(THIS, GF_EVENT_UPCALL, &upcall_data);
+    client_cache_invalidation_notify(THIS, &ca_req);
 
 out:
     if (ca_req.gfid)
@@ -139,8 +152,47 @@ out:
     if (ca_req.xdata.xdata_val)
         free(ca_req.xdata.xdata_val);
 
-    if (ca_data.dict)
-        dict_unref(ca_data.dict);
+    return 0;
+}
+
+int
+client_cbk_cache_invalidation_batch(struct rpc_clnt *rpc, void *mydata,
+                                    void *data)
+{
+    int ret = -1;
+    unsigned int i = 0;
+    struct iovec *iov = NULL;
+    gfs3_cbk_cache_invalidation_req *ca_req = NULL;
+    gfs4_cbk_cache_invalidation_batch_req batch_req = {
+        {0},
+    };
+
+    gf_msg_trace(THIS->name, 0, "Upcall batch callback is called");
+
+    if (!rpc || !mydata || !data)
+        goto out;
+
+    iov = (struct iovec *)data;
+    ret = xdr_to_generic(*iov, &batch_req,
+                         (xdrproc_t)xdr_gfs4_cbk_cache_invalidation_batch_req);
+    if (ret < 0) {
+        gf_msg(THIS->name, GF_LOG_WARNING, -ret, PC_MSG_CACHE_INVALIDATION_FAIL,
+               "XDR decode of cache_invalidation batch failed.");
+        goto out;
+    }
+
+    /* the xlators above handle invalidations one gfid at a time */
+    for (i = 0; i < batch_req.entries.entries_len; i++) {
+        ca_req = &batch_req.entries.entries_val[i];
+        client_cache_invalidation_notify(THIS, ca_req);
+
+        free(ca_req->gfid);
+        free(ca_req->xdata.xdata_val);
+    }
+
+out:
+    free(batch_req.entries.entries_val);
+    free(batch_req.xdata.xdata_val);
 
     return 0;
 }
@@ -314,6 +366,9 @@ rpcclnt_cb_actor_t gluster_cbk_actors[GF_CBK_MAXVALUE] = {
     [GF_CBK_ENTRYLK_CONTENTION] = {"ENTRYLK_CONTENTION",
                                    GF_CBK_ENTRYLK_CONTENTION,
                                    client_cbk_entrylk_contention},
+    [GF_CBK_CACHE_INVALIDATION_BATCH] = {"CACHE_INVALIDATION_BATCH",
+                                         GF_CBK_CACHE_INVALIDATION_BATCH,
+                                         client_cbk_cache_invalidation_batch},
 };
 
 struct rpcclnt_cb_program gluster_cbk_prog = {
@@ -1280,6 +1280,13 @@ client_setvolume(xlator_t *this, struct rpc_clnt *rpc)
                "failed to set clnt-lk-version(1) in handshake msg");
     }
 
+    /* cache invalidations can be sent in GF_CBK_CACHE_INVALIDATION_BATCH */
+    ret = dict_set_uint32(options, "cache-invalidation-batch", 1);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, PC_MSG_DICT_SET_FAILED,
+               "failed to set cache-invalidation-batch in handshake msg");
+    }
+
     ret = dict_set_int32(options, "opversion", GD_OP_VERSION_MAX);
     if (ret < 0) {
         gf_msg(this->name, GF_LOG_ERROR, 0, PC_MSG_DICT_SET_FAILED,
@@ -3029,6 +3029,8 @@ client4_0_lookup(call_frame_t *frame, xlator_t *this, void *data)
 
     if (args->xdata) {
         content = dict_get(args->xdata, GF_CONTENT_KEY);
+        if (content == NULL)
+            content = dict_get(args->xdata, GF_CONTENT_HEAD_KEY);
         if (content != NULL) {
             rsp_iobref = iobref_new();
             if (rsp_iobref == NULL) {
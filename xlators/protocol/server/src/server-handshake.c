@@ -515,6 +515,9 @@ server_setvolume(rpcsvc_request_t *req)
                          "peer-info");
     }
 
+    if (dict_get_sizen(params, "cache-invalidation-batch"))
+        serv_ctx->cache_invalidation_batch = _gf_true;
+
     ret = dict_get_uint32(params, "opversion", &opversion);
     if (ret) {
         gf_msg(this->name, GF_LOG_INFO, 0, PS_MSG_CLIENT_OPVERSION_GET_FAILED,
@@ -1329,6 +1329,95 @@ server_fini(xlator_t *this)
     return;
 }
 
+static int
+server_process_upcall_batch(xlator_t *this, server_conf_t *conf,
+                            struct gf_upcall *upcall_data)
+{
+    int ret = -1;
+    uint32_t i = 0;
+    client_t *client = NULL;
+    server_ctx_t *serv_ctx = NULL;
+    rpc_transport_t *xprt = NULL;
+    struct gf_upcall_cache_invalidation_batch *batch = NULL;
+    gfs3_cbk_cache_invalidation_req *entries = NULL;
+    char *gfids = NULL;
+    gfs4_cbk_cache_invalidation_batch_req batch_req = {
+        {0},
+    };
+
+    batch = upcall_data->data;
+    GF_VALIDATE_OR_GOTO(this->name, batch, out);
+    if (!batch->count)
+        goto out;
+
+    entries = GF_CALLOC(batch->count, sizeof(*entries),
+                        gf_server_mt_upcall_batch_t);
+    gfids = GF_CALLOC(batch->count, GF_UUID_BUF_SIZE,
+                      gf_server_mt_upcall_batch_t);
+    if (!entries || !gfids)
+        goto out;
+
+    for (i = 0; i < batch->count; i++) {
+        ret = gf_proto_cache_invalidation_from_upcall(this, &entries[i],
+                                                      &batch->entries[i]);
+        if (ret < 0)
+            goto out;
+        /* uuid_utoa() returns the same buffer for every entry */
+        entries[i].gfid = uuid_utoa_r(batch->entries[i].gfid,
+                                      gfids + (i * GF_UUID_BUF_SIZE));
+    }
+
+    batch_req.entries.entries_len = batch->count;
+    batch_req.entries.entries_val = entries;
+
+    pthread_mutex_lock(&conf->mutex);
+    {
+        list_for_each_entry(xprt, &conf->xprt_list, list)
+        {
+            client = xprt->xl_private;
+
+            if (!client || strcmp(client->client_uid, upcall_data->client_uid))
+                continue;
+
+            client_ctx_get(client, this, (void **)&serv_ctx);
+            if (serv_ctx && serv_ctx->cache_invalidation_batch) {
+                ret = rpcsvc_request_submit(
+                    conf->rpc, xprt, &server_cbk_prog,
+                    GF_CBK_CACHE_INVALIDATION_BATCH, &batch_req, this->ctx,
+                    (xdrproc_t)xdr_gfs4_cbk_cache_invalidation_batch_req);
+            } else {
+                /* older clients get one callback per gfid */
+                for (i = 0; i < batch->count; i++) {
+                    ret = rpcsvc_request_submit(
+                        conf->rpc, xprt, &server_cbk_prog,
+                        GF_CBK_CACHE_INVALIDATION, &entries[i], this->ctx,
+                        (xdrproc_t)xdr_gfs3_cbk_cache_invalidation_req);
+                    if (ret < 0)
+                        break;
+                }
+            }
+            if (ret < 0) {
+                gf_msg_debug(this->name, 0,
+                             "Failed to send upcall batch of %u entries to "
+                             "client:%s",
+                             batch->count, upcall_data->client_uid);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&conf->mutex);
+    ret = 0;
+out:
+    if (entries) {
+        for (i = 0; i < batch->count; i++)
+            GF_FREE(entries[i].xdata.xdata_val);
+        GF_FREE(entries);
+    }
+    GF_FREE(gfids);
+
+    return ret;
+}
+
 int
 server_process_event_upcall(xlator_t *this, void *data)
 {
@@ -1384,6 +1473,9 @@ server_process_event_upcall(xlator_t *this, void *data)
             cbk_procnum = GF_CBK_CACHE_INVALIDATION;
             xdrproc = (xdrproc_t)xdr_gfs3_cbk_cache_invalidation_req;
             break;
+        case GF_UPCALL_CACHE_INVALIDATION_BATCH:
+            ret = server_process_upcall_batch(this, conf, upcall_data);
+            goto out;
         case GF_UPCALL_RECALL_LEASE:
             ret = gf_proto_recall_lease_from_upcall(this, &gf_recall_lease,
                                                     upcall_data);
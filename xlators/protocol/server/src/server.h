@@ -193,6 +193,8 @@ extern struct rpcsvc_program glusterfs4_0_fop_prog;
 typedef struct _server_ctx {
     gf_lock_t fdtable_lock;
     fdtable_t *fdtable;
+    /* client handles GF_CBK_CACHE_INVALIDATION_BATCH */
+    gf_boolean_t cache_invalidation_batch;
 } server_ctx_t;
 
 typedef struct server_cleanup_xprt_arg {
@@ -119,6 +119,14 @@ posix_priv(xlator_t *this)
     gf_proc_dump_write("max_read", "%" PRId64, GF_ATOMIC_GET(priv->read_value));
     gf_proc_dump_write("max_write", "%" PRId64,
                        GF_ATOMIC_GET(priv->write_value));
+    gf_proc_dump_write("handle_cache_size", "%" PRIu32,
+                       priv->handle_cache_limit);
+    gf_proc_dump_write("handle_cache_entries", "%" PRIu32,
+                       priv->handle_cache_count);
+    gf_proc_dump_write("handle_cache_hits", "%" PRId64,
+                       GF_ATOMIC_GET(priv->handle_cache_hits));
+    gf_proc_dump_write("handle_cache_misses", "%" PRId64,
+                       GF_ATOMIC_GET(priv->handle_cache_misses));
 
     return 0;
 }
@@ -270,6 +278,7 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     int32_t force_directory_mode = -1;
     int32_t create_mask = -1;
     int32_t create_directory_mask = -1;
+    uint32_t handle_cache_size = 0;
 
     priv = this->private;
 
@@ -398,6 +407,10 @@ posix_reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("ctime", priv->ctime, options, bool, out);
 
+    GF_OPTION_RECONF("handle-cache-size", handle_cache_size, options, uint32,
+                     out);
+    posix_handle_cache_set_limit(this, handle_cache_size);
+
     ret = 0;
 out:
     return ret;
@@ -545,6 +558,7 @@ posix_init(xlator_t *this)
     char *batch_fsync_mode_str;
     char *gfid2path_sep = NULL;
     int force_create = -1;
+    uint32_t handle_cache_size = 0;
     int force_directory = -1;
     int create_mask = -1;
     int create_directory_mask = -1;
@@ -908,6 +922,12 @@ posix_init(xlator_t *this)
 
     this->private = (void *)_private;
 
+    op_ret = posix_handle_cache_init(this);
+    if (op_ret == -1) {
+        ret = -1;
+        goto out;
+    }
+
     op_ret = posix_handle_init(this);
     if (op_ret == -1) {
         gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_HANDLE_CREATE,
@@ -1068,9 +1088,15 @@ posix_init(xlator_t *this)
                    out);
 
     GF_OPTION_INIT("ctime", _private->ctime, bool, out);
+
+    GF_OPTION_INIT("handle-cache-size", handle_cache_size, uint32, out);
+    posix_handle_cache_set_limit(this, handle_cache_size);
 out:
     if (ret) {
         if (_private) {
+            if (this->private)
+                posix_handle_cache_fini(this);
+
             GF_FREE(_private->base_path);
 
             GF_FREE(_private->hostname);
@@ -1128,6 +1154,8 @@ posix_fini(xlator_t *this)
     if (priv->mount_lock)
         (void)sys_closedir(priv->mount_lock);
 
+    posix_handle_cache_fini(this);
+
     GF_FREE(priv->base_path);
     LOCK_DESTROY(&priv->lock);
     pthread_mutex_destroy(&priv->fsync_mutex);
@@ -1375,5 +1403,18 @@ struct volume_options posix_options[] = {
          "are stored in xattr to keep it consistent across replica and "
          "distribute set. The time attributes stored at the backend are "
          "not considered "},
+    {.key = {"handle-cache-size"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 1048576,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_8_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"posix"},
+     .validate = GF_OPT_VALIDATE_MIN,
+     .description = "Number of directory gfid handles whose targets are "
+                    "kept in memory, saving the readlink() calls made to "
+                    "resolve a gfid to a path (nameless lookups from "
+                    "self-heal, NFS, gfid2path). 0 disables the cache."},
     {.key = {NULL}},
 };
@@ -82,6 +82,276 @@ out:
     return inode;
 }
 
+/*
+ * Directory handle cache
+ *
+ * Every directory has a symlink .glusterfs/xx/yy/<gfid> pointing to
+ * ../../pp/qq/<pgfid>/<name>. Resolving a directory gfid to a path
+ * (posix_handle_path(), building the ancestry for nameless lookups,
+ * gfid2path) costs a readlink() per level. The targets are cached here,
+ * bounded by the "handle-cache-size" option and evicted in LRU order.
+ * All changes to directory handles go through posix_handle_soft() and
+ * posix_handle_unset_gfid(), which invalidate the entry; that covers
+ * mkdir, rmdir, rename and the heal paths of the entry fops.
+ */
+
+#define POSIX_HANDLE_CACHE_BUCKETS 4096
+
+typedef struct posix_handle_cache_entry {
+    struct list_head hash;
+    struct list_head lru;
+    uuid_t gfid;
+    uuid_t pgfid;
+    char bname[];
+} posix_handle_cache_entry_t;
+
+static uint32_t
+posix_handle_cache_hash(uuid_t gfid)
+{
+    return ((gfid[14] << 8) | gfid[15]) & (POSIX_HANDLE_CACHE_BUCKETS - 1);
+}
+
+static posix_handle_cache_entry_t *
+__posix_handle_cache_find(struct posix_private *priv, uuid_t gfid)
+{
+    posix_handle_cache_entry_t *entry = NULL;
+    struct list_head *head = NULL;
+
+    head = &priv->handle_cache_table[posix_handle_cache_hash(gfid)];
+    list_for_each_entry(entry, head, hash)
+    {
+        if (gf_uuid_compare(entry->gfid, gfid) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static void
+__posix_handle_cache_del(struct posix_private *priv,
+                         posix_handle_cache_entry_t *entry)
+{
+    list_del(&entry->hash);
+    list_del(&entry->lru);
+    priv->handle_cache_count--;
+    GF_FREE(entry);
+}
+
+static void
+__posix_handle_cache_shrink(struct posix_private *priv, uint32_t limit)
+{
+    posix_handle_cache_entry_t *entry = NULL;
+
+    while (priv->handle_cache_count > limit) {
+        entry = list_entry(priv->handle_cache_lru.prev,
+                           posix_handle_cache_entry_t, lru);
+        __posix_handle_cache_del(priv, entry);
+    }
+}
+
+/* Caches the target read from the handle of @gfid, unless a handle was
+ * created or removed since @gen was sampled.
+ */
+static void
+posix_handle_cache_add(struct posix_private *priv, uuid_t gfid,
+                       const char *linkname, size_t len, uint64_t gen)
+{
+    posix_handle_cache_entry_t *entry = NULL;
+    const char *bname = NULL;
+    size_t bname_len = 0;
+    char pgfid_str[GF_UUID_BUF_SIZE] = {
+        0,
+    };
+    uuid_t pgfid = {
+        0,
+    };
+
+    /* "../../pp/qq/<pgfid>/<name>" */
+    if (len <= SLEN("../../00/00/" UUID0_STR "/") ||
+        memcmp(linkname, "../../", SLEN("../../")) != 0 ||
+        linkname[SLEN("../../00/00/" UUID0_STR)] != '/')
+        return;
+
+    memcpy(pgfid_str, linkname + SLEN("../../00/00/"), SLEN(UUID0_STR));
+    if (gf_uuid_parse(pgfid_str, pgfid))
+        return;
+
+    bname = linkname + SLEN("../../00/00/" UUID0_STR "/");
+    bname_len = len - SLEN("../../00/00/" UUID0_STR "/");
+    if (bname_len > NAME_MAX || memchr(bname, '/', bname_len))
+        return;
+
+    entry = GF_MALLOC(sizeof(*entry) + bname_len + 1,
+                      gf_posix_mt_handle_cache_t);
+    if (!entry)
+        return;
+
+    INIT_LIST_HEAD(&entry->hash);
+    INIT_LIST_HEAD(&entry->lru);
+    gf_uuid_copy(entry->gfid, gfid);
+    gf_uuid_copy(entry->pgfid, pgfid);
+    memcpy(entry->bname, bname, bname_len);
+    entry->bname[bname_len] = '\0';
+
+    LOCK(&priv->handle_cache_lock);
+    {
+        if ((gen != priv->handle_cache_gen) || !priv->handle_cache_limit ||
+            __posix_handle_cache_find(priv, gfid)) {
+            GF_FREE(entry);
+            goto unlock;
+        }
+
+        list_add(&entry->hash,
+                 &priv->handle_cache_table[posix_handle_cache_hash(gfid)]);
+        list_add(&entry->lru, &priv->handle_cache_lru);
+        priv->handle_cache_count++;
+        __posix_handle_cache_shrink(priv, priv->handle_cache_limit);
+    }
+unlock:
+    UNLOCK(&priv->handle_cache_lock);
+}
+
+/*
+ * Drop-in replacement for readlink() on the handle @handle of directory
+ * @gfid: the target is served from the cache when present. Like
+ * readlink(), the result is not NUL terminated by contract and -1 is
+ * returned with errno set on failure.
+ */
+int
+posix_handle_readlink(xlator_t *this, uuid_t gfid, const char *handle,
+                      char *linkname, size_t size)
+{
+    struct posix_private *priv = NULL;
+    posix_handle_cache_entry_t *entry = NULL;
+    char pgfid_str[GF_UUID_BUF_SIZE] = {
+        0,
+    };
+    uint64_t gen = 0;
+    int len = -1;
+
+    priv = this->private;
+
+    if (!priv->handle_cache_limit || __is_root_gfid(gfid))
+        return sys_readlink(handle, linkname, size);
+
+    LOCK(&priv->handle_cache_lock);
+    {
+        gen = priv->handle_cache_gen;
+        entry = __posix_handle_cache_find(priv, gfid);
+        if (entry) {
+            list_move(&entry->lru, &priv->handle_cache_lru);
+            len = snprintf(linkname, size, "../../%02x/%02x/%s/%s",
+                           entry->pgfid[0], entry->pgfid[1],
+                           uuid_utoa_r(entry->pgfid, pgfid_str),
+                           entry->bname);
+        }
+    }
+    UNLOCK(&priv->handle_cache_lock);
+
+    if (entry && (len > 0) && (len < size)) {
+        GF_ATOMIC_INC(priv->handle_cache_hits);
+        return len;
+    }
+
+    GF_ATOMIC_INC(priv->handle_cache_misses);
+    len = sys_readlink(handle, linkname, size);
+    if ((len > 0) && (len < size))
+        posix_handle_cache_add(priv, gfid, linkname, len, gen);
+
+    return len;
+}
+
+static gf_boolean_t
+posix_handle_cache_has(struct posix_private *priv, uuid_t gfid)
+{
+    gf_boolean_t found = _gf_false;
+
+    if (!priv->handle_cache_limit)
+        return _gf_false;
+
+    LOCK(&priv->handle_cache_lock);
+    {
+        found = (__posix_handle_cache_find(priv, gfid) != NULL);
+    }
+    UNLOCK(&priv->handle_cache_lock);
+
+    return found;
+}
+
+void
+posix_handle_cache_invalidate(xlator_t *this, uuid_t gfid)
+{
+    struct posix_private *priv = NULL;
+    posix_handle_cache_entry_t *entry = NULL;
+
+    priv = this->private;
+    if (!priv->handle_cache_table || !priv->handle_cache_limit)
+        return;
+
+    LOCK(&priv->handle_cache_lock);
+    {
+        priv->handle_cache_gen++;
+        entry = __posix_handle_cache_find(priv, gfid);
+        if (entry)
+            __posix_handle_cache_del(priv, entry);
+    }
+    UNLOCK(&priv->handle_cache_lock);
+}
+
+void
+posix_handle_cache_set_limit(xlator_t *this, uint32_t limit)
+{
+    struct posix_private *priv = NULL;
+
+    priv = this->private;
+
+    LOCK(&priv->handle_cache_lock);
+    {
+        priv->handle_cache_limit = limit;
+        __posix_handle_cache_shrink(priv, limit);
+    }
+    UNLOCK(&priv->handle_cache_lock);
+}
+
+int
+posix_handle_cache_init(xlator_t *this)
+{
+    struct posix_private *priv = NULL;
+    int i = 0;
+
+    priv = this->private;
+
+    priv->handle_cache_table = GF_CALLOC(POSIX_HANDLE_CACHE_BUCKETS,
+                                         sizeof(struct list_head),
+                                         gf_posix_mt_handle_cache_t);
+    if (!priv->handle_cache_table)
+        return -1;
+
+    for (i = 0; i < POSIX_HANDLE_CACHE_BUCKETS; i++)
+        INIT_LIST_HEAD(&priv->handle_cache_table[i]);
+    INIT_LIST_HEAD(&priv->handle_cache_lru);
+    LOCK_INIT(&priv->handle_cache_lock);
+    GF_ATOMIC_INIT(priv->handle_cache_hits, 0);
+    GF_ATOMIC_INIT(priv->handle_cache_misses, 0);
+
+    return 0;
+}
+
+void
+posix_handle_cache_fini(xlator_t *this)
+{
+    struct posix_private *priv = NULL;
+
+    priv = this->private;
+    if (!priv->handle_cache_table)
+        return;
+
+    posix_handle_cache_set_limit(this, 0);
+    LOCK_DESTROY(&priv->handle_cache_lock);
+    GF_FREE(priv->handle_cache_table);
+    priv->handle_cache_table = NULL;
+}
+
 int
 posix_make_ancestral_node(const char *priv_base_path, char *path, int pathsize,
                           gf_dirent_t *head, char *dir_name, struct iatt *iabuf,
@@ -184,7 +454,8 @@ posix_make_ancestryfromgfid(xlator_t *this, char *path, int pathsize,
                      priv_base_path, GF_HIDDEN_PATH, tmp_gfid[0], tmp_gfid[1],
                      uuid_utoa(tmp_gfid));
 
-            len = sys_readlink(dir_handle, linkname, PATH_MAX);
+            len = posix_handle_readlink(this, tmp_gfid, dir_handle, linkname,
+                                        PATH_MAX);
             if (len < 0) {
                 *op_errno = errno;
                 gf_msg(this->name,
@@ -333,9 +604,15 @@ posix_handle_pump(xlator_t *this, char *buf, int len, int maxlen,
     int ret = 0;
     int blen = 0;
     int link_len = 0;
+    uuid_t gfid = {
+        0,
+    };
 
-    /* is a directory's symlink-handle */
-    ret = sys_readlink(base_str, linkname, 512);
+    /* is a directory's symlink-handle; base_str ends in xx/yy/<gfid> */
+    if (gf_uuid_parse(base_str + pfx_len + SLEN("00/00/"), gfid))
+        ret = sys_readlink(base_str, linkname, 512);
+    else
+        ret = posix_handle_readlink(this, gfid, base_str, linkname, 512);
     if (ret == -1) {
         gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_READLINK_FAILED,
                "internal readlink failed on %s ", base_str);
@@ -427,10 +704,13 @@ posix_handle_path(xlator_t *this, uuid_t gfid, const char *basename, char *ubuf,
         len = snprintf(buf, maxlen, "%s", base_str);
     }
 
-    ret = sys_lstat(base_str, &stat);
+    /* a cached gfid is known to be a directory's symlink-handle */
+    if (!posix_handle_cache_has(priv, gfid)) {
+        ret = sys_lstat(base_str, &stat);
 
-    if (!(ret == 0 && S_ISLNK(stat.st_mode) && stat.st_nlink == 1))
-        goto out;
+        if (!(ret == 0 && S_ISLNK(stat.st_mode) && stat.st_nlink == 1))
+            goto out;
+    }
 
     do {
         errno = 0;
@@ -808,6 +1088,8 @@ posix_handle_soft(xlator_t *this, const char *real_path, loc_t *loc,
     MAKE_HANDLE_ABSPATH(newpath, this, gfid);
     MAKE_HANDLE_RELPATH(oldpath, this, loc->pargfid, loc->name);
 
+    posix_handle_cache_invalidate(this, gfid);
+
     ret = sys_lstat(newpath, &newbuf);
     if (ret == -1 && errno != ENOENT) {
         gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_HANDLE_CREATE, "%s",
@@ -874,6 +1156,8 @@ posix_handle_unset_gfid(xlator_t *this, uuid_t gfid)
 
     MAKE_HANDLE_GFID_PATH(path, this, gfid, NULL);
 
+    posix_handle_cache_invalidate(this, gfid);
+
     ret = sys_lstat(path, &stat);
 
     if (ret == -1) {
@@ -422,6 +422,7 @@ _posix_xattr_get_set(dict_t *xattr_req, char *key, data_t *data,
     char *databuf = NULL;
     int _fd = -1;
     ssize_t req_size = 0;
+    ssize_t content_size = 0;
     int32_t list_offset = 0;
     ssize_t remaining_size = 0;
     char *xattr = NULL;
@@ -434,13 +435,19 @@ _posix_xattr_get_set(dict_t *xattr_req, char *key, data_t *data,
     if (posix_xattr_ignorable(key))
         goto out;
     /* should size be put into the data_t ? */
-    if (!strcmp(key, GF_CONTENT_KEY) && IA_ISREG(filler->stbuf->ia_type)) {
+    if ((!strcmp(key, GF_CONTENT_KEY) || !strcmp(key, GF_CONTENT_HEAD_KEY)) &&
+        IA_ISREG(filler->stbuf->ia_type)) {
         if (!filler->real_path)
             goto out;
 
-        /* file content request */
+        /* file content request: the whole file if it is no larger than
+         * the requested size, else (for GF_CONTENT_HEAD_KEY only) its
+         * first req_size bytes */
         req_size = data_to_uint64(data);
-        if (req_size >= filler->stbuf->ia_size) {
+        content_size = filler->stbuf->ia_size;
+        if ((content_size > req_size) && !strcmp(key, GF_CONTENT_HEAD_KEY))
+            content_size = req_size;
+        if (req_size >= content_size) {
             _fd = open(filler->real_path, O_RDONLY);
             if (_fd == -1) {
                 gf_msg(filler->this->name, GF_LOG_ERROR, errno,
@@ -459,12 +466,12 @@ _posix_xattr_get_set(dict_t *xattr_req, char *key, data_t *data,
              * when size is zero, there is no space for user
              * data. The memory can be freed by calling GF_FREE.
              */
-            databuf = GF_CALLOC(1, filler->stbuf->ia_size, gf_posix_mt_char);
+            databuf = GF_CALLOC(1, content_size, gf_posix_mt_char);
             if (!databuf) {
                 goto err;
             }
 
-            ret = sys_read(_fd, databuf, filler->stbuf->ia_size);
+            ret = sys_read(_fd, databuf, content_size);
             if (ret == -1) {
                 gf_msg(filler->this->name, GF_LOG_ERROR, errno,
                        P_MSG_XDATA_GETXATTR, "Read on file %s failed",
@@ -481,8 +488,7 @@ _posix_xattr_get_set(dict_t *xattr_req, char *key, data_t *data,
                 goto err;
             }
 
-            ret = dict_set_bin(filler->xattr, key, databuf,
-                               filler->stbuf->ia_size);
+            ret = dict_set_bin(filler->xattr, key, databuf, content_size);
             if (ret < 0) {
                 gf_msg(filler->this->name, GF_LOG_ERROR, 0,
                        P_MSG_XDATA_GETXATTR,
@@ -2756,7 +2762,8 @@ posix_resolve_dirgfid_to_path(const uuid_t dirgfid, const char *brick_path,
             goto out;
         }
 
-        len = sys_readlink(dir_handle, linkname, PATH_MAX);
+        len = posix_handle_readlink(this, pargfid, dir_handle, linkname,
+                                    PATH_MAX);
         if (len < 0) {
             gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_READLINK_FAILED,
                    "could not read the "
@@ -113,6 +113,22 @@ posix_make_ancestryfromgfid(xlator_t *this, char *path, int pathsize,
 int
 posix_handle_init(xlator_t *this);
 
+int
+posix_handle_readlink(xlator_t *this, uuid_t gfid, const char *handle,
+                      char *linkname, size_t size);
+
+int
+posix_handle_cache_init(xlator_t *this);
+
+void
+posix_handle_cache_fini(xlator_t *this);
+
+void
+posix_handle_cache_set_limit(xlator_t *this, uint32_t limit);
+
+void
+posix_handle_cache_invalidate(xlator_t *this, uuid_t gfid);
+
 int
 posix_handle_trash_init(xlator_t *this);
 
@@ -254,6 +254,21 @@ struct posix_private {
 
     gf_boolean_t fips_mode_rchecksum;
     gf_boolean_t ctime;
+
+    /* Cache of directory handles: dir gfid -> (parent gfid, name), i.e.
+     * the target of the .glusterfs/xx/yy/<gfid> symlink. Protected by
+     * handle_cache_lock. handle_cache_gen is bumped whenever a handle
+     * symlink is created or removed, so a resolver that raced with a
+     * rename or rmdir does not cache the target it read before.
+     */
+    gf_lock_t handle_cache_lock;
+    struct list_head *handle_cache_table;
+    struct list_head handle_cache_lru;
+    uint32_t handle_cache_limit;
+    uint32_t handle_cache_count;
+    uint64_t handle_cache_gen;
+    gf_atomic_t handle_cache_hits;
+    gf_atomic_t handle_cache_misses;
 };
 
 typedef struct {